@@ -3,6 +3,8 @@ package com.vera360.ax360e;
 import android.content.res.AssetFileDescriptor;
 import android.net.Uri;
 import android.os.Bundle;
+import android.os.Handler;
+import android.os.Looper;
 import android.os.ParcelFileDescriptor;
 import android.view.Choreographer;
 import android.view.Surface;
@@ -37,6 +39,10 @@ public class EmulationActivity extends AppCompatActivity
     private boolean nativeRunning = false;
     private volatile boolean emulationLoopActive = false;
     private String resolvedGamePath = null;
+    private final Handler frameHandler = new Handler(Looper.getMainLooper());
+    private final Runnable tickRunnable = () -> {
+        if (emulationLoopActive) NativeBridge.tick();
+    };
 
     @Override
     protected void onCreate(Bundle savedInstanceState) {
@@ -177,7 +183,15 @@ public class EmulationActivity extends AppCompatActivity
     @Override
     public void doFrame(long frameTimeNanos) {
         if (emulationLoopActive) {
-            NativeBridge.tick();
+            // Late latching: the looper keeps dispatching touch input until
+            // the frame has to start, so the guest polls the freshest state
+            long delayNanos = NativeBridge.tickDelayNanos(frameTimeNanos)
+                    - (System.nanoTime() - frameTimeNanos);
+            if (delayNanos >= 1_000_000) {
+                frameHandler.postDelayed(tickRunnable, delayNanos / 1_000_000);
+            } else {
+                tickRunnable.run();
+            }
             Choreographer.getInstance().postFrameCallback(this);
         }
     }
@@ -188,6 +202,7 @@ public class EmulationActivity extends AppCompatActivity
     protected void onPause() {
         super.onPause();
         emulationLoopActive = false;
+        frameHandler.removeCallbacks(tickRunnable);
         if (nativeRunning) NativeBridge.pause();
     }
 
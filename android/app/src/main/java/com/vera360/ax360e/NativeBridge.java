@@ -28,6 +28,11 @@ public class NativeBridge {
     public static native void resume();
     // ── Frame tick (called from render thread) ──────────────────────────
     public static native void tick();
+    /** Nanoseconds to hold off the tick for this vsync (late latching). */
+    public static native long tickDelayNanos(long frameTimeNanos);
+    // ── Save states (carried out between ticks) ─────────────────────────
+    public static native void saveState(String path);
+    public static native void loadState(String path);
     // ── Hardware queries ────────────────────────────────────────────────────
     public static native boolean isVulkanAvailable();
     public static native String getGpuName();
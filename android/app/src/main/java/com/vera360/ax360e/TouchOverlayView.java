@@ -240,6 +240,10 @@ public class TouchOverlayView extends View {
         int pointerIndex = event.getActionIndex();
         int pointerId = event.getPointerId(pointerIndex);
 
+        // Deliver moves as they come rather than batched at vsync, so a
+        // late-started frame sees them
+        if (action == MotionEvent.ACTION_DOWN) requestUnbufferedDispatch(event);
+
         // Handle stick pointer up
         if (action == MotionEvent.ACTION_UP || action == MotionEvent.ACTION_CANCEL) {
             leftStickPointerId = -1;  leftStickX = 0; leftStickY = 0;
@@ -7,42 +7,90 @@
  */
 
 #include "xenia/app/emulator.h"
+#include "xenia/app/save_state.h"
+#include "xenia/apu/apu_system.h"
 #include "xenia/base/logging.h"
 #include "xenia/base/memory/memory.h"
-#include "xenia/base/platform_android.h"
 #include "xenia/base/clock.h"
+#include "xenia/base/cvar.h"
+#include "xenia/base/replay.h"
+#include "xenia/base/timebase.h"
+#include "xenia/base/trace.h"
+#include "xenia/base/verified_cache.h"
+#include "xenia/cpu/guest_profiler.h"
 #include "xenia/cpu/processor.h"
 #include "xenia/cpu/frontend/ppc_interpreter.h"
 #include "xenia/kernel/kernel_state.h"
 #include "xenia/kernel/xmodule.h"
 #include "xenia/kernel/xthread.h"
 #include "xenia/kernel/xex2_loader.h"
+#include "xenia/vfs/virtual_file_system.h"
+#include "xenia/vfs/host_path_device.h"
+#include "xenia/vfs/disc_image_device.h"
+#include "xenia/vfs/compressed_image.h"
+#include "xenia/vfs/stfs_container.h"
+#include "xenia/vfs/svod_container.h"
 #include "xenia/gpu/gpu_command_processor.h"
+#if defined(__ANDROID__)
+#include "xenia/base/platform_android.h"
 #include "xenia/gpu/vulkan/vulkan_instance.h"
 #include "xenia/gpu/vulkan/vulkan_device.h"
 #include "xenia/gpu/vulkan/vulkan_swap_chain.h"
+#endif
 
 // Forward-declare subsystem init/shutdown:
 namespace xe::kernel::xboxkrnl {
   void RegisterAllExports();
-  bool Dispatch(uint32_t ordinal, uint32_t* args);
+  uint32_t Dispatch(uint32_t ordinal, uint32_t* args);
 }
 namespace xe::kernel::xam {
   void RegisterAllExports();
-  bool Dispatch(uint32_t ordinal, uint32_t* args);
+  uint32_t Dispatch(uint32_t ordinal, uint32_t* args);
 }
 namespace xe::hid {
   bool Initialize();
   void Shutdown();
+  void NotePresent();
+  void BeginFrame();
+  void EndFrame();
+  uint64_t TypicalPollOffset();
 }
 
+#if defined(__ANDROID__)
 #include <android/native_window.h>
+#endif
+#include <sys/stat.h>
 #include <fstream>
 #include <cstring>
 #include <algorithm>
+#include <utility>
+#include <vector>
 
 namespace xe {
 
+DEFINE_bool(input_late_latch, true,
+            "Start each frame as late as recent frame times allow, so the "
+            "guest polls fresher input");
+DEFINE_int32(input_late_latch_margin_ms, 3,
+             "Slack kept before the next vsync when starting frames late");
+DEFINE_string(trace_file, "",
+              "Record trace zones from startup and write them to this file "
+              "as Chrome trace JSON at shutdown (builds with VERA360_TRACE)");
+DEFINE_string(guest_profile_file, "",
+              "Sample guest call stacks while a title runs and write them to "
+              "this file as folded stacks at shutdown");
+DEFINE_int32(guest_profile_interval_us, 1000,
+             "Time between guest profiler samples");
+DEFINE_bool(deterministic, false,
+            "Run with guest time counted in executed instructions, a fixed "
+            "thread order and XMA decoded in step with the guest");
+DEFINE_string(replay_record, "",
+              "Deterministic run that logs guest input and file I/O to this "
+              "file");
+DEFINE_string(replay_play, "",
+              "Deterministic run that feeds guest input from this log and "
+              "checks file I/O against it");
+
 Emulator::Emulator() = default;
 Emulator::~Emulator() { Shutdown(); }
 
@@ -50,7 +98,10 @@ bool Emulator::Initialize(ANativeWindow* window, const std::string& storage_root
   storage_root_ = storage_root;
   native_window_ = window;
   XELOGI("=== Vera360 / Xenia Edge ===");
+  StartTrace();
   XELOGI("Initialising emulator... storage={}", storage_root);
+  if (!StartReplay()) return false;
+  VerifiedCache::Get().Open(storage_root + "/verified_hashes.bin");
 
   if (!InitMemory()) return false;
   if (!InitGraphics(window)) return false;
@@ -59,8 +110,8 @@ bool Emulator::Initialize(ANativeWindow* window, const std::string& storage_root
   if (!InitApu()) return false;
   if (!InitHid()) return false;
 
-  // Wire GPU MMIO intercept: PPC writes to GPU register range get forwarded
-  WireGpuMmio();
+  // Wire MMIO intercept: PPC accesses to GPU/APU register ranges get forwarded
+  WireMmio();
 
   running_ = true;
   XELOGI("Emulator initialised OK");
@@ -71,12 +122,16 @@ bool Emulator::InitCore(const std::string& storage_root) {
   storage_root_ = storage_root;
   XELOGI("=== Vera360 / Xenia Edge ===");
   XELOGI("InitCore: storage={}", storage_root);
+  StartTrace();
+  if (!StartReplay()) return false;
+  VerifiedCache::Get().Open(storage_root + "/verified_hashes.bin");
 
   if (!InitMemory()) return false;
   if (!InitCpu()) return false;
   if (!InitKernel()) return false;
   if (!InitApu()) return false;
   if (!InitHid()) return false;
+  WireMmio();
 
   XELOGI("InitCore done — waiting for surface");
   return true;
@@ -89,12 +144,45 @@ bool Emulator::InitGraphicsFromSurface(ANativeWindow* window) {
   if (!InitGraphics(window)) return false;
 
   // Wire GPU MMIO now that GPU is ready
-  WireGpuMmio();
+  WireMmio();
 
   XELOGI("Graphics initialised from surface");
   return true;
 }
 
+void Emulator::StartTrace() {
+  if (cvars.GetValue<std::string>("trace_file", "").empty() ||
+      trace::enabled()) {
+    return;
+  }
+#if defined(XE_TRACE)
+  trace::Start();
+#else
+  XELOGW("trace_file is set, but this build has no trace zones "
+         "(configure with -DVERA360_TRACE=ON)");
+#endif
+}
+
+bool Emulator::StartReplay() {
+  if (replay::deterministic()) return true;
+  std::string play = cvars.GetValue<std::string>("replay_play", "");
+  std::string record = cvars.GetValue<std::string>("replay_record", "");
+  bool started;
+  if (!play.empty()) {
+    started = replay::Start(replay::Mode::kReplay, play);
+  } else if (!record.empty()) {
+    started = replay::Start(replay::Mode::kRecord, record);
+  } else if (cvars.GetValue<bool>("deterministic", false)) {
+    started = replay::Start(replay::Mode::kDeterministic);
+  } else {
+    return true;
+  }
+  if (!started) return false;
+  // Every run starts at the same guest time and counts it in instructions
+  timebase::UseInstructionClock(0);
+  return true;
+}
+
 void Emulator::StartRunning() {
   running_ = true;
   XELOGI("Emulator now running");
@@ -105,8 +193,17 @@ void Emulator::Shutdown() {
   running_ = false;
 
   XELOGI("Shutting down emulator...");
+  // Both hold guest memory through the access hook
+  save_writer_.reset();
+  state_reader_.reset();
   xe::hid::Shutdown();
+  if (apu_system_) {
+    if (kernel_state_) kernel_state_->SetApuSystem(nullptr);
+    apu_system_->Shutdown();
+    apu_system_.reset();
+  }
 
+#if defined(__ANDROID__)
   // Clean up Vulkan rendering resources
   if (vulkan_device_) {
     VkDevice dev = vulkan_device_->GetHandle();
@@ -128,7 +225,16 @@ void Emulator::Shutdown() {
   vulkan_swap_chain_.reset();
   vulkan_device_.reset();
   vulkan_instance_.reset();
+#else
+  gpu_command_processor_.reset();
+#endif
 
+  if (guest_profiler_) {
+    guest_profiler_->Stop();
+    guest_profiler_->WriteFolded(
+        cvars.GetValue<std::string>("guest_profile_file", ""));
+    guest_profiler_.reset();
+  }
   processor_.reset();
 
   if (kernel_state_) {
@@ -137,6 +243,12 @@ void Emulator::Shutdown() {
     kernel_state_ = nullptr;
   }
 
+  if (trace::enabled()) {
+    trace::Stop();
+    trace::WriteChromeTrace(cvars.GetValue<std::string>("trace_file", ""));
+  }
+  if (replay::deterministic()) replay::Stop();
+
   xe::memory::Shutdown();
   XELOGI("Emulator shut down");
 }
@@ -152,9 +264,12 @@ bool Emulator::InitMemory() {
 
 bool Emulator::InitGraphics(ANativeWindow* window) {
   if (!window) {
+    // Null presenter: guest GPU commands are consumed, nothing is drawn
     XELOGW("No ANativeWindow supplied — headless mode");
-    return true;
+    gpu_command_processor_ = std::make_unique<gpu::GpuCommandProcessor>();
+    return gpu_command_processor_->Initialize(nullptr);
   }
+#if defined(__ANDROID__)
   surface_width_ = ANativeWindow_getWidth(window);
   surface_height_ = ANativeWindow_getHeight(window);
   XELOGI("Graphics init: {}x{}", surface_width_, surface_height_);
@@ -196,6 +311,10 @@ bool Emulator::InitGraphics(ANativeWindow* window) {
 
   XELOGI("Vulkan graphics pipeline initialised");
   return true;
+#else
+  XELOGE("No presenter in this build — run headless");
+  return false;
+#endif
 }
 
 bool Emulator::InitCpu() {
@@ -217,6 +336,34 @@ bool Emulator::InitKernel() {
   kernel_state_ = new kernel::KernelState();
   kernel::KernelState::SetShared(kernel_state_);
 
+  // Guest file system: writable host devices for HDD / memory unit, and the
+  // usual aliases for the game device mounted later by LoadGame()
+  auto fs = std::make_unique<vfs::VirtualFileSystem>();
+  fs->Initialize();
+#if defined(__ANDROID__)
+  const std::string data_root = "/sdcard/Vera360";
+#else
+  const std::string data_root = storage_root_;
+#endif
+  const std::pair<const char*, std::string> kHostMounts[] = {
+      {"\\Device\\Harddisk0\\Partition1", data_root + "/HDD"},
+      {"\\Device\\Mu0", data_root + "/MU"},
+  };
+  mkdir(data_root.c_str(), 0777);
+  for (const auto& [mount_path, host_root] : kHostMounts) {
+    mkdir(host_root.c_str(), 0777);
+    auto device = std::make_unique<vfs::HostPathDevice>(mount_path, host_root);
+    if (device->Initialize()) {
+      fs->RegisterDevice(std::move(device));
+    } else {
+      XELOGW("Could not mount {} at {}", host_root, mount_path);
+    }
+  }
+  fs->RegisterSymbolicLink("game:", "\\Device\\CdRom0");
+  fs->RegisterSymbolicLink("d:", "\\Device\\CdRom0");
+  fs->RegisterSymbolicLink("hdd:", "\\Device\\Harddisk0\\Partition1");
+  kernel_state_->SetFileSystem(std::move(fs));
+
   xe::kernel::xboxkrnl::RegisterAllExports();
   xe::kernel::xam::RegisterAllExports();
 
@@ -224,27 +371,33 @@ bool Emulator::InitKernel() {
   if (processor_) {
     processor_->SetKernelDispatch(
       [this](cpu::ThreadState* ts, uint32_t ordinal) {
-        // Build args array from r3-r10 (PPC calling convention)
-        uint32_t args[8];
+        // Build args array from r3-r10 (PPC calling convention); the 9th
+        // and 10th arguments live in the caller's parameter save area
+        uint32_t args[10];
         for (int i = 0; i < 8; ++i) {
           args[i] = static_cast<uint32_t>(ts->gpr[3 + i]);
         }
+        uint32_t sp = static_cast<uint32_t>(ts->gpr[1]);
+        for (int i = 8; i < 10; ++i) {
+          auto* p = static_cast<const uint8_t*>(
+              xe::memory::TranslateVirtual(sp + 0x54 + (i - 8) * 8));
+          args[i] = (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) |
+                    (uint32_t(p[2]) << 8) | p[3];
+        }
 
-        bool handled = false;
+        XE_TRACE_ZONE_VALUE("kernel", "export", ordinal);
+        // Unimplemented exports are logged by Dispatch and return 0
+        uint32_t result;
         if (ordinal & 0x10000) {
           // XAM export (ordinal high bit set by thunk patching)
-          handled = xe::kernel::xam::Dispatch(ordinal & 0xFFFF, args);
+          result = xe::kernel::xam::Dispatch(ordinal & 0xFFFF, args);
         } else {
           // xboxkrnl export
-          handled = xe::kernel::xboxkrnl::Dispatch(ordinal, args);
-        }
-
-        if (!handled) {
-          XELOGW("Unhandled kernel call: ordinal={} (0x{:04X})", ordinal, ordinal);
+          result = xe::kernel::xboxkrnl::Dispatch(ordinal, args);
         }
 
         // Return value goes in r3
-        ts->gpr[3] = args[0];
+        ts->gpr[3] = result;
       });
   }
 
@@ -254,7 +407,15 @@ bool Emulator::InitKernel() {
 }
 
 bool Emulator::InitApu() {
-  XELOGI("APU subsystem init");
+  apu_system_ = std::make_unique<apu::ApuSystem>();
+  apu::XmaDecoderOptions xma_options;
+  if (replay::deterministic()) {
+    // Decoded in RunFrame, between guest slices
+    xma_options.thread_count = 1;
+    xma_options.audio_thread = false;
+  }
+  if (!apu_system_->Initialize(xma_options)) return false;
+  kernel_state_->SetApuSystem(apu_system_.get());
   return true;
 }
 
@@ -262,6 +423,7 @@ bool Emulator::InitHid() {
   return xe::hid::Initialize();
 }
 
+#if defined(__ANDROID__)
 bool Emulator::InitGpuRenderer() {
   VkDevice device = vulkan_device_->GetHandle();
 
@@ -512,6 +674,7 @@ bool Emulator::InitGpuRenderer() {
   XELOGI("GPU renderer initialized (cmd pool + staging buffers + pipeline)");
   return true;
 }
+#endif  // __ANDROID__
 
 bool Emulator::LoadGame(const std::string& path) {
   XELOGI("Loading game: {}", path);
@@ -529,75 +692,126 @@ bool Emulator::LoadGame(const std::string& path) {
   // Read magic
   uint8_t magic[4] = {};
   file.read(reinterpret_cast<char*>(magic), 4);
-  file.seekg(0);
+  file.close();
 
   uint32_t magic32 = (uint32_t(magic[0]) << 24) | (uint32_t(magic[1]) << 16) |
                       (uint32_t(magic[2]) << 8) | magic[3];
 
   bool is_xex = (magic32 == 0x58455832 || magic32 == 0x58455831);
-  bool is_stfs = (magic32 == 0x434F4E20 || magic32 == 0x4C495645 || magic32 == 0x50495253);
-  bool is_iso = false;
-
-  if (!is_xex && !is_stfs) {
-    if (file_size > 0x10004) {
-      file.seekg(0x10000);
-      uint8_t iso_hdr[4];
-      file.read(reinterpret_cast<char*>(iso_hdr), 4);
-      if (iso_hdr[0] == 'M' && iso_hdr[1] == 'I' && iso_hdr[2] == 'C' && iso_hdr[3] == 'R') {
-        is_iso = true;
-      }
-      file.seekg(0);
-    }
-  }
+  bool is_stfs = (magic32 == vfs::kStfsMagicCon ||
+                  magic32 == vfs::kStfsMagicLive ||
+                  magic32 == vfs::kStfsMagicPirs);
+  bool is_iso = !is_xex && !is_stfs && vfs::DiscImageDevice::IsDiscImage(path);
 
   if (is_xex) {
-    return LoadXex(path, file, file_size);
+    return LoadXex(path);
   } else if (is_stfs) {
-    XELOGI("STFS container detected — extracting default.xex...");
+    XELOGI("STFS container detected");
     return LoadStfsPackage(path);
   } else if (is_iso) {
-    XELOGI("ISO disc image detected");
+    XELOGI("{} disc image detected",
+           vfs::CompressedImageSource::IsCompressedImage(magic, sizeof(magic))
+               ? "Compressed"
+               : "ISO");
     return LoadDiscImage(path);
   } else {
     XELOGW("Unknown format (magic=0x{:08X}), trying as XEX", magic32);
-    return LoadXex(path, file, file_size);
+    return LoadXex(path);
   }
 }
 
-bool Emulator::LoadXex(const std::string& path, std::ifstream& file,
-                        std::streampos file_size) {
+bool Emulator::LoadXex(const std::string& path) {
   xe::loader::Xex2Loader loader;
-  file.close();
-
   if (!loader.Load(path)) {
     XELOGE("Failed to parse XEX2 header");
     return false;
   }
 
-  const auto& module = loader.module();
-  XELOGI("XEX2 loaded: entry=0x{:08X}, base=0x{:08X}, image_size=0x{:X}",
-         module.entry_point, module.base_address, module.image_size);
+  // A loose XEX sees its own directory as the disc
+  auto* fs = kernel_state_->file_system();
+  size_t slash = path.find_last_of('/');
+  std::string game_dir = slash == std::string::npos ? "." : path.substr(0, slash);
+  auto device = std::make_unique<vfs::HostPathDevice>(
+      "\\Device\\CdRom0", game_dir, /*read_only=*/true);
+  if (device->Initialize()) {
+    fs->RegisterDevice(std::move(device));
+  } else {
+    XELOGW("Could not mount game directory {}", game_dir);
+  }
 
-  // Map into guest memory
-  uint8_t* guest_base = xe::memory::GetGuestBase();
-  if (guest_base && module.image_size > 0) {
-    xe::memory::Commit(guest_base + module.base_address, module.image_size,
-                       xe::memory::PageAccess::kExecuteReadWrite);
-
-    if (!module.pe_image.empty()) {
-      memcpy(guest_base + module.base_address,
-             module.pe_image.data(),
-             module.pe_image.size());
-      XELOGI("Mapped {} bytes to guest 0x{:08X}",
-             module.pe_image.size(), module.base_address);
+  return LaunchXex(loader, path);
+}
+
+bool Emulator::LaunchFromDevice(std::unique_ptr<vfs::VfsDevice> device,
+                                const std::string& path) {
+  if (!device->Initialize()) {
+    XELOGE("Failed to open game image: {}", path);
+    return false;
+  }
+
+  vfs::VfsEntry* entry = device->ResolvePath("default.xex");
+  if (!entry || entry->is_directory()) {
+    XELOGW("Could not find default.xex in {}", path);
+    return false;
+  }
+
+  auto xex_file = device->OpenFile(entry, vfs::FileAccess::kRead, false);
+  if (!xex_file) {
+    XELOGE("Failed to open default.xex in {}", path);
+    return false;
+  }
+
+  // Memory-mapped images are parsed and decompressed in place; others are
+  // read once into a buffer the loader drops as soon as the image is mapped
+  xe::loader::Xex2Loader loader;
+  bool parsed;
+  if (const uint8_t* xex_data = xex_file->mapped_data()) {
+    XELOGI("default.xex: {} bytes (mapped)", entry->size());
+    parsed = loader.LoadFromMemory(xex_data, static_cast<size_t>(entry->size()));
+  } else {
+    std::vector<uint8_t> xex_buffer(static_cast<size_t>(entry->size()));
+    size_t bytes_read = 0;
+    if (!xex_file->Read(xex_buffer.data(), xex_buffer.size(), 0,
+                        &bytes_read) ||
+        bytes_read != xex_buffer.size()) {
+      XELOGE("Failed to read default.xex from {}", path);
+      return false;
     }
+    XELOGI("default.xex: {} bytes (copied)", entry->size());
+    parsed = loader.LoadFromBuffer(std::move(xex_buffer));
   }
+  if (!parsed) {
+    XELOGE("Failed to parse XEX2 header");
+    return false;
+  }
+  loader.module().path = path;
+  // Hash checks are cached against the container file
+  std::string identity = VerifiedCache::FileIdentity(path);
+  if (!identity.empty()) loader.set_source_identity(identity + "|default.xex");
+
+  kernel_state_->file_system()->RegisterDevice(std::move(device));
+  return LaunchXex(loader, path);
+}
+
+bool Emulator::LaunchXex(xe::loader::Xex2Loader& loader,
+                         const std::string& path) {
+  // Decompress straight into guest memory at the image base
+  uint8_t* guest_base = xe::memory::GetGuestBase();
+  if (!guest_base || !loader.MapIntoMemory(guest_base)) {
+    XELOGE("Failed to map {} into guest memory", path);
+    return false;
+  }
+
+  const auto& module = loader.module();
+  XELOGI("XEX2 loaded: entry=0x{:08X}, base=0x{:08X}, image_size=0x{:X}",
+         module.entry_point, module.base_address, module.image_size);
 
   // Create kernel module object
   auto* xmod = kernel_state_->LoadModule(path);
   xmod->set_base_address(module.base_address);
   xmod->set_entry_point(module.entry_point);
   kernel_state_->SetExecutableModule(xmod);
+  loader.BuildFunctionMap(&xmod->function_map());
 
   // Log imports
   for (auto& lib : module.import_libs) {
@@ -630,235 +844,86 @@ bool Emulator::LoadXex(const std::string& path, std::ifstream& file,
   XELOGI("Main thread created: entry=0x{:08X}, stack=0x{:08X}-0x{:08X}",
          module.entry_point, stack_base, stack_base + kDefaultStackSize);
 
+  if (!cvars.GetValue<std::string>("guest_profile_file", "").empty() &&
+      !guest_profiler_) {
+    guest_profiler_ = std::make_unique<cpu::GuestProfiler>();
+    if (!guest_profiler_->Start(
+            processor_.get(), &xmod->function_map(),
+            uint32_t(std::max(
+                cvars.GetValue<int32_t>("guest_profile_interval_us", 1000),
+                1)))) {
+      guest_profiler_.reset();
+    }
+  }
+
   game_loaded_ = true;
   return true;
 }
 
 bool Emulator::LoadStfsPackage(const std::string& path) {
-  // Open the STFS file and look for default.xex in the file listing
-  std::ifstream file(path, std::ios::binary | std::ios::ate);
-  if (!file.is_open()) return false;
-
-  auto fsize = file.tellg();
-  file.seekg(0);
-
-  // Read entire file into memory for parsing
-  std::vector<uint8_t> data(static_cast<size_t>(fsize));
-  file.read(reinterpret_cast<char*>(data.data()), fsize);
-  file.close();
-
-  // STFS structure:
-  // 0x000: Magic (CON / LIVE / PIRS)
-  // 0x340: Content metadata (title, description, etc.)
-  // 0x379: Content type (4 bytes)
-  // 0x37D: Metadata version
-  // 0x3A0: Title ID
-  // File table at volume descriptor offset
-
-  if (data.size() < 0x1000) {
-    XELOGE("STFS file too small");
-    return false;
-  }
-
-  // Read volume descriptor type at offset 0x379
-  uint8_t vol_desc_type = data[0x379];
-  XELOGD("STFS volume descriptor type: {}", vol_desc_type);
-
-  // Content type at 0x344 (4 bytes, big-endian)
-  uint32_t content_type = (data[0x344] << 24) | (data[0x345] << 16) |
-                           (data[0x346] << 8) | data[0x347];
-  XELOGD("STFS content type: 0x{:08X}", content_type);
-
-  // Title ID at 0x360 (4 bytes, big-endian)
-  uint32_t title_id = (data[0x360] << 24) | (data[0x361] << 16) |
-                       (data[0x362] << 8) | data[0x363];
-  XELOGI("STFS Title ID: {:08X}", title_id);
-
-  // Volume descriptor starts at 0x379
-  // STFS: block size = 0x1000 (4KB)
-  // Hash table at block 0, file table follows
-  // For simplicity: scan for "default.xex" in the file table area
-
-  const char* xex_name = "default.xex";
-  size_t xex_name_len = strlen(xex_name);
-
-  // STFS file table entries are at the beginning of data blocks
-  // Each entry: 0x40 bytes: name (0x28), flags, block count (3 bytes LE),
-  // etc. Scan from 0xC000 onwards for file table entries
-  size_t scan_start = 0xB000;
-  size_t scan_end = std::min(data.size(), static_cast<size_t>(0x20000));
-
-  for (size_t off = scan_start; off + 0x40 <= scan_end; off += 0x40) {
-    // Check for "default.xex" at the entry name field
-    if (memcmp(data.data() + off, xex_name, xex_name_len) == 0 &&
-        data[off + xex_name_len] == 0) {
-      XELOGI("Found default.xex entry in STFS at offset 0x{:X}", off);
-
-      // Read starting block (3 bytes LE at offset +0x2F)
-      uint32_t start_block = data[off + 0x2F] |
-                              (data[off + 0x30] << 8) |
-                              (data[off + 0x31] << 16);
-      uint32_t file_size_stfs = data[off + 0x34] |
-                                (data[off + 0x35] << 8) |
-                                (data[off + 0x36] << 16) |
-                                (data[off + 0x37] << 24);
-
-      XELOGD("STFS default.xex: start_block={}, size={}", start_block, file_size_stfs);
-
-      // Extract the XEX data from STFS blocks
-      // Block data offset = 0xC000 + block * 0x1000
-      constexpr uint32_t kStfsDataStart = 0xC000;
-      constexpr uint32_t kStfsBlockSize = 0x1000;
-
-      std::vector<uint8_t> xex_data;
-      xex_data.reserve(file_size_stfs);
-      uint32_t current_block = start_block;
-      uint32_t remaining = file_size_stfs;
-
-      while (remaining > 0 && current_block != 0xFFFFFF) {
-        uint32_t block_offset = kStfsDataStart + current_block * kStfsBlockSize;
-        if (block_offset + kStfsBlockSize > data.size()) break;
-
-        uint32_t to_copy = std::min(remaining, kStfsBlockSize);
-        xex_data.insert(xex_data.end(),
-                        data.data() + block_offset,
-                        data.data() + block_offset + to_copy);
-        remaining -= to_copy;
-        current_block++;  // Simplified: assume sequential blocks
-      }
-
-      if (xex_data.size() >= 4) {
-        // Save extracted XEX to temp file and load
-        std::string temp_path = storage_root_ + "/temp_default.xex";
-        std::ofstream out(temp_path, std::ios::binary);
-        if (out.is_open()) {
-          out.write(reinterpret_cast<const char*>(xex_data.data()), xex_data.size());
-          out.close();
-          XELOGI("Extracted default.xex ({} bytes)", xex_data.size());
-
-          std::ifstream xex_file(temp_path, std::ios::binary | std::ios::ate);
-          auto xex_size = xex_file.tellg();
-          xex_file.seekg(0);
-          return LoadXex(temp_path, xex_file, xex_size);
-        }
-      }
-      break;
-    }
+  // Games on Demand use the same header with a GDF (SVOD) volume
+  if (vfs::SvodContainerDevice::IsSvodPackage(path)) {
+    auto device = std::make_unique<vfs::SvodContainerDevice>(
+        "\\Device\\CdRom0", path);
+    XELOGI("Mounting SVOD package: {}", path);
+    return LaunchFromDevice(std::move(device), path);
   }
-
-  XELOGW("Could not find default.xex in STFS package");
-  return false;
+  auto device = std::make_unique<vfs::StfsContainerDevice>(
+      "\\Device\\CdRom0", path);
+  XELOGI("Mounting STFS package: {}", path);
+  return LaunchFromDevice(std::move(device), path);
 }
 
 bool Emulator::LoadDiscImage(const std::string& path) {
-  // XISO (Xbox ISO) format:
-  // Sector 32 (0x10000): "MICROSOFT*XBOX*MEDIA" magic
-  // Root directory table follows the volume descriptor
-  std::ifstream file(path, std::ios::binary | std::ios::ate);
-  if (!file.is_open()) return false;
-
-  auto fsize = file.tellg();
-  file.seekg(0);
-
-  // Read the volume descriptor at sector 32
-  constexpr uint32_t kSectorSize = 0x800;
-  constexpr uint64_t kRootSector = 32;
-  constexpr uint64_t kVolumeDescOffset = kRootSector * kSectorSize;
-
-  if (static_cast<uint64_t>(fsize) < kVolumeDescOffset + 0x24) {
-    XELOGE("ISO too small for XISO header");
-    return false;
-  }
-
-  file.seekg(kVolumeDescOffset);
-  uint8_t vol_hdr[0x24];
-  file.read(reinterpret_cast<char*>(vol_hdr), 0x24);
-
-  // Verify magic: "MICROSOFT*XBOX*MEDIA"
-  if (memcmp(vol_hdr, "MICROSOFT*XBOX*MEDIA", 20) != 0) {
-    XELOGE("Not a valid XISO image");
-    return false;
-  }
-
-  // Root directory entry at offset 0x14 in the volume descriptor:
-  // 4 bytes LE: root dir table sector
-  // 4 bytes LE: root dir table size
-  uint32_t root_sector = vol_hdr[0x14] | (vol_hdr[0x15] << 8) |
-                          (vol_hdr[0x16] << 16) | (vol_hdr[0x17] << 24);
-  uint32_t root_size = vol_hdr[0x18] | (vol_hdr[0x19] << 8) |
-                        (vol_hdr[0x1A] << 16) | (vol_hdr[0x1B] << 24);
-
-  XELOGD("XISO root dir: sector={}, size={}", root_sector, root_size);
+  auto device = std::make_unique<vfs::DiscImageDevice>(
+      "\\Device\\CdRom0", path);
+  XELOGI("Mounting disc image: {}", path);
+  return LaunchFromDevice(std::move(device), path);
+}
 
-  // Read root directory table
-  uint64_t root_offset = static_cast<uint64_t>(root_sector) * kSectorSize;
-  if (static_cast<uint64_t>(fsize) < root_offset + root_size) {
-    XELOGE("ISO truncated at root directory");
-    return false;
-  }
+void Emulator::Tick() {
+  if (game_loaded_) ServiceSaveStates();
+  if (!running_ || !game_loaded_) return;
 
-  std::vector<uint8_t> root_data(root_size);
-  file.seekg(root_offset);
-  file.read(reinterpret_cast<char*>(root_data.data()), root_size);
-
-  // Scan directory entries for "default.xex"
-  // Each entry: left_offset(2), right_offset(2), sector(4), size(4),
-  //             attributes(1), name_len(1), name(variable)
-  for (size_t off = 0; off + 14 <= root_data.size();) {
-    uint16_t left = root_data[off] | (root_data[off + 1] << 8);
-    uint16_t right = root_data[off + 2] | (root_data[off + 3] << 8);
-    uint32_t sector = root_data[off + 4] | (root_data[off + 5] << 8) |
-                      (root_data[off + 6] << 16) | (root_data[off + 7] << 24);
-    uint32_t size = root_data[off + 8] | (root_data[off + 9] << 8) |
-                    (root_data[off + 10] << 16) | (root_data[off + 11] << 24);
-    uint8_t attrib = root_data[off + 12];
-    uint8_t name_len = root_data[off + 13];
-
-    if (name_len == 0 || off + 14 + name_len > root_data.size()) break;
-
-    std::string name(reinterpret_cast<const char*>(root_data.data() + off + 14),
-                      name_len);
-
-    XELOGD("XISO entry: {} sector={} size={}", name, sector, size);
-
-    if (name == "default.xex" && size > 0) {
-      // Extract and load
-      uint64_t xex_offset = static_cast<uint64_t>(sector) * kSectorSize;
-      if (static_cast<uint64_t>(fsize) < xex_offset + size) {
-        XELOGE("ISO truncated at default.xex data");
-        return false;
-      }
+  XE_TRACE_ZONE("frame", "Tick");
+  uint64_t start = Clock::QueryHostTickCount();
+  frame_stats_ = {};
+  xe::hid::BeginFrame();
+  RunFrame();
+  xe::hid::EndFrame();
+  frame_stats_.total_ns = Clock::QueryHostTickCount() - start;
+  frame_work_ns_[frame_count_ % kFrameWorkWindow] = frame_stats_.total_ns;
+  XE_TRACE_COUNTER("instructions", frame_stats_.instructions);
+}
 
-      std::vector<uint8_t> xex_data(size);
-      file.seekg(xex_offset);
-      file.read(reinterpret_cast<char*>(xex_data.data()), size);
-
-      // Save to temp and load
-      std::string temp_path = storage_root_ + "/temp_default.xex";
-      std::ofstream out(temp_path, std::ios::binary);
-      out.write(reinterpret_cast<const char*>(xex_data.data()), xex_data.size());
-      out.close();
-
-      XELOGI("Extracted default.xex from ISO ({} bytes)", size);
-      std::ifstream xex_file(temp_path, std::ios::binary | std::ios::ate);
-      auto xex_size = xex_file.tellg();
-      xex_file.seekg(0);
-      return LoadXex(temp_path, xex_file, xex_size);
+uint64_t Emulator::TickDelayNanos(uint64_t vsync_ns) {
+  // Display period from consecutive vsyncs, smoothed
+  if (last_vsync_ns_ && vsync_ns > last_vsync_ns_) {
+    uint64_t period = vsync_ns - last_vsync_ns_;
+    if (period < kMaxFramePeriodNs) {
+      frame_period_ns_ =
+          frame_period_ns_ ? (frame_period_ns_ * 7 + period) / 8 : period;
     }
-
-    // Move to next entry (aligned to 4 bytes)
-    off += 14 + name_len;
-    off = (off + 3) & ~3u;
   }
-
-  XELOGW("Could not find default.xex in ISO image");
-  file.close();
-  return false;
+  last_vsync_ns_ = vsync_ns;
+
+  // Only worth it while the title samples input, and once frame costs are
+  // known; the slowest recent frame bounds how late this one may start
+  if (!running_ || !game_loaded_ || !frame_period_ns_ ||
+      frame_count_ < kFrameWorkWindow ||
+      !cvars.GetValue<bool>("input_late_latch", true) ||
+      !xe::hid::TypicalPollOffset()) {
+    return 0;
+  }
+  uint64_t work = *std::max_element(frame_work_ns_.begin(),
+                                    frame_work_ns_.end());
+  uint64_t margin = uint64_t(std::max(
+      cvars.GetValue<int32_t>("input_late_latch_margin_ms", 3), 0)) * 1000000;
+  if (work + margin >= frame_period_ns_) return 0;
+  return std::min(frame_period_ns_ - work - margin, frame_period_ns_ * 3 / 4);
 }
 
-void Emulator::Tick() {
-  if (!running_ || !game_loaded_) return;
-
+void Emulator::RunFrame() {
   frame_count_++;
 
   // ── Step 1: Check if all threads terminated ────────────────────────
@@ -873,6 +938,9 @@ void Emulator::Tick() {
   }
 
   // ── Step 2: Execute PPC instructions (round-robin scheduler) ────────
+  // Deterministic runs also keep every guest-visible effect on this thread
+  bool deterministic = replay::deterministic();
+  uint64_t step_start = Clock::QueryHostTickCount();
   if (processor_ && kernel_state_) {
     const auto& threads = kernel_state_->GetAllThreads();
     size_t thread_count = threads.size();
@@ -892,35 +960,63 @@ void Emulator::Tick() {
         kernel_state_->SetCurrentThread(thread);
         auto* cpu_thread = processor_->CreateThreadState(thread->thread_id());
         if (cpu_thread && cpu_thread->running) {
-          processor_->ExecuteBounded(cpu_thread, cpu_thread->pc, instructions_per_thread);
+          uint64_t executed = processor_->ExecuteBounded(
+              cpu_thread, cpu_thread->pc, instructions_per_thread);
+          frame_stats_.instructions += executed;
+          if (deterministic) timebase::AdvanceInstructions(executed);
         }
       }
       // Advance the round-robin start for next frame
       kernel_state_->set_current_thread_index((start_idx + 1) % thread_count);
     }
   }
+  if (deterministic && apu_system_) {
+    apu_system_->xma_decoder().DecodePeriod();
+  }
+
+  uint64_t step_end = Clock::QueryHostTickCount();
+  frame_stats_.cpu_ns = step_end - step_start;
 
   // ── Step 2: Process GPU command buffer ────────────────────────────────
+  step_start = step_end;
   if (gpu_command_processor_) {
     gpu_command_processor_->ProcessPendingCommands();
   }
+  step_end = Clock::QueryHostTickCount();
+  frame_stats_.gpu_ns = step_end - step_start;
 
   // ── Step 3: Render frame via Vulkan ───────────────────────────────────
+#if defined(__ANDROID__)
+  step_start = step_end;
   if (vulkan_swap_chain_ && vulkan_device_ && vk_cmd_buffer_) {
     uint32_t image_index = 0;
-    if (vulkan_swap_chain_->AcquireNextImage(&image_index)) {
+    bool acquired;
+    {
+      XE_TRACE_ZONE("present", "AcquireNextImage");
+      acquired = vulkan_swap_chain_->AcquireNextImage(&image_index);
+    }
+    if (acquired) {
       RenderFrame(image_index);
-      vulkan_swap_chain_->Present(image_index);
+      {
+        XE_TRACE_ZONE("present", "Present");
+        vulkan_swap_chain_->Present(image_index);
+      }
+      xe::hid::NotePresent();
     }
   }
+  frame_stats_.present_ns = Clock::QueryHostTickCount() - step_start;
+#endif
 
   // Clear draw calls for next frame
   if (gpu_command_processor_) {
+    XE_TRACE_COUNTER("draws", gpu_command_processor_->GetDrawCalls().size());
     gpu_command_processor_->ClearDrawCalls();
   }
 }
 
+#if defined(__ANDROID__)
 void Emulator::RenderFrame(uint32_t image_index) {
+  XE_TRACE_ZONE("present", "RenderFrame");
   VkDevice device = vulkan_device_->GetHandle();
   VkRenderPass render_pass = vulkan_swap_chain_->GetRenderPass();
   VkFramebuffer framebuffer = vulkan_swap_chain_->GetFramebuffer(image_index);
@@ -1002,11 +1098,7 @@ void Emulator::RenderFrame(uint32_t image_index) {
 
         // Byte-swap each 32-bit word (big-endian → little-endian)
         uint32_t words = vertex_data_size / 4;
-        const uint32_t* src32 = reinterpret_cast<const uint32_t*>(src);
-        uint32_t* dst32 = reinterpret_cast<uint32_t*>(dst);
-        for (uint32_t w = 0; w < words; w++) {
-          dst32[w] = __builtin_bswap32(src32[w]);
-        }
+        xe::memory::CopyAndSwap32(dst, src, words);
         // Copy any remainder bytes
         uint32_t remainder = vertex_data_size % 4;
         if (remainder) {
@@ -1025,15 +1117,9 @@ void Emulator::RenderFrame(uint32_t image_index) {
           const uint8_t* isrc = guest_base + dc.index_base_addr;
           uint8_t* idst = ib_map + ib_offset;
           if (idx_elem_size == 4) {
-            uint32_t cnt = dc.num_indices;
-            const uint32_t* s32 = reinterpret_cast<const uint32_t*>(isrc);
-            uint32_t* d32 = reinterpret_cast<uint32_t*>(idst);
-            for (uint32_t i = 0; i < cnt; i++) d32[i] = __builtin_bswap32(s32[i]);
+            xe::memory::CopyAndSwap32(idst, isrc, dc.num_indices);
           } else {
-            uint32_t cnt = dc.num_indices;
-            const uint16_t* s16 = reinterpret_cast<const uint16_t*>(isrc);
-            uint16_t* d16 = reinterpret_cast<uint16_t*>(idst);
-            for (uint32_t i = 0; i < cnt; i++) d16[i] = __builtin_bswap16(s16[i]);
+            xe::memory::CopyAndSwap16(idst, isrc, dc.num_indices);
           }
         } else {
           is_indexed = false;
@@ -1060,6 +1146,7 @@ void Emulator::RenderFrame(uint32_t image_index) {
 
     vkUnmapMemory(device, vk_staging_vb_mem_);
     vkUnmapMemory(device, vk_staging_ib_mem_);
+    XE_TRACE_COUNTER("upload_bytes", vb_offset + ib_offset);
 
     if (draws_submitted > 0) {
       XELOGD("Frame {}: submitted {} draw calls ({} vertices)",
@@ -1087,9 +1174,125 @@ void Emulator::RenderFrame(uint32_t image_index) {
   submit.signalSemaphoreCount = 1;
   submit.pSignalSemaphores = signal_sems;
 
+  XE_TRACE_ZONE("present", "vkQueueSubmit");
   vkQueueSubmit(vulkan_device_->GetGraphicsQueue(), 1, &submit,
                 vulkan_swap_chain_->GetInFlightFence());
 }
+#endif  // __ANDROID__
+
+// ── Save states ─────────────────────────────────────────────────────────────
+
+namespace {
+constexpr uint32_t kSectionCpu = StateTag("CPU ");
+constexpr uint32_t kSectionKernel = StateTag("KRNL");
+constexpr uint32_t kSectionGpu = StateTag("GPU ");
+constexpr uint32_t kSectionClock = StateTag("CLK ");
+}
+
+void Emulator::RequestSaveState(const std::string& path) {
+  std::lock_guard<std::mutex> lock(state_request_mutex_);
+  pending_save_path_ = path;
+}
+
+void Emulator::RequestLoadState(const std::string& path) {
+  std::lock_guard<std::mutex> lock(state_request_mutex_);
+  pending_load_path_ = path;
+}
+
+void Emulator::ServiceSaveStates() {
+  if (save_writer_ && save_writer_->done()) save_writer_.reset();
+  if (state_reader_ && state_reader_->memory_complete()) {
+    if (state_reader_->memory_failed()) {
+      XELOGE("Load state: some memory blocks were corrupt and are zeroed");
+    }
+    state_reader_.reset();
+  }
+
+  std::string save_path, load_path;
+  {
+    std::lock_guard<std::mutex> lock(state_request_mutex_);
+    save_path.swap(pending_save_path_);
+    load_path.swap(pending_load_path_);
+  }
+  if (!save_path.empty()) SaveState(save_path);
+  if (!load_path.empty()) LoadState(load_path);
+}
+
+bool Emulator::SaveState(const std::string& path) {
+  if (!processor_ || !kernel_state_) return false;
+  // One snapshot or restore at a time: finish the previous one first
+  save_writer_.reset();
+  state_reader_.reset();
+
+  StateWriter writer;
+  size_t section = writer.BeginSection(kSectionCpu);
+  processor_->SaveState(writer);
+  writer.EndSection(section);
+  section = writer.BeginSection(kSectionKernel);
+  kernel_state_->SaveState(writer);
+  writer.EndSection(section);
+  if (gpu_command_processor_) {
+    section = writer.BeginSection(kSectionGpu);
+    gpu_command_processor_->SaveState(writer);
+    writer.EndSection(section);
+  }
+  section = writer.BeginSection(kSectionClock);
+  writer.Write(Clock::QueryGuestTickCount());
+  writer.EndSection(section);
+
+  save_writer_ = SaveStateWriter::Start(path, writer.Take());
+  return save_writer_ != nullptr;
+}
+
+bool Emulator::LoadState(const std::string& path) {
+  if (!processor_ || !kernel_state_) return false;
+  save_writer_.reset();
+  state_reader_.reset();
+
+  auto reader = SaveStateReader::Open(path);
+  if (!reader) return false;
+  StateReader machine = reader->machine_state();
+  StateReader cpu(nullptr, 0), kernel(nullptr, 0), gpu(nullptr, 0),
+      clock(nullptr, 0);
+  bool has_cpu = false, has_kernel = false, has_gpu = false, has_clock = false;
+  while (machine.remaining()) {
+    uint32_t tag = 0;
+    StateReader section(nullptr, 0);
+    if (!machine.NextSection(&tag, &section)) break;
+    if (tag == kSectionCpu) { cpu = section; has_cpu = true; }
+    if (tag == kSectionKernel) { kernel = section; has_kernel = true; }
+    if (tag == kSectionGpu) { gpu = section; has_gpu = true; }
+    if (tag == kSectionClock) { clock = section; has_clock = true; }
+  }
+  if (!machine.ok() || !has_cpu || !has_kernel || !has_clock) {
+    XELOGE("Load state: {} is missing machine state", path);
+    return false;
+  }
+
+  // The kernel checks its whole section before changing anything; past
+  // that point a failure leaves the machine half restored, so stop it
+  uint64_t start_ns = Clock::QueryHostTickCount();
+  if (!kernel_state_->RestoreState(kernel)) {
+    XELOGE("Load state: {} could not be applied", path);
+    return false;
+  }
+  uint64_t guest_ticks = 0;
+  bool ok = reader->BeginMemoryRestore() && processor_->RestoreState(cpu) &&
+            clock.Read(&guest_ticks);
+  if (ok && has_gpu && gpu_command_processor_) {
+    ok = gpu_command_processor_->RestoreState(gpu);
+  }
+  if (!ok) {
+    XELOGE("Load state: {} is corrupt; emulation stopped", path);
+    running_ = false;
+    return false;
+  }
+  Clock::SetGuestTickCount(guest_ticks);
+  state_reader_ = std::move(reader);
+  XELOGI("Load state: {} restored in {} us (memory pages in on demand)",
+         path, (Clock::QueryHostTickCount() - start_ns) / 1000);
+  return true;
+}
 
 void Emulator::Pause() {
   running_ = false;
@@ -1109,34 +1312,43 @@ void Emulator::OnSurfaceChanged(ANativeWindow* window, int width, int height) {
   surface_height_ = height;
   XELOGI("Surface changed: {}x{}", width, height);
 
+#if defined(__ANDROID__)
   if (vulkan_swap_chain_) {
     vulkan_swap_chain_->Recreate(static_cast<uint32_t>(width),
                                   static_cast<uint32_t>(height));
   }
+#endif
 }
 
 void Emulator::OnSurfaceDestroyed() {
   XELOGI("Surface destroyed");
   native_window_ = nullptr;
+#if defined(__ANDROID__)
   vulkan_swap_chain_.reset();
+#endif
 }
 
-void Emulator::WireGpuMmio() {
-  if (processor_ && gpu_command_processor_) {
-    auto* interp = processor_->GetInterpreter();
-    if (interp) {
-      auto* gpu = gpu_command_processor_.get();
-      interp->SetMmioHandlers(
-        [gpu](uint32_t addr, uint32_t value) -> bool {
-          return gpu->HandleMmioWrite(addr, value);
-        },
-        [gpu](uint32_t addr) -> uint32_t {
-          return gpu->HandleMmioRead(addr);
-        }
-      );
-      XELOGI("GPU MMIO intercept wired to PPC interpreter");
+void Emulator::WireMmio() {
+  auto* interp = processor_ ? processor_->GetInterpreter() : nullptr;
+  if (!interp) return;
+  auto* gpu = gpu_command_processor_.get();
+  auto* apu = apu_system_.get();
+  interp->SetMmioHandlers(
+    [gpu, apu](uint32_t addr, uint32_t value) -> bool {
+      if (apu && apu::XmaDecoder::IsMmio(addr)) {
+        return apu->HandleMmioWrite(addr, value);
+      }
+      return gpu && gpu->HandleMmioWrite(addr, value);
+    },
+    [gpu, apu](uint32_t addr) -> uint32_t {
+      if (apu && apu::XmaDecoder::IsMmio(addr)) {
+        return apu->HandleMmioRead(addr);
+      }
+      return gpu ? gpu->HandleMmioRead(addr) : 0;
     }
-  }
+  );
+  XELOGI("MMIO intercept wired to PPC interpreter (GPU {}, APU {})",
+         gpu ? "on" : "off", apu ? "on" : "off");
 }
 
 }  // namespace xe
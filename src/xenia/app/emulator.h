@@ -4,23 +4,32 @@
  *
  * Owns and initialises every subsystem, loads an XEX, and runs the
  * main emulation loop with Vulkan rendering and PPC interpretation.
+ * Without a window (and always in the Linux host build, which has no
+ * Vulkan presenter) it runs headless: GPU commands are still processed,
+ * nothing is drawn.
  */
 #pragma once
 
+#include <array>
 #include <cstdint>
-#include <fstream>
 #include <memory>
+#include <mutex>
 #include <string>
 
+#if defined(__ANDROID__)
 #ifndef VK_USE_PLATFORM_ANDROID_KHR
 #define VK_USE_PLATFORM_ANDROID_KHR
 #endif
 #include <vulkan/vulkan.h>
+#endif
 
 struct ANativeWindow;
 
-namespace xe::cpu { class Processor; }
+namespace xe::apu { class ApuSystem; }
+namespace xe::cpu { class GuestProfiler; class Processor; }
 namespace xe::kernel { class KernelState; }
+namespace xe::loader { class Xex2Loader; }
+namespace xe::vfs { class VfsDevice; }
 namespace xe::gpu {
   class GpuCommandProcessor;
   namespace vulkan {
@@ -36,6 +45,9 @@ namespace xe::gpu {
 
 namespace xe {
 
+class SaveStateReader;
+class SaveStateWriter;
+
 class Emulator {
  public:
   Emulator();
@@ -61,6 +73,11 @@ class Emulator {
 
   /// Frame tick — called from the render loop
   void Tick();
+  /// How long to hold off the tick for the vsync at vsync_ns (late
+  /// latching): the frame then starts as late as the slowest recent frame
+  /// allows, and the guest polls input that arrived meanwhile. The caller
+  /// must keep delivering input while it waits.
+  uint64_t TickDelayNanos(uint64_t vsync_ns);
 
   /// Pause / resume
   void Pause();
@@ -69,6 +86,23 @@ class Emulator {
   bool is_game_loaded() const { return game_loaded_; }
   uint64_t frame_count() const { return frame_count_; }
 
+  /// Where the last tick's time went
+  struct FrameStats {
+    uint64_t instructions = 0;  // guest instructions executed
+    uint64_t cpu_ns = 0;        // guest execution
+    uint64_t gpu_ns = 0;        // command processing
+    uint64_t present_ns = 0;    // rendering and present
+    uint64_t total_ns = 0;      // the whole tick
+  };
+  const FrameStats& last_frame_stats() const { return frame_stats_; }
+
+  /// Save states (any thread). Carried out between ticks: a save pauses
+  /// the guest only to write-protect its memory and the file is written
+  /// in the background; a load maps the file and continues at once, with
+  /// guest pages faulting in on first touch.
+  void RequestSaveState(const std::string& path);
+  void RequestLoadState(const std::string& path);
+
   /// Surface change (e.g., orientation)
   void OnSurfaceChanged(ANativeWindow* window, int width, int height);
   void OnSurfaceDestroyed();
@@ -77,6 +111,7 @@ class Emulator {
   gpu::GpuCommandProcessor* gpu_command_processor() {
     return gpu_command_processor_.get();
   }
+  apu::ApuSystem* apu_system() { return apu_system_.get(); }
 
  private:
   bool InitMemory();
@@ -85,38 +120,80 @@ class Emulator {
   bool InitKernel();
   bool InitApu();
   bool InitHid();
+#if defined(__ANDROID__)
   bool InitGpuRenderer();
+#endif
+  /// Starts recording trace zones when trace_file is set
+  void StartTrace();
+  /// Enters deterministic, record or replay mode from the replay cvars;
+  /// false if a log cannot be opened
+  bool StartReplay();
 
-  /// Wire GPU MMIO intercept to PPC interpreter
-  void WireGpuMmio();
+  /// Wire GPU and APU MMIO intercepts to the PPC interpreter
+  void WireMmio();
 
   /// Kernel HLE dispatch — called when guest executes sc
   void DispatchKernelCall(uint32_t ordinal, void* thread_state);
 
   /// Game loading helpers
-  bool LoadXex(const std::string& path, std::ifstream& file,
-               std::streampos file_size);
+  bool LoadXex(const std::string& path);
   bool LoadStfsPackage(const std::string& path);
   bool LoadDiscImage(const std::string& path);
 
+  /// Mount a game device at \Device\CdRom0 and boot its default.xex
+  bool LaunchFromDevice(std::unique_ptr<vfs::VfsDevice> device,
+                        const std::string& path);
+
+  /// Map a parsed XEX, resolve imports and create the main thread
+  bool LaunchXex(loader::Xex2Loader& loader, const std::string& path);
+
+  /// One frame of guest execution, GPU processing and presentation
+  void RunFrame();
+#if defined(__ANDROID__)
   /// Render all GPU draw calls for this frame to the swap chain
   void RenderFrame(uint32_t image_index);
+#endif
+
+  /// Run queued save-state requests and retire finished ones (Tick thread)
+  void ServiceSaveStates();
+  bool SaveState(const std::string& path);
+  bool LoadState(const std::string& path);
 
   bool running_ = false;
   bool game_loaded_ = false;
   uint64_t frame_count_ = 0;
   std::string storage_root_;
+
+  // Late latching (Tick thread): display period and recent frame costs
+  static constexpr size_t kFrameWorkWindow = 32;
+  /// Longer vsync gaps are pauses, not the display period
+  static constexpr uint64_t kMaxFramePeriodNs = 100000000;
+  uint64_t last_vsync_ns_ = 0;
+  uint64_t frame_period_ns_ = 0;
+  std::array<uint64_t, kFrameWorkWindow> frame_work_ns_ = {};
+  FrameStats frame_stats_;
   int surface_width_ = 0;
   int surface_height_ = 0;
 
+  // Save states
+  std::mutex state_request_mutex_;
+  std::string pending_save_path_;
+  std::string pending_load_path_;
+  std::unique_ptr<SaveStateWriter> save_writer_;
+  std::unique_ptr<SaveStateReader> state_reader_;
+
   // Subsystems
   std::unique_ptr<cpu::Processor> processor_;
+  std::unique_ptr<cpu::GuestProfiler> guest_profiler_;
+  std::unique_ptr<apu::ApuSystem> apu_system_;
   kernel::KernelState* kernel_state_ = nullptr;
+  std::unique_ptr<gpu::GpuCommandProcessor> gpu_command_processor_;
+  ANativeWindow* native_window_ = nullptr;
+
+#if defined(__ANDROID__)
   std::unique_ptr<gpu::vulkan::VulkanInstance> vulkan_instance_;
   std::unique_ptr<gpu::vulkan::VulkanDevice> vulkan_device_;
   std::unique_ptr<gpu::vulkan::VulkanSwapChain> vulkan_swap_chain_;
-  std::unique_ptr<gpu::GpuCommandProcessor> gpu_command_processor_;
-  ANativeWindow* native_window_ = nullptr;
 
   // Vulkan rendering resources
   VkCommandPool vk_cmd_pool_ = VK_NULL_HANDLE;
@@ -134,6 +211,7 @@ class Emulator {
   VkBuffer vk_staging_ib_ = VK_NULL_HANDLE;
   VkDeviceMemory vk_staging_ib_mem_ = VK_NULL_HANDLE;
   static constexpr uint32_t kStagingBufferSize = 4 * 1024 * 1024; // 4MB each
+#endif  // __ANDROID__
 
   /// Instructions executed per tick (budget per frame ~16ms)
   static constexpr uint64_t kInstructionsPerTick = 500000;
@@ -169,6 +169,37 @@ Java_com_vera360_ax360e_NativeBridge_tick(
   if (g_emulator) g_emulator->Tick();
 }
 
+// Java: public static native long tickDelayNanos(long frameTimeNanos);
+JNIEXPORT jlong JNICALL
+Java_com_vera360_ax360e_NativeBridge_tickDelayNanos(
+    JNIEnv* /*env*/, jclass /*clazz*/, jlong frameTimeNanos) {
+  if (!g_emulator) return 0;
+  return static_cast<jlong>(
+      g_emulator->TickDelayNanos(static_cast<uint64_t>(frameTimeNanos)));
+}
+
+// ──────────────────────────── Save states ─────────────────────────
+
+// Java: public static native void saveState(String path);
+JNIEXPORT void JNICALL
+Java_com_vera360_ax360e_NativeBridge_saveState(
+    JNIEnv* env, jclass /*clazz*/, jstring path) {
+  const char* p = env->GetStringUTFChars(path, nullptr);
+  XELOGI("JNI: saveState({})", p);
+  if (g_emulator) g_emulator->RequestSaveState(p);
+  env->ReleaseStringUTFChars(path, p);
+}
+
+// Java: public static native void loadState(String path);
+JNIEXPORT void JNICALL
+Java_com_vera360_ax360e_NativeBridge_loadState(
+    JNIEnv* env, jclass /*clazz*/, jstring path) {
+  const char* p = env->GetStringUTFChars(path, nullptr);
+  XELOGI("JNI: loadState({})", p);
+  if (g_emulator) g_emulator->RequestLoadState(p);
+  env->ReleaseStringUTFChars(path, p);
+}
+
 // ──────────────────────── Hardware queries ────────────────────────
 
 // Java: public static native boolean isVulkanAvailable();
@@ -246,11 +277,8 @@ Java_com_vera360_ax360e_NativeBridge_onControllerInput(
   // Translate Java button mask to XINPUT and apply as full state
   uint16_t xinput_buttons = TranslateButtons(buttonMask);
 
-  // Set all buttons at once (pad 0)
-  xe::hid::SetButtonsRaw(0, xinput_buttons);
-  // Set analog sticks
-  xe::hid::SetAnalog(0, true, lx, ly);
-  xe::hid::SetAnalog(0, false, rx, ry);
+  // Buttons and sticks in one update (pad 0), so a poll never mixes two
+  xe::hid::SetControllerState(0, xinput_buttons, lx, ly, rx, ry);
 }
 
 // Java: public static native void onTouchEvent(
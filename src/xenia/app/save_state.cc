@@ -0,0 +1,305 @@
+/**
+ * Vera360 — Xenia Edge
+ * Save-state file writer / reader
+ */
+
+#include "xenia/app/save_state.h"
+#include "xenia/base/clock.h"
+#include "xenia/base/logging.h"
+#include "xenia/base/lz4.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace xe {
+
+namespace {
+
+constexpr char kMagic[8] = {'V', 'E', 'R', 'A', 'S', 'A', 'V', 'E'};
+constexpr uint32_t kVersion = 2;  // 2: file handles moved into the kernel table
+constexpr uint32_t kBlockSize = 64 * 1024;
+constexpr uint64_t kDataAlignment = 4096;
+constexpr uint32_t kMaxWorkers = 4;
+
+struct FileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t block_size;
+  uint64_t machine_offset;
+  uint64_t machine_size;
+  uint64_t table_offset;
+  uint64_t block_count;
+  uint64_t guest_bytes;
+};
+
+struct FileBlock {
+  uint32_t address;
+  uint32_t size;
+  uint32_t access;       // memory::PageAccess
+  uint32_t stored_size;  // 0 = all zero, size = raw, otherwise LZ4
+  uint64_t offset;
+};
+
+bool WriteAll(int fd, const void* data, size_t size, uint64_t offset) {
+  auto* p = static_cast<const uint8_t*>(data);
+  while (size) {
+    ssize_t n = pwrite(fd, p, size, static_cast<off_t>(offset));
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) return false;
+    p += n;
+    size -= static_cast<size_t>(n);
+    offset += static_cast<uint64_t>(n);
+  }
+  return true;
+}
+
+bool IsAllZero(const uint8_t* data, size_t size) {
+  uint64_t acc = 0;
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    uint64_t word;
+    memcpy(&word, data + i, sizeof(word));
+    acc |= word;
+  }
+  for (; i < size; ++i) acc |= data[i];
+  return acc == 0;
+}
+
+uint32_t WorkerCount() {
+  long cores = sysconf(_SC_NPROCESSORS_ONLN);
+  // Leave a core for the guest; the snapshot is never on its critical path
+  long workers = cores > 1 ? cores - 1 : 1;
+  return static_cast<uint32_t>(std::min<long>(workers, kMaxWorkers));
+}
+
+}  // namespace
+
+// ── SaveStateWriter ─────────────────────────────────────────────────────────
+
+std::unique_ptr<SaveStateWriter> SaveStateWriter::Start(
+    const std::string& path, std::vector<uint8_t> machine_state) {
+  std::unique_ptr<SaveStateWriter> writer(new SaveStateWriter());
+  writer->path_ = path;
+  writer->start_ns_ = Clock::QueryHostTickCount();
+  writer->fd_ = open((path + ".tmp").c_str(),
+                     O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (writer->fd_ < 0) {
+    XELOGE("Save state: cannot create {}.tmp: {}", path, strerror(errno));
+    return nullptr;
+  }
+
+  writer->snapshot_ = memory::GuestSnapshot::Capture(kBlockSize);
+  if (!writer->snapshot_) {
+    close(writer->fd_);
+    unlink((path + ".tmp").c_str());
+    return nullptr;
+  }
+  uint64_t pause_ns = Clock::QueryHostTickCount() - writer->start_ns_;
+
+  writer->machine_state_ = std::move(machine_state);
+  writer->table_.resize(writer->snapshot_->blocks().size() * sizeof(FileBlock));
+  uint64_t data_start = sizeof(FileHeader) + writer->machine_state_.size();
+  data_start = (data_start + kDataAlignment - 1) & ~(kDataAlignment - 1);
+  writer->next_offset_.store(data_start, std::memory_order_relaxed);
+  writer->worker_count_ = WorkerCount();
+
+  XELOGI("Save state: captured {} blocks ({} MB) in {} us",
+         writer->snapshot_->blocks().size(),
+         writer->snapshot_->total_bytes() >> 20, pause_ns / 1000);
+
+  auto* self = writer.get();
+  threading::JobOptions options;
+  options.name = "save_state";
+  options.priority = threading::JobPriority::kBackground;
+  options.counter = &writer->counter_;
+  threading::JobSystem::Shared().Submit([self]() { self->Run(); }, options);
+  return writer;
+}
+
+SaveStateWriter::~SaveStateWriter() { Wait(); }
+
+bool SaveStateWriter::Wait() {
+  threading::JobSystem::Shared().Wait(counter_);
+  return ok_;
+}
+
+void SaveStateWriter::Run() {
+  threading::JobOptions options;
+  options.name = "save_state_blocks";
+  options.priority = threading::JobPriority::kBackground;
+  threading::JobSystem::Shared().ParallelFor(
+      worker_count_, [this](uint32_t) { WriteBlocks(); }, options);
+
+  uint32_t preserved = snapshot_->preserved_count();
+  uint64_t guest_bytes = snapshot_->total_bytes();
+  size_t block_count = snapshot_->blocks().size();
+  // Every block has been read: give the guest its memory back
+  snapshot_.reset();
+
+  ok_ = !write_failed_.load(std::memory_order_acquire) && Finish();
+  if (ok_) {
+    XELOGI("Save state: wrote {} ({} blocks, {} MB -> {} MB, {} copied on "
+           "write) in {} ms",
+           path_, block_count, guest_bytes >> 20,
+           stored_bytes_.load() >> 20, preserved,
+           (Clock::QueryHostTickCount() - start_ns_) / 1000000);
+  } else {
+    XELOGE("Save state: writing {} failed: {}", path_, strerror(errno));
+    if (fd_ >= 0) close(fd_);
+    fd_ = -1;
+    unlink((path_ + ".tmp").c_str());
+  }
+  done_.store(true, std::memory_order_release);
+}
+
+void SaveStateWriter::WriteBlocks() {
+  std::vector<uint8_t> raw(kBlockSize);
+  std::vector<uint8_t> packed(lz4::CompressBound(kBlockSize));
+  const auto& blocks = snapshot_->blocks();
+  while (!write_failed_.load(std::memory_order_relaxed)) {
+    size_t index = next_block_.fetch_add(1, std::memory_order_relaxed);
+    if (index >= blocks.size()) break;
+    const auto& block = blocks[index];
+    snapshot_->ReadBlock(index, raw.data());
+
+    FileBlock entry = {block.address, block.size,
+                       static_cast<uint32_t>(block.access), 0, 0};
+    if (!IsAllZero(raw.data(), block.size)) {
+      size_t packed_size =
+          lz4::Compress(raw.data(), block.size, packed.data(), packed.size());
+      const uint8_t* data = packed.data();
+      if (!packed_size || packed_size >= block.size) {
+        data = raw.data();
+        packed_size = block.size;
+      }
+      entry.stored_size = static_cast<uint32_t>(packed_size);
+      entry.offset = next_offset_.fetch_add(packed_size,
+                                            std::memory_order_relaxed);
+      if (!WriteAll(fd_, data, packed_size, entry.offset)) {
+        write_failed_.store(true, std::memory_order_release);
+        break;
+      }
+      stored_bytes_.fetch_add(packed_size, std::memory_order_relaxed);
+    }
+    memcpy(&table_[index * sizeof(FileBlock)], &entry, sizeof(entry));
+  }
+}
+
+bool SaveStateWriter::Finish() {
+  FileHeader header = {};
+  header.version = kVersion;
+  header.block_size = kBlockSize;
+  header.machine_offset = sizeof(FileHeader);
+  header.machine_size = machine_state_.size();
+  header.table_offset = (next_offset_.load() + 7) & ~uint64_t(7);
+  header.block_count = table_.size() / sizeof(FileBlock);
+  for (size_t i = 0; i < header.block_count; ++i) {
+    FileBlock entry;
+    memcpy(&entry, &table_[i * sizeof(FileBlock)], sizeof(entry));
+    header.guest_bytes += entry.size;
+  }
+
+  // Magic last: a file cut short never validates
+  bool ok = WriteAll(fd_, machine_state_.data(), machine_state_.size(),
+                     header.machine_offset) &&
+            WriteAll(fd_, table_.data(), table_.size(), header.table_offset) &&
+            WriteAll(fd_, &header, sizeof(header), 0) && fsync(fd_) == 0;
+  memcpy(header.magic, kMagic, sizeof(kMagic));
+  ok = ok && WriteAll(fd_, header.magic, sizeof(header.magic), 0);
+  ok = close(fd_) == 0 && ok;
+  fd_ = -1;
+  return ok && rename((path_ + ".tmp").c_str(), path_.c_str()) == 0;
+}
+
+// ── SaveStateReader ─────────────────────────────────────────────────────────
+
+std::unique_ptr<SaveStateReader> SaveStateReader::Open(
+    const std::string& path) {
+  auto file = MappedFile::Open(path);
+  if (!file) {
+    XELOGE("Load state: cannot open {}", path);
+    return nullptr;
+  }
+  uint64_t file_size = file->size();
+  FileHeader header;
+  if (file_size < sizeof(header)) {
+    XELOGE("Load state: {} is truncated", path);
+    return nullptr;
+  }
+  memcpy(&header, file->data(), sizeof(header));
+  if (memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+      header.version != kVersion || header.block_size != kBlockSize) {
+    XELOGE("Load state: {} is not a version {} save state", path, kVersion);
+    return nullptr;
+  }
+  auto in_file = [file_size](uint64_t offset, uint64_t size) {
+    return offset <= file_size && size <= file_size - offset;
+  };
+  if (!in_file(header.machine_offset, header.machine_size) ||
+      header.block_count > file_size / sizeof(FileBlock) ||
+      !in_file(header.table_offset, header.block_count * sizeof(FileBlock))) {
+    XELOGE("Load state: {} has a corrupt header", path);
+    return nullptr;
+  }
+
+  std::unique_ptr<SaveStateReader> reader(new SaveStateReader());
+  reader->machine_data_ = file->data() + header.machine_offset;
+  reader->machine_size_ = static_cast<size_t>(header.machine_size);
+  reader->blocks_.reserve(header.block_count);
+  for (uint64_t i = 0; i < header.block_count; ++i) {
+    FileBlock entry;
+    memcpy(&entry, file->data() + header.table_offset + i * sizeof(entry),
+           sizeof(entry));
+    if (!entry.size || entry.size > kBlockSize ||
+        entry.stored_size > entry.size ||
+        entry.access > static_cast<uint32_t>(
+                           memory::PageAccess::kExecuteReadWrite) ||
+        (entry.stored_size && !in_file(entry.offset, entry.stored_size))) {
+      XELOGE("Load state: {} has a corrupt block table (entry {})", path, i);
+      return nullptr;
+    }
+    reader->blocks_.push_back({entry.address, entry.size,
+                               static_cast<memory::PageAccess>(entry.access)});
+    reader->block_offsets_.push_back(entry.offset);
+    reader->block_stored_sizes_.push_back(entry.stored_size);
+  }
+  reader->file_ = std::move(file);
+  return reader;
+}
+
+SaveStateReader::~SaveStateReader() { restore_.reset(); }
+
+StateReader SaveStateReader::machine_state() const {
+  return StateReader(machine_data_, machine_size_);
+}
+
+bool SaveStateReader::FillBlock(size_t index, uint8_t* dest) const {
+  uint32_t size = blocks_[index].size;
+  uint32_t stored = block_stored_sizes_[index];
+  const uint8_t* src = file_->data() + block_offsets_[index];
+  if (!stored) return true;  // Fresh pages are already zero
+  if (stored == size) {
+    memcpy(dest, src, size);
+    return true;
+  }
+  return lz4::Decompress(src, stored, dest, size);
+}
+
+bool SaveStateReader::BeginMemoryRestore() {
+  if (restore_) return false;
+  // Workers claim blocks in address order, so the background fill reads
+  // the file roughly front to back
+  file_->Advise(0, file_->size(), MappedFile::AccessHint::kSequential);
+  restore_ = memory::GuestRestore::Begin(
+      blocks_, [this](size_t index, uint8_t* dest) {
+        return FillBlock(index, dest);
+      });
+  return restore_ != nullptr;
+}
+
+}  // namespace xe
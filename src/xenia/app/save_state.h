@@ -0,0 +1,99 @@
+/**
+ * Vera360 — Xenia Edge
+ * Save-state files
+ *
+ * A file holds a header, the machine-state sections (CPU, kernel, GPU,
+ * clock), a table of guest memory blocks and the blocks themselves: 64KB
+ * or smaller, LZ4-compressed (raw when that does not help, absent when all
+ * zero). Saving only pauses the guest to write-protect its memory;
+ * loading maps the file and lets guest pages fault in on first touch.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "xenia/base/job_system.h"
+#include "xenia/base/mapped_file.h"
+#include "xenia/base/memory/guest_snapshot.h"
+#include "xenia/base/state_stream.h"
+#include "xenia/base/threading.h"
+
+namespace xe {
+
+class SaveStateWriter {
+ public:
+  /// Snapshot guest memory and start writing path (via path + ".tmp") as
+  /// background jobs. The guest may run on as soon as this returns.
+  static std::unique_ptr<SaveStateWriter> Start(
+      const std::string& path, std::vector<uint8_t> machine_state);
+
+  /// Waits for the file
+  ~SaveStateWriter();
+
+  bool done() const { return done_.load(std::memory_order_acquire); }
+
+  /// Wait until the file is complete; true if it was written
+  bool Wait();
+
+ private:
+  SaveStateWriter() = default;
+
+  void Run();
+  void WriteBlocks();
+  bool Finish();
+
+  std::string path_;
+  int fd_ = -1;
+  std::vector<uint8_t> machine_state_;
+  std::unique_ptr<memory::GuestSnapshot> snapshot_;
+  std::vector<uint8_t> table_;
+  std::atomic<size_t> next_block_{0};
+  std::atomic<uint64_t> next_offset_{0};
+  std::atomic<uint64_t> stored_bytes_{0};
+  std::atomic<bool> write_failed_{false};
+  uint32_t worker_count_ = 1;
+  uint64_t start_ns_ = 0;
+  threading::JobCounter counter_;  // the Run job
+  std::atomic<bool> done_{false};
+  bool ok_ = false;
+};
+
+class SaveStateReader {
+ public:
+  /// Map and validate a save-state file. Nothing is changed yet.
+  static std::unique_ptr<SaveStateReader> Open(const std::string& path);
+
+  /// Waits for the background fill
+  ~SaveStateReader();
+
+  /// The machine-state sections
+  StateReader machine_state() const;
+
+  /// Replace guest memory with the saved image. Pages are populated on
+  /// first touch and by a background thread; the reader must stay alive
+  /// until memory_complete().
+  bool BeginMemoryRestore();
+
+  bool memory_complete() const { return !restore_ || restore_->complete(); }
+  /// A block was corrupt and was restored as zeros
+  bool memory_failed() const { return restore_ && restore_->failed(); }
+
+ private:
+  SaveStateReader() = default;
+
+  bool FillBlock(size_t index, uint8_t* dest) const;
+
+  std::unique_ptr<MappedFile> file_;
+  const uint8_t* machine_data_ = nullptr;
+  size_t machine_size_ = 0;
+  std::vector<memory::SnapshotBlock> blocks_;
+  std::vector<uint64_t> block_offsets_;
+  std::vector<uint32_t> block_stored_sizes_;
+  std::unique_ptr<memory::GuestRestore> restore_;
+};
+
+}  // namespace xe
@@ -3,36 +3,202 @@
  * APU System — Xbox 360 audio processing unit emulation
  */
 
+#include "xenia/apu/apu_system.h"
+#include "xenia/base/cvar.h"
 #include "xenia/base/logging.h"
-#include <cstdint>
-#include <vector>
+
+#include <algorithm>
+#include <cmath>
 
 namespace xe::apu {
 
-class ApuSystem {
- public:
-  bool Initialize() {
-    XELOGI("APU system initialized");
-    // Use Android AudioTrack (AAudio) for output
-    return true;
+DEFINE_int32(audio_latency_ms, 24,
+             "Audio queued ahead of the device, in milliseconds");
+DEFINE_bool(audio_time_stretch, true,
+            "Stretch the output to ride out emulation speed changes");
+DEFINE_string(audio_wav_path, "",
+              "Record the mixed output to this WAV file (null sink only)");
+
+namespace {
+
+// Ring headroom over the target so a late mixer pass never overwrites
+constexpr uint32_t kRingLatencyMultiple = 4;
+
+// Stretch control: ratio per unit of fill error, the largest deviation
+// from 1, the error ignored around the target, and the per-pass smoothing
+constexpr float kStretchGain = 1.0f;
+constexpr float kStretchLimit = 0.25f;
+constexpr float kStretchDeadZone = 0.1f;
+constexpr float kStretchSmoothing = 0.05f;
+
+}  // namespace
+
+ApuSystem::ApuSystem() = default;
+
+ApuSystem::~ApuSystem() { Shutdown(); }
+
+bool ApuSystem::Initialize(const XmaDecoderOptions& xma_options) {
+  if (!xma_decoder_.Initialize(xma_options)) return false;
+  if (!OpenSink(0)) return false;
+
+  uint32_t rate = sink_->sample_rate();
+  if (!mixer_.Initialize(rate)) return false;
+  int32_t latency_ms =
+      std::max(cvars.GetValue<int32_t>("audio_latency_ms", 24), 1);
+  target_fill_ = std::max(uint32_t(uint64_t(rate) * latency_ms / 1000),
+                          2 * sink_->burst_frames());
+  if (!ring_.Initialize(target_fill_ * kRingLatencyMultiple,
+                        AudioMixer::kChannels)) {
+    return false;
+  }
+  low_fill_ = target_fill_ / 4;
+  mix_buffer_.assign(AudioMixer::kBlockFrames * AudioMixer::kChannels, 0.0f);
+  stretch_enabled_ = cvars.GetValue<bool>("audio_time_stretch", true) &&
+                     stretch_.Initialize(rate);
+  stretch_buffer_.assign(mix_buffer_.size(), 0.0f);
+  xma_submix_ = mixer_.CreateSubmixVoice();
+
+  ProcessAudio();
+  if (!sink_->Start(&ring_)) return false;
+  mixer_running_ = true;
+  mixer_thread_ =
+      threading::Thread::Create([this]() { MixerMain(); }, "APU Mixer");
+  XELOGI("APU system initialized: {} Hz, {} ms target latency{}", rate,
+         latency_ms, stretch_enabled_ ? ", time stretch" : "");
+  return true;
+}
+
+void ApuSystem::Shutdown() {
+  if (!sink_) return;
+  if (mixer_thread_) {
+    mixer_running_ = false;
+    mixer_thread_->Join();
+    mixer_thread_.reset();
+  }
+  sink_->Close();
+  XELOGI("APU: {} frames of underrun, {} frames of starved voices",
+         sink_->underrun_frames(), mixer_.starved_frames());
+  if (stretch_enabled_) {
+    XELOGI("APU: stretch ratio ranged {}% to {}%",
+           int(std::lround(stretch_min_ * 100.0f)),
+           int(std::lround(stretch_max_ * 100.0f)));
+  }
+  sink_.reset();
+  xma_decoder_.Shutdown();
+  XELOGI("APU system shut down");
+}
+
+bool ApuSystem::OpenSink(uint32_t requested_rate) {
+#if defined(__ANDROID__)
+  sink_ = CreateAAudioSink();
+  if (sink_->Open(requested_rate)) return true;
+  XELOGW("APU: no audio device, output is discarded");
+#endif
+  sink_ = CreateNullSink(cvars.GetValue<std::string>("audio_wav_path", ""));
+  return sink_->Open(requested_rate);
+}
+
+// ── XMA voices ───────────────────────────────────────────────────────────────
+
+uint32_t ApuSystem::AllocateXmaContext() {
+  uint32_t context = xma_decoder_.AllocateContext();
+  if (!context) return 0;
+  // The format follows the stream once it decodes
+  uint32_t voice = mixer_.CreateSourceVoice(2, 48000, xma_submix_);
+  if (voice) {
+    mixer_.AttachXmaOutput(voice, xma_decoder_.context_output(context));
+    threading::LockGuard lock(xma_voices_mutex_);
+    xma_voices_.emplace_back(context, voice);
   }
+  return context;
+}
 
-  void Shutdown() {
-    XELOGI("APU system shut down");
+void ApuSystem::ReleaseXmaContext(uint32_t guest_address) {
+  {
+    threading::LockGuard lock(xma_voices_mutex_);
+    auto it = std::find_if(
+        xma_voices_.begin(), xma_voices_.end(),
+        [guest_address](const auto& entry) { return entry.first == guest_address; });
+    if (it != xma_voices_.end()) {
+      mixer_.DestroyVoice(it->second);
+      xma_voices_.erase(it);
+    }
   }
+  xma_decoder_.ReleaseContext(guest_address);
+}
+
+// ── Mixer thread ─────────────────────────────────────────────────────────────
 
-  /// Process pending audio data — called each frame or periodically
-  void ProcessAudio() {
-    // TODO: Read XMA decoder output and send to Android audio
+void ApuSystem::ProcessAudio() {
+  uint32_t fill = ring_.fill();
+  if (stretch_enabled_) {
+    // Decoded audio piling up in the voices is latency too
+    uint32_t backlog = mixer_.available_frames();
+    UpdateStretch(fill + (backlog == UINT32_MAX || backlog < target_fill_
+                              ? 0
+                              : backlog - target_fill_));
   }
+  while (fill + AudioMixer::kBlockFrames <= target_fill_) {
+    uint32_t frames = AudioMixer::kBlockFrames;
+    if (!stretch_enabled_) {
+      // Mix no more than the ring takes, so no mixed audio is dropped
+      frames = std::min(frames, ring_.free_frames());
+      if (!frames) break;
+      mixer_.Mix(mix_buffer_.data(), frames);
+      fill += ring_.Write(mix_buffer_.data(), frames);
+      continue;
+    }
+    if (fill >= low_fill_) {
+      // Let the ring drain for a guest running slow rather than mix a gap
+      frames = std::min(frames, mixer_.available_frames());
+      if (!frames) break;
+    }
+    mixer_.Mix(mix_buffer_.data(), frames);
+    stretch_.Push(mix_buffer_.data(), frames);
+    // Pull only what the ring takes; the rest waits in the stretch
+    while (uint32_t space = std::min(ring_.free_frames(),
+                                     AudioMixer::kBlockFrames)) {
+      uint32_t stretched = stretch_.Pull(stretch_buffer_.data(), space);
+      if (!stretched) break;
+      ring_.Write(stretch_buffer_.data(), stretched);
+    }
+    fill = ring_.fill();
+  }
+}
 
-  /// Set master volume (0.0 - 1.0)
-  void SetVolume(float volume) {
-    volume_ = volume;
+void ApuSystem::UpdateStretch(uint32_t queued) {
+  float error = (float(queued) - float(target_fill_)) / float(target_fill_);
+  float wanted = 1.0f;
+  if (std::abs(error) > kStretchDeadZone) {
+    wanted = std::clamp(1.0f - kStretchGain * error, 1.0f - kStretchLimit,
+                        1.0f + kStretchLimit);
   }
+  float ratio = stretch_.ratio();
+  ratio += (wanted - ratio) * kStretchSmoothing;
+  // Settle exactly on 1 so the stretch goes back to passing audio through
+  if (wanted == 1.0f && std::abs(ratio - 1.0f) < 0.002f) ratio = 1.0f;
+  stretch_.set_ratio(ratio);
+  stretch_min_ = std::min(stretch_min_, ratio);
+  stretch_max_ = std::max(stretch_max_, ratio);
+}
 
- private:
-  float volume_ = 1.0f;
-};
+void ApuSystem::MixerMain() {
+  while (mixer_running_) {
+    if (sink_->disconnected()) {
+      // Same rate again, so the mixer and ring stay valid
+      XELOGW("APU: audio device lost, reopening");
+      uint32_t rate = sink_->sample_rate();
+      sink_->Close();
+      if (!OpenSink(rate) || !sink_->Start(&ring_)) {
+        XELOGE("APU: cannot reopen audio output");
+        break;
+      }
+    }
+    ProcessAudio();
+    uint64_t burst_ns =
+        uint64_t(sink_->burst_frames()) * 1000000000ull / sink_->sample_rate();
+    threading::NanoSleep(burst_ns / 2);
+  }
+}
 
 }  // namespace xe::apu
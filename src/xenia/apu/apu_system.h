@@ -0,0 +1,100 @@
+/**
+ * Vera360 — Xenia Edge
+ * APU System — Xbox 360 audio processing unit emulation
+ *
+ * Output path: XMA contexts and other source voices → AudioMixer (at the
+ * device rate) → TimeStretch → AudioRing → AudioSink callback. A mixer
+ * thread keeps the ring topped up to the target latency; the device
+ * callback only reads the ring.
+ *
+ * XMA audio arrives at the guest's pace, so a guest running slow would
+ * starve its voices and leave gaps. Instead the mixer waits for the voices
+ * while the ring drains, and the ring's fill steers the stretch ratio:
+ * below target the output is slowed down (at most 25%) to cover for the
+ * guest, above it (or with decoded audio piling up in the voices) sped up
+ * to bring latency back. Only when the ring gets
+ * near empty does mixing go on regardless.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "xenia/apu/audio_mixer.h"
+#include "xenia/apu/audio_ring.h"
+#include "xenia/apu/audio_sink.h"
+#include "xenia/apu/time_stretch.h"
+#include "xenia/apu/xma_decoder.h"
+#include "xenia/base/threading.h"
+
+namespace xe::apu {
+
+class ApuSystem {
+ public:
+  ApuSystem();
+  ~ApuSystem();
+
+  /// xma_options.audio_thread = false leaves XMA decoding to the caller
+  /// (xma_decoder().DecodePeriod)
+  bool Initialize(const XmaDecoderOptions& xma_options = {});
+  void Shutdown();
+
+  /// Mix until the ring holds the target latency; the mixer thread calls
+  /// this every half burst
+  void ProcessAudio();
+
+  /// Set master volume (0.0 - 1.0)
+  void SetVolume(float volume) {
+    mixer_.SetVolume(AudioMixer::kMasterVoice, volume);
+  }
+
+  XmaDecoder& xma_decoder() { return xma_decoder_; }
+  AudioMixer& mixer() { return mixer_; }
+  AudioSink* sink() { return sink_.get(); }
+
+  /// Claim an XMA context and give it a source voice on the XMA submix;
+  /// the context's guest address, or 0
+  uint32_t AllocateXmaContext();
+  void ReleaseXmaContext(uint32_t guest_address);
+
+  /// APU registers (0x7FEA0000); false if addr is not one
+  bool HandleMmioWrite(uint32_t guest_addr, uint32_t value) {
+    return xma_decoder_.HandleMmioWrite(guest_addr, value);
+  }
+  uint32_t HandleMmioRead(uint32_t guest_addr) {
+    return xma_decoder_.HandleMmioRead(guest_addr);
+  }
+
+ private:
+  bool OpenSink(uint32_t requested_rate);
+  /// Steer the stretch ratio toward keeping queued (ring fill plus excess
+  /// voice backlog) at the target fill
+  void UpdateStretch(uint32_t queued);
+  void MixerMain();
+
+  XmaDecoder xma_decoder_;
+  AudioMixer mixer_;
+  AudioRing ring_;
+  std::unique_ptr<AudioSink> sink_;
+  uint32_t target_fill_ = 0;  // frames
+  uint32_t low_fill_ = 0;     // below this, mix even if voices starve
+  std::vector<float> mix_buffer_;
+
+  TimeStretch stretch_;
+  bool stretch_enabled_ = false;
+  std::vector<float> stretch_buffer_;
+  float stretch_min_ = 1.0f;  // ratio range used, for the shutdown report
+  float stretch_max_ = 1.0f;
+
+  uint32_t xma_submix_ = 0;
+  threading::Mutex xma_voices_mutex_;
+  std::vector<std::pair<uint32_t, uint32_t>> xma_voices_;  // context, voice
+
+  std::unique_ptr<threading::Thread> mixer_thread_;
+  std::atomic<bool> mixer_running_{false};
+};
+
+}  // namespace xe::apu
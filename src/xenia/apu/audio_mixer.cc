@@ -0,0 +1,332 @@
+/**
+ * Vera360 — Xenia Edge
+ * Audio mixer — XAudio2-style voice graph
+ */
+
+#include "xenia/apu/audio_mixer.h"
+#include "xenia/apu/vec4.h"
+#include "xenia/apu/xma_context.h"
+#include "xenia/base/logging.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace xe::apu {
+
+namespace {
+
+constexpr float kPi = 3.14159265f;
+
+/// dst += src * gain
+void Accumulate(float* dst, const float* src, float gain, uint32_t count) {
+  uint32_t i = 0;
+#if XE_APU_NEON || XE_APU_SSE2
+  Vec4 g = Splat4(gain);
+  for (; i + 4 <= count; i += 4) {
+    Store4(dst + i, MulAdd4(Load4(dst + i), Load4(src + i), g));
+  }
+#endif
+  for (; i < count; ++i) dst[i] += src[i] * gain;
+}
+
+/// Scale, clamp to [-1, 1] and interleave two planar channels
+void StoreInterleaved(const float* left, const float* right, float gain,
+                      uint32_t count, float* out) {
+  uint32_t i = 0;
+#if XE_APU_NEON || XE_APU_SSE2
+  Vec4 g = Splat4(gain), lo = Splat4(-1.0f), hi = Splat4(1.0f);
+  for (; i + 4 <= count; i += 4) {
+    Vec4 l = Min4(Max4(Mul4(Load4(left + i), g), lo), hi);
+    Vec4 r = Min4(Max4(Mul4(Load4(right + i), g), lo), hi);
+#if XE_APU_NEON
+    vst2q_f32(out + i * 2, (float32x4x2_t{{l, r}}));
+#else
+    _mm_storeu_ps(out + i * 2, _mm_unpacklo_ps(l, r));
+    _mm_storeu_ps(out + i * 2 + 4, _mm_unpackhi_ps(l, r));
+#endif
+  }
+#endif
+  for (; i < count; ++i) {
+    out[i * 2] = std::clamp(left[i] * gain, -1.0f, 1.0f);
+    out[i * 2 + 1] = std::clamp(right[i] * gain, -1.0f, 1.0f);
+  }
+}
+
+/// Balance: full level at centre, the far side fades out
+void BalanceGains(float volume, float pan, float* left, float* right) {
+  *left = volume * std::min(1.0f, 1.0f - pan);
+  *right = volume * std::min(1.0f, 1.0f + pan);
+}
+
+}  // namespace
+
+AudioMixer::AudioMixer() = default;
+
+AudioMixer::~AudioMixer() = default;
+
+bool AudioMixer::Initialize(uint32_t device_rate) {
+  if (!device_rate) return false;
+  device_rate_ = device_rate;
+  XELOGI("Audio mixer: {} Hz stereo, {}-frame blocks", device_rate_,
+         kBlockFrames);
+  return true;
+}
+
+// ── Voices ───────────────────────────────────────────────────────────────────
+
+AudioMixer::Voice* AudioMixer::FindOutput(uint32_t id) {
+  for (auto& submix : submixes_) {
+    if (submix->id == id) return submix.get();
+  }
+  return nullptr;
+}
+
+AudioMixer::SourceVoice* AudioMixer::FindSource(uint32_t id) {
+  for (auto& source : sources_) {
+    if (source->id == id) return source.get();
+  }
+  return nullptr;
+}
+
+AudioMixer::Voice* AudioMixer::FindVoice(uint32_t id) {
+  if (SourceVoice* source = FindSource(id)) return source;
+  return FindOutput(id);
+}
+
+uint32_t AudioMixer::CreateSubmixVoice(uint32_t output) {
+  threading::LockGuard lock(mutex_);
+  Voice* target = output == kMasterVoice ? nullptr : FindOutput(output);
+  if (output != kMasterVoice && !target) return 0;
+  auto voice = std::make_unique<Voice>();
+  voice->id = next_id_++;
+  voice->output = target;
+  submixes_.push_back(std::move(voice));
+  return submixes_.back()->id;
+}
+
+uint32_t AudioMixer::CreateSourceVoice(uint32_t channels, uint32_t sample_rate,
+                                       uint32_t output) {
+  threading::LockGuard lock(mutex_);
+  Voice* target = output == kMasterVoice ? nullptr : FindOutput(output);
+  if (output != kMasterVoice && !target) return 0;
+  auto voice = std::make_unique<SourceVoice>();
+  if (!voice->resampler.Initialize(channels, sample_rate, device_rate_)) {
+    XELOGW("Audio mixer: unsupported source format ({} channels, {} Hz)",
+           channels, sample_rate);
+    return 0;
+  }
+  voice->id = next_id_++;
+  voice->output = target;
+  sources_.push_back(std::move(voice));
+  return sources_.back()->id;
+}
+
+bool AudioMixer::DestroyVoice(uint32_t voice) {
+  threading::LockGuard lock(mutex_);
+  auto is_voice = [voice](const auto& v) { return v->id == voice; };
+  auto source = std::find_if(sources_.begin(), sources_.end(), is_voice);
+  if (source != sources_.end()) {
+    sources_.erase(source);
+    return true;
+  }
+  auto submix = std::find_if(submixes_.begin(), submixes_.end(), is_voice);
+  if (submix == submixes_.end()) return false;
+  auto feeds = [&](const auto& v) { return v->output == submix->get(); };
+  if (std::any_of(sources_.begin(), sources_.end(), feeds) ||
+      std::any_of(submixes_.begin(), submixes_.end(), feeds)) {
+    return false;
+  }
+  submixes_.erase(submix);
+  return true;
+}
+
+void AudioMixer::SetVolume(uint32_t voice, float volume) {
+  volume = std::max(volume, 0.0f);
+  if (voice == kMasterVoice) {
+    master_volume_.store(volume, std::memory_order_relaxed);
+    return;
+  }
+  threading::LockGuard lock(mutex_);
+  if (Voice* v = FindVoice(voice)) {
+    v->volume.store(volume, std::memory_order_relaxed);
+  }
+}
+
+void AudioMixer::SetPan(uint32_t voice, float pan) {
+  threading::LockGuard lock(mutex_);
+  if (Voice* v = FindVoice(voice)) {
+    v->pan.store(std::clamp(pan, -1.0f, 1.0f), std::memory_order_relaxed);
+  }
+}
+
+bool AudioMixer::SubmitBuffer(uint32_t voice, const float* frames,
+                              uint32_t count) {
+  if (!count) return true;
+  threading::LockGuard lock(mutex_);
+  SourceVoice* source = FindSource(voice);
+  if (!source || source->xma) return false;
+  source->queue.emplace_back(frames,
+                             frames + size_t(count) * source->resampler.channels());
+  return true;
+}
+
+uint32_t AudioMixer::queued_frames(uint32_t voice) {
+  threading::LockGuard lock(mutex_);
+  SourceVoice* source = FindSource(voice);
+  if (!source) return 0;
+  size_t samples = 0;
+  for (const auto& buffer : source->queue) samples += buffer.size();
+  return static_cast<uint32_t>(samples / source->resampler.channels()) -
+         source->queue_offset;
+}
+
+bool AudioMixer::AttachXmaOutput(uint32_t voice, XmaOutput* output) {
+  threading::LockGuard lock(mutex_);
+  SourceVoice* source = FindSource(voice);
+  if (!source) return false;
+  source->xma = output;
+  source->queue.clear();
+  source->queue_offset = 0;
+  source->pending_frames = 0;
+  if (output) {
+    for (auto& pending : source->pending) {
+      pending.resize(XmaOutput::kChannelStride);
+    }
+  }
+  return true;
+}
+
+// ── Mixing ───────────────────────────────────────────────────────────────────
+
+bool AudioMixer::FetchXma(SourceVoice* voice) {
+  if (voice->pending_frames) return true;
+  const XmaOutput::Slot* slot = voice->xma->Acquire();
+  if (!slot) return false;
+  Resampler& resampler = voice->resampler;
+  if (slot->channels != resampler.channels()) {
+    resampler.Initialize(slot->channels, slot->sample_rate, device_rate_);
+  } else {
+    resampler.SetRates(slot->sample_rate, device_rate_);
+  }
+  for (uint32_t ch = 0; ch < slot->channels; ++ch) {
+    memcpy(voice->pending[ch].data(),
+           &slot->pcm[ch * XmaOutput::kChannelStride],
+           slot->samples * sizeof(float));
+  }
+  voice->pending_offset = 0;
+  voice->pending_frames = slot->samples;
+  voice->xma->Release();
+  return true;
+}
+
+void AudioMixer::Refill(SourceVoice* voice, uint32_t count) {
+  Resampler& resampler = voice->resampler;
+  uint32_t needed = resampler.InputNeeded(count);
+  while (needed) {
+    uint32_t pushed;
+    if (voice->xma) {
+      if (!voice->pending_frames) {
+        if (!FetchXma(voice)) break;
+        // The resampler may have been rebuilt for a new format
+        needed = resampler.InputNeeded(count);
+      }
+      const float* in[kChannels] = {
+          voice->pending[0].data() + voice->pending_offset,
+          voice->pending[1].data() + voice->pending_offset};
+      pushed = resampler.Push(in, std::min(needed, voice->pending_frames));
+      voice->pending_offset += pushed;
+      voice->pending_frames -= pushed;
+    } else {
+      if (voice->queue.empty()) break;
+      const std::vector<float>& buffer = voice->queue.front();
+      uint32_t channels = resampler.channels();
+      uint32_t left =
+          static_cast<uint32_t>(buffer.size() / channels) - voice->queue_offset;
+      pushed = resampler.PushInterleaved(
+          &buffer[size_t(voice->queue_offset) * channels],
+          std::min(needed, left));
+      voice->queue_offset += pushed;
+      if (pushed == left) {
+        voice->queue.pop_front();
+        voice->queue_offset = 0;
+      }
+    }
+    if (!pushed) break;
+    needed -= std::min(needed, pushed);
+  }
+}
+
+void AudioMixer::Mix(float* out, uint32_t count) {
+  threading::LockGuard lock(mutex_);
+  while (count) {
+    uint32_t block = std::min(count, kBlockFrames);
+    MixBlock(out, block);
+    out += block * kChannels;
+    count -= block;
+  }
+}
+
+uint32_t AudioMixer::available_frames() {
+  threading::LockGuard lock(mutex_);
+  uint32_t available = UINT32_MAX;
+  for (auto& voice : sources_) {
+    if (!voice->xma || !voice->streaming) continue;
+    FetchXma(voice.get());
+    available = std::min(
+        available, voice->resampler.OutputAvailable(voice->pending_frames));
+  }
+  return available;
+}
+
+void AudioMixer::MixBlock(float* out, uint32_t count) {
+  for (auto& submix : submixes_) {
+    for (auto& channel : submix->bus) std::fill_n(channel, count, 0.0f);
+  }
+  for (auto& channel : master_) std::fill_n(channel, count, 0.0f);
+
+  for (auto& voice : sources_) {
+    Refill(voice.get(), count);
+    float* rendered[kChannels] = {scratch_[0], scratch_[1]};
+    uint32_t produced = voice->resampler.Pull(rendered, count);
+    voice->streaming = produced == count;
+    if (!produced) continue;  // idle: nothing queued
+    if (produced < count) {
+      starved_frames_.fetch_add(count - produced, std::memory_order_relaxed);
+      for (auto& channel : scratch_) {
+        std::fill(channel + produced, channel + count, 0.0f);
+      }
+    }
+
+    auto& bus = voice->output ? voice->output->bus : master_;
+    float volume = voice->volume.load(std::memory_order_relaxed);
+    float pan = voice->pan.load(std::memory_order_relaxed);
+    if (voice->resampler.channels() == 1) {
+      // Constant power: -3 dB per side at centre
+      float angle = (pan + 1.0f) * (kPi / 4.0f);
+      Accumulate(bus[0], scratch_[0], volume * std::cos(angle), count);
+      Accumulate(bus[1], scratch_[0], volume * std::sin(angle), count);
+    } else {
+      float left, right;
+      BalanceGains(volume, pan, &left, &right);
+      Accumulate(bus[0], scratch_[0], left, count);
+      Accumulate(bus[1], scratch_[1], right, count);
+    }
+  }
+
+  // A submix only feeds earlier ones, so newest first settles every bus
+  for (auto it = submixes_.rbegin(); it != submixes_.rend(); ++it) {
+    Voice* submix = it->get();
+    auto& bus = submix->output ? submix->output->bus : master_;
+    float left, right;
+    BalanceGains(submix->volume.load(std::memory_order_relaxed),
+                 submix->pan.load(std::memory_order_relaxed), &left, &right);
+    Accumulate(bus[0], submix->bus[0], left, count);
+    Accumulate(bus[1], submix->bus[1], right, count);
+  }
+
+  StoreInterleaved(master_[0], master_[1],
+                   master_volume_.load(std::memory_order_relaxed), count, out);
+}
+
+}  // namespace xe::apu
@@ -0,0 +1,122 @@
+/**
+ * Vera360 — Xenia Edge
+ * Audio mixer — XAudio2-style voice graph
+ *
+ * Source voices carry PCM at their own rate and channel count, either
+ * buffers submitted by the host or the host copy of an XMA context. Each
+ * is resampled to the device rate and mixed, with its volume and pan, into
+ * a submix voice or the master. Submixes apply their own volume and pan and
+ * feed the master or an earlier submix; the master applies the global
+ * volume and writes clamped, interleaved stereo.
+ *
+ * Mixing runs on the APU mixer thread, never in the device callback.
+ * Creating and destroying voices and queueing buffers take the mixer's
+ * lock; volume and pan are atomics, so they can change from any thread
+ * without waiting for a mix.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "xenia/apu/resampler.h"
+#include "xenia/base/threading.h"
+
+namespace xe::apu {
+
+class XmaOutput;
+
+class AudioMixer {
+ public:
+  static constexpr uint32_t kMasterVoice = 0;
+  static constexpr uint32_t kChannels = 2;
+  /// Frames mixed per pass over the voice graph
+  static constexpr uint32_t kBlockFrames = 256;
+
+  AudioMixer();
+  ~AudioMixer();
+
+  bool Initialize(uint32_t device_rate);
+  uint32_t device_rate() const { return device_rate_; }
+
+  /// A voice id, or 0 on failure. output must be the master or an existing
+  /// submix voice.
+  uint32_t CreateSubmixVoice(uint32_t output = kMasterVoice);
+  uint32_t CreateSourceVoice(uint32_t channels, uint32_t sample_rate,
+                             uint32_t output = kMasterVoice);
+  /// False for a submix that is still some voice's output
+  bool DestroyVoice(uint32_t voice);
+
+  /// Linear gain; kMasterVoice sets the global volume
+  void SetVolume(uint32_t voice, float volume);
+  /// -1 (left) to 1 (right): constant-power placement for mono sources,
+  /// balance for stereo ones and submixes
+  void SetPan(uint32_t voice, float pan);
+
+  /// Queue interleaved PCM on a source voice (copied)
+  bool SubmitBuffer(uint32_t voice, const float* frames, uint32_t count);
+  /// Frames submitted to a source voice and not yet mixed
+  uint32_t queued_frames(uint32_t voice);
+  /// Feed a source voice from an XMA context's decoded output; its rate and
+  /// channel count then follow the stream. nullptr detaches.
+  bool AttachXmaOutput(uint32_t voice, XmaOutput* output);
+
+  /// Mix count frames of interleaved stereo at the device rate
+  void Mix(float* out, uint32_t count);
+  /// Frames that can be mixed before an XMA voice that is mid-stream runs
+  /// out of decoded audio; UINT32_MAX when none is. Mixing past this
+  /// inserts silence into the stream, so the caller can wait on a guest
+  /// that is running slow instead.
+  uint32_t available_frames();
+
+  /// Frames source voices had to fill with silence for lack of input
+  uint64_t starved_frames() const {
+    return starved_frames_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  struct Voice {
+    uint32_t id = 0;
+    Voice* output = nullptr;  // nullptr = master
+    std::atomic<float> volume{1.0f};
+    std::atomic<float> pan{0.0f};
+    float bus[kChannels][kBlockFrames];  // submixes: this block's input
+  };
+  struct SourceVoice : Voice {
+    Resampler resampler;
+    std::deque<std::vector<float>> queue;  // interleaved, front partly used
+    uint32_t queue_offset = 0;             // frames
+    XmaOutput* xma = nullptr;
+    // Current XMA slot, copied out so the slot is released at once
+    std::vector<float> pending[kChannels];
+    uint32_t pending_offset = 0;
+    uint32_t pending_frames = 0;
+    bool streaming = false;  // XMA: the last block was fully fed
+  };
+
+  Voice* FindOutput(uint32_t id);
+  Voice* FindVoice(uint32_t id);
+  SourceVoice* FindSource(uint32_t id);
+  /// Copy the XMA output's published slot into pending if it is empty;
+  /// false when there is nothing new
+  bool FetchXma(SourceVoice* voice);
+  /// Top up the resampler's input for count output frames
+  void Refill(SourceVoice* voice, uint32_t count);
+  void MixBlock(float* out, uint32_t count);
+
+  uint32_t device_rate_ = 0;
+  uint32_t next_id_ = 1;
+  std::atomic<float> master_volume_{1.0f};
+  std::atomic<uint64_t> starved_frames_{0};
+
+  threading::Mutex mutex_;
+  std::vector<std::unique_ptr<SourceVoice>> sources_;
+  std::vector<std::unique_ptr<Voice>> submixes_;  // creation order
+  float master_[kChannels][kBlockFrames];
+  float scratch_[kChannels][kBlockFrames];
+};
+
+}  // namespace xe::apu
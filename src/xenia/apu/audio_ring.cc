@@ -0,0 +1,58 @@
+/**
+ * Vera360 — Xenia Edge
+ * Audio ring — single-producer / single-consumer PCM FIFO
+ */
+
+#include "xenia/apu/audio_ring.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+namespace xe::apu {
+
+bool AudioRing::Initialize(uint32_t capacity_frames, uint32_t channels) {
+  if (!capacity_frames || !channels) return false;
+  capacity_ = std::bit_ceil(capacity_frames);
+  channels_ = channels;
+  buffer_.assign(size_t(capacity_) * channels_, 0.0f);
+  write_pos_ = 0;
+  read_pos_ = 0;
+  return true;
+}
+
+uint32_t AudioRing::fill() const {
+  uint64_t read = read_pos_.load(std::memory_order_acquire);
+  uint64_t write = write_pos_.load(std::memory_order_acquire);
+  return static_cast<uint32_t>(write - read);
+}
+
+uint32_t AudioRing::Write(const float* frames, uint32_t count) {
+  uint64_t write = write_pos_.load(std::memory_order_relaxed);
+  uint64_t read = read_pos_.load(std::memory_order_acquire);
+  count = std::min(count, capacity_ - static_cast<uint32_t>(write - read));
+  uint32_t start = static_cast<uint32_t>(write) & (capacity_ - 1);
+  uint32_t first = std::min(count, capacity_ - start);
+  Copy(&buffer_[size_t(start) * channels_], frames, first);
+  Copy(buffer_.data(), frames + size_t(first) * channels_, count - first);
+  write_pos_.store(write + count, std::memory_order_release);
+  return count;
+}
+
+uint32_t AudioRing::Read(float* frames, uint32_t count) {
+  uint64_t read = read_pos_.load(std::memory_order_relaxed);
+  uint64_t write = write_pos_.load(std::memory_order_acquire);
+  count = std::min(count, static_cast<uint32_t>(write - read));
+  uint32_t start = static_cast<uint32_t>(read) & (capacity_ - 1);
+  uint32_t first = std::min(count, capacity_ - start);
+  Copy(frames, &buffer_[size_t(start) * channels_], first);
+  Copy(frames + size_t(first) * channels_, buffer_.data(), count - first);
+  read_pos_.store(read + count, std::memory_order_release);
+  return count;
+}
+
+void AudioRing::Copy(float* dst, const float* src, uint32_t frames) const {
+  if (frames) memcpy(dst, src, size_t(frames) * channels_ * sizeof(float));
+}
+
+}  // namespace xe::apu
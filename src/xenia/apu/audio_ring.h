@@ -0,0 +1,50 @@
+/**
+ * Vera360 — Xenia Edge
+ * Audio ring — single-producer / single-consumer PCM FIFO
+ *
+ * Carries interleaved float frames from the mixer thread to the host audio
+ * callback. Each side owns one cursor and only reads the other's, so
+ * neither ever blocks, locks or allocates; the storage is sized once up
+ * front.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace xe::apu {
+
+class AudioRing {
+ public:
+  /// capacity is rounded up to a power of two frames
+  bool Initialize(uint32_t capacity_frames, uint32_t channels);
+
+  uint32_t capacity() const { return capacity_; }
+  uint32_t channels() const { return channels_; }
+
+  /// Frames queued; exact on the consumer side, a lower bound on the
+  /// producer side (and the reverse for free_frames)
+  uint32_t fill() const;
+  uint32_t free_frames() const { return capacity_ - fill(); }
+
+  // Producer side
+  /// Queue up to frames frames; the number queued
+  uint32_t Write(const float* frames, uint32_t count);
+
+  // Consumer side
+  /// Dequeue up to count frames; the number dequeued
+  uint32_t Read(float* frames, uint32_t count);
+
+ private:
+  void Copy(float* dst, const float* src, uint32_t frames) const;
+
+  std::vector<float> buffer_;
+  uint32_t capacity_ = 0;
+  uint32_t channels_ = 0;
+  // Monotonic frame counts, each on its own cache line
+  alignas(64) std::atomic<uint64_t> write_pos_{0};
+  alignas(64) std::atomic<uint64_t> read_pos_{0};
+};
+
+}  // namespace xe::apu
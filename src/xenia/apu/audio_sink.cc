@@ -0,0 +1,140 @@
+/**
+ * Vera360 — Xenia Edge
+ * Audio sink — ring draining and the null / WAV sink
+ */
+
+#include "xenia/apu/audio_sink.h"
+#include "xenia/apu/audio_ring.h"
+#include "xenia/base/clock.h"
+#include "xenia/base/logging.h"
+#include "xenia/base/threading.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+namespace xe::apu {
+
+void AudioSink::Render(float* out, uint32_t frames) {
+  uint32_t got = ring_ ? ring_->Read(out, frames) : 0;
+  if (got < frames) {
+    memset(out + got * 2, 0, (frames - got) * 2 * sizeof(float));
+    underrun_frames_.fetch_add(frames - got, std::memory_order_relaxed);
+  }
+}
+
+// ── Null sink ────────────────────────────────────────────────────────────────
+
+namespace {
+
+constexpr uint32_t kNullSinkRate = 48000;
+constexpr uint32_t kNullSinkBurst = 256;
+
+void PutLE16(std::ofstream& f, uint16_t v) {
+  char b[2] = {char(v), char(v >> 8)};
+  f.write(b, 2);
+}
+
+void PutLE32(std::ofstream& f, uint32_t v) {
+  char b[4] = {char(v), char(v >> 8), char(v >> 16), char(v >> 24)};
+  f.write(b, 4);
+}
+
+class NullSink final : public AudioSink {
+ public:
+  explicit NullSink(std::string wav_path) : wav_path_(std::move(wav_path)) {}
+  ~NullSink() override { Close(); }
+
+  bool Open(uint32_t requested_rate) override {
+    sample_rate_ = requested_rate ? requested_rate : kNullSinkRate;
+    burst_frames_ = kNullSinkBurst;
+    burst_.assign(burst_frames_ * 2, 0.0f);
+    if (!wav_path_.empty()) {
+      wav_.open(wav_path_, std::ios::binary | std::ios::trunc);
+      if (!wav_) {
+        XELOGE("Null audio sink: cannot create {}", wav_path_);
+        return false;
+      }
+      WriteWavHeader(0);
+    }
+    XELOGI("Null audio sink: {} Hz{}{}", sample_rate_,
+           wav_path_.empty() ? "" : ", recording to ", wav_path_);
+    return true;
+  }
+
+  bool Start(AudioRing* ring) override {
+    ring_ = ring;
+    running_ = true;
+    thread_ = threading::Thread::Create([this]() { ThreadMain(); },
+                                        "Audio Null Sink");
+    return thread_ != nullptr;
+  }
+
+  void Close() override {
+    if (thread_) {
+      running_ = false;
+      thread_->Join();
+      thread_.reset();
+    }
+    if (wav_.is_open()) {
+      WriteWavHeader(wav_frames_);
+      wav_.close();
+    }
+  }
+
+ private:
+  void ThreadMain() {
+    uint64_t start_ns = Clock::QueryHostTickCount();
+    uint64_t played = 0;
+    while (running_) {
+      // Consume whole bursts on the schedule a device would
+      uint64_t due = (Clock::QueryHostTickCount() - start_ns) * sample_rate_ /
+                     1000000000ull;
+      while (played + burst_frames_ <= due) {
+        Render(burst_.data(), burst_frames_);
+        played += burst_frames_;
+        if (wav_.is_open()) {
+          wav_.write(reinterpret_cast<const char*>(burst_.data()),
+                     burst_.size() * sizeof(float));
+          wav_frames_ += burst_frames_;
+        }
+      }
+      threading::Sleep(1);
+    }
+  }
+
+  void WriteWavHeader(uint64_t frames) {
+    uint32_t data_bytes = uint32_t(std::min<uint64_t>(
+        frames * 2 * sizeof(float), 0xFFFFFFFFull - 36));
+    wav_.seekp(0);
+    wav_.write("RIFF", 4);
+    PutLE32(wav_, 36 + data_bytes);
+    wav_.write("WAVEfmt ", 8);
+    PutLE32(wav_, 16);
+    PutLE16(wav_, 3);  // IEEE float
+    PutLE16(wav_, 2);
+    PutLE32(wav_, sample_rate_);
+    PutLE32(wav_, sample_rate_ * 2 * sizeof(float));
+    PutLE16(wav_, 2 * sizeof(float));
+    PutLE16(wav_, 32);
+    wav_.write("data", 4);
+    PutLE32(wav_, data_bytes);
+    wav_.seekp(0, std::ios::end);
+  }
+
+  std::string wav_path_;
+  std::ofstream wav_;
+  uint64_t wav_frames_ = 0;
+  std::vector<float> burst_;
+  std::atomic<bool> running_{false};
+  std::unique_ptr<threading::Thread> thread_;
+};
+
+}  // namespace
+
+std::unique_ptr<AudioSink> CreateNullSink(const std::string& wav_path) {
+  return std::make_unique<NullSink>(wav_path);
+}
+
+}  // namespace xe::apu
@@ -0,0 +1,64 @@
+/**
+ * Vera360 — Xenia Edge
+ * Audio sink — host output device
+ *
+ * A sink drains the AudioRing at the device's pace. Its callback (Render)
+ * runs on the device's real-time thread and only copies out of the ring,
+ * zero-filling whatever is missing: no locks, no allocation, no logging.
+ * Android plays through AAudio; the null sink keeps real-time pace without
+ * a device and can record what it plays to a WAV file, for headless runs
+ * and tests.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace xe::apu {
+
+class AudioRing;
+
+class AudioSink {
+ public:
+  virtual ~AudioSink() = default;
+
+  /// Open the device; sample_rate() and burst_frames() are valid after.
+  /// requested_rate 0 takes the device's native rate.
+  virtual bool Open(uint32_t requested_rate) = 0;
+  /// Begin pulling stereo float frames from ring
+  virtual bool Start(AudioRing* ring) = 0;
+  virtual void Close() = 0;
+  /// The device went away (headphones unplugged, route change); Close and
+  /// Open again from a normal thread
+  bool disconnected() const {
+    return disconnected_.load(std::memory_order_acquire);
+  }
+
+  uint32_t sample_rate() const { return sample_rate_; }
+  /// Frames the device takes per callback
+  uint32_t burst_frames() const { return burst_frames_; }
+  /// Frames of silence played because the ring ran dry
+  uint64_t underrun_frames() const {
+    return underrun_frames_.load(std::memory_order_relaxed);
+  }
+
+ protected:
+  /// The device callback body
+  void Render(float* out, uint32_t frames);
+
+  AudioRing* ring_ = nullptr;
+  uint32_t sample_rate_ = 0;
+  uint32_t burst_frames_ = 0;
+  std::atomic<bool> disconnected_{false};
+  std::atomic<uint64_t> underrun_frames_{0};
+};
+
+#if defined(__ANDROID__)
+std::unique_ptr<AudioSink> CreateAAudioSink();
+#endif
+/// Plays into nothing in real time; records to wav_path if not empty
+std::unique_ptr<AudioSink> CreateNullSink(const std::string& wav_path = {});
+
+}  // namespace xe::apu
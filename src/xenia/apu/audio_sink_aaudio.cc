@@ -0,0 +1,99 @@
+/**
+ * Vera360 — Xenia Edge
+ * Audio sink — AAudio (Android 8+)
+ */
+
+#include "xenia/apu/audio_sink.h"
+#include "xenia/base/logging.h"
+
+#include <aaudio/AAudio.h>
+
+namespace xe::apu {
+
+namespace {
+
+class AAudioSink final : public AudioSink {
+ public:
+  ~AAudioSink() override { Close(); }
+
+  bool Open(uint32_t requested_rate) override {
+    AAudioStreamBuilder* builder = nullptr;
+    if (AAudio_createStreamBuilder(&builder) != AAUDIO_OK) return false;
+    AAudioStreamBuilder_setDirection(builder, AAUDIO_DIRECTION_OUTPUT);
+    AAudioStreamBuilder_setFormat(builder, AAUDIO_FORMAT_PCM_FLOAT);
+    AAudioStreamBuilder_setChannelCount(builder, 2);
+    AAudioStreamBuilder_setPerformanceMode(builder,
+                                           AAUDIO_PERFORMANCE_MODE_LOW_LATENCY);
+    AAudioStreamBuilder_setSharingMode(builder, AAUDIO_SHARING_MODE_SHARED);
+    if (requested_rate) {
+      AAudioStreamBuilder_setSampleRate(builder, int32_t(requested_rate));
+    }
+    AAudioStreamBuilder_setDataCallback(builder, DataCallback, this);
+    AAudioStreamBuilder_setErrorCallback(builder, ErrorCallback, this);
+    aaudio_result_t result = AAudioStreamBuilder_openStream(builder, &stream_);
+    AAudioStreamBuilder_delete(builder);
+    if (result != AAUDIO_OK) {
+      XELOGE("AAudio: cannot open an output stream: {}",
+             AAudio_convertResultToText(result));
+      stream_ = nullptr;
+      return false;
+    }
+
+    sample_rate_ = uint32_t(AAudioStream_getSampleRate(stream_));
+    burst_frames_ = uint32_t(AAudioStream_getFramesPerBurst(stream_));
+    // Two bursts of device buffering: the ring upstream carries the rest
+    AAudioStream_setBufferSizeInFrames(stream_, int32_t(burst_frames_ * 2));
+    disconnected_ = false;
+    XELOGI("AAudio: {} Hz, {} frames per burst, {}", sample_rate_,
+           burst_frames_,
+           AAudioStream_getPerformanceMode(stream_) ==
+                   AAUDIO_PERFORMANCE_MODE_LOW_LATENCY
+               ? "low latency"
+               : "normal latency");
+    return true;
+  }
+
+  bool Start(AudioRing* ring) override {
+    if (!stream_) return false;
+    ring_ = ring;
+    aaudio_result_t result = AAudioStream_requestStart(stream_);
+    if (result != AAUDIO_OK) {
+      XELOGE("AAudio: cannot start: {}", AAudio_convertResultToText(result));
+      return false;
+    }
+    return true;
+  }
+
+  void Close() override {
+    if (!stream_) return;
+    AAudioStream_requestStop(stream_);
+    AAudioStream_close(stream_);
+    stream_ = nullptr;
+  }
+
+ private:
+  static aaudio_data_callback_result_t DataCallback(AAudioStream*,
+                                                    void* user_data,
+                                                    void* audio_data,
+                                                    int32_t frames) {
+    static_cast<AAudioSink*>(user_data)->Render(static_cast<float*>(audio_data),
+                                                uint32_t(frames));
+    return AAUDIO_CALLBACK_RESULT_CONTINUE;
+  }
+
+  static void ErrorCallback(AAudioStream*, void* user_data, aaudio_result_t) {
+    // Reopening is not allowed from here; the mixer thread does it
+    static_cast<AAudioSink*>(user_data)->disconnected_.store(
+        true, std::memory_order_release);
+  }
+
+  AAudioStream* stream_ = nullptr;
+};
+
+}  // namespace
+
+std::unique_ptr<AudioSink> CreateAAudioSink() {
+  return std::make_unique<AAudioSink>();
+}
+
+}  // namespace xe::apu
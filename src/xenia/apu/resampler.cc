@@ -0,0 +1,171 @@
+/**
+ * Vera360 — Xenia Edge
+ * Polyphase resampler — windowed-sinc sample rate conversion
+ */
+
+#include "xenia/apu/resampler.h"
+#include "xenia/apu/vec4.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace xe::apu {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+// Taps before the output position; the rest are at or after it
+constexpr uint32_t kLookBehind = Resampler::kTaps / 2 - 1;
+constexpr uint32_t kLookAhead = Resampler::kTaps - kLookBehind;
+// The top bits of the fractional position pick the filter row
+constexpr uint32_t kPhaseBits = 6;
+static_assert(Resampler::kPhases == 1u << kPhaseBits);
+static_assert(Resampler::kTaps % 4 == 0);
+
+}  // namespace
+
+bool Resampler::Initialize(uint32_t channels, uint32_t in_rate,
+                           uint32_t out_rate) {
+  if (!channels || channels > kMaxChannels) return false;
+  channels_ = channels;
+  capacity_ = kMaxInputFrames + kTaps;
+  for (uint32_t ch = 0; ch < channels_; ++ch) {
+    input_[ch].assign(capacity_, 0.0f);
+  }
+  filter_.assign((kPhases + 1) * kTaps, 0.0f);
+  if (!SetRates(in_rate, out_rate)) return false;
+  Reset();
+  return true;
+}
+
+bool Resampler::SetRates(uint32_t in_rate, uint32_t out_rate) {
+  if (!in_rate || !out_rate || in_rate > out_rate * kMaxRatio) return false;
+  if (in_rate == in_rate_ && out_rate == out_rate_) return true;
+  in_rate_ = in_rate;
+  out_rate_ = out_rate;
+  step_ = (uint64_t(in_rate) << 32) / out_rate;
+  BuildFilter(in_rate > out_rate ? float(out_rate) / float(in_rate) : 1.0f);
+  return true;
+}
+
+void Resampler::Reset() {
+  // Start on silence so the first output sample has its look-behind
+  for (uint32_t ch = 0; ch < channels_; ++ch) {
+    std::fill(input_[ch].begin(), input_[ch].begin() + kLookBehind, 0.0f);
+  }
+  input_frames_ = kLookBehind;
+  position_ = uint64_t(kLookBehind) << 32;
+}
+
+void Resampler::BuildFilter(float cutoff) {
+  // Row p, tap k weighs input sample i - kLookBehind + k for an output at
+  // i + p / kPhases
+  constexpr double kHalfSpan = Resampler::kTaps / 2.0;
+  for (uint32_t p = 0; p <= kPhases; ++p) {
+    for (uint32_t k = 0; k < kTaps; ++k) {
+      double t = double(p) / kPhases + kLookBehind - k;
+      double x = kPi * cutoff * t;
+      double sinc = std::abs(x) < 1e-9 ? 1.0 : std::sin(x) / x;
+      double w = std::abs(t) >= kHalfSpan
+                     ? 0.0
+                     : 0.42 + 0.5 * std::cos(kPi * t / kHalfSpan) +
+                           0.08 * std::cos(2.0 * kPi * t / kHalfSpan);
+      filter_[p * kTaps + k] = static_cast<float>(cutoff * sinc * w);
+    }
+  }
+}
+
+uint32_t Resampler::InputNeeded(uint32_t out_frames) const {
+  if (!out_frames) return 0;
+  uint64_t last = (position_ + (out_frames - 1) * step_) >> 32;
+  uint64_t needed = last + kLookAhead;
+  return needed > input_frames_ ? static_cast<uint32_t>(needed - input_frames_)
+                                : 0;
+}
+
+uint32_t Resampler::OutputAvailable(uint32_t extra_input) const {
+  uint64_t total = uint64_t(input_frames_) + extra_input;
+  if (total < kLookAhead || !step_) return 0;
+  // Largest n whose last position still has kLookAhead frames after it
+  uint64_t end = (total - kLookAhead + 1) << 32;
+  if (position_ >= end) return 0;
+  uint64_t frames = (end - 1 - position_) / step_ + 1;
+  return static_cast<uint32_t>(std::min<uint64_t>(frames, UINT32_MAX));
+}
+
+uint32_t Resampler::Push(const float* const* in, uint32_t frames) {
+  if (input_frames_ + frames > capacity_) Compact();
+  frames = std::min(frames, capacity_ - input_frames_);
+  for (uint32_t ch = 0; ch < channels_; ++ch) {
+    memcpy(&input_[ch][input_frames_], in[ch], frames * sizeof(float));
+  }
+  input_frames_ += frames;
+  return frames;
+}
+
+uint32_t Resampler::PushInterleaved(const float* in, uint32_t frames) {
+  if (input_frames_ + frames > capacity_) Compact();
+  frames = std::min(frames, capacity_ - input_frames_);
+  for (uint32_t ch = 0; ch < channels_; ++ch) {
+    float* dst = &input_[ch][input_frames_];
+    for (uint32_t i = 0; i < frames; ++i) dst[i] = in[i * channels_ + ch];
+  }
+  input_frames_ += frames;
+  return frames;
+}
+
+void Resampler::Compact() {
+  uint32_t first = static_cast<uint32_t>(position_ >> 32) - kLookBehind;
+  if (!first) return;
+  for (uint32_t ch = 0; ch < channels_; ++ch) {
+    memmove(input_[ch].data(), &input_[ch][first],
+            (input_frames_ - first) * sizeof(float));
+  }
+  input_frames_ -= first;
+  position_ -= uint64_t(first) << 32;
+}
+
+uint32_t Resampler::Pull(float* const* out, uint32_t out_frames) {
+  const float* left = input_[0].data();
+  const float* right = channels_ > 1 ? input_[1].data() : nullptr;
+  uint32_t produced = 0;
+  for (; produced < out_frames; ++produced) {
+    uint32_t index = static_cast<uint32_t>(position_ >> 32);
+    if (index + kLookAhead > input_frames_) break;
+    uint32_t frac = static_cast<uint32_t>(position_);
+    // The remaining bits blend the row with the next one
+    uint32_t phase = frac >> (32 - kPhaseBits);
+    float blend = float(frac & ((1u << (32 - kPhaseBits)) - 1)) *
+                  (1.0f / float(1u << (32 - kPhaseBits)));
+    const float* row = &filter_[phase * kTaps];
+    const float* l = left + index - kLookBehind;
+#if XE_APU_NEON || XE_APU_SSE2
+    Vec4 b = Splat4(blend);
+    Vec4 acc_l = Splat4(0.0f), acc_r = Splat4(0.0f);
+    for (uint32_t k = 0; k < kTaps; k += 4) {
+      Vec4 t0 = Load4(row + k);
+      Vec4 taps = MulAdd4(t0, Sub4(Load4(row + kTaps + k), t0), b);
+      acc_l = MulAdd4(acc_l, Load4(l + k), taps);
+      if (right) {
+        acc_r = MulAdd4(acc_r, Load4(right + index - kLookBehind + k), taps);
+      }
+    }
+    out[0][produced] = Sum4(acc_l);
+    if (right) out[1][produced] = Sum4(acc_r);
+#else
+    float acc_l = 0.0f, acc_r = 0.0f;
+    for (uint32_t k = 0; k < kTaps; ++k) {
+      float tap = row[k] + (row[kTaps + k] - row[k]) * blend;
+      acc_l += l[k] * tap;
+      if (right) acc_r += right[index - kLookBehind + k] * tap;
+    }
+    out[0][produced] = acc_l;
+    if (right) out[1][produced] = acc_r;
+#endif
+    position_ += step_;
+  }
+  return produced;
+}
+
+}  // namespace xe::apu
@@ -0,0 +1,70 @@
+/**
+ * Vera360 — Xenia Edge
+ * Polyphase resampler — windowed-sinc sample rate conversion
+ *
+ * Converts a voice's PCM (24, 32, 44.1 or 48 kHz from XMA, anything from
+ * a submitted buffer) to the device rate. Each output sample is a 16-tap
+ * dot product with a filter phase interpolated from a 64-phase
+ * Blackman-windowed sinc table; the cutoff drops to the output Nyquist when
+ * downsampling. Taps run four lanes at a time on NEON or SSE2, and both
+ * channels of a stereo voice share one set of interpolated taps. All
+ * storage is sized in Initialize, so Push and Pull never allocate.
+ */
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace xe::apu {
+
+class Resampler {
+ public:
+  static constexpr uint32_t kTaps = 16;
+  static constexpr uint32_t kPhases = 64;
+  static constexpr uint32_t kMaxChannels = 2;
+  /// Input queued at most; bounds the output produced per Pull to
+  /// kMaxInputFrames * out_rate / in_rate
+  static constexpr uint32_t kMaxInputFrames = 4096;
+  /// Largest in_rate / out_rate
+  static constexpr uint32_t kMaxRatio = 8;
+
+  bool Initialize(uint32_t channels, uint32_t in_rate, uint32_t out_rate);
+  /// Switch rates mid-stream, keeping the queued input
+  bool SetRates(uint32_t in_rate, uint32_t out_rate);
+  /// Drop queued input and history
+  void Reset();
+
+  uint32_t channels() const { return channels_; }
+  uint32_t in_rate() const { return in_rate_; }
+  uint32_t out_rate() const { return out_rate_; }
+
+  /// Input frames to Push before out_frames more can be pulled
+  uint32_t InputNeeded(uint32_t out_frames) const;
+  /// Output frames Pull could produce once extra_input more are pushed
+  uint32_t OutputAvailable(uint32_t extra_input) const;
+  uint32_t input_space() const { return capacity_ - input_frames_; }
+
+  /// Queue planar input; the frames taken
+  uint32_t Push(const float* const* in, uint32_t frames);
+  /// Queue interleaved input (channels() samples per frame)
+  uint32_t PushInterleaved(const float* in, uint32_t frames);
+  /// Produce up to out_frames planar frames; the frames produced
+  uint32_t Pull(float* const* out, uint32_t out_frames);
+
+ private:
+  void BuildFilter(float cutoff);
+  /// Shift consumed input out, keeping the filter's look-behind
+  void Compact();
+
+  uint32_t channels_ = 0;
+  uint32_t in_rate_ = 0;
+  uint32_t out_rate_ = 0;
+  std::vector<float> filter_;  // kPhases + 1 rows of kTaps
+  std::vector<float> input_[kMaxChannels];
+  uint32_t capacity_ = 0;
+  uint32_t input_frames_ = 0;
+  uint64_t position_ = 0;  // 32.32 fixed point, in input_ frames
+  uint64_t step_ = 0;
+};
+
+}  // namespace xe::apu
@@ -0,0 +1,194 @@
+/**
+ * Vera360 — Xenia Edge
+ * Time stretch — WSOLA tempo change for the output stage
+ */
+
+#include "xenia/apu/time_stretch.h"
+#include "xenia/apu/vec4.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+
+namespace xe::apu {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+// Input kept queued at most, in frames
+constexpr uint32_t kCapacityFrames = 8;
+
+float Dot(const float* a, const float* b, uint32_t count) {
+  uint32_t i = 0;
+  float sum = 0.0f;
+#if XE_APU_NEON || XE_APU_SSE2
+  Vec4 acc = Splat4(0.0f);
+  for (; i + 4 <= count; i += 4) acc = MulAdd4(acc, Load4(a + i), Load4(b + i));
+  sum = Sum4(acc);
+#endif
+  for (; i < count; ++i) sum += a[i] * b[i];
+  return sum;
+}
+
+/// out = tail + in * window (first half); tail = in * window (second half)
+void OverlapHalf(const float* in, const float* window, uint32_t hop,
+                 float* tail, float* out) {
+  uint32_t i = 0;
+#if XE_APU_NEON || XE_APU_SSE2
+  for (; i + 4 <= hop; i += 4) {
+    Store4(out + i, MulAdd4(Load4(tail + i), Load4(in + i), Load4(window + i)));
+    Store4(tail + i, Mul4(Load4(in + hop + i), Load4(window + hop + i)));
+  }
+#endif
+  for (; i < hop; ++i) {
+    out[i] = tail[i] + in[i] * window[i];
+    tail[i] = in[hop + i] * window[hop + i];
+  }
+}
+
+}  // namespace
+
+bool TimeStretch::Initialize(uint32_t sample_rate) {
+  if (!sample_rate) return false;
+  frame_ = std::bit_ceil(std::max(sample_rate / 100, 64u));
+  hop_ = frame_ / 2;
+  tolerance_ = frame_ / 4;
+  // Periodic Hann: overlapping halves sum to exactly 1
+  window_.resize(frame_);
+  for (uint32_t i = 0; i < frame_; ++i) {
+    window_[i] = float(0.5 - 0.5 * std::cos(2.0 * kPi * i / frame_));
+  }
+  capacity_ = kCapacityFrames * frame_;
+  for (uint32_t ch = 0; ch < kChannels; ++ch) {
+    input_[ch].assign(capacity_, 0.0f);
+    tail_[ch].assign(hop_, 0.0f);
+    output_[ch].assign(hop_, 0.0f);
+  }
+  mono_.assign(capacity_, 0.0f);
+  Reset();
+  return true;
+}
+
+void TimeStretch::Reset() {
+  // Lead-in silence so the first search window starts inside the buffer
+  for (uint32_t ch = 0; ch < kChannels; ++ch) {
+    std::fill(input_[ch].begin(), input_[ch].begin() + tolerance_, 0.0f);
+    std::fill(tail_[ch].begin(), tail_[ch].end(), 0.0f);
+  }
+  std::fill(mono_.begin(), mono_.begin() + tolerance_, 0.0f);
+  input_frames_ = tolerance_;
+  position_ = tolerance_;
+  previous_ = 0;
+  first_ = true;
+  output_read_ = 0;
+  output_frames_ = 0;
+}
+
+void TimeStretch::set_ratio(float ratio) {
+  ratio_ = std::clamp(ratio, kMinRatio, kMaxRatio);
+}
+
+uint32_t TimeStretch::queued_frames() const {
+  int64_t consumed = std::max<int64_t>(int64_t(position_), 0);
+  return input_frames_ > consumed ? uint32_t(input_frames_ - consumed) : 0;
+}
+
+uint32_t TimeStretch::Push(const float* frames, uint32_t count) {
+  if (input_frames_ + count > capacity_) Compact();
+  count = std::min(count, capacity_ - input_frames_);
+  float* left = &input_[0][input_frames_];
+  float* right = &input_[1][input_frames_];
+  float* mono = &mono_[input_frames_];
+  for (uint32_t i = 0; i < count; ++i) {
+    left[i] = frames[i * 2];
+    right[i] = frames[i * 2 + 1];
+    mono[i] = left[i] + right[i];
+  }
+  input_frames_ += count;
+  return count;
+}
+
+uint32_t TimeStretch::Pull(float* frames, uint32_t count) {
+  uint32_t produced = 0;
+  while (produced < count) {
+    if (output_read_ == output_frames_) {
+      if (!CanStep()) break;
+      Step();
+    }
+    uint32_t n = std::min(count - produced, output_frames_ - output_read_);
+    for (uint32_t i = 0; i < n; ++i) {
+      frames[(produced + i) * 2] = output_[0][output_read_ + i];
+      frames[(produced + i) * 2 + 1] = output_[1][output_read_ + i];
+    }
+    output_read_ += n;
+    produced += n;
+  }
+  return produced;
+}
+
+bool TimeStretch::CanStep() const {
+  int64_t nominal = std::llround(position_);
+  int64_t last = std::max(nominal + tolerance_, previous_ + hop_);
+  return last + frame_ <= input_frames_;
+}
+
+int64_t TimeStretch::Search(int64_t natural, int64_t nominal) const {
+  // Normalized correlation of each candidate's leading half against the
+  // natural continuation's; the candidate energy slides along
+  const float* reference = &mono_[natural];
+  int64_t first = nominal - tolerance_;
+  float energy = Dot(&mono_[first], &mono_[first], hop_);
+  int64_t best = nominal;
+  float best_score = 0.0f;
+  for (int64_t start = first; start <= nominal + tolerance_; ++start) {
+    if (energy > 1e-9f) {
+      float score = Dot(reference, &mono_[start], hop_) / std::sqrt(energy);
+      if (score > best_score) {
+        best_score = score;
+        best = start;
+      }
+    }
+    float out = mono_[start], in = mono_[start + hop_];
+    energy = std::max(energy - out * out + in * in, 0.0f);
+  }
+  return best;
+}
+
+void TimeStretch::Step() {
+  int64_t nominal = std::llround(position_);
+  int64_t start = nominal;
+  if (!first_) {
+    int64_t natural = previous_ + hop_;
+    start = std::abs(natural - nominal) <= int64_t(tolerance_)
+                ? natural
+                : Search(natural, nominal);
+  }
+  for (uint32_t ch = 0; ch < kChannels; ++ch) {
+    OverlapHalf(&input_[ch][start], window_.data(), hop_, tail_[ch].data(),
+                output_[ch].data());
+  }
+  output_read_ = 0;
+  output_frames_ = hop_;
+  previous_ = start;
+  position_ += hop_ / ratio_;
+  first_ = false;
+}
+
+void TimeStretch::Compact() {
+  int64_t keep = std::min<int64_t>(std::llround(position_) - tolerance_,
+                                   previous_ + hop_);
+  if (first_) keep = std::llround(position_) - tolerance_;
+  if (keep <= 0) return;
+  uint32_t shift = uint32_t(keep);
+  for (uint32_t ch = 0; ch < kChannels; ++ch) {
+    memmove(input_[ch].data(), &input_[ch][shift],
+            (input_frames_ - shift) * sizeof(float));
+  }
+  memmove(mono_.data(), &mono_[shift], (input_frames_ - shift) * sizeof(float));
+  input_frames_ -= shift;
+  position_ -= shift;
+  previous_ -= shift;
+}
+
+}  // namespace xe::apu
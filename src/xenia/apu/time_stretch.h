@@ -0,0 +1,71 @@
+/**
+ * Vera360 — Xenia Edge
+ * Time stretch — WSOLA tempo change for the output stage
+ *
+ * Waveform-similarity overlap-add: the output is built from Hann-windowed
+ * frames overlapped by half. Each next frame is taken near its nominal
+ * input position (which advances by hop / ratio) at the offset that best
+ * matches the natural continuation of the previous frame, so the tempo
+ * changes without shifting pitch or clicking. While the natural
+ * continuation lies inside the search window it is taken as is, which at
+ * ratio 1 reproduces the input exactly and skips the search entirely.
+ * Correlation, windowing and overlap-add run on NEON or SSE2.
+ */
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace xe::apu {
+
+class TimeStretch {
+ public:
+  static constexpr uint32_t kChannels = 2;
+  static constexpr float kMinRatio = 0.75f;
+  static constexpr float kMaxRatio = 1.5f;
+
+  /// Frame length follows the rate (~10 ms)
+  bool Initialize(uint32_t sample_rate);
+  void Reset();
+
+  /// Output length over input length, clamped to [kMinRatio, kMaxRatio]
+  void set_ratio(float ratio);
+  float ratio() const { return ratio_; }
+
+  /// Queue interleaved stereo; the frames taken
+  uint32_t Push(const float* frames, uint32_t count);
+  /// Produce up to count interleaved stereo frames; the frames produced
+  uint32_t Pull(float* frames, uint32_t count);
+
+  /// Input frames queued and not yet consumed by a frame
+  uint32_t queued_frames() const;
+
+ private:
+  bool CanStep() const;
+  void Step();
+  /// Frame start in [nominal - tolerance, nominal + tolerance] that best
+  /// continues the frame that began at natural - hop
+  int64_t Search(int64_t natural, int64_t nominal) const;
+  void Compact();
+
+  uint32_t frame_ = 0;      // frame length, a power of two
+  uint32_t hop_ = 0;        // synthesis hop, frame / 2
+  uint32_t tolerance_ = 0;  // search radius
+  float ratio_ = 1.0f;
+
+  std::vector<float> window_;
+  std::vector<float> input_[kChannels];
+  std::vector<float> mono_;  // channel sum, for the similarity search
+  uint32_t capacity_ = 0;
+  uint32_t input_frames_ = 0;
+  double position_ = 0;  // nominal input position of the next frame
+  int64_t previous_ = 0;  // start of the last frame taken
+  bool first_ = true;
+
+  std::vector<float> tail_[kChannels];    // second half of the last frame
+  std::vector<float> output_[kChannels];  // one hop ready to pull
+  uint32_t output_read_ = 0;
+  uint32_t output_frames_ = 0;
+};
+
+}  // namespace xe::apu
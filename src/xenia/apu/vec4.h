@@ -0,0 +1,61 @@
+/**
+ * Vera360 — Xenia Edge
+ * Four-lane float helpers shared by the APU's DSP code
+ *
+ * NEON on ARM64, SSE2 on x86-64. XE_APU_NEON / XE_APU_SSE2 say which one
+ * is in use; with neither, callers keep their scalar loops.
+ */
+#pragma once
+
+#if defined(__aarch64__)
+#define XE_APU_NEON 1
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#define XE_APU_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace xe::apu {
+
+#if XE_APU_NEON
+using Vec4 = float32x4_t;
+inline Vec4 Load4(const float* p) { return vld1q_f32(p); }
+inline void Store4(float* p, Vec4 v) { vst1q_f32(p, v); }
+inline Vec4 Add4(Vec4 a, Vec4 b) { return vaddq_f32(a, b); }
+inline Vec4 Sub4(Vec4 a, Vec4 b) { return vsubq_f32(a, b); }
+inline Vec4 Mul4(Vec4 a, Vec4 b) { return vmulq_f32(a, b); }
+/// a + b * c
+inline Vec4 MulAdd4(Vec4 a, Vec4 b, Vec4 c) { return vmlaq_f32(a, b, c); }
+inline Vec4 Min4(Vec4 a, Vec4 b) { return vminq_f32(a, b); }
+inline Vec4 Max4(Vec4 a, Vec4 b) { return vmaxq_f32(a, b); }
+inline Vec4 Splat4(float v) { return vdupq_n_f32(v); }
+inline float Sum4(Vec4 v) { return vaddvq_f32(v); }
+/// Lanes in reverse order
+inline Vec4 Reverse4(Vec4 v) {
+  v = vrev64q_f32(v);
+  return vcombine_f32(vget_high_f32(v), vget_low_f32(v));
+}
+#elif XE_APU_SSE2
+using Vec4 = __m128;
+inline Vec4 Load4(const float* p) { return _mm_loadu_ps(p); }
+inline void Store4(float* p, Vec4 v) { _mm_storeu_ps(p, v); }
+inline Vec4 Add4(Vec4 a, Vec4 b) { return _mm_add_ps(a, b); }
+inline Vec4 Sub4(Vec4 a, Vec4 b) { return _mm_sub_ps(a, b); }
+inline Vec4 Mul4(Vec4 a, Vec4 b) { return _mm_mul_ps(a, b); }
+inline Vec4 MulAdd4(Vec4 a, Vec4 b, Vec4 c) {
+  return _mm_add_ps(a, _mm_mul_ps(b, c));
+}
+inline Vec4 Min4(Vec4 a, Vec4 b) { return _mm_min_ps(a, b); }
+inline Vec4 Max4(Vec4 a, Vec4 b) { return _mm_max_ps(a, b); }
+inline Vec4 Splat4(float v) { return _mm_set1_ps(v); }
+inline float Sum4(Vec4 v) {
+  __m128 pairs = _mm_add_ps(v, _mm_movehl_ps(v, v));
+  return _mm_cvtss_f32(
+      _mm_add_ss(pairs, _mm_shuffle_ps(pairs, pairs, _MM_SHUFFLE(1, 1, 1, 1))));
+}
+inline Vec4 Reverse4(Vec4 v) {
+  return _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 1, 2, 3));
+}
+#endif
+
+}  // namespace xe::apu
@@ -0,0 +1,682 @@
+/**
+ * Vera360 — Xenia Edge
+ * WMA Pro frame decoder — bitstream parsing and reconstruction
+ */
+
+#include "xenia/apu/wma_frame.h"
+#include "xenia/apu/wma_tables.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace xe::apu {
+
+namespace {
+
+constexpr uint32_t kFrameLengthBits = 15;
+/// Quantizer base for 16-bit streams (90 * bits_per_sample / 16)
+constexpr int32_t kQuantStepBase = 90;
+/// Gain on bands a stereo transform leaves out (181 / 128 ~ sqrt(2))
+constexpr float kUntransformedGain = 181.0f / 128.0f;
+constexpr float kStereoMatrix[4] = {1.0f, -1.0f, 1.0f, 1.0f};
+
+inline uint32_t Log2(uint32_t v) { return 31 - __builtin_clz(v); }
+
+}  // namespace
+
+// ── Bit reader ───────────────────────────────────────────────────────────────
+
+namespace wma {
+
+/// MSB-first reader over one frame. Reads past the end return zeros and
+/// leave overrun() set.
+class BitReader {
+ public:
+  BitReader(const uint8_t* data, uint32_t bit_count)
+      : data_(data), bit_count_(bit_count) {}
+
+  uint32_t position() const { return position_; }
+  uint32_t left() const {
+    return position_ < bit_count_ ? bit_count_ - position_ : 0;
+  }
+  bool overrun() const { return position_ > bit_count_; }
+
+  /// The next 32 bits, left-aligned
+  uint32_t Peek32() const {
+    if (position_ >= bit_count_) return 0;
+    const uint8_t* p = data_ + (position_ >> 3);
+    uint64_t v = 0;
+    for (int i = 0; i < 8; ++i) v = (v << 8) | p[i];
+    uint32_t bits = uint32_t((v << (position_ & 7)) >> 32);
+    uint32_t left = bit_count_ - position_;
+    return left < 32 ? bits & (~0u << (32 - left)) : bits;
+  }
+
+  /// count bits (at most 32) as an unsigned value
+  uint32_t Read(uint32_t count) {
+    if (!count) return 0;
+    uint32_t v = Peek32() >> (32 - count);
+    position_ += count;
+    return v;
+  }
+  int32_t ReadSigned(uint32_t count) {
+    return int32_t(Read(count) << (32 - count)) >> (32 - count);
+  }
+  bool ReadBit() { return Read(1) != 0; }
+  void Skip(uint32_t count) { position_ += count; }
+
+  /// Escaped magnitude: 8 bits, widened to 16, 24 or 31 by flag bits
+  uint32_t ReadLargeValue() {
+    uint32_t count = 8;
+    if (ReadBit()) {
+      count += 8;
+      if (ReadBit()) {
+        count += 8;
+        if (ReadBit()) count += 7;
+      }
+    }
+    return Read(count);
+  }
+
+ private:
+  const uint8_t* data_;
+  uint32_t bit_count_;
+  uint32_t position_ = 0;
+};
+
+}  // namespace wma
+
+namespace {
+
+// ── Huffman tables ───────────────────────────────────────────────────────────
+
+/// A codebook with codes rebuilt from its lengths. Codes of up to
+/// kLookupBits resolve in one table lookup; longer ones by binary search
+/// over the codes, which are sorted by construction.
+class HuffmanTable {
+ public:
+  void Build(const wma::Codebook& book) {
+    codes_.resize(book.count);
+    uint64_t code = 0;
+    for (uint32_t i = 0; i < book.count; ++i) {
+      codes_[i].code = uint32_t(code);
+      codes_[i].length = book.lengths[i];
+      codes_[i].symbol = int16_t(book.symbols[i] + book.symbol_offset);
+      code += uint64_t(1) << (32 - book.lengths[i]);
+    }
+    for (uint32_t i = 0; i < (1u << kLookupBits); ++i) {
+      const Code& c = Find(i << (32 - kLookupBits));
+      lookup_[i] = c.length <= kLookupBits ? Entry{c.symbol, c.length}
+                                           : Entry{0, 0};
+    }
+  }
+
+  int32_t Decode(wma::BitReader& bits) const {
+    uint32_t window = bits.Peek32();
+    Entry e = lookup_[window >> (32 - kLookupBits)];
+    if (e.length) {
+      bits.Skip(e.length);
+      return e.symbol;
+    }
+    const Code& c = Find(window);
+    bits.Skip(c.length);
+    return c.symbol;
+  }
+
+ private:
+  static constexpr uint32_t kLookupBits = 9;
+
+  struct Code {
+    uint32_t code;
+    int16_t symbol;
+    uint8_t length;
+  };
+  struct Entry {
+    int16_t symbol;
+    uint8_t length;  // 0: longer than kLookupBits
+  };
+
+  /// The code window starts with (the codes are complete, so one does)
+  const Code& Find(uint32_t window) const {
+    auto it = std::upper_bound(
+        codes_.begin(), codes_.end(), window,
+        [](uint32_t v, const Code& c) { return v < c.code; });
+    return *(it - 1);
+  }
+
+  std::vector<Code> codes_;
+  Entry lookup_[1 << kLookupBits];
+};
+
+struct Codebooks {
+  HuffmanTable scale;
+  HuffmanTable scale_run_level;
+  HuffmanTable coefficients[2];
+  HuffmanTable vec4;
+  HuffmanTable vec2;
+  HuffmanTable vec1;
+
+  Codebooks() {
+    scale.Build(wma::kScaleCodebook);
+    scale_run_level.Build(wma::kScaleRunLevelCodebook);
+    coefficients[0].Build(wma::kCoefCodebooks[0]);
+    coefficients[1].Build(wma::kCoefCodebooks[1]);
+    vec4.Build(wma::kVec4Codebook);
+    vec2.Build(wma::kVec2Codebook);
+    vec1.Build(wma::kVec1Codebook);
+  }
+};
+
+/// Shared by every context; built on first use
+const Codebooks& GetCodebooks() {
+  static const Codebooks codebooks;
+  return codebooks;
+}
+
+}  // namespace
+
+// ── Setup ────────────────────────────────────────────────────────────────────
+
+bool WmaFrameDecoder::Initialize() {
+  GetCodebooks();
+  for (uint32_t i = 0; i < kBlockSizes; ++i) {
+    uint32_t length = kSamplesPerFrame >> i;
+    if (!imdct_[i].Initialize(length * 2)) return false;
+    // Windows by overlap length, shortest first
+    uint32_t window_length = kMinSubframeLength << i;
+    windows_[i].resize(window_length);
+    SineWindow(window_length, windows_[i].data());
+  }
+  scratch_.assign(kSamplesPerFrame, 0.0f);
+  return true;
+}
+
+void WmaFrameDecoder::Configure(uint32_t channels, uint32_t sample_rate) {
+  if (channels == channel_count_ && sample_rate == sample_rate_) return;
+  channel_count_ = std::min(channels, kMaxChannels);
+  sample_rate_ = sample_rate;
+
+  // Scale factor bands: the critical frequencies at this block size, on
+  // 4-coefficient boundaries
+  for (uint32_t i = 0; i < kBlockSizes; ++i) {
+    uint32_t length = kSamplesPerFrame >> i;
+    uint32_t* offsets = band_offsets_[i];
+    uint32_t band = 1;
+    offsets[0] = 0;
+    for (uint32_t x = 0; x < kMaxBands - 1 && offsets[band - 1] < length;
+         ++x) {
+      uint32_t offset =
+          ((length * 2 * wma::kCriticalFrequencies[x]) / sample_rate + 2) &
+          ~3u;
+      if (offset > offsets[band - 1]) offsets[band++] = offset;
+      if (offset >= length) break;
+    }
+    offsets[band - 1] = length;
+    band_count_[i] = band - 1;
+  }
+
+  for (uint32_t to = 0; to < kBlockSizes; ++to) {
+    for (uint32_t b = 0; b < band_count_[to]; ++b) {
+      uint32_t middle =
+          ((band_offsets_[to][b] + band_offsets_[to][b + 1] - 1) << to) >> 1;
+      for (uint32_t from = 0; from < kBlockSizes; ++from) {
+        uint32_t v = 0;
+        while (v + 1 < band_count_[from] &&
+               (band_offsets_[from][v + 1] << from) < middle) {
+          ++v;
+        }
+        resample_band_[to][from][b] = uint8_t(v);
+      }
+    }
+  }
+  Reset();
+}
+
+void WmaFrameDecoder::Reset() {
+  for (Channel& channel : channels_) {
+    channel.previous_block_length = kSamplesPerFrame;
+    channel.reuse_scale_factors = false;
+    channel.saved_index = 0;
+    channel.scale_factors = channel.saved_scale_factors[0];
+    std::fill(std::begin(channel.out), std::end(channel.out), 0.0f);
+  }
+}
+
+// ── Frame ────────────────────────────────────────────────────────────────────
+
+bool WmaFrameDecoder::Decode(const uint8_t* data, uint32_t bit_count,
+                             float* const* pcm) {
+  BitReader bits(data, bit_count);
+  bool ok = bits.Read(kFrameLengthBits) == bit_count && channel_count_ &&
+            DecodeTileHeader(bits);
+  if (ok) {
+    // Post-processing matrix, for the host's downmix: not applied
+    if (channel_count_ > 1 && bits.ReadBit() && bits.ReadBit()) {
+      bits.Skip(4 * channel_count_ * channel_count_);
+    }
+    bits.Skip(8);  // dynamic range compression gain
+    if (bits.ReadBit()) {
+      // Encoder delay and padding, in samples
+      uint32_t skip_bits = Log2(kSamplesPerFrame * 2);
+      if (bits.ReadBit()) bits.Skip(skip_bits);
+      if (bits.ReadBit()) bits.Skip(skip_bits);
+    }
+
+    for (uint32_t c = 0; c < channel_count_; ++c) {
+      channels_[c].decoded_samples = 0;
+      channels_[c].current_subframe = 0;
+      channels_[c].reuse_scale_factors = false;
+    }
+    bool last = false;
+    while (ok && !last) ok = DecodeSubframe(bits, &last);
+    // Two trailer bits (the second says whether more frames follow)
+    ok = ok && !bits.overrun() && bits.position() + 2 == bit_count;
+  }
+
+  if (!ok) {
+    Reset();
+    for (uint32_t c = 0; c < channel_count_; ++c) {
+      std::fill(pcm[c], pcm[c] + kSamplesPerFrame, 0.0f);
+    }
+    return false;
+  }
+  for (uint32_t c = 0; c < channel_count_; ++c) {
+    float* out = channels_[c].out;
+    memcpy(pcm[c], out, kSamplesPerFrame * sizeof(float));
+    // The second half of the last block overlaps the next frame
+    memcpy(out, out + kSamplesPerFrame, kSamplesPerFrame / 2 * sizeof(float));
+  }
+  return true;
+}
+
+bool WmaFrameDecoder::DecodeTileHeader(BitReader& bits) {
+  // Subframes are laid out in time order across channels: each step adds
+  // one length to the channels (among those furthest behind) that a mask
+  // selects, unless every channel shares one layout
+  uint32_t samples[kMaxChannels] = {};
+  bool contains[kMaxChannels];
+  uint32_t subframe_channels = channel_count_;
+  uint32_t min_length = 0;
+  for (uint32_t c = 0; c < channel_count_; ++c) {
+    channels_[c].subframe_count = 0;
+  }
+  bool fixed_layout = bits.ReadBit();
+
+  do {
+    for (uint32_t c = 0; c < channel_count_; ++c) {
+      if (samples[c] == min_length) {
+        contains[c] =
+            fixed_layout || subframe_channels == 1 ||
+            min_length == kSamplesPerFrame - kMinSubframeLength ||
+            bits.ReadBit();
+      } else {
+        contains[c] = false;
+      }
+    }
+
+    int32_t length = DecodeSubframeLength(bits, min_length);
+    if (length <= 0) return false;
+
+    min_length += uint32_t(length);
+    for (uint32_t c = 0; c < channel_count_; ++c) {
+      Channel& channel = channels_[c];
+      if (contains[c]) {
+        samples[c] += uint32_t(length);
+        if (samples[c] > kSamplesPerFrame ||
+            channel.subframe_count >= kMaxSubframes) {
+          return false;
+        }
+        channel.subframe_length[channel.subframe_count++] = uint32_t(length);
+      } else if (samples[c] <= min_length) {
+        if (samples[c] < min_length) {
+          subframe_channels = 0;
+          min_length = samples[c];
+        }
+        ++subframe_channels;
+      }
+    }
+  } while (min_length < kSamplesPerFrame);
+  return !bits.overrun();
+}
+
+int32_t WmaFrameDecoder::DecodeSubframeLength(BitReader& bits,
+                                              uint32_t offset) {
+  // The last slot of a frame can only hold the shortest subframe
+  if (offset == kSamplesPerFrame - kMinSubframeLength) {
+    return kMinSubframeLength;
+  }
+  if (bits.overrun()) return -1;
+  uint32_t shift = 0;
+  if (bits.ReadBit()) shift = 1 + bits.Read(1);
+  return int32_t(kSamplesPerFrame >> shift);
+}
+
+// ── Subframe ─────────────────────────────────────────────────────────────────
+
+bool WmaFrameDecoder::DecodeSubframe(BitReader& bits, bool* last) {
+  // The next subframe is the one of the channel furthest behind; every
+  // channel with a subframe of the same start and length shares it
+  uint32_t offset = kSamplesPerFrame;
+  uint32_t length = kSamplesPerFrame;
+  for (uint32_t c = 0; c < channel_count_; ++c) {
+    Channel& channel = channels_[c];
+    if (offset > channel.decoded_samples) {
+      if (channel.current_subframe >= channel.subframe_count) return false;
+      offset = channel.decoded_samples;
+      length = channel.subframe_length[channel.current_subframe];
+    }
+  }
+  uint32_t remaining = kSamplesPerFrame * channel_count_;
+  subframe_channel_count_ = 0;
+  for (uint32_t c = 0; c < channel_count_; ++c) {
+    Channel& channel = channels_[c];
+    remaining -= channel.decoded_samples;
+    if (offset == channel.decoded_samples &&
+        channel.current_subframe < channel.subframe_count &&
+        length == channel.subframe_length[channel.current_subframe]) {
+      remaining -= length;
+      channel.decoded_samples += length;
+      subframe_channels_[subframe_channel_count_++] = c;
+    }
+  }
+  *last = remaining == 0;
+
+  table_index_ = Log2(kSamplesPerFrame / length);
+  subframe_length_ = length;
+  escape_bits_ = Log2(length - 1) + 1;
+  uint32_t band_count = band_count_[table_index_];
+  const uint32_t* band_offsets = band_offsets_[table_index_];
+  for (uint32_t i = 0; i < subframe_channel_count_; ++i) {
+    Channel& channel = channels_[subframe_channels_[i]];
+    channel.coefficients = channel.out + offset + kSamplesPerFrame / 2;
+  }
+
+  // Extension header: fill bits
+  if (bits.ReadBit()) {
+    uint32_t fill = bits.Read(2);
+    if (!fill) fill = bits.Read(bits.Read(4)) + 1;
+    bits.Skip(fill);
+    if (bits.overrun()) return false;
+  }
+  if (bits.ReadBit()) return false;  // reserved
+  if (!DecodeChannelTransform(bits)) return false;
+
+  bool transmit = false;
+  for (uint32_t i = 0; i < subframe_channel_count_; ++i) {
+    Channel& channel = channels_[subframe_channels_[i]];
+    channel.transmit_coefficients = bits.ReadBit();
+    transmit |= channel.transmit_coefficients;
+  }
+
+  if (transmit) {
+    transmit_vector_counts_ = bits.ReadBit();
+    for (uint32_t i = 0; i < subframe_channel_count_; ++i) {
+      Channel& channel = channels_[subframe_channels_[i]];
+      channel.vector_coefficients = length;
+      if (transmit_vector_counts_) {
+        channel.vector_coefficients = bits.Read(Log2((length + 3) / 4) + 1)
+                                      << 2;
+        if (channel.vector_coefficients > length) return false;
+      }
+    }
+
+    // Quantizer, with an open-ended escape at either end of the 6-bit step
+    int32_t step = bits.ReadSigned(6);
+    int32_t quant_step = kQuantStepBase + step;
+    if (step == -32 || step == 31) {
+      int32_t sign = step == 31 ? 0 : -1;
+      int32_t quant = 0;
+      while (bits.left() > 5 && (step = int32_t(bits.Read(5))) == 31) {
+        quant += 31;
+      }
+      quant_step += ((quant + step) ^ sign) - sign;
+    }
+    if (subframe_channel_count_ == 1) {
+      channels_[subframe_channels_[0]].quant_step = quant_step;
+    } else {
+      uint32_t modifier_bits = bits.Read(3);
+      for (uint32_t i = 0; i < subframe_channel_count_; ++i) {
+        Channel& channel = channels_[subframe_channels_[i]];
+        channel.quant_step = quant_step;
+        if (bits.ReadBit()) {
+          channel.quant_step +=
+              modifier_bits ? int32_t(bits.Read(modifier_bits)) + 1 : 1;
+        }
+      }
+    }
+    if (!DecodeScaleFactors(bits)) return false;
+  }
+
+  for (uint32_t i = 0; i < subframe_channel_count_; ++i) {
+    Channel& channel = channels_[subframe_channels_[i]];
+    if (channel.transmit_coefficients && !bits.overrun()) {
+      DecodeCoefficients(bits, channel);
+    } else {
+      std::fill(channel.coefficients, channel.coefficients + length, 0.0f);
+    }
+  }
+
+  if (transmit) {
+    InverseChannelTransform();
+    // Dequantize per band, folding in the transform's 2 / length, the
+    // 16-bit full scale and WMA Pro's sign (its inverse MDCT is the negated
+    // textbook one), then back to time domain in place
+    float scale = -2.0f / float(length) / 32768.0f;
+    float* scratch = scratch_.data();
+    for (uint32_t i = 0; i < subframe_channel_count_; ++i) {
+      Channel& channel = channels_[subframe_channels_[i]];
+      for (uint32_t b = 0; b < band_count; ++b) {
+        uint32_t start = band_offsets[b];
+        uint32_t end = std::min(band_offsets[b + 1], length);
+        int32_t exponent =
+            channel.quant_step -
+            (channel.max_scale_factor - channel.scale_factors[b]) *
+                channel.scale_factor_step;
+        float gain = float(std::pow(10.0, exponent / 20.0)) * scale;
+        for (uint32_t k = start; k < end; ++k) {
+          scratch[k] = channel.coefficients[k] * gain;
+        }
+      }
+      imdct_[table_index_].TransformHalf(scratch, channel.coefficients);
+    }
+  }
+
+  // Overlap with the previous block over the shorter of the two lengths
+  for (uint32_t i = 0; i < subframe_channel_count_; ++i) {
+    Channel& channel = channels_[subframe_channels_[i]];
+    uint32_t window = std::min(channel.previous_block_length, length);
+    WindowOverlap(channel.coefficients - window / 2,
+                  windows_[Log2(window / kMinSubframeLength)].data(),
+                  window / 2);
+    channel.previous_block_length = length;
+    ++channel.current_subframe;
+  }
+  return !bits.overrun();
+}
+
+bool WmaFrameDecoder::DecodeChannelTransform(BitReader& bits) {
+  stereo_transform_ = false;
+  if (channel_count_ < 2) return true;
+  // Multichannel transform escape; XMA streams are at most stereo
+  if (bits.ReadBit()) return false;
+  if (subframe_channel_count_ != 2) return true;
+
+  if (bits.ReadBit()) {
+    // No transform; the other escape is an unknown transform type
+    if (bits.ReadBit()) return false;
+  } else {
+    stereo_transform_ = true;
+  }
+  if (stereo_transform_) {
+    uint32_t band_count = band_count_[table_index_];
+    bool all_bands = bits.ReadBit();
+    for (uint32_t b = 0; b < band_count; ++b) {
+      transform_band_[b] = all_bands || bits.ReadBit();
+    }
+  }
+  return true;
+}
+
+void WmaFrameDecoder::InverseChannelTransform() {
+  if (!stereo_transform_) return;
+  float* a = channels_[subframe_channels_[0]].coefficients;
+  float* b = channels_[subframe_channels_[1]].coefficients;
+  const uint32_t* band_offsets = band_offsets_[table_index_];
+  for (uint32_t band = 0; band < band_count_[table_index_]; ++band) {
+    uint32_t start = band_offsets[band];
+    uint32_t end = std::min(band_offsets[band + 1], subframe_length_);
+    if (transform_band_[band]) {
+      ApplyChannelTransform(a + start, b + start, end - start, kStereoMatrix);
+    } else {
+      for (uint32_t k = start; k < end; ++k) {
+        a[k] *= kUntransformedGain;
+        b[k] *= kUntransformedGain;
+      }
+    }
+  }
+}
+
+bool WmaFrameDecoder::DecodeScaleFactors(BitReader& bits) {
+  const Codebooks& books = GetCodebooks();
+  uint32_t band_count = band_count_[table_index_];
+  for (uint32_t i = 0; i < subframe_channel_count_; ++i) {
+    Channel& channel = channels_[subframe_channels_[i]];
+    int32_t* saved = channel.saved_scale_factors[channel.saved_index];
+    channel.scale_factors = channel.saved_scale_factors[!channel.saved_index];
+    int32_t* sf = channel.scale_factors;
+
+    // Resample the last transmitted set to this block size's bands; it
+    // stays the reference until a new one is sent
+    if (channel.reuse_scale_factors) {
+      const uint8_t* map = resample_band_[table_index_][channel.saved_table];
+      for (uint32_t b = 0; b < band_count; ++b) sf[b] = saved[map[b]];
+    }
+
+    if (!channel.current_subframe || bits.ReadBit()) {
+      if (!channel.reuse_scale_factors) {
+        // DPCM from a fixed start
+        channel.scale_factor_step = int32_t(bits.Read(2)) + 1;
+        int32_t value = 45 / channel.scale_factor_step;
+        for (uint32_t b = 0; b < band_count; ++b) {
+          value += books.scale.Decode(bits);
+          sf[b] = value;
+        }
+      } else {
+        // Run/level coded corrections to the resampled set
+        for (uint32_t b = 0; b < band_count; ++b) {
+          int32_t index = books.scale_run_level.Decode(bits);
+          int32_t level, sign;
+          uint32_t run;
+          if (index == 0) {
+            uint32_t code = bits.Read(14);
+            level = int32_t(code >> 6);
+            sign = int32_t(code & 1) - 1;
+            run = (code & 0x3F) >> 1;
+          } else if (index == 1) {
+            break;
+          } else {
+            run = wma::kScaleRunLevelRun[index];
+            level = wma::kScaleRunLevelLevel[index];
+            sign = int32_t(bits.ReadBit()) - 1;
+          }
+          b += run;
+          if (b >= band_count) return false;
+          sf[b] += (level ^ sign) - sign;
+        }
+      }
+      channel.saved_index ^= 1;
+      channel.saved_table = table_index_;
+      channel.reuse_scale_factors = true;
+    }
+
+    channel.max_scale_factor = *std::max_element(sf, sf + band_count);
+  }
+  return !bits.overrun();
+}
+
+void WmaFrameDecoder::DecodeCoefficients(BitReader& bits, Channel& channel) {
+  const Codebooks& books = GetCodebooks();
+  float* coefficients = channel.coefficients;
+  uint32_t length = subframe_length_;
+  uint32_t table = bits.Read(1);
+  const uint16_t* runs = table ? wma::kCoef1Run : wma::kCoef0Run;
+  const float* levels = table ? wma::kCoef1Level : wma::kCoef0Level;
+
+  // Vector coded: four magnitudes per symbol, escaping to pairs and then
+  // single values. Signs follow for the nonzero ones (a 0 bit is
+  // negative). Without explicit vector counts, a run of more than
+  // length / 256 zeros hands over to run/level coding.
+  uint32_t current = 0;
+  uint32_t zeros = 0;
+  bool run_level = false;
+  while ((transmit_vector_counts_ || !run_level) &&
+         current + 3 < channel.vector_coefficients) {
+    uint32_t values[4];
+    int32_t index = books.vec4.Decode(bits);
+    if (index < 0) {
+      for (uint32_t i = 0; i < 4; i += 2) {
+        index = books.vec2.Decode(bits);
+        if (index < 0) {
+          for (uint32_t j = i; j < i + 2; ++j) {
+            values[j] = uint32_t(books.vec1.Decode(bits));
+            if (values[j] == wma::kVec1Escape) {
+              values[j] += bits.ReadLargeValue();
+            }
+          }
+        } else {
+          values[i] = uint32_t(index) >> 4;
+          values[i + 1] = uint32_t(index) & 0xF;
+        }
+      }
+    } else {
+      values[0] = uint32_t(index) >> 12;
+      values[1] = (uint32_t(index) >> 8) & 0xF;
+      values[2] = (uint32_t(index) >> 4) & 0xF;
+      values[3] = uint32_t(index) & 0xF;
+    }
+    for (uint32_t i = 0; i < 4; ++i) {
+      if (values[i]) {
+        float v = float(values[i]);
+        coefficients[current] = bits.ReadBit() ? v : -v;
+        zeros = 0;
+      } else {
+        coefficients[current] = 0.0f;
+        run_level |= ++zeros > (length >> 8);
+      }
+      ++current;
+    }
+  }
+  if (current >= length) return;
+
+  // Run/level coded: 0 escapes to an explicit level and run, 1 ends the
+  // block. Positions wrap within the block, as the reference decoder's do.
+  std::fill(coefficients + current, coefficients + length, 0.0f);
+  const HuffmanTable& book = books.coefficients[table];
+  uint32_t mask = length - 1;
+  for (uint32_t offset = current; offset < length && !bits.overrun();
+       ++offset) {
+    int32_t code = book.Decode(bits);
+    if (code > 1) {
+      offset += runs[code];
+      float level = levels[code];
+      coefficients[offset & mask] = bits.ReadBit() ? level : -level;
+    } else if (code == 1) {
+      break;
+    } else {
+      int32_t level = int32_t(bits.ReadLargeValue());
+      if (bits.ReadBit()) {
+        if (bits.ReadBit()) {
+          if (bits.ReadBit()) return;  // broken escape
+          offset += bits.Read(escape_bits_) + 4;
+        } else {
+          offset += bits.Read(2) + 1;
+        }
+      }
+      coefficients[offset & mask] =
+          bits.ReadBit() ? float(level) : -float(level);
+    }
+  }
+}
+
+}  // namespace xe::apu
@@ -0,0 +1,124 @@
+/**
+ * Vera360 — Xenia Edge
+ * WMA Pro frame decoder — tiling, channel transforms, scale factors and
+ * Huffman-coded coefficients
+ *
+ * The front half of an XMA decoder: one frame's bits in, 512 samples per
+ * channel out. A frame is tiled into subframes of 512, 256 or 128 samples
+ * per channel. Each subframe carries a stereo transform (per band), a
+ * quantizer, scale factors per band (DPCM coded, or run/level coded
+ * against the previous ones resampled to the new band layout) and the
+ * coefficients: vector coded while they are dense, run/level coded after.
+ * Synthesis (inverse MDCT, window overlap between subframes) is the back
+ * half, in wma_synthesis.
+ *
+ * XMA fixes the stream parameters WMA Pro leaves open: 16-bit, 512-sample
+ * frames of at most four subframes, each led by its length and carrying
+ * dynamic range information.
+ */
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "xenia/apu/wma_synthesis.h"
+
+namespace xe::apu {
+
+namespace wma {
+class BitReader;
+}  // namespace wma
+
+class WmaFrameDecoder {
+ public:
+  static constexpr uint32_t kSamplesPerFrame = 512;
+  static constexpr uint32_t kMaxChannels = 2;
+  /// Slack the frame buffer needs past its last byte
+  static constexpr uint32_t kReadPadding = 8;
+
+  bool Initialize();
+
+  /// Set the stream format; the decoder resets when it changes
+  void Configure(uint32_t channels, uint32_t sample_rate);
+  /// Forget the overlap carried from the previous frame
+  void Reset();
+
+  /// Decode one frame of bit_count bits (from its length field on) into
+  /// kSamplesPerFrame samples per channel. data must be readable for
+  /// kReadPadding bytes past the frame. A corrupt frame decodes to silence
+  /// and resets the decoder (false).
+  bool Decode(const uint8_t* data, uint32_t bit_count, float* const* pcm);
+
+ private:
+  static constexpr uint32_t kMaxSubframes = 4;
+  static constexpr uint32_t kMinSubframeLength =
+      kSamplesPerFrame / kMaxSubframes;
+  static constexpr uint32_t kBlockSizes = 3;  // 512, 256, 128
+  static constexpr uint32_t kMaxBands = 29;
+
+  struct Channel {
+    // Tiling of the current frame
+    uint32_t subframe_count = 0;
+    uint32_t subframe_length[kMaxSubframes] = {};
+    uint32_t current_subframe = 0;
+    uint32_t decoded_samples = 0;
+    uint32_t previous_block_length = kSamplesPerFrame;
+
+    // Current subframe
+    bool transmit_coefficients = false;
+    uint32_t vector_coefficients = 0;
+    int32_t quant_step = 0;
+    float* coefficients = nullptr;
+
+    // Scale factors: the last transmitted set and the one in use (possibly
+    // resampled from it), alternating between saved_scale_factors
+    bool reuse_scale_factors = false;
+    uint32_t saved_index = 0;
+    uint32_t saved_table = 0;  // block size index of the transmitted set
+    int32_t saved_scale_factors[2][kMaxBands] = {};
+    int32_t* scale_factors = saved_scale_factors[0];
+    int32_t scale_factor_step = 1;
+    int32_t max_scale_factor = 0;
+
+    /// Synthesis output: the current frame at kSamplesPerFrame / 2, after
+    /// the half block carried over from the previous one
+    float out[kSamplesPerFrame * 3 / 2] = {};
+  };
+
+  using BitReader = wma::BitReader;
+
+  bool DecodeTileHeader(BitReader& bits);
+  int32_t DecodeSubframeLength(BitReader& bits, uint32_t offset);
+  bool DecodeSubframe(BitReader& bits, bool* last);
+  bool DecodeChannelTransform(BitReader& bits);
+  bool DecodeScaleFactors(BitReader& bits);
+  void DecodeCoefficients(BitReader& bits, Channel& channel);
+  void InverseChannelTransform();
+
+  uint32_t channel_count_ = 0;
+  uint32_t sample_rate_ = 0;
+  Channel channels_[kMaxChannels];
+
+  // Band layout per block size (index = log2(kSamplesPerFrame / length))
+  uint32_t band_count_[kBlockSizes] = {};
+  uint32_t band_offsets_[kBlockSizes][kMaxBands + 1] = {};
+  /// For resampling scale factors: band of a set transmitted at block size
+  /// [from] covering the middle of band b at block size [to]
+  uint8_t resample_band_[kBlockSizes][kBlockSizes][kMaxBands] = {};
+
+  // Current subframe
+  uint32_t subframe_channels_[kMaxChannels] = {};
+  uint32_t subframe_channel_count_ = 0;
+  uint32_t subframe_length_ = 0;
+  uint32_t table_index_ = 0;
+  uint32_t escape_bits_ = 0;
+  bool transmit_vector_counts_ = false;
+  bool stereo_transform_ = false;
+  bool transform_band_[kMaxBands] = {};
+
+  Imdct imdct_[kBlockSizes];
+  std::vector<float> windows_[kBlockSizes];
+  std::vector<float> scratch_;
+};
+
+}  // namespace xe::apu
@@ -0,0 +1,293 @@
+/**
+ * Vera360 — Xenia Edge
+ * WMA Pro synthesis — NEON / SSE2 / scalar back-ends
+ */
+
+#include "xenia/apu/wma_synthesis.h"
+#include "xenia/apu/vec4.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace xe::apu {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+inline int16_t ToS16(float v) {
+  float s = std::clamp(v * 32768.0f, -32768.0f, 32767.0f);
+  return static_cast<int16_t>(std::lrint(s));
+}
+
+inline void StoreBE16(uint8_t* p, int16_t v) {
+  p[0] = static_cast<uint8_t>(static_cast<uint16_t>(v) >> 8);
+  p[1] = static_cast<uint8_t>(v);
+}
+
+}  // namespace
+
+// ── Imdct ────────────────────────────────────────────────────────────────────
+
+const char* Imdct::backend_name() {
+#if XE_APU_NEON
+  return "neon";
+#elif XE_APU_SSE2
+  return "sse2";
+#else
+  return "scalar";
+#endif
+}
+
+bool Imdct::Initialize(uint32_t size) {
+  if (size < 16 || size > 8192 || (size & (size - 1))) return false;
+  size_ = size;
+  uint32_t n4 = size / 4;
+
+  twiddle_cos_.resize(n4);
+  twiddle_sin_.resize(n4);
+  for (uint32_t i = 0; i < n4; ++i) {
+    double alpha = 2.0 * kPi * (i + 0.125) / size;
+    twiddle_cos_[i] = static_cast<float>(std::cos(alpha));
+    twiddle_sin_[i] = static_cast<float>(std::sin(alpha));
+  }
+
+  uint32_t bits = __builtin_ctz(n4);
+  bit_reverse_.resize(n4);
+  for (uint32_t i = 0; i < n4; ++i) {
+    uint32_t r = 0;
+    for (uint32_t b = 0; b < bits; ++b) r |= ((i >> b) & 1) << (bits - 1 - b);
+    bit_reverse_[i] = static_cast<uint16_t>(r);
+  }
+
+  // exp(i*pi*j/h) for every butterfly span h; stage h starts at h - 1
+  fft_cos_.assign(n4, 0.0f);
+  fft_sin_.assign(n4, 0.0f);
+  for (uint32_t h = 1; h < n4; h <<= 1) {
+    for (uint32_t j = 0; j < h; ++j) {
+      fft_cos_[h - 1 + j] = static_cast<float>(std::cos(kPi * j / h));
+      fft_sin_[h - 1 + j] = static_cast<float>(std::sin(kPi * j / h));
+    }
+  }
+  re_.assign(n4, 0.0f);
+  im_.assign(n4, 0.0f);
+  return true;
+}
+
+void Imdct::Fft() {
+  uint32_t n = size_ / 4;
+  float* re = re_.data();
+  float* im = im_.data();
+
+  // Spans 1 and 2 as one radix-4 pass (twiddles 1 and i)
+  for (uint32_t g = 0; g < n; g += 4) {
+    float ar = re[g] + re[g + 1], ai = im[g] + im[g + 1];
+    float br = re[g] - re[g + 1], bi = im[g] - im[g + 1];
+    float cr = re[g + 2] + re[g + 3], ci = im[g + 2] + im[g + 3];
+    float dr = re[g + 2] - re[g + 3], di = im[g + 2] - im[g + 3];
+    re[g] = ar + cr;      im[g] = ai + ci;
+    re[g + 2] = ar - cr;  im[g + 2] = ai - ci;
+    re[g + 1] = br - di;  im[g + 1] = bi + dr;
+    re[g + 3] = br + di;  im[g + 3] = bi - dr;
+  }
+
+  for (uint32_t h = 4; h < n; h <<= 1) {
+    const float* wr = &fft_cos_[h - 1];
+    const float* wi = &fft_sin_[h - 1];
+    for (uint32_t g = 0; g < n; g += 2 * h) {
+      float* ar = re + g;
+      float* ai = im + g;
+      float* br = re + g + h;
+      float* bi = im + g + h;
+#if XE_APU_NEON || XE_APU_SSE2
+      for (uint32_t j = 0; j < h; j += 4) {
+        Vec4 vwr = Load4(wr + j), vwi = Load4(wi + j);
+        Vec4 vbr = Load4(br + j), vbi = Load4(bi + j);
+        Vec4 tr = Sub4(Mul4(vbr, vwr), Mul4(vbi, vwi));
+        Vec4 ti = Add4(Mul4(vbr, vwi), Mul4(vbi, vwr));
+        Vec4 var = Load4(ar + j), vai = Load4(ai + j);
+        Store4(ar + j, Add4(var, tr));
+        Store4(ai + j, Add4(vai, ti));
+        Store4(br + j, Sub4(var, tr));
+        Store4(bi + j, Sub4(vai, ti));
+      }
+#else
+      for (uint32_t j = 0; j < h; ++j) {
+        float tr = br[j] * wr[j] - bi[j] * wi[j];
+        float ti = br[j] * wi[j] + bi[j] * wr[j];
+        br[j] = ar[j] - tr;
+        bi[j] = ai[j] - ti;
+        ar[j] += tr;
+        ai[j] += ti;
+      }
+#endif
+    }
+  }
+}
+
+void Imdct::TransformHalf(const float* in, float* out) {
+  uint32_t n2 = size_ / 2, n4 = size_ / 4, n8 = size_ / 8;
+  const float* tc = twiddle_cos_.data();
+  const float* ts = twiddle_sin_.data();
+
+  // Pre-twiddle, scattered into bit-reversed order for the FFT
+  for (uint32_t k = 0; k < n4; ++k) {
+    float a = in[n2 - 1 - 2 * k];
+    float b = in[2 * k];
+    uint32_t j = bit_reverse_[k];
+    re_[j] = a * tc[k] - b * ts[k];
+    im_[j] = a * ts[k] + b * tc[k];
+  }
+
+  Fft();
+
+  // Post-twiddle; the result is the middle half of the output, interleaved
+  for (uint32_t k = 0; k < n8; ++k) {
+    uint32_t p = n8 - k - 1, q = n8 + k;
+    float r0 = re_[p] * tc[p] - im_[p] * ts[p];
+    float i1 = -(im_[p] * tc[p] + re_[p] * ts[p]);
+    float r1 = re_[q] * tc[q] - im_[q] * ts[q];
+    float i0 = -(im_[q] * tc[q] + re_[q] * ts[q]);
+    out[2 * p] = r0;
+    out[2 * p + 1] = i0;
+    out[2 * q] = r1;
+    out[2 * q + 1] = i1;
+  }
+}
+
+void Imdct::Transform(const float* in, float* out) {
+  uint32_t n2 = size_ / 2, n4 = size_ / 4;
+  TransformHalf(in, out + n4);
+
+  // The outer quarters follow by symmetry
+  uint32_t k = 0;
+#if XE_APU_NEON || XE_APU_SSE2
+  Vec4 neg = Splat4(-1.0f);
+  for (; k + 4 <= n4; k += 4) {
+    Store4(out + k, Mul4(neg, Reverse4(Load4(out + n2 - k - 4))));
+    Store4(out + size_ - k - 4, Reverse4(Load4(out + n2 + k)));
+  }
+#endif
+  for (; k < n4; ++k) {
+    out[k] = -out[n2 - k - 1];
+    out[size_ - k - 1] = out[n2 + k];
+  }
+}
+
+// ── Windowing and channel transforms ─────────────────────────────────────────
+
+void SineWindow(uint32_t length, float* window) {
+  for (uint32_t i = 0; i < length; ++i) {
+    window[i] = static_cast<float>(std::sin(kPi / 2 * (i + 0.5) / length));
+  }
+}
+
+void WindowOverlap(float* samples, const float* window, uint32_t count) {
+  // Pairs (i, j) mirror around the middle; each reads and writes only its
+  // own two samples, so the update is in place
+  float* head = samples;
+  float* tail = samples + count;
+  uint32_t i = 0;
+#if XE_APU_NEON || XE_APU_SSE2
+  for (; i + 4 <= count; i += 4) {
+    uint32_t j = count - i - 4;
+    Vec4 s0 = Load4(head + i);
+    Vec4 s1 = Reverse4(Load4(tail + j));
+    Vec4 wi = Load4(window + i);
+    Vec4 wj = Reverse4(Load4(window + count + j));
+    Store4(head + i, Sub4(Mul4(s0, wj), Mul4(s1, wi)));
+    Store4(tail + j, Reverse4(Add4(Mul4(s0, wi), Mul4(s1, wj))));
+  }
+#endif
+  for (; i < count; ++i) {
+    uint32_t j = count - i - 1;
+    float s0 = head[i], s1 = tail[j];
+    float wi = window[i], wj = window[count + j];
+    head[i] = s0 * wj - s1 * wi;
+    tail[j] = s0 * wi + s1 * wj;
+  }
+}
+
+void ApplyChannelTransform(float* a, float* b, uint32_t count,
+                           const float matrix[4]) {
+  uint32_t i = 0;
+#if XE_APU_NEON || XE_APU_SSE2
+  Vec4 m0 = Splat4(matrix[0]), m1 = Splat4(matrix[1]);
+  Vec4 m2 = Splat4(matrix[2]), m3 = Splat4(matrix[3]);
+  for (; i + 4 <= count; i += 4) {
+    Vec4 va = Load4(a + i), vb = Load4(b + i);
+    Store4(a + i, Add4(Mul4(m0, va), Mul4(m1, vb)));
+    Store4(b + i, Add4(Mul4(m2, va), Mul4(m3, vb)));
+  }
+#endif
+  for (; i < count; ++i) {
+    float va = a[i], vb = b[i];
+    a[i] = matrix[0] * va + matrix[1] * vb;
+    b[i] = matrix[2] * va + matrix[3] * vb;
+  }
+}
+
+// ── PCM output ───────────────────────────────────────────────────────────────
+
+void StorePcm16BE(const float* const* channels, uint32_t channel_count,
+                  uint32_t count, uint8_t* out) {
+  const float* left = channels[0];
+  const float* right = channel_count > 1 ? channels[1] : nullptr;
+  uint32_t i = 0;
+#if XE_APU_NEON
+  float32x4_t scale = vdupq_n_f32(32768.0f);
+  for (; i + 8 <= count; i += 8) {
+    // vcvtn rounds to nearest; vqmovn saturates to 16 bits
+    int16x8_t l = vcombine_s16(
+        vqmovn_s32(vcvtnq_s32_f32(vmulq_f32(vld1q_f32(left + i), scale))),
+        vqmovn_s32(vcvtnq_s32_f32(vmulq_f32(vld1q_f32(left + i + 4), scale))));
+    if (!right) {
+      vst1q_u8(out + i * 2, vrev16q_u8(vreinterpretq_u8_s16(l)));
+      continue;
+    }
+    int16x8_t r = vcombine_s16(
+        vqmovn_s32(vcvtnq_s32_f32(vmulq_f32(vld1q_f32(right + i), scale))),
+        vqmovn_s32(vcvtnq_s32_f32(vmulq_f32(vld1q_f32(right + i + 4), scale))));
+    int16x8x2_t lr = vzipq_s16(l, r);
+    vst1q_u8(out + i * 4, vrev16q_u8(vreinterpretq_u8_s16(lr.val[0])));
+    vst1q_u8(out + i * 4 + 16, vrev16q_u8(vreinterpretq_u8_s16(lr.val[1])));
+  }
+#elif XE_APU_SSE2
+  // cvtps rounds to nearest (default MXCSR) and saturates out-of-range
+  // lanes to INT32_MIN; packs then saturates to 16 bits. Clamping first
+  // keeps large positive values from wrapping negative.
+  __m128 scale = _mm_set1_ps(32768.0f);
+  __m128 lo = _mm_set1_ps(-32768.0f), hi = _mm_set1_ps(32767.0f);
+  auto convert = [&](const float* p) {
+    __m128 a = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(p), scale), lo), hi);
+    __m128 b =
+        _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(p + 4), scale), lo), hi);
+    return _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b));
+  };
+  auto swap = [](__m128i v) {
+    return _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+  };
+  for (; i + 8 <= count; i += 8) {
+    __m128i l = convert(left + i);
+    if (!right) {
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 2), swap(l));
+      continue;
+    }
+    __m128i r = convert(right + i);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 4),
+                     swap(_mm_unpacklo_epi16(l, r)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 4 + 16),
+                     swap(_mm_unpackhi_epi16(l, r)));
+  }
+#endif
+  for (; i < count; ++i) {
+    if (right) {
+      StoreBE16(out + i * 4, ToS16(left[i]));
+      StoreBE16(out + i * 4 + 2, ToS16(right[i]));
+    } else {
+      StoreBE16(out + i * 2, ToS16(left[i]));
+    }
+  }
+}
+
+}  // namespace xe::apu
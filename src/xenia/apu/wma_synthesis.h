@@ -0,0 +1,68 @@
+/**
+ * Vera360 — Xenia Edge
+ * WMA Pro synthesis — inverse MDCT, window overlap, channel transforms, PCM
+ *
+ * The back half of an XMA (WMA Pro-family) decoder: spectral coefficients
+ * in, interleaved big-endian 16-bit PCM out. The transform is an N/4-point
+ * complex FFT between pre- and post-twiddles; FFT butterflies, windowing,
+ * channel matrices and sample conversion run four lanes at a time on NEON
+ * or SSE2, with a scalar fallback.
+ */
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace xe::apu {
+
+class Imdct {
+ public:
+  /// size = samples produced per transform (twice the coefficient count);
+  /// a power of two from 16 to 8192
+  bool Initialize(uint32_t size);
+
+  /// out[n] = sum_k in[k] * cos(2*pi/size * (n + 1/2 + size/4) * (k + 1/2))
+  /// for n < size, k < size / 2. in and out must not overlap.
+  void Transform(const float* in, float* out);
+  /// The middle half of Transform (n from size / 4 to 3 * size / 4) into
+  /// out[0, size / 2); the outer quarters only mirror it.
+  void TransformHalf(const float* in, float* out);
+
+  uint32_t size() const { return size_; }
+
+  /// "neon", "sse2" or "scalar"
+  static const char* backend_name();
+
+ private:
+  void Fft();
+
+  uint32_t size_ = 0;
+  std::vector<float> twiddle_cos_;  // size / 4 pre/post twiddles
+  std::vector<float> twiddle_sin_;
+  std::vector<uint16_t> bit_reverse_;
+  std::vector<float> fft_cos_;      // per-stage FFT twiddles, stage h at h - 1
+  std::vector<float> fft_sin_;
+  std::vector<float> re_;
+  std::vector<float> im_;
+};
+
+/// Rising half of a sine window: window[i] = sin(pi/2 * (i + 1/2) / length)
+void SineWindow(uint32_t length, float* window);
+
+/// WMA Pro's overlap of neighbouring transform halves, in place: samples
+/// holds count samples of the previous block's half output followed by
+/// count of the current one's; window is a rising half window of
+/// 2 * count samples.
+void WindowOverlap(float* samples, const float* window, uint32_t count);
+
+/// Stereo reconstruction on coefficients: (a, b) = matrix * (a, b), with
+/// matrix row-major ({1, -1, 1, 1} undoes WMA Pro's stereo transform)
+void ApplyChannelTransform(float* a, float* b, uint32_t count,
+                           const float matrix[4]);
+
+/// Clamp [-1, 1] floats to 16-bit and write them interleaved, big-endian
+/// (the layout of an XMA output buffer). channel_count is 1 or 2.
+void StorePcm16BE(const float* const* channels, uint32_t channel_count,
+                  uint32_t count, uint8_t* out);
+
+}  // namespace xe::apu
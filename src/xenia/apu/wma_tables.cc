@@ -0,0 +1,387 @@
+/**
+ * Vera360 — Xenia Edge
+ * WMA Pro codebooks — Huffman tables, run/level maps, band edges
+ *
+ * Generated from the WMA Pro bitstream's code tables; do not edit by hand.
+ */
+
+#include "xenia/apu/wma_tables.h"
+
+namespace xe::apu::wma {
+
+namespace {
+
+// ── Scale factors ────────────────────────────────────────────────────────────
+
+const uint8_t kScaleLengths[121] = {
+    5, 6, 7, 7, 5, 6, 9, 10, 15, 19, 19, 19, 19, 19, 19, 19,
+    19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19,
+    19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19,
+    19, 19, 19, 19, 19, 19, 19, 19, 19, 13, 13, 19, 19, 19, 19, 19,
+    19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19,
+    19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19,
+    19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19,
+    19, 18, 16, 11, 8, 7, 3, 2, 1,
+};
+
+const uint16_t kScaleSymbols[121] = {
+    58, 64, 66, 65, 62, 63, 68, 69, 54, 19, 20, 21,
+    22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33,
+    34, 17, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45,
+    46, 47, 48, 49, 50, 51, 52, 15, 16, 14, 13, 12,
+    11, 10, 0, 9, 8, 7, 6, 5, 4, 55, 70, 3,
+    2, 1, 35, 71, 72, 73, 74, 75, 76, 77, 78, 79,
+    80, 81, 82, 83, 84, 85, 86, 87, 88, 89, 90, 91,
+    92, 93, 94, 95, 96, 97, 98, 99, 100, 101, 102, 103,
+    104, 105, 106, 107, 108, 109, 110, 111, 112, 113, 114, 115,
+    116, 117, 118, 119, 120, 18, 53, 56, 57, 67, 61, 59,
+    60,
+};
+
+const uint8_t kScaleRunLevelLengths[120] = {
+    7, 11, 11, 10, 10, 12, 12, 11, 11, 12, 15, 15, 14, 13, 10, 9,
+    6, 5, 4, 5, 7, 8, 8, 7, 11, 12, 12, 11, 12, 14, 16, 16,
+    15, 13, 10, 12, 12, 12, 12, 8, 4, 2, 6, 7, 9, 9, 9, 10,
+    12, 12, 12, 16, 18, 21, 21, 21, 21, 21, 21, 20, 17, 15, 15, 15,
+    14, 14, 7, 7, 7, 8, 8, 9, 9, 10, 10, 9, 7, 9, 9, 9,
+    11, 11, 12, 15, 15, 14, 14, 15, 15, 11, 9, 9, 8, 5, 8, 9,
+    9, 7, 6, 6, 12, 14, 14, 13, 11, 10, 9, 9, 11, 12, 13, 15,
+    15, 14, 10, 7, 5, 6, 6, 2,
+};
+
+const uint16_t kScaleRunLevelSymbols[120] = {
+    103, 80, 60, 18, 56, 21, 90, 58, 27, 69, 84, 48,
+    86, 47, 19, 32, 78, 5, 28, 53, 9, 31, 38, 10,
+    88, 25, 105, 118, 23, 82, 98, 110, 108, 93, 68, 72,
+    97, 81, 42, 64, 4, 1, 7, 14, 0, 55, 61, 117,
+    24, 44, 67, 70, 99, 96, 95, 2, 77, 52, 111, 102,
+    101, 46, 73, 109, 51, 92, 30, 11, 66, 15, 16, 116,
+    65, 57, 59, 115, 12, 35, 17, 41, 20, 91, 26, 75,
+    45, 107, 83, 100, 89, 43, 62, 37, 104, 6, 39, 40,
+    34, 79, 8, 63, 87, 94, 49, 50, 22, 119, 33, 36,
+    113, 106, 112, 71, 85, 74, 76, 114, 29, 54, 13, 3,
+};
+
+// ── Coefficients ─────────────────────────────────────────────────────────────
+
+const uint8_t kCoef0Lengths[272] = {
+    2, 9, 14, 14, 13, 12, 13, 14, 15, 15, 12, 10, 10, 10, 13, 14,
+    15, 15, 12, 11, 13, 14, 14, 13, 15, 15, 14, 12, 12, 8, 10, 10,
+    15, 15, 14, 13, 14, 14, 13, 15, 20, 20, 19, 21, 21, 20, 19, 17,
+    17, 18, 18, 15, 15, 13, 12, 14, 15, 15, 14, 15, 15, 12, 11, 6,
+    7, 8, 9, 13, 13, 13, 14, 14, 11, 10, 7, 8, 14, 14, 14, 14,
+    12, 13, 13, 12, 12, 12, 11, 9, 13, 14, 14, 12, 11, 11, 11, 9,
+    8, 7, 14, 15, 15, 14, 14, 12, 13, 15, 16, 17, 17, 14, 12, 12,
+    12, 15, 15, 14, 14, 14, 13, 13, 9, 9, 11, 11, 10, 7, 6, 13,
+    15, 15, 14, 14, 14, 13, 14, 15, 15, 13, 14, 14, 14, 14, 10, 9,
+    10, 10, 11, 11, 10, 8, 9, 13, 14, 14, 12, 11, 14, 15, 15, 13,
+    12, 14, 14, 14, 14, 13, 14, 14, 3, 5, 8, 10, 10, 15, 15, 14,
+    14, 16, 16, 15, 12, 11, 11, 11, 7, 8, 8, 9, 12, 13, 13, 12,
+    14, 15, 15, 13, 10, 11, 11, 13, 14, 14, 13, 14, 14, 11, 10, 13,
+    15, 15, 14, 12, 11, 4, 6, 6, 8, 12, 12, 12, 13, 13, 12, 13,
+    13, 14, 14, 13, 13, 13, 9, 7, 9, 11, 14, 14, 13, 14, 14, 13,
+    10, 8, 7, 5, 9, 12, 13, 14, 15, 15, 12, 12, 10, 14, 14, 13,
+    12, 13, 14, 14, 12, 13, 13, 12, 12, 12, 9, 7, 6, 3, 4, 4,
+};
+
+const uint16_t kCoef0Symbols[272] = {
+    2, 25, 111, 94, 69, 58, 87, 93, 136, 135, 59, 37,
+    34, 36, 82, 182, 120, 138, 195, 45, 168, 216, 178, 86,
+    140, 219, 186, 162, 239, 18, 156, 35, 127, 236, 109, 85,
+    180, 253, 88, 147, 268, 264, 256, 266, 270, 262, 260, 248,
+    246, 252, 258, 137, 189, 230, 64, 179, 146, 208, 101, 118,
+    238, 163, 46, 9, 153, 0, 26, 247, 169, 76, 202, 131,
+    194, 38, 13, 19, 132, 106, 191, 97, 65, 198, 77, 62,
+    66, 164, 48, 27, 81, 183, 102, 60, 47, 49, 159, 227,
+    20, 14, 112, 263, 144, 217, 104, 63, 79, 209, 269, 250,
+    254, 203, 241, 196, 61, 220, 148, 124, 185, 100, 80, 78,
+    193, 28, 50, 235, 41, 1, 10, 171, 226, 150, 103, 114,
+    115, 170, 105, 211, 149, 249, 108, 188, 107, 255, 231, 155,
+    42, 40, 55, 160, 39, 21, 29, 215, 234, 184, 228, 51,
+    116, 142, 145, 172, 165, 181, 130, 113, 117, 89, 128, 204,
+    3, 7, 154, 157, 43, 141, 265, 133, 225, 271, 244, 221,
+    74, 54, 56, 52, 15, 222, 22, 30, 83, 199, 173, 73,
+    123, 210, 143, 175, 44, 53, 237, 174, 139, 134, 110, 218,
+    129, 161, 213, 177, 267, 151, 125, 67, 223, 5, 11, 192,
+    23, 214, 243, 166, 200, 176, 68, 224, 187, 257, 261, 232,
+    96, 251, 31, 16, 32, 57, 207, 121, 91, 126, 119, 99,
+    158, 24, 212, 8, 33, 70, 92, 205, 240, 242, 75, 197,
+    233, 259, 190, 98, 71, 201, 122, 206, 72, 90, 95, 84,
+    167, 245, 229, 17, 12, 4, 152, 6,
+};
+
+const uint8_t kCoef1Lengths[244] = {
+    2, 3, 3, 4, 6, 9, 10, 10, 8, 8, 9, 14, 15, 15, 13, 13,
+    14, 14, 11, 13, 19, 19, 18, 17, 16, 15, 15, 15, 12, 12, 15, 15,
+    14, 13, 5, 4, 5, 7, 9, 11, 12, 12, 16, 16, 15, 14, 13, 14,
+    15, 21, 21, 21, 21, 20, 20, 18, 17, 16, 14, 14, 11, 8, 6, 7,
+    10, 12, 12, 15, 15, 14, 14, 14, 12, 10, 10, 8, 9, 9, 13, 13,
+    17, 17, 16, 15, 15, 15, 13, 12, 14, 15, 19, 19, 18, 17, 16, 13,
+    11, 13, 15, 15, 14, 12, 11, 14, 14, 15, 16, 16, 14, 14, 15, 15,
+    13, 11, 12, 14, 16, 16, 15, 13, 8, 8, 5, 9, 9, 10, 12, 13,
+    13, 11, 10, 10, 12, 12, 12, 15, 17, 20, 20, 19, 18, 16, 14, 14,
+    16, 16, 15, 11, 11, 9, 11, 13, 14, 15, 15, 13, 16, 16, 15, 16,
+    17, 17, 15, 10, 10, 10, 6, 7, 7, 6, 4, 8, 9, 13, 13, 12,
+    12, 12, 10, 9, 13, 14, 14, 13, 16, 16, 15, 15, 15, 11, 13, 14,
+    15, 15, 12, 11, 8, 6, 6, 9, 10, 14, 14, 13, 12, 12, 20, 22,
+    22, 21, 19, 18, 18, 18, 17, 17, 15, 15, 15, 13, 14, 14, 14, 15,
+    15, 12, 11, 10, 10, 13, 16, 16, 15, 14, 14, 15, 15, 14, 16, 16,
+    16, 16, 11, 7,
+};
+
+const uint16_t kCoef1Symbols[244] = {
+    2, 3, 102, 4, 148, 134, 171, 18, 11, 159, 14, 156,
+    235, 61, 38, 153, 48, 49, 23, 203, 208, 204, 129, 94,
+    87, 62, 174, 147, 29, 191, 64, 65, 146, 164, 142, 132,
+    103, 154, 165, 181, 109, 30, 86, 92, 239, 138, 39, 50,
+    115, 238, 228, 236, 222, 216, 226, 196, 192, 120, 221, 51,
+    24, 143, 7, 9, 152, 136, 160, 241, 66, 168, 219, 113,
+    193, 19, 173, 105, 149, 15, 205, 207, 125, 190, 182, 68,
+    70, 67, 137, 31, 223, 116, 210, 220, 198, 126, 88, 41,
+    25, 40, 73, 243, 53, 195, 183, 225, 52, 71, 121, 89,
+    170, 55, 69, 83, 209, 108, 32, 54, 122, 184, 176, 42,
+    12, 161, 6, 167, 106, 20, 145, 111, 43, 26, 175, 107,
+    34, 33, 197, 74, 128, 232, 212, 224, 202, 90, 57, 227,
+    97, 93, 140, 185, 27, 16, 158, 211, 56, 117, 72, 166,
+    91, 95, 80, 101, 194, 127, 82, 21, 144, 177, 151, 10,
+    157, 8, 5, 13, 0, 213, 46, 199, 35, 162, 135, 169,
+    45, 59, 114, 44, 188, 186, 75, 79, 118, 187, 112, 139,
+    178, 81, 110, 28, 163, 133, 104, 17, 22, 229, 172, 217,
+    201, 36, 218, 242, 240, 234, 230, 206, 200, 214, 130, 131,
+    141, 84, 76, 215, 58, 231, 233, 180, 77, 37, 189, 179,
+    155, 47, 96, 99, 119, 63, 237, 78, 85, 60, 98, 100,
+    124, 123, 150, 1,
+};
+
+const uint8_t kVec4Lengths[127] = {
+    1, 6, 8, 10, 10, 10, 10, 8, 8, 10, 10, 9, 8, 8, 9, 12,
+    12, 11, 12, 12, 11, 9, 9, 8, 8, 9, 9, 8, 8, 9, 9, 12,
+    12, 12, 14, 14, 13, 11, 11, 9, 8, 9, 9, 11, 11, 10, 9, 8,
+    6, 6, 6, 6, 6, 6, 11, 11, 10, 11, 11, 10, 10, 11, 11, 9,
+    7, 6, 7, 7, 6, 6, 6, 5, 7, 11, 11, 10, 9, 8, 6, 9,
+    9, 10, 10, 9, 8, 8, 6, 6, 6, 8, 8, 9, 12, 12, 11, 10,
+    8, 8, 8, 10, 10, 10, 10, 9, 9, 8, 10, 11, 11, 9, 8, 8,
+    8, 9, 9, 10, 11, 12, 12, 9, 9, 9, 8, 8, 7, 7, 7,
+};
+
+const uint16_t kVec4Symbols[127] = {
+    0x0000, 0x1112, 0x0113, 0x2003, 0x1032, 0x3101, 0x2021, 0x0122,
+    0x1211, 0x0203, 0x0014, 0x2202, 0x2012, 0x1103, 0x1023, 0x4001,
+    0x1401, 0x2301, 0x0141, 0x0411, 0x0033, 0x1221, 0x0222, 0x1202,
+    0x0212, 0x0201, 0x2103, 0x1121, 0x1022, 0x0021, 0x2013, 0x0005,
+    0x0042, 0x1041, 0x0501, 0x0051, 0x0006, 0x0321, 0x2004, 0x2121,
+    0x2101, 0x1203, 0x0213, 0x0231, 0x0301, 0x3002, 0x2022, 0x0013,
+    0x1001, 0x0002, 0x1111, 0x0112, 0x1102, 0x1012, 0x3003, 0x4101,
+    0x3011, 0x0031, 0x3021, 0x0104, 0x1004, 0x0204, 0x0015, 0x3102,
+    0x2112, 0x1101, 0x1113, 0x1212, 0x0101, 0x0012, 0x0011, 0x0001,
+    0x1122, 0x2031, 0x0303, 0x1301, 0x2201, 0x2002, 0x1002, 0x3111,
+    0x0114, 0x0032, 0x0311, 0x1014, 0x2011, 0x1003, 0x0111, 0x1011,
+    0x0102, 0x0103, 0x1201, 0x0023, 0x0402, 0x0401, 0x4011, 0x0131,
+    0x0022, 0x0211, 0x0121, 0x0302, 0x3001, 0x0004, 0x1031, 0x1104,
+    0x3012, 0x2001, 0x3201, 0x0105, 0x4002, 0x1311, 0x0003, 0x0202,
+    0x1021, 0x0221, 0x0132, 0x0024, 0x1005, 0x0041, 0x5001, 0x0312,
+    0x1131, 0x1302, 0x2211, 0x0123, 0x2102, 0x2111, 0x1013,
+};
+
+const uint8_t kVec2Lengths[137] = {
+    5, 10, 11, 11, 10, 11, 11, 8, 7, 7, 9, 10, 10, 9, 9, 5,
+    6, 9, 9, 8, 7, 3, 8, 9, 10, 10, 8, 10, 10, 10, 10, 6,
+    6, 8, 9, 9, 7, 7, 11, 12, 12, 10, 9, 8, 8, 9, 9, 7,
+    7, 9, 10, 11, 11, 10, 10, 9, 6, 6, 6, 6, 6, 6, 8, 8,
+    8, 8, 5, 5, 9, 9, 10, 10, 9, 8, 8, 9, 11, 12, 12, 10,
+    9, 9, 7, 7, 7, 7, 10, 10, 9, 8, 5, 5, 8, 10, 10, 9,
+    7, 6, 6, 6, 9, 9, 8, 7, 6, 7, 8, 9, 9, 8, 9, 10,
+    10, 9, 9, 8, 8, 9, 9, 8, 8, 7, 7, 7, 9, 10, 11, 11,
+    9, 9, 6, 6, 7, 8, 8, 4, 4,
+};
+
+const uint16_t kVec2Symbols[137] = {
+    0x13, 0xA5, 0xD3, 0x2E, 0x4B, 0xB1, 0x0C, 0x56, 0x53, 0x26, 0x85, 0xB2,
+    0x1C, 0x68, 0x49, 0x23, 0x34, 0x71, 0x08, 0x65, 0x45, 0x00, 0x47, 0x77,
+    0x5B, 0xB3, 0x72, 0xA6, 0x0A, 0x2C, 0x91, 0x42, 0x15, 0x18, 0x92, 0x1A,
+    0x41, 0x05, 0xE2, 0xE1, 0x0F, 0xB4, 0x93, 0x73, 0x28, 0x59, 0x86, 0x54,
+    0x36, 0x2A, 0x3C, 0x1F, 0xC1, 0xB5, 0x4C, 0x94, 0x25, 0x43, 0x21, 0x03,
+    0x11, 0x02, 0x66, 0x57, 0x74, 0x38, 0x32, 0x14, 0x78, 0x3A, 0x1D, 0xC2,
+    0x87, 0x61, 0x07, 0x69, 0x0D, 0xF1, 0x10, 0x2D, 0x95, 0x4A, 0x62, 0x17,
+    0x55, 0x46, 0xC3, 0xA1, 0x81, 0x48, 0x33, 0x24, 0x75, 0x3D, 0x0B, 0xA2,
+    0x01, 0x04, 0x31, 0x44, 0x09, 0x1B, 0x82, 0x27, 0x35, 0x63, 0x19, 0x96,
+    0x5A, 0x67, 0xA3, 0xC4, 0xD2, 0x88, 0x79, 0x29, 0x83, 0x2B, 0xA4, 0x76,
+    0x58, 0x51, 0x06, 0x37, 0x3B, 0x1E, 0xD1, 0x0E, 0x97, 0x6A, 0x52, 0x16,
+    0x64, 0x84, 0x39, 0x12, 0x22,
+};
+
+const uint8_t kVec1Lengths[101] = {
+    5, 8, 10, 10, 11, 11, 10, 8, 9, 10, 11, 11, 6, 5, 6, 7,
+    8, 9, 9, 5, 5, 10, 11, 11, 10, 11, 11, 8, 7, 7, 9, 10,
+    10, 8, 5, 6, 11, 11, 10, 9, 9, 10, 11, 11, 7, 5, 8, 10,
+    10, 9, 9, 10, 11, 11, 8, 6, 5, 5, 7, 9, 11, 11, 10, 8,
+    7, 10, 11, 11, 9, 8, 6, 7, 9, 10, 10, 9, 10, 10, 5, 5,
+    6, 8, 9, 10, 10, 7, 4, 4, 5, 5, 4, 4, 5, 8, 9, 10,
+    10, 8, 8, 6, 4,
+};
+
+const uint16_t kVec1Symbols[101] = {
+    7, 32, 59, 60, 83, 82, 62, 33, 45, 61, 84, 85,
+    1, 13, 19, 25, 34, 46, 47, 14, 6, 64, 87, 86,
+    63, 88, 90, 35, 26, 0, 48, 65, 66, 36, 15, 20,
+    91, 89, 67, 49, 50, 69, 92, 93, 27, 5, 37, 68,
+    71, 51, 52, 70, 94, 96, 38, 21, 16, 4, 28, 53,
+    95, 97, 73, 39, 29, 72, 98, 99, 54, 40, 22, 30,
+    55, 74, 76, 56, 75, 77, 17, 3, 23, 41, 57, 78,
+    79, 31, 10, 9, 100, 2, 11, 8, 18, 42, 58, 80,
+    81, 43, 44, 24, 12,
+};
+
+}  // namespace
+
+const Codebook kScaleCodebook = {kScaleLengths, kScaleSymbols, 121, -60};
+const Codebook kScaleRunLevelCodebook = {kScaleRunLevelLengths,
+                                         kScaleRunLevelSymbols, 120, 0};
+
+const uint8_t kScaleRunLevelRun[120] = {
+    0, 0, 0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12,
+    13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 0, 1, 2, 3,
+    4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19,
+    20, 21, 22, 23, 24, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10,
+    11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 0, 1,
+    2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17,
+    18, 19, 20, 21, 22, 23, 24, 0, 1, 2, 3, 4, 5, 6, 7, 8,
+    9, 10, 0, 1, 0, 1, 0, 1,
+};
+
+const uint8_t kScaleRunLevelLevel[120] = {
+    0, 0, 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3,
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+    3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 5, 5,
+    5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5,
+    5, 5, 5, 5, 5, 5, 5, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+    6, 6, 7, 7, 8, 8, 9, 9,
+};
+
+const Codebook kCoefCodebooks[2] = {
+    {kCoef0Lengths, kCoef0Symbols, 272, 0},
+    {kCoef1Lengths, kCoef1Symbols, 244, 0},
+};
+
+const uint16_t kCoef0Run[272] = {
+    0, 0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9,
+    10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21,
+    22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33,
+    34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45,
+    46, 47, 48, 49, 50, 51, 52, 53, 54, 55, 56, 57,
+    58, 59, 60, 61, 62, 63, 64, 65, 66, 67, 68, 69,
+    70, 71, 72, 73, 74, 75, 76, 77, 78, 79, 80, 81,
+    82, 83, 84, 85, 86, 87, 88, 89, 90, 91, 92, 93,
+    94, 95, 96, 97, 98, 99, 100, 101, 102, 103, 104, 105,
+    106, 107, 108, 109, 110, 111, 112, 113, 114, 115, 116, 117,
+    118, 119, 120, 121, 122, 123, 124, 125, 126, 127, 128, 129,
+    130, 131, 132, 133, 134, 135, 136, 137, 138, 139, 140, 141,
+    142, 143, 144, 145, 146, 147, 148, 149, 0, 1, 2, 3,
+    4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+    16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27,
+    28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39,
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11,
+    12, 13, 14, 15, 16, 17, 18, 19, 0, 1, 2, 3,
+    4, 5, 6, 7, 8, 9, 0, 1, 2, 3, 4, 0,
+    1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0,
+    1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0,
+    1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0,
+    1, 0, 1, 0, 1, 0, 1, 0,
+};
+
+const uint16_t kCoef1Run[244] = {
+    0, 0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9,
+    10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21,
+    22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33,
+    34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45,
+    46, 47, 48, 49, 50, 51, 52, 53, 54, 55, 56, 57,
+    58, 59, 60, 61, 62, 63, 64, 65, 66, 67, 68, 69,
+    70, 71, 72, 73, 74, 75, 76, 77, 78, 79, 80, 81,
+    82, 83, 84, 85, 86, 87, 88, 89, 90, 91, 92, 93,
+    94, 95, 96, 97, 98, 99, 0, 1, 2, 3, 4, 5,
+    6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17,
+    18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29,
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 0, 1,
+    2, 3, 4, 5, 0, 1, 2, 0, 1, 2, 0, 1,
+    2, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0,
+    1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0,
+    1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0,
+    1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0,
+    1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0,
+    1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0,
+    1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0,
+    1, 0, 0, 0,
+};
+
+const float kCoef0Level[272] = {
+    0.0f, 0.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f,
+    1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f,
+    1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f,
+    1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f,
+    1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f,
+    1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f,
+    1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f,
+    1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f,
+    1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f,
+    1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f,
+    1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f,
+    1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f,
+    1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f,
+    1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f,
+    1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f,
+    1.0f, 1.0f, 2.0f, 2.0f, 2.0f, 2.0f, 2.0f, 2.0f, 2.0f, 2.0f,
+    2.0f, 2.0f, 2.0f, 2.0f, 2.0f, 2.0f, 2.0f, 2.0f, 2.0f, 2.0f,
+    2.0f, 2.0f, 2.0f, 2.0f, 2.0f, 2.0f, 2.0f, 2.0f, 2.0f, 2.0f,
+    2.0f, 2.0f, 2.0f, 2.0f, 2.0f, 2.0f, 2.0f, 2.0f, 2.0f, 2.0f,
+    2.0f, 2.0f, 3.0f, 3.0f, 3.0f, 3.0f, 3.0f, 3.0f, 3.0f, 3.0f,
+    3.0f, 3.0f, 3.0f, 3.0f, 3.0f, 3.0f, 3.0f, 3.0f, 3.0f, 3.0f,
+    3.0f, 3.0f, 4.0f, 4.0f, 4.0f, 4.0f, 4.0f, 4.0f, 4.0f, 4.0f,
+    4.0f, 4.0f, 5.0f, 5.0f, 5.0f, 5.0f, 5.0f, 6.0f, 6.0f, 7.0f,
+    7.0f, 8.0f, 8.0f, 9.0f, 9.0f, 10.0f, 10.0f, 11.0f, 11.0f, 12.0f,
+    12.0f, 13.0f, 13.0f, 14.0f, 14.0f, 15.0f, 15.0f, 16.0f, 16.0f, 17.0f,
+    17.0f, 18.0f, 18.0f, 19.0f, 19.0f, 20.0f, 20.0f, 21.0f, 21.0f, 22.0f,
+    22.0f, 23.0f, 23.0f, 24.0f, 24.0f, 25.0f, 25.0f, 26.0f, 26.0f, 27.0f,
+    27.0f, 28.0f,
+};
+
+const float kCoef1Level[244] = {
+    0.0f, 0.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f,
+    1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f,
+    1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f,
+    1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f,
+    1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f,
+    1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f,
+    1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f,
+    1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f,
+    1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f,
+    1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f,
+    1.0f, 1.0f, 2.0f, 2.0f, 2.0f, 2.0f, 2.0f, 2.0f, 2.0f, 2.0f,
+    2.0f, 2.0f, 2.0f, 2.0f, 2.0f, 2.0f, 2.0f, 2.0f, 2.0f, 2.0f,
+    2.0f, 2.0f, 2.0f, 2.0f, 2.0f, 2.0f, 2.0f, 2.0f, 2.0f, 2.0f,
+    2.0f, 2.0f, 3.0f, 3.0f, 3.0f, 3.0f, 3.0f, 3.0f, 3.0f, 3.0f,
+    3.0f, 3.0f, 4.0f, 4.0f, 4.0f, 4.0f, 4.0f, 4.0f, 5.0f, 5.0f,
+    5.0f, 6.0f, 6.0f, 6.0f, 7.0f, 7.0f, 7.0f, 8.0f, 8.0f, 9.0f,
+    9.0f, 10.0f, 10.0f, 11.0f, 11.0f, 12.0f, 12.0f, 13.0f, 13.0f, 14.0f,
+    14.0f, 15.0f, 15.0f, 16.0f, 16.0f, 17.0f, 17.0f, 18.0f, 18.0f, 19.0f,
+    19.0f, 20.0f, 20.0f, 21.0f, 21.0f, 22.0f, 22.0f, 23.0f, 23.0f, 24.0f,
+    24.0f, 25.0f, 25.0f, 26.0f, 26.0f, 27.0f, 27.0f, 28.0f, 28.0f, 29.0f,
+    29.0f, 30.0f, 30.0f, 31.0f, 31.0f, 32.0f, 32.0f, 33.0f, 33.0f, 34.0f,
+    34.0f, 35.0f, 35.0f, 36.0f, 36.0f, 37.0f, 37.0f, 38.0f, 38.0f, 39.0f,
+    39.0f, 40.0f, 40.0f, 41.0f, 41.0f, 42.0f, 42.0f, 43.0f, 43.0f, 44.0f,
+    44.0f, 45.0f, 45.0f, 46.0f, 46.0f, 47.0f, 47.0f, 48.0f, 48.0f, 49.0f,
+    49.0f, 50.0f, 51.0f, 52.0f,
+};
+
+const Codebook kVec4Codebook = {kVec4Lengths, kVec4Symbols, 127, -1};
+const Codebook kVec2Codebook = {kVec2Lengths, kVec2Symbols, 137, -1};
+const Codebook kVec1Codebook = {kVec1Lengths, kVec1Symbols, 101, 0};
+
+const uint16_t kCriticalFrequencies[28] = {
+    100, 200, 300, 400, 510, 630, 770, 920, 1080, 1270,
+    1480, 1720, 2000, 2320, 2700, 3150, 3700, 4400, 5300, 6400,
+    7700, 9500, 12000, 15500, 20675, 28575, 41375, 63875,
+};
+
+}  // namespace xe::apu::wma
@@ -0,0 +1,50 @@
+/**
+ * Vera360 — Xenia Edge
+ * WMA Pro codebooks — Huffman tables, run/level maps, band edges
+ *
+ * Each codebook lists its codes in code order by length alone: the first
+ * code is all zeros and each next one follows the previous, so codes are
+ * rebuilt from the lengths (see HuffmanTable in wma_frame.cc).
+ */
+#pragma once
+
+#include <cstdint>
+
+namespace xe::apu::wma {
+
+struct Codebook {
+  const uint8_t* lengths;
+  const uint16_t* symbols;
+  uint32_t count;
+  /// Added to each symbol when decoded
+  int32_t symbol_offset;
+};
+
+/// Scale factor DPCM deltas (-60 to 60)
+extern const Codebook kScaleCodebook;
+/// Run/level coded scale factor updates: 0 escapes, 1 ends the list,
+/// others index kScaleRunLevelRun / kScaleRunLevelLevel
+extern const Codebook kScaleRunLevelCodebook;
+extern const uint8_t kScaleRunLevelRun[120];
+extern const uint8_t kScaleRunLevelLevel[120];
+
+/// Run/level coded coefficients, one set per table selector bit: 0
+/// escapes, 1 ends the block, others index kCoef*Run / kCoef*Level
+extern const Codebook kCoefCodebooks[2];
+extern const uint16_t kCoef0Run[272];
+extern const uint16_t kCoef1Run[244];
+extern const float kCoef0Level[272];
+extern const float kCoef1Level[244];
+
+/// Vector coded coefficient magnitudes: four nibbles, two nibbles or one
+/// value per symbol. -1 escapes to the next smaller vector; a single value
+/// of 100 escapes to a long value added to it.
+extern const Codebook kVec4Codebook;
+extern const Codebook kVec2Codebook;
+extern const Codebook kVec1Codebook;
+constexpr int32_t kVec1Escape = 100;
+
+/// Scale factor band edges in Hz, scaled per block size and sample rate
+extern const uint16_t kCriticalFrequencies[28];
+
+}  // namespace xe::apu::wma
@@ -0,0 +1,461 @@
+/**
+ * Vera360 — Xenia Edge
+ * XMA context — packet walking, frame reassembly and decoding
+ */
+
+#include "xenia/apu/xma_context.h"
+#include "xenia/base/clock.h"
+#include "xenia/base/logging.h"
+#include "xenia/base/memory/memory.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace xe::apu {
+
+namespace {
+
+constexpr uint32_t kPacketBits = XmaContext::kPacketSize * 8;
+constexpr uint32_t kFrameLengthBits = 15;
+constexpr uint32_t kPaddingFrameLength = 0x7FFF;
+constexpr uint32_t kSampleRates[4] = {24000, 32000, 44100, 48000};
+
+inline uint32_t LoadBE32(const uint8_t* p) {
+  return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) |
+         (uint32_t(p[2]) << 8) | p[3];
+}
+
+inline void StoreBE32(uint8_t* p, uint32_t v) {
+  p[0] = uint8_t(v >> 24); p[1] = uint8_t(v >> 16);
+  p[2] = uint8_t(v >> 8);  p[3] = uint8_t(v);
+}
+
+inline uint32_t Bits(uint32_t v, uint32_t shift, uint32_t width) {
+  return (v >> shift) & ((1u << width) - 1);
+}
+
+/// Copy count bits, MSB first, from src at src_bit to dst at dst_bit
+void CopyBits(const uint8_t* src, uint32_t src_bit, uint8_t* dst,
+              uint32_t dst_bit, uint32_t count) {
+  while (count) {
+    uint32_t n = std::min({count, 8 - (src_bit & 7), 8 - (dst_bit & 7)});
+    uint32_t bits =
+        (src[src_bit >> 3] >> (8 - (src_bit & 7) - n)) & ((1u << n) - 1);
+    uint8_t& out = dst[dst_bit >> 3];
+    uint32_t shift = 8 - (dst_bit & 7) - n;
+    out = static_cast<uint8_t>((out & ~(((1u << n) - 1) << shift)) |
+                               (bits << shift));
+    src_bit += n;
+    dst_bit += n;
+    count -= n;
+  }
+}
+
+}  // namespace
+
+// ── XmaContextData ───────────────────────────────────────────────────────────
+
+void XmaContextData::Load(const uint8_t* guest) {
+  uint32_t d0 = LoadBE32(guest + 0);
+  input_buffer_0_packet_count = Bits(d0, 0, 12);
+  loop_count = Bits(d0, 12, 8);
+  input_buffer_0_valid = Bits(d0, 20, 1);
+  input_buffer_1_valid = Bits(d0, 21, 1);
+  output_buffer_block_count = Bits(d0, 22, 5);
+  output_buffer_write_offset = Bits(d0, 27, 5);
+
+  uint32_t d1 = LoadBE32(guest + 4);
+  input_buffer_1_packet_count = Bits(d1, 0, 12);
+  loop_subframe_start = Bits(d1, 12, 2);
+  loop_subframe_end = Bits(d1, 14, 3);
+  loop_subframe_skip = Bits(d1, 17, 3);
+  subframe_decode_count = Bits(d1, 20, 4);
+  output_buffer_padding = Bits(d1, 24, 3);
+  sample_rate = Bits(d1, 27, 2);
+  is_stereo = Bits(d1, 29, 1);
+  unk_dword_1 = Bits(d1, 30, 1);
+  output_buffer_valid = Bits(d1, 31, 1);
+
+  uint32_t d2 = LoadBE32(guest + 8);
+  input_buffer_read_offset = Bits(d2, 0, 26);
+  error_status = Bits(d2, 26, 5);
+  error_set = Bits(d2, 31, 1);
+
+  loop_start = Bits(LoadBE32(guest + 12), 0, 26);
+  uint32_t d4 = LoadBE32(guest + 16);
+  loop_end = Bits(d4, 0, 26);
+  packet_metadata = Bits(d4, 26, 5);
+  current_buffer = Bits(d4, 31, 1);
+
+  input_buffer_0_ptr = LoadBE32(guest + 20);
+  input_buffer_1_ptr = LoadBE32(guest + 24);
+  output_buffer_ptr = LoadBE32(guest + 28);
+  work_buffer_ptr = LoadBE32(guest + 32);
+  output_buffer_read_offset = Bits(LoadBE32(guest + 36), 0, 5);
+}
+
+void XmaContextData::StoreResult(uint8_t* guest) const {
+  // Valid bits are only ever cleared by the hardware: AND them in so a
+  // buffer the guest submitted mid-decode is not lost
+  uint32_t d0 = LoadBE32(guest + 0);
+  d0 &= ~(uint32_t(!input_buffer_0_valid) << 20);
+  d0 &= ~(uint32_t(!input_buffer_1_valid) << 21);
+  d0 = (d0 & ~(0x1Fu << 27)) | (output_buffer_write_offset << 27);
+  StoreBE32(guest + 0, d0);
+
+  uint32_t d1 = LoadBE32(guest + 4);
+  d1 &= ~(uint32_t(!output_buffer_valid) << 31);
+  StoreBE32(guest + 4, d1);
+
+  StoreBE32(guest + 8, input_buffer_read_offset | (error_status << 26) |
+                           (error_set << 31));
+
+  uint32_t d4 = LoadBE32(guest + 16);
+  d4 = (d4 & 0x03FFFFFFu) | (packet_metadata << 26) | (current_buffer << 31);
+  StoreBE32(guest + 16, d4);
+}
+
+// ── XmaDecodeStats ───────────────────────────────────────────────────────────
+
+void XmaDecodeStats::Merge(const XmaDecodeStats& other) {
+  packets += other.packets;
+  frames += other.frames;
+  samples += other.samples;
+  corrupt_frames += other.corrupt_frames;
+  decode_ns += other.decode_ns;
+  budget_ns += other.budget_ns;
+  worst_packet = std::max(worst_packet, other.worst_packet);
+}
+
+// ── XmaOutput ────────────────────────────────────────────────────────────────
+
+void XmaOutput::BeginWrite(uint32_t channels, uint32_t sample_rate) {
+  uint32_t state = state_.load(std::memory_order_acquire);
+  bool reclaimed;
+  for (;;) {
+    uint32_t published = state & 3;
+    uint32_t reading = (state >> 2) & 3;
+    // Take back a slot the mixer has not started on (it cannot start once
+    // the published bits are clear); otherwise stay off the one it reads
+    reclaimed = published != 0;
+    uint32_t slot = reclaimed ? published - 1 : (reading ? 2 - reading : 0);
+    if (state_.compare_exchange_weak(state, state & ~3u,
+                                     std::memory_order_acq_rel,
+                                     std::memory_order_acquire)) {
+      writing_ = slot;
+      break;
+    }
+  }
+  Slot& slot = slots_[writing_];
+  if (slot.pcm.empty()) slot.pcm.resize(2 * kChannelStride);
+  if (!reclaimed || slot.channels != channels ||
+      slot.sample_rate != sample_rate) {
+    if (reclaimed) {
+      dropped_samples_.fetch_add(slot.samples, std::memory_order_relaxed);
+    }
+    slot.samples = 0;
+  }
+  slot.channels = channels;
+  slot.sample_rate = sample_rate;
+}
+
+void XmaOutput::Append(const float* const* channels, uint32_t count) {
+  Slot& slot = slots_[writing_];
+  if (slot.samples + count > kChannelStride) {
+    dropped_samples_.fetch_add(slot.samples, std::memory_order_relaxed);
+    slot.samples = 0;
+  }
+  for (uint32_t ch = 0; ch < slot.channels; ++ch) {
+    memcpy(&slot.pcm[ch * kChannelStride + slot.samples], channels[ch],
+           count * sizeof(float));
+  }
+  slot.samples += count;
+}
+
+void XmaOutput::Publish() {
+  uint32_t state = state_.load(std::memory_order_relaxed);
+  while (!state_.compare_exchange_weak(state, (state & ~3u) | (writing_ + 1),
+                                       std::memory_order_release,
+                                       std::memory_order_relaxed)) {
+  }
+}
+
+const XmaOutput::Slot* XmaOutput::Acquire() {
+  uint32_t state = state_.load(std::memory_order_acquire);
+  for (;;) {
+    uint32_t published = state & 3;
+    if (!published) return nullptr;
+    if (state_.compare_exchange_weak(state, published << 2,
+                                     std::memory_order_acq_rel,
+                                     std::memory_order_acquire)) {
+      return &slots_[published - 1];
+    }
+  }
+}
+
+void XmaOutput::Release() {
+  state_.fetch_and(~0xCu, std::memory_order_release);
+}
+
+// ── XmaContext ───────────────────────────────────────────────────────────────
+
+bool XmaContext::Initialize(uint32_t id, uint32_t guest_address) {
+  id_ = id;
+  guest_address_ = guest_address;
+  if (!wma_.Initialize()) return false;
+  for (uint32_t ch = 0; ch < 2; ++ch) {
+    pcm_[ch].assign(kSamplesPerFrame, 0.0f);
+  }
+  pcm16_.resize(kSamplesPerFrame * 2 * sizeof(int16_t));
+  frame_.assign((kPaddingFrameLength + 7) / 8 + WmaFrameDecoder::kReadPadding,
+                0);
+  return true;
+}
+
+void XmaContext::Enable() {
+  threading::LockGuard lock(mutex_);
+  enabled_ = true;
+}
+
+void XmaContext::Disable() {
+  threading::LockGuard lock(mutex_);
+  enabled_ = false;
+}
+
+void XmaContext::Clear() {
+  threading::LockGuard lock(mutex_);
+  enabled_ = false;
+  frame_bits_ = 0;
+  frame_length_ = 0;
+  packet_decode_ns_ = 0;
+  packet_budget_ns_ = 0;
+  wma_.Reset();
+  auto* guest = static_cast<uint8_t*>(memory::TranslateVirtual(guest_address_));
+  data_.Load(guest);
+  data_.input_buffer_read_offset = 0;
+  data_.current_buffer = 0;
+  data_.output_buffer_write_offset = 0;
+  data_.StoreResult(guest);
+}
+
+uint32_t XmaContext::input_buffer_ptr(uint32_t index) const {
+  return index ? data_.input_buffer_1_ptr : data_.input_buffer_0_ptr;
+}
+
+uint32_t XmaContext::input_buffer_packets(uint32_t index) const {
+  return index ? data_.input_buffer_1_packet_count
+               : data_.input_buffer_0_packet_count;
+}
+
+bool XmaContext::input_buffer_valid(uint32_t index) const {
+  bool valid = index ? data_.input_buffer_1_valid : data_.input_buffer_0_valid;
+  return valid && input_buffer_ptr(index) && input_buffer_packets(index);
+}
+
+void XmaContext::InvalidateInputBuffer(uint32_t index) {
+  if (index) {
+    data_.input_buffer_1_valid = 0;
+  } else {
+    data_.input_buffer_0_valid = 0;
+  }
+}
+
+bool XmaContext::NextPacket(uint32_t packet, XmaDecodeStats* stats) {
+  FinishPacket(stats);
+  auto* buffer = static_cast<const uint8_t*>(
+      memory::TranslateVirtual(input_buffer_ptr(data_.current_buffer)));
+  // Packets of other streams interleaved in the buffer are skipped over
+  uint32_t skip = buffer[packet * kPacketSize + 3];
+  uint32_t next = skip == 0xFF ? input_buffer_packets(data_.current_buffer)
+                               : packet + 1 + skip;
+  if (next < input_buffer_packets(data_.current_buffer)) {
+    data_.input_buffer_read_offset = next * kPacketBits;
+    return true;
+  }
+  // Buffer consumed: hand it back and continue in the other one
+  InvalidateInputBuffer(data_.current_buffer);
+  data_.current_buffer ^= 1;
+  data_.input_buffer_read_offset = 0;
+  return input_buffer_valid(data_.current_buffer);
+}
+
+bool XmaContext::ReadStreamBits(uint32_t bits, XmaDecodeStats* stats) {
+  while (frame_bits_ < bits) {
+    uint32_t index = data_.current_buffer;
+    if (!input_buffer_valid(index)) return false;
+    auto* buffer = static_cast<const uint8_t*>(
+        memory::TranslateVirtual(input_buffer_ptr(index)));
+    uint32_t offset = data_.input_buffer_read_offset;
+    uint32_t packet = offset / kPacketBits;
+    if (packet >= input_buffer_packets(index)) {
+      // The guest pointed past the end; treat the buffer as consumed
+      InvalidateInputBuffer(index);
+      data_.current_buffer ^= 1;
+      data_.input_buffer_read_offset = 0;
+      continue;
+    }
+
+    if (offset % kPacketBits < kPacketHeaderBits) {
+      // Entering a packet: a frame in progress continues right after the
+      // header, a new one starts where the header says
+      const uint8_t* header = buffer + packet * kPacketSize;
+      uint32_t value = LoadBE32(header);
+      data_.packet_metadata = Bits(value, 8, 3);
+      uint32_t start = kPacketHeaderBits;
+      if (frame_bits_ && !frame_length_ && !Bits(value, 11, 15)) {
+        // Less than a length field was left before the packet ended and
+        // nothing carries on here: those bits were padding
+        frame_bits_ = 0;
+      }
+      if (!frame_bits_) {
+        uint32_t frame_count = Bits(value, 26, 6);
+        start += Bits(value, 11, 15);
+        if (!frame_count || start >= kPacketBits - kFrameLengthBits) {
+          // Nothing starts here (all continuation or padding)
+          if (!NextPacket(packet, stats)) return false;
+          continue;
+        }
+      }
+      data_.input_buffer_read_offset = packet * kPacketBits + start;
+      continue;
+    }
+
+    uint32_t packet_end = (packet + 1) * kPacketBits;
+    uint32_t take = std::min(bits - frame_bits_, packet_end - offset);
+    CopyBits(buffer, offset, frame_.data(), frame_bits_, take);
+    frame_bits_ += take;
+    data_.input_buffer_read_offset = offset + take;
+    if (offset + take == packet_end && !NextPacket(packet, stats) &&
+        frame_bits_ < bits) {
+      return false;
+    }
+  }
+  return true;
+}
+
+XmaContext::Fetch XmaContext::FetchFrame(XmaDecodeStats* stats) {
+  if (!frame_length_) {
+    if (!ReadStreamBits(kFrameLengthBits, stats)) {
+      return Fetch::kStarved;
+    }
+    uint32_t length = (uint32_t(frame_[0]) << 7) | (frame_[1] >> 1);
+    if (length == kPaddingFrameLength) {
+      // Rest of the packet is padding
+      frame_bits_ = 0;
+      uint32_t offset = data_.input_buffer_read_offset;
+      if (offset % kPacketBits) NextPacket(offset / kPacketBits, stats);
+      return Fetch::kPadding;
+    }
+    if (length <= kFrameLengthBits) {
+      frame_bits_ = 0;
+      return Fetch::kError;
+    }
+    frame_length_ = length;
+  }
+  if (!ReadStreamBits(frame_length_, stats)) {
+    return Fetch::kStarved;
+  }
+  return Fetch::kFrame;
+}
+
+bool XmaContext::DecodeFrame() {
+  uint32_t channels = data_.is_stereo ? 2 : 1;
+  wma_.Configure(channels, kSampleRates[data_.sample_rate]);
+  float* pcm[2] = {pcm_[0].data(), pcm_[1].data()};
+  bool ok = wma_.Decode(frame_.data(), frame_length_, pcm);
+  StorePcm16BE(pcm, channels, kSamplesPerFrame, pcm16_.data());
+  return ok;
+}
+
+void XmaContext::CopyToHost(bool* writing, uint32_t channels) {
+  if (!*writing) {
+    host_output_.BeginWrite(channels, kSampleRates[data_.sample_rate]);
+    *writing = true;
+  }
+  const float* pcm[2] = {pcm_[0].data(), pcm_[1].data()};
+  host_output_.Append(pcm, kSamplesPerFrame);
+}
+
+void XmaContext::FinishPacket(XmaDecodeStats* stats) {
+  stats->packets++;
+  if (packet_budget_ns_) {
+    stats->worst_packet = std::max(
+        stats->worst_packet, float(packet_decode_ns_) / float(packet_budget_ns_));
+  }
+  packet_decode_ns_ = 0;
+  packet_budget_ns_ = 0;
+}
+
+bool XmaContext::Work(XmaDecodeStats* stats) {
+  if (!enabled() || busy_.exchange(true, std::memory_order_acquire)) {
+    return false;
+  }
+  Decode(stats);
+  busy_.store(false, std::memory_order_release);
+  return true;
+}
+
+void XmaContext::Decode(XmaDecodeStats* stats) {
+  threading::LockGuard lock(mutex_);
+  if (!enabled_) return;
+  auto* guest = static_cast<uint8_t*>(memory::TranslateVirtual(guest_address_));
+  data_.Load(guest);
+  uint32_t block_count = data_.output_buffer_block_count;
+  if (!data_.output_buffer_valid || !block_count || !data_.output_buffer_ptr) {
+    return;
+  }
+
+  uint32_t channels = data_.is_stereo ? 2 : 1;
+  uint32_t frame_blocks =
+      kSamplesPerFrame * channels * sizeof(int16_t) / kOutputBlockSize;
+  uint64_t frame_budget_ns =
+      uint64_t(kSamplesPerFrame) * 1000000000ull /
+      kSampleRates[data_.sample_rate];
+  auto* ring = static_cast<uint8_t*>(
+      memory::TranslateVirtual(data_.output_buffer_ptr));
+  bool host_writing = false;
+
+  while (data_.output_buffer_valid) {
+    // write == read is an empty ring; a full one is flagged invalid
+    uint32_t write = data_.output_buffer_write_offset % block_count;
+    uint32_t read = data_.output_buffer_read_offset % block_count;
+    uint32_t free = read > write ? read - write : block_count - write + read;
+    if (free < frame_blocks) break;
+
+    uint64_t start_ns = Clock::QueryHostTickCount();
+    Fetch fetch = FetchFrame(stats);
+    if (fetch == Fetch::kPadding) continue;
+    if (fetch == Fetch::kStarved) break;
+    if (fetch == Fetch::kError) {
+      XELOGW("XMA context {}: bad frame length at bit {}", id_,
+             data_.input_buffer_read_offset);
+      data_.error_set = 1;
+      enabled_ = false;
+      break;
+    }
+
+    if (!DecodeFrame()) stats->corrupt_frames++;
+    frame_bits_ = 0;
+    frame_length_ = 0;
+    for (uint32_t i = 0; i < frame_blocks; ++i) {
+      memcpy(ring + write * kOutputBlockSize, &pcm16_[i * kOutputBlockSize],
+             kOutputBlockSize);
+      write = (write + 1) % block_count;
+    }
+    data_.output_buffer_write_offset = write;
+    if (write == read) data_.output_buffer_valid = 0;
+    CopyToHost(&host_writing, channels);
+
+    uint64_t ns = Clock::QueryHostTickCount() - start_ns;
+    packet_decode_ns_ += ns;
+    packet_budget_ns_ += frame_budget_ns;
+    stats->frames++;
+    stats->samples += kSamplesPerFrame;
+    stats->decode_ns += ns;
+    stats->budget_ns += frame_budget_ns;
+  }
+  if (host_writing) host_output_.Publish();
+  data_.StoreResult(guest);
+}
+
+}  // namespace xe::apu
@@ -0,0 +1,211 @@
+/**
+ * Vera360 — Xenia Edge
+ * XMA context — one hardware decode stream
+ *
+ * Titles describe each stream with a 64-byte big-endian context in guest
+ * memory: two input buffers of 2KB XMA packets that the hardware ping-pongs
+ * between, an output ring of 256-byte PCM blocks and the read/write
+ * cursors of both. A packet starts with a 32-bit header (frame count, bit
+ * offset of the first frame that starts in it, skip count to the stream's
+ * next packet); frames are bit-packed behind it, each led by its 15-bit
+ * length, and may run on into the next packet. Every frame is 512 samples
+ * per channel.
+ *
+ * Besides the guest ring, each context keeps a host copy of what it decoded
+ * in an XmaOutput, so the mixer can pick up a stream's newest audio without
+ * waiting for the thread decoding it.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "xenia/apu/wma_frame.h"
+#include "xenia/base/threading.h"
+
+namespace xe::apu {
+
+/// The guest context, unpacked (field layout as in Xenia's XMA_CONTEXT_DATA)
+struct XmaContextData {
+  static constexpr uint32_t kSize = 64;
+
+  // Dword 0
+  uint32_t input_buffer_0_packet_count;  // 12 bits
+  uint32_t loop_count;                   // 8
+  uint32_t input_buffer_0_valid;         // 1
+  uint32_t input_buffer_1_valid;         // 1
+  uint32_t output_buffer_block_count;    // 5
+  uint32_t output_buffer_write_offset;   // 5, in blocks
+  // Dword 1
+  uint32_t input_buffer_1_packet_count;  // 12
+  uint32_t loop_subframe_start;          // 2
+  uint32_t loop_subframe_end;            // 3
+  uint32_t loop_subframe_skip;           // 3
+  uint32_t subframe_decode_count;        // 4
+  uint32_t output_buffer_padding;        // 3
+  uint32_t sample_rate;                  // 2 (24, 32, 44.1, 48 kHz)
+  uint32_t is_stereo;                    // 1
+  uint32_t unk_dword_1;                  // 1
+  uint32_t output_buffer_valid;          // 1
+  // Dword 2
+  uint32_t input_buffer_read_offset;     // 26, in bits
+  uint32_t error_status;                 // 5
+  uint32_t error_set;                    // 1
+  // Dwords 3-4
+  uint32_t loop_start;                   // 26
+  uint32_t loop_end;                     // 26
+  uint32_t packet_metadata;              // 5
+  uint32_t current_buffer;               // 1
+  // Dwords 5-8
+  uint32_t input_buffer_0_ptr;
+  uint32_t input_buffer_1_ptr;
+  uint32_t output_buffer_ptr;
+  uint32_t work_buffer_ptr;
+  // Dword 9
+  uint32_t output_buffer_read_offset;    // 5, in blocks
+
+  void Load(const uint8_t* guest);
+  /// Writes back only the fields the hardware updates, so guest changes to
+  /// the others made during a decode survive
+  void StoreResult(uint8_t* guest) const;
+};
+
+/// Decode cost against the real-time length of the audio produced
+struct XmaDecodeStats {
+  uint64_t packets = 0;
+  uint64_t frames = 0;
+  uint64_t samples = 0;      // per channel
+  uint64_t corrupt_frames = 0;  // decoded as silence
+  uint64_t decode_ns = 0;
+  uint64_t budget_ns = 0;    // playback time of the decoded samples
+  float worst_packet = 0.0f;  // highest decode_ns / budget_ns of a packet
+
+  void Merge(const XmaDecodeStats& other);
+};
+
+/// A context's decoded PCM for the host mixer, double-buffered: the decoder
+/// fills one slot while the mixer reads the other, and neither side ever
+/// waits. A slot published but not yet taken is reclaimed and appended to,
+/// so nothing is lost unless the mixer falls a whole slot behind.
+class XmaOutput {
+ public:
+  static constexpr uint32_t kMaxFrames = 8;
+  static constexpr uint32_t kChannelStride = kMaxFrames * 512;
+
+  struct Slot {
+    uint32_t channels = 0;
+    uint32_t sample_rate = 0;
+    uint32_t samples = 0;  // per channel
+    /// Planar: channel c starts at c * kChannelStride
+    std::vector<float> pcm;
+  };
+
+  // Decoder side
+  void BeginWrite(uint32_t channels, uint32_t sample_rate);
+  /// Add count samples per channel; when the slot is full its audio is
+  /// discarded first
+  void Append(const float* const* channels, uint32_t count);
+  void Publish();
+
+  // Mixer side
+  /// The published slot, or nullptr if nothing new; hold it until Release
+  const Slot* Acquire();
+  void Release();
+
+  /// Samples per channel discarded because the mixer fell behind
+  uint64_t dropped_samples() const {
+    return dropped_samples_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  // Bits 0-1: published slot + 1, bits 2-3: slot being read + 1 (0 = none)
+  std::atomic<uint32_t> state_{0};
+  Slot slots_[2];
+  uint32_t writing_ = 0;
+  std::atomic<uint64_t> dropped_samples_{0};
+};
+
+class XmaContext {
+ public:
+  static constexpr uint32_t kPacketSize = 2048;
+  static constexpr uint32_t kPacketHeaderBits = 32;
+  static constexpr uint32_t kSamplesPerFrame = 512;
+  static constexpr uint32_t kOutputBlockSize = 256;
+
+  bool Initialize(uint32_t id, uint32_t guest_address);
+
+  uint32_t id() const { return id_; }
+  uint32_t guest_address() const { return guest_address_; }
+
+  /// Claimed by a title (AllocateContext / ReleaseContext)
+  bool allocated() const { return allocated_; }
+  void set_allocated(bool allocated) { allocated_ = allocated; }
+
+  bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+  /// Kick register: start or continue decoding
+  void Enable();
+  /// Lock register: stop; waits out a decode in progress
+  void Disable();
+  /// Clear register: stop and reset the stream state
+  void Clear();
+
+  /// Decode until the output ring is full or the input runs dry. Safe to
+  /// call from several threads: a context another thread is decoding is
+  /// skipped rather than waited for (returns false).
+  bool Work(XmaDecodeStats* stats);
+  bool busy() const { return busy_.load(std::memory_order_acquire); }
+
+  /// Host copy of the decoded audio, published after each Work call that
+  /// produced frames
+  XmaOutput& output() { return host_output_; }
+
+ private:
+  enum class Fetch { kFrame, kPadding, kStarved, kError };
+
+  void Decode(XmaDecodeStats* stats);
+
+  uint32_t input_buffer_ptr(uint32_t index) const;
+  uint32_t input_buffer_packets(uint32_t index) const;
+  bool input_buffer_valid(uint32_t index) const;
+  void InvalidateInputBuffer(uint32_t index);
+
+  /// Leave packet for the stream's next one, switching input buffers at
+  /// the end of one; false if the next buffer is not ready
+  bool NextPacket(uint32_t packet, XmaDecodeStats* stats);
+  /// Fill frame_ with the stream up to bits; false when starved
+  bool ReadStreamBits(uint32_t bits, XmaDecodeStats* stats);
+  /// Reassemble the next frame (it may span packets and buffers)
+  Fetch FetchFrame(XmaDecodeStats* stats);
+  /// Decode the frame in frame_ into pcm_ and pcm16_; false if corrupt
+  bool DecodeFrame();
+  /// Append pcm_ to the host output, opening a write on the first frame
+  void CopyToHost(bool* writing, uint32_t channels);
+  /// Close the per-packet cost accounting
+  void FinishPacket(XmaDecodeStats* stats);
+
+  uint32_t id_ = 0;
+  uint32_t guest_address_ = 0;
+  bool allocated_ = false;
+  std::atomic<bool> enabled_{false};
+  std::atomic<bool> busy_{false};
+  threading::Mutex mutex_;
+  XmaContextData data_ = {};
+
+  // Frame reassembly: bits carried over while waiting for the next buffer
+  std::vector<uint8_t> frame_;
+  uint32_t frame_bits_ = 0;
+  uint32_t frame_length_ = 0;  // 0 until the length field is read
+
+  // Decoding
+  WmaFrameDecoder wma_;
+  std::vector<float> pcm_[2];
+  std::vector<uint8_t> pcm16_;
+  XmaOutput host_output_;
+
+  // Cost of the packet the read cursor is in
+  uint64_t packet_decode_ns_ = 0;
+  uint64_t packet_budget_ns_ = 0;
+};
+
+}  // namespace xe::apu
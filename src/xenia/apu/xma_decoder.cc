@@ -1,55 +1,274 @@
 /**
  * Vera360 — Xenia Edge
- * XMA Decoder — Xbox 360 XMA audio format decoder stub
- *
- * XMA is Microsoft's proprietary audio codec used by the Xbox 360.
- * Full decoding requires either a software decoder (like FFmpeg's xma2)
- * or a hardware-specific implementation.
+ * XMA decoder — context array, APU registers and the audio thread
  */
 
+#include "xenia/apu/xma_decoder.h"
+#include "xenia/base/clock.h"
+#include "xenia/base/cvar.h"
 #include "xenia/base/logging.h"
-#include <cstdint>
-#include <vector>
+#include "xenia/base/memory/memory.h"
+
+#include <unistd.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 
 namespace xe::apu {
 
-/// XMA packet header
-struct XmaPacketHeader {
-  uint32_t frame_count;
-  uint32_t frame_offset_bits;
-  uint32_t metadata;
-};
-
-class XmaDecoder {
- public:
-  bool Initialize() {
-    XELOGI("XMA decoder initialized (stub)");
-    return true;
-  }
-
-  void Shutdown() {}
-
-  /// Decode an XMA packet to PCM samples
-  /// Returns the number of decoded samples
-  uint32_t DecodePacket(const uint8_t* xma_data, uint32_t data_size,
-                         int16_t* pcm_out, uint32_t max_samples) {
-    // TODO: Implement XMA decoding
-    // For now, output silence
-    if (pcm_out && max_samples > 0) {
-      for (uint32_t i = 0; i < max_samples; ++i) {
-        pcm_out[i] = 0;
-      }
+DEFINE_int32(xma_decoder_threads, 0,
+             "Threads decoding XMA streams in parallel, the audio thread "
+             "included (0 = one per core, up to 4)");
+
+namespace {
+
+// Register indices (byte offset / 4); each bank is 10 x 32 context bits
+constexpr uint32_t kRegContextArrayAddress = 0x600;
+constexpr uint32_t kRegKickBase = 0x650;
+constexpr uint32_t kRegLockBase = 0x690;
+constexpr uint32_t kRegClearBase = 0x6A0;
+constexpr uint32_t kRegBankSize = XmaDecoder::kContextCount / 32;
+
+// An XMA frame is ~10 ms at 48 kHz; poll twice per frame so a ring the
+// guest has drained is refilled well before it runs dry
+constexpr uint32_t kPollPeriodMs = 5;
+constexpr uint64_t kReportIntervalNs = 10ull * 1000000000ull;
+
+constexpr uint32_t kContextArraySize =
+    XmaDecoder::kContextCount * XmaContextData::kSize;
+
+// Beyond this the pool mostly competes with the guest's CPU threads
+constexpr uint32_t kMaxDecodeThreads = 4;
+
+uint32_t OnlineCoreCount() {
+  long cores = sysconf(_SC_NPROCESSORS_ONLN);
+  return cores > 0 ? static_cast<uint32_t>(cores) : 1;
+}
+
+}  // namespace
+
+XmaDecoder::XmaDecoder() = default;
+
+XmaDecoder::~XmaDecoder() { Shutdown(); }
+
+bool XmaDecoder::Initialize(const XmaDecoderOptions& options) {
+  void* array = memory::TranslateVirtual(kContextArrayAddress);
+  if (!memory::Commit(array, kContextArraySize, memory::PageAccess::kReadWrite)) {
+    XELOGE("XMA: cannot commit the context array at 0x{:08X}",
+           kContextArrayAddress);
+    return false;
+  }
+  memset(array, 0, kContextArraySize);
+  for (uint32_t i = 0; i < kContextCount; ++i) {
+    if (!contexts_[i].Initialize(
+            i, kContextArrayAddress + i * XmaContextData::kSize)) {
+      return false;
     }
-    return max_samples;
   }
 
-  /// Get the output sample rate (typically 44100 or 48000)
-  uint32_t sample_rate() const { return 48000; }
-  /// Get the number of channels
-  uint32_t channels() const { return 2; }
+  uint32_t threads = options.thread_count;
+  if (!threads) {
+    int32_t configured = cvars.GetValue<int32_t>("xma_decoder_threads", 0);
+    threads = configured > 0 ? uint32_t(configured)
+                             : std::min(OnlineCoreCount(), kMaxDecodeThreads);
+  }
+  helper_count_ = std::min(threads - 1,
+                           threading::JobSystem::Shared().worker_count());
 
- private:
-  // Decode state would go here
-};
+  shutting_down_ = false;
+  if (options.audio_thread) {
+    worker_ =
+        threading::Thread::Create([this]() { WorkerMain(); }, "XMA Decoder");
+  }
+  XELOGI("XMA decoder: {} contexts at 0x{:08X}, {} decode threads, {} "
+         "synthesis", kContextCount, kContextArrayAddress, thread_count(),
+         Imdct::backend_name());
+  return true;
+}
+
+void XmaDecoder::Shutdown() {
+  if (worker_) {
+    {
+      threading::LockGuard lock(worker_mutex_);
+      shutting_down_ = true;
+    }
+    worker_cv_.NotifyAll();
+    worker_->Join();
+    worker_.reset();
+  }
+  // Helpers still on a context finish it; nothing is left to claim after
+  next_context_.store(kContextCount, std::memory_order_relaxed);
+  threading::JobSystem::Shared().Wait(helper_counter_);
+}
+
+uint32_t XmaDecoder::AllocateContext() {
+  threading::LockGuard lock(allocation_mutex_);
+  for (auto& context : contexts_) {
+    if (context.allocated()) continue;
+    context.set_allocated(true);
+    memset(memory::TranslateVirtual(context.guest_address()), 0,
+           XmaContextData::kSize);
+    context.Clear();
+    return context.guest_address();
+  }
+  XELOGW("XMA: all {} contexts are in use", kContextCount);
+  return 0;
+}
+
+void XmaDecoder::ReleaseContext(uint32_t guest_address) {
+  threading::LockGuard lock(allocation_mutex_);
+  XmaContext* context = ContextAt(guest_address);
+  if (!context || !context->allocated()) return;
+  context->Clear();
+  context->set_allocated(false);
+}
+
+XmaContext* XmaDecoder::ContextAt(uint32_t guest_address) {
+  uint32_t offset = guest_address - kContextArrayAddress;
+  if (offset >= kContextArraySize || offset % XmaContextData::kSize) {
+    return nullptr;
+  }
+  return &contexts_[offset / XmaContextData::kSize];
+}
+
+// ── Registers ────────────────────────────────────────────────────────────────
+
+bool XmaDecoder::HandleMmioWrite(uint32_t guest_addr, uint32_t value) {
+  if (!IsMmio(guest_addr)) return false;
+  uint32_t reg = (guest_addr - kRegisterBase) / 4;
+
+  bool kicked = false;
+  auto for_each_bit = [&](uint32_t bank, auto&& fn) {
+    for (uint32_t bits = value; bits; bits &= bits - 1) {
+      fn(contexts_[bank * 32 + __builtin_ctz(bits)]);
+    }
+  };
+  if (reg - kRegKickBase < kRegBankSize) {
+    for_each_bit(reg - kRegKickBase, [](XmaContext& c) { c.Enable(); });
+    kicked = value != 0;
+  } else if (reg - kRegLockBase < kRegBankSize) {
+    for_each_bit(reg - kRegLockBase, [](XmaContext& c) { c.Disable(); });
+  } else if (reg - kRegClearBase < kRegBankSize) {
+    for_each_bit(reg - kRegClearBase, [](XmaContext& c) { c.Clear(); });
+  } else {
+    XELOGD("XMA: write 0x{:08X} to register 0x{:03X} ignored", value, reg);
+  }
+
+  if (kicked) {
+    {
+      threading::LockGuard lock(worker_mutex_);
+      kicked_ = true;
+    }
+    worker_cv_.NotifyOne();
+  }
+  return true;
+}
+
+uint32_t XmaDecoder::HandleMmioRead(uint32_t guest_addr) {
+  uint32_t reg = (guest_addr - kRegisterBase) / 4;
+  return reg == kRegContextArrayAddress ? kContextArrayAddress : 0;
+}
+
+bool XmaDecoder::idle() const {
+  return std::none_of(contexts_.begin(), contexts_.end(),
+                      [](const XmaContext& c) { return c.busy(); });
+}
+
+XmaDecodeStats XmaDecoder::stats() {
+  threading::LockGuard lock(stats_mutex_);
+  return stats_;
+}
+
+// ── Decode pool ──────────────────────────────────────────────────────────────
+
+bool XmaDecoder::DecodePeriod() {
+  if (std::none_of(contexts_.begin(), contexts_.end(),
+                   [](const XmaContext& c) { return c.enabled(); })) {
+    return false;
+  }
+  // Helpers still finishing the last period join this one when they are
+  // done; a context they hold is skipped here, not waited for
+  next_context_.store(0, std::memory_order_relaxed);
+  uint32_t running = helpers_running_.load(std::memory_order_relaxed);
+  if (running < helper_count_) {
+    threading::JobOptions options;
+    options.name = "xma_decode";
+    options.priority = threading::JobPriority::kCritical;
+    options.counter = &helper_counter_;
+    for (uint32_t i = running; i < helper_count_; ++i) {
+      helpers_running_.fetch_add(1, std::memory_order_relaxed);
+      threading::JobSystem::Shared().Submit(
+          [this]() {
+            RunJobs();
+            helpers_running_.fetch_sub(1, std::memory_order_relaxed);
+          },
+          options);
+    }
+  }
+  RunJobs();
+  return true;
+}
+
+void XmaDecoder::RunJobs() {
+  XmaDecodeStats pass;
+  for (;;) {
+    uint32_t index = next_context_.fetch_add(1, std::memory_order_relaxed);
+    if (index >= kContextCount) break;
+    contexts_[index].Work(&pass);
+  }
+  if (pass.frames || pass.packets) {
+    threading::LockGuard lock(stats_mutex_);
+    stats_.Merge(pass);
+    report_.Merge(pass);
+  }
+}
+
+// ── Audio thread ─────────────────────────────────────────────────────────────
+
+void XmaDecoder::WorkerMain() {
+  bool active = false;
+  uint64_t report_start_ns = Clock::QueryHostTickCount();
+
+  for (;;) {
+    {
+      threading::LockGuard lock(worker_mutex_);
+      // Idle until kicked; while streams play, also wake once a period to
+      // refill rings the guest has drained
+      if (active) {
+        if (!kicked_ && !shutting_down_) {
+          worker_cv_.WaitFor(worker_mutex_, kPollPeriodMs);
+        }
+      } else {
+        while (!kicked_ && !shutting_down_) worker_cv_.Wait(worker_mutex_);
+      }
+      if (shutting_down_) break;
+      kicked_ = false;
+    }
+
+    active = DecodePeriod();
+
+    uint64_t now_ns = Clock::QueryHostTickCount();
+    if (now_ns - report_start_ns >= kReportIntervalNs) {
+      XmaDecodeStats report;
+      {
+        threading::LockGuard lock(stats_mutex_);
+        report = report_;
+        report_ = {};
+      }
+      if (report.budget_ns) {
+        float load = 100.0f * float(report.decode_ns) / float(report.budget_ns);
+        float cpu = 100.0f * float(report.decode_ns) /
+                    float(now_ns - report_start_ns);
+        XELOGD("XMA: {} frames ({} corrupt) in {} packets, decode {}% of "
+               "real time (worst packet {}%), {}% of a core",
+               report.frames, report.corrupt_frames, report.packets,
+               std::round(load * 10) / 10,
+               std::round(report.worst_packet * 1000) / 10,
+               std::round(cpu * 10) / 10);
+      }
+      report_start_ns = now_ns;
+    }
+  }
+}
 
 }  // namespace xe::apu
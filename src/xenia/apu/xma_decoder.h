@@ -0,0 +1,109 @@
+/**
+ * Vera360 — Xenia Edge
+ * XMA decoder — the APU's hardware decode block
+ *
+ * 320 contexts live in guest memory; titles claim them through the kernel
+ * and drive them with the APU registers at 0x7FEA0000 (one bit per context
+ * in the kick, lock and clear banks). A dedicated audio thread sleeps until
+ * a context is kicked and then runs one decode period every few
+ * milliseconds, so it costs nothing while a title is silent.
+ *
+ * Each period every enabled context is a work item: the audio thread and
+ * a few helper jobs on the shared job system claim contexts from a shared
+ * cursor and decode them in parallel. A context still being decoded from an
+ * earlier period is skipped, and the audio thread stops once no context is
+ * left to claim rather than waiting for the helpers, so one slow stream
+ * cannot hold up the period. Finished audio is published lock-free through
+ * each context's XmaOutput. Every frame's decode time is weighed against
+ * the playback time it produces.
+ */
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "xenia/apu/xma_context.h"
+#include "xenia/base/job_system.h"
+#include "xenia/base/threading.h"
+
+namespace xe::apu {
+
+struct XmaDecoderOptions {
+  /// Contexts decoded in parallel, the audio thread included (the rest are
+  /// pool jobs); 0 = xma_decoder_threads
+  uint32_t thread_count = 0;
+  /// False: no audio thread, the caller runs DecodePeriod itself (tools)
+  bool audio_thread = true;
+};
+
+class XmaDecoder {
+ public:
+  static constexpr uint32_t kContextCount = 320;
+  static constexpr uint32_t kContextArrayAddress = 0xE0000000;
+  static constexpr uint32_t kRegisterBase = 0x7FEA0000;
+  static constexpr uint32_t kRegisterSize = 0x10000;
+
+  XmaDecoder();
+  ~XmaDecoder();
+
+  /// Map the context array and start the audio thread
+  bool Initialize(const XmaDecoderOptions& options = {});
+  void Shutdown();
+
+  /// One audio period: offer every enabled context to the pool and decode
+  /// alongside it until none is left to claim. Contexts a helper is still
+  /// on finish in the background. False if no context is enabled.
+  bool DecodePeriod();
+  /// No context is being decoded
+  bool idle() const;
+  uint32_t thread_count() const { return helper_count_ + 1; }
+
+  /// Claim a free context; its guest address, or 0 if all are in use
+  uint32_t AllocateContext();
+  void ReleaseContext(uint32_t guest_address);
+
+  /// Host copy of a context's decoded audio; nullptr for a bad address
+  XmaOutput* context_output(uint32_t guest_address) {
+    XmaContext* context = ContextAt(guest_address);
+    return context ? &context->output() : nullptr;
+  }
+
+  static bool IsMmio(uint32_t guest_addr) {
+    return guest_addr - kRegisterBase < kRegisterSize;
+  }
+  bool HandleMmioWrite(uint32_t guest_addr, uint32_t value);
+  uint32_t HandleMmioRead(uint32_t guest_addr);
+
+  /// Totals since Initialize
+  XmaDecodeStats stats();
+
+ private:
+  XmaContext* ContextAt(uint32_t guest_address);
+  void WorkerMain();
+  /// Claim and decode contexts until the period's cursor runs out
+  void RunJobs();
+
+  std::array<XmaContext, kContextCount> contexts_;
+  threading::Mutex allocation_mutex_;
+
+  std::unique_ptr<threading::Thread> worker_;
+  threading::Mutex worker_mutex_;
+  threading::ConditionVariable worker_cv_;
+  bool kicked_ = false;
+  bool shutting_down_ = false;
+
+  // Helper jobs
+  uint32_t helper_count_ = 0;
+  std::atomic<uint32_t> helpers_running_{0};
+  threading::JobCounter helper_counter_;
+  std::atomic<uint32_t> next_context_{kContextCount};
+
+  threading::Mutex stats_mutex_;
+  XmaDecodeStats stats_;
+  XmaDecodeStats report_;  // since the last log line
+};
+
+}  // namespace xe::apu
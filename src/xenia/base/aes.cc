@@ -0,0 +1,358 @@
+/**
+ * Vera360 — Xenia Edge
+ * AES-128 decryption (FIPS 197): ARMv8 Crypto / AES-NI / T-table back-ends
+ */
+
+#include "xenia/base/aes.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#if defined(__aarch64__) && (defined(__ARM_FEATURE_AES) || defined(__ARM_FEATURE_CRYPTO))
+#define XE_AES_ARMV8 1
+#include <arm_neon.h>
+#elif defined(__x86_64__)
+#define XE_AES_NI 1
+#include <immintrin.h>
+#endif
+
+namespace xe {
+
+namespace {
+
+// ── Tables ───────────────────────────────────────────────────────────────────
+
+constexpr uint8_t Rotl8(uint8_t v, int n) {
+  return static_cast<uint8_t>((v << n) | (v >> (8 - n)));
+}
+
+constexpr uint8_t GfMul(uint8_t a, uint8_t b) {
+  uint8_t r = 0;
+  while (b) {
+    if (b & 1) r ^= a;
+    a = static_cast<uint8_t>((a << 1) ^ ((a & 0x80) ? 0x1B : 0));
+    b >>= 1;
+  }
+  return r;
+}
+
+struct Tables {
+  std::array<uint8_t, 256> sbox{};
+  std::array<uint8_t, 256> inv_sbox{};
+  std::array<uint32_t, 256> td0{};
+  std::array<uint32_t, 256> td1{};
+  std::array<uint32_t, 256> td2{};
+  std::array<uint32_t, 256> td3{};
+
+  constexpr Tables() {
+    // S-box from the multiplicative inverse (p walks GF(2^8)* via 3^k,
+    // q via 3^-k) and the affine transform
+    uint8_t p = 1, q = 1;
+    do {
+      p = static_cast<uint8_t>(p ^ (p << 1) ^ ((p & 0x80) ? 0x1B : 0));
+      q = static_cast<uint8_t>(q ^ (q << 1));
+      q = static_cast<uint8_t>(q ^ (q << 2));
+      q = static_cast<uint8_t>(q ^ (q << 4));
+      if (q & 0x80) q ^= 0x09;
+      sbox[p] = static_cast<uint8_t>(q ^ Rotl8(q, 1) ^ Rotl8(q, 2) ^
+                                     Rotl8(q, 3) ^ Rotl8(q, 4) ^ 0x63);
+    } while (p != 1);
+    sbox[0] = 0x63;
+    for (int i = 0; i < 256; ++i) inv_sbox[sbox[i]] = static_cast<uint8_t>(i);
+    for (int i = 0; i < 256; ++i) {
+      uint8_t s = inv_sbox[i];
+      uint32_t w = (uint32_t(GfMul(s, 0x0E)) << 24) |
+                   (uint32_t(GfMul(s, 0x09)) << 16) |
+                   (uint32_t(GfMul(s, 0x0D)) << 8) | GfMul(s, 0x0B);
+      td0[i] = w;
+      td1[i] = (w >> 8) | (w << 24);
+      td2[i] = (w >> 16) | (w << 16);
+      td3[i] = (w >> 24) | (w << 8);
+    }
+  }
+};
+
+constexpr Tables kTables;
+
+inline uint32_t LoadBE32(const uint8_t* p) {
+  return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) |
+         (uint32_t(p[2]) << 8) | p[3];
+}
+
+inline void StoreBE32(uint8_t* p, uint32_t v) {
+  p[0] = static_cast<uint8_t>(v >> 24);
+  p[1] = static_cast<uint8_t>(v >> 16);
+  p[2] = static_cast<uint8_t>(v >> 8);
+  p[3] = static_cast<uint8_t>(v);
+}
+
+uint32_t SubWord(uint32_t w) {
+  const auto& s = kTables.sbox;
+  return (uint32_t(s[w >> 24]) << 24) | (uint32_t(s[(w >> 16) & 0xFF]) << 16) |
+         (uint32_t(s[(w >> 8) & 0xFF]) << 8) | s[w & 0xFF];
+}
+
+/// InvMixColumns of one round-key word (Td(S(x)) == InvMixColumns(x))
+uint32_t InvMixColumn(uint32_t w) {
+  const auto& t = kTables;
+  return t.td0[t.sbox[w >> 24]] ^ t.td1[t.sbox[(w >> 16) & 0xFF]] ^
+         t.td2[t.sbox[(w >> 8) & 0xFF]] ^ t.td3[t.sbox[w & 0xFF]];
+}
+
+// ── Portable ────────────────────────────────────────────────────────────────
+
+void DecryptBlockPortable(const uint32_t* rk, const uint8_t* in, uint8_t* out) {
+  const auto& t = kTables;
+  uint32_t s0 = LoadBE32(in) ^ rk[0];
+  uint32_t s1 = LoadBE32(in + 4) ^ rk[1];
+  uint32_t s2 = LoadBE32(in + 8) ^ rk[2];
+  uint32_t s3 = LoadBE32(in + 12) ^ rk[3];
+  for (int round = 1; round < 10; ++round) {
+    rk += 4;
+    uint32_t t0 = t.td0[s0 >> 24] ^ t.td1[(s3 >> 16) & 0xFF] ^
+                  t.td2[(s2 >> 8) & 0xFF] ^ t.td3[s1 & 0xFF] ^ rk[0];
+    uint32_t t1 = t.td0[s1 >> 24] ^ t.td1[(s0 >> 16) & 0xFF] ^
+                  t.td2[(s3 >> 8) & 0xFF] ^ t.td3[s2 & 0xFF] ^ rk[1];
+    uint32_t t2 = t.td0[s2 >> 24] ^ t.td1[(s1 >> 16) & 0xFF] ^
+                  t.td2[(s0 >> 8) & 0xFF] ^ t.td3[s3 & 0xFF] ^ rk[2];
+    uint32_t t3 = t.td0[s3 >> 24] ^ t.td1[(s2 >> 16) & 0xFF] ^
+                  t.td2[(s1 >> 8) & 0xFF] ^ t.td3[s0 & 0xFF] ^ rk[3];
+    s0 = t0;
+    s1 = t1;
+    s2 = t2;
+    s3 = t3;
+  }
+  rk += 4;
+  const auto& is = t.inv_sbox;
+  auto last = [&](uint32_t a, uint32_t b, uint32_t c, uint32_t d, uint32_t k) {
+    return ((uint32_t(is[a >> 24]) << 24) | (uint32_t(is[(b >> 16) & 0xFF]) << 16) |
+            (uint32_t(is[(c >> 8) & 0xFF]) << 8) | is[d & 0xFF]) ^ k;
+  };
+  StoreBE32(out, last(s0, s3, s2, s1, rk[0]));
+  StoreBE32(out + 4, last(s1, s0, s3, s2, rk[1]));
+  StoreBE32(out + 8, last(s2, s1, s0, s3, rk[2]));
+  StoreBE32(out + 12, last(s3, s2, s1, s0, rk[3]));
+}
+
+void DecryptCbcPortable(const uint32_t* rk, const uint8_t* in, uint8_t* out,
+                        size_t length, uint8_t* iv) {
+  uint8_t prev[16], cipher[16];
+  memcpy(prev, iv, 16);
+  for (size_t i = 0; i < length; i += 16) {
+    memcpy(cipher, in + i, 16);
+    DecryptBlockPortable(rk, cipher, out + i);
+    for (int j = 0; j < 16; ++j) out[i + j] ^= prev[j];
+    memcpy(prev, cipher, 16);
+  }
+  memcpy(iv, prev, 16);
+}
+
+// ── ARMv8 Crypto Extensions ─────────────────────────────────────────────────
+
+#if XE_AES_ARMV8
+
+inline uint8x16_t DecryptArm(const uint8x16_t* k, uint8x16_t s) {
+  for (int r = 0; r < 9; ++r) s = vaesimcq_u8(vaesdq_u8(s, k[r]));
+  return veorq_u8(vaesdq_u8(s, k[9]), k[10]);
+}
+
+void DecryptCbcArm(const uint8_t* keys, const uint8_t* in, uint8_t* out,
+                   size_t length, uint8_t* iv) {
+  uint8x16_t k[11];
+  for (int i = 0; i < 11; ++i) k[i] = vld1q_u8(keys + i * 16);
+  uint8x16_t prev = vld1q_u8(iv);
+  size_t i = 0;
+  // CBC decryption has no serial dependency: keep four blocks in flight
+  for (; i + 64 <= length; i += 64) {
+    uint8x16_t c0 = vld1q_u8(in + i), c1 = vld1q_u8(in + i + 16);
+    uint8x16_t c2 = vld1q_u8(in + i + 32), c3 = vld1q_u8(in + i + 48);
+    uint8x16_t p0 = c0, p1 = c1, p2 = c2, p3 = c3;
+    for (int r = 0; r < 9; ++r) {
+      p0 = vaesimcq_u8(vaesdq_u8(p0, k[r]));
+      p1 = vaesimcq_u8(vaesdq_u8(p1, k[r]));
+      p2 = vaesimcq_u8(vaesdq_u8(p2, k[r]));
+      p3 = vaesimcq_u8(vaesdq_u8(p3, k[r]));
+    }
+    p0 = veorq_u8(veorq_u8(vaesdq_u8(p0, k[9]), k[10]), prev);
+    p1 = veorq_u8(veorq_u8(vaesdq_u8(p1, k[9]), k[10]), c0);
+    p2 = veorq_u8(veorq_u8(vaesdq_u8(p2, k[9]), k[10]), c1);
+    p3 = veorq_u8(veorq_u8(vaesdq_u8(p3, k[9]), k[10]), c2);
+    vst1q_u8(out + i, p0);
+    vst1q_u8(out + i + 16, p1);
+    vst1q_u8(out + i + 32, p2);
+    vst1q_u8(out + i + 48, p3);
+    prev = c3;
+  }
+  for (; i < length; i += 16) {
+    uint8x16_t c = vld1q_u8(in + i);
+    vst1q_u8(out + i, veorq_u8(DecryptArm(k, c), prev));
+    prev = c;
+  }
+  vst1q_u8(iv, prev);
+}
+
+#endif  // XE_AES_ARMV8
+
+// ── AES-NI ──────────────────────────────────────────────────────────────────
+
+#if XE_AES_NI
+
+bool HasAesNi() {
+  static const bool has = __builtin_cpu_supports("aes");
+  return has;
+}
+
+__attribute__((target("aes,sse2"))) inline __m128i DecryptNi(const __m128i* k,
+                                                             __m128i s) {
+  s = _mm_xor_si128(s, k[0]);
+  for (int r = 1; r < 10; ++r) s = _mm_aesdec_si128(s, k[r]);
+  return _mm_aesdeclast_si128(s, k[10]);
+}
+
+__attribute__((target("aes,sse2"))) void DecryptCbcNi(const uint8_t* keys,
+                                                      const uint8_t* in,
+                                                      uint8_t* out,
+                                                      size_t length,
+                                                      uint8_t* iv) {
+  __m128i k[11];
+  for (int i = 0; i < 11; ++i) {
+    k[i] = _mm_load_si128(reinterpret_cast<const __m128i*>(keys + i * 16));
+  }
+  auto load = [](const uint8_t* p) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+  };
+  auto store = [](uint8_t* p, __m128i v) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v);
+  };
+  __m128i prev = load(iv);
+  size_t i = 0;
+  for (; i + 64 <= length; i += 64) {
+    __m128i c0 = load(in + i), c1 = load(in + i + 16);
+    __m128i c2 = load(in + i + 32), c3 = load(in + i + 48);
+    __m128i p0 = _mm_xor_si128(c0, k[0]), p1 = _mm_xor_si128(c1, k[0]);
+    __m128i p2 = _mm_xor_si128(c2, k[0]), p3 = _mm_xor_si128(c3, k[0]);
+    for (int r = 1; r < 10; ++r) {
+      p0 = _mm_aesdec_si128(p0, k[r]);
+      p1 = _mm_aesdec_si128(p1, k[r]);
+      p2 = _mm_aesdec_si128(p2, k[r]);
+      p3 = _mm_aesdec_si128(p3, k[r]);
+    }
+    store(out + i, _mm_xor_si128(_mm_aesdeclast_si128(p0, k[10]), prev));
+    store(out + i + 16, _mm_xor_si128(_mm_aesdeclast_si128(p1, k[10]), c0));
+    store(out + i + 32, _mm_xor_si128(_mm_aesdeclast_si128(p2, k[10]), c1));
+    store(out + i + 48, _mm_xor_si128(_mm_aesdeclast_si128(p3, k[10]), c2));
+    prev = c3;
+  }
+  for (; i < length; i += 16) {
+    __m128i c = load(in + i);
+    store(out + i, _mm_xor_si128(DecryptNi(k, c), prev));
+    prev = c;
+  }
+  store(iv, prev);
+}
+
+#endif  // XE_AES_NI
+
+}  // namespace
+
+// ── Aes128 ──────────────────────────────────────────────────────────────────
+
+Aes128::Aes128(const uint8_t key[kKeySize]) {
+  static constexpr uint8_t kRcon[10] = {0x01, 0x02, 0x04, 0x08, 0x10,
+                                        0x20, 0x40, 0x80, 0x1B, 0x36};
+  uint32_t ek[44];
+  for (int i = 0; i < 4; ++i) ek[i] = LoadBE32(key + i * 4);
+  for (int i = 4; i < 44; ++i) {
+    uint32_t t = ek[i - 1];
+    if (i % 4 == 0) {
+      t = SubWord((t << 8) | (t >> 24)) ^ (uint32_t(kRcon[i / 4 - 1]) << 24);
+    }
+    ek[i] = ek[i - 4] ^ t;
+  }
+
+  for (int round = 0; round <= 10; ++round) {
+    const uint32_t* src = ek + (10 - round) * 4;
+    for (int j = 0; j < 4; ++j) {
+      uint32_t w = (round == 0 || round == 10) ? src[j] : InvMixColumn(src[j]);
+      dec_words_[round * 4 + j] = w;
+      StoreBE32(dec_keys_ + round * 16 + j * 4, w);
+    }
+  }
+}
+
+void Aes128::DecryptBlock(const uint8_t in[kBlockSize],
+                          uint8_t out[kBlockSize]) const {
+  uint8_t zero_iv[kBlockSize] = {};
+  DecryptCbc(in, out, kBlockSize, zero_iv);
+}
+
+void Aes128::DecryptCbc(const uint8_t* in, uint8_t* out, size_t length,
+                        uint8_t iv[kBlockSize]) const {
+  length &= ~(kBlockSize - 1);
+#if XE_AES_ARMV8
+  DecryptCbcArm(dec_keys_, in, out, length, iv);
+#else
+#if XE_AES_NI
+  if (HasAesNi()) {
+    DecryptCbcNi(dec_keys_, in, out, length, iv);
+    return;
+  }
+#endif
+  DecryptCbcPortable(dec_words_, in, out, length, iv);
+#endif
+}
+
+void Aes128::DecryptCbcRange(const uint8_t* stream, size_t stream_size,
+                             size_t offset, size_t length, uint8_t* out,
+                             const uint8_t iv[kBlockSize]) const {
+  const size_t full_end = stream_size & ~(kBlockSize - 1);
+  size_t pos = offset & ~(kBlockSize - 1);
+  uint8_t chain[kBlockSize];
+  memcpy(chain, pos ? stream + pos - kBlockSize : iv, kBlockSize);
+
+  // Partial leading block
+  if (pos != offset && pos < full_end) {
+    uint8_t block[kBlockSize];
+    DecryptCbc(stream + pos, block, kBlockSize, chain);
+    size_t skip = offset - pos;
+    size_t n = std::min(length, kBlockSize - skip);
+    memcpy(out, block + skip, n);
+    out += n;
+    offset += n;
+    length -= n;
+    pos += kBlockSize;
+  }
+
+  // Whole blocks straight into the destination
+  size_t whole = std::min(length, full_end > offset ? full_end - offset : 0) &
+                 ~(kBlockSize - 1);
+  if (whole) {
+    DecryptCbc(stream + offset, out, whole, chain);
+    out += whole;
+    offset += whole;
+    length -= whole;
+  }
+
+  // Partial trailing block, or unencrypted bytes past the last full block
+  if (length && offset < full_end) {
+    uint8_t block[kBlockSize];
+    DecryptCbc(stream + offset, block, kBlockSize, chain);
+    memcpy(out, block, length);
+    return;
+  }
+  if (length) memcpy(out, stream + offset, length);
+}
+
+const char* Aes128::backend_name() {
+#if XE_AES_ARMV8
+  return "armv8";
+#else
+#if XE_AES_NI
+  if (HasAesNi()) return "aes-ni";
+#endif
+  return "portable";
+#endif
+}
+
+}  // namespace xe
@@ -0,0 +1,49 @@
+/**
+ * Vera360 — Xenia Edge
+ * AES-128 decryption — XEX session keys and CBC-encrypted image data
+ *
+ * Uses the ARMv8 Crypto Extensions when built with them (the Android build
+ * is), AES-NI on x86-64 hosts that report it, and a T-table implementation
+ * otherwise. All back-ends share one key schedule.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace xe {
+
+class Aes128 {
+ public:
+  static constexpr size_t kKeySize = 16;
+  static constexpr size_t kBlockSize = 16;
+
+  explicit Aes128(const uint8_t key[kKeySize]);
+
+  /// ECB-decrypt one block (in == out allowed)
+  void DecryptBlock(const uint8_t in[kBlockSize], uint8_t out[kBlockSize]) const;
+
+  /// CBC-decrypt whole blocks (length % 16 == 0, in == out allowed). iv is
+  /// advanced to the last ciphertext block so calls can be chained.
+  void DecryptCbc(const uint8_t* in, uint8_t* out, size_t length,
+                  uint8_t iv[kBlockSize]) const;
+
+  /// CBC-decrypt bytes [offset, offset + length) of a ciphertext stream
+  /// that starts with iv. CBC decryption is random access (block k needs
+  /// only ciphertext k - 1), so independent ranges can be decrypted in any
+  /// order or in parallel. A trailing partial block is not encrypted and is
+  /// copied through.
+  void DecryptCbcRange(const uint8_t* stream, size_t stream_size,
+                       size_t offset, size_t length, uint8_t* out,
+                       const uint8_t iv[kBlockSize]) const;
+
+  /// "armv8", "aes-ni" or "portable"
+  static const char* backend_name();
+
+ private:
+  // Equivalent inverse cipher round keys: ek[10], IMC(ek[9..1]), ek[0]
+  alignas(16) uint8_t dec_keys_[11 * kBlockSize];
+  uint32_t dec_words_[11 * 4];
+};
+
+}  // namespace xe
@@ -16,13 +16,16 @@ class Clock {
   static double   QueryHostSeconds();
   static uint64_t QueryHostUptimeMillis();
 
-  // Guest clock (Xbox 360 timebase)
+  // Guest clock (Xbox 360 timebase). Hot paths read
+  // timebase::QueryGuestTicks() directly: it inlines.
   static void     SetGuestTimeScalar(double scalar);
   static double   GetGuestTimeScalar();
   static uint64_t QueryGuestTickCount();
   static uint64_t QueryGuestTickFrequency();
   static void     PauseGuest();
   static void     ResumeGuest();
+  /// Continue guest time from ticks (save-state restore)
+  static void     SetGuestTickCount(uint64_t ticks);
 };
 
 }  // namespace xe
@@ -1,9 +1,10 @@
 /**
  * Vera360 — Xenia Edge
- * High-resolution clock (POSIX clock_gettime)
+ * High-resolution clock (POSIX clock_gettime; guest time in timebase.h)
  */
 
 #include "xenia/base/clock.h"
+#include "xenia/base/timebase.h"
 
 #include <time.h>
 
@@ -28,46 +29,34 @@ uint64_t Clock::QueryHostUptimeMillis() {
   return QueryHostTickCount() / 1000000ULL;
 }
 
-// ── Guest clock (Xbox 360 timebase: ~49.875 MHz) ───────────────────────────
-
-namespace {
-constexpr uint64_t kGuestTickRate = 49875000ULL;  // Xbox 360 CPU timebase
-uint64_t g_guest_tick_offset = 0;
-double g_guest_time_scalar = 1.0;
-bool g_guest_paused = false;
-uint64_t g_guest_pause_tick = 0;
-}
+// ── Guest clock (Xbox 360 timebase: 49.875 MHz) ────────────────────────────
 
 void Clock::SetGuestTimeScalar(double scalar) {
-  g_guest_time_scalar = scalar;
+  timebase::SetScalar(scalar);
 }
 
 double Clock::GetGuestTimeScalar() {
-  return g_guest_time_scalar;
+  return timebase::GetScalar();
 }
 
 uint64_t Clock::QueryGuestTickCount() {
-  if (g_guest_paused) return g_guest_pause_tick;
-  uint64_t host_ns = QueryHostTickCount();
-  double guest_ticks = static_cast<double>(host_ns) *
-                       (static_cast<double>(kGuestTickRate) / 1e9) *
-                       g_guest_time_scalar;
-  return static_cast<uint64_t>(guest_ticks) + g_guest_tick_offset;
+  return timebase::QueryGuestTicks();
 }
 
 uint64_t Clock::QueryGuestTickFrequency() {
-  return kGuestTickRate;
+  return timebase::kGuestTickRate;
 }
 
 void Clock::PauseGuest() {
-  if (!g_guest_paused) {
-    g_guest_pause_tick = QueryGuestTickCount();
-    g_guest_paused = true;
-  }
+  timebase::Pause();
 }
 
 void Clock::ResumeGuest() {
-  g_guest_paused = false;
+  timebase::Resume();
+}
+
+void Clock::SetGuestTickCount(uint64_t ticks) {
+  timebase::SetTicks(ticks);
 }
 
 }  // namespace xe
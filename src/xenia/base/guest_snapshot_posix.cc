@@ -0,0 +1,351 @@
+/**
+ * Vera360 — Xenia Edge
+ * Guest memory snapshots (POSIX: mprotect write tracking + SIGSEGV)
+ */
+
+#include "xenia/base/memory/guest_snapshot.h"
+#include "xenia/base/logging.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <sched.h>
+#include <sys/mman.h>
+
+namespace xe::memory {
+
+namespace {
+
+/// Set while a snapshot or restore owns the access hook
+std::atomic<bool> g_engine_active{false};
+
+// Snapshot block states
+constexpr uint8_t kPending = 0;    // Write-protected, not read yet
+constexpr uint8_t kCopying = 1;    // Being copied (by a reader or a fault)
+constexpr uint8_t kPreserved = 2;  // Copied to the side pool, guest released
+constexpr uint8_t kReleased = 3;   // Read, guest released
+
+// Restore block states
+constexpr uint8_t kMissing = 0;    // Committed but not populated
+constexpr uint8_t kFilling = 1;
+constexpr uint8_t kResident = 2;
+constexpr uint8_t kWanted = 3;     // Missing, and a faulting thread waits
+
+bool IsWritable(PageAccess access) {
+  return access == PageAccess::kReadWrite ||
+         access == PageAccess::kExecuteReadWrite;
+}
+
+/// Write-protected equivalent of a writable access
+PageAccess ReadOnlyAccess(PageAccess access) {
+  return access == PageAccess::kExecuteReadWrite ? PageAccess::kExecuteRead
+                                                 : PageAccess::kReadOnly;
+}
+
+/// Index of the first block ending after address
+size_t FirstBlockEndingAfter(const std::vector<SnapshotBlock>& blocks,
+                             uint64_t address) {
+  auto it = std::upper_bound(
+      blocks.begin(), blocks.end(), address,
+      [](uint64_t a, const SnapshotBlock& b) { return a < b.address; });
+  size_t index = static_cast<size_t>(it - blocks.begin());
+  if (index > 0 &&
+      uint64_t(blocks[index - 1].address) + blocks[index - 1].size > address) {
+    --index;
+  }
+  return index;
+}
+
+/// Wait out another thread's copy of a block
+uint8_t WaitWhile(const std::atomic<uint8_t>& state, uint8_t busy) {
+  uint8_t s;
+  while ((s = state.load(std::memory_order_acquire)) == busy) {
+    sched_yield();
+  }
+  return s;
+}
+
+}  // namespace
+
+// ── GuestSnapshot ───────────────────────────────────────────────────────────
+
+std::unique_ptr<GuestSnapshot> GuestSnapshot::Capture(uint32_t block_size) {
+  size_t page = GetHostPageSize();
+  if (!block_size || block_size % page) return nullptr;
+  bool expected = false;
+  if (!g_engine_active.compare_exchange_strong(expected, true)) {
+    XELOGW("GuestSnapshot: a snapshot or restore is already active");
+    return nullptr;
+  }
+
+  std::unique_ptr<GuestSnapshot> snapshot(new GuestSnapshot());
+  std::vector<SnapshotBlock> writable_runs;
+  ForEachCommittedRange([&](uint32_t address, uint32_t size,
+                            PageAccess access) {
+    if (IsWritable(access)) writable_runs.push_back({address, size, access});
+    uint64_t end = uint64_t(address) + size;
+    uint64_t cursor = address;
+    while (cursor < end) {
+      // Cut at block_size-aligned boundaries so blocks line up run to run
+      uint64_t next = std::min(end, (cursor / block_size + 1) * block_size);
+      snapshot->blocks_.push_back({static_cast<uint32_t>(cursor),
+                                   static_cast<uint32_t>(next - cursor),
+                                   access});
+      cursor = next;
+    }
+    snapshot->total_bytes_ += size;
+  });
+
+  size_t count = snapshot->blocks_.size();
+  snapshot->states_ = std::make_unique<std::atomic<uint8_t>[]>(count);
+  snapshot->pool_offsets_.resize(count);
+  for (size_t i = 0; i < count; ++i) {
+    snapshot->states_[i].store(kPending, std::memory_order_relaxed);
+    snapshot->pool_offsets_[i] = snapshot->pool_size_;
+    snapshot->pool_size_ += (snapshot->blocks_[i].size + page - 1) & ~(page - 1);
+  }
+
+  // Side pool for blocks the guest writes to before they are read; only
+  // the slots actually used are ever backed by memory
+  if (snapshot->pool_size_) {
+    void* pool = mmap(nullptr, snapshot->pool_size_, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (pool == MAP_FAILED) {
+      XELOGE("GuestSnapshot: cannot reserve 0x{:X} byte pool: {}",
+             snapshot->pool_size_, strerror(errno));
+      g_engine_active.store(false, std::memory_order_release);
+      return nullptr;
+    }
+    snapshot->pool_ = static_cast<uint8_t*>(pool);
+  }
+
+  SetAccessHook(&GuestSnapshot::AccessHook, snapshot.get());
+  for (const auto& run : writable_runs) {
+    ApplyProtection(run.address, run.size, ReadOnlyAccess(run.access));
+  }
+  return snapshot;
+}
+
+GuestSnapshot::~GuestSnapshot() {
+  // Hand unread blocks back before dropping the hook, so no write can
+  // fault with nobody to release it
+  for (size_t i = 0; i < blocks_.size(); ++i) {
+    uint8_t expected = kPending;
+    if (states_[i].compare_exchange_strong(expected, kCopying,
+                                           std::memory_order_acq_rel)) {
+      ApplyProtection(blocks_[i].address, blocks_[i].size, blocks_[i].access);
+      states_[i].store(kReleased, std::memory_order_release);
+    } else {
+      WaitWhile(states_[i], kCopying);
+    }
+  }
+  SetAccessHook(nullptr, nullptr);
+  if (pool_) munmap(pool_, pool_size_);
+  g_engine_active.store(false, std::memory_order_release);
+}
+
+void GuestSnapshot::Preserve(size_t index) {
+  const auto& block = blocks_[index];
+  uint8_t* live = GetGuestBase() + block.address;
+  if (block.access == PageAccess::kNoAccess) {
+    ApplyProtection(block.address, block.size, PageAccess::kReadOnly);
+  }
+  memcpy(pool_ + pool_offsets_[index], live, block.size);
+  ApplyProtection(block.address, block.size, block.access);
+  preserved_.fetch_add(1, std::memory_order_relaxed);
+  states_[index].store(kPreserved, std::memory_order_release);
+}
+
+bool GuestSnapshot::AccessHook(void* context, uint32_t address,
+                               uint32_t size, bool from_fault,
+                               bool is_write) {
+  (void)is_write;  // Only writes fault on write-protected pages
+  auto* self = static_cast<GuestSnapshot*>(context);
+  const auto& blocks = self->blocks_;
+  uint64_t end = uint64_t(address) + size;
+  bool handled = false;
+  for (size_t i = FirstBlockEndingAfter(blocks, address);
+       i < blocks.size() && blocks[i].address < end; ++i) {
+    // A fault on a block that was never write-protected is the guest's own
+    if (from_fault && !IsWritable(blocks[i].access)) return false;
+    uint8_t expected = kPending;
+    if (self->states_[i].compare_exchange_strong(expected, kCopying,
+                                                 std::memory_order_acq_rel)) {
+      self->Preserve(i);
+    } else {
+      WaitWhile(self->states_[i], kCopying);
+    }
+    handled = true;
+  }
+  return handled || !from_fault;
+}
+
+void GuestSnapshot::ReadBlock(size_t index, uint8_t* out) {
+  const auto& block = blocks_[index];
+  uint8_t expected = kPending;
+  if (states_[index].compare_exchange_strong(expected, kCopying,
+                                             std::memory_order_acq_rel)) {
+    if (block.access == PageAccess::kNoAccess) {
+      ApplyProtection(block.address, block.size, PageAccess::kReadOnly);
+    }
+    memcpy(out, GetGuestBase() + block.address, block.size);
+    ApplyProtection(block.address, block.size, block.access);
+    states_[index].store(kReleased, std::memory_order_release);
+    return;
+  }
+  if (WaitWhile(states_[index], kCopying) == kPreserved) {
+    uint8_t* slot = pool_ + pool_offsets_[index];
+    memcpy(out, slot, block.size);
+    // Slots are page aligned; give the copy back to the kernel
+    size_t page = GetHostPageSize();
+    madvise(slot, (block.size + page - 1) & ~(page - 1), MADV_DONTNEED);
+  }
+}
+
+// ── GuestRestore ────────────────────────────────────────────────────────────
+
+std::unique_ptr<GuestRestore> GuestRestore::Begin(
+    std::vector<SnapshotBlock> blocks, FillFn fill) {
+  size_t page = GetHostPageSize();
+  uint64_t previous_end = 0;
+  for (const auto& block : blocks) {
+    uint64_t end = uint64_t(block.address) + block.size;
+    if (!block.size || block.address % page || block.size % page ||
+        block.address < previous_end || end > (1ULL << 32)) {
+      XELOGE("GuestRestore: bad block 0x{:08X}+0x{:X}", block.address,
+             block.size);
+      return nullptr;
+    }
+    previous_end = end;
+  }
+  bool expected = false;
+  if (!g_engine_active.compare_exchange_strong(expected, true)) {
+    XELOGW("GuestRestore: a snapshot or restore is already active");
+    return nullptr;
+  }
+  if (!ResetGuestSpace()) {
+    g_engine_active.store(false, std::memory_order_release);
+    return nullptr;
+  }
+
+  std::unique_ptr<GuestRestore> restore(new GuestRestore());
+  restore->blocks_ = std::move(blocks);
+  restore->fill_ = std::move(fill);
+  size_t count = restore->blocks_.size();
+  restore->states_ = std::make_unique<std::atomic<uint8_t>[]>(count);
+  for (size_t i = 0; i < count; ++i) {
+    const auto& block = restore->blocks_[i];
+    restore->states_[i].store(kMissing, std::memory_order_relaxed);
+    CommitDeferred(GetGuestBase() + block.address, block.size, block.access);
+  }
+  restore->remaining_.store(count, std::memory_order_release);
+  SetAccessHook(&GuestRestore::AccessHook, restore.get());
+  auto* self = restore.get();
+  restore->fill_thread_ = threading::Thread::Create(
+      [self]() { self->FillRemaining(); }, "GuestRestoreFill");
+  return restore;
+}
+
+GuestRestore::~GuestRestore() {
+  if (fill_thread_) fill_thread_->Join();
+  // Not expected: only if the thread could not be created
+  FillRemaining();
+  SetAccessHook(nullptr, nullptr);
+  g_engine_active.store(false, std::memory_order_release);
+}
+
+void GuestRestore::Fill(size_t index) {
+  const auto& block = blocks_[index];
+  // Populate a private buffer and move it into place in one step, so the
+  // guest never sees (or writes into) a half-filled block
+  void* staging = mmap(nullptr, block.size, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  bool ok = staging != MAP_FAILED &&
+            fill_(index, static_cast<uint8_t*>(staging)) &&
+            MoveIntoGuest(staging, block.address, block.size, block.access);
+  if (!ok) {
+    if (staging != MAP_FAILED) munmap(staging, block.size);
+    // Leave the block zeroed but usable
+    ApplyProtection(block.address, block.size, block.access);
+    failed_.store(true, std::memory_order_release);
+  }
+  states_[index].store(kResident, std::memory_order_release);
+  remaining_.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+bool GuestRestore::TryFill(size_t index) {
+  uint8_t expected = kMissing;
+  if (!states_[index].compare_exchange_strong(expected, kFilling,
+                                              std::memory_order_acq_rel)) {
+    if (expected != kWanted ||
+        !states_[index].compare_exchange_strong(expected, kFilling,
+                                                std::memory_order_acq_rel)) {
+      return false;
+    }
+    wanted_.fetch_sub(1, std::memory_order_relaxed);
+  }
+  Fill(index);
+  return true;
+}
+
+void GuestRestore::FillRemaining() {
+  for (size_t i = 0; i < blocks_.size() && !complete(); ++i) {
+    // Blocks a guest thread is stuck on go first
+    if (wanted_.load(std::memory_order_acquire)) {
+      for (size_t j = 0; j < blocks_.size(); ++j) {
+        if (states_[j].load(std::memory_order_acquire) == kWanted) TryFill(j);
+      }
+    }
+    TryFill(i);
+  }
+  // Wait for fills other threads started
+  for (size_t i = 0; i < blocks_.size(); ++i) {
+    WaitWhile(states_[i], kFilling);
+  }
+}
+
+bool GuestRestore::AccessHook(void* context, uint32_t address, uint32_t size,
+                              bool from_fault, bool is_write) {
+  auto* self = static_cast<GuestRestore*>(context);
+  const auto& blocks = self->blocks_;
+  uint64_t end = uint64_t(address) + size;
+  bool handled = false;
+  for (size_t i = FirstBlockEndingAfter(blocks, address);
+       i < blocks.size() && blocks[i].address < end; ++i) {
+    auto& state = self->states_[i];
+    if (!from_fault) {
+      // Outside the signal handler the caller can fill the block itself
+      if (self->TryFill(i)) continue;
+    } else {
+      // Inside it, only flag the block for the fill thread and wait:
+      // filling maps memory and runs the decompressor, neither of which
+      // belongs in a signal handler
+      uint8_t expected = kMissing;
+      if (state.compare_exchange_strong(expected, kWanted,
+                                        std::memory_order_acq_rel)) {
+        self->wanted_.fetch_add(1, std::memory_order_release);
+        expected = kWanted;
+      }
+      if (expected == kWanted || expected == kFilling) {
+        uint8_t s;
+        while ((s = state.load(std::memory_order_acquire)) == kWanted ||
+               s == kFilling) {
+          sched_yield();
+        }
+        handled = true;  // The fill thread got to it while we waited
+        continue;
+      }
+    }
+    if (WaitWhile(state, kFilling) == kResident && from_fault) {
+      // Already resident: retry only if the block's protection allows the
+      // access (lost a race with the filler), else it is the guest's fault
+      PageAccess access = blocks[i].access;
+      handled = access != PageAccess::kNoAccess &&
+                (!is_write || IsWritable(access));
+    }
+  }
+  return handled || !from_fault;
+}
+
+}  // namespace xe::memory
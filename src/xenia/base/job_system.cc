@@ -0,0 +1,471 @@
+/**
+ * Vera360 — Xenia Edge
+ * Work-stealing job system
+ */
+
+#include "xenia/base/job_system.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <string>
+
+#include <unistd.h>
+
+#include "xenia/base/clock.h"
+#include "xenia/base/logging.h"
+
+namespace xe::threading {
+
+struct Job {
+  JobSystem::JobFn fn;
+  const char* name;
+  JobCounter* counter;
+  JobPriority priority;
+  int32_t worker;
+  uint64_t submitted_ns;
+};
+
+namespace {
+
+// ── Chase-Lev deque ─────────────────────────────────────────────────────────
+// Lê, Pop, Cohen, Zappa Nardelli, "Correct and Efficient Work-Stealing for
+// Weak Memory Models" (PPoPP 2013). Only the owner pushes and pops; anyone
+// steals. Outgrown rings stay allocated until the deque goes, since a
+// thief may still be reading one.
+
+class WorkDeque {
+ public:
+  WorkDeque() {
+    rings_.push_back(std::make_unique<Ring>(kInitialCapacity));
+    ring_.store(rings_.back().get(), std::memory_order_relaxed);
+  }
+
+  void Push(Job* job) {
+    int64_t bottom = bottom_.load(std::memory_order_relaxed);
+    int64_t top = top_.load(std::memory_order_acquire);
+    Ring* ring = ring_.load(std::memory_order_relaxed);
+    if (bottom - top > int64_t(ring->mask)) {
+      rings_.push_back(std::make_unique<Ring>((ring->mask + 1) * 2));
+      Ring* grown = rings_.back().get();
+      for (int64_t i = top; i < bottom; ++i) grown->Put(i, ring->Get(i));
+      ring_.store(grown, std::memory_order_release);
+      ring = grown;
+    }
+    ring->Put(bottom, job);
+    bottom_.store(bottom + 1, std::memory_order_release);
+  }
+
+  Job* Pop() {
+    int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+    Ring* ring = ring_.load(std::memory_order_relaxed);
+    bottom_.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t top = top_.load(std::memory_order_relaxed);
+    if (top > bottom) {
+      bottom_.store(bottom + 1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    Job* job = ring->Get(bottom);
+    if (top == bottom) {
+      // Last one: race the thieves for it
+      if (!top_.compare_exchange_strong(top, top + 1,
+                                        std::memory_order_seq_cst,
+                                        std::memory_order_relaxed)) {
+        job = nullptr;
+      }
+      bottom_.store(bottom + 1, std::memory_order_relaxed);
+    }
+    return job;
+  }
+
+  /// nullptr when empty or when another thread won the race
+  Job* Steal() {
+    int64_t top = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t bottom = bottom_.load(std::memory_order_acquire);
+    if (top >= bottom) return nullptr;
+    Job* job = ring_.load(std::memory_order_acquire)->Get(top);
+    if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                      std::memory_order_relaxed)) {
+      return nullptr;
+    }
+    return job;
+  }
+
+ private:
+  static constexpr size_t kInitialCapacity = 256;
+
+  struct Ring {
+    explicit Ring(size_t capacity)
+        : mask(capacity - 1), slots(new std::atomic<Job*>[capacity]) {}
+    Job* Get(int64_t i) const {
+      return slots[size_t(i) & mask].load(std::memory_order_relaxed);
+    }
+    void Put(int64_t i, Job* job) {
+      slots[size_t(i) & mask].store(job, std::memory_order_relaxed);
+    }
+    size_t mask;
+    std::unique_ptr<std::atomic<Job*>[]> slots;
+  };
+
+  alignas(64) std::atomic<int64_t> top_{0};
+  alignas(64) std::atomic<int64_t> bottom_{0};
+  std::atomic<Ring*> ring_{nullptr};
+  std::vector<std::unique_ptr<Ring>> rings_;  // owner only
+};
+
+struct CurrentWorker {
+  const JobSystem* system = nullptr;
+  int32_t index = kAnyWorker;
+  uint32_t steal_seed = 0x9E3779B9u;
+};
+thread_local CurrentWorker t_current;
+
+uint32_t NextStealStart(uint32_t count) {
+  uint32_t& x = t_current.steal_seed;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  return x % count;
+}
+
+/// Online cores, fastest first (cpuinfo_max_freq; index order when the
+/// kernel does not say)
+std::vector<int32_t> CoresFastestFirst() {
+  long online = sysconf(_SC_NPROCESSORS_ONLN);
+  std::vector<std::pair<uint64_t, int32_t>> cores;
+  for (int32_t cpu = 0; cpu < std::max(1L, online) && cpu < 64; ++cpu) {
+    uint64_t khz = 0;
+    std::string path = "/sys/devices/system/cpu/cpu" + std::to_string(cpu) +
+                       "/cpufreq/cpuinfo_max_freq";
+    if (FILE* f = fopen(path.c_str(), "r")) {
+      unsigned long long value = 0;
+      if (fscanf(f, "%llu", &value) == 1) khz = value;
+      fclose(f);
+    }
+    cores.push_back({khz, cpu});
+  }
+  std::stable_sort(cores.begin(), cores.end(),
+                   [](const auto& a, const auto& b) { return a.first > b.first; });
+  std::vector<int32_t> order;
+  for (const auto& core : cores) order.push_back(core.second);
+  return order;
+}
+
+}  // namespace
+
+// ── Timing ──────────────────────────────────────────────────────────────────
+
+/// One per thread that runs jobs; only its thread writes, under its lock
+struct JobSystem::TimingTable {
+  void Record(const char* name, uint64_t run_ns, uint64_t queued_ns) {
+    LockGuard lock(mutex);
+    auto it = std::find_if(entries.begin(), entries.end(),
+                           [name](const JobTiming& t) { return t.name == name; });
+    if (it == entries.end()) {
+      entries.push_back({name});
+      it = entries.end() - 1;
+    }
+    it->count++;
+    it->run_ns += run_ns;
+    it->max_run_ns = std::max(it->max_run_ns, run_ns);
+    it->queued_ns += queued_ns;
+  }
+
+  mutable Mutex mutex;
+  std::vector<JobTiming> entries;
+};
+
+struct JobSystem::Worker {
+  WorkDeque deques[kJobPriorityCount];
+  Mutex mailbox_mutex;
+  std::deque<Job*> mailbox[kJobPriorityCount];
+  std::atomic<uint32_t> mailbox_size{0};  // lets thieves skip the lock
+  TimingTable timing;
+  std::unique_ptr<Thread> thread;
+};
+
+// ── JobSystem ───────────────────────────────────────────────────────────────
+
+JobSystem& JobSystem::Shared() {
+  static JobSystem shared;
+  static bool started = shared.Initialize();
+  (void)started;
+  return shared;
+}
+
+JobSystem::JobSystem() : external_timing_(std::make_unique<TimingTable>()) {}
+
+JobSystem::~JobSystem() { Shutdown(); }
+
+bool JobSystem::Initialize(const JobSystemOptions& options) {
+  if (!workers_.empty()) return true;
+  uint32_t count = options.worker_count;
+  if (!count) {
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    count = online > 1 ? uint32_t(online - 1) : 1;
+  }
+  std::vector<int32_t> cores;
+  if (options.pin_workers) cores = CoresFastestFirst();
+
+  exit_ = false;
+  for (uint32_t i = 0; i < count; ++i) {
+    workers_.push_back(std::make_unique<Worker>());
+  }
+  // Workers only start once the whole vector exists: they steal from it
+  for (uint32_t i = 0; i < count; ++i) {
+    int32_t core = cores.empty() ? -1 : cores[i % cores.size()];
+    workers_[i]->thread = Thread::Create(
+        [this, i, core]() { WorkerMain(i, core); }, "Job Worker");
+    if (!workers_[i]->thread) {
+      XELOGE("Jobs: cannot start worker {}", i);
+      Shutdown();
+      return false;
+    }
+  }
+  XELOGI("Jobs: {} workers{}", count, options.pin_workers ? ", pinned" : "");
+  return true;
+}
+
+void JobSystem::Shutdown() {
+  if (workers_.empty()) return;
+  {
+    LockGuard lock(sleep_mutex_);
+    exit_ = true;
+  }
+  sleep_cv_.NotifyAll();
+  for (auto& worker : workers_) {
+    if (worker->thread) worker->thread->Join();
+  }
+  workers_.clear();
+}
+
+int32_t JobSystem::current_worker() const {
+  return t_current.system == this ? t_current.index : kAnyWorker;
+}
+
+void JobSystem::Submit(JobFn fn, const JobOptions& options) {
+  auto* job = new Job{std::move(fn), options.name, options.counter,
+                      options.priority, options.worker,
+                      Clock::QueryHostTickCount()};
+  if (JobCounter* counter = job->counter) {
+    counter->pending_.fetch_add(1, std::memory_order_acq_rel);
+    uint8_t lowest = counter->lowest_priority_.load(std::memory_order_relaxed);
+    while (lowest < uint8_t(job->priority) &&
+           !counter->lowest_priority_.compare_exchange_weak(
+               lowest, uint8_t(job->priority), std::memory_order_relaxed)) {
+    }
+  }
+  if (JobCounter* after = options.after) {
+    LockGuard lock(after->mutex_);
+    if (after->pending_.load(std::memory_order_acquire)) {
+      after->waiting_.push_back(job);
+      return;
+    }
+  }
+  Enqueue(job);
+}
+
+void JobSystem::Enqueue(Job* job) {
+  uint32_t count = worker_count();
+  if (!count) {
+    // Not started, or shut down: run it here rather than lose it
+    Run(job, *external_timing_);
+    return;
+  }
+  int32_t self = current_worker();
+  size_t priority = size_t(job->priority);
+  if (job->worker == kAnyWorker && self != kAnyWorker) {
+    workers_[self]->deques[priority].Push(job);
+  } else {
+    uint32_t target = job->worker >= 0
+                          ? uint32_t(job->worker) % count
+                          : next_mailbox_.fetch_add(1, std::memory_order_relaxed) %
+                                count;
+    Worker& worker = *workers_[target];
+    LockGuard lock(worker.mailbox_mutex);
+    worker.mailbox[priority].push_back(job);
+    worker.mailbox_size.fetch_add(1, std::memory_order_release);
+  }
+  WakeWorker();
+}
+
+void JobSystem::WakeWorker() {
+  // Pairs with the sleeper's increment-then-check in WorkerMain
+  work_epoch_.fetch_add(1, std::memory_order_seq_cst);
+  if (sleepers_.load(std::memory_order_seq_cst)) {
+    LockGuard lock(sleep_mutex_);
+    sleep_cv_.NotifyOne();
+  }
+}
+
+Job* JobSystem::FindJob(int32_t self, JobPriority lowest) {
+  uint32_t count = worker_count();
+  auto take_mail = [](Worker& worker, size_t priority) -> Job* {
+    if (!worker.mailbox_size.load(std::memory_order_acquire)) return nullptr;
+    LockGuard lock(worker.mailbox_mutex);
+    auto& queue = worker.mailbox[priority];
+    if (queue.empty()) return nullptr;
+    Job* job = queue.front();
+    queue.pop_front();
+    worker.mailbox_size.fetch_sub(1, std::memory_order_relaxed);
+    return job;
+  };
+  uint32_t start = NextStealStart(count);
+  for (size_t priority = 0; priority <= size_t(lowest); ++priority) {
+    if (self != kAnyWorker) {
+      Worker& own = *workers_[self];
+      if (Job* job = own.deques[priority].Pop()) return job;
+      if (Job* job = take_mail(own, priority)) return job;
+    }
+    for (uint32_t k = 0; k < count; ++k) {
+      uint32_t victim = (start + k) % count;
+      if (int32_t(victim) == self) continue;
+      Worker& other = *workers_[victim];
+      if (Job* job = other.deques[priority].Steal()) return job;
+      if (Job* job = take_mail(other, priority)) return job;
+    }
+  }
+  return nullptr;
+}
+
+void JobSystem::Run(Job* job, TimingTable& timing) {
+  uint64_t start = Clock::QueryHostTickCount();
+  job->fn();
+  uint64_t end = Clock::QueryHostTickCount();
+  timing.Record(job->name, end - start, start - job->submitted_ns);
+  JobCounter* counter = job->counter;
+  delete job;
+  if (counter) Release(*counter);
+}
+
+void JobSystem::Release(JobCounter& counter) {
+  // Only the last decrement takes the lock; once it is dropped nothing
+  // here touches the counter, which the waiter may then destroy
+  uint32_t pending = counter.pending_.load(std::memory_order_acquire);
+  while (pending > 1) {
+    if (counter.pending_.compare_exchange_weak(pending, pending - 1,
+                                               std::memory_order_acq_rel)) {
+      return;
+    }
+  }
+  std::vector<Job*> ready;
+  {
+    LockGuard lock(counter.mutex_);
+    if (counter.pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      ready.swap(counter.waiting_);
+    }
+  }
+  for (Job* job : ready) Enqueue(job);
+  if (blocked_waiters_.load(std::memory_order_seq_cst)) {
+    LockGuard lock(done_mutex_);
+    done_cv_.NotifyAll();
+  }
+}
+
+void JobSystem::Wait(JobCounter& counter) {
+  int32_t self = current_worker();
+  TimingTable& timing =
+      self != kAnyWorker ? workers_[self]->timing : *external_timing_;
+  auto lowest = JobPriority(
+      counter.lowest_priority_.load(std::memory_order_relaxed));
+  while (!counter.done()) {
+    if (Job* job = workers_.empty() ? nullptr : FindJob(self, lowest)) {
+      Run(job, timing);
+      continue;
+    }
+    // Nothing to help with: the last jobs are running elsewhere. The
+    // timeout covers work queued meanwhile, which this thread could run.
+    LockGuard lock(done_mutex_);
+    blocked_waiters_.fetch_add(1, std::memory_order_seq_cst);
+    if (!counter.done()) done_cv_.WaitFor(done_mutex_, 1);
+    blocked_waiters_.fetch_sub(1, std::memory_order_relaxed);
+  }
+  // The last Release may still hold the counter's lock
+  LockGuard lock(counter.mutex_);
+}
+
+void JobSystem::ParallelFor(uint32_t count,
+                            const std::function<void(uint32_t)>& fn,
+                            const JobOptions& options) {
+  if (!count) return;
+  std::atomic<uint32_t> next{0};
+  auto drain = [&]() {
+    for (uint32_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < count;) {
+      fn(i);
+    }
+  };
+  JobCounter counter;
+  JobOptions helper = options;
+  helper.counter = &counter;
+  uint32_t helpers = std::min(count - 1, worker_count());
+  for (uint32_t i = 0; i < helpers; ++i) Submit(drain, helper);
+  drain();
+  Wait(counter);
+}
+
+void JobSystem::WorkerMain(uint32_t index, int32_t core) {
+  t_current.system = this;
+  t_current.index = int32_t(index);
+  t_current.steal_seed = 0x9E3779B9u * (index + 1);
+  if (core >= 0 && !SetThreadAffinity(1ull << core)) {
+    XELOGW("Jobs: cannot pin worker {} to core {}", index, core);
+  }
+  Worker& self = *workers_[index];
+  while (true) {
+    uint64_t epoch = work_epoch_.load(std::memory_order_seq_cst);
+    if (Job* job = FindJob(int32_t(index))) {
+      Run(job, self.timing);
+      continue;
+    }
+    // Queues are drained before exiting, so Shutdown loses nothing
+    LockGuard lock(sleep_mutex_);
+    if (exit_) break;
+    sleepers_.fetch_add(1, std::memory_order_seq_cst);
+    if (work_epoch_.load(std::memory_order_seq_cst) == epoch) {
+      sleep_cv_.Wait(sleep_mutex_);
+    }
+    sleepers_.fetch_sub(1, std::memory_order_relaxed);
+  }
+}
+
+std::vector<JobTiming> JobSystem::timings() const {
+  std::vector<JobTiming> merged;
+  auto merge = [&merged](const TimingTable& table) {
+    LockGuard lock(table.mutex);
+    for (const JobTiming& entry : table.entries) {
+      auto it = std::find_if(merged.begin(), merged.end(),
+                             [&entry](const JobTiming& t) {
+                               return strcmp(t.name, entry.name) == 0;
+                             });
+      if (it == merged.end()) {
+        merged.push_back(entry);
+        continue;
+      }
+      it->count += entry.count;
+      it->run_ns += entry.run_ns;
+      it->max_run_ns = std::max(it->max_run_ns, entry.max_run_ns);
+      it->queued_ns += entry.queued_ns;
+    }
+  };
+  for (const auto& worker : workers_) merge(worker->timing);
+  merge(*external_timing_);
+  std::sort(merged.begin(), merged.end(),
+            [](const JobTiming& a, const JobTiming& b) {
+              return a.run_ns > b.run_ns;
+            });
+  return merged;
+}
+
+void JobSystem::ResetTimings() {
+  auto reset = [](TimingTable& table) {
+    LockGuard lock(table.mutex);
+    table.entries.clear();
+  };
+  for (auto& worker : workers_) reset(worker->timing);
+  reset(*external_timing_);
+}
+
+}  // namespace xe::threading
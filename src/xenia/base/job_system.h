@@ -0,0 +1,165 @@
+/**
+ * Vera360 — Xenia Edge
+ * Work-stealing job system — one shared pool for every parallel subsystem
+ *
+ * Each worker owns a Chase-Lev deque per priority class: it pushes and pops
+ * its own jobs at the bottom (newest first, still in cache) while idle
+ * threads steal from the top (oldest first, usually the biggest piece of a
+ * split). Jobs submitted from outside the pool, or with a worker hint, go
+ * to a worker's mailbox, which anyone may also take from. Wherever a thread
+ * looks for work it takes critical jobs before normal ones and normal
+ * before background.
+ *
+ * Completion is tracked with JobCounters: a job submitted against a counter
+ * holds it up until it returns, and a job may name a counter it has to wait
+ * for, in which case it is not queued until that counter is done. Wait()
+ * never just blocks: the waiting thread runs queued jobs until its counter
+ * is done, so fork-join inside a job cannot starve the pool. It only picks
+ * jobs as urgent as the least urgent one submitted against the counter, so
+ * waiting on critical work never runs a long background job first.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "xenia/base/threading.h"
+
+namespace xe::threading {
+
+enum class JobPriority : uint8_t {
+  kCritical = 0,  // on the frame's critical path: JIT, texture conversion
+  kNormal,
+  kBackground,    // can finish late: save-state compression, cache fill
+};
+constexpr size_t kJobPriorityCount = 3;
+
+/// JobOptions::worker: no preference
+constexpr int32_t kAnyWorker = -1;
+
+struct Job;  // job_system.cc
+
+/// Completion count of a group of jobs. Must outlive the jobs submitted
+/// against it (Wait on it before it goes out of scope).
+class JobCounter {
+ public:
+  JobCounter() = default;
+  JobCounter(const JobCounter&) = delete;
+  JobCounter& operator=(const JobCounter&) = delete;
+
+  /// Jobs submitted against the counter that have not returned yet
+  uint32_t pending() const { return pending_.load(std::memory_order_acquire); }
+  bool done() const { return pending() == 0; }
+
+ private:
+  friend class JobSystem;
+  std::atomic<uint32_t> pending_{0};
+  /// Least urgent JobPriority submitted against the counter; bounds what
+  /// Wait() helps with
+  std::atomic<uint8_t> lowest_priority_{0};
+  Mutex mutex_;                // last decrement, waiting_
+  std::vector<Job*> waiting_;  // queued once pending_ reaches 0
+};
+
+struct JobOptions {
+  /// Static string; timings are keyed by it
+  const char* name = "job";
+  JobPriority priority = JobPriority::kNormal;
+  /// Incremented at submit, decremented when the job returns
+  JobCounter* counter = nullptr;
+  /// Dependency: the job is not queued before this counter is done
+  JobCounter* after = nullptr;
+  /// Affinity hint: the worker whose mailbox gets the job. Others still
+  /// take it when that worker is busy.
+  int32_t worker = kAnyWorker;
+};
+
+struct JobSystemOptions {
+  /// 0: one per online core but one, at least one
+  uint32_t worker_count = 0;
+  /// Bind worker i to the i-th fastest core (big cores first on
+  /// big.LITTLE), so low worker hints mean fast cores
+  bool pin_workers = false;
+};
+
+/// Per job name, since Initialize or the last ResetTimings
+struct JobTiming {
+  const char* name = nullptr;
+  uint64_t count = 0;
+  uint64_t run_ns = 0;      // total running
+  uint64_t max_run_ns = 0;
+  uint64_t queued_ns = 0;   // total between submit and start
+};
+
+class JobSystem {
+ public:
+  using JobFn = std::function<void()>;
+
+  /// The process-wide pool, started on first use with default options
+  static JobSystem& Shared();
+
+  JobSystem();
+  ~JobSystem();
+
+  bool Initialize(const JobSystemOptions& options = {});
+  /// Runs what is still queued, then joins the workers
+  void Shutdown();
+
+  void Submit(JobFn fn, const JobOptions& options = {});
+
+  /// Runs queued jobs, no less urgent than those submitted against the
+  /// counter, on the calling thread until the counter is done
+  void Wait(JobCounter& counter);
+
+  /// fn(0) … fn(count - 1) across the pool and the calling thread, which
+  /// returns when all are done. Indices are claimed one at a time, so
+  /// uneven items balance out. options.counter is ignored.
+  void ParallelFor(uint32_t count, const std::function<void(uint32_t)>& fn,
+                   const JobOptions& options = {});
+
+  uint32_t worker_count() const {
+    return static_cast<uint32_t>(workers_.size());
+  }
+  /// Index of the calling thread in this pool, kAnyWorker outside it
+  int32_t current_worker() const;
+
+  std::vector<JobTiming> timings() const;
+  void ResetTimings();
+
+  JobSystem(const JobSystem&) = delete;
+  JobSystem& operator=(const JobSystem&) = delete;
+
+ private:
+  struct Worker;
+  struct TimingTable;
+
+  void WorkerMain(uint32_t index, int32_t core);
+  /// Queues a job whose dependency is done
+  void Enqueue(Job* job);
+  /// Next job of priority lowest or more urgent
+  Job* FindJob(int32_t self, JobPriority lowest = JobPriority::kBackground);
+  void Run(Job* job, TimingTable& timing);
+  void Release(JobCounter& counter);
+  void WakeWorker();
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::unique_ptr<TimingTable> external_timing_;  // jobs run by Wait callers
+  std::atomic<uint32_t> next_mailbox_{0};
+  std::atomic<bool> exit_{false};
+
+  // Idle workers sleep here; work_epoch_ moves on every enqueue
+  std::atomic<uint64_t> work_epoch_{0};
+  std::atomic<uint32_t> sleepers_{0};
+  Mutex sleep_mutex_;
+  ConditionVariable sleep_cv_;
+
+  // Wait() callers with nothing to run sleep here
+  std::atomic<uint32_t> blocked_waiters_{0};
+  Mutex done_mutex_;
+  ConditionVariable done_cv_;
+};
+
+}  // namespace xe::threading
@@ -11,6 +11,7 @@
 #include <cstdio>
 #include <cstring>
 #include <string>
+#include <string_view>
 #include <sstream>
 #include <type_traits>
 
@@ -152,6 +153,10 @@ inline void AppendArg(std::string& out, const char*, const char*, const std::str
   out += val;
 }
 
+inline void AppendArg(std::string& out, const char*, const char*, std::string_view val) {
+  out += val;
+}
+
 inline void AppendArg(std::string& out, const char*, const char*, bool val) {
   out += val ? "true" : "false";
 }
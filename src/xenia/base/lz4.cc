@@ -0,0 +1,180 @@
+/**
+ * Vera360 — Xenia Edge
+ * LZ4 block codec
+ */
+
+#include "xenia/base/lz4.h"
+
+#include <cstring>
+
+namespace xe::lz4 {
+
+namespace {
+
+constexpr size_t kMinMatch = 4;
+constexpr size_t kLastLiterals = 5;   // Spec: last 5 bytes are literals
+constexpr size_t kMatchFindLimit = 12;  // Spec: no match starts in last 12
+constexpr size_t kMaxOffset = 65535;
+constexpr int kHashLog = 12;
+
+inline uint32_t Read32(const uint8_t* p) {
+  uint32_t v;
+  memcpy(&v, p, 4);
+  return v;
+}
+
+inline uint32_t Hash(uint32_t sequence) {
+  return (sequence * 2654435761u) >> (32 - kHashLog);
+}
+
+/// Append a length extension (runs of 255 terminated by a smaller byte)
+inline uint8_t* WriteLength(uint8_t* op, size_t length) {
+  while (length >= 255) {
+    *op++ = 255;
+    length -= 255;
+  }
+  *op++ = static_cast<uint8_t>(length);
+  return op;
+}
+
+inline size_t SequenceBound(size_t literals, size_t match) {
+  return 1 + literals / 255 + 1 + literals + 2 + match / 255 + 1;
+}
+
+}  // namespace
+
+size_t Compress(const uint8_t* src, size_t src_size, uint8_t* dst,
+                size_t dst_capacity) {
+  uint8_t* op = dst;
+  uint8_t* const op_end = dst + dst_capacity;
+  size_t anchor = 0;
+
+  if (src_size > kMatchFindLimit) {
+    uint32_t table[1 << kHashLog] = {};
+    const size_t match_limit = src_size - kMatchFindLimit;
+    const size_t extend_limit = src_size - kLastLiterals;
+    size_t ip = 1;
+    table[Hash(Read32(src))] = 0;
+
+    while (ip < match_limit) {
+      uint32_t sequence = Read32(src + ip);
+      uint32_t h = Hash(sequence);
+      size_t ref = table[h];
+      table[h] = static_cast<uint32_t>(ip);
+
+      if (ref >= ip || ip - ref > kMaxOffset || Read32(src + ref) != sequence) {
+        // Skip faster through incompressible data
+        ip += 1 + ((ip - anchor) >> 6);
+        continue;
+      }
+
+      // Extend backwards over pending literals, then forwards
+      while (ip > anchor && ref > 0 && src[ip - 1] == src[ref - 1]) {
+        --ip;
+        --ref;
+      }
+      size_t match_len = kMinMatch;
+      while (ip + match_len < extend_limit &&
+             src[ref + match_len] == src[ip + match_len]) {
+        ++match_len;
+      }
+
+      size_t literals = ip - anchor;
+      if (op + SequenceBound(literals, match_len) > op_end) return 0;
+
+      uint8_t* token = op++;
+      size_t ml = match_len - kMinMatch;
+      *token = static_cast<uint8_t>(((literals >= 15 ? 15 : literals) << 4) |
+                                    (ml >= 15 ? 15 : ml));
+      if (literals >= 15) op = WriteLength(op, literals - 15);
+      memcpy(op, src + anchor, literals);
+      op += literals;
+      size_t offset = ip - ref;
+      *op++ = static_cast<uint8_t>(offset);
+      *op++ = static_cast<uint8_t>(offset >> 8);
+      if (ml >= 15) op = WriteLength(op, ml - 15);
+
+      ip += match_len;
+      anchor = ip;
+      if (ip < match_limit) {
+        table[Hash(Read32(src + ip - 2))] = static_cast<uint32_t>(ip - 2);
+      }
+    }
+  }
+
+  // Trailing literals
+  size_t literals = src_size - anchor;
+  if (op + 1 + literals / 255 + 1 + literals > op_end) return 0;
+  *op++ = static_cast<uint8_t>((literals >= 15 ? 15 : literals) << 4);
+  if (literals >= 15) op = WriteLength(op, literals - 15);
+  memcpy(op, src + anchor, literals);
+  op += literals;
+  return static_cast<size_t>(op - dst);
+}
+
+bool Decompress(const uint8_t* src, size_t src_size, uint8_t* dst,
+                size_t dst_size) {
+  const uint8_t* ip = src;
+  const uint8_t* const ip_end = src + src_size;
+  uint8_t* op = dst;
+  uint8_t* const op_end = dst + dst_size;
+
+  while (ip < ip_end) {
+    uint8_t token = *ip++;
+
+    size_t literals = token >> 4;
+    if (literals == 15) {
+      uint8_t b;
+      do {
+        if (ip >= ip_end) return false;
+        b = *ip++;
+        literals += b;
+      } while (b == 255);
+    }
+    if (literals > size_t(ip_end - ip) || literals > size_t(op_end - op)) {
+      return false;
+    }
+    memcpy(op, ip, literals);
+    ip += literals;
+    op += literals;
+
+    if (ip == ip_end) break;  // Final sequence has no match
+
+    if (ip_end - ip < 2) return false;
+    size_t offset = size_t(ip[0]) | (size_t(ip[1]) << 8);
+    ip += 2;
+    if (offset == 0 || offset > size_t(op - dst)) return false;
+
+    size_t match_len = token & 15;
+    if (match_len == 15) {
+      uint8_t b;
+      do {
+        if (ip >= ip_end) return false;
+        b = *ip++;
+        match_len += b;
+      } while (b == 255);
+    }
+    match_len += kMinMatch;
+    if (match_len > size_t(op_end - op)) return false;
+
+    const uint8_t* match = op - offset;
+    if (offset >= match_len) {
+      memcpy(op, match, match_len);
+    } else {
+      // Overlapping copy: lay down one period, then double it
+      memcpy(op, match, offset);
+      size_t copied = offset;
+      while (copied < match_len) {
+        size_t chunk = copied < match_len - copied ? copied
+                                                   : match_len - copied;
+        memcpy(op + copied, op, chunk);
+        copied += chunk;
+      }
+    }
+    op += match_len;
+  }
+
+  return op == op_end;
+}
+
+}  // namespace xe::lz4
@@ -0,0 +1,31 @@
+/**
+ * Vera360 — Xenia Edge
+ * LZ4 block codec (in-tree, no external dependency)
+ *
+ * Implements the standard LZ4 block format: sequences of
+ *   token(lit_len:4 | match_len-4:4), [lit_len ext], literals,
+ *   offset(LE16), [match_len ext]
+ * with the last 5 bytes always literals. Streams produced here decode with
+ * any conforming LZ4 decoder and vice versa.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace xe::lz4 {
+
+/// Worst-case compressed size for an input of n bytes
+constexpr size_t CompressBound(size_t n) { return n + n / 255 + 16; }
+
+/// Compress src into dst. Returns the compressed size, or 0 if the output
+/// does not fit in dst_capacity (callers then store the data raw).
+size_t Compress(const uint8_t* src, size_t src_size, uint8_t* dst,
+                size_t dst_capacity);
+
+/// Decompress a block that must expand to exactly dst_size bytes.
+/// Rejects malformed input without reading or writing out of bounds.
+bool Decompress(const uint8_t* src, size_t src_size, uint8_t* dst,
+                size_t dst_size);
+
+}  // namespace xe::lz4
@@ -0,0 +1,55 @@
+/**
+ * Vera360 — Xenia Edge
+ * Read-only memory-mapped files
+ *
+ * Large images (ISO, STFS, XEX) are mapped once and read with memcpy (or
+ * handed out as pointers) instead of seek/read syscalls per request. The
+ * kernel's page cache does the buffering; Advise() steers its read-ahead.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace xe {
+
+class MappedFile {
+ public:
+  enum class AccessHint {
+    kNormal,
+    kSequential,   // Aggressive read-ahead, pages dropped behind
+    kRandom,       // No read-ahead
+    kWillNeed,     // Start fetching the range now
+    kDontNeed,     // Range can be dropped from the page cache
+  };
+
+  /// Map an entire file read-only. Returns nullptr on failure.
+  static std::unique_ptr<MappedFile> Open(const std::string& path);
+
+  ~MappedFile();
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  const uint8_t* data() const { return data_; }
+  uint64_t size() const { return size_; }
+  /// Underlying descriptor (kept open for remapping file pages elsewhere)
+  int fd() const { return fd_; }
+  const std::string& path() const { return path_; }
+
+  /// Page-cache hint for a byte range (rounded out to whole pages)
+  void Advise(uint64_t offset, uint64_t length, AccessHint hint) const;
+
+ private:
+  MappedFile(std::string path, int fd, const uint8_t* data, uint64_t size)
+      : path_(std::move(path)), fd_(fd), data_(data), size_(size) {}
+
+  std::string path_;
+  int fd_ = -1;
+  const uint8_t* data_ = nullptr;
+  uint64_t size_ = 0;
+};
+
+}  // namespace xe
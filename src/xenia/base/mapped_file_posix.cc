@@ -0,0 +1,72 @@
+/**
+ * Vera360 — Xenia Edge
+ * Memory-mapped files (POSIX mmap)
+ */
+
+#include "xenia/base/mapped_file.h"
+#include "xenia/base/logging.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace xe {
+
+std::unique_ptr<MappedFile> MappedFile::Open(const std::string& path) {
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    XELOGW("MappedFile: open({}) failed: {}", path, strerror(errno));
+    return nullptr;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+    XELOGW("MappedFile: {} is empty or unreadable", path);
+    close(fd);
+    return nullptr;
+  }
+  uint64_t size = static_cast<uint64_t>(st.st_size);
+
+  void* data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  if (data == MAP_FAILED) {
+    XELOGW("MappedFile: mmap({}, 0x{:X}) failed: {}", path, size,
+           strerror(errno));
+    close(fd);
+    return nullptr;
+  }
+
+  return std::unique_ptr<MappedFile>(
+      new MappedFile(path, fd, static_cast<const uint8_t*>(data), size));
+}
+
+MappedFile::~MappedFile() {
+  if (data_) munmap(const_cast<uint8_t*>(data_), size_);
+  if (fd_ >= 0) close(fd_);
+}
+
+void MappedFile::Advise(uint64_t offset, uint64_t length,
+                        AccessHint hint) const {
+  if (offset >= size_ || length == 0) return;
+  length = std::min(length, size_ - offset);
+
+  static const uint64_t page_size = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+  uint64_t start = offset & ~(page_size - 1);
+  uint64_t end = offset + length;
+
+  int advice = MADV_NORMAL;
+  switch (hint) {
+    case AccessHint::kNormal:     advice = MADV_NORMAL; break;
+    case AccessHint::kSequential: advice = MADV_SEQUENTIAL; break;
+    case AccessHint::kRandom:     advice = MADV_RANDOM; break;
+    case AccessHint::kWillNeed:   advice = MADV_WILLNEED; break;
+    case AccessHint::kDontNeed:   advice = MADV_DONTNEED; break;
+  }
+  madvise(const_cast<uint8_t*>(data_) + start, end - start, advice);
+}
+
+}  // namespace xe
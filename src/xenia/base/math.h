@@ -3,7 +3,9 @@
  */
 #pragma once
 
+#if defined(__aarch64__)
 #include <arm_neon.h>
+#endif
 #include <cmath>
 #include <cstdint>
 
@@ -41,6 +43,7 @@ inline uint32_t PopCount(uint32_t v) {
   return __builtin_popcount(v);
 }
 
+#if defined(__aarch64__)
 // ── NEON vector helpers ─────────────────────────────────────────────
 inline float32x4_t Vec4Load(const float* p) {
   return vld1q_f32(p);
@@ -58,4 +61,6 @@ inline float32x4_t Vec4Mul(float32x4_t a, float32x4_t b) {
   return vmulq_f32(a, b);
 }
 
+#endif  // __aarch64__
+
 }  // namespace xe::math
@@ -0,0 +1,116 @@
+/**
+ * Vera360 — Xenia Edge
+ * Guest memory snapshots — copy-on-write capture and lazy restore
+ *
+ * Capture write-protects committed guest memory and lets the guest carry
+ * on: the first write to a block copies it aside before the write goes
+ * through, while background readers take every other block straight from
+ * guest memory. Restore is the mirror image: blocks start out inaccessible
+ * and are filled by a background thread, which takes blocks the guest
+ * faults on first. Both work through the memory manager's access hook, so
+ * only one can be active.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "xenia/base/memory/memory.h"
+#include "xenia/base/threading.h"
+
+namespace xe::memory {
+
+/// A run of committed guest pages with one protection
+struct SnapshotBlock {
+  uint32_t address = 0;
+  uint32_t size = 0;
+  PageAccess access = PageAccess::kNoAccess;
+};
+
+class GuestSnapshot {
+ public:
+  /// Split committed guest memory into blocks of at most block_size bytes
+  /// (a multiple of the host page size) and write-protect it. Returns
+  /// nullptr if another snapshot or restore is active.
+  static std::unique_ptr<GuestSnapshot> Capture(uint32_t block_size);
+
+  /// Blocks not read yet are given back to the guest unread
+  ~GuestSnapshot();
+
+  const std::vector<SnapshotBlock>& blocks() const { return blocks_; }
+  uint64_t total_bytes() const { return total_bytes_; }
+
+  /// Copy block index, as it was at capture, to out (block.size bytes).
+  /// Thread-safe; each block may be read once.
+  void ReadBlock(size_t index, uint8_t* out);
+
+  /// Blocks the guest wrote to before they were read
+  uint32_t preserved_count() const {
+    return preserved_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  GuestSnapshot() = default;
+
+  static bool AccessHook(void* context, uint32_t address, uint32_t size,
+                         bool from_fault, bool is_write);
+  void Preserve(size_t index);
+
+  std::vector<SnapshotBlock> blocks_;
+  std::vector<uint64_t> pool_offsets_;
+  std::unique_ptr<std::atomic<uint8_t>[]> states_;
+  uint8_t* pool_ = nullptr;
+  uint64_t pool_size_ = 0;
+  uint64_t total_bytes_ = 0;
+  std::atomic<uint32_t> preserved_{0};
+};
+
+class GuestRestore {
+ public:
+  /// Fill dest (block.size writable bytes) with block index's contents.
+  /// Runs on the fill thread, or on a thread calling EnsureAccessible;
+  /// never inside the SIGSEGV handler.
+  using FillFn = std::function<bool(size_t index, uint8_t* dest)>;
+
+  /// Discard all guest memory and recreate blocks (sorted, disjoint, host
+  /// page aligned) as committed but not yet populated, then start the fill
+  /// thread. Returns nullptr if the blocks are invalid or another snapshot
+  /// or restore is active.
+  static std::unique_ptr<GuestRestore> Begin(std::vector<SnapshotBlock> blocks,
+                                             FillFn fill);
+
+  /// Waits for the fill thread
+  ~GuestRestore();
+
+  bool complete() const {
+    return remaining_.load(std::memory_order_acquire) == 0;
+  }
+  /// A block failed to fill (and was left zeroed)
+  bool failed() const { return failed_.load(std::memory_order_acquire); }
+
+ private:
+  GuestRestore() = default;
+
+  static bool AccessHook(void* context, uint32_t address, uint32_t size,
+                         bool from_fault, bool is_write);
+  void Fill(size_t index);
+  /// Claim block index (missing or wanted) and fill it; false if another
+  /// thread has it
+  bool TryFill(size_t index);
+  void FillRemaining();
+
+  std::vector<SnapshotBlock> blocks_;
+  std::unique_ptr<std::atomic<uint8_t>[]> states_;
+  FillFn fill_;
+  std::atomic<size_t> remaining_{0};
+  /// Blocks a faulting thread is waiting on
+  std::atomic<size_t> wanted_{0};
+  std::atomic<bool> failed_{false};
+  std::unique_ptr<threading::Thread> fill_thread_;
+};
+
+}  // namespace xe::memory
@@ -10,6 +10,8 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <functional>
 
 namespace xe::memory {
 
@@ -58,6 +60,68 @@ bool Protect(void* base, size_t size, PageAccess access);
 /// Release a region entirely (un-reserves).
 bool Release(void* base, size_t size);
 
+/// Host page size (4 KB, or 16 KB on some Android kernels).
+size_t GetHostPageSize();
+
+/// Replace committed guest pages with a private (copy-on-write) view of a
+/// file, keeping their protection. base, size and offset must be host-page
+/// aligned, and every page committed writable with the same access;
+/// false otherwise, and the caller copies instead.
+bool MapFileView(void* base, size_t size, int fd, uint64_t offset);
+
+/// Guest page granularity tracked by the commit map
+constexpr uint32_t kGuestPageSize = 4096;
+
+/// Visit maximal runs of committed guest pages that share one protection,
+/// in address order (from the commit map; no syscalls).
+void ForEachCommittedRange(
+    const std::function<void(uint32_t address, uint32_t size,
+                             PageAccess access)>& fn);
+
+/// Whether the guest page holding guest_address is committed readable
+/// (from the commit map; no syscalls). For code that follows guest
+/// pointers it cannot trust, such as stack walks.
+bool IsReadable(uint32_t guest_address);
+
+/// Record pages as committed with access but leave them inaccessible; the
+/// access hook applies the protection when it populates them.
+bool CommitDeferred(void* base, size_t size, PageAccess access);
+
+/// Drop every page of the guest space (including file views) and clear
+/// the commit map, keeping the 4GB reservation.
+bool ResetGuestSpace();
+
+/// Hook for engines that temporarily hide guest pages (save-state capture,
+/// lazy restore). It is called for [guest_address, guest_address + size)
+/// either from the SIGSEGV handler (from_fault, with is_write when the
+/// CPU reports it) or from EnsureAccessible; it returns true once the
+/// range may be accessed again. Must be async-signal-safe when from_fault:
+/// no allocation, locks or library calls beyond raw syscalls.
+using AccessHook = bool (*)(void* context, uint32_t guest_address,
+                            uint32_t size, bool from_fault, bool is_write);
+
+/// Install (or with nullptr, remove) the access hook. Faults the hook
+/// declines are passed to the previously installed SIGSEGV handler.
+/// Removal waits for hook calls already running on other threads, so the
+/// context may be freed once it returns; never remove from inside the hook.
+void SetAccessHook(AccessHook hook, void* context);
+
+/// Change protection of guest pages directly, bypassing the commit map and
+/// the access hook. Async-signal-safe, for use by access hooks.
+bool ApplyProtection(uint32_t guest_address, uint32_t size,
+                     PageAccess access);
+
+/// Atomically replace guest pages with an anonymous mapping of size bytes
+/// (which is consumed), protected as access. Lets an access hook fill a
+/// block privately and publish it whole. Async-signal-safe.
+bool MoveIntoGuest(void* pages, uint32_t guest_address, uint32_t size,
+                   PageAccess access);
+
+/// Run the access hook over a guest range before it is handed to a
+/// syscall (which would fail with EFAULT rather than fault) or remapped.
+/// Commit, Decommit, Protect and MapFileView do this themselves.
+void EnsureAccessible(void* base, size_t size);
+
 /// Allocate executable memory for JIT code caches.
 void* AllocateExecutable(size_t size);
 
@@ -70,4 +134,31 @@ size_t QueryAvailablePhysicalMemory();
 /// Query total system RAM.
 size_t QueryTotalPhysicalMemory();
 
+// ── Byte-swapping copies ────────────────────────────────────────────────────
+
+/// Copy count big-endian 32-bit words (guest vertex and index data) to host
+/// order. Neither pointer needs to be aligned.
+inline void CopyAndSwap32(void* dst, const void* src, size_t count) {
+  auto* d = static_cast<uint8_t*>(dst);
+  auto* s = static_cast<const uint8_t*>(src);
+  for (size_t i = 0; i < count; ++i) {
+    uint32_t v;
+    memcpy(&v, s + i * 4, 4);
+    v = __builtin_bswap32(v);
+    memcpy(d + i * 4, &v, 4);
+  }
+}
+
+/// As above, for 16-bit words
+inline void CopyAndSwap16(void* dst, const void* src, size_t count) {
+  auto* d = static_cast<uint8_t*>(dst);
+  auto* s = static_cast<const uint8_t*>(src);
+  for (size_t i = 0; i < count; ++i) {
+    uint16_t v;
+    memcpy(&v, s + i * 2, 2);
+    v = __builtin_bswap16(v);
+    memcpy(d + i * 2, &v, 2);
+  }
+}
+
 }  // namespace xe::memory
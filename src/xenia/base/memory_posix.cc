@@ -4,7 +4,7 @@
  *
  * This replaces ALL Win32 virtual memory APIs:
  *   VirtualAlloc   → mmap + mprotect
- *   VirtualFree    → munmap / madvise(MADV_DONTNEED)
+ *   VirtualFree    → fresh PROT_NONE anonymous pages (munmap outside guest space)
  *   VirtualProtect → mprotect
  *   VirtualQuery   → parsing /proc/self/maps (if needed)
  */
@@ -12,12 +12,18 @@
 #include "xenia/base/memory/memory.h"
 #include "xenia/base/logging.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cerrno>
+#include <csignal>
 #include <cstring>
 #include <fstream>
+#include <memory>
 #include <string>
 
+#include <sched.h>
 #include <sys/mman.h>
+#include <ucontext.h>
 #include <unistd.h>
 
 namespace xe::memory {
@@ -30,6 +36,127 @@ constexpr size_t kGuestSize = 4ULL * 1024 * 1024 * 1024;  // 0x100000000
 /// Host pointer to the base of the guest reservation
 uint8_t* g_guest_base = nullptr;
 
+// ── Commit map ──────────────────────────────────────────────────────────────
+// One byte per 4KB guest page: 0 = not committed, else kCommitted | access.
+
+constexpr uint8_t kCommitted = 0x80;
+constexpr size_t kGuestPageCount = kGuestSize / kGuestPageSize;
+std::unique_ptr<uint8_t[]> g_commit_map;
+
+/// Page index range covering [base, base + size), false if the range is
+/// not inside the guest reservation
+bool GuestPageRange(const void* base, size_t size, size_t* first,
+                    size_t* end) {
+  auto* p = static_cast<const uint8_t*>(base);
+  if (!g_guest_base || p < g_guest_base || size > kGuestSize ||
+      static_cast<size_t>(p - g_guest_base) > kGuestSize - size) {
+    return false;
+  }
+  size_t offset = static_cast<size_t>(p - g_guest_base);
+  *first = offset / kGuestPageSize;
+  *end = (offset + size + kGuestPageSize - 1) / kGuestPageSize;
+  return true;
+}
+
+void MarkPages(const void* base, size_t size, uint8_t value) {
+  size_t first, end;
+  if (!g_commit_map || !GuestPageRange(base, size, &first, &end)) return;
+  memset(&g_commit_map[first], value, end - first);
+}
+
+uint8_t CommittedValue(PageAccess access) {
+  return kCommitted | static_cast<uint8_t>(access);
+}
+
+/// Swap a range for fresh zero-fill pages, inaccessible. Unlike
+/// MADV_DONTNEED this also drops file views: those would come back with
+/// the file's contents instead of zeros.
+bool ReplaceWithAnonymous(void* base, size_t size) {
+  void* mapped = mmap(base, size, PROT_NONE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED,
+                      -1, 0);
+  return mapped != MAP_FAILED;
+}
+
+// ── Access hook (SIGSEGV) ───────────────────────────────────────────────────
+
+std::atomic<AccessHook> g_access_hook{nullptr};
+std::atomic<void*> g_access_hook_context{nullptr};
+/// Hook calls in flight; SetAccessHook(nullptr) waits for them to drain so
+/// the context can be destroyed right after
+std::atomic<uint32_t> g_access_hook_calls{0};
+struct sigaction g_previous_segv;
+bool g_segv_installed = false;
+
+/// Whether the faulting access was a write, from the signal frame. Unknown
+/// counts as a write: hooks only ever treat that more strictly.
+bool FaultIsWrite(void* ucontext) {
+#if defined(__x86_64__)
+  auto* uc = static_cast<ucontext_t*>(ucontext);
+  return (uc->uc_mcontext.gregs[REG_ERR] & 0x2) != 0;
+#elif defined(__aarch64__)
+  // The kernel appends an ESR record to the frame's extension area; its
+  // WnR bit (6) is set for writes
+  struct ContextRecord { uint32_t magic; uint32_t size; };
+  struct EsrRecord { ContextRecord head; uint64_t esr; };
+  constexpr uint32_t kEsrMagic = 0x45535201;
+  auto* uc = static_cast<ucontext_t*>(ucontext);
+  auto* cursor = reinterpret_cast<uint8_t*>(uc->uc_mcontext.__reserved);
+  auto* limit = cursor + sizeof(uc->uc_mcontext.__reserved);
+  while (cursor + sizeof(ContextRecord) <= limit) {
+    auto* record = reinterpret_cast<ContextRecord*>(cursor);
+    if (!record->magic || record->size < sizeof(ContextRecord)) break;
+    if (record->magic == kEsrMagic) {
+      return (reinterpret_cast<EsrRecord*>(record)->esr >> 6) & 1;
+    }
+    cursor += record->size;
+  }
+  return true;
+#else
+  (void)ucontext;
+  return true;
+#endif
+}
+
+/// Run the installed hook, if any. The in-flight count is raised before
+/// the hook is loaded, so a removal either sees this call or this call
+/// sees the removal.
+bool CallAccessHook(uint32_t guest_address, uint32_t size, bool from_fault,
+                    bool is_write) {
+  g_access_hook_calls.fetch_add(1, std::memory_order_seq_cst);
+  AccessHook hook = g_access_hook.load(std::memory_order_seq_cst);
+  bool handled =
+      hook && hook(g_access_hook_context.load(std::memory_order_acquire),
+                   guest_address, size, from_fault, is_write);
+  g_access_hook_calls.fetch_sub(1, std::memory_order_release);
+  return handled;
+}
+
+void AccessFaultHandler(int signal, siginfo_t* info, void* ucontext) {
+  auto* addr = static_cast<uint8_t*>(info->si_addr);
+  if (g_guest_base && addr >= g_guest_base &&
+      addr < g_guest_base + kGuestSize) {
+    auto guest_address = static_cast<uint32_t>(addr - g_guest_base);
+    if (CallAccessHook(guest_address, 1, true, FaultIsWrite(ucontext))) {
+      return;  // Retry the access
+    }
+  }
+
+  // Not ours — hand the fault to whoever was installed before us
+  if (g_previous_segv.sa_flags & SA_SIGINFO) {
+    if (g_previous_segv.sa_sigaction) {
+      g_previous_segv.sa_sigaction(signal, info, ucontext);
+      return;
+    }
+  } else if (g_previous_segv.sa_handler != SIG_DFL &&
+             g_previous_segv.sa_handler != SIG_IGN) {
+    g_previous_segv.sa_handler(signal);
+    return;
+  }
+  // Default action: restore it and let the access fault again
+  ::signal(signal, SIG_DFL);
+}
+
 /// Convert our PageAccess enum to POSIX mprotect flags
 int ToPosixProtection(PageAccess access) {
   switch (access) {
@@ -91,14 +218,17 @@ bool Initialize() {
   }
 
   g_guest_base = static_cast<uint8_t*>(base);
+  g_commit_map = std::make_unique<uint8_t[]>(kGuestPageCount);
   XELOGI("Guest memory reserved at {:p}, size 0x{:X}", base, kGuestSize);
   return true;
 }
 
 void Shutdown() {
   if (g_guest_base) {
+    SetAccessHook(nullptr, nullptr);
     munmap(g_guest_base, kGuestSize);
     g_guest_base = nullptr;
+    g_commit_map.reset();
     XELOGI("Guest memory released");
   }
 }
@@ -129,6 +259,7 @@ MappingResult Reserve(void* preferred_base, size_t size) {
 bool Commit(void* base, size_t size, PageAccess access) {
   size = AlignToPage(size);
   int prot = ToPosixProtection(access);
+  EnsureAccessible(base, size);
 
   // mprotect to make pages accessible — kernel allocates physical pages on first touch  
   if (mprotect(base, size, prot) != 0) {
@@ -140,29 +271,29 @@ bool Commit(void* base, size_t size, PageAccess access) {
   // (MADV_WILLNEED hints that we'll access these pages soon)
   madvise(base, size, MADV_WILLNEED);
 
+  MarkPages(base, size, CommittedValue(access));
   return true;
 }
 
 bool Decommit(void* base, size_t size) {
   size = AlignToPage(size);
+  EnsureAccessible(base, size);
 
-  // Set to PROT_NONE so accesses fault
-  if (mprotect(base, size, PROT_NONE) != 0) {
-    XELOGE("Decommit mprotect({:p}, 0x{:X}) failed: {}", base, size, strerror(errno));
+  // Fresh PROT_NONE pages: accesses fault, the old pages (or file view)
+  // are released, and a later Commit sees zeros
+  if (!ReplaceWithAnonymous(base, size)) {
+    XELOGE("Decommit({:p}, 0x{:X}) failed: {}", base, size, strerror(errno));
     return false;
   }
 
-  // MADV_DONTNEED releases physical pages but keeps the VMA
-  if (madvise(base, size, MADV_DONTNEED) != 0) {
-    XELOGW("Decommit madvise DONTNEED failed (non-fatal): {}", strerror(errno));
-  }
-
+  MarkPages(base, size, 0);
   return true;
 }
 
 bool Protect(void* base, size_t size, PageAccess access) {
   size = AlignToPage(size);
   int prot = ToPosixProtection(access);
+  EnsureAccessible(base, size);
 
   if (mprotect(base, size, prot) != 0) {
     XELOGE("Protect({:p}, 0x{:X}, {}) failed: {}", base, size,
@@ -170,20 +301,177 @@ bool Protect(void* base, size_t size, PageAccess access) {
     return false;
   }
 
+  MarkPages(base, size, CommittedValue(access));
   return true;
 }
 
 bool Release(void* base, size_t size) {
   size = AlignToPage(size);
 
+  // Inside the guest space the reservation stays: an unmapped hole there
+  // could be taken by an unrelated host mapping
+  size_t first, end;
+  if (GuestPageRange(base, size, &first, &end)) {
+    EnsureAccessible(base, size);
+    if (!ReplaceWithAnonymous(base, size)) {
+      XELOGE("Release({:p}, 0x{:X}) failed: {}", base, size, strerror(errno));
+      return false;
+    }
+    MarkPages(base, size, 0);
+    return true;
+  }
+
   if (munmap(base, size) != 0) {
     XELOGE("Release munmap({:p}, 0x{:X}) failed: {}", base, size, strerror(errno));
     return false;
   }
 
+  MarkPages(base, size, 0);
   return true;
 }
 
+size_t GetHostPageSize() {
+  return GetPageSize();
+}
+
+bool MapFileView(void* base, size_t size, int fd, uint64_t offset) {
+  size_t ps = GetPageSize();
+  size_t first, end;
+  if ((reinterpret_cast<uintptr_t>(base) & (ps - 1)) || (size & (ps - 1)) ||
+      (offset & (ps - 1)) || !size || !g_commit_map ||
+      !GuestPageRange(base, size, &first, &end)) {
+    return false;
+  }
+  // Only over pages the guest committed writable, all alike: the view
+  // takes their protection and must not commit anything new
+  uint8_t value = g_commit_map[first];
+  auto access = static_cast<PageAccess>(value & ~kCommitted);
+  if (!(value & kCommitted) || (access != PageAccess::kReadWrite &&
+                                access != PageAccess::kExecuteReadWrite)) {
+    return false;
+  }
+  for (size_t page = first + 1; page < end; ++page) {
+    if (g_commit_map[page] != value) return false;
+  }
+  EnsureAccessible(base, size);
+
+  // MAP_FIXED atomically swaps the existing (anonymous) pages for the file
+  // view; MAP_PRIVATE keeps guest writes out of the backing file. Decommit
+  // and Release swap anonymous pages back in.
+  void* mapped = mmap(base, size, ToPosixProtection(access),
+                      MAP_PRIVATE | MAP_FIXED, fd, static_cast<off_t>(offset));
+  if (mapped == MAP_FAILED) {
+    XELOGW("MapFileView({:p}, 0x{:X}) failed: {}", base, size, strerror(errno));
+    return false;
+  }
+  return true;
+}
+
+void ForEachCommittedRange(
+    const std::function<void(uint32_t address, uint32_t size,
+                             PageAccess access)>& fn) {
+  if (!g_commit_map) return;
+  // Runs are capped so their byte size fits in 32 bits
+  constexpr size_t kMaxRunPages = 0x80000000ULL / kGuestPageSize;
+  size_t page = 0;
+  while (page < kGuestPageCount) {
+    uint8_t value = g_commit_map[page];
+    if (!value) {
+      ++page;
+      continue;
+    }
+    size_t end = page + 1;
+    while (end < kGuestPageCount && g_commit_map[end] == value &&
+           end - page < kMaxRunPages) {
+      ++end;
+    }
+    fn(static_cast<uint32_t>(page * kGuestPageSize),
+       static_cast<uint32_t>((end - page) * kGuestPageSize),
+       static_cast<PageAccess>(value & ~kCommitted));
+    page = end;
+  }
+}
+
+bool IsReadable(uint32_t guest_address) {
+  if (!g_commit_map) return false;
+  uint8_t value = g_commit_map[guest_address / kGuestPageSize];
+  return (value & kCommitted) && (value & ~kCommitted) != 0;
+}
+
+bool CommitDeferred(void* base, size_t size, PageAccess access) {
+  size_t first, end;
+  if (!g_commit_map || !GuestPageRange(base, size, &first, &end)) {
+    return false;
+  }
+  MarkPages(base, size, CommittedValue(access));
+  return true;
+}
+
+bool ResetGuestSpace() {
+  if (!g_guest_base) return false;
+  void* base = mmap(g_guest_base, kGuestSize, PROT_NONE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED,
+                    -1, 0);
+  if (base == MAP_FAILED) {
+    XELOGE("ResetGuestSpace failed: {}", strerror(errno));
+    return false;
+  }
+  memset(g_commit_map.get(), 0, kGuestPageCount);
+  return true;
+}
+
+void SetAccessHook(AccessHook hook, void* context) {
+  if (hook && !g_segv_installed) {
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_sigaction = AccessFaultHandler;
+    action.sa_flags = SA_SIGINFO | SA_ONSTACK | SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    if (sigaction(SIGSEGV, &action, &g_previous_segv) != 0) {
+      XELOGE("SetAccessHook: sigaction failed: {}", strerror(errno));
+      return;
+    }
+    g_segv_installed = true;
+  }
+  if (hook) {
+    g_access_hook_context.store(context, std::memory_order_release);
+    g_access_hook.store(hook, std::memory_order_release);
+  } else {
+    g_access_hook.store(nullptr, std::memory_order_seq_cst);
+    while (g_access_hook_calls.load(std::memory_order_acquire)) {
+      sched_yield();
+    }
+    g_access_hook_context.store(nullptr, std::memory_order_release);
+  }
+}
+
+bool ApplyProtection(uint32_t guest_address, uint32_t size,
+                     PageAccess access) {
+  return mprotect(g_guest_base + guest_address, size,
+                  ToPosixProtection(access)) == 0;
+}
+
+bool MoveIntoGuest(void* pages, uint32_t guest_address, uint32_t size,
+                   PageAccess access) {
+  if (mprotect(pages, size, ToPosixProtection(access)) != 0) return false;
+  return mremap(pages, size, size, MREMAP_MAYMOVE | MREMAP_FIXED,
+                g_guest_base + guest_address) != MAP_FAILED;
+}
+
+void EnsureAccessible(void* base, size_t size) {
+  size_t first, end;
+  if (!g_access_hook.load(std::memory_order_acquire) || !size ||
+      !GuestPageRange(base, size, &first, &end)) {
+    return;
+  }
+  auto guest_address =
+      static_cast<uint32_t>(static_cast<uint8_t*>(base) - g_guest_base);
+  CallAccessHook(guest_address,
+                 static_cast<uint32_t>(std::min<size_t>(
+                     {size, kGuestSize - guest_address, UINT32_MAX})),
+                 false, true);
+}
+
 void* AllocateExecutable(size_t size) {
   size = AlignToPage(size);
 
@@ -0,0 +1,245 @@
+/**
+ * Vera360 — Xenia Edge
+ * Deterministic replay — log recording and playback
+ */
+
+#include "xenia/base/replay.h"
+#include "xenia/base/logging.h"
+#include "xenia/base/threading.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace xe::replay {
+
+namespace {
+
+/// 2010-01-01 00:00 UTC: every deterministic run starts on this date
+constexpr uint64_t kFixedSystemTime = 129067776000000000ULL;
+
+struct State {
+  threading::Mutex mutex;
+  Mode mode = Mode::kOff;
+  std::string path;
+  uint64_t system_time = kFixedSystemTime;
+  FILE* file = nullptr;        // record
+  std::vector<uint8_t> log;    // replay: the whole log
+  size_t cursor = 0;
+  uint64_t events = 0;
+  bool diverged = false;
+  bool ended = false;
+};
+
+State& GetState() {
+  static State* state = new State();
+  return *state;
+}
+
+const char* EventName(uint16_t kind) {
+  switch (static_cast<Event>(kind)) {
+    case Event::kPadPoll:
+      return "pad poll";
+    case Event::kIoCompletion:
+      return "I/O completion";
+  }
+  return "unknown";
+}
+
+bool Append(State& s, Event kind, const void* data, size_t size) {
+  EventHeader header = {static_cast<uint16_t>(kind),
+                        static_cast<uint16_t>(size)};
+  if (fwrite(&header, sizeof(header), 1, s.file) != 1 ||
+      (size && fwrite(data, size, 1, s.file) != 1)) {
+    XELOGE("Replay: write to {} failed, recording stopped", s.path);
+    fclose(s.file);
+    s.file = nullptr;
+    return false;
+  }
+  ++s.events;
+  return true;
+}
+
+/// The next logged event if it is kind and size; reports the first
+/// mismatch or the end of the log
+const uint8_t* Next(State& s, Event kind, size_t size) {
+  if (s.diverged || s.ended) return nullptr;
+  EventHeader header;
+  if (s.cursor + sizeof(header) > s.log.size()) {
+    XELOGW("Replay: log ended after {} events, input is live from here",
+           s.events);
+    s.ended = true;
+    return nullptr;
+  }
+  memcpy(&header, s.log.data() + s.cursor, sizeof(header));
+  if (header.kind != static_cast<uint16_t>(kind) || header.size != size ||
+      s.cursor + sizeof(header) + size > s.log.size()) {
+    XELOGW("Replay: diverged at event {}: the guest asked for a {}, the log "
+           "has a {}", s.events, EventName(static_cast<uint16_t>(kind)),
+           EventName(header.kind));
+    s.diverged = true;
+    return nullptr;
+  }
+  const uint8_t* payload = s.log.data() + s.cursor + sizeof(header);
+  s.cursor += sizeof(header) + size;
+  ++s.events;
+  return payload;
+}
+
+bool OpenRecord(State& s) {
+  s.file = fopen(s.path.c_str(), "wb");
+  if (!s.file) {
+    XELOGE("Replay: cannot write {}", s.path);
+    return false;
+  }
+  Header header = {kMagic, kVersion, s.system_time};
+  if (fwrite(&header, sizeof(header), 1, s.file) != 1) {
+    XELOGE("Replay: write to {} failed", s.path);
+    fclose(s.file);
+    s.file = nullptr;
+    return false;
+  }
+  return true;
+}
+
+bool OpenReplay(State& s) {
+  FILE* f = fopen(s.path.c_str(), "rb");
+  if (!f) {
+    XELOGE("Replay: cannot open {}", s.path);
+    return false;
+  }
+  s.log.clear();
+  uint8_t buffer[64 * 1024];
+  size_t n;
+  while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0) {
+    s.log.insert(s.log.end(), buffer, buffer + n);
+  }
+  bool ok = !ferror(f);
+  fclose(f);
+  Header header;
+  if (!ok || s.log.size() < sizeof(header)) {
+    XELOGE("Replay: cannot read {}", s.path);
+    return false;
+  }
+  memcpy(&header, s.log.data(), sizeof(header));
+  if (header.magic != kMagic || header.version != kVersion) {
+    XELOGE("Replay: {} is not a version {} replay log", s.path, kVersion);
+    return false;
+  }
+  s.system_time = header.system_time;
+  s.cursor = sizeof(header);
+  return true;
+}
+
+}  // namespace
+
+bool Start(Mode mode, const std::string& path) {
+  State& s = GetState();
+  threading::LockGuard lock(s.mutex);
+  if (s.mode != Mode::kOff) return false;
+  s.path = path;
+  s.system_time = kFixedSystemTime;
+  s.events = 0;
+  s.diverged = false;
+  s.ended = false;
+  if (mode == Mode::kRecord && !OpenRecord(s)) return false;
+  if (mode == Mode::kReplay && !OpenReplay(s)) return false;
+  s.mode = mode;
+  switch (mode) {
+    case Mode::kRecord:
+      XELOGI("Replay: recording to {}", path);
+      break;
+    case Mode::kReplay:
+      XELOGI("Replay: replaying {} ({} bytes)", path, s.log.size());
+      break;
+    default:
+      XELOGI("Replay: deterministic run, no log");
+      break;
+  }
+  return true;
+}
+
+void Stop() {
+  State& s = GetState();
+  threading::LockGuard lock(s.mutex);
+  if (s.mode == Mode::kRecord && s.file) {
+    if (fclose(s.file) != 0) XELOGE("Replay: write to {} failed", s.path);
+    s.file = nullptr;
+    XELOGI("Replay: recorded {} events", s.events);
+  } else if (s.mode == Mode::kReplay) {
+    size_t left = s.log.size() - s.cursor;
+    if (s.diverged) {
+      XELOGW("Replay: diverged after {} matching events", s.events);
+    } else {
+      XELOGI("Replay: {} events matched{}", s.events,
+             left ? ", the log has more" : "");
+    }
+    s.log.clear();
+    s.log.shrink_to_fit();
+  }
+  s.mode = Mode::kOff;
+}
+
+Mode mode() {
+  State& s = GetState();
+  threading::LockGuard lock(s.mutex);
+  return s.mode;
+}
+
+bool deterministic() { return mode() != Mode::kOff; }
+
+uint64_t system_time() {
+  State& s = GetState();
+  threading::LockGuard lock(s.mutex);
+  return s.system_time;
+}
+
+bool Exchange(Event kind, void* data, size_t size) {
+  State& s = GetState();
+  threading::LockGuard lock(s.mutex);
+  if (s.mode == Mode::kRecord) {
+    return s.file && Append(s, kind, data, size);
+  }
+  if (s.mode != Mode::kReplay) return false;
+  const uint8_t* logged = Next(s, kind, size);
+  if (!logged) return false;
+  memcpy(data, logged, size);
+  return true;
+}
+
+bool Check(Event kind, const void* data, size_t size) {
+  State& s = GetState();
+  threading::LockGuard lock(s.mutex);
+  if (s.mode == Mode::kRecord) {
+    return s.file && Append(s, kind, data, size);
+  }
+  if (s.mode != Mode::kReplay) return true;
+  if (s.diverged || s.ended) return false;
+  const uint8_t* logged = Next(s, kind, size);
+  if (!logged) return false;
+  if (memcmp(logged, data, size) != 0) {
+    --s.events;  // counts matches only
+    XELOGW("Replay: diverged at event {}: the {} differs from the log",
+           s.events, EventName(static_cast<uint16_t>(kind)));
+    s.diverged = true;
+    return false;
+  }
+  return true;
+}
+
+uint64_t event_count() {
+  State& s = GetState();
+  threading::LockGuard lock(s.mutex);
+  return s.events;
+}
+
+uint64_t Hash(const void* data, size_t size) {
+  const auto* p = static_cast<const uint8_t*>(data);
+  uint64_t hash = 0xCBF29CE484222325ULL;
+  for (size_t i = 0; i < size; ++i) {
+    hash = (hash ^ p[i]) * 0x100000001B3ULL;
+  }
+  return hash;
+}
+
+}  // namespace xe::replay
@@ -0,0 +1,86 @@
+/**
+ * Vera360 — Xenia Edge
+ * Deterministic replay — the inputs of a run, logged in guest order
+ *
+ * A deterministic run (record, replay, or plain deterministic mode) takes
+ * the host out of guest behavior: the guest clock is the instruction clock
+ * (timebase.h), guest threads run in a fixed round-robin on one host
+ * thread, XMA decodes on that thread between slices, and the guest's wall
+ * clock starts at a fixed date. What is left comes from outside, and is
+ * logged as events in the order the guest observed them:
+ *
+ *   kPadPoll       every XInputGetState result. Replay hands the guest the
+ *                  logged state instead of the live pad.
+ *   kIoCompletion  every file read/write completion (status, byte count,
+ *                  data hash). I/O completes synchronously, in call order,
+ *                  so replay checks these rather than substituting them.
+ *
+ * The first event that does not match the log is reported as a
+ * divergence: the guest took a different path than the recorded run, and
+ * later events stop meaning anything. Replay then falls back to live
+ * input. Log layout: a Header, then per event an EventHeader and its
+ * payload, all host byte order.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace xe::replay {
+
+enum class Mode : uint8_t {
+  kOff = 0,
+  kDeterministic,  // fixed time and scheduling, no log
+  kRecord,
+  kReplay,
+};
+
+enum class Event : uint16_t {
+  kPadPoll = 1,
+  kIoCompletion = 2,
+};
+
+constexpr uint32_t kMagic = 0x4C523356;  // "V3RL"
+constexpr uint32_t kVersion = 1;
+
+struct Header {
+  uint32_t magic;
+  uint32_t version;
+  /// Guest wall clock at guest tick 0, as a FILETIME
+  uint64_t system_time;
+};
+
+struct EventHeader {
+  uint16_t kind;
+  uint16_t size;
+};
+
+/// Deterministic mode needs no path. Record and replay open it, and
+/// replay takes the start date from the log.
+bool Start(Mode mode, const std::string& path = {});
+/// Finishes the log and reports the event count and any divergence
+void Stop();
+
+Mode mode();
+/// Any mode but kOff: time and scheduling are fixed
+bool deterministic();
+
+/// FILETIME (100 ns since 1601) that guest time 0 corresponds to
+uint64_t system_time();
+
+/// Record: logs data. Replay: replaces data with the next event, which
+/// must be kind and size. False if data is left as it was (off, a
+/// divergence, or the end of the log).
+bool Exchange(Event kind, void* data, size_t size);
+/// Record: logs data. Replay: compares it with the next event. False on a
+/// divergence.
+bool Check(Event kind, const void* data, size_t size);
+
+/// Events logged or replayed since Start
+uint64_t event_count();
+
+/// FNV-1a, for logging a digest of bulk data
+uint64_t Hash(const void* data, size_t size);
+
+}  // namespace xe::replay
@@ -0,0 +1,72 @@
+/**
+ * Vera360 — Xenia Edge
+ * Sequence lock — lock-free snapshots of a small value
+ *
+ * One writer publishes whole values; any number of readers take consistent
+ * copies without locking and without ever blocking the writer. The
+ * sequence is odd while a store is in progress; a reader that saw it odd,
+ * or saw it change across its copy, retries. The value lives in relaxed
+ * atomic words, so a torn read is discarded rather than a data race.
+ * Writers must serialize among themselves.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "xenia/base/threading.h"
+
+namespace xe {
+
+template <typename T>
+class SeqLock {
+  static_assert(std::is_trivially_copyable_v<T>);
+
+ public:
+  void Store(const T& value) {
+    uint64_t words[kWords] = {};
+    memcpy(words, &value, sizeof(T));
+    uint32_t sequence = sequence_.load(std::memory_order_relaxed);
+    sequence_.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < kWords; ++i) {
+      words_[i].store(words[i], std::memory_order_relaxed);
+    }
+    sequence_.store(sequence + 2, std::memory_order_release);
+  }
+
+  T Load() const {
+    uint64_t words[kWords];
+    for (uint32_t spins = 0;; ++spins) {
+      uint32_t before = sequence_.load(std::memory_order_acquire);
+      if (!(before & 1)) {
+        for (size_t i = 0; i < kWords; ++i) {
+          words[i] = words_[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence_.load(std::memory_order_relaxed) == before) break;
+      }
+      // The writer was preempted mid-store; let it finish
+      if (spins >= 64) threading::MaybeYield();
+    }
+    T value;
+    memcpy(&value, words, sizeof(T));
+    return value;
+  }
+
+  /// Stores so far, times two
+  uint32_t sequence() const {
+    return sequence_.load(std::memory_order_acquire) & ~1u;
+  }
+
+ private:
+  static constexpr size_t kWords = (sizeof(T) + 7) / 8;
+
+  std::atomic<uint32_t> sequence_{0};
+  std::atomic<uint64_t> words_[kWords] = {};
+};
+
+}  // namespace xe
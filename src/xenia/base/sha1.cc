@@ -0,0 +1,288 @@
+/**
+ * Vera360 — Xenia Edge
+ * SHA-1 (FIPS 180-4): ARMv8 Crypto / SHA-NI / portable back-ends
+ */
+
+#include "xenia/base/sha1.h"
+
+#include <cstring>
+
+#if defined(__aarch64__) && (defined(__ARM_FEATURE_SHA2) || defined(__ARM_FEATURE_CRYPTO))
+#define XE_SHA1_ARMV8 1
+#include <arm_neon.h>
+#elif defined(__x86_64__)
+#define XE_SHA1_NI 1
+#include <immintrin.h>
+#endif
+
+namespace xe {
+
+namespace {
+
+inline uint32_t Rotl(uint32_t v, int n) { return (v << n) | (v >> (32 - n)); }
+
+inline uint32_t LoadBE32(const uint8_t* p) {
+  return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) |
+         (uint32_t(p[2]) << 8) | p[3];
+}
+
+// ── Portable ────────────────────────────────────────────────────────────────
+
+void ProcessBlocksPortable(uint32_t* state, const uint8_t* data,
+                           size_t block_count) {
+  uint32_t h0 = state[0], h1 = state[1], h2 = state[2], h3 = state[3],
+           h4 = state[4];
+  for (; block_count; --block_count, data += 64) {
+    // 16-word circular message schedule
+    uint32_t w[16];
+    for (int i = 0; i < 16; ++i) w[i] = LoadBE32(data + i * 4);
+
+    uint32_t a = h0, b = h1, c = h2, d = h3, e = h4;
+    for (int i = 0; i < 80; ++i) {
+      if (i >= 16) {
+        w[i & 15] = Rotl(w[(i + 13) & 15] ^ w[(i + 8) & 15] ^
+                             w[(i + 2) & 15] ^ w[i & 15],
+                         1);
+      }
+      uint32_t f, k;
+      if (i < 20) {
+        f = (b & c) | (~b & d);
+        k = 0x5A827999;
+      } else if (i < 40) {
+        f = b ^ c ^ d;
+        k = 0x6ED9EBA1;
+      } else if (i < 60) {
+        f = (b & c) | (b & d) | (c & d);
+        k = 0x8F1BBCDC;
+      } else {
+        f = b ^ c ^ d;
+        k = 0xCA62C1D6;
+      }
+      uint32_t t = Rotl(a, 5) + f + e + k + w[i & 15];
+      e = d;
+      d = c;
+      c = Rotl(b, 30);
+      b = a;
+      a = t;
+    }
+    h0 += a;
+    h1 += b;
+    h2 += c;
+    h3 += d;
+    h4 += e;
+  }
+  state[0] = h0;
+  state[1] = h1;
+  state[2] = h2;
+  state[3] = h3;
+  state[4] = h4;
+}
+
+// ── ARMv8 Crypto Extensions ─────────────────────────────────────────────────
+
+#if XE_SHA1_ARMV8
+
+void ProcessBlocksArm(uint32_t* state, const uint8_t* data,
+                      size_t block_count) {
+  static constexpr uint32_t kK[4] = {0x5A827999, 0x6ED9EBA1, 0x8F1BBCDC,
+                                     0xCA62C1D6};
+  uint32x4_t abcd = vld1q_u32(state);
+  uint32_t e = state[4];
+  for (; block_count; --block_count, data += 64) {
+    const uint32x4_t abcd_saved = abcd;
+    const uint32_t e_saved = e;
+    // w[j & 3] holds schedule words 4j..4j+3
+    uint32x4_t w[4];
+    for (int i = 0; i < 4; ++i) {
+      w[i] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data + i * 16)));
+    }
+    for (int g = 0; g < 20; ++g) {
+      if (g >= 4) {
+        w[g & 3] = vsha1su1q_u32(
+            vsha1su0q_u32(w[g & 3], w[(g + 1) & 3], w[(g + 2) & 3]),
+            w[(g + 3) & 3]);
+      }
+      uint32x4_t wk = vaddq_u32(w[g & 3], vdupq_n_u32(kK[g / 5]));
+      uint32_t e_next = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+      if (g < 5) {
+        abcd = vsha1cq_u32(abcd, e, wk);
+      } else if (g < 10 || g >= 15) {
+        abcd = vsha1pq_u32(abcd, e, wk);
+      } else {
+        abcd = vsha1mq_u32(abcd, e, wk);
+      }
+      e = e_next;
+    }
+    abcd = vaddq_u32(abcd, abcd_saved);
+    e += e_saved;
+  }
+  vst1q_u32(state, abcd);
+  state[4] = e;
+}
+
+#endif  // XE_SHA1_ARMV8
+
+// ── SHA-NI ──────────────────────────────────────────────────────────────────
+
+#if XE_SHA1_NI
+
+bool HasShaNi() {
+  static const bool has = [] {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sha") && __builtin_cpu_supports("sse4.1");
+  }();
+  return has;
+}
+
+#define XE_SHA1_NI_TARGET __attribute__((target("sha,sse4.1")))
+
+/// Four rounds with round function kFunc; e_in is E + W for this group.
+/// After the last group e_in is left holding the ABCD that precedes it.
+template <int kFunc>
+XE_SHA1_NI_TARGET inline void ShaNiGroup(__m128i& abcd, __m128i& e_in,
+                                         __m128i* w, int g) {
+  __m128i abcd_prev = abcd;
+  abcd = _mm_sha1rnds4_epu32(abcd, e_in, kFunc);
+  if (g == 19) {
+    e_in = abcd_prev;
+    return;
+  }
+  int j = g + 1;
+  if (j >= 4) {
+    w[j & 3] = _mm_sha1msg2_epu32(
+        _mm_xor_si128(_mm_sha1msg1_epu32(w[j & 3], w[(j + 1) & 3]),
+                      w[(j + 2) & 3]),
+        w[(j + 3) & 3]);
+  }
+  e_in = _mm_sha1nexte_epu32(abcd_prev, w[j & 3]);
+}
+
+XE_SHA1_NI_TARGET void ProcessBlocksNi(uint32_t* state, const uint8_t* data,
+                                       size_t block_count) {
+  const __m128i kByteSwap =
+      _mm_set_epi64x(0x0001020304050607ll, 0x08090A0B0C0D0E0Fll);
+  __m128i abcd = _mm_shuffle_epi32(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(state)), 0x1B);
+  __m128i e = _mm_set_epi32(static_cast<int>(state[4]), 0, 0, 0);
+  for (; block_count; --block_count, data += 64) {
+    const __m128i abcd_saved = abcd;
+    const __m128i e_saved = e;
+    __m128i w[4];
+    for (int i = 0; i < 4; ++i) {
+      w[i] = _mm_shuffle_epi8(
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i * 16)),
+          kByteSwap);
+    }
+    __m128i e_in = _mm_add_epi32(e, w[0]);
+    int g = 0;
+    for (; g < 5; ++g) ShaNiGroup<0>(abcd, e_in, w, g);
+    for (; g < 10; ++g) ShaNiGroup<1>(abcd, e_in, w, g);
+    for (; g < 15; ++g) ShaNiGroup<2>(abcd, e_in, w, g);
+    for (; g < 20; ++g) ShaNiGroup<3>(abcd, e_in, w, g);
+    // Final E is A from before the last group, rotated
+    e = _mm_sha1nexte_epu32(e_in, e_saved);
+    abcd = _mm_add_epi32(abcd, abcd_saved);
+  }
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(state),
+                   _mm_shuffle_epi32(abcd, 0x1B));
+  state[4] = static_cast<uint32_t>(_mm_extract_epi32(e, 3));
+}
+
+#undef XE_SHA1_NI_TARGET
+
+#endif  // XE_SHA1_NI
+
+}  // namespace
+
+
+void Sha1::Reset() {
+  state_[0] = 0x67452301;
+  state_[1] = 0xEFCDAB89;
+  state_[2] = 0x98BADCFE;
+  state_[3] = 0x10325476;
+  state_[4] = 0xC3D2E1F0;
+  total_length_ = 0;
+  buffer_length_ = 0;
+}
+
+void Sha1::ProcessBlocks(const uint8_t* data, size_t block_count) {
+#if XE_SHA1_ARMV8
+  ProcessBlocksArm(state_, data, block_count);
+#else
+#if XE_SHA1_NI
+  if (HasShaNi()) {
+    ProcessBlocksNi(state_, data, block_count);
+    return;
+  }
+#endif
+  ProcessBlocksPortable(state_, data, block_count);
+#endif
+}
+
+void Sha1::Update(const void* data, size_t length) {
+  auto* p = static_cast<const uint8_t*>(data);
+  total_length_ += length;
+
+  if (buffer_length_) {
+    size_t take = 64 - buffer_length_;
+    if (take > length) take = length;
+    memcpy(buffer_ + buffer_length_, p, take);
+    buffer_length_ += take;
+    p += take;
+    length -= take;
+    if (buffer_length_ < 64) return;
+    ProcessBlocks(buffer_, 1);
+    buffer_length_ = 0;
+  }
+
+  // Whole blocks straight from the caller's buffer
+  if (length >= 64) {
+    ProcessBlocks(p, length / 64);
+    p += length & ~size_t(63);
+    length &= 63;
+  }
+
+  if (length) {
+    memcpy(buffer_, p, length);
+    buffer_length_ = length;
+  }
+}
+
+void Sha1::Final(uint8_t digest[kDigestSize]) {
+  uint64_t bit_length = total_length_ * 8;
+  uint8_t pad[72] = {0x80};
+  size_t pad_length =
+      (buffer_length_ < 56 ? 56 : 120) - buffer_length_;
+  for (int i = 0; i < 8; ++i) {
+    pad[pad_length + i] = static_cast<uint8_t>(bit_length >> (56 - i * 8));
+  }
+  Update(pad, pad_length + 8);
+
+  for (int i = 0; i < 5; ++i) {
+    digest[i * 4 + 0] = static_cast<uint8_t>(state_[i] >> 24);
+    digest[i * 4 + 1] = static_cast<uint8_t>(state_[i] >> 16);
+    digest[i * 4 + 2] = static_cast<uint8_t>(state_[i] >> 8);
+    digest[i * 4 + 3] = static_cast<uint8_t>(state_[i]);
+  }
+  Reset();
+}
+
+void Sha1::Digest(const void* data, size_t length,
+                  uint8_t digest[kDigestSize]) {
+  Sha1 sha;
+  sha.Update(data, length);
+  sha.Final(digest);
+}
+
+const char* Sha1::backend_name() {
+#if XE_SHA1_ARMV8
+  return "armv8";
+#else
+#if XE_SHA1_NI
+  if (HasShaNi()) return "sha-ni";
+#endif
+  return "portable";
+#endif
+}
+
+}  // namespace xe
@@ -0,0 +1,38 @@
+/**
+ * Vera360 — Xenia Edge
+ * SHA-1 — content hashes for STFS/SVOD verification and XEX page checks
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace xe {
+
+class Sha1 {
+ public:
+  static constexpr size_t kDigestSize = 20;
+
+  Sha1() { Reset(); }
+
+  void Reset();
+  void Update(const void* data, size_t length);
+  void Final(uint8_t digest[kDigestSize]);
+
+  /// One-shot digest of a buffer
+  static void Digest(const void* data, size_t length,
+                     uint8_t digest[kDigestSize]);
+
+  /// "armv8", "sha-ni" or "portable"
+  static const char* backend_name();
+
+ private:
+  void ProcessBlocks(const uint8_t* data, size_t block_count);
+
+  uint32_t state_[5];
+  uint64_t total_length_;
+  uint8_t buffer_[64];
+  size_t buffer_length_;
+};
+
+}  // namespace xe
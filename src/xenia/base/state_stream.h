@@ -0,0 +1,112 @@
+/**
+ * Vera360 — Xenia Edge
+ * Save-state serialization streams
+ *
+ * Machine state is a sequence of tagged, length-prefixed sections written
+ * in host byte order; a reader can skip sections it does not know. Values
+ * go through Write/Read as plain bytes, so only trivially copyable types
+ * are accepted.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace xe {
+
+/// Four-character section tag
+constexpr uint32_t StateTag(const char (&name)[5]) {
+  return uint32_t(uint8_t(name[0])) | uint32_t(uint8_t(name[1])) << 8 |
+         uint32_t(uint8_t(name[2])) << 16 | uint32_t(uint8_t(name[3])) << 24;
+}
+
+class StateWriter {
+ public:
+  template <typename T>
+  void Write(const T& value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    WriteBytes(&value, sizeof(T));
+  }
+
+  void WriteBytes(const void* data, size_t size) {
+    auto* p = static_cast<const uint8_t*>(data);
+    buffer_.insert(buffer_.end(), p, p + size);
+  }
+
+  void WriteString(std::string_view s) {
+    Write(static_cast<uint32_t>(s.size()));
+    WriteBytes(s.data(), s.size());
+  }
+
+  /// Start a section; returns a token for EndSection
+  size_t BeginSection(uint32_t tag) {
+    Write(tag);
+    size_t token = buffer_.size();
+    Write(uint32_t(0));
+    return token;
+  }
+
+  /// Patch the length of the section started at token
+  void EndSection(size_t token) {
+    auto size = static_cast<uint32_t>(buffer_.size() - token - sizeof(uint32_t));
+    memcpy(&buffer_[token], &size, sizeof(size));
+  }
+
+  const std::vector<uint8_t>& data() const { return buffer_; }
+  std::vector<uint8_t> Take() { return std::move(buffer_); }
+
+ private:
+  std::vector<uint8_t> buffer_;
+};
+
+class StateReader {
+ public:
+  StateReader(const uint8_t* data, size_t size)
+      : cursor_(data), end_(data + size) {}
+
+  /// Reads past the end fail and leave the reader failed (sticky)
+  template <typename T>
+  bool Read(T* value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    return ReadBytes(value, sizeof(T));
+  }
+
+  bool ReadBytes(void* out, size_t size) {
+    if (!ok_ || size > remaining()) return ok_ = false;
+    memcpy(out, cursor_, size);
+    cursor_ += size;
+    return true;
+  }
+
+  bool ReadString(std::string* out) {
+    uint32_t size = 0;
+    if (!Read(&size) || size > remaining()) return ok_ = false;
+    out->assign(reinterpret_cast<const char*>(cursor_), size);
+    cursor_ += size;
+    return true;
+  }
+
+  /// Next section: its tag and a reader over its body
+  bool NextSection(uint32_t* tag, StateReader* section) {
+    uint32_t size = 0;
+    if (!Read(tag) || !Read(&size) || size > remaining()) return ok_ = false;
+    *section = StateReader(cursor_, size);
+    cursor_ += size;
+    return true;
+  }
+
+  bool ok() const { return ok_; }
+  size_t remaining() const { return static_cast<size_t>(end_ - cursor_); }
+
+ private:
+  const uint8_t* cursor_ = nullptr;
+  const uint8_t* end_ = nullptr;
+  bool ok_ = true;
+};
+
+}  // namespace xe
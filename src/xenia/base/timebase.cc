@@ -0,0 +1,255 @@
+/**
+ * Vera360 — Xenia Edge
+ * Guest timebase — counter selection, calibration and rebasing
+ */
+
+#include "xenia/base/timebase.h"
+
+#include <cmath>
+#include <mutex>
+
+#if defined(__x86_64__)
+#include <cpuid.h>
+#endif
+
+namespace xe::timebase {
+
+namespace {
+
+uint64_t MonotonicNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+  return uint64_t(ts.tv_sec) * 1000000000ULL + uint64_t(ts.tv_nsec);
+}
+
+/// Reads until the first parameters are published: guest time 0
+constexpr Params kBootstrap = {0, 0, 0, 32, 32, 0};
+
+}  // namespace
+
+std::atomic<const Params*> g_params{&kBootstrap};
+#if defined(__x86_64__)
+bool g_use_tsc = false;
+#endif
+
+namespace {
+
+/// Published parameters rotate through these: a reader that loaded an old
+/// pointer has seven more changes' time to finish with it, and retries if
+/// it takes longer
+constexpr uint32_t kSlots = 8;
+
+struct State {
+  std::mutex mutex;
+  Params slots[kSlots];
+  uint32_t active = 0;
+  uint64_t frequency = 1000000000ULL;
+  const char* name = "clock_gettime";
+  double scalar = 1.0;
+  bool paused = false;
+  bool instruction_clock = false;
+  /// Instructions × kGuestTickRate not yet worth a whole tick
+  uint64_t instruction_remainder = 0;
+};
+
+#if defined(__x86_64__)
+bool HasInvariantTsc() {
+  unsigned eax, ebx, ecx, edx;
+  if (!__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) || eax < 0x80000007) {
+    return false;
+  }
+  __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx);
+  return edx & (1u << 8);
+}
+
+/// One (ns, tsc) pair, taken where the two reads sit closest together
+void SamplePair(uint64_t* ns, uint64_t* tsc) {
+  uint64_t best = ~0ULL;
+  for (int i = 0; i < 8; ++i) {
+    uint64_t before = __rdtsc();
+    uint64_t now = MonotonicNs();
+    uint64_t after = __rdtsc();
+    if (after - before < best) {
+      best = after - before;
+      *ns = now;
+      *tsc = before + (after - before) / 2;
+    }
+  }
+}
+
+/// TSC ticks per second over a 10 ms window; 0 if it does not look sane
+uint64_t CalibrateTsc() {
+  uint64_t ns0, tsc0, ns1, tsc1;
+  SamplePair(&ns0, &tsc0);
+  struct timespec wait = {0, 10000000};
+  nanosleep(&wait, nullptr);
+  SamplePair(&ns1, &tsc1);
+  if (ns1 <= ns0 || tsc1 <= tsc0) return 0;
+  return uint64_t(double(tsc1 - tsc0) * 1e9 / double(ns1 - ns0) + 0.5);
+}
+#endif
+
+/// Picks the counter; guest time starts where the old clock_gettime clock
+/// would have put it, at host uptime
+State& GetState() {
+  static State* state = [] {
+    auto* s = new State();
+#if defined(__aarch64__)
+    uint64_t frequency;
+    asm volatile("mrs %0, cntfrq_el0" : "=r"(frequency));
+    s->frequency = frequency;
+    s->name = "cntvct_el0";
+#elif defined(__x86_64__)
+    if (HasInvariantTsc()) {
+      if (uint64_t frequency = CalibrateTsc()) {
+        s->frequency = frequency;
+        s->name = "rdtsc";
+        g_use_tsc = true;
+      }
+    }
+#endif
+    uint64_t ticks = uint64_t(
+        uint128_t(MonotonicNs()) * kGuestTickRate / 1000000000ULL);
+    Params& params = s->slots[0];
+    params.counter_base = ReadCounter();
+    params.tick_base = ticks;
+    params.shift = 32;
+    params.inv_shift = 32;
+    return s;
+  }();
+  return *state;
+}
+
+void StoreField(uint64_t& field, uint64_t value) {
+  __atomic_store_n(&field, value, __ATOMIC_RELAXED);
+}
+
+/// Fills the next slot so that tick is the guest time at counter, and
+/// publishes it
+void Rebase(State& s, uint64_t tick, uint64_t counter) {
+  uint64_t mult = 0;
+  uint64_t shift = 32;
+  if (!s.paused && !s.instruction_clock && s.scalar > 0) {
+    // Guest ticks per counter tick, as large a fraction as fits 63 bits
+    double ratio = double(kGuestTickRate) * s.scalar / double(s.frequency);
+    shift = 63;
+    while (shift > 1 && std::ldexp(ratio, int(shift)) >= std::ldexp(1.0, 63)) {
+      --shift;
+    }
+    mult = uint64_t(std::llround(std::ldexp(ratio, int(shift))));
+  }
+
+  uint32_t index = (s.active + 1) % kSlots;
+  Params& next = s.slots[index];
+  // Odd while the fields change, so a reader still on this slot retries
+  uint64_t sequence = next.sequence + 1;
+  StoreField(next.sequence, sequence);
+  std::atomic_thread_fence(std::memory_order_release);
+  StoreField(next.counter_base, counter);
+  StoreField(next.tick_base, tick);
+  StoreField(next.mult, mult);
+  StoreField(next.shift, shift);
+  StoreField(next.inv_shift, 64 - shift);
+  __atomic_store_n(&next.sequence, sequence + 1, __ATOMIC_RELEASE);
+  s.active = index;
+  g_params.store(&next, std::memory_order_release);
+}
+
+/// Rebase at the current counter value
+void Rebase(State& s, uint64_t tick) { Rebase(s, tick, ReadCounter()); }
+
+uint64_t CurrentTick(State& s, uint64_t counter) {
+  return Scale(s.slots[s.active], counter);
+}
+
+/// Publishes before main, so the inline read never sees the bootstrap
+/// parameters once the emulator is running
+const bool g_started = [] {
+  State& s = GetState();
+  std::lock_guard<std::mutex> lock(s.mutex);
+  Rebase(s, s.slots[s.active].tick_base);
+  return true;
+}();
+
+}  // namespace
+
+uint64_t CounterFrequency() { return GetState().frequency; }
+
+const char* CounterName() { return GetState().name; }
+
+void SetScalar(double scalar) {
+  State& s = GetState();
+  std::lock_guard<std::mutex> lock(s.mutex);
+  // One counter read for both, so no time is lost or gained in between
+  uint64_t counter = ReadCounter();
+  uint64_t tick = CurrentTick(s, counter);
+  s.scalar = scalar;
+  Rebase(s, tick, counter);
+}
+
+double GetScalar() {
+  State& s = GetState();
+  std::lock_guard<std::mutex> lock(s.mutex);
+  return s.scalar;
+}
+
+void SetTicks(uint64_t ticks) {
+  State& s = GetState();
+  std::lock_guard<std::mutex> lock(s.mutex);
+  Rebase(s, ticks);
+}
+
+void Pause() {
+  State& s = GetState();
+  std::lock_guard<std::mutex> lock(s.mutex);
+  if (s.paused) return;
+  uint64_t counter = ReadCounter();
+  uint64_t tick = CurrentTick(s, counter);
+  s.paused = true;
+  Rebase(s, tick, counter);
+}
+
+void Resume() {
+  State& s = GetState();
+  std::lock_guard<std::mutex> lock(s.mutex);
+  if (!s.paused) return;
+  uint64_t counter = ReadCounter();
+  uint64_t tick = CurrentTick(s, counter);
+  s.paused = false;
+  Rebase(s, tick, counter);
+}
+
+
+void UseInstructionClock(uint64_t ticks) {
+  State& s = GetState();
+  std::lock_guard<std::mutex> lock(s.mutex);
+  s.instruction_clock = true;
+  s.instruction_remainder = 0;
+  Rebase(s, ticks);
+}
+
+bool instruction_clock() {
+  State& s = GetState();
+  std::lock_guard<std::mutex> lock(s.mutex);
+  return s.instruction_clock;
+}
+
+void AdvanceInstructions(uint64_t count) {
+  State& s = GetState();
+  std::lock_guard<std::mutex> lock(s.mutex);
+  if (!s.instruction_clock || s.paused || !count) return;
+  uint128_t scaled =
+      uint128_t(count) * kGuestTickRate + s.instruction_remainder;
+  uint64_t ticks = uint64_t(scaled / kGuestInstructionRate);
+  s.instruction_remainder = uint64_t(scaled % kGuestInstructionRate);
+  if (ticks) Rebase(s, s.slots[s.active].tick_base + ticks);
+}
+
+void AdvanceTicks(uint64_t ticks) {
+  State& s = GetState();
+  std::lock_guard<std::mutex> lock(s.mutex);
+  if (!s.instruction_clock || s.paused || !ticks) return;
+  Rebase(s, s.slots[s.active].tick_base + ticks);
+}
+
+}  // namespace xe::timebase
@@ -0,0 +1,141 @@
+/**
+ * Vera360 — Xenia Edge
+ * Guest timebase — the Xbox 360's 49.875 MHz counter from a host counter
+ *
+ *   guest ticks = tick_base + ((counter - counter_base) * mult) >> shift
+ *
+ * counter is the cheapest monotonic counter the host has: CNTVCT_EL0 on
+ * arm64, the invariant TSC on x86-64 (calibrated against
+ * CLOCK_MONOTONIC_RAW at startup), clock_gettime nanoseconds otherwise.
+ * mult and shift fold the counter frequency, the guest rate and the time
+ * scalar into one 64×64→128-bit multiply. Every change — scalar, pause,
+ * resume, save-state restore — rebases the parameters at the current tick,
+ * so guest time never jumps; a paused clock is mult = 0.
+ *
+ * Parameters rotate through a few slots and are published by pointer, so
+ * the inline read below and the JIT's inline sequence need no lock. Each
+ * slot carries a sequence number, odd while the slot is being rewritten;
+ * a reader that held an old pointer across a whole rotation sees it change
+ * and starts over instead of mixing two parameter sets.
+ *
+ * The instruction clock (deterministic runs) leaves the host counter out:
+ * mult stays 0 and the scheduler advances tick_base by the instructions it
+ * executed, at kGuestInstructionRate, so guest time depends on nothing but
+ * the guest's own progress.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include <time.h>
+
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+namespace xe::timebase {
+
+constexpr uint64_t kGuestTickRate = 49875000ULL;  // Xbox 360 CPU timebase
+/// Instruction clock: one instruction per 3.2 GHz Xenon cycle
+constexpr uint64_t kGuestInstructionRate = 3200000000ULL;
+
+__extension__ typedef unsigned __int128 uint128_t;
+
+/// Layout is read by generated code: keep the offsets below in step
+struct Params {
+  uint64_t counter_base;
+  uint64_t tick_base;
+  uint64_t mult;
+  uint64_t shift;      // 1..63
+  uint64_t inv_shift;  // 64 - shift
+  uint64_t sequence;   // odd while being written
+};
+constexpr size_t kParamsCounterBase = 0;
+constexpr size_t kParamsTickBase = 8;
+constexpr size_t kParamsMult = 16;
+constexpr size_t kParamsShift = 24;
+constexpr size_t kParamsInvShift = 32;
+constexpr size_t kParamsSequence = 40;
+static_assert(offsetof(Params, sequence) == kParamsSequence);
+
+/// Current parameters; never null
+extern std::atomic<const Params*> g_params;
+#if defined(__x86_64__)
+/// False when the TSC is not invariant (or failed calibration)
+extern bool g_use_tsc;
+#endif
+
+/// MRS encoding of CNTVCT_EL0, for ARM64Emitter::MRS
+constexpr uint32_t kCntvctSysReg = 0xBE040;
+
+inline uint64_t ReadCounter() {
+#if defined(__aarch64__)
+  uint64_t value;
+  asm volatile("mrs %0, cntvct_el0" : "=r"(value));
+  return value;
+#else
+#if defined(__x86_64__)
+  if (g_use_tsc) return __rdtsc();
+#endif
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+  return uint64_t(ts.tv_sec) * 1000000000ULL + uint64_t(ts.tv_nsec);
+#endif
+}
+
+/// Parameter fields are rewritten under a reader's feet (see sequence)
+inline uint64_t LoadField(const uint64_t& field) {
+  return __atomic_load_n(&field, __ATOMIC_RELAXED);
+}
+
+/// A consistent copy of the current parameters
+inline Params LoadParams() {
+  for (;;) {
+    const Params* params = g_params.load(std::memory_order_acquire);
+    uint64_t sequence = __atomic_load_n(&params->sequence, __ATOMIC_ACQUIRE);
+    Params copy;
+    copy.counter_base = LoadField(params->counter_base);
+    copy.tick_base = LoadField(params->tick_base);
+    copy.mult = LoadField(params->mult);
+    copy.shift = LoadField(params->shift);
+    copy.inv_shift = LoadField(params->inv_shift);
+    copy.sequence = sequence;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (!(sequence & 1) && LoadField(params->sequence) == sequence) {
+      return copy;
+    }
+  }
+}
+
+inline uint64_t Scale(const Params& params, uint64_t counter) {
+  uint128_t product =
+      static_cast<uint128_t>(counter - params.counter_base) * params.mult;
+  return params.tick_base + static_cast<uint64_t>(product >> params.shift);
+}
+
+/// Guest ticks now: one counter read, one multiply
+inline uint64_t QueryGuestTicks() {
+  return Scale(LoadParams(), ReadCounter());
+}
+
+/// Counter ticks per second, and where they come from
+uint64_t CounterFrequency();
+const char* CounterName();
+
+// Rebasing changes; they serialize among themselves
+void SetScalar(double scalar);
+double GetScalar();
+void SetTicks(uint64_t ticks);
+void Pause();
+void Resume();
+
+// Instruction clock: guest time stops following the host counter and
+// continues from ticks. Advances are ignored while it is off or paused.
+void UseInstructionClock(uint64_t ticks);
+bool instruction_clock();
+void AdvanceInstructions(uint64_t count);
+void AdvanceTicks(uint64_t ticks);
+
+}  // namespace xe::timebase
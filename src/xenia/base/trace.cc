@@ -0,0 +1,247 @@
+/**
+ * Vera360 — Xenia Edge
+ * Trace zones — per-thread event buffers and Chrome trace export
+ */
+
+#include "xenia/base/trace.h"
+
+#include "xenia/base/clock.h"
+#include "xenia/base/logging.h"
+#include "xenia/base/threading.h"
+
+#include <pthread.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+namespace xe::trace {
+
+std::atomic<bool> g_enabled{false};
+
+namespace {
+
+constexpr uint32_t kChunksPerThread = kEventsPerThread / kEventsPerChunk;
+
+/// Written only by its thread; read by the exporter up to count. Buffers
+/// outlive their threads, so a thread that exits mid-session still shows;
+/// Start frees them.
+struct ThreadBuffer {
+  /// Chunk i holds events [i, i + 1) * kEventsPerChunk; published before
+  /// count moves into it
+  std::atomic<Event*> chunks[kChunksPerThread] = {};
+  std::atomic<uint32_t> count{0};
+  std::atomic<uint32_t> generation{0};  // session the events belong to
+  std::atomic<uint64_t> dropped{0};
+  std::atomic<bool> exited{false};
+  uint64_t thread_id = 0;
+  char thread_name[32] = {};
+
+  ~ThreadBuffer() {
+    for (auto& chunk : chunks) delete[] chunk.load(std::memory_order_relaxed);
+  }
+};
+
+struct Registry {
+  threading::Mutex mutex;
+  std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+  /// Bumped by Start; a thread clears its own buffer when it sees it move
+  std::atomic<uint32_t> generation{1};
+  uint64_t start_ns = 0;
+};
+
+Registry& GetRegistry() {
+  static Registry* registry = new Registry();
+  return *registry;
+}
+
+thread_local ThreadBuffer* t_buffer = nullptr;
+
+/// Marks the thread's buffer as reclaimable when the thread exits
+struct ThreadExit {
+  ThreadBuffer* buffer = nullptr;
+  ~ThreadExit() {
+    if (buffer) buffer->exited.store(true, std::memory_order_release);
+  }
+};
+thread_local ThreadExit t_exit;
+
+ThreadBuffer* RegisterThread() {
+  auto buffer = std::make_unique<ThreadBuffer>();
+  buffer->thread_id = threading::GetCurrentThreadId();
+  pthread_getname_np(pthread_self(), buffer->thread_name,
+                     sizeof(buffer->thread_name));
+  t_buffer = buffer.get();
+  t_exit.buffer = t_buffer;
+  Registry& registry = GetRegistry();
+  threading::LockGuard lock(registry.mutex);
+  registry.buffers.push_back(std::move(buffer));
+  return t_buffer;
+}
+
+void Record(const Event& event) {
+  ThreadBuffer* buffer = t_buffer ? t_buffer : RegisterThread();
+  uint32_t generation =
+      GetRegistry().generation.load(std::memory_order_relaxed);
+  if (buffer->generation.load(std::memory_order_relaxed) != generation) {
+    // New session: the exporter skips this buffer until generation moves,
+    // so the chunks past the first can go
+    buffer->count.store(0, std::memory_order_relaxed);
+    buffer->dropped.store(0, std::memory_order_relaxed);
+    for (uint32_t i = 1; i < kChunksPerThread; ++i) {
+      delete[] buffer->chunks[i].exchange(nullptr, std::memory_order_relaxed);
+    }
+    buffer->generation.store(generation, std::memory_order_release);
+  }
+  uint32_t index = buffer->count.load(std::memory_order_relaxed);
+  if (index >= kEventsPerThread) {
+    buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  auto& chunk = buffer->chunks[index / kEventsPerChunk];
+  Event* events = chunk.load(std::memory_order_relaxed);
+  if (!events) {
+    events = new Event[kEventsPerChunk];
+    chunk.store(events, std::memory_order_relaxed);
+  }
+  events[index % kEventsPerChunk] = event;
+  buffer->count.store(index + 1, std::memory_order_release);
+}
+
+void WriteEscaped(FILE* f, const char* text) {
+  for (const char* p = text; *p; ++p) {
+    unsigned char c = static_cast<unsigned char>(*p);
+    if (c == '"' || c == '\\') {
+      fprintf(f, "\\%c", c);
+    } else if (c < 0x20) {
+      fprintf(f, "\\u%04x", c);
+    } else {
+      fputc(c, f);
+    }
+  }
+}
+
+}  // namespace
+
+uint64_t NowNs() { return Clock::QueryHostTickCount(); }
+
+void Start() {
+  Registry& registry = GetRegistry();
+  {
+    threading::LockGuard lock(registry.mutex);
+    registry.start_ns = NowNs();
+    registry.generation.fetch_add(1, std::memory_order_relaxed);
+    // Exited threads' events are discarded with the rest; nothing writes
+    // their buffers any more
+    auto& buffers = registry.buffers;
+    buffers.erase(std::remove_if(buffers.begin(), buffers.end(),
+                                 [](const std::unique_ptr<ThreadBuffer>& b) {
+                                   return b->exited.load(
+                                       std::memory_order_acquire);
+                                 }),
+                  buffers.end());
+  }
+  g_enabled.store(true, std::memory_order_relaxed);
+  XELOGI("Trace: recording ({} events per thread)", kEventsPerThread);
+}
+
+void Stop() { g_enabled.store(false, std::memory_order_relaxed); }
+
+void RecordZone(const char* category, const char* name, uint64_t start_ns,
+                uint64_t duration_ns, uint64_t value, bool has_value) {
+  Record({category, name, start_ns, duration_ns, value, EventType::kZone,
+          has_value});
+}
+
+void RecordCounter(const char* name, uint64_t value) {
+  Record({"counter", name, NowNs(), 0, value, EventType::kCounter, true});
+}
+
+uint64_t dropped_events() {
+  Registry& registry = GetRegistry();
+  threading::LockGuard lock(registry.mutex);
+  uint32_t generation = registry.generation.load(std::memory_order_relaxed);
+  uint64_t dropped = 0;
+  for (const auto& buffer : registry.buffers) {
+    if (buffer->generation.load(std::memory_order_acquire) == generation) {
+      dropped += buffer->dropped.load(std::memory_order_relaxed);
+    }
+  }
+  return dropped;
+}
+
+bool WriteChromeTrace(const std::string& path) {
+  FILE* f = fopen(path.c_str(), "w");
+  if (!f) {
+    XELOGE("Trace: cannot write {}", path);
+    return false;
+  }
+  Registry& registry = GetRegistry();
+  threading::LockGuard lock(registry.mutex);
+  uint32_t generation = registry.generation.load(std::memory_order_relaxed);
+  int pid = static_cast<int>(getpid());
+  uint64_t events = 0;
+  uint64_t dropped = 0;
+
+  fprintf(f, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+  fprintf(f, "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":%d,"
+             "\"args\":{\"name\":\"vera360\"}}",
+          pid);
+  for (const auto& buffer : registry.buffers) {
+    if (buffer->generation.load(std::memory_order_acquire) != generation) {
+      continue;
+    }
+    uint32_t count = buffer->count.load(std::memory_order_acquire);
+    if (!count) continue;
+    dropped += buffer->dropped.load(std::memory_order_relaxed);
+    uint64_t tid = buffer->thread_id;
+    fprintf(f, ",\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":%d,"
+               "\"tid\":%" PRIu64 ",\"args\":{\"name\":\"",
+            pid, tid);
+    WriteEscaped(f, buffer->thread_name[0] ? buffer->thread_name : "thread");
+    fprintf(f, "\"}}");
+
+    for (uint32_t i = 0; i < count; ++i) {
+      const Event& e =
+          buffer->chunks[i / kEventsPerChunk].load(
+              std::memory_order_relaxed)[i % kEventsPerChunk];
+      // Microseconds since Start, to the nanosecond
+      uint64_t ts = e.start_ns - std::min(e.start_ns, registry.start_ns);
+      if (e.type == EventType::kCounter) {
+        fprintf(f, ",\n{\"ph\":\"C\",\"name\":\"");
+        WriteEscaped(f, e.name);
+        fprintf(f, "\",\"pid\":%d,\"tid\":%" PRIu64 ",\"ts\":%" PRIu64
+                   ".%03u,\"args\":{\"value\":%" PRIu64 "}}",
+                pid, tid, ts / 1000, unsigned(ts % 1000), e.value);
+      } else {
+        fprintf(f, ",\n{\"ph\":\"X\",\"cat\":\"");
+        WriteEscaped(f, e.category);
+        fprintf(f, "\",\"name\":\"");
+        WriteEscaped(f, e.name);
+        fprintf(f, "\",\"pid\":%d,\"tid\":%" PRIu64 ",\"ts\":%" PRIu64
+                   ".%03u,\"dur\":%" PRIu64 ".%03u",
+                pid, tid, ts / 1000, unsigned(ts % 1000),
+                e.duration_ns / 1000, unsigned(e.duration_ns % 1000));
+        if (e.has_value) {
+          fprintf(f, ",\"args\":{\"value\":%" PRIu64 "}", e.value);
+        }
+        fprintf(f, "}");
+      }
+    }
+    events += count;
+  }
+  fprintf(f, "\n]}\n");
+  bool ok = !ferror(f);
+  ok = (fclose(f) == 0) && ok;
+  if (!ok) {
+    XELOGE("Trace: write to {} failed", path);
+    return false;
+  }
+  XELOGI("Trace: {} events to {} ({} dropped)", events, path, dropped);
+  return true;
+}
+
+}  // namespace xe::trace
@@ -0,0 +1,120 @@
+/**
+ * Vera360 — Xenia Edge
+ * Trace zones — where a frame's time goes, across threads and subsystems
+ *
+ *   XE_TRACE_ZONE("gpu", "ProcessRingBuffer");
+ *   XE_TRACE_ZONE_VALUE("kernel", "export", ordinal);
+ *   XE_TRACE_COUNTER("draws", draw_count);
+ *
+ * A zone times its enclosing scope. Events go to a buffer owned by the
+ * recording thread, allocated in chunks as it fills: no lock, one
+ * allocation per kEventsPerChunk events, and a full buffer drops events
+ * (and counts them) rather than wrapping. A new session trims each buffer
+ * back to one chunk, and frees those of threads that have exited.
+ * Categories and names must be string literals — only the pointer is
+ * stored.
+ *
+ * The macros compile to nothing unless the build sets XE_TRACE
+ * (-DVERA360_TRACE=ON); with it, they cost one relaxed load while tracing
+ * is stopped. WriteChromeTrace emits the Chrome trace event JSON that
+ * chrome://tracing and ui.perfetto.dev both open.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace xe::trace {
+
+enum class EventType : uint8_t {
+  kZone,     // complete event: start and duration
+  kCounter,  // value at a point in time
+};
+
+struct Event {
+  const char* category;
+  const char* name;
+  uint64_t start_ns;
+  uint64_t duration_ns;
+  uint64_t value;
+  EventType type;
+  bool has_value;
+};
+
+/// Events a thread can record between Start and WriteChromeTrace
+constexpr uint32_t kEventsPerThread = 1u << 17;
+/// Buffer growth step
+constexpr uint32_t kEventsPerChunk = 1u << 12;
+
+extern std::atomic<bool> g_enabled;
+
+inline bool enabled() { return g_enabled.load(std::memory_order_relaxed); }
+
+/// Discards what earlier sessions recorded and starts recording. Not while
+/// WriteChromeTrace runs.
+void Start();
+void Stop();
+
+/// Every thread's events since Start, plus thread names. Call after Stop,
+/// or accept that events still being recorded may be missed.
+bool WriteChromeTrace(const std::string& path);
+
+/// Events lost to full buffers since Start
+uint64_t dropped_events();
+
+uint64_t NowNs();
+void RecordZone(const char* category, const char* name, uint64_t start_ns,
+                uint64_t duration_ns, uint64_t value, bool has_value);
+void RecordCounter(const char* name, uint64_t value);
+
+class Zone {
+ public:
+  Zone(const char* category, const char* name)
+      : category_(category), name_(name) {
+    if (enabled()) start_ns_ = NowNs();
+  }
+  Zone(const char* category, const char* name, uint64_t value)
+      : category_(category), name_(name), value_(value), has_value_(true) {
+    if (enabled()) start_ns_ = NowNs();
+  }
+  ~Zone() {
+    if (start_ns_ && enabled()) {
+      RecordZone(category_, name_, start_ns_, NowNs() - start_ns_, value_,
+                 has_value_);
+    }
+  }
+
+  Zone(const Zone&) = delete;
+  Zone& operator=(const Zone&) = delete;
+
+ private:
+  const char* category_;
+  const char* name_;
+  uint64_t start_ns_ = 0;  // 0: tracing was off at entry
+  uint64_t value_ = 0;
+  bool has_value_ = false;
+};
+
+}  // namespace xe::trace
+
+#define XE_TRACE_CONCAT_(a, b) a##b
+#define XE_TRACE_CONCAT(a, b) XE_TRACE_CONCAT_(a, b)
+
+#if defined(XE_TRACE)
+#define XE_TRACE_ZONE(category, name) \
+  ::xe::trace::Zone XE_TRACE_CONCAT(xe_trace_zone_, __LINE__)(category, name)
+#define XE_TRACE_ZONE_VALUE(category, name, value)               \
+  ::xe::trace::Zone XE_TRACE_CONCAT(xe_trace_zone_, __LINE__)(   \
+      category, name, static_cast<uint64_t>(value))
+#define XE_TRACE_COUNTER(name, value)                                 \
+  do {                                                                \
+    if (::xe::trace::enabled()) {                                     \
+      ::xe::trace::RecordCounter(name, static_cast<uint64_t>(value)); \
+    }                                                                 \
+  } while (0)
+#else
+#define XE_TRACE_ZONE(category, name) ((void)0)
+#define XE_TRACE_ZONE_VALUE(category, name, value) ((void)0)
+#define XE_TRACE_COUNTER(name, value) ((void)0)
+#endif
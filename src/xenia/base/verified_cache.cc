@@ -0,0 +1,70 @@
+/**
+ * Vera360 — Xenia Edge
+ * Verified-content cache implementation
+ */
+
+#include "xenia/base/verified_cache.h"
+#include "xenia/base/logging.h"
+
+#include <sys/stat.h>
+#include <fstream>
+
+namespace xe {
+
+VerifiedCache& VerifiedCache::Get() {
+  static VerifiedCache instance;
+  return instance;
+}
+
+void VerifiedCache::Open(const std::string& path) {
+  xe::threading::LockGuard lock(mutex_);
+  path_ = path;
+  std::ifstream f(path, std::ios::binary);
+  if (!f.is_open()) return;
+  char record[Sha1::kDigestSize];
+  while (f.read(record, sizeof(record))) {
+    entries_.emplace(record, sizeof(record));
+  }
+  XELOGD("Verified cache: {} entries from {}", entries_.size(), path);
+}
+
+std::string VerifiedCache::FileIdentity(const std::string& path) {
+  struct stat st;
+  if (path.empty() || stat(path.c_str(), &st) != 0) return {};
+  return path + '|' + std::to_string(st.st_size) + '|' +
+         std::to_string(st.st_mtim.tv_sec) + '.' +
+         std::to_string(st.st_mtim.tv_nsec) + '|' +
+         std::to_string(st.st_ino);
+}
+
+VerifiedCache::Key VerifiedCache::MakeKey(const std::string& identity,
+                                          const std::string& scope,
+                                          const uint8_t* root,
+                                          size_t root_size) {
+  if (identity.empty()) return {};
+  Sha1 sha;
+  sha.Update(identity.data(), identity.size());
+  sha.Update("\0", 1);
+  sha.Update(scope.data(), scope.size());
+  sha.Update("\0", 1);
+  sha.Update(root, root_size);
+  uint8_t digest[Sha1::kDigestSize];
+  sha.Final(digest);
+  return Key(reinterpret_cast<const char*>(digest), sizeof(digest));
+}
+
+bool VerifiedCache::Contains(const Key& key) {
+  if (key.empty()) return false;
+  xe::threading::LockGuard lock(mutex_);
+  return entries_.count(key) != 0;
+}
+
+void VerifiedCache::Insert(const Key& key) {
+  if (key.empty()) return;
+  xe::threading::LockGuard lock(mutex_);
+  if (!entries_.insert(key).second || path_.empty()) return;
+  std::ofstream f(path_, std::ios::binary | std::ios::app);
+  if (f.is_open()) f.write(key.data(), static_cast<std::streamsize>(key.size()));
+}
+
+}  // namespace xe
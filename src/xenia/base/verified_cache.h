@@ -0,0 +1,51 @@
+/**
+ * Vera360 — Xenia Edge
+ * Verified-content cache — remembers which images passed hash verification
+ *
+ * Keys are SHA-1s of (file identity, content root hash): the identity
+ * (path, size, mtime, inode) changes whenever the file is replaced or
+ * rewritten, so a hit means this exact file was checked on an earlier run.
+ * Entries are appended to a small file under the storage root.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_set>
+
+#include "xenia/base/sha1.h"
+#include "xenia/base/threading.h"
+
+namespace xe {
+
+class VerifiedCache {
+ public:
+  using Key = std::string;  // kDigestSize raw bytes
+
+  static VerifiedCache& Get();
+
+  /// Load the entries stored at path; later inserts are appended to it.
+  /// Without a path the cache only lasts for this run.
+  void Open(const std::string& path);
+
+  /// Identity of a file on disk, empty if it cannot be stat'ed
+  static std::string FileIdentity(const std::string& path);
+
+  /// Key for content with root hash root, read from the file identified by
+  /// identity. An empty identity yields an empty key (never cached).
+  static Key MakeKey(const std::string& identity, const std::string& scope,
+                     const uint8_t* root, size_t root_size);
+
+  bool Contains(const Key& key);
+  void Insert(const Key& key);
+
+ private:
+  VerifiedCache() = default;
+
+  xe::threading::Mutex mutex_;
+  std::unordered_set<Key> entries_;
+  std::string path_;
+};
+
+}  // namespace xe
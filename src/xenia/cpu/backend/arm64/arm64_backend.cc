@@ -5,10 +5,13 @@
 
 #include "xenia/cpu/backend/arm64/arm64_backend.h"
 #include "xenia/cpu/backend/arm64/arm64_sequences.h"
+#include "xenia/cpu/backend/perf_jit.h"
 #include "xenia/base/memory/memory.h"
 #include "xenia/base/logging.h"
 
 #include <cstring>
+#include <utility>
+#include <vector>
 
 namespace xe::cpu::backend::arm64 {
 
@@ -18,6 +21,7 @@ ARM64Backend::~ARM64Backend() { Shutdown(); }
 bool ARM64Backend::Initialize() {
   XELOGI("ARM64 JIT backend initialized");
   XELOGI("  Register mapping: X8=guestmem, X9=ctx, X19-X28=PPC GPR");
+  PerfJit::Get().Initialize();
   return true;
 }
 
@@ -55,8 +59,14 @@ CodeBlock* ARM64Backend::CompileFunction(uint32_t guest_address) {
   uint32_t pc = guest_address;
   uint32_t function_size = 0;
   bool done = false;
+  // Host offset of each guest instruction, for profiler line info
+  PerfJit& perf = PerfJit::Get();
+  std::vector<std::pair<uint32_t, uint32_t>> lines;
 
   while (!done && function_size < 0x10000) {  // Max 64KB per function
+    if (perf.wants_lines()) {
+      lines.emplace_back(static_cast<uint32_t>(emitter_.GetCodeSize()), pc);
+    }
     uint32_t ppc_instr;
     memcpy(&ppc_instr, guest_base + pc, sizeof(uint32_t));
     
@@ -104,6 +114,16 @@ CodeBlock* ARM64Backend::CompileFunction(uint32_t guest_address) {
   total_compiled_++;
   total_code_size_ += result->host_code_size;
 
+  if (perf.enabled()) {
+    JitCodeRecord record;
+    record.host_code = result->host_code;
+    record.host_size = result->host_code_size;
+    record.guest_address = guest_address;
+    record.guest_size = function_size;
+    record.lines = &lines;
+    perf.RecordCode(record);
+  }
+
   XELOGD("Compiled PPC 0x{:08X} ({} bytes) → ARM64 ({} bytes)",
          guest_address, function_size, result->host_code_size);
 
@@ -30,6 +30,7 @@ struct RegisterAllocation {
   static constexpr Reg kScratch1     = Reg::X11;
   static constexpr Reg kScratch2     = Reg::X12;
   static constexpr Reg kScratch3     = Reg::X13;
+  static constexpr Reg kScratch4     = Reg::X14;
 
   // PPC GPR mapping: r3-r12 are hot (function args + temporaries)
   // Map to callee-saved X19-X28 for persistence across calls
@@ -10,6 +10,7 @@
 #include "xenia/cpu/backend/arm64/arm64_sequences.h"
 #include "xenia/cpu/backend/arm64/arm64_backend.h"
 #include "xenia/base/logging.h"
+#include "xenia/base/timebase.h"
 
 namespace xe::cpu::backend::arm64 {
 
@@ -248,6 +249,7 @@ bool ARM64Sequences::Emit(ARM64Emitter& e, uint32_t guest_addr, uint32_t instr)
         case 339: return Emit_MFSPR(e, instr);
         case 341: return Emit_LWAX(e, instr);
         case 343: return Emit_LHAX(e, instr);
+        case 371: return Emit_MFTB(e, instr);
         case 407: return Emit_STHX(e, instr);
         case 412: return Emit_ORC_XO(e, instr);
         case 439: return Emit_STHUX(e, instr);
@@ -1650,6 +1652,7 @@ bool ARM64Sequences::Emit_SC(ARM64Emitter& e, uint32_t i) {
 
 bool ARM64Sequences::Emit_MFSPR(ARM64Emitter& e, uint32_t i) {
   uint32_t spr = ((PPC_RA(i) & 0x1F) << 5) | (PPC_RB(i) & 0x1F);
+  if (spr == 268 || spr == 269) return Emit_MFTB(e, i);
   int32_t offset;
   switch (spr) {
     case 8:   offset = kCtxLR;  break; // LR
@@ -1662,6 +1665,47 @@ bool ARM64Sequences::Emit_MFSPR(ARM64Emitter& e, uint32_t i) {
   return true;
 }
 
+/// Guest timebase inline (timebase.h): CNTVCT_EL0 scaled by the published
+/// parameters, no call out. Like timebase::LoadParams, starts over if the
+/// slot's sequence is odd or moved while the fields were read.
+bool ARM64Sequences::Emit_MFTB(ARM64Emitter& e, uint32_t i) {
+  uint32_t tbr = ((PPC_RA(i) & 0x1F) << 5) | (PPC_RB(i) & 0x1F);
+  auto offset = [](size_t field) { return static_cast<int32_t>(field); };
+  auto back_to = [&e](size_t target) {
+    return static_cast<int32_t>(target) - static_cast<int32_t>(e.GetOffset());
+  };
+  size_t retry = e.GetOffset();
+  e.MOV_imm(R::kScratch0, reinterpret_cast<uint64_t>(&timebase::g_params));
+  e.LDR(R::kScratch0, R::kScratch0);  // params; loads below depend on it
+  e.LDR(R::kScratch4, R::kScratch0, offset(timebase::kParamsSequence));
+  e.DMB_ISH();  // sequence before the fields
+  e.MRS(R::kScratch1, timebase::kCntvctSysReg);
+  e.LDR(R::kScratch2, R::kScratch0, offset(timebase::kParamsCounterBase));
+  e.SUB(R::kScratch1, R::kScratch1, R::kScratch2);
+  // 128-bit delta * mult, shifted right: (hi << (64 - shift)) | (lo >> shift)
+  e.LDR(R::kScratch2, R::kScratch0, offset(timebase::kParamsMult));
+  e.MUL(R::kScratch3, R::kScratch1, R::kScratch2);
+  e.UMULH(R::kScratch1, R::kScratch1, R::kScratch2);
+  e.LDR(R::kScratch2, R::kScratch0, offset(timebase::kParamsShift));
+  e.LSR_reg(R::kScratch3, R::kScratch3, R::kScratch2);
+  e.LDR(R::kScratch2, R::kScratch0, offset(timebase::kParamsInvShift));
+  e.LSL_reg(R::kScratch1, R::kScratch1, R::kScratch2);
+  e.ORR(R::kScratch1, R::kScratch1, R::kScratch3);
+  e.LDR(R::kScratch2, R::kScratch0, offset(timebase::kParamsTickBase));
+  e.ADD(R::kScratch1, R::kScratch1, R::kScratch2);
+  e.DMB_ISH();  // the fields before the sequence check
+  e.LDR(R::kScratch2, R::kScratch0, offset(timebase::kParamsSequence));
+  e.CMP(R::kScratch2, R::kScratch4);
+  e.B(Cond::NE, back_to(retry));
+  e.ADD(R::kScratch2, Reg::XZR, R::kScratch4, Shift::LSL, 63);  // odd bit
+  e.CBNZ(R::kScratch2, back_to(retry));
+  if (tbr == 269) {  // TBU
+    e.ADD(R::kScratch1, Reg::XZR, R::kScratch1, Shift::LSR, 32);
+  }
+  StoreGPR(e, PPC_RD(i), R::kScratch1);
+  return true;
+}
+
 bool ARM64Sequences::Emit_MTSPR(ARM64Emitter& e, uint32_t i) {
   uint32_t spr = ((PPC_RA(i) & 0x1F) << 5) | (PPC_RB(i) & 0x1F);
   Reg s = MapGPR(e, PPC_RS(i));
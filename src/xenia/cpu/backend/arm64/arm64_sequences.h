@@ -247,6 +247,7 @@ class ARM64Sequences {
   // ── System & SPR ──────────────────────────────────────────────────────
   static bool Emit_SC(ARM64Emitter& e, uint32_t i);
   static bool Emit_MFSPR(ARM64Emitter& e, uint32_t i);
+  static bool Emit_MFTB(ARM64Emitter& e, uint32_t i);
   static bool Emit_MTSPR(ARM64Emitter& e, uint32_t i);
   static bool Emit_MFCR(ARM64Emitter& e, uint32_t i);
   static bool Emit_MTCRF(ARM64Emitter& e, uint32_t i);
@@ -0,0 +1,254 @@
+/**
+ * Vera360 — Xenia Edge
+ * Host profiler symbols for JIT code — implementation
+ */
+
+#include "xenia/cpu/backend/perf_jit.h"
+#include "xenia/cpu/guest_function_map.h"
+#include "xenia/base/cvar.h"
+#include "xenia/base/logging.h"
+#include "xenia/base/memory/memory.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+
+namespace xe::cpu::frontend {
+std::string DisassemblePPC(uint32_t address, uint32_t code);
+}
+
+namespace xe::cpu::backend {
+
+DEFINE_bool(jit_perf_map, false,
+            "Write perf-<pid>.map symbols for JIT-compiled guest functions");
+DEFINE_bool(jit_dump, false,
+            "Write a perf jitdump (code and guest line info) for "
+            "JIT-compiled guest functions");
+#if defined(__ANDROID__)
+DEFINE_string(jit_perf_dir, "/data/local/tmp",
+              "Directory for jit_perf_map and jit_dump output");
+#else
+DEFINE_string(jit_perf_dir, "/tmp",
+              "Directory for jit_perf_map and jit_dump output");
+#endif
+
+namespace {
+
+// ── jitdump format (tools/perf/Documentation/jitdump-specification.txt) ──
+
+constexpr uint32_t kJitDumpMagic = 0x4A695444;  // "JiTD", host order
+constexpr uint32_t kJitDumpVersion = 1;
+constexpr uint32_t kJitCodeLoad = 0;
+constexpr uint32_t kJitCodeDebugInfo = 2;
+
+#if defined(__aarch64__)
+constexpr uint32_t kElfMachine = 183;  // EM_AARCH64
+#elif defined(__x86_64__)
+constexpr uint32_t kElfMachine = 62;   // EM_X86_64
+#else
+constexpr uint32_t kElfMachine = 0;
+#endif
+
+struct JitDumpHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t total_size;
+  uint32_t elf_mach;
+  uint32_t pad1;
+  uint32_t pid;
+  uint64_t timestamp;
+  uint64_t flags;
+};
+
+struct JitRecordHeader {
+  uint32_t id;
+  uint32_t total_size;
+  uint64_t timestamp;
+};
+
+/// perf record -k mono stamps samples with this clock
+uint64_t MonotonicNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return uint64_t(ts.tv_sec) * 1000000000ULL + uint64_t(ts.tv_nsec);
+}
+
+template <typename T>
+void Append(std::vector<uint8_t>& out, const T& value) {
+  const auto* p = reinterpret_cast<const uint8_t*>(&value);
+  out.insert(out.end(), p, p + sizeof(T));
+}
+
+void AppendString(std::vector<uint8_t>& out, const std::string& text) {
+  out.insert(out.end(), text.begin(), text.end());
+  out.push_back(0);
+}
+
+bool WriteAll(int fd, const void* data, size_t size) {
+  const auto* p = static_cast<const uint8_t*>(data);
+  while (size) {
+    ssize_t written = write(fd, p, size);
+    if (written <= 0) return false;
+    p += written;
+    size -= size_t(written);
+  }
+  return true;
+}
+
+}  // namespace
+
+PerfJit& PerfJit::Get() {
+  static PerfJit instance;
+  return instance;
+}
+
+void PerfJit::Initialize() {
+  threading::LockGuard lock(mutex_);
+  if (initialized_) return;
+  initialized_ = true;
+  std::string dir = cvars.GetValue<std::string>("jit_perf_dir", "/tmp");
+  bool ok = false;
+  if (cvars.GetValue<bool>("jit_perf_map", false)) ok |= OpenPerfMap(dir);
+  if (cvars.GetValue<bool>("jit_dump", false)) ok |= OpenJitDump(dir);
+  enabled_.store(ok, std::memory_order_relaxed);
+}
+
+bool PerfJit::OpenPerfMap(const std::string& dir) {
+  std::string path = dir + "/perf-" + std::to_string(getpid()) + ".map";
+  perf_map_ = fopen(path.c_str(), "w");
+  if (!perf_map_) {
+    XELOGW("JIT perf map: cannot write {}: {}", path, strerror(errno));
+    return false;
+  }
+  XELOGI("JIT perf map: {}", path);
+  return true;
+}
+
+bool PerfJit::OpenJitDump(const std::string& dir) {
+  std::string pid = std::to_string(getpid());
+  std::string path = dir + "/jit-" + pid + ".dump";
+  int fd = open(path.c_str(), O_CREAT | O_TRUNC | O_RDWR | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    XELOGW("JIT dump: cannot write {}: {}", path, strerror(errno));
+    return false;
+  }
+  // perf finds the dump through this mapping's mmap event; it stays
+  // mapped for the life of the process
+  long page = sysconf(_SC_PAGESIZE);
+  void* marker = mmap(nullptr, size_t(page), PROT_READ | PROT_EXEC,
+                      MAP_PRIVATE, fd, 0);
+  if (marker == MAP_FAILED) {
+    XELOGW("JIT dump: cannot map {}: {}", path, strerror(errno));
+    close(fd);
+    return false;
+  }
+  JitDumpHeader header = {};
+  header.magic = kJitDumpMagic;
+  header.version = kJitDumpVersion;
+  header.total_size = sizeof(header);
+  header.elf_mach = kElfMachine;
+  header.pid = uint32_t(getpid());
+  header.timestamp = MonotonicNs();
+  if (!WriteAll(fd, &header, sizeof(header))) {
+    XELOGW("JIT dump: write to {} failed", path);
+    munmap(marker, size_t(page));
+    close(fd);
+    return false;
+  }
+  jitdump_fd_ = fd;
+  listing_dir_ = dir + "/jit-" + pid;
+  if (mkdir(listing_dir_.c_str(), 0755) != 0 && errno != EEXIST) {
+    XELOGW("JIT dump: no guest listings, cannot create {}", listing_dir_);
+    listing_dir_.clear();
+  }
+  XELOGI("JIT dump: {}", path);
+  return true;
+}
+
+void PerfJit::RecordCode(const JitCodeRecord& code) {
+  if (!enabled() || !code.host_code || !code.host_size) return;
+  std::string name = GuestFunctionMap::Name(code.guest_address);
+  threading::LockGuard lock(mutex_);
+  if (perf_map_) {
+    fprintf(perf_map_, "%llx %zx %s\n",
+            static_cast<unsigned long long>(
+                reinterpret_cast<uintptr_t>(code.host_code)),
+            code.host_size, name.c_str());
+    fflush(perf_map_);
+  }
+  if (jitdump_fd_ >= 0) WriteJitDump(code, name);
+}
+
+void PerfJit::WriteJitDump(const JitCodeRecord& code,
+                           const std::string& name) {
+  auto host = reinterpret_cast<uint64_t>(code.host_code);
+  uint64_t timestamp = MonotonicNs();
+  std::vector<uint8_t> out;
+
+  // Debug info goes first: perf attaches it to the next code load
+  std::string listing = WriteListing(code, name);
+  if (!listing.empty() && code.lines && !code.lines->empty()) {
+    size_t start = out.size();
+    Append(out, JitRecordHeader{kJitCodeDebugInfo, 0, timestamp});
+    Append(out, host);
+    Append(out, uint64_t(code.lines->size()));
+    for (const auto& [offset, guest] : *code.lines) {
+      Append(out, host + offset);
+      Append(out, uint32_t((guest - code.guest_address) / 4 + 1));  // line
+      Append(out, uint32_t(0));                                     // discrim
+      AppendString(out, listing);
+    }
+    uint32_t size = uint32_t(out.size() - start);
+    memcpy(&out[start + offsetof(JitRecordHeader, total_size)], &size,
+           sizeof(size));
+  }
+
+  size_t start = out.size();
+  Append(out, JitRecordHeader{kJitCodeLoad, 0, timestamp});
+  Append(out, uint32_t(getpid()));
+  Append(out, uint32_t(threading::GetCurrentThreadId()));
+  Append(out, host);                      // vma
+  Append(out, host);                      // code_addr
+  Append(out, uint64_t(code.host_size));
+  Append(out, code_index_++);
+  AppendString(out, name);
+  const auto* bytes = static_cast<const uint8_t*>(code.host_code);
+  out.insert(out.end(), bytes, bytes + code.host_size);
+  uint32_t size = uint32_t(out.size() - start);
+  memcpy(&out[start + offsetof(JitRecordHeader, total_size)], &size,
+         sizeof(size));
+
+  if (!WriteAll(jitdump_fd_, out.data(), out.size())) {
+    XELOGW("JIT dump: write failed, no more records");
+    close(jitdump_fd_);
+    jitdump_fd_ = -1;
+    enabled_.store(perf_map_ != nullptr, std::memory_order_relaxed);
+  }
+}
+
+std::string PerfJit::WriteListing(const JitCodeRecord& code,
+                                  const std::string& name) {
+  uint8_t* guest_base = xe::memory::GetGuestBase();
+  if (listing_dir_.empty() || !guest_base) return {};
+  std::string path = listing_dir_ + "/" + name + ".ppc";
+  FILE* f = fopen(path.c_str(), "w");
+  if (!f) return {};
+  for (uint32_t offset = 0; offset < code.guest_size; offset += 4) {
+    uint32_t address = code.guest_address + offset;
+    uint32_t word;
+    memcpy(&word, guest_base + address, sizeof(word));
+    fprintf(f, "%s\n",
+            frontend::DisassemblePPC(address, __builtin_bswap32(word)).c_str());
+  }
+  bool ok = !ferror(f);
+  ok = (fclose(f) == 0) && ok;
+  return ok ? path : std::string();
+}
+
+}  // namespace xe::cpu::backend
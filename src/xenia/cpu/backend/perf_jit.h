@@ -0,0 +1,77 @@
+/**
+ * Vera360 — Xenia Edge
+ * Host profiler symbols for JIT code — perf map and jitdump
+ *
+ * Without these, perf and simpleperf see compiled guest code as anonymous
+ * executable memory. Each backend reports every function it compiles:
+ *
+ *   jit_perf_map  <dir>/perf-<pid>.map, "start size guest_82001234" per
+ *                 function: perf report and simpleperf report pick it up
+ *                 by pid
+ *   jit_dump      <dir>/jit-<pid>.dump in perf's jitdump format, with the
+ *                 code bytes, plus a PPC listing per function under
+ *                 <dir>/jit-<pid>/ that the debug info points each host
+ *                 instruction at. Record with perf record -k mono, then
+ *                 perf inject --jit, and perf annotate shows the guest
+ *                 instruction each host instruction came from.
+ *
+ * <dir> is jit_perf_dir: /tmp on Linux, /data/local/tmp on Android (where
+ * simpleperf looks; the app needs it writable, e.g. a debuggable build run
+ * through run-as).
+ */
+#pragma once
+
+#include "xenia/base/threading.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace xe::cpu::backend {
+
+struct JitCodeRecord {
+  const void* host_code = nullptr;
+  size_t host_size = 0;
+  uint32_t guest_address = 0;
+  uint32_t guest_size = 0;
+  /// Host code offset where each guest instruction starts, ascending.
+  /// Optional; only jitdump uses it.
+  const std::vector<std::pair<uint32_t, uint32_t>>* lines = nullptr;
+};
+
+class PerfJit {
+ public:
+  static PerfJit& Get();
+
+  /// Opens what the cvars ask for; later calls do nothing
+  void Initialize();
+
+  bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+  /// Whether RecordCode uses JitCodeRecord::lines
+  bool wants_lines() const { return jitdump_fd_ >= 0; }
+
+  /// Any thread; call once the code is in its final place
+  void RecordCode(const JitCodeRecord& code);
+
+ private:
+  PerfJit() = default;
+  bool OpenPerfMap(const std::string& dir);
+  bool OpenJitDump(const std::string& dir);
+  void WriteJitDump(const JitCodeRecord& code, const std::string& name);
+  /// The function's PPC listing, one instruction per line; its path
+  std::string WriteListing(const JitCodeRecord& code, const std::string& name);
+
+  threading::Mutex mutex_;
+  bool initialized_ = false;
+  std::atomic<bool> enabled_{false};
+  FILE* perf_map_ = nullptr;
+  int jitdump_fd_ = -1;
+  std::string listing_dir_;
+  uint64_t code_index_ = 0;
+};
+
+}  // namespace xe::cpu::backend
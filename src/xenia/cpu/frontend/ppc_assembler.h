@@ -0,0 +1,267 @@
+/**
+ * Vera360 — Xenia Edge
+ * PPC instruction encoder — builds guest code for tools and benchmarks
+ *
+ * One function per instruction, named after the mnemonic (with a trailing
+ * underscore where the mnemonic is a C++ keyword or ends in '.'), operands
+ * in assembler order. Branch displacements are in bytes, relative to the
+ * branch itself.
+ */
+#pragma once
+
+#include <cstdint>
+
+namespace xe::cpu::frontend::ppc_asm {
+
+// ── Forms ────────────────────────────────────────────────────────────────────
+
+constexpr uint32_t DForm(uint32_t op, uint32_t rt, uint32_t ra, int32_t d) {
+  return (op << 26) | (rt << 21) | (ra << 16) | (uint32_t(d) & 0xFFFF);
+}
+constexpr uint32_t XForm(uint32_t rt, uint32_t ra, uint32_t rb, uint32_t xo,
+                         uint32_t rc = 0) {
+  return (31u << 26) | (rt << 21) | (ra << 16) | (rb << 11) | (xo << 1) | rc;
+}
+constexpr uint32_t VXForm(uint32_t vd, uint32_t va, uint32_t vb,
+                          uint32_t xo) {
+  return (4u << 26) | (vd << 21) | (va << 16) | (vb << 11) | xo;
+}
+constexpr uint32_t VAForm(uint32_t vd, uint32_t va, uint32_t vb, uint32_t vc,
+                          uint32_t xo) {
+  return (4u << 26) | (vd << 21) | (va << 16) | (vb << 11) | (vc << 6) | xo;
+}
+
+// ── Integer ──────────────────────────────────────────────────────────────────
+
+constexpr uint32_t addi(uint32_t rd, uint32_t ra, int32_t simm) {
+  return DForm(14, rd, ra, simm);
+}
+constexpr uint32_t addis(uint32_t rd, uint32_t ra, int32_t simm) {
+  return DForm(15, rd, ra, simm);
+}
+constexpr uint32_t li(uint32_t rd, int32_t simm) { return addi(rd, 0, simm); }
+constexpr uint32_t lis(uint32_t rd, int32_t simm) { return addis(rd, 0, simm); }
+constexpr uint32_t mulli(uint32_t rd, uint32_t ra, int32_t simm) {
+  return DForm(7, rd, ra, simm);
+}
+constexpr uint32_t ori(uint32_t ra, uint32_t rs, uint32_t uimm) {
+  return DForm(24, rs, ra, int32_t(uimm));
+}
+constexpr uint32_t oris(uint32_t ra, uint32_t rs, uint32_t uimm) {
+  return DForm(25, rs, ra, int32_t(uimm));
+}
+constexpr uint32_t andi_(uint32_t ra, uint32_t rs, uint32_t uimm) {
+  return DForm(28, rs, ra, int32_t(uimm));
+}
+constexpr uint32_t nop() { return ori(0, 0, 0); }
+
+constexpr uint32_t add(uint32_t rd, uint32_t ra, uint32_t rb) {
+  return XForm(rd, ra, rb, 266);
+}
+constexpr uint32_t subf(uint32_t rd, uint32_t ra, uint32_t rb) {
+  return XForm(rd, ra, rb, 40);
+}
+constexpr uint32_t mullw(uint32_t rd, uint32_t ra, uint32_t rb) {
+  return XForm(rd, ra, rb, 235);
+}
+constexpr uint32_t divwu(uint32_t rd, uint32_t ra, uint32_t rb) {
+  return XForm(rd, ra, rb, 459);
+}
+constexpr uint32_t neg(uint32_t rd, uint32_t ra) {
+  return XForm(rd, ra, 0, 104);
+}
+constexpr uint32_t and_(uint32_t ra, uint32_t rs, uint32_t rb) {
+  return XForm(rs, ra, rb, 28);
+}
+constexpr uint32_t or_(uint32_t ra, uint32_t rs, uint32_t rb) {
+  return XForm(rs, ra, rb, 444);
+}
+constexpr uint32_t mr(uint32_t ra, uint32_t rs) { return or_(ra, rs, rs); }
+constexpr uint32_t xor_(uint32_t ra, uint32_t rs, uint32_t rb) {
+  return XForm(rs, ra, rb, 316);
+}
+constexpr uint32_t slw(uint32_t ra, uint32_t rs, uint32_t rb) {
+  return XForm(rs, ra, rb, 24);
+}
+constexpr uint32_t srw(uint32_t ra, uint32_t rs, uint32_t rb) {
+  return XForm(rs, ra, rb, 536);
+}
+constexpr uint32_t rlwinm(uint32_t ra, uint32_t rs, uint32_t sh, uint32_t mb,
+                          uint32_t me) {
+  return (21u << 26) | (rs << 21) | (ra << 16) | (sh << 11) | (mb << 6) |
+         (me << 1);
+}
+
+constexpr uint32_t cmpw(uint32_t crf, uint32_t ra, uint32_t rb) {
+  return XForm(crf << 2, ra, rb, 0);
+}
+constexpr uint32_t cmplw(uint32_t crf, uint32_t ra, uint32_t rb) {
+  return XForm(crf << 2, ra, rb, 32);
+}
+constexpr uint32_t cmpwi(uint32_t crf, uint32_t ra, int32_t simm) {
+  return DForm(11, crf << 2, ra, simm);
+}
+constexpr uint32_t cmplwi(uint32_t crf, uint32_t ra, uint32_t uimm) {
+  return DForm(10, crf << 2, ra, int32_t(uimm));
+}
+
+// ── Load / store ─────────────────────────────────────────────────────────────
+
+constexpr uint32_t lwz(uint32_t rd, int32_t d, uint32_t ra) {
+  return DForm(32, rd, ra, d);
+}
+constexpr uint32_t lbz(uint32_t rd, int32_t d, uint32_t ra) {
+  return DForm(34, rd, ra, d);
+}
+constexpr uint32_t stw(uint32_t rs, int32_t d, uint32_t ra) {
+  return DForm(36, rs, ra, d);
+}
+constexpr uint32_t stb(uint32_t rs, int32_t d, uint32_t ra) {
+  return DForm(38, rs, ra, d);
+}
+constexpr uint32_t lhz(uint32_t rd, int32_t d, uint32_t ra) {
+  return DForm(40, rd, ra, d);
+}
+constexpr uint32_t sth(uint32_t rs, int32_t d, uint32_t ra) {
+  return DForm(44, rs, ra, d);
+}
+constexpr uint32_t lfs(uint32_t frd, int32_t d, uint32_t ra) {
+  return DForm(48, frd, ra, d);
+}
+constexpr uint32_t stfs(uint32_t frs, int32_t d, uint32_t ra) {
+  return DForm(52, frs, ra, d);
+}
+/// DS form: d must be a multiple of 4
+constexpr uint32_t ld(uint32_t rd, int32_t d, uint32_t ra) {
+  return DForm(58, rd, ra, d & ~3);
+}
+constexpr uint32_t std_(uint32_t rs, int32_t d, uint32_t ra) {
+  return DForm(62, rs, ra, d & ~3);
+}
+constexpr uint32_t lwzx(uint32_t rd, uint32_t ra, uint32_t rb) {
+  return XForm(rd, ra, rb, 23);
+}
+constexpr uint32_t stwx(uint32_t rs, uint32_t ra, uint32_t rb) {
+  return XForm(rs, ra, rb, 151);
+}
+constexpr uint32_t lwarx(uint32_t rd, uint32_t ra, uint32_t rb) {
+  return XForm(rd, ra, rb, 20);
+}
+constexpr uint32_t stwcx_(uint32_t rs, uint32_t ra, uint32_t rb) {
+  return XForm(rs, ra, rb, 150, 1);
+}
+
+// ── Floating point ───────────────────────────────────────────────────────────
+
+/// A form: op 63 is double precision, 59 single
+constexpr uint32_t AForm(uint32_t op, uint32_t frd, uint32_t fra, uint32_t frb,
+                         uint32_t frc, uint32_t xo) {
+  return (op << 26) | (frd << 21) | (fra << 16) | (frb << 11) | (frc << 6) |
+         (xo << 1);
+}
+constexpr uint32_t fadd(uint32_t frd, uint32_t fra, uint32_t frb) {
+  return AForm(63, frd, fra, frb, 0, 21);
+}
+constexpr uint32_t fsub(uint32_t frd, uint32_t fra, uint32_t frb) {
+  return AForm(63, frd, fra, frb, 0, 20);
+}
+constexpr uint32_t fmul(uint32_t frd, uint32_t fra, uint32_t frc) {
+  return AForm(63, frd, fra, 0, frc, 25);
+}
+/// frd = fra * frc + frb
+constexpr uint32_t fmadd(uint32_t frd, uint32_t fra, uint32_t frc,
+                         uint32_t frb) {
+  return AForm(63, frd, fra, frb, frc, 29);
+}
+constexpr uint32_t fadds(uint32_t frd, uint32_t fra, uint32_t frb) {
+  return AForm(59, frd, fra, frb, 0, 21);
+}
+constexpr uint32_t fmuls(uint32_t frd, uint32_t fra, uint32_t frc) {
+  return AForm(59, frd, fra, 0, frc, 25);
+}
+constexpr uint32_t fmr(uint32_t frd, uint32_t frb) {
+  return (63u << 26) | (frd << 21) | (frb << 11) | (72u << 1);
+}
+
+// ── Branch / SPR ─────────────────────────────────────────────────────────────
+
+constexpr uint32_t b(int32_t disp) {
+  return (18u << 26) | (uint32_t(disp) & 0x03FFFFFC);
+}
+constexpr uint32_t bl(int32_t disp) { return b(disp) | 1; }
+constexpr uint32_t bc(uint32_t bo, uint32_t bi, int32_t disp) {
+  return (16u << 26) | (bo << 21) | (bi << 16) | (uint32_t(disp) & 0xFFFC);
+}
+constexpr uint32_t bdnz(int32_t disp) { return bc(16, 0, disp); }
+constexpr uint32_t beq(uint32_t crf, int32_t disp) {
+  return bc(12, crf * 4 + 2, disp);
+}
+constexpr uint32_t bne(uint32_t crf, int32_t disp) {
+  return bc(4, crf * 4 + 2, disp);
+}
+constexpr uint32_t blt(uint32_t crf, int32_t disp) {
+  return bc(12, crf * 4, disp);
+}
+constexpr uint32_t bge(uint32_t crf, int32_t disp) {
+  return bc(4, crf * 4, disp);
+}
+constexpr uint32_t blr() { return (19u << 26) | (20u << 21) | (16u << 1); }
+constexpr uint32_t bctr() { return (19u << 26) | (20u << 21) | (528u << 1); }
+constexpr uint32_t sc() { return 0x44000002; }
+
+/// The SPR number is split into two swapped 5-bit halves
+constexpr uint32_t mtspr(uint32_t spr, uint32_t rs) {
+  return XForm(rs, spr & 0x1F, (spr >> 5) & 0x1F, 467);
+}
+constexpr uint32_t mfspr(uint32_t rd, uint32_t spr) {
+  return XForm(rd, spr & 0x1F, (spr >> 5) & 0x1F, 339);
+}
+constexpr uint32_t mtctr(uint32_t rs) { return mtspr(9, rs); }
+constexpr uint32_t mtlr(uint32_t rs) { return mtspr(8, rs); }
+constexpr uint32_t mflr(uint32_t rd) { return mfspr(rd, 8); }
+constexpr uint32_t mfctr(uint32_t rd) { return mfspr(rd, 9); }
+constexpr uint32_t mfcr(uint32_t rd) { return XForm(rd, 0, 0, 19); }
+
+// ── VMX ──────────────────────────────────────────────────────────────────────
+
+constexpr uint32_t lvx(uint32_t vd, uint32_t ra, uint32_t rb) {
+  return XForm(vd, ra, rb, 103);
+}
+constexpr uint32_t stvx(uint32_t vs, uint32_t ra, uint32_t rb) {
+  return XForm(vs, ra, rb, 231);
+}
+constexpr uint32_t vaddfp(uint32_t vd, uint32_t va, uint32_t vb) {
+  return VXForm(vd, va, vb, 10);
+}
+constexpr uint32_t vsubfp(uint32_t vd, uint32_t va, uint32_t vb) {
+  return VXForm(vd, va, vb, 74);
+}
+constexpr uint32_t vmaxfp(uint32_t vd, uint32_t va, uint32_t vb) {
+  return VXForm(vd, va, vb, 1034);
+}
+constexpr uint32_t vand(uint32_t vd, uint32_t va, uint32_t vb) {
+  return VXForm(vd, va, vb, 1028);
+}
+constexpr uint32_t vor(uint32_t vd, uint32_t va, uint32_t vb) {
+  return VXForm(vd, va, vb, 1156);
+}
+constexpr uint32_t vxor(uint32_t vd, uint32_t va, uint32_t vb) {
+  return VXForm(vd, va, vb, 1220);
+}
+/// vd = va * vc + vb
+constexpr uint32_t vmaddfp(uint32_t vd, uint32_t va, uint32_t vc,
+                           uint32_t vb) {
+  return VAForm(vd, va, vb, vc, 46);
+}
+/// The element index sits where VX form has va
+constexpr uint32_t vspltw(uint32_t vd, uint32_t vb, uint32_t uimm) {
+  return VXForm(vd, uimm, vb, 652);
+}
+constexpr uint32_t vperm(uint32_t vd, uint32_t va, uint32_t vb, uint32_t vc) {
+  return VAForm(vd, va, vb, vc, 43);
+}
+constexpr uint32_t vsel(uint32_t vd, uint32_t va, uint32_t vb, uint32_t vc) {
+  return VAForm(vd, va, vb, vc, 42);
+}
+
+}  // namespace xe::cpu::frontend::ppc_asm
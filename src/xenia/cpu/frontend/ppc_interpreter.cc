@@ -11,6 +11,7 @@
 
 #include "xenia/cpu/frontend/ppc_interpreter.h"
 #include "xenia/base/logging.h"
+#include "xenia/base/timebase.h"
 
 #include <cmath>
 #include <cstring>
@@ -52,8 +53,8 @@ uint16_t PPCInterpreter::ReadU16(uint32_t addr) const {
 }
 
 uint32_t PPCInterpreter::ReadU32(uint32_t addr) const {
-  // Intercept GPU MMIO reads
-  if (addr >= 0x7C800000 && addr < 0x7D000000 && mmio_read_) {
+  // Intercept GPU and APU MMIO reads
+  if (IsMmio(addr) && mmio_read_) {
     return mmio_read_(addr);
   }
   uint32_t v;
@@ -91,8 +92,8 @@ void PPCInterpreter::WriteU16(uint32_t addr, uint16_t val) {
 }
 
 void PPCInterpreter::WriteU32(uint32_t addr, uint32_t val) {
-  // Intercept GPU MMIO writes (0x7C800000+)
-  if (addr >= 0x7C800000 && addr < 0x7D000000 && mmio_write_) {
+  // Intercept GPU (0x7C800000+) and APU (0x7FEA0000+) MMIO writes
+  if (IsMmio(addr) && mmio_write_) {
     if (mmio_write_(addr, val)) return;
   }
   uint32_t be = __builtin_bswap32(val);
@@ -116,6 +117,26 @@ void PPCInterpreter::WriteF64(uint32_t addr, double val) {
   WriteU64(addr, bits);
 }
 
+// VMX registers hold their four words in host byte order, element i in
+// word i, so float and integer lanes read directly. Byte element k of the
+// big-endian register then lives at host byte VByte(k), halfword k at
+// VHalf(k).
+static inline uint32_t VByte(uint32_t k) { return k ^ 3; }
+static inline uint32_t VHalf(uint32_t k) { return k ^ 1; }
+
+static inline void LoadVector(uint8_t* v, const uint8_t* src) {
+  for (int i = 0; i < 4; i++) {
+    uint32_t w;
+    memcpy(&w, src + i * 4, 4);
+    w = __builtin_bswap32(w);
+    memcpy(v + i * 4, &w, 4);
+  }
+}
+
+static inline void StoreVector(uint8_t* dst, const uint8_t* v) {
+  LoadVector(dst, v);  // the word swap is its own inverse
+}
+
 // ═══════════════════════════════════════════════════════════════════════════
 // CR / condition helpers
 // ═══════════════════════════════════════════════════════════════════════════
@@ -205,8 +226,14 @@ uint64_t PPCInterpreter::BuildMask64(uint32_t mb, uint32_t me) {
 uint64_t PPCInterpreter::Run(ThreadState* thread, uint64_t max_instructions) {
   uint64_t count = 0;
   uint64_t limit = max_instructions > 0 ? max_instructions : UINT64_MAX;
+  sample_requested_.store(false, std::memory_order_relaxed);
 
   while (count < limit) {
+    if (sample_requested_.load(std::memory_order_relaxed)) [[unlikely]] {
+      sample_requested_.store(false, std::memory_order_relaxed);
+      if (sample_hook_) sample_hook_(*thread);
+    }
+
     // Check for HLE thunk at current PC
     auto thunk_it = thunk_map_.find(thread->pc);
     if (thunk_it != thunk_map_.end()) {
@@ -801,6 +828,7 @@ InterpResult PPCInterpreter::Step(ThreadState* t) {
       t->gpr[rd] = ReadU32(ea);
       t->reserve_address = ea;
       t->reserve_valid = true;
+      t->reserve_epoch = reservation_epoch_;
       return InterpResult::kContinue;
     }
     case 23: { // lwzx — load word and zero indexed
@@ -928,9 +956,11 @@ InterpResult PPCInterpreter::Step(ThreadState* t) {
       uint32_t ea = (ra == 0) ? 0 : static_cast<uint32_t>(t->gpr[ra]);
       ea += static_cast<uint32_t>(t->gpr[rb]);
 
-      if (t->reserve_valid && t->reserve_address == ea) {
+      if (t->reserve_valid && t->reserve_address == ea &&
+          t->reserve_epoch == reservation_epoch_) {
         WriteU32(ea, static_cast<uint32_t>(t->gpr[RS(instr)]));
         t->reserve_valid = false;
+        reservation_epoch_++;
         // Set CR0 = EQ (success)
         t->cr = (t->cr & ~(0xFu << 28)) | (0x2u << 28);
       } else {
@@ -1045,18 +1075,12 @@ InterpResult PPCInterpreter::Step(ThreadState* t) {
         case 1:   t->gpr[rd] = t->xer; break;  // XER
         case 8:   t->gpr[rd] = t->lr; break;    // LR
         case 9:   t->gpr[rd] = t->ctr; break;   // CTR
-        case 268: {  // TBL — timebase lower (50MHz timer)
-          static uint64_t fake_tb_spr = 0;
-          fake_tb_spr += 500;  // ~10us per read at 50MHz
-          t->gpr[rd] = static_cast<uint32_t>(fake_tb_spr);
+        case 268:  // TB — the whole 64-bit timebase in 64-bit mode
+          t->gpr[rd] = timebase::QueryGuestTicks();
           break;
-        }
-        case 269: {  // TBU — timebase upper
-          static uint64_t fake_tb_spr2 = 0;
-          fake_tb_spr2 += 500;
-          t->gpr[rd] = static_cast<uint32_t>(fake_tb_spr2 >> 32);
+        case 269:  // TBU — timebase upper
+          t->gpr[rd] = timebase::QueryGuestTicks() >> 32;
           break;
-        }
         default:  t->gpr[rd] = 0; break;
       }
       return InterpResult::kContinue;
@@ -1069,12 +1093,8 @@ InterpResult PPCInterpreter::Step(ThreadState* t) {
       return InterpResult::kContinue;
     }
     case 371: { // mftb — move from time base
-      uint32_t tbr_val = TBR(instr);
-      // Return a monotonically increasing value
-      static uint64_t fake_tb = 0;
-      fake_tb += 100;
-      if (tbr_val == 268) t->gpr[rd] = static_cast<uint32_t>(fake_tb);
-      else t->gpr[rd] = static_cast<uint32_t>(fake_tb >> 32);
+      uint64_t tb = timebase::QueryGuestTicks();
+      t->gpr[rd] = TBR(instr) == 268 ? tb : tb >> 32;
       return InterpResult::kContinue;
     }
     case 375: { // lhaux
@@ -1300,7 +1320,7 @@ InterpResult PPCInterpreter::Step(ThreadState* t) {
       uint32_t ea = (ra == 0) ? 0 : static_cast<uint32_t>(t->gpr[ra]);
       ea += static_cast<uint32_t>(t->gpr[rb]);
       ea &= ~0xFu;  // align to 16 bytes
-      memcpy(t->vmx[vt], guest_base_ + ea, 16);
+      LoadVector(t->vmx[vt], guest_base_ + ea);
       return InterpResult::kContinue;
     }
     case 359: { // lvxl — load vector indexed last (same as lvx for us)
@@ -1308,7 +1328,7 @@ InterpResult PPCInterpreter::Step(ThreadState* t) {
       uint32_t ea = (ra == 0) ? 0 : static_cast<uint32_t>(t->gpr[ra]);
       ea += static_cast<uint32_t>(t->gpr[rb]);
       ea &= ~0xFu;
-      memcpy(t->vmx[vt], guest_base_ + ea, 16);
+      LoadVector(t->vmx[vt], guest_base_ + ea);
       return InterpResult::kContinue;
     }
     case 231: { // stvx — store vector indexed
@@ -1316,7 +1336,7 @@ InterpResult PPCInterpreter::Step(ThreadState* t) {
       uint32_t ea = (ra == 0) ? 0 : static_cast<uint32_t>(t->gpr[ra]);
       ea += static_cast<uint32_t>(t->gpr[rb]);
       ea &= ~0xFu;
-      memcpy(guest_base_ + ea, t->vmx[vs], 16);
+      StoreVector(guest_base_ + ea, t->vmx[vs]);
       return InterpResult::kContinue;
     }
     case 487: { // stvxl — store vector indexed last
@@ -1324,7 +1344,7 @@ InterpResult PPCInterpreter::Step(ThreadState* t) {
       uint32_t ea = (ra == 0) ? 0 : static_cast<uint32_t>(t->gpr[ra]);
       ea += static_cast<uint32_t>(t->gpr[rb]);
       ea &= ~0xFu;
-      memcpy(guest_base_ + ea, t->vmx[vs], 16);
+      StoreVector(guest_base_ + ea, t->vmx[vs]);
       return InterpResult::kContinue;
     }
     case 7: { // lvebx — load vector element byte indexed
@@ -1332,7 +1352,7 @@ InterpResult PPCInterpreter::Step(ThreadState* t) {
       uint32_t ea = (ra == 0) ? 0 : static_cast<uint32_t>(t->gpr[ra]);
       ea += static_cast<uint32_t>(t->gpr[rb]);
       memset(t->vmx[vt], 0, 16);
-      t->vmx[vt][ea & 0xF] = *(guest_base_ + ea);
+      t->vmx[vt][VByte(ea & 0xF)] = ReadU8(ea);
       return InterpResult::kContinue;
     }
     case 39: { // lvehx — load vector element half indexed
@@ -1341,7 +1361,8 @@ InterpResult PPCInterpreter::Step(ThreadState* t) {
       ea += static_cast<uint32_t>(t->gpr[rb]);
       ea &= ~1u;
       memset(t->vmx[vt], 0, 16);
-      memcpy(t->vmx[vt] + (ea & 0xE), guest_base_ + ea, 2);
+      uint16_t half = ReadU16(ea);
+      memcpy(t->vmx[vt] + VHalf((ea & 0xE) >> 1) * 2, &half, 2);
       return InterpResult::kContinue;
     }
     case 71: { // lvewx — load vector element word indexed
@@ -1350,7 +1371,10 @@ InterpResult PPCInterpreter::Step(ThreadState* t) {
       ea += static_cast<uint32_t>(t->gpr[rb]);
       ea &= ~3u;
       memset(t->vmx[vt], 0, 16);
-      memcpy(t->vmx[vt] + (ea & 0xC), guest_base_ + ea, 4);
+      uint32_t word;
+      memcpy(&word, guest_base_ + ea, 4);
+      word = __builtin_bswap32(word);
+      memcpy(t->vmx[vt] + (ea & 0xC), &word, 4);
       return InterpResult::kContinue;
     }
     case 342: { // dst — data stream touch — NOP
@@ -1367,7 +1391,7 @@ InterpResult PPCInterpreter::Step(ThreadState* t) {
       uint32_t ea = (ra == 0) ? 0 : static_cast<uint32_t>(t->gpr[ra]);
       ea += static_cast<uint32_t>(t->gpr[rb]);
       uint8_t sh = ea & 0xF;
-      for (int i = 0; i < 16; i++) t->vmx[vt][i] = (sh + i) & 0xFF;
+      for (int i = 0; i < 16; i++) t->vmx[vt][VByte(i)] = (sh + i) & 0xFF;
       return InterpResult::kContinue;
     }
     case 38: { // lvsr — load vector for shift right
@@ -1375,7 +1399,7 @@ InterpResult PPCInterpreter::Step(ThreadState* t) {
       uint32_t ea = (ra == 0) ? 0 : static_cast<uint32_t>(t->gpr[ra]);
       ea += static_cast<uint32_t>(t->gpr[rb]);
       uint8_t sh = ea & 0xF;
-      for (int i = 0; i < 16; i++) t->vmx[vt][i] = (0x10 - sh + i) & 0xFF;
+      for (int i = 0; i < 16; i++) t->vmx[vt][VByte(i)] = (0x10 - sh + i) & 0xFF;
       return InterpResult::kContinue;
     }
 
@@ -2030,24 +2054,32 @@ InterpResult PPCInterpreter::Step(ThreadState* t) {
     }
 
     // ────── Vector Splat ──────
-    case 844: { // vspltw — splat word
-      uint32_t uimm = vb; // UIMM field selects element
-      uint32_t val = vi(va)[uimm & 3];
+    // UIMM sits in the vA field, the source register in vB
+    case 652: { // vspltw — splat word
+      uint32_t val = vi(vb)[va & 3];
       for (int i = 0; i < 4; i++) vi(vd)[i] = val;
       return InterpResult::kContinue;
     }
-    case 780: { // vsplth — splat halfword
-      uint32_t uimm = vb;
-      uint16_t val = vh(va)[uimm & 7];
+    case 588: { // vsplth — splat halfword
+      uint16_t val = vh(vb)[VHalf(va & 7)];
       for (int i = 0; i < 8; i++) vh(vd)[i] = val;
       return InterpResult::kContinue;
     }
-    case 716: { // vspltb — splat byte
-      uint32_t uimm = vb;
-      uint8_t val = vb8(va)[uimm & 15];
+    case 524: { // vspltb — splat byte
+      uint8_t val = vb8(vb)[VByte(va & 15)];
       for (int i = 0; i < 16; i++) vb8(vd)[i] = val;
       return InterpResult::kContinue;
     }
+    case 780: { // vspltisb — splat immediate signed byte
+      int32_t simm = static_cast<int32_t>(va << 27) >> 27;
+      for (int i = 0; i < 16; i++) vb8(vd)[i] = static_cast<uint8_t>(simm);
+      return InterpResult::kContinue;
+    }
+    case 844: { // vspltish — splat immediate signed halfword
+      int32_t simm = static_cast<int32_t>(va << 27) >> 27;
+      for (int i = 0; i < 8; i++) vh(vd)[i] = static_cast<uint16_t>(simm);
+      return InterpResult::kContinue;
+    }
     case 908: { // vspltisw — splat immediate signed word
       int32_t simm = static_cast<int32_t>(va << 27) >> 27; // sign extend 5-bit
       for (int i = 0; i < 4; i++) vi(vd)[i] = static_cast<uint32_t>(simm);
@@ -2082,9 +2114,9 @@ InterpResult PPCInterpreter::Step(ThreadState* t) {
     case 43: { // vperm — vector permute
       uint8_t tmp[16];
       for (int i = 0; i < 16; i++) {
-        uint8_t sel = vb8(vc)[i] & 0x1F;
-        if (sel < 16) tmp[i] = vb8(va)[sel];
-        else          tmp[i] = vb8(vb)[sel - 16];
+        uint8_t sel = vb8(vc)[VByte(i)] & 0x1F;
+        if (sel < 16) tmp[VByte(i)] = vb8(va)[VByte(sel)];
+        else          tmp[VByte(i)] = vb8(vb)[VByte(sel - 16)];
       }
       memcpy(t->vmx[vd], tmp, 16);
       return InterpResult::kContinue;
@@ -2092,27 +2124,27 @@ InterpResult PPCInterpreter::Step(ThreadState* t) {
 
     // ────── Vector Reciprocal/Rsqrt Estimates ──────
     case 266: { // vrefp — vector reciprocal estimate float
-      for (int i = 0; i < 4; i++) vf(vd)[i] = 1.0f / vf(va)[i];
+      for (int i = 0; i < 4; i++) vf(vd)[i] = 1.0f / vf(vb)[i];
       return InterpResult::kContinue;
     }
     case 330: { // vrsqrtefp — vector reciprocal sqrt estimate
-      for (int i = 0; i < 4; i++) vf(vd)[i] = 1.0f / sqrtf(vf(va)[i]);
+      for (int i = 0; i < 4; i++) vf(vd)[i] = 1.0f / sqrtf(vf(vb)[i]);
       return InterpResult::kContinue;
     }
     case 394: { // vlogefp — vector log2 estimate
-      for (int i = 0; i < 4; i++) vf(vd)[i] = log2f(vf(va)[i]);
+      for (int i = 0; i < 4; i++) vf(vd)[i] = log2f(vf(vb)[i]);
       return InterpResult::kContinue;
     }
     case 458: { // vexptefp — vector 2^x estimate
-      for (int i = 0; i < 4; i++) vf(vd)[i] = exp2f(vf(va)[i]);
+      for (int i = 0; i < 4; i++) vf(vd)[i] = exp2f(vf(vb)[i]);
       return InterpResult::kContinue;
     }
 
     // ────── Vector Float Convert ──────
     case 842: { // vctsxs — vector convert to signed int saturated
-      uint32_t uimm = vb; // UIMM is scale factor
+      uint32_t uimm = va; // UIMM is scale factor
       for (int i = 0; i < 4; i++) {
-        float scaled = vf(va)[i] * (float)(1 << uimm);
+        float scaled = vf(vb)[i] * (float)(1 << uimm);
         int32_t ival;
         if (scaled >= 2147483647.0f) ival = 0x7FFFFFFF;
         else if (scaled <= -2147483648.0f) ival = (int32_t)0x80000000;
@@ -2122,9 +2154,9 @@ InterpResult PPCInterpreter::Step(ThreadState* t) {
       return InterpResult::kContinue;
     }
     case 906: { // vctuxs — vector convert to unsigned int saturated
-      uint32_t uimm = vb;
+      uint32_t uimm = va;
       for (int i = 0; i < 4; i++) {
-        float scaled = vf(va)[i] * (float)(1 << uimm);
+        float scaled = vf(vb)[i] * (float)(1 << uimm);
         uint32_t uval;
         if (scaled >= 4294967295.0f) uval = 0xFFFFFFFF;
         else if (scaled <= 0.0f) uval = 0;
@@ -2134,10 +2166,10 @@ InterpResult PPCInterpreter::Step(ThreadState* t) {
       return InterpResult::kContinue;
     }
     case 970: { // vcfsx — convert from signed int
-      uint32_t uimm = vb;
+      uint32_t uimm = va;
       float scale = (uimm > 0) ? (1.0f / (float)(1 << uimm)) : 1.0f;
       for (int i = 0; i < 4; i++)
-        vf(vd)[i] = (float)(int32_t)vi(va)[i] * scale;
+        vf(vd)[i] = (float)(int32_t)vi(vb)[i] * scale;
       return InterpResult::kContinue;
     }
 
@@ -2161,9 +2193,9 @@ InterpResult PPCInterpreter::Step(ThreadState* t) {
     case 43: { // vperm (VA form)
       uint8_t tmp[16];
       for (int i = 0; i < 16; i++) {
-        uint8_t sel = vb8(vc)[i] & 0x1F;
-        if (sel < 16) tmp[i] = vb8(va)[sel];
-        else          tmp[i] = vb8(vb)[sel - 16];
+        uint8_t sel = vb8(vc)[VByte(i)] & 0x1F;
+        if (sel < 16) tmp[VByte(i)] = vb8(va)[VByte(sel)];
+        else          tmp[VByte(i)] = vb8(vb)[VByte(sel - 16)];
       }
       memcpy(t->vmx[vd], tmp, 16);
       return InterpResult::kContinue;
@@ -2176,9 +2208,11 @@ InterpResult PPCInterpreter::Step(ThreadState* t) {
     case 44: { // vsldoi — shift left double by octet immediate
       uint32_t sh = (instr >> 6) & 0xF; // SH field
       uint8_t tmp[32];
-      memcpy(tmp, t->vmx[va], 16);
-      memcpy(tmp + 16, t->vmx[vb], 16);
-      memcpy(t->vmx[vd], tmp + sh, 16);
+      for (int i = 0; i < 16; i++) {
+        tmp[i] = vb8(va)[VByte(i)];
+        tmp[i + 16] = vb8(vb)[VByte(i)];
+      }
+      for (int i = 0; i < 16; i++) vb8(vd)[VByte(i)] = tmp[i + sh];
       return InterpResult::kContinue;
     }
     default:
@@ -20,6 +20,7 @@
 #pragma once
 
 #include "xenia/cpu/processor.h"
+#include <atomic>
 #include <cstdint>
 #include <functional>
 #include <unordered_map>
@@ -51,7 +52,8 @@ class PPCInterpreter {
   /// Set the HLE dispatch callback (handles kernel import thunks)
   void SetHleDispatch(HleDispatchFn fn) { hle_dispatch_ = std::move(fn); }
 
-  /// Set GPU MMIO write callback — called when guest writes to GPU register space
+  /// Set MMIO callbacks — called for 32-bit guest accesses to the GPU and
+  /// APU register spaces
   using MmioWriteFn = std::function<bool(uint32_t addr, uint32_t value)>;
   using MmioReadFn = std::function<uint32_t(uint32_t addr)>;
   void SetMmioHandlers(MmioWriteFn write_fn, MmioReadFn read_fn) {
@@ -72,6 +74,14 @@ class PPCInterpreter {
   /// Register an HLE thunk address → ordinal mapping
   void RegisterThunk(uint32_t guest_addr, uint32_t ordinal);
 
+  /// Sampling profiler: the hook runs on the executing thread at the next
+  /// instruction boundary after RequestSample (from any thread). Requests
+  /// made while no guest code runs are dropped at the next Run.
+  void SetSampleHook(SampleFn fn) { sample_hook_ = std::move(fn); }
+  void RequestSample() {
+    sample_requested_.store(true, std::memory_order_relaxed);
+  }
+
   /// Stats
   uint64_t instructions_executed() const { return instructions_executed_; }
 
@@ -132,12 +142,22 @@ class PPCInterpreter {
   static uint32_t BuildMask32(uint32_t mb, uint32_t me);
   static uint64_t BuildMask64(uint32_t mb, uint32_t me);
 
+  /// GPU registers (0x7C800000) or APU registers (0x7FEA0000)
+  static bool IsMmio(uint32_t addr) {
+    return addr - 0x7C800000u < 0x00800000u || addr - 0x7FEA0000u < 0x10000u;
+  }
+
   uint8_t* guest_base_ = nullptr;
   HleDispatchFn hle_dispatch_;
   MmioWriteFn mmio_write_;
   MmioReadFn mmio_read_;
   std::unordered_map<uint32_t, uint32_t> thunk_map_;  // guest_addr → ordinal
+  /// Bumped by every successful stwcx.: a reservation taken before another
+  /// thread's conditional store is lost, as the hardware's would be
+  uint64_t reservation_epoch_ = 0;
   uint64_t instructions_executed_ = 0;
+  SampleFn sample_hook_;
+  std::atomic<bool> sample_requested_{false};
 };
 
 }  // namespace xe::cpu::frontend
@@ -0,0 +1,100 @@
+/**
+ * Vera360 — Xenia Edge
+ * Guest function map implementation
+ */
+
+#include "xenia/cpu/guest_function_map.h"
+#include "xenia/base/memory/memory.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace xe::cpu {
+
+namespace {
+
+uint32_t LoadBE32(const uint8_t* p) {
+  uint32_t value;
+  memcpy(&value, p, sizeof(value));
+  return __builtin_bswap32(value);
+}
+
+}  // namespace
+
+size_t GuestFunctionMap::AddPdata(const uint8_t* pdata, size_t size) {
+  size_t taken = 0;
+  for (size_t offset = 0; offset + 8 <= size; offset += 8) {
+    uint32_t start = LoadBE32(pdata + offset);
+    uint32_t length = ((LoadBE32(pdata + offset + 4) >> 8) & 0x3FFFFF) * 4;
+    // The table is zero-padded to the section size
+    if (!start || !length || (start & 3)) continue;
+    Add(start, start + length);
+    limit_ = std::max(limit_, start + length);
+    ++taken;
+  }
+  return taken;
+}
+
+size_t GuestFunctionMap::AddCallTargets(uint32_t start, uint32_t end) {
+  uint8_t* guest_base = xe::memory::GetGuestBase();
+  if (!guest_base || end <= start) return 0;
+  limit_ = std::max(limit_, end);
+  size_t found = 0;
+  for (uint32_t address = start & ~3u; address + 4 <= end; address += 4) {
+    uint32_t code = LoadBE32(guest_base + address);
+    // bl: primary opcode 18, AA = 0, LK = 1
+    if ((code & 0xFC000003) != 0x48000001) continue;
+    int32_t offset = (static_cast<int32_t>(code << 6) >> 6) & ~3;
+    uint32_t target = address + static_cast<uint32_t>(offset);
+    if (target < start || target >= end) continue;
+    Add(target);
+    ++found;
+  }
+  return found;
+}
+
+void GuestFunctionMap::Add(uint32_t start, uint32_t end) {
+  functions_.push_back({start, end});
+}
+
+void GuestFunctionMap::Finalize() {
+  // Known lengths sort first among equal starts and win the merge
+  std::sort(functions_.begin(), functions_.end(),
+            [](const GuestFunction& a, const GuestFunction& b) {
+              return a.start != b.start ? a.start < b.start : a.end > b.end;
+            });
+  functions_.erase(std::unique(functions_.begin(), functions_.end(),
+                               [](const GuestFunction& a,
+                                  const GuestFunction& b) {
+                                 return a.start == b.start;
+                               }),
+                   functions_.end());
+  for (size_t i = 0; i < functions_.size(); ++i) {
+    uint32_t next = i + 1 < functions_.size() ? functions_[i + 1].start
+                                              : std::max(limit_,
+                                                         functions_[i].start + 4);
+    // An open end, or a pdata length that runs into the next function
+    // (a bl target inside it: a secondary entry point)
+    if (!functions_[i].end || functions_[i].end > next) {
+      functions_[i].end = next;
+    }
+  }
+}
+
+const GuestFunction* GuestFunctionMap::Lookup(uint32_t address) const {
+  auto it = std::upper_bound(
+      functions_.begin(), functions_.end(), address,
+      [](uint32_t value, const GuestFunction& f) { return value < f.start; });
+  if (it == functions_.begin()) return nullptr;
+  --it;
+  return address < it->end ? &*it : nullptr;
+}
+
+std::string GuestFunctionMap::Name(uint32_t start) {
+  char name[24];
+  snprintf(name, sizeof(name), "guest_%08X", start);
+  return name;
+}
+
+}  // namespace xe::cpu
@@ -0,0 +1,56 @@
+/**
+ * Vera360 — Xenia Edge
+ * Guest function map — where each function of a loaded image starts
+ *
+ * Built once per module at load. Retail images carry a .pdata table (one
+ * RUNTIME_FUNCTION per function, with its length); stripped or homebrew
+ * images fall back to the targets of every bl in their code, which finds
+ * all functions that are called directly. A function without a known
+ * length ends where the next one starts.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace xe::cpu {
+
+struct GuestFunction {
+  uint32_t start;
+  uint32_t end;  // exclusive
+};
+
+class GuestFunctionMap {
+ public:
+  /// Xbox 360 .pdata: big-endian {start address, flags} pairs, the length
+  /// in instructions in flags bits 8-29. Returns the entries taken.
+  size_t AddPdata(const uint8_t* pdata, size_t size);
+
+  /// Targets of relative bl instructions in guest [start, end) that land
+  /// inside it. Returns the targets found, with repeats.
+  size_t AddCallTargets(uint32_t start, uint32_t end);
+
+  /// end 0: unknown, up to the next function
+  void Add(uint32_t start, uint32_t end = 0);
+
+  /// Sorts, merges duplicates and closes open ends; call after adding
+  void Finalize();
+
+  /// The function holding address, nullptr if none
+  const GuestFunction* Lookup(uint32_t address) const;
+
+  /// "guest_82001234", the name profilers show for a function
+  static std::string Name(uint32_t start);
+
+  const std::vector<GuestFunction>& functions() const { return functions_; }
+  bool empty() const { return functions_.empty(); }
+
+ private:
+  std::vector<GuestFunction> functions_;
+  /// Upper bound for open ends: the highest scanned or pdata address
+  uint32_t limit_ = 0;
+};
+
+}  // namespace xe::cpu
@@ -0,0 +1,153 @@
+/**
+ * Vera360 — Xenia Edge
+ * Guest profiler implementation
+ */
+
+#include "xenia/cpu/guest_profiler.h"
+#include "xenia/cpu/processor.h"
+#include "xenia/base/logging.h"
+#include "xenia/base/memory/memory.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace xe::cpu {
+
+namespace {
+
+/// Larger gaps between back-chain links mean the chain is garbage
+constexpr uint32_t kMaxFrameSize = 1024 * 1024;
+
+bool ReadGuest32(uint32_t address, uint32_t* value) {
+  if ((address & 3) || !xe::memory::IsReadable(address)) return false;
+  uint32_t raw;
+  memcpy(&raw, xe::memory::TranslateVirtual(address), sizeof(raw));
+  *value = __builtin_bswap32(raw);
+  return true;
+}
+
+}  // namespace
+
+GuestProfiler::GuestProfiler() = default;
+GuestProfiler::~GuestProfiler() { Stop(); }
+
+bool GuestProfiler::Start(Processor* processor,
+                          const GuestFunctionMap* functions,
+                          uint32_t interval_us) {
+  if (timer_ || !processor || !functions) return false;
+  if (processor->exec_mode() != ExecMode::kInterpreter) {
+    XELOGW("Guest profiler: samples the interpreter only");
+  }
+  processor_ = processor;
+  functions_ = functions;
+  exit_.store(false, std::memory_order_relaxed);
+  processor_->SetSampleHook(
+      [this](const ThreadState& thread) { Sample(thread); });
+
+  uint64_t interval_ns = uint64_t(std::max(interval_us, 1u)) * 1000;
+  timer_ = threading::Thread::Create(
+      [this, interval_ns] {
+        while (!exit_.load(std::memory_order_relaxed)) {
+          threading::NanoSleep(interval_ns);
+          processor_->RequestSample();
+        }
+      },
+      "Guest Profiler");
+  if (!timer_) {
+    processor_->SetSampleHook(nullptr);
+    XELOGE("Guest profiler: cannot start the timer thread");
+    return false;
+  }
+  XELOGI("Guest profiler: sampling every {} us, {} functions mapped",
+         interval_us, functions->functions().size());
+  return true;
+}
+
+void GuestProfiler::Stop() {
+  if (!timer_) return;
+  exit_.store(true, std::memory_order_relaxed);
+  timer_->Join();
+  timer_.reset();
+  processor_->SetSampleHook(nullptr);
+  XELOGI("Guest profiler: {} samples", sample_count());
+}
+
+uint32_t GuestProfiler::FunctionOf(uint32_t address) const {
+  const GuestFunction* function = functions_->Lookup(address);
+  return function ? function->start : 0;
+}
+
+void GuestProfiler::Sample(const ThreadState& thread) {
+  // Leaf first; return addresses are looked up at the bl (ra - 4), which
+  // is inside the caller even when the call is its last instruction
+  uint32_t frames[kMaxDepth];
+  uint32_t depth = 0;
+  frames[depth++] = FunctionOf(thread.pc);
+
+  uint32_t returns[kMaxDepth];
+  uint32_t return_count = 0;
+  uint32_t sp = static_cast<uint32_t>(thread.gpr[1]);
+  while (return_count < kMaxDepth - 2) {
+    uint32_t caller_sp, ra;
+    if (!ReadGuest32(sp, &caller_sp) || caller_sp <= sp ||
+        caller_sp - sp > kMaxFrameSize ||
+        !ReadGuest32(caller_sp - 8, &ra) || ra < 4) {
+      break;
+    }
+    returns[return_count++] = ra;
+    sp = caller_sp;
+  }
+
+  // A function that has not saved LR yet (a leaf, or a prologue) has its
+  // return address only in LR. Once saved, LR is either that same address
+  // or a return point inside the function itself.
+  uint32_t lr = static_cast<uint32_t>(thread.lr);
+  if (lr >= 4 && (!return_count || returns[0] != lr)) {
+    uint32_t caller = FunctionOf(lr - 4);
+    if (caller != frames[0]) frames[depth++] = caller;
+  }
+  for (uint32_t i = 0; i < return_count && depth < kMaxDepth; ++i) {
+    frames[depth++] = FunctionOf(returns[i] - 4);
+  }
+
+  std::vector<uint32_t> key;
+  key.reserve(depth + 1);
+  key.push_back(thread.thread_id);
+  for (uint32_t i = depth; i-- > 0;) key.push_back(frames[i]);
+
+  threading::LockGuard lock(mutex_);
+  ++stacks_[std::move(key)];
+  samples_.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool GuestProfiler::WriteFolded(const std::string& path) const {
+  FILE* f = fopen(path.c_str(), "w");
+  if (!f) {
+    XELOGE("Guest profiler: cannot write {}", path);
+    return false;
+  }
+  threading::LockGuard lock(mutex_);
+  for (const auto& [key, count] : stacks_) {
+    fprintf(f, "thread_%u", key[0]);
+    for (size_t i = 1; i < key.size(); ++i) {
+      if (key[i]) {
+        fprintf(f, ";%s", GuestFunctionMap::Name(key[i]).c_str());
+      } else {
+        fprintf(f, ";[unknown]");
+      }
+    }
+    fprintf(f, " %llu\n", static_cast<unsigned long long>(count));
+  }
+  bool ok = !ferror(f);
+  ok = (fclose(f) == 0) && ok;
+  if (!ok) {
+    XELOGE("Guest profiler: write to {} failed", path);
+    return false;
+  }
+  XELOGI("Guest profiler: {} stacks ({} samples) to {}", stacks_.size(),
+         sample_count(), path);
+  return true;
+}
+
+}  // namespace xe::cpu
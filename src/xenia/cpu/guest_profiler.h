@@ -0,0 +1,76 @@
+/**
+ * Vera360 — Xenia Edge
+ * Guest profiler — sampled call stacks of guest code, as folded stacks
+ *
+ * A timer thread asks the processor for a sample every interval; the
+ * interpreter takes it at its next instruction boundary, on the thread
+ * running guest code, so the walk sees consistent registers and stack.
+ * The stack is the PC, then the saved return address of each frame along
+ * the r1 back chain (the Xbox 360 ABI keeps it 8 bytes below the caller's
+ * stack pointer), plus LR when the sampled function has not saved it
+ * yet. Every address is mapped to its function through the module's
+ * GuestFunctionMap, and samples are counted per (guest thread, stack).
+ *
+ * WriteFolded emits one line per stack, root first, for flamegraph.pl,
+ * inferno or speedscope:
+ *
+ *   thread_1;guest_82001000;guest_82004A30 812
+ *
+ * Time in HLE calls is counted against the guest function that made them.
+ */
+#pragma once
+
+#include "xenia/base/threading.h"
+#include "xenia/cpu/guest_function_map.h"
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace xe::cpu {
+
+class Processor;
+struct ThreadState;
+
+class GuestProfiler {
+ public:
+  /// Frames kept per sample, leaf first
+  static constexpr uint32_t kMaxDepth = 64;
+
+  GuestProfiler();
+  ~GuestProfiler();
+
+  /// functions must outlive Stop
+  bool Start(Processor* processor, const GuestFunctionMap* functions,
+             uint32_t interval_us);
+  void Stop();
+
+  bool WriteFolded(const std::string& path) const;
+
+  uint64_t sample_count() const {
+    return samples_.load(std::memory_order_relaxed);
+  }
+
+  GuestProfiler(const GuestProfiler&) = delete;
+  GuestProfiler& operator=(const GuestProfiler&) = delete;
+
+ private:
+  void Sample(const ThreadState& thread);
+  /// Function start for address; 0 for addresses outside every function
+  uint32_t FunctionOf(uint32_t address) const;
+
+  Processor* processor_ = nullptr;
+  const GuestFunctionMap* functions_ = nullptr;
+  std::unique_ptr<threading::Thread> timer_;
+  std::atomic<bool> exit_{false};
+  std::atomic<uint64_t> samples_{0};
+
+  /// Key: guest thread id, then function starts root first
+  mutable threading::Mutex mutex_;
+  std::map<std::vector<uint32_t>, uint64_t> stacks_;
+};
+
+}  // namespace xe::cpu
@@ -6,6 +6,8 @@
 #include "xenia/cpu/processor.h"
 #include "xenia/cpu/frontend/ppc_interpreter.h"
 #include "xenia/base/logging.h"
+#include "xenia/base/state_stream.h"
+#include "xenia/base/trace.h"
 
 namespace xe::cpu {
 
@@ -55,6 +57,18 @@ void Processor::SetKernelDispatch(KernelDispatchFn fn) {
   }
 }
 
+void Processor::SetSampleHook(SampleFn fn) {
+  if (interpreter_) {
+    interpreter_->SetSampleHook(std::move(fn));
+  }
+}
+
+void Processor::RequestSample() {
+  if (interpreter_) {
+    interpreter_->RequestSample();
+  }
+}
+
 void Processor::RegisterThunk(uint32_t guest_addr, uint32_t ordinal) {
   if (interpreter_) {
     interpreter_->RegisterThunk(guest_addr, ordinal);
@@ -94,6 +108,7 @@ void Processor::Execute(ThreadState* thread, uint32_t start_address) {
 
 uint64_t Processor::ExecuteBounded(ThreadState* thread, uint32_t start_address,
                                    uint64_t max_instructions) {
+  XE_TRACE_ZONE_VALUE("cpu", "ExecuteBounded", thread->thread_id);
   thread->pc = start_address;
   thread->running = true;
 
@@ -112,4 +127,50 @@ void Processor::Step(ThreadState* thread) {
   }
 }
 
+// ── Save states ─────────────────────────────────────────────────────────────
+
+void Processor::SaveState(StateWriter& writer) const {
+  writer.Write(static_cast<uint32_t>(thread_states_.size()));
+  for (const auto& ts : thread_states_) {
+    writer.Write(ts->gpr);
+    writer.Write(ts->lr);
+    writer.Write(ts->ctr);
+    writer.Write(ts->xer);
+    writer.Write(ts->cr);
+    writer.Write(ts->fpr);
+    writer.Write(ts->vmx);
+    writer.Write(ts->pc);
+    writer.Write(ts->thread_id);
+    writer.Write(ts->reserve_address);
+    writer.Write(ts->reserve_valid);
+    writer.Write(ts->running);
+  }
+}
+
+bool Processor::RestoreState(StateReader& reader) {
+  uint32_t count = 0;
+  if (!reader.Read(&count)) return false;
+  std::vector<std::unique_ptr<ThreadState>> states;
+  for (uint32_t i = 0; i < count; ++i) {
+    auto ts = std::make_unique<ThreadState>();
+    reader.Read(&ts->gpr);
+    reader.Read(&ts->lr);
+    reader.Read(&ts->ctr);
+    reader.Read(&ts->xer);
+    reader.Read(&ts->cr);
+    reader.Read(&ts->fpr);
+    reader.Read(&ts->vmx);
+    reader.Read(&ts->pc);
+    reader.Read(&ts->thread_id);
+    reader.Read(&ts->reserve_address);
+    reader.Read(&ts->reserve_valid);
+    if (!reader.Read(&ts->running)) return false;
+    states.push_back(std::move(ts));
+  }
+  thread_states_ = std::move(states);
+  if (backend_) backend_->InvalidateCode(0, 0xFFFFFFFF);
+  XELOGI("Restored {} CPU thread states", count);
+  return true;
+}
+
 }  // namespace xe::cpu
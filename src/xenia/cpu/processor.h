@@ -13,6 +13,7 @@
 #include <unordered_map>
 #include <vector>
 
+namespace xe { class StateReader; class StateWriter; }
 namespace xe::cpu::frontend { class PPCInterpreter; }
 
 namespace xe::cpu {
@@ -45,6 +46,7 @@ struct ThreadState {
   // Reservation (for lwarx/stwcx atomic ops)
   uint32_t reserve_address = 0;
   bool reserve_valid = false;
+  uint64_t reserve_epoch = 0;  // interpreter's store epoch at the lwarx
 
   // Running flag — set to false to stop execution
   bool running = true;
@@ -53,6 +55,9 @@ struct ThreadState {
 /// HLE kernel export callback: (thread_state, ordinal)
 using KernelDispatchFn = std::function<void(ThreadState*, uint32_t)>;
 
+/// Profiler sample callback, on the thread executing guest code
+using SampleFn = std::function<void(const ThreadState&)>;
+
 /// Execution mode
 enum class ExecMode : uint8_t {
   kInterpreter = 0,
@@ -87,6 +92,16 @@ class Processor {
   /// Step one instruction (for debugging)
   void Step(ThreadState* thread);
 
+  /// Sampling profiler hook (interpreter only): RequestSample, from any
+  /// thread, has the hook called with the running guest thread's state
+  void SetSampleHook(SampleFn fn);
+  void RequestSample();
+
+  /// Save states: registers of every thread. Restore replaces all thread
+  /// states and drops compiled code (guest memory is about to change).
+  void SaveState(StateWriter& writer) const;
+  bool RestoreState(StateReader& reader);
+
   backend::arm64::ARM64Backend* GetBackend() { return backend_.get(); }
   frontend::PPCInterpreter* GetInterpreter() { return interpreter_.get(); }
   ExecMode exec_mode() const { return exec_mode_; }
@@ -9,6 +9,8 @@
 #include "xenia/gpu/gpu_command_processor.h"
 #include "xenia/base/memory/memory.h"
 #include "xenia/base/logging.h"
+#include "xenia/base/state_stream.h"
+#include "xenia/base/trace.h"
 
 #include <cstring>
 
@@ -90,6 +92,7 @@ void GpuCommandProcessor::ProcessPendingCommands() {
 }
 
 void GpuCommandProcessor::ProcessRingBuffer(uint32_t read_ptr, uint32_t write_ptr) {
+  XE_TRACE_ZONE("gpu", "ProcessRingBuffer");
   uint8_t* guest_base = xe::memory::GetGuestBase();
   if (!guest_base || ring_size_ == 0) return;
 
@@ -366,4 +369,32 @@ void GpuCommandProcessor::HandleIndirectBuffer(const uint32_t* data, uint32_t co
   ring_size_ = saved_size;
 }
 
+// ── Save states ─────────────────────────────────────────────────────────────
+
+void GpuCommandProcessor::SaveState(StateWriter& writer) const {
+  writer.Write(kXenosRegisterCount);
+  writer.Write(regs_.values);
+  writer.Write(ring_base_);
+  writer.Write(ring_size_);
+  writer.Write(ring_read_ptr_);
+  writer.Write(ring_write_ptr_);
+  writer.Write(total_draw_calls_);
+}
+
+bool GpuCommandProcessor::RestoreState(StateReader& reader) {
+  uint32_t register_count = 0;
+  if (!reader.Read(&register_count) || register_count != kXenosRegisterCount ||
+      reader.remaining() < sizeof(regs_.values) + 5 * sizeof(uint32_t)) {
+    return false;
+  }
+  reader.Read(&regs_.values);
+  reader.Read(&ring_base_);
+  reader.Read(&ring_size_);
+  reader.Read(&ring_read_ptr_);
+  reader.Read(&ring_write_ptr_);
+  reader.Read(&total_draw_calls_);
+  draw_calls_.clear();
+  return true;
+}
+
 }  // namespace xe::gpu
@@ -9,7 +9,11 @@
 #include <functional>
 #include <memory>
 #include <vector>
-#include <vulkan/vulkan.h>
+
+namespace xe {
+class StateReader;
+class StateWriter;
+}
 
 namespace xe::gpu {
 
@@ -135,6 +139,10 @@ class GpuCommandProcessor {
 
   uint32_t draw_call_count() const { return total_draw_calls_; }
 
+  /// Save states: registers and ring buffer position
+  void SaveState(StateWriter& writer) const;
+  bool RestoreState(StateReader& reader);
+
  private:
   void ExecutePacketType0(uint32_t header, const uint32_t* data);
   void ExecutePacketType3(uint32_t header, const uint32_t* data, uint32_t count);
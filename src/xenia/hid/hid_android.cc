@@ -4,66 +4,112 @@
  */
 
 #include "xenia/hid/hid_android.h"
+#include "xenia/base/clock.h"
 #include "xenia/base/logging.h"
+#include "xenia/base/seqlock.h"
+#include "xenia/hid/input_latency.h"
 #include <array>
+#include <cstring>
 #include <mutex>
 
 namespace xe::hid {
 
-/// Gamepad state for up to 4 controllers
-static std::array<GamepadState, 4> g_gamepads;
-static std::mutex g_gamepad_mutex;
+/// Published state for up to 4 controllers, read lock-free by the guest
+static std::array<SeqLock<PadSample>, 4> g_pads;
+/// Writer-side copies; updates read-modify-write these, then publish
+static std::array<PadSample, 4> g_pending;
+static std::mutex g_writer_mutex;
+
+namespace {
+
+int16_t ToThumb(float v) { return static_cast<int16_t>(v * 32767.0f); }
+
+/// Stamp and publish the pending state if the update changed it
+void Publish(int pad, const GamepadState& before) {
+  PadSample& sample = g_pending[pad];
+  if (!memcmp(&before, &sample.state, sizeof(GamepadState))) return;
+  sample.packet++;
+  sample.host_time_ns = Clock::QueryHostTickCount();
+  g_pads[pad].Store(sample);
+}
+
+}  // namespace
 
 /// Called from JNI/touch overlay to update button state
 void SetButton(int pad, uint16_t button, bool pressed) {
-  std::lock_guard<std::mutex> lock(g_gamepad_mutex);
+  std::lock_guard<std::mutex> lock(g_writer_mutex);
   if (pad < 0 || pad >= 4) return;
+  GamepadState before = g_pending[pad].state;
   if (pressed) {
-    g_gamepads[pad].buttons |= button;
+    g_pending[pad].state.buttons |= button;
   } else {
-    g_gamepads[pad].buttons &= ~button;
+    g_pending[pad].state.buttons &= ~button;
   }
+  Publish(pad, before);
 }
 
 /// Set full button mask at once (replaces all buttons)
 void SetButtonsRaw(int pad, uint16_t buttons) {
-  std::lock_guard<std::mutex> lock(g_gamepad_mutex);
+  std::lock_guard<std::mutex> lock(g_writer_mutex);
   if (pad < 0 || pad >= 4) return;
-  g_gamepads[pad].buttons = buttons;
+  GamepadState before = g_pending[pad].state;
+  g_pending[pad].state.buttons = buttons;
+  Publish(pad, before);
 }
 
 /// Called from JNI/touch overlay to set analog stick
 void SetAnalog(int pad, bool left, float x, float y) {
-  std::lock_guard<std::mutex> lock(g_gamepad_mutex);
+  std::lock_guard<std::mutex> lock(g_writer_mutex);
   if (pad < 0 || pad >= 4) return;
-  int16_t ix = static_cast<int16_t>(x * 32767.0f);
-  int16_t iy = static_cast<int16_t>(y * 32767.0f);
+  GamepadState before = g_pending[pad].state;
   if (left) {
-    g_gamepads[pad].thumb_lx = ix;
-    g_gamepads[pad].thumb_ly = iy;
+    g_pending[pad].state.thumb_lx = ToThumb(x);
+    g_pending[pad].state.thumb_ly = ToThumb(y);
   } else {
-    g_gamepads[pad].thumb_rx = ix;
-    g_gamepads[pad].thumb_ry = iy;
+    g_pending[pad].state.thumb_rx = ToThumb(x);
+    g_pending[pad].state.thumb_ry = ToThumb(y);
   }
+  Publish(pad, before);
 }
 
 /// Called from JNI to set trigger value
 void SetTrigger(int pad, bool left, float value) {
-  std::lock_guard<std::mutex> lock(g_gamepad_mutex);
+  std::lock_guard<std::mutex> lock(g_writer_mutex);
   if (pad < 0 || pad >= 4) return;
+  GamepadState before = g_pending[pad].state;
   uint8_t v = static_cast<uint8_t>(value * 255.0f);
   if (left) {
-    g_gamepads[pad].left_trigger = v;
+    g_pending[pad].state.left_trigger = v;
   } else {
-    g_gamepads[pad].right_trigger = v;
+    g_pending[pad].state.right_trigger = v;
   }
+  Publish(pad, before);
+}
+
+/// Called from JNI with the whole controller, so a poll never sees the
+/// buttons of one update with the sticks of another
+void SetControllerState(int pad, uint16_t buttons, float lx, float ly,
+                        float rx, float ry) {
+  std::lock_guard<std::mutex> lock(g_writer_mutex);
+  if (pad < 0 || pad >= 4) return;
+  GamepadState before = g_pending[pad].state;
+  GamepadState& state = g_pending[pad].state;
+  state.buttons = buttons;
+  state.thumb_lx = ToThumb(lx);
+  state.thumb_ly = ToThumb(ly);
+  state.thumb_rx = ToThumb(rx);
+  state.thumb_ry = ToThumb(ry);
+  Publish(pad, before);
 }
 
 /// Get current pad state (used by kernel XInput shim)
 GamepadState GetState(int pad) {
-  std::lock_guard<std::mutex> lock(g_gamepad_mutex);
+  return ReadPad(pad).state;
+}
+
+PadSample ReadPad(int pad) {
   if (pad < 0 || pad >= 4) return {};
-  return g_gamepads[pad];
+  return g_pads[pad].Load();
 }
 
 bool Initialize() {
@@ -72,6 +118,7 @@ bool Initialize() {
 }
 
 void Shutdown() {
+  LogInputLatency();
   XELOGI("HID Android shutdown");
 }
 
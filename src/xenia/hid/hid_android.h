@@ -1,6 +1,11 @@
 /**
  * Vera360 — Xenia Edge
  * HID Android — input from Android touch overlay + gamepads
+ *
+ * The JNI side updates pads on the UI thread while the guest polls them
+ * from its own threads. Each pad is published through a seqlock, so a poll
+ * never waits and always sees one whole update, stamped with the host time
+ * it arrived for latency measurement.
  */
 #pragma once
 
@@ -19,6 +24,13 @@ struct GamepadState {
   int16_t thumb_ry = 0;
 };
 
+/// A pad's state with when it last changed
+struct PadSample {
+  GamepadState state;
+  uint32_t packet = 0;        // bumps on every change, like dwPacketNumber
+  uint64_t host_time_ns = 0;  // Clock::QueryHostTickCount at arrival
+};
+
 /// Button masks
 namespace Button {
   constexpr uint16_t kDpadUp    = 0x0001;
@@ -51,7 +63,12 @@ void SetButtonsRaw(int pad, uint16_t buttons);
 void SetAnalog(int pad, bool left, float x, float y);
 /// Set trigger value from JNI
 void SetTrigger(int pad, bool left, float value);
+/// Set buttons and both sticks as a single update
+void SetControllerState(int pad, uint16_t buttons, float lx, float ly,
+                        float rx, float ry);
 /// Get current pad state (used by kernel XInput shim)
 GamepadState GetState(int pad);
+/// Current pad state with its packet number and arrival time; lock-free
+PadSample ReadPad(int pad);
 
 }  // namespace xe::hid
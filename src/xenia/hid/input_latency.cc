@@ -0,0 +1,171 @@
+/**
+ * Vera360 — Xenia Edge
+ * Input latency — from a pad update's arrival to the guest and the screen
+ */
+
+#include "xenia/hid/input_latency.h"
+#include "xenia/base/clock.h"
+#include "xenia/base/logging.h"
+
+#include <algorithm>
+#include <array>
+
+namespace xe::hid {
+
+namespace {
+
+constexpr int kPadCount = 4;
+// Frames the typical poll point is taken over
+constexpr size_t kPollWindow = 32;
+
+LatencyHistogram g_guest_read;
+LatencyHistogram g_present;
+LatencyHistogram g_poll_offset;
+/// Packet of the last sample the guest polled, per pad
+std::atomic<uint32_t> g_read_packet[kPadCount] = {};
+/// Arrival of the oldest polled update not yet presented (0 = none)
+std::atomic<uint64_t> g_unpresented[kPadCount] = {};
+
+// Current frame: its start and its first poll's offset (UINT64_MAX = none)
+std::atomic<uint64_t> g_frame_start{0};
+std::atomic<uint64_t> g_first_poll{UINT64_MAX};
+// Recent first-poll offsets (frame loop thread only)
+std::array<uint64_t, kPollWindow> g_poll_window;
+size_t g_poll_count = 0;
+size_t g_frames_since_poll = kPollWindow;
+
+void LogSummary(const char* name, const LatencyHistogram::Summary& s) {
+  if (!s.count) return;
+  XELOGI("Input latency {}: {} samples, mean {} us, p50 {} us, p99 {} us, "
+         "max {} us",
+         name, s.count, s.mean_us, s.p50_us, s.p99_us, s.max_us);
+}
+
+}  // namespace
+
+// ── LatencyHistogram ─────────────────────────────────────────────────────────
+
+void LatencyHistogram::Record(uint64_t ns) {
+  uint64_t bucket =
+      std::min<uint64_t>(ns / (kBucketUs * 1000ull), kBuckets - 1);
+  buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+  total_ns_.fetch_add(ns, std::memory_order_relaxed);
+  uint64_t max = max_ns_.load(std::memory_order_relaxed);
+  while (ns > max && !max_ns_.compare_exchange_weak(
+                         max, ns, std::memory_order_relaxed)) {
+  }
+}
+
+LatencyHistogram::Summary LatencyHistogram::Summarize() const {
+  Summary summary;
+  uint64_t counts[kBuckets];
+  for (uint32_t i = 0; i < kBuckets; ++i) {
+    counts[i] = buckets_[i].load(std::memory_order_relaxed);
+    summary.count += counts[i];
+  }
+  if (!summary.count) return summary;
+  summary.mean_us = total_ns_.load(std::memory_order_relaxed) / summary.count /
+                    1000;
+  summary.max_us = max_ns_.load(std::memory_order_relaxed) / 1000;
+  uint64_t p50 = (summary.count + 1) / 2;
+  uint64_t p99 = summary.count - summary.count / 100;
+  uint64_t seen = 0;
+  for (uint32_t i = 0; i < kBuckets; ++i) {
+    uint64_t before = seen;
+    seen += counts[i];
+    uint64_t upper_us = std::min<uint64_t>(uint64_t(i + 1) * kBucketUs,
+                                           summary.max_us);
+    if (before < p50 && seen >= p50) summary.p50_us = upper_us;
+    if (before < p99 && seen >= p99) summary.p99_us = upper_us;
+  }
+  return summary;
+}
+
+void LatencyHistogram::Reset() {
+  for (auto& bucket : buckets_) bucket.store(0, std::memory_order_relaxed);
+  total_ns_.store(0, std::memory_order_relaxed);
+  max_ns_.store(0, std::memory_order_relaxed);
+}
+
+// ── Measurement points ───────────────────────────────────────────────────────
+
+void NoteGuestPoll(int pad, const PadSample& sample) {
+  if (pad < 0 || pad >= kPadCount) return;
+  uint64_t now = Clock::QueryHostTickCount();
+  uint64_t frame_start = g_frame_start.load(std::memory_order_relaxed);
+  if (frame_start && now >= frame_start) {
+    uint64_t none = UINT64_MAX;
+    g_first_poll.compare_exchange_strong(none, now - frame_start,
+                                         std::memory_order_relaxed);
+  }
+
+  // Only the first poll of an update counts
+  if (!sample.host_time_ns ||
+      g_read_packet[pad].exchange(sample.packet, std::memory_order_relaxed) ==
+          sample.packet) {
+    return;
+  }
+  g_guest_read.Record(now > sample.host_time_ns ? now - sample.host_time_ns
+                                                : 0);
+  uint64_t none = 0;
+  g_unpresented[pad].compare_exchange_strong(none, sample.host_time_ns,
+                                             std::memory_order_relaxed);
+}
+
+void NotePresent() {
+  uint64_t now = Clock::QueryHostTickCount();
+  for (auto& unpresented : g_unpresented) {
+    uint64_t arrival = unpresented.exchange(0, std::memory_order_relaxed);
+    if (arrival) g_present.Record(now > arrival ? now - arrival : 0);
+  }
+}
+
+// ── Frame bracketing ─────────────────────────────────────────────────────────
+
+void BeginFrame() {
+  g_first_poll.store(UINT64_MAX, std::memory_order_relaxed);
+  g_frame_start.store(Clock::QueryHostTickCount(), std::memory_order_relaxed);
+}
+
+void EndFrame() {
+  g_frame_start.store(0, std::memory_order_relaxed);
+  uint64_t offset = g_first_poll.load(std::memory_order_relaxed);
+  if (offset == UINT64_MAX) {
+    g_frames_since_poll++;
+    return;
+  }
+  g_frames_since_poll = 0;
+  g_poll_offset.Record(offset);
+  g_poll_window[g_poll_count++ % kPollWindow] = offset;
+}
+
+uint64_t TypicalPollOffset() {
+  size_t count = std::min(g_poll_count, kPollWindow);
+  if (!count || g_frames_since_poll >= kPollWindow) return 0;
+  std::array<uint64_t, kPollWindow> sorted = g_poll_window;
+  std::nth_element(sorted.begin(), sorted.begin() + count / 2,
+                   sorted.begin() + count);
+  return sorted[count / 2];
+}
+
+InputLatencyReport GetInputLatency() {
+  return {g_guest_read.Summarize(), g_present.Summarize(),
+          g_poll_offset.Summarize()};
+}
+
+void ResetInputLatency() {
+  g_guest_read.Reset();
+  g_present.Reset();
+  g_poll_offset.Reset();
+  g_poll_count = 0;
+  g_frames_since_poll = kPollWindow;
+}
+
+void LogInputLatency() {
+  InputLatencyReport report = GetInputLatency();
+  LogSummary("to guest poll", report.guest_read);
+  LogSummary("to present", report.present);
+  LogSummary("frame start to poll", report.poll_offset);
+}
+
+}  // namespace xe::hid
@@ -0,0 +1,72 @@
+/**
+ * Vera360 — Xenia Edge
+ * Input latency — from a pad update's arrival to the guest and the screen
+ *
+ * Every pad update carries the host time it arrived (PadSample). The first
+ * guest poll that sees an update records how long it waited; the update
+ * then counts as unpresented until the next frame goes to the swap chain,
+ * which records arrival-to-present, the part of the lag the player feels
+ * short of display scan-out.
+ *
+ * The frame loop also brackets each frame, so the time from frame start to
+ * the guest's first poll is known; its recent median is where the title
+ * typically samples input. The loop only schedules frames late while the
+ * title is polling at all.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "xenia/hid/hid_android.h"
+
+namespace xe::hid {
+
+/// Lock-free latency histogram, 250 us buckets up to 100 ms
+class LatencyHistogram {
+ public:
+  static constexpr uint32_t kBucketUs = 250;
+  static constexpr uint32_t kBuckets = 400;  // the last one takes the rest
+
+  struct Summary {
+    uint64_t count = 0;
+    uint64_t mean_us = 0;
+    uint64_t p50_us = 0;  // bucket upper bounds
+    uint64_t p99_us = 0;
+    uint64_t max_us = 0;
+  };
+
+  void Record(uint64_t ns);
+  Summary Summarize() const;
+  void Reset();
+
+ private:
+  std::atomic<uint64_t> buckets_[kBuckets] = {};
+  std::atomic<uint64_t> total_ns_{0};
+  std::atomic<uint64_t> max_ns_{0};
+};
+
+struct InputLatencyReport {
+  LatencyHistogram::Summary guest_read;   // arrival → first guest poll
+  LatencyHistogram::Summary present;      // arrival → next present after it
+  LatencyHistogram::Summary poll_offset;  // frame start → first guest poll
+};
+
+/// The guest polled pad and got sample (XInputGetState)
+void NoteGuestPoll(int pad, const PadSample& sample);
+/// A frame was handed to the swap chain
+void NotePresent();
+
+/// Bracket one frame of guest execution (frame loop thread)
+void BeginFrame();
+void EndFrame();
+/// Median time from frame start to the first guest poll over recent
+/// frames that polled; 0 if the guest has not polled lately
+uint64_t TypicalPollOffset();
+
+InputLatencyReport GetInputLatency();
+void ResetInputLatency();
+/// One line per measurement, if anything was measured
+void LogInputLatency();
+
+}  // namespace xe::hid
@@ -4,35 +4,46 @@
  */
 
 #include "xenia/base/logging.h"
+#include "xenia/base/replay.h"
+#include "xenia/hid/hid_android.h"
+#include "xenia/hid/input_latency.h"
 #include <cstdint>
 
 namespace xe::hid {
 
-/// Xbox 360 gamepad state (XINPUT_GAMEPAD-like) — must match hid_android.cc
-struct GamepadState {
-  uint16_t buttons = 0;
-  uint8_t left_trigger = 0;
-  uint8_t right_trigger = 0;
-  int16_t thumb_lx = 0;
-  int16_t thumb_ly = 0;
-  int16_t thumb_rx = 0;
-  int16_t thumb_ry = 0;
+namespace {
+
+/// kPadPoll payload
+struct PadPoll {
+  uint32_t user_index;
+  uint32_t packet;
+  GamepadState state;
 };
 
-extern GamepadState GetState(int pad);
+}  // namespace
 
 /// Called from kernel shim when game calls XInputGetState
 uint32_t XInputGetState(uint32_t user_index, void* out_state) {
   if (user_index > 3) return 0x048F;  // ERROR_DEVICE_NOT_CONNECTED
-  
-  auto state = GetState(static_cast<int>(user_index));
-  
+
   // For user_index == 0, always connected (touch overlay)
   // Others: only if a Bluetooth gamepad is connected
   if (user_index > 0) {
     return 0x048F;  // TODO: detect BT gamepads
   }
 
+  // Lock-free snapshot; the first poll of each update times its latency
+  PadSample sample = ReadPad(static_cast<int>(user_index));
+  NoteGuestPoll(static_cast<int>(user_index), sample);
+
+  // Recorded runs log what the guest saw; replays see it again
+  PadPoll poll = {user_index, sample.packet, sample.state};
+  if (replay::Exchange(replay::Event::kPadPoll, &poll, sizeof(poll))) {
+    sample.packet = poll.packet;
+    sample.state = poll.state;
+  }
+  const GamepadState& state = sample.state;
+
   // Write state to guest memory
   // The caller is responsible for byte-swapping to big-endian
   if (out_state) {
@@ -7,7 +7,20 @@
 #include "xenia/kernel/xobject.h"
 #include "xenia/kernel/xthread.h"
 #include "xenia/kernel/xmodule.h"
+#include "xenia/vfs/virtual_file_system.h"
 #include "xenia/base/logging.h"
+#include "xenia/base/state_stream.h"
+
+#include <algorithm>
+#include <functional>
+
+namespace xe::kernel::xboxkrnl {
+void SaveMemoryState(StateWriter& writer);
+// Restores parse and validate; *apply then commits and cannot fail
+bool RestoreMemoryState(StateReader& reader, std::function<void()>* apply);
+void SaveFileState(StateWriter& writer);
+bool RestoreFileState(StateReader& reader, std::function<void()>* apply);
+}
 
 namespace xe::kernel {
 
@@ -19,6 +32,11 @@ KernelState::~KernelState() = default;
 KernelState* KernelState::shared() { return shared_instance_; }
 void KernelState::SetShared(KernelState* state) { shared_instance_ = state; }
 
+void KernelState::SetFileSystem(
+    std::unique_ptr<vfs::VirtualFileSystem> file_system) {
+  file_system_ = std::move(file_system);
+}
+
 uint32_t KernelState::AllocateHandle() {
   std::lock_guard<std::mutex> lock(object_mutex_);
   return next_handle_++;
@@ -131,4 +149,254 @@ KernelState::EventState* KernelState::GetEventState(uint32_t handle) {
   return it != event_states_.end() ? &it->second : nullptr;
 }
 
+// ── Save states ─────────────────────────────────────────────────────────────
+
+namespace {
+// Handle table entry kinds
+constexpr uint8_t kHandleThread = 0;  // value = index into the thread list
+constexpr uint8_t kHandleModule = 1;  // value = index into the module list
+}
+
+void KernelState::SaveState(StateWriter& writer) {
+  std::vector<XModule*> modules;
+  {
+    std::lock_guard<std::mutex> lock(object_mutex_);
+    writer.Write(next_handle_);
+    writer.Write(static_cast<uint64_t>(current_thread_idx_));
+
+    writer.Write(static_cast<uint32_t>(threads_.size()));
+    for (auto* t : threads_) {
+      writer.Write(t->handle());
+      writer.Write(t->stack_size());
+      writer.Write(t->entry_point());
+      writer.Write(t->parameter());
+      writer.Write(t->thread_id());
+      writer.Write(t->suspend_count());
+      writer.Write(t->is_terminated());
+      writer.Write(t->exit_code());
+      writer.WriteString(t->name());
+    }
+
+    for (auto& [handle, obj] : objects_) {
+      if (obj->type() != XObject::Type::kModule) continue;
+      auto* module = static_cast<XModule*>(obj);
+      if (std::find(modules.begin(), modules.end(), module) == modules.end()) {
+        modules.push_back(module);
+      }
+    }
+    writer.Write(static_cast<uint32_t>(modules.size()));
+    for (auto* m : modules) {
+      writer.WriteString(m->path());
+      writer.Write(m->base_address());
+      writer.Write(m->entry_point());
+    }
+
+    // Handles, including duplicates and threads whose handle was closed
+    std::vector<std::pair<uint32_t, std::pair<uint8_t, uint32_t>>> handles;
+    for (auto& [handle, obj] : objects_) {
+      if (obj->type() == XObject::Type::kThread) {
+        auto it = std::find(threads_.begin(), threads_.end(), obj);
+        if (it == threads_.end()) continue;
+        handles.push_back({handle, {kHandleThread,
+                                    uint32_t(it - threads_.begin())}});
+      } else if (obj->type() == XObject::Type::kModule) {
+        auto it = std::find(modules.begin(), modules.end(), obj);
+        handles.push_back({handle, {kHandleModule,
+                                    uint32_t(it - modules.begin())}});
+      }
+    }
+    writer.Write(static_cast<uint32_t>(handles.size()));
+    for (auto& [handle, ref] : handles) {
+      writer.Write(handle);
+      writer.Write(ref.first);
+      writer.Write(ref.second);
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(tls_mutex_);
+    writer.Write(next_tls_slot_);
+    writer.Write(static_cast<uint32_t>(tls_data_.size()));
+    for (auto& [thread_id, slots] : tls_data_) {
+      writer.Write(thread_id);
+      writer.Write(static_cast<uint32_t>(slots.size()));
+      for (auto& [slot, value] : slots) {
+        writer.Write(slot);
+        writer.Write(value);
+      }
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(event_mutex_);
+    writer.Write(static_cast<uint32_t>(event_states_.size()));
+    for (auto& [handle, es] : event_states_) {
+      writer.Write(handle);
+      writer.Write(es.signaled);
+      writer.Write(es.manual_reset);
+    }
+  }
+
+  xboxkrnl::SaveMemoryState(writer);
+  xboxkrnl::SaveFileState(writer);
+}
+
+bool KernelState::RestoreState(StateReader& reader) {
+  struct SavedThread {
+    uint32_t handle, stack_size, entry, param, thread_id, suspend_count;
+    bool terminated;
+    uint32_t exit_code;
+    std::string name;
+  };
+  uint32_t next_handle = 0, count = 0;
+  uint64_t current_idx = 0;
+  reader.Read(&next_handle);
+  reader.Read(&current_idx);
+  std::vector<SavedThread> saved_threads;
+  if (!reader.Read(&count)) return false;
+  for (uint32_t i = 0; i < count && reader.ok(); ++i) {
+    SavedThread t;
+    reader.Read(&t.handle);
+    reader.Read(&t.stack_size);
+    reader.Read(&t.entry);
+    reader.Read(&t.param);
+    reader.Read(&t.thread_id);
+    reader.Read(&t.suspend_count);
+    reader.Read(&t.terminated);
+    reader.Read(&t.exit_code);
+    reader.ReadString(&t.name);
+    saved_threads.push_back(std::move(t));
+  }
+
+  // Modules must already be loaded, at the same addresses
+  std::vector<XModule*> modules;
+  if (!reader.Read(&count)) return false;
+  for (uint32_t i = 0; i < count; ++i) {
+    std::string path;
+    uint32_t base = 0, entry = 0;
+    reader.ReadString(&path);
+    reader.Read(&base);
+    if (!reader.Read(&entry)) return false;
+    XModule* match = nullptr;
+    {
+      std::lock_guard<std::mutex> lock(object_mutex_);
+      for (auto& [h, obj] : objects_) {
+        if (obj->type() != XObject::Type::kModule) continue;
+        auto* m = static_cast<XModule*>(obj);
+        if (m->path() == path && m->base_address() == base &&
+            m->entry_point() == entry) {
+          match = m;
+          break;
+        }
+      }
+    }
+    if (!match) {
+      XELOGE("Save state needs module '{}' at 0x{:08X}, which is not loaded",
+             path, base);
+      return false;
+    }
+    modules.push_back(match);
+  }
+
+  struct SavedHandle { uint32_t handle; uint8_t kind; uint32_t index; };
+  std::vector<SavedHandle> handles;
+  if (!reader.Read(&count)) return false;
+  for (uint32_t i = 0; i < count; ++i) {
+    SavedHandle h;
+    reader.Read(&h.handle);
+    reader.Read(&h.kind);
+    if (!reader.Read(&h.index)) return false;
+    size_t limit = h.kind == kHandleThread ? saved_threads.size()
+                                           : modules.size();
+    if (h.kind > kHandleModule || h.index >= limit) return false;
+    handles.push_back(h);
+  }
+
+  uint32_t next_tls_slot = 0;
+  std::unordered_map<uint32_t, std::unordered_map<uint32_t, uint64_t>> tls;
+  reader.Read(&next_tls_slot);
+  if (!reader.Read(&count)) return false;
+  for (uint32_t i = 0; i < count; ++i) {
+    uint32_t thread_id = 0, slot_count = 0;
+    reader.Read(&thread_id);
+    if (!reader.Read(&slot_count)) return false;
+    auto& slots = tls[thread_id];
+    for (uint32_t j = 0; j < slot_count; ++j) {
+      uint32_t slot = 0;
+      uint64_t value = 0;
+      reader.Read(&slot);
+      if (!reader.Read(&value)) return false;
+      slots[slot] = value;
+    }
+  }
+
+  std::unordered_map<uint32_t, EventState> events;
+  if (!reader.Read(&count)) return false;
+  for (uint32_t i = 0; i < count; ++i) {
+    uint32_t handle = 0;
+    EventState es;
+    reader.Read(&handle);
+    reader.Read(&es.signaled);
+    if (!reader.Read(&es.manual_reset)) return false;
+    events[handle] = es;
+  }
+
+  std::function<void()> apply_memory, apply_files;
+  if (!xboxkrnl::RestoreMemoryState(reader, &apply_memory) ||
+      !xboxkrnl::RestoreFileState(reader, &apply_files)) {
+    return false;
+  }
+
+  // Everything parsed and checked — swap the live state out. Nothing past
+  // this point can fail, so the machine is never left half restored.
+  {
+    std::lock_guard<std::mutex> lock(object_mutex_);
+    for (auto* t : threads_) {
+      for (auto it = objects_.begin(); it != objects_.end();) {
+        it = it->second == t ? objects_.erase(it) : std::next(it);
+      }
+      t->Release();
+    }
+    threads_.clear();
+    for (auto it = objects_.begin(); it != objects_.end();) {
+      it = it->second->type() == XObject::Type::kModule ? objects_.erase(it)
+                                                         : std::next(it);
+    }
+
+    for (auto& saved : saved_threads) {
+      auto* t = new XThread(this, saved.stack_size, saved.entry, saved.param,
+                            false);
+      t->set_handle(saved.handle);
+      t->set_thread_id(saved.thread_id);
+      t->set_suspend_count(saved.suspend_count);
+      if (saved.terminated) t->Terminate(saved.exit_code);
+      t->set_name(saved.name);
+      threads_.push_back(t);
+    }
+    for (auto& h : handles) {
+      objects_[h.handle] = h.kind == kHandleThread
+                               ? static_cast<XObject*>(threads_[h.index])
+                               : static_cast<XObject*>(modules[h.index]);
+    }
+    next_handle_ = next_handle;
+    current_thread_idx_ = threads_.empty() ? 0 : current_idx % threads_.size();
+    current_thread_ = nullptr;
+  }
+  {
+    std::lock_guard<std::mutex> lock(tls_mutex_);
+    next_tls_slot_ = next_tls_slot;
+    tls_data_ = std::move(tls);
+  }
+  {
+    std::lock_guard<std::mutex> lock(event_mutex_);
+    event_states_ = std::move(events);
+  }
+
+  apply_memory();
+  apply_files();
+  XELOGI("Restored kernel state: {} threads, {} handles", threads_.size(),
+         handles.size());
+  return true;
+}
+
 }  // namespace xe::kernel
@@ -12,6 +12,17 @@
 #include <string>
 #include <vector>
 
+namespace xe {
+class StateReader;
+class StateWriter;
+}
+namespace xe::vfs {
+class VirtualFileSystem;
+}
+namespace xe::apu {
+class ApuSystem;
+}
+
 namespace xe::kernel {
 
 class XObject;
@@ -53,6 +64,15 @@ class KernelState {
   XModule* GetExecutableModule() const { return exe_module_; }
   void SetExecutableModule(XModule* module) { exe_module_ = module; }
 
+  /// Guest file system (mounted devices + symbolic links)
+  vfs::VirtualFileSystem* file_system() const { return file_system_.get(); }
+  void SetFileSystem(std::unique_ptr<vfs::VirtualFileSystem> file_system);
+
+  /// Audio, for the XMA exports; owned by the emulator, null until the APU
+  /// is up and again once it shuts down
+  apu::ApuSystem* apu_system() const { return apu_system_; }
+  void SetApuSystem(apu::ApuSystem* apu_system) { apu_system_ = apu_system; }
+
   /// TLS
   uint32_t AllocateTLS();
   void FreeTLS(uint32_t slot);
@@ -67,6 +87,13 @@ class KernelState {
   void RegisterEvent(uint32_t handle, bool manual_reset, bool initial_state);
   EventState* GetEventState(uint32_t handle);
 
+  /// Save states: threads, the handle table, TLS, events and the xboxkrnl
+  /// allocator and file tables. Restore expects the same title to be
+  /// loaded: modules are matched, not recreated. The whole section is
+  /// parsed and checked first, so on false nothing has changed.
+  void SaveState(StateWriter& writer);
+  bool RestoreState(StateReader& reader);
+
  private:
   static KernelState* shared_instance_;
 
@@ -78,6 +105,8 @@ class KernelState {
   size_t current_thread_idx_ = 0;
   XThread* current_thread_ = nullptr;
   XModule* exe_module_ = nullptr;
+  std::unique_ptr<vfs::VirtualFileSystem> file_system_;
+  apu::ApuSystem* apu_system_ = nullptr;
 
   // TLS storage: thread_id -> (slot -> value)
   std::mutex tls_mutex_;
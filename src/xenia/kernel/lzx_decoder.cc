@@ -2,26 +2,34 @@
  * Vera360 — Xenia Edge
  * LZX Decoder implementation — Xbox 360 XEX2 LZX decompression
  *
- * Based on the LZX algorithm specification and Xenia's implementation.
- * Xbox 360 uses LZX with a 128KB window (window_bits=17).
- * The compressed data is stored in a chain of blocks, each preceded
- * by a 24-byte header containing the block's data size and a SHA-1
- * hash of the next block.
+ * Follows the LZX bitstream as decoded by libmspack's lzxd (which is what
+ * Xenia uses): 32 KB output frames, 16-bit little-endian input words read
+ * MSB-first, Huffman lengths delta-coded against the previous block, and
+ * the input re-aligned to 16 bits at every frame boundary.
+ *
+ * Output is written linearly into the caller's buffer, so the "window" is
+ * just everything decoded so far — matches copy straight out of it.
+ *
+ * Hot path: 64-bit bit buffer refilled with one unaligned load, two-level
+ * Huffman tables, and a fused literal/match loop with 8-byte match copies.
+ * vera360-lzxbench measures it against a corpus of XEX files.
  */
 
 #include "xenia/kernel/lzx_decoder.h"
 #include "xenia/base/logging.h"
-#include <cstring>
+
 #include <algorithm>
+#include <array>
+#include <cstring>
+#include <memory>
 
 namespace xe::kernel {
 
 // ── LZX constants ───────────────────────────────────────────────────────────
 
+static constexpr uint32_t kLzxFrameSize = 32768;
 static constexpr uint32_t kLzxMinMatch = 2;
-static constexpr uint32_t kLzxMaxMatch = 257;
 static constexpr uint32_t kLzxNumChars = 256;
-static constexpr uint32_t kLzxBlocktypeInvalid     = 0;
 static constexpr uint32_t kLzxBlocktypeVerbatim     = 1;
 static constexpr uint32_t kLzxBlocktypeAligned      = 2;
 static constexpr uint32_t kLzxBlocktypeUncompressed = 3;
@@ -30,500 +38,686 @@ static constexpr uint32_t kLzxAlignedNumElements = 8;
 static constexpr uint32_t kLzxNumPrimaryLengths = 7;
 static constexpr uint32_t kLzxNumSecondaryLengths = 249;
 static constexpr uint32_t kLzxMaxHufbits = 16;
-
-// Position slots for different window sizes
-static constexpr uint32_t kLzxPositionSlotsBits[] = {
-    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-    30, 32, 34, 36, 38, 42, 50, 66, 98, 162, 290
-};
-
-// Extra bits per position slot
-static const uint8_t kPositionExtra[] = {
-     0,  0,  0,  0,  1,  1,  2,  2,  3,  3,  4,  4,
-     5,  5,  6,  6,  7,  7,  8,  8,  9,  9, 10, 10,
-    11, 11, 12, 12, 13, 13, 14, 14, 15, 15, 16, 16,
-    17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17,
-    17, 17, 17
+static constexpr uint32_t kLzxMaxPositionSlots = 290;
+static constexpr uint32_t kLzxMainTreeMaxSymbols =
+    kLzxNumChars + kLzxMaxPositionSlots * 8;
+/// Zero bytes the bit reader may invent past the end of input: refills
+/// prefetch up to 64 bits beyond the last real code
+static constexpr uint32_t kLzxMaxOverrunBytes = 10;
+
+/// Position slots for window_bits 15..21
+static constexpr uint32_t kLzxPositionSlots[] = {30, 32, 34, 36, 38, 42, 50};
+
+struct PositionTables {
+  std::array<uint8_t, kLzxMaxPositionSlots> extra_bits{};
+  std::array<uint32_t, kLzxMaxPositionSlots> base{};
+  constexpr PositionTables() {
+    uint32_t b = 0;
+    for (uint32_t i = 0; i < kLzxMaxPositionSlots; ++i) {
+      extra_bits[i] = static_cast<uint8_t>(i < 4 ? 0 : i >= 36 ? 17 : (i - 2) / 2);
+      base[i] = b;
+      b += 1u << extra_bits[i];
+    }
+  }
 };
+static constexpr PositionTables kPosition;
 
-// Position base values per slot
-static const uint32_t kPositionBase[] = {
-           0,        1,        2,        3,        4,        6,
-           8,       12,       16,       24,       32,       48,
-          64,       96,      128,      192,      256,      384,
-         512,      768,     1024,     1536,     2048,     3072,
-        4096,     6144,     8192,    12288,    16384,    24576,
-       32768,    49152,    65536,    98304,   131072,   196608,
-      262144,   393216,   524288,   655360,   786432,   917504,
-     1048576,  1179648,  1310720,  1441792,  1572864,  1703936,
-     1835008,  1966080,  2097152
-};
+// ── Bitstream reader ────────────────────────────────────────────────────────
 
-/// Bitstream reader
+/// MSB-first reader over 16-bit LE words, pulling spans from the source.
+/// The 64-bit buffer is refilled to >= 48 bits with one unaligned load,
+/// so a main symbol + length symbol + offset bits need at most one refill.
 struct LzxBits {
-  const uint8_t* data;
-  size_t size;
-  size_t pos;      // byte position
-  uint32_t buf;    // bit buffer
-  int bits_left;   // bits remaining in buffer
-
-  void Init(const uint8_t* d, size_t s) {
-    data = d; size = s; pos = 0; buf = 0; bits_left = 0;
+  const LzxDecoder::InputSource* source = nullptr;
+  const uint8_t* ptr = nullptr;
+  const uint8_t* end = nullptr;
+  uint64_t buf = 0;     // left-aligned bit buffer, zero below bits_left
+  int bits_left = 0;
+  uint32_t overrun = 0;
+  // Whole words that were buffered when an uncompressed block began; they
+  // belong to its byte-aligned payload and are drained by ReadBytes
+  uint8_t pending[8];
+  uint32_t pending_pos = 0;
+  uint32_t pending_count = 0;
+
+  uint8_t NextByte() {
+    if (pending_pos < pending_count) return pending[pending_pos++];
+    while (ptr == end) {
+      size_t size = 0;
+      if (!(*source)(&ptr, &size)) {
+        ptr = end = nullptr;
+        overrun++;
+        return 0;
+      }
+      end = ptr + size;
+    }
+    return *ptr++;
   }
 
-  void EnsureBits(int need) {
-    while (bits_left < need && pos + 1 < size) {
-      // LZX uses 16-bit little-endian words for the bitstream
-      uint16_t word = data[pos] | (uint16_t(data[pos + 1]) << 8);
-      pos += 2;
-      buf |= (uint32_t(word) << (32 - 16 - bits_left));
+  /// Top the buffer up to at least 48 bits
+  inline __attribute__((always_inline)) void Refill() {
+    if (end - ptr >= 8 && pending_pos == pending_count) [[likely]] {
+      // Host is little-endian: swap the four LE words into stream order
+      uint64_t v;
+      memcpy(&v, ptr, 8);
+      v = ((v & 0x0000FFFF0000FFFFull) << 16) | ((v >> 16) & 0x0000FFFF0000FFFFull);
+      v = (v << 32) | (v >> 32);
+      int words = (64 - bits_left) >> 4;
+      int fill = bits_left + words * 16;
+      buf |= (v >> bits_left) & (~0ull << (64 - fill));
+      bits_left = fill;
+      ptr += words * 2;
+      return;
+    }
+    RefillSlow();
+  }
+
+  /// Word at a time across span boundaries and past the end of input
+  __attribute__((noinline)) void RefillSlow() {
+    while (bits_left <= 48) {
+      uint64_t lo = NextByte();
+      uint64_t hi = NextByte();
+      buf |= ((hi << 8) | lo) << (48 - bits_left);
       bits_left += 16;
     }
   }
 
-  uint32_t Peek(int n) {
-    EnsureBits(n);
-    return (buf >> (32 - n));
+  void EnsureBits(int need) {
+    if (bits_left < need) Refill();
   }
 
+  uint32_t Peek(int n) const { return static_cast<uint32_t>(buf >> (64 - n)); }
+
   void Skip(int n) {
     buf <<= n;
     bits_left -= n;
   }
 
   uint32_t Read(int n) {
+    if (n == 0) return 0;
+    EnsureBits(n);
     uint32_t v = Peek(n);
     Skip(n);
     return v;
   }
 
-  // Align to 16-bit boundary
-  void Align16() {
-    if (bits_left & 15) {
-      int skip = bits_left & 15;
-      Skip(skip);
+  /// Frame-boundary alignment: lzxd drops the rest of the current word
+  void AlignFrame() { Skip(bits_left & 15); }
+
+  /// Byte-align ahead of an uncompressed block. lzxd (32-bit buffer) drops
+  /// the rest of the current word, or the whole next word when it sits on
+  /// a word boundary; words we had already prefetched go back to the raw
+  /// byte stream.
+  void AlignBytes() {
+    int drop = bits_left & 15;
+    if (drop == 0) {
+      if (bits_left == 0) Refill();
+      drop = 16;
     }
+    Skip(drop);
+    // pending is empty here: the previous uncompressed block's 12 R bytes
+    // drained it
+    pending_pos = 0;
+    pending_count = 0;
+    while (bits_left >= 16) {
+      uint32_t word = Peek(16);
+      pending[pending_count++] = static_cast<uint8_t>(word);
+      pending[pending_count++] = static_cast<uint8_t>(word >> 8);
+      Skip(16);
+    }
+    buf = 0;
+    bits_left = 0;
   }
-};
 
-/// Huffman tree (canonical)
-struct HuffTree {
-  uint16_t lens[1024] = {};  // Code lengths
-  uint16_t table[65536] = {}; // Decode table (direct lookup)
-  uint32_t max_symbol = 0;
-  uint32_t table_bits = 0;
+  /// Copy raw bytes (uncompressed block payload)
+  void ReadBytes(uint8_t* dst, size_t len) {
+    while (len && pending_pos < pending_count) {
+      *dst++ = pending[pending_pos++];
+      len--;
+    }
+    while (len) {
+      if (ptr == end) {
+        *dst++ = NextByte();
+        len--;
+        continue;
+      }
+      size_t n = std::min(len, static_cast<size_t>(end - ptr));
+      memcpy(dst, ptr, n);
+      ptr += n;
+      dst += n;
+      len -= n;
+    }
+  }
+};
 
-  bool Build(uint32_t nsyms, uint32_t tablebits) {
-    max_symbol = nsyms;
-    table_bits = tablebits;
+// ── Huffman trees ───────────────────────────────────────────────────────────
 
-    // Count code lengths
-    uint16_t len_count[kLzxMaxHufbits + 1] = {};
+/// Canonical Huffman tree decoded through a two-level table. Codes up to
+/// kTableBits resolve with one lookup; longer codes share a first-level
+/// entry per kTableBits prefix that points at a subtable sized for the
+/// longest code under that prefix.
+///
+/// Entry layout: [31:16] symbol or subtable start, [7] subtable flag,
+/// [4:0] bits to consume (or subtable index bits).
+template <uint32_t kMaxSymbols, uint32_t kTableBits>
+struct HuffTree {
+  static constexpr uint32_t kSubtable = 0x80;
+  static constexpr uint32_t kMaxSubBits = kLzxMaxHufbits - kTableBits;
+  /// A subtable of 2^s entries covers a complete subtree of depth s, which
+  /// has at least s + 1 leaves; 2^s / (s + 1) grows with s, so this bounds
+  /// the total subtable space for any valid tree
+  static constexpr uint32_t kTableSize =
+      (1u << kTableBits) +
+      kMaxSymbols * (1u << kMaxSubBits) / (kMaxSubBits + 1) + (1u << kMaxSubBits);
+
+  uint8_t lens[kMaxSymbols + 64] = {};  // slack: runs may overshoot
+  uint32_t table[kTableSize];
+  bool empty = true;
+
+  /// Fails on over- or under-subscribed trees; an all-zero tree is only
+  /// accepted when allow_empty (the length tree may be unused)
+  bool Build(uint32_t nsyms, bool allow_empty) {
+    uint32_t count[kLzxMaxHufbits + 1] = {};
     for (uint32_t i = 0; i < nsyms; ++i) {
-      if (lens[i] > kLzxMaxHufbits) lens[i] = kLzxMaxHufbits;
-      len_count[lens[i]]++;
+      if (lens[i] > kLzxMaxHufbits) return false;
+      count[lens[i]]++;
     }
-    len_count[0] = 0;
+    count[0] = 0;
 
-    // Check for valid tree
-    uint32_t total = 0;
-    for (uint32_t i = 1; i <= kLzxMaxHufbits; ++i) {
-      total += len_count[i] << (kLzxMaxHufbits - i);
+    uint32_t kraft = 0;
+    for (uint32_t len = 1; len <= kLzxMaxHufbits; ++len) {
+      kraft += count[len] << (kLzxMaxHufbits - len);
     }
+    empty = kraft == 0;
+    if (empty) return allow_empty;
+    if (kraft != (1u << kLzxMaxHufbits)) return false;
 
-    // Build direct-lookup table for short codes
-    uint32_t table_size = 1u << tablebits;
-    memset(table, 0xFF, table_size * sizeof(uint16_t));
-
-    uint32_t code = 0;
-    uint32_t next_code[kLzxMaxHufbits + 1] = {};
+    // Symbols in canonical order (by length, then value)
+    uint16_t sorted[kMaxSymbols];
+    uint32_t offset[kLzxMaxHufbits + 2] = {};
     for (uint32_t len = 1; len <= kLzxMaxHufbits; ++len) {
-      next_code[len] = code;
-      code = (code + len_count[len]) << 1;
+      offset[len + 1] = offset[len] + count[len];
     }
-
-    // Assign codes to symbols
     for (uint32_t sym = 0; sym < nsyms; ++sym) {
+      if (lens[sym]) sorted[offset[lens[sym]]++] = static_cast<uint16_t>(sym);
+    }
+    const uint32_t total = offset[kLzxMaxHufbits];
+
+    uint32_t code = 0;
+    uint32_t code_len = 1;
+    uint32_t next_free = 1u << kTableBits;
+    uint32_t sub_prefix = UINT32_MAX;
+    uint32_t sub_start = 0;
+    uint32_t sub_bits = 0;
+    for (uint32_t i = 0; i < total; ++i) {
+      uint32_t sym = sorted[i];
       uint32_t len = lens[sym];
-      if (len == 0) continue;
-
-      uint32_t c = next_code[len]++;
-      if (len <= tablebits) {
-        // Direct lookup
-        uint32_t fill = 1u << (tablebits - len);
-        uint32_t base = c << (tablebits - len);
-        for (uint32_t j = 0; j < fill && (base + j) < table_size; ++j) {
-          table[base + j] = (uint16_t)sym;
-        }
+      code <<= len - code_len;
+      code_len = len;
+      if (len <= kTableBits) {
+        uint32_t shift = kTableBits - len;
+        std::fill_n(table + (code << shift), 1u << shift, (sym << 16) | len);
       } else {
-        // Use extended table entries for long codes
-        // For simplicity, we'll put them in the table with a marker
-        uint32_t base = c >> (len - tablebits);
-        if (base < table_size) {
-          table[base] = (uint16_t)sym;  // Approximation
+        uint32_t extra = len - kTableBits;
+        uint32_t prefix = code >> extra;
+        if (prefix != sub_prefix) {
+          // Size the subtable for the rest of this subtree (zlib's method)
+          sub_bits = extra;
+          int left = 1 << sub_bits;
+          while (sub_bits < kMaxSubBits) {
+            left -= static_cast<int>(count[sub_bits + kTableBits]);
+            if (left <= 0) break;
+            sub_bits++;
+            left <<= 1;
+          }
+          sub_prefix = prefix;
+          sub_start = next_free;
+          next_free += 1u << sub_bits;
+          if (next_free > kTableSize) return false;
+          table[prefix] = (sub_start << 16) | kSubtable | sub_bits;
         }
+        uint32_t low = code & ((1u << extra) - 1);
+        uint32_t shift = sub_bits - extra;
+        std::fill_n(table + sub_start + (low << shift), 1u << shift,
+                    (sym << 16) | extra);
       }
+      count[len]--;
+      code++;
     }
-
     return true;
   }
 
+  /// Needs >= 16 buffered bits; the tree must not be empty
   uint32_t Decode(LzxBits& bits) const {
-    bits.EnsureBits(kLzxMaxHufbits);
-    uint32_t idx = bits.Peek(table_bits);
-    uint32_t sym = table[idx & ((1u << table_bits) - 1)];
-    if (sym == 0xFFFF) {
-      // Symbol not found — return 0 (literal NUL)
-      bits.Skip(1);
-      return 0;
+    uint32_t e = table[bits.Peek(kTableBits)];
+    if (e & kSubtable) [[unlikely]] {
+      bits.Skip(kTableBits);
+      e = table[(e >> 16) + bits.Peek(e & 0x1F)];
     }
-    uint32_t len = lens[sym];
-    if (len == 0) len = 1;
-    bits.Skip(len);
-    return sym;
+    bits.Skip(e & 0x1F);
+    return e >> 16;
   }
 };
 
-/// LZX decoder state
-struct LzxState {
-  uint32_t window_size;
-  uint32_t window_bits;
-  uint32_t num_position_slots;
-  std::vector<uint8_t> window;
-  uint32_t window_pos;
-
-  HuffTree main_tree;
-  HuffTree length_tree;
-  HuffTree aligned_tree;
-  HuffTree pretree;
-
-  uint32_t R0, R1, R2;  // Repeated offsets
-
-  void Init(uint32_t wbits) {
-    window_bits = wbits;
-    window_size = 1u << wbits;
-    num_position_slots = (wbits < 15 || wbits > 25)
-        ? 34 : kLzxPositionSlotsBits[wbits];
-    window.resize(window_size, 0);
-    window_pos = 0;
-    R0 = R1 = R2 = 1;
-
-    main_tree.max_symbol = kLzxNumChars +
-        num_position_slots * kLzxNumPrimaryLengths;
-    length_tree.max_symbol = kLzxNumSecondaryLengths;
-    memset(main_tree.lens, 0, sizeof(main_tree.lens));
-    memset(length_tree.lens, 0, sizeof(length_tree.lens));
+using PreTree = HuffTree<kLzxPreTreeNumElements, 6>;
+using MainTree = HuffTree<kLzxMainTreeMaxSymbols, 12>;
+using LengthTree = HuffTree<kLzxNumSecondaryLengths, 12>;
+using AlignedTree = HuffTree<kLzxAlignedNumElements, 7>;
+
+// ── Match copy ──────────────────────────────────────────────────────────────
+
+/// Copy an LZ77 match. With >= 8 bytes of slack after the match the copy
+/// runs in 8-byte steps and may scribble up to 7 bytes past its end (they
+/// are overwritten by later output); short periods are replicated into an
+/// 8-byte pattern and stored at a stride that is a multiple of the period.
+static inline void CopyMatch(uint8_t* dst, uint32_t offset, uint32_t length,
+                             size_t room) {
+  const uint8_t* src = dst - offset;
+  if (room >= length + 8) [[likely]] {
+    uint8_t* end = dst + length;
+    if (offset >= 8) {
+      do {
+        uint64_t v;
+        memcpy(&v, src, 8);
+        memcpy(dst, &v, 8);
+        src += 8;
+        dst += 8;
+      } while (dst < end);
+      return;
+    }
+    if (offset == 1) {
+      memset(dst, *src, length);
+      return;
+    }
+    uint8_t pattern[8];
+    for (uint32_t i = 0; i < 8; ++i) pattern[i] = src[i % offset];
+    uint64_t v;
+    memcpy(&v, pattern, 8);
+    const uint32_t stride = 8 - 8 % offset;
+    do {
+      memcpy(dst, &v, 8);
+      dst += stride;
+    } while (dst < end);
+    return;
   }
+  for (uint32_t i = 0; i < length; ++i) dst[i] = src[i];
+}
+
+// ── Decoder state ───────────────────────────────────────────────────────────
 
-  void ReadPreTree(LzxBits& bits) {
+struct LzxDecoder::State {
+  LzxBits bits;
+  PreTree pretree;
+  MainTree main_tree;
+  LengthTree length_tree;
+  AlignedTree aligned_tree;
+
+  uint32_t R0 = 1, R1 = 1, R2 = 1;  // repeated offsets
+  uint32_t block_type = 0;
+  uint32_t block_length = 0;
+  uint32_t block_remaining = 0;
+  bool header_read = false;
+  uint32_t intel_filesize = 0;
+  bool intel_started = false;
+
+  template <typename Tree>
+  bool ReadLengths(Tree& tree, uint32_t first, uint32_t last) {
     for (uint32_t i = 0; i < kLzxPreTreeNumElements; ++i) {
-      pretree.lens[i] = (uint16_t)bits.Read(4);
+      pretree.lens[i] = static_cast<uint8_t>(bits.Read(4));
     }
-    pretree.Build(kLzxPreTreeNumElements, 6);
-  }
+    if (!pretree.Build(kLzxPreTreeNumElements, false)) return false;
 
-  void ReadLengths(LzxBits& bits, uint16_t* lens, uint32_t first, uint32_t last) {
-    ReadPreTree(bits);
-    for (uint32_t i = first; i < last;) {
-      uint32_t sym = pretree.Decode(bits);
-      if (sym == 17) {
+    uint8_t* lens = tree.lens;
+    for (uint32_t x = first; x < last;) {
+      bits.EnsureBits(kLzxMaxHufbits);
+      uint32_t z = pretree.Decode(bits);
+      if (z == 17) {
         uint32_t run = bits.Read(4) + 4;
-        for (uint32_t j = 0; j < run && i < last; ++j, ++i) {
-          lens[i] = 0;
-        }
-      } else if (sym == 18) {
+        memset(lens + x, 0, run);
+        x += run;
+      } else if (z == 18) {
         uint32_t run = bits.Read(5) + 20;
-        for (uint32_t j = 0; j < run && i < last; ++j, ++i) {
-          lens[i] = 0;
-        }
-      } else if (sym == 19) {
+        memset(lens + x, 0, run);
+        x += run;
+      } else if (z == 19) {
         uint32_t run = bits.Read(1) + 4;
-        uint32_t z = pretree.Decode(bits);
-        z = (lens[i] + 17 - z) % 17;
-        for (uint32_t j = 0; j < run && i < last; ++j, ++i) {
-          lens[i] = (uint16_t)z;
-        }
-      } else if (sym <= 16) {
-        lens[i] = (uint16_t)((lens[i] + 17 - sym) % 17);
-        i++;
+        bits.EnsureBits(kLzxMaxHufbits);
+        z = pretree.Decode(bits);
+        if (z > 16) return false;
+        uint8_t len = static_cast<uint8_t>((lens[x] + 17 - z) % 17);
+        memset(lens + x, len, run);
+        x += run;
       } else {
-        break;  // Invalid
+        lens[x] = static_cast<uint8_t>((lens[x] + 17 - z) % 17);
+        x++;
       }
     }
+    return true;
   }
 
-  bool DecompressBlock(LzxBits& bits, uint32_t block_remaining) {
-    while (block_remaining > 0) {
-      uint32_t sym = main_tree.Decode(bits);
-      if (sym < kLzxNumChars) {
-        // Literal byte
-        window[window_pos] = (uint8_t)sym;
-        window_pos = (window_pos + 1) & (window_size - 1);
-        block_remaining--;
-      } else {
-        // Match
-        sym -= kLzxNumChars;
-        uint32_t len_slot = sym % kLzxNumPrimaryLengths;
-        uint32_t pos_slot = sym / kLzxNumPrimaryLengths;
-
-        uint32_t match_length = kLzxMinMatch;
-        if (len_slot == kLzxNumPrimaryLengths - 1) {
-          match_length += length_tree.Decode(bits) + kLzxNumPrimaryLengths - 1;
-        } else {
-          match_length += len_slot;
-        }
+  bool ReadBlockHeader(uint32_t main_elements) {
+    // Uncompressed blocks with an odd length are padded to a word
+    if (block_type == kLzxBlocktypeUncompressed && (block_length & 1)) {
+      uint8_t pad;
+      bits.ReadBytes(&pad, 1);
+    }
+    block_type = bits.Read(3);
+    uint32_t hi = bits.Read(16);
+    uint32_t lo = bits.Read(8);
+    block_remaining = block_length = (hi << 8) | lo;
 
-        uint32_t match_offset;
-        if (pos_slot == 0) {
-          match_offset = R0;
-        } else if (pos_slot == 1) {
-          match_offset = R1;
-          R1 = R0; R0 = match_offset;
-        } else if (pos_slot == 2) {
-          match_offset = R2;
-          R2 = R0; R0 = match_offset;
-        } else {
-          uint32_t extra = kPositionExtra[pos_slot];
-          uint32_t verbatim_bits = 0;
-          if (extra > 0) {
-            verbatim_bits = bits.Read(extra);
-          }
-          match_offset = kPositionBase[pos_slot] + verbatim_bits;
-          R2 = R1; R1 = R0; R0 = match_offset;
+    switch (block_type) {
+      case kLzxBlocktypeAligned:
+        for (uint32_t i = 0; i < kLzxAlignedNumElements; ++i) {
+          aligned_tree.lens[i] = static_cast<uint8_t>(bits.Read(3));
         }
+        if (!aligned_tree.Build(kLzxAlignedNumElements, false)) return false;
+        [[fallthrough]];
+      case kLzxBlocktypeVerbatim:
+        if (!ReadLengths(main_tree, 0, kLzxNumChars)) return false;
+        if (!ReadLengths(main_tree, kLzxNumChars, main_elements)) return false;
+        if (!main_tree.Build(main_elements, false)) return false;
+        if (main_tree.lens[0xE8] != 0) intel_started = true;
+        if (!ReadLengths(length_tree, 0, kLzxNumSecondaryLengths)) return false;
+        if (!length_tree.Build(kLzxNumSecondaryLengths, true)) return false;
+        return true;
+      case kLzxBlocktypeUncompressed: {
+        intel_started = true;
+        bits.AlignBytes();
+        uint8_t r[12];
+        bits.ReadBytes(r, sizeof(r));
+        auto le32 = [](const uint8_t* p) {
+          return uint32_t(p[0]) | (uint32_t(p[1]) << 8) |
+                 (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+        };
+        R0 = le32(r);
+        R1 = le32(r + 4);
+        R2 = le32(r + 8);
+        return true;
+      }
+      default:
+        XELOGW("LZX: Invalid block type {}", block_type);
+        return false;
+    }
+  }
 
-        if (match_offset == 0) match_offset = 1;
+  /// Decode up to this_run bytes of the current compressed block at
+  /// out[pos]. The last match may overshoot; returns the bytes written.
+  int64_t DecodeRun(uint8_t* out, size_t pos, size_t out_size,
+                    int64_t this_run) {
+    // Work on locals so the hot state stays in registers
+    LzxBits b = bits;
+    uint32_t r0 = R0, r1 = R1, r2 = R2;
+    const size_t start = pos;
+    const bool aligned = block_type == kLzxBlocktypeAligned;
+    bool ok = true;
+
+    while (this_run > 0) {
+      // 32 bits cover main (16) + length (16) symbols; offset bits refill
+      // again only when needed
+      if (b.bits_left < 32) b.Refill();
+      uint32_t main_element = main_tree.Decode(b);
+      if (main_element < kLzxNumChars) {
+        out[pos++] = static_cast<uint8_t>(main_element);
+        this_run--;
+        continue;
+      }
 
-        // Copy from window
-        uint32_t src_pos = (window_pos - match_offset) & (window_size - 1);
-        for (uint32_t j = 0; j < match_length && block_remaining > 0; ++j) {
-          window[window_pos] = window[src_pos];
-          window_pos = (window_pos + 1) & (window_size - 1);
-          src_pos = (src_pos + 1) & (window_size - 1);
-          block_remaining--;
+      main_element -= kLzxNumChars;
+      uint32_t match_length = main_element & kLzxNumPrimaryLengths;
+      if (match_length == kLzxNumPrimaryLengths) {
+        if (length_tree.empty) {
+          ok = false;
+          break;
+        }
+        match_length += length_tree.Decode(b);
+      }
+      match_length += kLzxMinMatch;
+
+      uint32_t match_offset = main_element >> 3;
+      if (match_offset > 2) {
+        uint32_t slot = match_offset;
+        uint32_t extra = kPosition.extra_bits[slot];
+        match_offset = kPosition.base[slot] - 2;
+        if (b.bits_left < 24) b.Refill();
+        if (!aligned) {
+          match_offset += b.Read(extra);
+        } else if (extra >= 3) {
+          match_offset += b.Read(extra - 3) << 3;
+          match_offset += aligned_tree.Decode(b);
+        } else if (extra > 0) {
+          match_offset += b.Read(extra);
+        } else {
+          match_offset = 1;  // undefined by the spec; lzxd uses 1
         }
+        r2 = r1;
+        r1 = r0;
+        r0 = match_offset;
+      } else if (match_offset == 0) {
+        match_offset = r0;
+      } else if (match_offset == 1) {
+        match_offset = r1;
+        r1 = r0;
+        r0 = match_offset;
+      } else {
+        match_offset = r2;
+        r2 = r0;
+        r0 = match_offset;
+      }
+
+      if (match_offset == 0 || match_offset > pos ||
+          match_length > out_size - pos) [[unlikely]] {
+        XELOGW("LZX: Match out of range (offset={}, length={}, pos={})",
+               match_offset, match_length, pos);
+        ok = false;
+        break;
       }
+      CopyMatch(out + pos, match_offset, match_length, out_size - pos);
+      pos += match_length;
+      this_run -= match_length;
     }
-    return true;
+
+    bits = b;
+    R0 = r0;
+    R1 = r1;
+    R2 = r2;
+    return ok ? static_cast<int64_t>(pos - start) : -1;
   }
 };
 
-// ── Public API ──────────────────────────────────────────────────────────────
+// ── Decoder ─────────────────────────────────────────────────────────────────
 
-bool LzxDecompress(const uint8_t* compressed_data,
-                   size_t compressed_size,
-                   size_t uncompressed_size,
-                   uint32_t window_bits,
-                   const std::vector<uint32_t>& block_sizes,
-                   std::vector<uint8_t>& output) {
-  if (!compressed_data || compressed_size == 0 || uncompressed_size == 0) {
-    return false;
+LzxDecoder::LzxDecoder(uint32_t window_bits) : window_bits_(window_bits) {
+  if (window_bits >= 15 && window_bits <= 21) {
+    num_position_slots_ = kLzxPositionSlots[window_bits - 15];
+  } else {
+    XELOGE("LZX: Unsupported window size 2^{}", window_bits);
   }
+}
 
-  if (window_bits < 15) window_bits = 15;
-  if (window_bits > 21) window_bits = 21;
-
-  LzxState state;
-  state.Init(window_bits);
-
-  output.resize(uncompressed_size, 0);
-  size_t output_pos = 0;
-
-  LzxBits bits;
-  bits.Init(compressed_data, compressed_size);
-
-  while (output_pos < uncompressed_size) {
-    // Read block type and size
-    uint32_t block_type = bits.Read(3);
-    uint32_t block_size = bits.Read(24);
-
-    if (block_size == 0 || block_type == kLzxBlocktypeInvalid) {
-      break;
-    }
-
-    if (block_size > uncompressed_size - output_pos) {
-      block_size = static_cast<uint32_t>(uncompressed_size - output_pos);
+LzxDecoder::~LzxDecoder() = default;
+
+bool LzxDecoder::Decompress(const InputSource& input, uint8_t* output,
+                            size_t output_size) {
+  if (!is_valid() || !output) return false;
+
+  // Tree state is ~80 KB: keep it off the thread stack
+  auto state = std::make_unique<State>();
+  State& s = *state;
+  s.bits.source = &input;
+  const uint32_t main_elements = kLzxNumChars + num_position_slots_ * 8;
+
+  size_t pos = 0;
+  uint32_t first_intel_frame = UINT32_MAX;
+  for (uint32_t frame = 0; pos < output_size; ++frame) {
+    if (!s.header_read) {
+      if (s.bits.Read(1)) {
+        uint32_t hi = s.bits.Read(16);
+        uint32_t lo = s.bits.Read(16);
+        s.intel_filesize = (hi << 16) | lo;
+      }
+      s.header_read = true;
     }
 
-    switch (block_type) {
-      case kLzxBlocktypeVerbatim:
-      case kLzxBlocktypeAligned: {
-        uint32_t main_elements = kLzxNumChars +
-            state.num_position_slots * kLzxNumPrimaryLengths;
-
-        if (block_type == kLzxBlocktypeAligned) {
-          for (uint32_t i = 0; i < kLzxAlignedNumElements; ++i) {
-            state.aligned_tree.lens[i] = (uint16_t)bits.Read(3);
-          }
-          state.aligned_tree.Build(kLzxAlignedNumElements, 7);
-        }
-
-        // Read main tree lengths
-        state.ReadLengths(bits, state.main_tree.lens, 0, kLzxNumChars);
-        state.ReadLengths(bits, state.main_tree.lens, kLzxNumChars, main_elements);
-        state.main_tree.Build(main_elements, 12);
-
-        // Read length tree
-        state.ReadLengths(bits, state.length_tree.lens, 0, kLzxNumSecondaryLengths);
-        state.length_tree.Build(kLzxNumSecondaryLengths, 12);
-
-        // Decompress the block
-        uint32_t save_pos = state.window_pos;
-        state.DecompressBlock(bits, block_size);
-
-        // Copy from window to output
-        uint32_t copy_start = save_pos;
-        for (uint32_t i = 0; i < block_size && output_pos < uncompressed_size; ++i) {
-          output[output_pos++] = state.window[copy_start];
-          copy_start = (copy_start + 1) & (state.window_size - 1);
-        }
-        break;
+    const size_t frame_end =
+        pos + std::min<size_t>(kLzxFrameSize, output_size - pos);
+    while (pos < frame_end) {
+      if (s.block_remaining == 0 && !s.ReadBlockHeader(main_elements)) {
+        return false;
+      }
+      int64_t this_run = std::min<int64_t>(s.block_remaining, frame_end - pos);
+      int64_t written;
+      if (s.block_type == kLzxBlocktypeUncompressed) {
+        s.bits.ReadBytes(output + pos, static_cast<size_t>(this_run));
+        written = this_run;
+      } else {
+        written = s.DecodeRun(output, pos, output_size, this_run);
+        if (written < 0) return false;
+      }
+      if (written > s.block_remaining) {
+        XELOGW("LZX: Match overran its block");
+        return false;
       }
+      s.block_remaining -= static_cast<uint32_t>(written);
+      pos += static_cast<size_t>(written);
+    }
+    if (pos != frame_end) {
+      XELOGW("LZX: Match crossed a frame boundary at {}", frame_end);
+      return false;
+    }
+    s.bits.AlignFrame();
+    if (s.bits.overrun > kLzxMaxOverrunBytes) {
+      XELOGW("LZX: Input exhausted at output offset {}", pos);
+      return false;
+    }
+    if (s.intel_started && first_intel_frame == UINT32_MAX) {
+      first_intel_frame = frame;
+    }
+  }
 
-      case kLzxBlocktypeUncompressed: {
-        bits.Align16();
-
-        // Read R0, R1, R2 (little-endian in the stream)
-        if (bits.pos + 12 <= bits.size) {
-          state.R0 = bits.data[bits.pos] | (bits.data[bits.pos+1] << 8) |
-                     (bits.data[bits.pos+2] << 16) | (bits.data[bits.pos+3] << 24);
-          bits.pos += 4;
-          state.R1 = bits.data[bits.pos] | (bits.data[bits.pos+1] << 8) |
-                     (bits.data[bits.pos+2] << 16) | (bits.data[bits.pos+3] << 24);
-          bits.pos += 4;
-          state.R2 = bits.data[bits.pos] | (bits.data[bits.pos+1] << 8) |
-                     (bits.data[bits.pos+2] << 16) | (bits.data[bits.pos+3] << 24);
-          bits.pos += 4;
+  // E8 call translation. lzxd translates a copy of each frame on output so
+  // matches keep seeing untranslated bytes; translating in place once
+  // every frame has been decoded is equivalent.
+  if (s.intel_filesize && first_intel_frame != UINT32_MAX) {
+    const int32_t filesize = static_cast<int32_t>(s.intel_filesize);
+    for (size_t frame_start = size_t(first_intel_frame) * kLzxFrameSize;
+         frame_start < output_size && frame_start / kLzxFrameSize < 32768;
+         frame_start += kLzxFrameSize) {
+      size_t frame_size = std::min<size_t>(kLzxFrameSize, output_size - frame_start);
+      if (frame_size <= 10) break;
+      uint8_t* data = output + frame_start;
+      uint8_t* data_end = data + frame_size - 10;
+      int32_t curpos = static_cast<int32_t>(frame_start);
+      while (data < data_end) {
+        if (*data++ != 0xE8) {
+          curpos++;
+          continue;
         }
-        bits.bits_left = 0;
-        bits.buf = 0;
-
-        // Raw copy
-        uint32_t copy_len = std::min(static_cast<size_t>(block_size),
-                                     bits.size - bits.pos);
-        copy_len = std::min(copy_len,
-                           static_cast<uint32_t>(uncompressed_size - output_pos));
-        for (uint32_t i = 0; i < copy_len; ++i) {
-          uint8_t b = bits.data[bits.pos++];
-          state.window[state.window_pos] = b;
-          state.window_pos = (state.window_pos + 1) & (state.window_size - 1);
-          output[output_pos++] = b;
+        int32_t abs_off;
+        memcpy(&abs_off, data, 4);
+        if (abs_off >= -curpos && abs_off < filesize) {
+          int32_t rel_off = abs_off >= 0 ? abs_off - curpos : abs_off + filesize;
+          memcpy(data, &rel_off, 4);
         }
-        // Align to 16-bit boundary after uncompressed block
-        if (bits.pos & 1) bits.pos++;
-        break;
+        data += 4;
+        curpos += 5;
       }
-
-      default:
-        XELOGW("LZX: Unknown block type {}", block_type);
-        return false;
     }
   }
-
-  XELOGI("LZX decompressed: {} bytes → {} bytes", compressed_size, output_pos);
-  return output_pos > 0;
+  return true;
 }
 
-bool LzxDecompressXex(const uint8_t* data,
-                      size_t data_size,
-                      size_t uncompressed_size,
-                      uint32_t window_bits,
-                      uint32_t first_block_size,
-                      std::vector<uint8_t>& output) {
-  // XEX2 LZX format: chain of blocks, each with 24-byte header
-  // [0-3] = compressed block data size (big endian)
-  // [4-23] = SHA-1 hash of next block
-  // After header: compressed data for this block
-
-  if (!data || data_size == 0 || uncompressed_size == 0) {
-    return false;
-  }
-
-  if (window_bits < 15) window_bits = 15;
-  if (window_bits > 21) window_bits = 21;
-
-  // Collect all compressed block data into a contiguous buffer
-  std::vector<uint8_t> compressed;
-  compressed.reserve(data_size);
-
-  size_t offset = 0;
-  uint32_t expected_size = first_block_size;
-
-  while (offset < data_size) {
-    if (offset + 24 > data_size) break;
-
-    // Read block header
-    uint32_t block_data_size = (data[offset] << 24) | (data[offset+1] << 16) |
-                                (data[offset+2] << 8) | data[offset+3];
-    // SHA-1 hash at offset+4..offset+23 (skip for decompression)
-
-    offset += 24;  // Skip header
-
-    if (block_data_size == 0) break;
-    if (offset + block_data_size > data_size) {
-      block_data_size = static_cast<uint32_t>(data_size - offset);
-    }
+// ── Public API ──────────────────────────────────────────────────────────────
 
-    // Append block data
-    compressed.insert(compressed.end(),
-                     data + offset, data + offset + block_data_size);
-    offset += block_data_size;
-  }
+bool LzxDecompress(const uint8_t* data, size_t data_size, uint8_t* output,
+                   size_t output_size, uint32_t window_bits) {
+  bool consumed = false;
+  LzxDecoder::InputSource input = [&](const uint8_t** p, size_t* n) {
+    if (consumed) return false;
+    consumed = true;
+    *p = data;
+    *n = data_size;
+    return true;
+  };
+  return LzxDecoder(window_bits).Decompress(input, output, output_size);
+}
 
-  XELOGI("LZX XEX: collected {} bytes of compressed data from {} bytes input",
-         compressed.size(), data_size);
+bool LzxDecompressXex(const uint8_t* data, size_t data_size,
+                      uint32_t first_block_size, uint32_t window_size,
+                      uint8_t* output, size_t output_size) {
+  if (!data) return false;
+  XexBlockReader in_place = [data](size_t offset, size_t) {
+    return data + offset;
+  };
+  return LzxDecompressXex(in_place, data_size, first_block_size, window_size,
+                          output, output_size);
+}
 
-  if (compressed.empty()) {
+bool LzxDecompressXex(const XexBlockReader& read_block, size_t data_size,
+                      uint32_t first_block_size, uint32_t window_size,
+                      uint8_t* output, size_t output_size) {
+  if (!output || window_size == 0 || (window_size & (window_size - 1)) != 0) {
+    XELOGE("LZX XEX: Invalid window size 0x{:X}", window_size);
     return false;
   }
-
-  // Now decompress the collected data
-  std::vector<uint32_t> dummy_blocks;
-  bool ok = LzxDecompress(compressed.data(), compressed.size(),
-                       uncompressed_size, window_bits,
-                       dummy_blocks, output);
-  if (!ok) return false;
-
-  // ── E8 call translation (post-decompression fixup) ──────────────────
-  // Xbox 360 XEX2 applies an E8/E9 (x86 CALL/JMP) relative address
-  // translation after LZX decompression. This converts relative offsets
-  // back to absolute, which is how the LZX compressor improved compression
-  // by making CALL targets more repetitive.
-  //
-  // The algorithm scans for E8 bytes and translates the following 4-byte
-  // little-endian offset from absolute back to relative.
-  if (output.size() >= 5) {
-    size_t limit = output.size() - 4;
-    for (size_t i = 0; i < limit;) {
-      if (output[i] == 0xE8) {
-        // Read 4-byte LE offset after E8
-        int32_t abs_off = static_cast<int32_t>(
-            output[i+1] | (output[i+2] << 8) |
-            (output[i+3] << 16) | (output[i+4] << 24));
-
-        // Convert: if absolute value is in [0, uncompressed_size) or
-        // [-i, 0), it was translated by the compressor
-        int32_t file_size = static_cast<int32_t>(uncompressed_size);
-        if (abs_off >= -static_cast<int32_t>(i) && abs_off < file_size) {
-          int32_t rel_off;
-          if (abs_off >= 0) {
-            rel_off = abs_off - static_cast<int32_t>(i);
-          } else {
-            rel_off = abs_off + file_size;
+  uint32_t window_bits = static_cast<uint32_t>(__builtin_ctz(window_size));
+
+  size_t block_offset = 0;
+  uint32_t block_size = first_block_size;
+  const uint8_t* p = nullptr;          // next chunk header
+  const uint8_t* block_end = nullptr;  // nullptr between blocks
+  size_t block_count = 0;
+  bool corrupt = false;
+
+  // Hand the decoder each chunk in place: no staging copy
+  LzxDecoder::InputSource input = [&](const uint8_t** out, size_t* out_size) {
+    while (true) {
+      if (block_end) {
+        if (block_end - p >= 2) {
+          uint32_t chunk = (uint32_t(p[0]) << 8) | p[1];
+          p += 2;
+          if (chunk) {
+            if (static_cast<size_t>(block_end - p) < chunk) {
+              corrupt = true;
+              return false;
+            }
+            *out = p;
+            *out_size = chunk;
+            p += chunk;
+            return true;
           }
-          output[i+1] = static_cast<uint8_t>(rel_off);
-          output[i+2] = static_cast<uint8_t>(rel_off >> 8);
-          output[i+3] = static_cast<uint8_t>(rel_off >> 16);
-          output[i+4] = static_cast<uint8_t>(rel_off >> 24);
         }
-        i += 5;
-      } else {
-        i++;
+        block_end = nullptr;
       }
+      if (block_size == 0) return false;
+      if (block_size < 24 || data_size - block_offset < block_size) {
+        corrupt = true;
+        return false;
+      }
+      const uint8_t* block = read_block(block_offset, block_size);
+      if (!block) {
+        corrupt = true;
+        return false;
+      }
+      uint32_t next_size = (uint32_t(block[0]) << 24) | (uint32_t(block[1]) << 16) |
+                           (uint32_t(block[2]) << 8) | block[3];
+      p = block + 24;
+      block_end = block + block_size;
+      block_offset += block_size;
+      block_size = next_size;
+      block_count++;
     }
-  }
+  };
 
-  return true;
+  bool ok = LzxDecoder(window_bits).Decompress(input, output, output_size);
+  if (corrupt) {
+    XELOGE("LZX XEX: Block chain overruns the file (block {})", block_count);
+    return false;
+  }
+  if (ok) {
+    XELOGD("LZX XEX: {} blocks -> {} bytes", block_count, output_size);
+  }
+  return ok;
 }
 
 }  // namespace xe::kernel
@@ -2,51 +2,74 @@
  * Vera360 — Xenia Edge
  * LZX Decoder — decompresses Xbox 360 XEX2 LZX-compressed images
  *
- * Xbox 360 uses a custom LZX variant for executable compression.
- * The format stores data in blocks with a block descriptor table:
- *   - Each block has a SHA-1 hash (20 bytes) of the NEXT block
- *   - First block hash is in the file format info header
- *   - Data is LZX-compressed with window_bits=17 (128KB window)
+ * XEX2 images are compressed with LZX (as in CAB / mspack) and stored as a
+ * chain of blocks:
+ *   - The format header holds the window size and the first block's
+ *     size + SHA-1
+ *   - Each block starts with the NEXT block's size + SHA-1 (24 bytes),
+ *     followed by chunks of [size (BE16)][LZX data], ended by a 0 size
+ *   - The concatenated chunks form one LZX stream of 32 KB frames
  *
- * The LZX algorithm uses three Huffman trees:
- *   - Main: literals (0-255) + match lengths
- *   - Length: additional match length bits
- *   - Aligned offset: for aligned-offset blocks
+ * The decoder reads the chunks in place through an input callback and
+ * writes straight into the destination, which doubles as the LZX window:
+ * no compressed staging copy and no separate window buffer.
  *
- * Reference: Microsoft CAB LZX specification + Xenia src
+ * The LZX algorithm uses four Huffman trees:
+ *   - Pre-tree: encodes the code lengths of the others
+ *   - Main: literals (0-255) + (position slot, length header) pairs
+ *   - Length: additional match length
+ *   - Aligned offset: low 3 offset bits in aligned-offset blocks
+ *
+ * Reference: Microsoft LZX DELTA / CAB LZX specification, libmspack lzxd
  */
 #pragma once
 
 #include <cstdint>
 #include <cstddef>
-#include <vector>
+#include <functional>
 
 namespace xe::kernel {
 
-/// Decompress XEX2 LZX-compressed data
-/// @param compressed_data  Pointer to compressed data (after XEX2 header)
-/// @param compressed_size  Size of compressed data
-/// @param uncompressed_size Expected output size (module_.image_size)
-/// @param window_bits      LZX window size bits (typically 17 for Xbox 360)
-/// @param block_descriptors Array of block sizes from the XEX2 format info
-/// @param output           Output vector to store decompressed data
-/// @return true on success
-bool LzxDecompress(const uint8_t* compressed_data,
-                   size_t compressed_size,
-                   size_t uncompressed_size,
-                   uint32_t window_bits,
-                   const std::vector<uint32_t>& block_sizes,
-                   std::vector<uint8_t>& output);
-
-/// Simpler XEX2-specific variant: handles the block chain with SHA-1 hashes
-/// Each compressed block is preceded by a 24-byte header:
-///   [0-3] = block data size (big-endian)
-///   [4-23] = SHA-1 hash of next block
-bool LzxDecompressXex(const uint8_t* data,
-                      size_t data_size,
-                      size_t uncompressed_size,
-                      uint32_t window_bits,
-                      uint32_t first_block_size,
-                      std::vector<uint8_t>& output);
+class LzxDecoder {
+ public:
+  /// Supplies the next span of compressed input; false when exhausted
+  using InputSource = std::function<bool(const uint8_t** data, size_t* size)>;
+
+  /// window_bits: 15 (32 KB) to 21 (2 MB)
+  explicit LzxDecoder(uint32_t window_bits);
+  ~LzxDecoder();
+
+  bool is_valid() const { return num_position_slots_ != 0; }
+
+  /// Decode exactly output_size bytes. output is used as the window, so
+  /// it must be the whole stream's destination from its first byte.
+  bool Decompress(const InputSource& input, uint8_t* output,
+                  size_t output_size);
+
+ private:
+  struct State;
+  uint32_t window_bits_;
+  uint32_t num_position_slots_ = 0;
+};
+
+/// Decompress one contiguous LZX stream
+bool LzxDecompress(const uint8_t* data, size_t data_size, uint8_t* output,
+                   size_t output_size, uint32_t window_bits);
+
+/// Decompress an XEX2 LZX block chain (see above) starting at data
+bool LzxDecompressXex(const uint8_t* data, size_t data_size,
+                      uint32_t first_block_size, uint32_t window_size,
+                      uint8_t* output, size_t output_size);
+
+/// Returns the size bytes of the chain at offset, valid until the next
+/// call, or nullptr on failure. Lets encrypted chains be decrypted one
+/// block at a time while the decoder consumes the previous one.
+using XexBlockReader =
+    std::function<const uint8_t*(size_t offset, size_t size)>;
+
+/// As above, with the chain (data_size bytes) supplied block by block
+bool LzxDecompressXex(const XexBlockReader& read_block, size_t data_size,
+                      uint32_t first_block_size, uint32_t window_size,
+                      uint8_t* output, size_t output_size);
 
 }  // namespace xe::kernel
@@ -0,0 +1,66 @@
+/**
+ * Vera360 — Xenia Edge
+ * xboxkrnl audio shim — XMA context allocation
+ *
+ * Titles claim XMA decoder contexts through the kernel and then drive them
+ * directly: they fill in the 64-byte context and kick it through the APU
+ * registers, which the XMA decoder services. Allocation goes through the
+ * ApuSystem so each context also gets its mixer voice.
+ */
+
+#include "xenia/kernel/kernel_state.h"
+#include "xenia/apu/apu_system.h"
+#include "xenia/base/logging.h"
+#include "xenia/base/memory/memory.h"
+#include <functional>
+
+namespace xe::kernel::xboxkrnl {
+
+extern void RegisterExport(uint32_t ordinal, std::function<uint32_t(uint32_t*)> thunk);
+
+// ── Status codes ─────────────────────────────────────────────────────────────
+static constexpr uint32_t STATUS_SUCCESS           = 0x00000000;
+static constexpr uint32_t STATUS_INVALID_PARAMETER = 0xC000000D;
+static constexpr uint32_t STATUS_NO_MEMORY         = 0xC0000017;
+
+// ── Guest memory helpers ─────────────────────────────────────────────────────
+static inline void GW32(uint32_t addr, uint32_t v) {
+  auto* p = static_cast<uint8_t*>(xe::memory::TranslateVirtual(addr));
+  p[0] = uint8_t(v >> 24); p[1] = uint8_t(v >> 16);
+  p[2] = uint8_t(v >> 8);  p[3] = uint8_t(v);
+}
+
+static apu::ApuSystem* Apu() {
+  auto* state = KernelState::shared();
+  return state ? state->apu_system() : nullptr;
+}
+
+void RegisterAudioExports() {
+
+  // XMACreateContext (672)
+  RegisterExport(672, [](uint32_t* args) -> uint32_t {
+    // NTSTATUS XMACreateContext(XMA_CONTEXT_DATA** Context)
+    uint32_t context_ptr = args[0];
+    if (!context_ptr) return STATUS_INVALID_PARAMETER;
+    auto* apu = Apu();
+    uint32_t context = apu ? apu->AllocateXmaContext() : 0;
+    GW32(context_ptr, context);
+    if (!context) {
+      XELOGW("XMACreateContext: no free context");
+      return STATUS_NO_MEMORY;
+    }
+    XELOGD("XMACreateContext -> 0x{:08X}", context);
+    return STATUS_SUCCESS;
+  });
+
+  // XMAReleaseContext (673)
+  RegisterExport(673, [](uint32_t* args) -> uint32_t {
+    // VOID XMAReleaseContext(XMA_CONTEXT_DATA* Context)
+    uint32_t context = args[0];
+    XELOGD("XMAReleaseContext: 0x{:08X}", context);
+    if (auto* apu = Apu(); apu && context) apu->ReleaseXmaContext(context);
+    return 0;
+  });
+}
+
+}  // namespace xe::kernel::xboxkrnl
@@ -9,21 +9,26 @@
  *   game:\\path                              → aliased game root
  *   d:\\path                                 → aliased game root
  *
- * We resolve these to host paths via the VFS mount table.
+ * All of these resolve through the kernel's VirtualFileSystem: the mount
+ * trie picks the device and the device's cached index finds the entry, so
+ * opens, attribute queries and directory enumeration never touch the host
+ * file system. Only file data I/O reaches the backing store.
  */
 
 #include "xenia/kernel/kernel_state.h"
+#include "xenia/vfs/virtual_file_system.h"
 #include "xenia/base/logging.h"
 #include "xenia/base/memory/memory.h"
+#include "xenia/base/replay.h"
+#include "xenia/base/state_stream.h"
+#include "xenia/base/trace.h"
 #include <functional>
 #include <cstring>
-#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
 #include <unordered_map>
-#include <sys/stat.h>
-#include <fcntl.h>
-#include <unistd.h>
-#include <dirent.h>
-#include <cerrno>
 #include <vector>
 
 namespace xe::kernel::xboxkrnl {
@@ -33,6 +38,7 @@ extern void RegisterExport(uint32_t ordinal, std::function<uint32_t(uint32_t*)>
 // ── Status codes ─────────────────────────────────────────────────────────────
 static constexpr uint32_t STATUS_SUCCESS              = 0x00000000;
 static constexpr uint32_t STATUS_PENDING              = 0x00000103;
+static constexpr uint32_t STATUS_NO_MORE_FILES        = 0x80000006;
 static constexpr uint32_t STATUS_INVALID_HANDLE       = 0xC0000008;
 static constexpr uint32_t STATUS_INVALID_PARAMETER    = 0xC000000D;
 static constexpr uint32_t STATUS_NO_SUCH_FILE         = 0xC000000F;
@@ -40,8 +46,27 @@ static constexpr uint32_t STATUS_END_OF_FILE          = 0xC0000011;
 static constexpr uint32_t STATUS_ACCESS_DENIED        = 0xC0000022;
 static constexpr uint32_t STATUS_OBJECT_NAME_NOT_FOUND= 0xC0000034;
 static constexpr uint32_t STATUS_OBJECT_NAME_COLLISION= 0xC0000035;
+static constexpr uint32_t STATUS_OBJECT_PATH_NOT_FOUND= 0xC000003A;
+static constexpr uint32_t STATUS_FILE_IS_A_DIRECTORY  = 0xC00000BA;
+static constexpr uint32_t STATUS_NOT_A_DIRECTORY      = 0xC0000103;
 static constexpr uint32_t STATUS_NOT_IMPLEMENTED      = 0xC0000002;
 
+// ── Create dispositions / options / results ──────────────────────────────────
+static constexpr uint32_t FILE_SUPERSEDE    = 0;
+static constexpr uint32_t FILE_OPEN         = 1;
+static constexpr uint32_t FILE_CREATE       = 2;
+static constexpr uint32_t FILE_OPEN_IF      = 3;
+static constexpr uint32_t FILE_OVERWRITE    = 4;
+static constexpr uint32_t FILE_OVERWRITE_IF = 5;
+
+static constexpr uint32_t FILE_DIRECTORY_FILE     = 0x00000001;
+static constexpr uint32_t FILE_NON_DIRECTORY_FILE = 0x00000040;
+
+static constexpr uint32_t FILE_SUPERSEDED  = 0;
+static constexpr uint32_t FILE_OPENED      = 1;
+static constexpr uint32_t FILE_CREATED     = 2;
+static constexpr uint32_t FILE_OVERWRITTEN = 3;
+
 // ── Guest-host helpers ───────────────────────────────────────────────────────
 static inline void GW32(uint32_t addr, uint32_t v) {
   auto* p = static_cast<uint8_t*>(xe::memory::TranslateVirtual(addr));
@@ -53,56 +78,97 @@ static inline uint32_t GR32(uint32_t addr) {
   return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) |
          (uint32_t(p[2]) << 8)  | p[3];
 }
+static inline void GW64(uint32_t addr, uint64_t v) {
+  GW32(addr, uint32_t(v >> 32));
+  GW32(addr + 4, uint32_t(v));
+}
+static inline uint64_t GR64(uint32_t addr) {
+  return (uint64_t(GR32(addr)) << 32) | GR32(addr + 4);
+}
+
+static inline void SetIoStatus(uint32_t io_status_ptr, uint32_t status,
+                               uint32_t information) {
+  if (!io_status_ptr) return;
+  GW32(io_status_ptr, status);
+  GW32(io_status_ptr + 4, information);
+}
+
+/// kIoCompletion payload
+struct IoCompletion {
+  uint32_t ordinal;
+  uint32_t handle;
+  uint32_t status;
+  uint32_t information;
+  uint64_t offset;
+  uint64_t data_hash;
+};
+
+/// Data I/O completes before the call returns, so the guest sees
+/// completions in call order; recorded runs log them and replays check
+/// them against the log
+static void NoteIoCompletion(uint32_t ordinal, uint32_t handle,
+                             uint64_t offset, uint32_t status,
+                             uint32_t information, const void* data) {
+  replay::Mode mode = replay::mode();
+  if (mode != replay::Mode::kRecord && mode != replay::Mode::kReplay) return;
+  IoCompletion completion = {ordinal, handle, status, information, offset,
+                             data ? replay::Hash(data, information) : 0};
+  replay::Check(replay::Event::kIoCompletion, &completion,
+                sizeof(completion));
+}
 
-// ── Simple file handle table ─────────────────────────────────────────────────
+// ── File handle table ────────────────────────────────────────────────────────
 namespace {
 
 struct OpenFile {
-  int fd = -1;
-  std::string host_path;
+  // Holds the device, and so entry, alive if it is unmounted while open
+  std::shared_ptr<vfs::VfsDevice> device;
+  vfs::VfsEntry* entry = nullptr;
+  std::unique_ptr<vfs::VfsFile> file;  // null for directories
   uint64_t position = 0;
   bool is_directory = false;
+  bool writable = false;
+  // Directory enumeration cursor + pattern captured on the first query
+  size_t enum_index = 0;
+  std::string enum_pattern;
 };
 
 std::unordered_map<uint32_t, OpenFile> g_open_files;
-uint32_t g_next_file_handle = 0x1000;
-
-/// Guest path prefix → host directory mapping
-std::unordered_map<std::string, std::string> g_mount_table;
-
-void InitMountTable() {
-  // Default mount: game:\ → /sdcard/Vera360/Games/
-  // Can be overridden later
-  g_mount_table["\\Device\\Harddisk0\\Partition1"] = "/sdcard/Vera360/HDD";
-  g_mount_table["\\Device\\CdRom0"] = "/sdcard/Vera360/Games";
-  g_mount_table["\\Device\\Mu0"] = "/sdcard/Vera360/MU";
-  g_mount_table["game:"] = "/sdcard/Vera360/Games";
-  g_mount_table["d:"] = "/sdcard/Vera360/Games";
-  g_mount_table["GAME:"] = "/sdcard/Vera360/Games";
-  g_mount_table["D:"] = "/sdcard/Vera360/Games";
+
+vfs::VirtualFileSystem* FileSystem() {
+  auto* state = KernelState::shared();
+  return state ? state->file_system() : nullptr;
 }
 
-std::string ResolveGuestPath(const std::string& guest_path) {
-  if (g_mount_table.empty()) InitMountTable();
+/// Resolve a guest path, keeping its device in *device for as long as the
+/// caller uses the entry
+vfs::VfsEntry* ResolveHeld(std::string_view guest_path,
+                           std::shared_ptr<vfs::VfsDevice>* device) {
+  auto* fs = FileSystem();
+  std::string_view relative;
+  *device = fs ? fs->ResolveDevice(guest_path, &relative) : nullptr;
+  return *device ? (*device)->ResolvePath(relative) : nullptr;
+}
 
-  for (auto& [prefix, host_root] : g_mount_table) {
-    if (guest_path.substr(0, prefix.size()) == prefix) {
-      std::string remainder = guest_path.substr(prefix.size());
-      // Convert backslashes to forward slashes
-      for (auto& c : remainder) {
-        if (c == '\\') c = '/';
-      }
-      return host_root + remainder;
-    }
-  }
+/// Read a guest ANSI_STRING { USHORT Length; USHORT MaxLength; PCHAR Buffer }
+std::string ReadAnsiString(uint32_t string_ptr) {
+  if (!string_ptr) return "";
+  auto* sp = static_cast<uint8_t*>(xe::memory::TranslateVirtual(string_ptr));
+  uint16_t len = (uint16_t(sp[0]) << 8) | sp[1];
+  uint32_t buf_ptr = GR32(string_ptr + 4);
+  if (!buf_ptr || len == 0) return "";
+  auto* chars = static_cast<const char*>(xe::memory::TranslateVirtual(buf_ptr));
+  return std::string(chars, len);
+}
 
-  // Try as-is with backslash conversion
-  std::string result = guest_path;
-  for (auto& c : result) {
-    if (c == '\\') c = '/';
+/// Full guest path of an entry (mount path + device-relative path)
+std::string EntryGuestPath(const vfs::VfsEntry* entry) {
+  std::string path = entry->device()->mount_path();
+  if (!entry->path().empty()) {
+    path.push_back('\\');
+    path += entry->path();
   }
-  XELOGW("IO: Could not resolve guest path: {}", guest_path);
-  return result;
+  return path;
 }
 
 /// Read a guest OBJECT_ATTRIBUTES structure to extract the path
@@ -111,38 +177,288 @@ std::string ReadObjectName(uint32_t obj_attrs_ptr) {
 
   // OBJECT_ATTRIBUTES (Xbox):
   //   +0: HANDLE RootDirectory (4 bytes, BE)
-  //   +4: PUNICODE_STRING ObjectName (4 bytes, BE)
+  //   +4: PANSI_STRING ObjectName (4 bytes, BE)
   //   +8: ULONG Attributes (4 bytes, BE)
-  uint32_t name_ptr = GR32(obj_attrs_ptr + 4);
-  if (!name_ptr) return "";
+  uint32_t root_handle = GR32(obj_attrs_ptr);
+  std::string name = ReadAnsiString(GR32(obj_attrs_ptr + 4));
+
+  // Names relative to an open directory handle
+  if (root_handle) {
+    auto it = g_open_files.find(root_handle);
+    if (it != g_open_files.end() && it->second.is_directory) {
+      std::string base = EntryGuestPath(it->second.entry);
+      if (!name.empty()) {
+        base.push_back('\\');
+        base += name;
+      }
+      return base;
+    }
+  }
+  return name;
+}
 
-  // UNICODE_STRING:
-  //   +0: USHORT Length (2 bytes, BE)
-  //   +2: USHORT MaximumLength (2 bytes, BE)
-  //   +4: PWSTR Buffer (4 bytes, BE)
-  auto* nsp = static_cast<uint8_t*>(xe::memory::TranslateVirtual(name_ptr));
-  uint16_t len = (uint16_t(nsp[0]) << 8) | nsp[1];
-  uint32_t buf_ptr = GR32(name_ptr + 4);
+/// Case-insensitive DOS wildcard match ('*', '?', "*.*" matches all)
+bool MatchPattern(std::string_view name, std::string_view pattern) {
+  if (pattern.empty() || pattern == "*" || pattern == "*.*") return true;
+  size_t n = 0, p = 0, star = std::string_view::npos, mark = 0;
+  auto fold = [](char c) {
+    return (c >= 'A' && c <= 'Z') ? char(c + ('a' - 'A')) : c;
+  };
+  while (n < name.size()) {
+    if (p < pattern.size() &&
+        (pattern[p] == '?' || fold(pattern[p]) == fold(name[n]))) {
+      ++n; ++p;
+    } else if (p < pattern.size() && pattern[p] == '*') {
+      star = p++;
+      mark = n;
+    } else if (star != std::string_view::npos) {
+      p = star + 1;
+      n = ++mark;
+    } else {
+      return false;
+    }
+  }
+  while (p < pattern.size() && pattern[p] == '*') ++p;
+  return p == pattern.size();
+}
 
-  if (!buf_ptr || len == 0) return "";
+/// Shared body of NtCreateFile / NtOpenFile
+uint32_t OpenGuestPath(uint32_t handle_out, uint32_t access,
+                       uint32_t obj_attrs_ptr, uint32_t io_status_ptr,
+                       uint32_t create_disp, uint32_t create_options,
+                       const char* caller) {
+  std::string guest_path = ReadObjectName(obj_attrs_ptr);
+  auto* fs = FileSystem();
+  if (!fs) {
+    SetIoStatus(io_status_ptr, STATUS_OBJECT_PATH_NOT_FOUND, 0);
+    return STATUS_OBJECT_PATH_NOT_FOUND;
+  }
 
-  // Read wide string (big-endian UTF-16)
-  auto* wstr = static_cast<uint8_t*>(xe::memory::TranslateVirtual(buf_ptr));
-  std::string result;
-  result.reserve(len / 2);
-  for (uint16_t i = 0; i < len; i += 2) {
-    uint16_t ch = (uint16_t(wstr[i]) << 8) | wstr[i + 1];
-    if (ch < 128) {
-      result.push_back(static_cast<char>(ch));
-    } else {
-      result.push_back('?');
+  std::shared_ptr<vfs::VfsDevice> device;
+  vfs::VfsEntry* entry = ResolveHeld(guest_path, &device);
+  bool exists = entry != nullptr;
+  bool want_dir = (create_options & FILE_DIRECTORY_FILE) != 0;
+  bool want_write = (access & 0x40000000) || (access & 0x00000002) ||
+                    (access & 0x00000004);
+
+  XELOGI("{}: '{}' access=0x{:08X} disp={} options=0x{:X} exists={}", caller,
+         guest_path, access, create_disp, create_options, exists);
+
+  if (exists && want_dir && !entry->is_directory()) {
+    SetIoStatus(io_status_ptr, STATUS_NOT_A_DIRECTORY, 0);
+    return STATUS_NOT_A_DIRECTORY;
+  }
+  if (exists && entry->is_directory() &&
+      (create_options & FILE_NON_DIRECTORY_FILE)) {
+    SetIoStatus(io_status_ptr, STATUS_FILE_IS_A_DIRECTORY, 0);
+    return STATUS_FILE_IS_A_DIRECTORY;
+  }
+
+  uint32_t information = FILE_OPENED;
+  bool truncate = false;
+  switch (create_disp) {
+    case FILE_SUPERSEDE:
+      truncate = exists;
+      information = exists ? FILE_SUPERSEDED : FILE_CREATED;
+      break;
+    case FILE_OPEN:
+      if (!exists) {
+        SetIoStatus(io_status_ptr, STATUS_OBJECT_NAME_NOT_FOUND, 0);
+        return STATUS_OBJECT_NAME_NOT_FOUND;
+      }
+      break;
+    case FILE_CREATE:
+      if (exists) {
+        SetIoStatus(io_status_ptr, STATUS_OBJECT_NAME_COLLISION, 0);
+        return STATUS_OBJECT_NAME_COLLISION;
+      }
+      information = FILE_CREATED;
+      break;
+    case FILE_OPEN_IF:
+      information = exists ? FILE_OPENED : FILE_CREATED;
+      break;
+    case FILE_OVERWRITE:
+      if (!exists) {
+        SetIoStatus(io_status_ptr, STATUS_OBJECT_NAME_NOT_FOUND, 0);
+        return STATUS_OBJECT_NAME_NOT_FOUND;
+      }
+      truncate = true;
+      information = FILE_OVERWRITTEN;
+      break;
+    case FILE_OVERWRITE_IF:
+      truncate = exists;
+      information = exists ? FILE_OVERWRITTEN : FILE_CREATED;
+      break;
+    default:
+      SetIoStatus(io_status_ptr, STATUS_INVALID_PARAMETER, 0);
+      return STATUS_INVALID_PARAMETER;
+  }
+
+  if (!exists) {
+    entry = fs->CreatePath(guest_path, want_dir);
+    // A remount in between would put the entry on a device we do not hold
+    if (!entry || entry->device() != device.get()) {
+      uint32_t status = (device && device->is_read_only())
+                            ? STATUS_ACCESS_DENIED
+                            : STATUS_OBJECT_PATH_NOT_FOUND;
+      SetIoStatus(io_status_ptr, status, 0);
+      return status;
+    }
+  }
+
+  OpenFile of;
+  of.device = std::move(device);
+  of.entry = entry;
+  of.is_directory = entry->is_directory();
+  if (!of.is_directory) {
+    auto file_access = (want_write || truncate) ? vfs::FileAccess::kReadWrite
+                                                : vfs::FileAccess::kRead;
+    of.writable = file_access == vfs::FileAccess::kReadWrite;
+    of.file = entry->device()->OpenFile(entry, file_access, truncate);
+    if (!of.file) {
+      XELOGW("{}: device refused open of '{}'", caller, guest_path);
+      SetIoStatus(io_status_ptr, STATUS_ACCESS_DENIED, 0);
+      return STATUS_ACCESS_DENIED;
     }
   }
-  return result;
+
+  // Same namespace as kernel objects, so NtClose never has to guess
+  uint32_t handle = KernelState::shared()->AllocateHandle();
+  g_open_files[handle] = std::move(of);
+
+  if (handle_out) GW32(handle_out, handle);
+  SetIoStatus(io_status_ptr, STATUS_SUCCESS, information);
+  XELOGI("{}: handle=0x{:08X}", caller, handle);
+  return STATUS_SUCCESS;
+}
+
+/// Reads at least this large try to remap image pages instead of copying
+constexpr size_t kRemapThreshold = 256 * 1024;
+
+/// Read file data into a guest buffer. Large page-aligned reads from
+/// memory-mapped images swap the file pages in directly; the unaligned
+/// head/tail (and everything else) is copied.
+bool ReadIntoGuest(vfs::VfsFile* file, uint8_t* dest, size_t length,
+                   uint64_t offset, size_t* bytes_read) {
+  // Host-backed files pread() straight into guest memory; pages a save
+  // state is tracking would fail with EFAULT instead of faulting
+  xe::memory::EnsureAccessible(dest, length);
+  if (length >= kRemapThreshold) {
+    size_t page = xe::memory::GetHostPageSize();
+    size_t head = (page - (reinterpret_cast<uintptr_t>(dest) & (page - 1))) &
+                  (page - 1);
+    size_t body = (length - head) & ~(page - 1);
+    if (body >= kRemapThreshold &&
+        file->MapInto(dest + head, body, offset + head)) {
+      size_t head_read = 0, tail_read = 0;
+      if (!file->Read(dest, head, offset, &head_read)) return false;
+      size_t tail = length - head - body;
+      if (!file->Read(dest + head + body, tail, offset + head + body,
+                      &tail_read)) {
+        return false;
+      }
+      *bytes_read = head + body + tail_read;
+      return true;
+    }
+  }
+  return file->Read(dest, length, offset, bytes_read);
+}
+
+/// Write the FILE_NETWORK_OPEN_INFORMATION block (56 bytes)
+void WriteNetworkOpenInfo(uint32_t info_ptr, const vfs::VfsEntry* entry) {
+  memset(xe::memory::TranslateVirtual(info_ptr), 0, 56);
+  GW64(info_ptr + 0, entry->create_timestamp());   // CreationTime
+  GW64(info_ptr + 8, entry->write_timestamp());    // LastAccessTime
+  GW64(info_ptr + 16, entry->write_timestamp());   // LastWriteTime
+  GW64(info_ptr + 24, entry->write_timestamp());   // ChangeTime
+  GW64(info_ptr + 32, entry->allocation_size());   // AllocationSize
+  GW64(info_ptr + 40, entry->size());              // EndOfFile
+  GW32(info_ptr + 48, entry->attributes());        // FileAttributes
 }
 
 }  // anonymous namespace
 
+/// Release a file handle; called from NtClose. Returns false if the handle
+/// is not a file.
+bool CloseFileHandle(uint32_t handle) {
+  return g_open_files.erase(handle) != 0;
+}
+
+/// Save states: open handles by guest path, reopened on restore (host
+/// files may have changed in between; handles that no longer resolve are
+/// dropped with a warning)
+void SaveFileState(StateWriter& writer) {
+  writer.Write(static_cast<uint32_t>(g_open_files.size()));
+  for (auto& [handle, of] : g_open_files) {
+    writer.Write(handle);
+    writer.WriteString(EntryGuestPath(of.entry));
+    writer.Write(of.position);
+    writer.Write(of.is_directory);
+    writer.Write(of.writable);
+    writer.Write(static_cast<uint64_t>(of.enum_index));
+    writer.WriteString(of.enum_pattern);
+  }
+}
+
+bool RestoreFileState(StateReader& reader, std::function<void()>* apply) {
+  struct SavedFile {
+    uint32_t handle = 0;
+    std::string path;
+    uint64_t position = 0;
+    bool is_directory = false;
+    bool writable = false;
+    uint64_t enum_index = 0;
+    std::string enum_pattern;
+  };
+  uint32_t count = 0;
+  if (!reader.Read(&count)) return false;
+  std::vector<SavedFile> saved(count);
+  for (auto& f : saved) {
+    reader.Read(&f.handle);
+    reader.ReadString(&f.path);
+    reader.Read(&f.position);
+    reader.Read(&f.is_directory);
+    reader.Read(&f.writable);
+    reader.Read(&f.enum_index);
+    if (!reader.ReadString(&f.enum_pattern)) return false;
+  }
+
+  // Files that cannot be reopened are dropped, so applying never fails
+  *apply = [saved = std::move(saved)]() mutable {
+    g_open_files.clear();
+    for (auto& f : saved) {
+      std::shared_ptr<vfs::VfsDevice> device;
+      vfs::VfsEntry* entry = ResolveHeld(f.path, &device);
+      if (!entry || entry->is_directory() != f.is_directory) {
+        XELOGW("Save state: '{}' no longer exists, handle 0x{:08X} dropped",
+               f.path, f.handle);
+        continue;
+      }
+      OpenFile of;
+      of.device = std::move(device);
+      of.entry = entry;
+      of.position = f.position;
+      of.is_directory = f.is_directory;
+      of.writable = f.writable;
+      of.enum_index = static_cast<size_t>(f.enum_index);
+      of.enum_pattern = std::move(f.enum_pattern);
+      if (!of.is_directory) {
+        of.file = entry->device()->OpenFile(
+            entry, f.writable ? vfs::FileAccess::kReadWrite
+                              : vfs::FileAccess::kRead,
+            false);
+        if (!of.file) {
+          XELOGW("Save state: cannot reopen '{}', handle 0x{:08X} dropped",
+                 f.path, f.handle);
+          continue;
+        }
+      }
+      g_open_files[f.handle] = std::move(of);
+    }
+  };
+  return true;
+}
+
 void RegisterIoExports() {
 
   // ═══════════════════════════════════════════════════════════════════════════
@@ -160,141 +476,22 @@ void RegisterIoExports() {
     //   ULONG FileAttributes,        // args[5]
     //   ULONG ShareAccess,           // args[6]
     //   ULONG CreateDisposition,     // args[7]
-    //   ULONG CreateOptions)         // args[8]
-    uint32_t handle_out = args[0];
-    uint32_t access = args[1];
-    uint32_t obj_attrs_ptr = args[2];
-    uint32_t io_status_ptr = args[3];
-    uint32_t create_disp = args[7];
-    uint32_t create_options = args[8];
-
-    std::string guest_path = ReadObjectName(obj_attrs_ptr);
-    std::string host_path = ResolveGuestPath(guest_path);
-
-    XELOGI("NtCreateFile: '{}' -> '{}' access=0x{:08X} disp=0x{:X}",
-           guest_path, host_path, access, create_disp);
-
-    // Check if it's a directory open
-    bool is_dir = (create_options & 0x01) != 0; // FILE_DIRECTORY_FILE
-
-    struct stat st;
-    bool exists = (stat(host_path.c_str(), &st) == 0);
-
-    if (is_dir) {
-      if (!exists || !S_ISDIR(st.st_mode)) {
-        if (io_status_ptr) {
-          GW32(io_status_ptr, STATUS_OBJECT_NAME_NOT_FOUND);
-          GW32(io_status_ptr + 4, 0);
-        }
-        return STATUS_OBJECT_NAME_NOT_FOUND;
-      }
-      // "Open" the directory
-      uint32_t handle = g_next_file_handle++;
-      OpenFile of;
-      of.host_path = host_path;
-      of.is_directory = true;
-      g_open_files[handle] = of;
-      if (handle_out) GW32(handle_out, handle);
-      if (io_status_ptr) {
-        GW32(io_status_ptr, STATUS_SUCCESS);
-        GW32(io_status_ptr + 4, 1);  // FILE_OPENED
-      }
-      return STATUS_SUCCESS;
-    }
-
-    // Create disposition:
-    // 0 = FILE_SUPERSEDE, 1 = FILE_OPEN, 2 = FILE_CREATE,
-    // 3 = FILE_OPEN_IF, 4 = FILE_OVERWRITE, 5 = FILE_OVERWRITE_IF
-    int flags = 0;
-    bool want_write = (access & 0x40000000) || (access & 0x00000002);
-    
-    switch (create_disp) {
-      case 0: // FILE_SUPERSEDE
-      case 5: // FILE_OVERWRITE_IF
-        flags = O_CREAT | O_TRUNC | (want_write ? O_RDWR : O_RDONLY);
-        break;
-      case 1: // FILE_OPEN
-        if (!exists) {
-          if (io_status_ptr) GW32(io_status_ptr, STATUS_OBJECT_NAME_NOT_FOUND);
-          return STATUS_OBJECT_NAME_NOT_FOUND;
-        }
-        flags = want_write ? O_RDWR : O_RDONLY;
-        break;
-      case 2: // FILE_CREATE
-        if (exists) {
-          if (io_status_ptr) GW32(io_status_ptr, STATUS_OBJECT_NAME_COLLISION);
-          return STATUS_OBJECT_NAME_COLLISION;
-        }
-        flags = O_CREAT | O_EXCL | (want_write ? O_RDWR : O_RDONLY);
-        break;
-      case 3: // FILE_OPEN_IF
-        flags = O_CREAT | (want_write ? O_RDWR : O_RDONLY);
-        break;
-      case 4: // FILE_OVERWRITE
-        if (!exists) {
-          if (io_status_ptr) GW32(io_status_ptr, STATUS_OBJECT_NAME_NOT_FOUND);
-          return STATUS_OBJECT_NAME_NOT_FOUND;
-        }
-        flags = O_TRUNC | (want_write ? O_RDWR : O_RDONLY);
-        break;
-      default:
-        flags = want_write ? O_RDWR : O_RDONLY;
-        break;
-    }
-
-    int fd = open(host_path.c_str(), flags, 0666);
-    if (fd < 0) {
-      XELOGW("NtCreateFile: open() failed: {} (errno={})", host_path, errno);
-      if (io_status_ptr) GW32(io_status_ptr, STATUS_OBJECT_NAME_NOT_FOUND);
-      return STATUS_OBJECT_NAME_NOT_FOUND;
-    }
-
-    uint32_t handle = g_next_file_handle++;
-    OpenFile of;
-    of.fd = fd;
-    of.host_path = host_path;
-    g_open_files[handle] = of;
-
-    if (handle_out) GW32(handle_out, handle);
-    if (io_status_ptr) {
-      GW32(io_status_ptr, STATUS_SUCCESS);
-      GW32(io_status_ptr + 4, exists ? 1 : 2);  // FILE_OPENED / FILE_CREATED
-    }
-
-    XELOGI("NtCreateFile: handle=0x{:08X} fd={}", handle, fd);
-    return STATUS_SUCCESS;
+    //   ULONG CreateOptions)         // args[8] — first stack argument
+    return OpenGuestPath(args[0], args[1], args[2], args[3], args[7], args[8],
+                         "NtCreateFile");
   });
 
-  // NtOpenFile (202) — simplified version of NtCreateFile
+  // NtOpenFile (202) — NtCreateFile with FILE_OPEN
   RegisterExport(202, [](uint32_t* args) -> uint32_t {
-    uint32_t handle_out = args[0];
-    uint32_t access = args[1];
-    uint32_t obj_attrs_ptr = args[2];
-    uint32_t io_status_ptr = args[3];
-
-    std::string guest_path = ReadObjectName(obj_attrs_ptr);
-    std::string host_path = ResolveGuestPath(guest_path);
-
-    XELOGI("NtOpenFile: '{}' -> '{}'", guest_path, host_path);
-
-    int fd = open(host_path.c_str(), O_RDONLY);
-    if (fd < 0) {
-      if (io_status_ptr) GW32(io_status_ptr, STATUS_OBJECT_NAME_NOT_FOUND);
-      return STATUS_OBJECT_NAME_NOT_FOUND;
-    }
-
-    uint32_t handle = g_next_file_handle++;
-    OpenFile of;
-    of.fd = fd;
-    of.host_path = host_path;
-    g_open_files[handle] = of;
-
-    if (handle_out) GW32(handle_out, handle);
-    if (io_status_ptr) {
-      GW32(io_status_ptr, STATUS_SUCCESS);
-      GW32(io_status_ptr + 4, 1);
-    }
-    return STATUS_SUCCESS;
+    // NTSTATUS NtOpenFile(
+    //   PHANDLE FileHandle,          // args[0] — out
+    //   ACCESS_MASK DesiredAccess,    // args[1]
+    //   POBJECT_ATTRIBUTES ObjAttrs, // args[2]
+    //   PIO_STATUS_BLOCK IoStatus,   // args[3]
+    //   ULONG ShareAccess,           // args[4]
+    //   ULONG OpenOptions)           // args[5]
+    return OpenGuestPath(args[0], args[1], args[2], args[3], FILE_OPEN,
+                         args[5], "NtOpenFile");
   });
 
   // ═══════════════════════════════════════════════════════════════════════════
@@ -311,59 +508,43 @@ void RegisterIoExports() {
     //   PIO_STATUS_BLOCK IoStatus,   // args[4]
     //   PVOID Buffer,               // args[5]
     //   ULONG Length,               // args[6]
-    //   PLARGE_INTEGER ByteOffset,  // args[7]
-    //   PULONG Key)                 // args[8]
+    //   PLARGE_INTEGER ByteOffset)  // args[7]
     uint32_t handle = args[0];
     uint32_t io_status_ptr = args[4];
     uint32_t buffer_ptr = args[5];
     uint32_t length = args[6];
     uint32_t offset_ptr = args[7];
+    XE_TRACE_ZONE_VALUE("io", "NtReadFile", length);
 
     auto it = g_open_files.find(handle);
-    if (it == g_open_files.end()) {
+    if (it == g_open_files.end() || !it->second.file) {
       XELOGW("NtReadFile: invalid handle 0x{:08X}", handle);
       return STATUS_INVALID_HANDLE;
     }
 
     auto& of = it->second;
-    if (of.fd < 0) return STATUS_INVALID_HANDLE;
-
-    // Seek if offset provided
-    if (offset_ptr) {
-      auto* op = static_cast<uint8_t*>(xe::memory::TranslateVirtual(offset_ptr));
-      int64_t offset = (int64_t(op[0]) << 56) | (int64_t(op[1]) << 48) |
-                       (int64_t(op[2]) << 40) | (int64_t(op[3]) << 32) |
-                       (int64_t(op[4]) << 24) | (int64_t(op[5]) << 16) |
-                       (int64_t(op[6]) << 8)  | int64_t(op[7]);
-      lseek(of.fd, offset, SEEK_SET);
-    }
-
-    void* host_buf = xe::memory::TranslateVirtual(buffer_ptr);
-    ssize_t bytes_read = read(of.fd, host_buf, length);
-
-    if (bytes_read < 0) {
-      XELOGW("NtReadFile: read() failed (errno={})", errno);
-      if (io_status_ptr) {
-        GW32(io_status_ptr, STATUS_ACCESS_DENIED);
-        GW32(io_status_ptr + 4, 0);
-      }
+    uint64_t offset = offset_ptr ? GR64(offset_ptr) : of.position;
+
+    auto* host_buf = static_cast<uint8_t*>(xe::memory::TranslateVirtual(buffer_ptr));
+    size_t bytes_read = 0;
+    if (!ReadIntoGuest(of.file.get(), host_buf, length, offset, &bytes_read)) {
+      XELOGW("NtReadFile: read failed at offset {}", offset);
+      SetIoStatus(io_status_ptr, STATUS_ACCESS_DENIED, 0);
+      NoteIoCompletion(209, handle, offset, STATUS_ACCESS_DENIED, 0, nullptr);
       return STATUS_ACCESS_DENIED;
     }
 
-    if (bytes_read == 0) {
-      if (io_status_ptr) {
-        GW32(io_status_ptr, STATUS_END_OF_FILE);
-        GW32(io_status_ptr + 4, 0);
-      }
+    if (bytes_read == 0 && length != 0) {
+      SetIoStatus(io_status_ptr, STATUS_END_OF_FILE, 0);
+      NoteIoCompletion(209, handle, offset, STATUS_END_OF_FILE, 0, nullptr);
       return STATUS_END_OF_FILE;
     }
 
-    of.position += bytes_read;
-    if (io_status_ptr) {
-      GW32(io_status_ptr, STATUS_SUCCESS);
-      GW32(io_status_ptr + 4, static_cast<uint32_t>(bytes_read));
-    }
-
+    of.position = offset + bytes_read;
+    SetIoStatus(io_status_ptr, STATUS_SUCCESS,
+                static_cast<uint32_t>(bytes_read));
+    NoteIoCompletion(209, handle, offset, STATUS_SUCCESS,
+                     static_cast<uint32_t>(bytes_read), host_buf);
     return STATUS_SUCCESS;
   });
 
@@ -374,39 +555,30 @@ void RegisterIoExports() {
     uint32_t buffer_ptr = args[5];
     uint32_t length = args[6];
     uint32_t offset_ptr = args[7];
+    XE_TRACE_ZONE_VALUE("io", "NtWriteFile", length);
 
     auto it = g_open_files.find(handle);
-    if (it == g_open_files.end()) return STATUS_INVALID_HANDLE;
+    if (it == g_open_files.end() || !it->second.file) {
+      return STATUS_INVALID_HANDLE;
+    }
 
     auto& of = it->second;
-    if (of.fd < 0) return STATUS_INVALID_HANDLE;
-
-    if (offset_ptr) {
-      auto* op = static_cast<uint8_t*>(xe::memory::TranslateVirtual(offset_ptr));
-      int64_t offset = (int64_t(op[0]) << 56) | (int64_t(op[1]) << 48) |
-                       (int64_t(op[2]) << 40) | (int64_t(op[3]) << 32) |
-                       (int64_t(op[4]) << 24) | (int64_t(op[5]) << 16) |
-                       (int64_t(op[6]) << 8)  | int64_t(op[7]);
-      lseek(of.fd, offset, SEEK_SET);
-    }
+    uint64_t offset = offset_ptr ? GR64(offset_ptr) : of.position;
 
     void* host_buf = xe::memory::TranslateVirtual(buffer_ptr);
-    ssize_t bytes_written = write(of.fd, host_buf, length);
-
-    if (bytes_written < 0) {
-      if (io_status_ptr) {
-        GW32(io_status_ptr, STATUS_ACCESS_DENIED);
-        GW32(io_status_ptr + 4, 0);
-      }
+    xe::memory::EnsureAccessible(host_buf, length);
+    size_t bytes_written = 0;
+    if (!of.file->Write(host_buf, length, offset, &bytes_written)) {
+      SetIoStatus(io_status_ptr, STATUS_ACCESS_DENIED, 0);
+      NoteIoCompletion(225, handle, offset, STATUS_ACCESS_DENIED, 0, nullptr);
       return STATUS_ACCESS_DENIED;
     }
 
-    of.position += bytes_written;
-    if (io_status_ptr) {
-      GW32(io_status_ptr, STATUS_SUCCESS);
-      GW32(io_status_ptr + 4, static_cast<uint32_t>(bytes_written));
-    }
-
+    of.position = offset + bytes_written;
+    SetIoStatus(io_status_ptr, STATUS_SUCCESS,
+                static_cast<uint32_t>(bytes_written));
+    NoteIoCompletion(225, handle, offset, STATUS_SUCCESS,
+                     static_cast<uint32_t>(bytes_written), host_buf);
     return STATUS_SUCCESS;
   });
 
@@ -428,43 +600,31 @@ void RegisterIoExports() {
     if (it == g_open_files.end()) return STATUS_INVALID_HANDLE;
 
     auto& of = it->second;
-    struct stat st;
-    bool have_stat = false;
-
-    if (of.fd >= 0) {
-      have_stat = (fstat(of.fd, &st) == 0);
-    } else if (!of.host_path.empty()) {
-      have_stat = (stat(of.host_path.c_str(), &st) == 0);
-    }
+    const vfs::VfsEntry* entry = of.entry;
+    uint32_t written = 0;
 
     switch (info_class) {
       case 5: {
         // FileStandardInformation
         // {LARGE_INTEGER AllocationSize, LARGE_INTEGER EndOfFile,
         //  ULONG NumberOfLinks, BOOLEAN DeletePending, BOOLEAN Directory}
-        if (info_ptr && info_length >= 24 && have_stat) {
+        if (info_ptr && info_length >= 24) {
           auto* p = static_cast<uint8_t*>(xe::memory::TranslateVirtual(info_ptr));
           memset(p, 0, 24);
-          uint64_t file_size = static_cast<uint64_t>(st.st_size);
-          // AllocationSize (8 bytes, BE)
-          for (int i = 0; i < 8; ++i) p[i] = uint8_t(file_size >> ((7-i)*8));
-          // EndOfFile (8 bytes, BE)
-          for (int i = 0; i < 8; ++i) p[8+i] = uint8_t(file_size >> ((7-i)*8));
-          // NumberOfLinks
-          GW32(info_ptr + 16, 1);
-          // DeletePending
-          p[20] = 0;
-          // Directory
-          p[21] = S_ISDIR(st.st_mode) ? 1 : 0;
+          GW64(info_ptr + 0, entry->allocation_size());
+          GW64(info_ptr + 8, entry->size());
+          GW32(info_ptr + 16, 1);        // NumberOfLinks
+          p[20] = 0;                     // DeletePending
+          p[21] = of.is_directory ? 1 : 0;
+          written = 24;
         }
         break;
       }
       case 34: {
         // FilePositionInformation
         if (info_ptr && info_length >= 8) {
-          uint64_t pos = of.position;
-          auto* p = static_cast<uint8_t*>(xe::memory::TranslateVirtual(info_ptr));
-          for (int i = 0; i < 8; ++i) p[i] = uint8_t(pos >> ((7-i)*8));
+          GW64(info_ptr, of.position);
+          written = 8;
         }
         break;
       }
@@ -472,27 +632,21 @@ void RegisterIoExports() {
         // FileBasicInformation
         // {CreationTime, LastAccessTime, LastWriteTime, ChangeTime, FileAttributes}
         if (info_ptr && info_length >= 40) {
-          auto* p = static_cast<uint8_t*>(xe::memory::TranslateVirtual(info_ptr));
-          memset(p, 0, 40);
-          // FileAttributes at offset 32
-          uint32_t attrs = 0x80; // FILE_ATTRIBUTE_NORMAL
-          if (have_stat && S_ISDIR(st.st_mode)) attrs = 0x10; // DIRECTORY
-          GW32(info_ptr + 32, attrs);
+          memset(xe::memory::TranslateVirtual(info_ptr), 0, 40);
+          GW64(info_ptr + 0, entry->create_timestamp());
+          GW64(info_ptr + 8, entry->write_timestamp());
+          GW64(info_ptr + 16, entry->write_timestamp());
+          GW64(info_ptr + 24, entry->write_timestamp());
+          GW32(info_ptr + 32, entry->attributes());
+          written = 40;
         }
         break;
       }
       case 35: {
         // FileNetworkOpenInformation
         if (info_ptr && info_length >= 56) {
-          memset(xe::memory::TranslateVirtual(info_ptr), 0, 56);
-          if (have_stat) {
-            uint64_t file_size = static_cast<uint64_t>(st.st_size);
-            auto* p = static_cast<uint8_t*>(xe::memory::TranslateVirtual(info_ptr));
-            // AllocationSize at 32
-            for (int i = 0; i < 8; ++i) p[32+i] = uint8_t(file_size >> ((7-i)*8));
-            // EndOfFile at 40
-            for (int i = 0; i < 8; ++i) p[40+i] = uint8_t(file_size >> ((7-i)*8));
-          }
+          WriteNetworkOpenInfo(info_ptr, entry);
+          written = 56;
         }
         break;
       }
@@ -501,34 +655,39 @@ void RegisterIoExports() {
         break;
     }
 
-    if (io_status_ptr) {
-      GW32(io_status_ptr, STATUS_SUCCESS);
-      GW32(io_status_ptr + 4, 0);
-    }
+    SetIoStatus(io_status_ptr, STATUS_SUCCESS, written);
     return STATUS_SUCCESS;
   });
 
   // NtSetInformationFile (218)
   RegisterExport(218, [](uint32_t* args) -> uint32_t {
     uint32_t handle = args[0];
+    uint32_t io_status_ptr = args[1];
+    uint32_t info_ptr = args[2];
     uint32_t info_class = args[4];
     XELOGI("NtSetInformationFile: handle=0x{:08X} class={}", handle, info_class);
 
-    if (info_class == 34) {
-      // FilePositionInformation — update file position
-      uint32_t info_ptr = args[2];
-      auto it = g_open_files.find(handle);
-      if (it != g_open_files.end() && info_ptr) {
-        auto* p = static_cast<uint8_t*>(xe::memory::TranslateVirtual(info_ptr));
-        int64_t new_pos = 0;
-        for (int i = 0; i < 8; ++i) new_pos |= int64_t(p[i]) << ((7-i)*8);
-        if (it->second.fd >= 0) {
-          lseek(it->second.fd, new_pos, SEEK_SET);
+    auto it = g_open_files.find(handle);
+    if (it == g_open_files.end()) return STATUS_INVALID_HANDLE;
+    auto& of = it->second;
+
+    switch (info_class) {
+      case 34:
+        // FilePositionInformation — update file position
+        if (info_ptr) of.position = GR64(info_ptr);
+        break;
+      case 20:
+        // FileEndOfFileInformation — resize
+        if (info_ptr && (!of.file || !of.file->SetLength(GR64(info_ptr)))) {
+          SetIoStatus(io_status_ptr, STATUS_ACCESS_DENIED, 0);
+          return STATUS_ACCESS_DENIED;
         }
-        it->second.position = new_pos;
-      }
+        break;
+      default:
+        break;
     }
 
+    SetIoStatus(io_status_ptr, STATUS_SUCCESS, 0);
     return STATUS_SUCCESS;
   });
 
@@ -538,14 +697,24 @@ void RegisterIoExports() {
 
   // NtQueryDirectoryFile (205)
   RegisterExport(205, [](uint32_t* args) -> uint32_t {
+    // NTSTATUS NtQueryDirectoryFile(
+    //   HANDLE FileHandle,           // args[0]
+    //   HANDLE Event,                // args[1]
+    //   PIO_APC_ROUTINE ApcRoutine,  // args[2]
+    //   PVOID ApcContext,            // args[3]
+    //   PIO_STATUS_BLOCK IoStatus,   // args[4]
+    //   PVOID FileInformation,       // args[5]
+    //   ULONG Length,                // args[6]
+    //   PANSI_STRING FileName,       // args[7] — optional pattern
+    //   BOOLEAN RestartScan)         // args[8] — first stack argument
     uint32_t handle = args[0];
     uint32_t io_status_ptr = args[4];
     uint32_t buffer_ptr = args[5];
     uint32_t buffer_length = args[6];
-    uint32_t info_class = args[7];
-    uint32_t file_name_ptr = args[9];
+    uint32_t file_name_ptr = args[7];
+    bool restart_scan = (args[8] & 0xFF) != 0;
 
-    XELOGI("NtQueryDirectoryFile: handle=0x{:08X} class={} buflen={}", handle, info_class, buffer_length);
+    XELOGI("NtQueryDirectoryFile: handle=0x{:08X} buflen={}", handle, buffer_length);
 
     auto it = g_open_files.find(handle);
     if (it == g_open_files.end() || !it->second.is_directory) {
@@ -554,130 +723,75 @@ void RegisterIoExports() {
 
     auto& of = it->second;
 
-    // Read optional filename filter
-    std::string filter;
-    if (file_name_ptr) {
-      // UNICODE_STRING: Length(2), MaxLen(2), Buffer(4)
-      auto* nsp = static_cast<uint8_t*>(xe::memory::TranslateVirtual(file_name_ptr));
-      uint16_t len = (uint16_t(nsp[0]) << 8) | nsp[1];
-      uint32_t buf_ptr = GR32(file_name_ptr + 4);
-      if (buf_ptr && len > 0) {
-        auto* wstr = static_cast<uint8_t*>(xe::memory::TranslateVirtual(buf_ptr));
-        filter.reserve(len / 2);
-        for (uint16_t i = 0; i < len; i += 2) {
-          uint16_t ch = (uint16_t(wstr[i]) << 8) | wstr[i + 1];
-          if (ch < 128) filter.push_back(static_cast<char>(ch));
-          else filter.push_back('?');
-        }
-      }
-    }
-
-    // Open directory and enumerate
-    DIR* dir = opendir(of.host_path.c_str());
-    if (!dir) {
-      if (io_status_ptr) {
-        GW32(io_status_ptr, STATUS_NO_SUCH_FILE);
-        GW32(io_status_ptr + 4, 0);
-      }
-      return STATUS_NO_SUCH_FILE;
+    // The pattern is latched on the first query (or on restart)
+    if (restart_scan || of.enum_index == 0) {
+      of.enum_index = 0;
+      of.enum_pattern = ReadAnsiString(file_name_ptr);
     }
 
-    // Skip entries based on position (simple state: use position counter)
-    uint64_t skip = of.position;
-    uint64_t current = 0;
-    struct dirent* entry = nullptr;
-    bool found = false;
-
-    auto* out = static_cast<uint8_t*>(xe::memory::TranslateVirtual(buffer_ptr));
-    uint32_t bytes_written = 0;
-
-    while ((entry = readdir(dir)) != nullptr) {
-      // Skip . and ..
-      if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
-
-      if (current < skip) { current++; continue; }
-
-      // Apply filter (simple wildcard: * matches all)
-      if (!filter.empty() && filter != "*" && filter != "*.*") {
-        // Basic check: if filter doesn't match the filename, skip
-        bool match = false;
-        if (filter.find('*') != std::string::npos || filter.find('?') != std::string::npos) {
-          match = true;  // Treat any wildcard as match-all for now
-        } else {
-          match = (strcasecmp(entry->d_name, filter.c_str()) == 0);
+    of.device->ListDirectory(of.entry);
+    const vfs::VfsEntry* entry = nullptr;
+    uint32_t file_index = 0;
+    bool empty;
+    {
+      // Another thread creating a file here may grow the children vector
+      std::lock_guard<std::mutex> lock(of.device->tree_mutex());
+      const auto& children = of.entry->children();
+      empty = children.empty();
+      while (of.enum_index < children.size()) {
+        file_index = static_cast<uint32_t>(of.enum_index);
+        const auto* candidate = children[of.enum_index++].get();
+        if (MatchPattern(candidate->name(), of.enum_pattern)) {
+          entry = candidate;
+          break;
         }
-        if (!match) { current++; continue; }
       }
-
-      // Get file info
-      std::string full_path = of.host_path + "/" + entry->d_name;
-      struct stat st;
-      if (stat(full_path.c_str(), &st) != 0) { current++; continue; }
-
-      // Write FileBothDirectoryInformation (info_class=3) or FileDirectoryInformation (info_class=1)
-      // Both have similar layout:
-      // +0: NextEntryOffset (4, BE)
-      // +4: FileIndex (4, BE)
-      // +8: CreationTime (8, BE)
-      // +16: LastAccessTime (8, BE)
-      // +24: LastWriteTime (8, BE)
-      // +32: ChangeTime (8, BE)
-      // +40: EndOfFile (8, BE)
-      // +48: AllocationSize (8, BE)
-      // +56: FileAttributes (4, BE)
-      // +60: FileNameLength (4, BE)
-      // +64: FileName (variable, wide chars BE)
-
-      size_t name_len = strlen(entry->d_name);
-      uint32_t entry_size = 64 + static_cast<uint32_t>(name_len * 2);
-      entry_size = (entry_size + 7) & ~7u;  // Align to 8 bytes
-
-      if (bytes_written + entry_size > buffer_length) break;
-
-      memset(out + bytes_written, 0, entry_size);
-      // NextEntryOffset = 0 (last entry for now; real impl chains them)
-      GW32(buffer_ptr + bytes_written + 0, 0);
-      // FileIndex
-      GW32(buffer_ptr + bytes_written + 4, static_cast<uint32_t>(current));
-      // EndOfFile
-      uint64_t file_size = static_cast<uint64_t>(st.st_size);
-      auto* eof_p = out + bytes_written + 40;
-      for (int j = 0; j < 8; ++j) eof_p[j] = uint8_t(file_size >> ((7-j)*8));
-      // AllocationSize
-      auto* alloc_p = out + bytes_written + 48;
-      for (int j = 0; j < 8; ++j) alloc_p[j] = uint8_t(file_size >> ((7-j)*8));
-      // FileAttributes
-      uint32_t attrs = S_ISDIR(st.st_mode) ? 0x10 : 0x80;
-      GW32(buffer_ptr + bytes_written + 56, attrs);
-      // FileNameLength (in bytes, wide)
-      GW32(buffer_ptr + bytes_written + 60, static_cast<uint32_t>(name_len * 2));
-      // FileName (big-endian UTF-16)
-      auto* fname_p = out + bytes_written + 64;
-      for (size_t j = 0; j < name_len; ++j) {
-        fname_p[j * 2] = 0;
-        fname_p[j * 2 + 1] = static_cast<uint8_t>(entry->d_name[j]);
-      }
-
-      bytes_written += entry_size;
-      of.position = current + 1;
-      found = true;
-      break;  // Return one entry at a time (simplification)
     }
 
-    closedir(dir);
-
-    if (!found) {
-      if (io_status_ptr) {
-        GW32(io_status_ptr, STATUS_NO_SUCH_FILE);
-        GW32(io_status_ptr + 4, 0);
-      }
-      return STATUS_NO_SUCH_FILE;
+    if (!entry) {
+      uint32_t status = file_index == 0 && empty
+                            ? STATUS_NO_SUCH_FILE : STATUS_NO_MORE_FILES;
+      SetIoStatus(io_status_ptr, status, 0);
+      return status;
     }
 
-    if (io_status_ptr) {
-      GW32(io_status_ptr, STATUS_SUCCESS);
-      GW32(io_status_ptr + 4, bytes_written);
+    // FILE_DIRECTORY_INFORMATION (Xbox, ANSI name):
+    // +0: NextEntryOffset (4, BE)
+    // +4: FileIndex (4, BE)
+    // +8: CreationTime (8, BE)
+    // +16: LastAccessTime (8, BE)
+    // +24: LastWriteTime (8, BE)
+    // +32: ChangeTime (8, BE)
+    // +40: EndOfFile (8, BE)
+    // +48: AllocationSize (8, BE)
+    // +56: FileAttributes (4, BE)
+    // +60: FileNameLength (4, BE)
+    // +64: FileName (variable, char)
+    const std::string& name = entry->name();
+    uint32_t entry_size = 64 + static_cast<uint32_t>(name.size());
+    entry_size = (entry_size + 7) & ~7u;  // Align to 8 bytes
+
+    if (entry_size > buffer_length) {
+      --of.enum_index;  // Retry this entry with a bigger buffer
+      SetIoStatus(io_status_ptr, STATUS_INVALID_PARAMETER, 0);
+      return STATUS_INVALID_PARAMETER;
     }
+
+    auto* out = static_cast<uint8_t*>(xe::memory::TranslateVirtual(buffer_ptr));
+    memset(out, 0, entry_size);
+    GW32(buffer_ptr + 0, 0);  // Single entry per call
+    GW32(buffer_ptr + 4, file_index);
+    GW64(buffer_ptr + 8, entry->create_timestamp());
+    GW64(buffer_ptr + 16, entry->write_timestamp());
+    GW64(buffer_ptr + 24, entry->write_timestamp());
+    GW64(buffer_ptr + 32, entry->write_timestamp());
+    GW64(buffer_ptr + 40, entry->size());
+    GW64(buffer_ptr + 48, entry->allocation_size());
+    GW32(buffer_ptr + 56, entry->attributes());
+    GW32(buffer_ptr + 60, static_cast<uint32_t>(name.size()));
+    memcpy(out + 64, name.data(), name.size());
+
+    SetIoStatus(io_status_ptr, STATUS_SUCCESS, entry_size);
     return STATUS_SUCCESS;
   });
 
@@ -687,29 +801,16 @@ void RegisterIoExports() {
     uint32_t info_ptr = args[1];
 
     std::string guest_path = ReadObjectName(obj_attrs_ptr);
-    std::string host_path = ResolveGuestPath(guest_path);
+    std::shared_ptr<vfs::VfsDevice> device;
+    vfs::VfsEntry* entry = ResolveHeld(guest_path, &device);
 
-    XELOGI("NtQueryFullAttributesFile: '{}' -> '{}'", guest_path, host_path);
+    XELOGI("NtQueryFullAttributesFile: '{}' found={}", guest_path,
+           entry != nullptr);
 
-    struct stat st;
-    if (stat(host_path.c_str(), &st) != 0) {
-      return STATUS_OBJECT_NAME_NOT_FOUND;
-    }
+    if (!entry) return STATUS_OBJECT_NAME_NOT_FOUND;
 
     // Fill FILE_NETWORK_OPEN_INFORMATION (56 bytes)
-    if (info_ptr) {
-      auto* p = static_cast<uint8_t*>(xe::memory::TranslateVirtual(info_ptr));
-      memset(p, 0, 56);
-      uint64_t file_size = static_cast<uint64_t>(st.st_size);
-      // AllocationSize at 32
-      for (int i = 0; i < 8; ++i) p[32+i] = uint8_t(file_size >> ((7-i)*8));
-      // EndOfFile at 40
-      for (int i = 0; i < 8; ++i) p[40+i] = uint8_t(file_size >> ((7-i)*8));
-      // FileAttributes at 48
-      uint32_t attrs = S_ISDIR(st.st_mode) ? 0x10 : 0x80;
-      GW32(info_ptr + 48, attrs);
-    }
-
+    if (info_ptr) WriteNetworkOpenInfo(info_ptr, entry);
     return STATUS_SUCCESS;
   });
 
@@ -717,8 +818,7 @@ void RegisterIoExports() {
   // Close / DeviceIoControl
   // ═══════════════════════════════════════════════════════════════════════════
 
-  // NtClose (184) — handled in module, but also close our file table
-  // (The module version just removes from kernel object table)
+  // NtClose (184) — handled in module, which calls CloseFileHandle()
 
   // NtDeviceIoControlFile (198)
   RegisterExport(198, [](uint32_t* args) -> uint32_t {
@@ -747,24 +847,28 @@ void RegisterIoExports() {
 
     // FileFsSizeInformation (3)
     if (info_class == 3 && buffer_ptr && buffer_length >= 24) {
-      auto* p = static_cast<uint8_t*>(xe::memory::TranslateVirtual(buffer_ptr));
-      memset(p, 0, 24);
-      // TotalAllocationUnits = 512MB / 16KB = 32768
-      GW32(buffer_ptr + 0, 0);
-      GW32(buffer_ptr + 4, 32768);
-      // AvailableAllocationUnits
-      GW32(buffer_ptr + 8, 0);
-      GW32(buffer_ptr + 12, 16384);
-      // SectorsPerAllocationUnit = 32
-      GW32(buffer_ptr + 16, 32);
-      // BytesPerSector = 512
-      GW32(buffer_ptr + 20, 512);
+      constexpr uint32_t kSectorsPerUnit = 32;
+      constexpr uint32_t kBytesPerSector = 512;
+      constexpr uint64_t kUnitSize = kSectorsPerUnit * kBytesPerSector;
+      // Defaults: 512MB total, 256MB free
+      uint64_t total_units = 32768;
+      uint64_t free_units = 16384;
+      auto it = g_open_files.find(handle);
+      if (it != g_open_files.end()) {
+        auto& device = it->second.device;
+        if (device->total_bytes()) {
+          total_units = device->total_bytes() / kUnitSize;
+          free_units = device->free_bytes() / kUnitSize;
+        }
+      }
+      memset(xe::memory::TranslateVirtual(buffer_ptr), 0, 24);
+      GW64(buffer_ptr + 0, total_units);
+      GW64(buffer_ptr + 8, free_units);
+      GW32(buffer_ptr + 16, kSectorsPerUnit);
+      GW32(buffer_ptr + 20, kBytesPerSector);
     }
 
-    if (io_status_ptr) {
-      GW32(io_status_ptr, STATUS_SUCCESS);
-      GW32(io_status_ptr + 4, 0);
-    }
+    SetIoStatus(io_status_ptr, STATUS_SUCCESS, 0);
     return STATUS_SUCCESS;
   });
 
@@ -774,13 +878,22 @@ void RegisterIoExports() {
 
   // ObCreateSymbolicLink (— ordinal 351)
   RegisterExport(351, [](uint32_t* args) -> uint32_t {
-    XELOGI("ObCreateSymbolicLink");
+    std::string link = ReadAnsiString(args[0]);
+    std::string target = ReadAnsiString(args[1]);
+    XELOGI("ObCreateSymbolicLink: '{}' -> '{}'", link, target);
+    auto* fs = FileSystem();
+    if (fs && !link.empty() && !target.empty()) {
+      fs->RegisterSymbolicLink(link, target);
+    }
     return STATUS_SUCCESS;
   });
 
   // ObDeleteSymbolicLink (352)
   RegisterExport(352, [](uint32_t* args) -> uint32_t {
-    XELOGI("ObDeleteSymbolicLink");
+    std::string link = ReadAnsiString(args[0]);
+    XELOGI("ObDeleteSymbolicLink: '{}'", link);
+    auto* fs = FileSystem();
+    if (fs && !link.empty()) fs->UnregisterSymbolicLink(link);
     return STATUS_SUCCESS;
   });
 
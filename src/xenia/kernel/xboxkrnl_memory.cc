@@ -17,6 +17,7 @@
 #include "xenia/kernel/kernel_state.h"
 #include "xenia/base/memory/memory.h"
 #include "xenia/base/logging.h"
+#include "xenia/base/state_stream.h"
 #include <functional>
 #include <cstring>
 #include <algorithm>
@@ -77,6 +78,24 @@ static xe::memory::PageAccess MapProtect(uint32_t xbox_protect) {
   return xe::memory::PageAccess::kNoAccess;
 }
 
+/// Save states: the allocator cursors (pages themselves are in the
+/// snapshot's guest memory image)
+void SaveMemoryState(StateWriter& writer) {
+  writer.Write(g_virtual_alloc_ptr);
+  writer.Write(g_physical_alloc_ptr);
+}
+
+bool RestoreMemoryState(StateReader& reader, std::function<void()>* apply) {
+  uint32_t virtual_ptr = 0, physical_ptr = 0;
+  reader.Read(&virtual_ptr);
+  if (!reader.Read(&physical_ptr)) return false;
+  *apply = [virtual_ptr, physical_ptr]() {
+    g_virtual_alloc_ptr = virtual_ptr;
+    g_physical_alloc_ptr = physical_ptr;
+  };
+  return true;
+}
+
 void RegisterMemoryExports() {
 
   // ═══════════════════════════════════════════════════════════════════════════
@@ -17,6 +17,8 @@
 #include "xenia/base/logging.h"
 #include "xenia/base/memory/memory.h"
 #include "xenia/base/clock.h"
+#include "xenia/base/replay.h"
+#include "xenia/base/timebase.h"
 #include <unordered_map>
 #include <functional>
 #include <cstring>
@@ -49,6 +51,8 @@ uint32_t Dispatch(uint32_t ordinal, uint32_t* args) {
 extern void RegisterThreadingExports();
 extern void RegisterMemoryExports();
 extern void RegisterIoExports();
+extern void RegisterAudioExports();
+extern bool CloseFileHandle(uint32_t handle);
 
 // ─────────────────────────────────────────────────────────────────────────────
 // NT status codes
@@ -213,7 +217,7 @@ void RegisterAllExports() {
 
   // KeQueryPerformanceCounter (18) → returns 64-bit counter via guest pointer
   RegisterExport(18, [](uint32_t* args) -> uint32_t {
-    uint64_t ts = xe::Clock::QueryGuestTickCount();
+    uint64_t ts = xe::timebase::QueryGuestTicks();
     // Xbox 360 returns result in a LARGE_INTEGER* at args[0]
     if (args[0]) {
       auto* p = static_cast<uint8_t*>(xe::memory::TranslateVirtual(args[0]));
@@ -228,8 +232,8 @@ void RegisterAllExports() {
 
   // KeQueryPerformanceFrequency (19)
   RegisterExport(19, [](uint32_t* args) -> uint32_t {
-    // Xbox 360 timebase = 50 MHz
-    constexpr uint32_t kTimebaseFreq = 50000000;
+    // The rate KeQueryPerformanceCounter actually counts at
+    constexpr uint32_t kTimebaseFreq = xe::timebase::kGuestTickRate;
     if (args[0]) GuestWrite32(args[0], kTimebaseFreq);
     return kTimebaseFreq;
   });
@@ -237,14 +241,23 @@ void RegisterAllExports() {
   // KeQuerySystemTime (154) → fills FILETIME* at args[0]
   RegisterExport(154, [](uint32_t* args) -> uint32_t {
     // Windows FILETIME: 100ns intervals since 1601-01-01
-    // We approximate with current time
-    struct timespec ts;
-    clock_gettime(CLOCK_REALTIME, &ts);
-    // Epoch offset from 1601 to 1970 in 100ns units
-    constexpr uint64_t kEpochDelta = 116444736000000000ULL;
-    uint64_t ft = kEpochDelta +
-                  static_cast<uint64_t>(ts.tv_sec) * 10000000ULL +
-                  static_cast<uint64_t>(ts.tv_nsec) / 100;
+    uint64_t ft;
+    if (xe::replay::deterministic()) {
+      // The replay date, advanced by guest time
+      using xe::timebase::uint128_t;
+      ft = xe::replay::system_time() +
+           uint64_t(uint128_t(xe::timebase::QueryGuestTicks()) * 10000000ULL /
+                    xe::timebase::kGuestTickRate);
+    } else {
+      // We approximate with current time
+      struct timespec ts;
+      clock_gettime(CLOCK_REALTIME, &ts);
+      // Epoch offset from 1601 to 1970 in 100ns units
+      constexpr uint64_t kEpochDelta = 116444736000000000ULL;
+      ft = kEpochDelta +
+           static_cast<uint64_t>(ts.tv_sec) * 10000000ULL +
+           static_cast<uint64_t>(ts.tv_nsec) / 100;
+    }
     if (args[0]) {
       auto* p = static_cast<uint8_t*>(xe::memory::TranslateVirtual(args[0]));
       // FILETIME in big-endian
@@ -295,6 +308,7 @@ void RegisterAllExports() {
   RegisterExport(184, [](uint32_t* args) -> uint32_t {
     uint32_t handle = args[0];
     XELOGI("NtClose: handle=0x{:08X}", handle);
+    if (CloseFileHandle(handle)) return X_STATUS_SUCCESS;
     auto* state = KernelState::shared();
     if (state) state->UnregisterObject(handle);
     return X_STATUS_SUCCESS;
@@ -922,6 +936,7 @@ void RegisterAllExports() {
   RegisterThreadingExports();
   RegisterMemoryExports();
   RegisterIoExports();
+  RegisterAudioExports();
 
   XELOGI("Registered xboxkrnl exports ({} total)", g_exports.size());
 }
@@ -17,6 +17,8 @@
 #include "xenia/kernel/xobject.h"
 #include "xenia/base/logging.h"
 #include "xenia/base/memory/memory.h"
+#include "xenia/base/replay.h"
+#include "xenia/base/timebase.h"
 #include <functional>
 #include <cstring>
 #include <thread>
@@ -416,7 +418,11 @@ void RegisterThreadingExports() {
       if (interval < 0) {
         int64_t us = (-interval) / 10;  // Convert 100ns to microseconds
         if (us > 1000000) us = 1000000; // Cap at 1 second
-        if (us > 0) {
+        if (us > 0 && xe::replay::deterministic()) {
+          // Sleeping passes guest time, not host time
+          xe::timebase::AdvanceTicks(
+              uint64_t(us) * xe::timebase::kGuestTickRate / 1000000);
+        } else if (us > 0) {
           std::this_thread::sleep_for(std::chrono::microseconds(us));
         }
       }
@@ -2,41 +2,286 @@
  * Vera360 — Xenia Edge
  * XEX2 Loader — full implementation
  *
- * Parses XEX2 headers, decompresses PE image, maps into guest memory,
- * resolves kernel imports via HLE thunks.
+ * Parses XEX2 headers from a mapped file, decompresses the PE image
+ * directly into guest memory, resolves kernel imports via HLE thunks.
  */
 
 #include "xenia/kernel/xex2_loader.h"
 #include "xenia/kernel/lzx_decoder.h"
+#include "xenia/base/aes.h"
+#include "xenia/base/cvar.h"
+#include "xenia/base/job_system.h"
 #include "xenia/base/logging.h"
+#include "xenia/base/mapped_file.h"
 #include "xenia/base/memory/memory.h"
+#include "xenia/base/sha1.h"
+#include "xenia/base/verified_cache.h"
+#include "xenia/cpu/guest_function_map.h"
 #include "xenia/cpu/processor.h"
 
+#include <unistd.h>
 #include <algorithm>
 #include <cstring>
-#include <fstream>
 
 namespace xe::loader {
 
+DEFINE_bool(xex_verify_hashes, true,
+            "Check the SHA-1 chain of LZX-compressed XEX images while they "
+            "decompress; files that pass are not checked again");
+
+namespace {
+
+// ── Decryption ──────────────────────────────────────────────────────────────
+
+constexpr uint8_t kRetailKey[16] = {0x20, 0xB1, 0x85, 0xA5, 0x9D, 0x28,
+                                    0xFD, 0xC3, 0x40, 0x58, 0x3F, 0xBB,
+                                    0x08, 0x96, 0xBF, 0x91};
+constexpr uint8_t kDevkitKey[16] = {};
+
+/// Image data stream CBC IV
+constexpr uint8_t kZeroIv[16] = {};
+
+/// Below this, splitting a CBC decrypt across threads costs more than it saves
+constexpr size_t kMinParallelDecryptBytes = 1024 * 1024;
+constexpr uint32_t kMaxDecryptThreads = 4;
+
+uint32_t OnlineCoreCount() {
+  long cores = sysconf(_SC_NPROCESSORS_ONLN);
+  return cores > 0 ? static_cast<uint32_t>(cores) : 1;
+}
+
+uint32_t LoadBE32(const uint8_t* p) {
+  return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) |
+         (uint32_t(p[2]) << 8) | p[3];
+}
+
+/// Bytes [src_offset, src_offset + length) of the data stream land at dest
+struct ImageSpan {
+  size_t src_offset;
+  uint8_t* dest;
+  size_t length;
+};
+
+/// Copy (or CBC-decrypt) the spans into place. CBC decryption only needs
+/// the previous ciphertext block, so with aes the byte range is cut into
+/// equal slices, one per thread.
+void CopyImageSpans(const uint8_t* stream, size_t stream_size,
+                    const std::vector<ImageSpan>& spans, const Aes128* aes) {
+  if (!aes) {
+    for (auto& span : spans) {
+      memcpy(span.dest, stream + span.src_offset, span.length);
+    }
+    return;
+  }
+  size_t total = 0;
+  for (auto& span : spans) total += span.length;
+  uint32_t thread_count = std::min<uint32_t>(
+      kMaxDecryptThreads, std::min<size_t>(OnlineCoreCount(),
+                                           total / kMinParallelDecryptBytes + 1));
+
+  // Slice t covers [t * total / n, (t + 1) * total / n) of the span bytes
+  auto decrypt = [&](uint32_t t) {
+    size_t begin = total * t / thread_count;
+    size_t end = total * (t + 1) / thread_count;
+    size_t pos = 0;
+    for (auto& span : spans) {
+      size_t lo = std::max(begin, pos);
+      size_t hi = std::min(end, pos + span.length);
+      if (lo < hi) {
+        aes->DecryptCbcRange(stream, stream_size, span.src_offset + (lo - pos),
+                             hi - lo, span.dest + (lo - pos), kZeroIv);
+      }
+      pos += span.length;
+      if (pos >= end) break;
+    }
+  };
+  xe::threading::JobOptions options;
+  options.name = "xex_decrypt";
+  options.priority = xe::threading::JobPriority::kCritical;
+  xe::threading::JobSystem::Shared().ParallelFor(thread_count, decrypt,
+                                                 options);
+}
+
+// ── Block chain verification ────────────────────────────────────────────────
+
+constexpr size_t kChainHeaderSize = 4 + Sha1::kDigestSize;
+
+/// Does a chain block match the SHA-1 its predecessor (or the format
+/// header, for the first block) recorded?
+bool ChainBlockMatches(const uint8_t* block, size_t size,
+                       const uint8_t* expected) {
+  uint8_t digest[Sha1::kDigestSize];
+  Sha1::Digest(block, size, digest);
+  return memcmp(digest, expected, Sha1::kDigestSize) == 0;
+}
+
+/// Walks a plaintext chain in place as a pool job, alongside the decoder
+/// reading the same bytes
+class ChainVerifier {
+ public:
+  ChainVerifier(const uint8_t* stream, size_t stream_size,
+                uint32_t first_block_size, const uint8_t* first_hash) {
+    xe::threading::JobOptions options;
+    options.name = "xex_verify";
+    options.priority = xe::threading::JobPriority::kCritical;
+    options.counter = &counter_;
+    xe::threading::JobSystem::Shared().Submit(
+        [=, this]() {
+          Walk(stream, stream_size, first_block_size, first_hash);
+        },
+        options);
+  }
+
+  ~ChainVerifier() { xe::threading::JobSystem::Shared().Wait(counter_); }
+
+  /// Index of the first bad block, or -1 once the whole chain checks out
+  int64_t Finish() {
+    xe::threading::JobSystem::Shared().Wait(counter_);
+    return bad_block_;
+  }
+
+ private:
+  void Walk(const uint8_t* stream, size_t stream_size, uint32_t block_size,
+            const uint8_t* expected) {
+    size_t offset = 0;
+    for (int64_t index = 0; block_size; ++index) {
+      if (block_size < kChainHeaderSize || block_size > stream_size - offset ||
+          !ChainBlockMatches(stream + offset, block_size, expected)) {
+        bad_block_ = index;
+        return;
+      }
+      const uint8_t* block = stream + offset;
+      expected = block + 4;
+      offset += block_size;
+      block_size = LoadBE32(block);
+    }
+  }
+
+  xe::threading::JobCounter counter_;
+  int64_t bad_block_ = -1;
+};
+
+/// Serves an encrypted LZX block chain to the decoder one block at a time.
+/// Each block is decrypted into a small ring slot just before the decoder
+/// reads it, so the plaintext is consumed (and, when verifying, hashed)
+/// while still in cache. With a spare core, a worker decrypts block k + 1
+/// (whose size is in block k's header) while block k is being
+/// decompressed, as a job on the shared pool. The LZX stream itself is
+/// sequential, so this is the only parallelism the chain allows.
+class ChainDecryptor {
+ public:
+  /// first_hash: SHA-1 of the first block, or nullptr to skip verification
+  ChainDecryptor(const Aes128& aes, const uint8_t* stream, size_t stream_size,
+                 const uint8_t* first_hash)
+      : aes_(aes), stream_(stream), stream_size_(stream_size),
+        verify_(first_hash != nullptr) {
+    if (verify_) memcpy(next_hash_, first_hash, sizeof(next_hash_));
+    read_ahead_ = OnlineCoreCount() > 1;
+  }
+
+  ~ChainDecryptor() { xe::threading::JobSystem::Shared().Wait(counter_); }
+
+  /// Index of the first block that failed its hash, -1 if none did
+  int64_t bad_block() const { return bad_block_; }
+
+  const uint8_t* Read(size_t offset, size_t size) {
+    Slot* slot = nullptr;
+    if (ahead_) {
+      xe::threading::JobSystem::Shared().Wait(counter_);
+      if (ahead_->offset == offset && ahead_->size == size) slot = ahead_;
+      ahead_ = nullptr;
+    }
+    if (!slot) {
+      slot = &slots_[next_slot_];
+      memcpy(slot->expected, next_hash_, sizeof(next_hash_));
+      Decrypt(slot, offset, size);
+    }
+    next_slot_ = slot == &slots_[0] ? 1 : 0;
+    if (!slot->hash_ok && bad_block_ < 0) bad_block_ = block_index_;
+    block_index_++;
+
+    // Queue the next block into the other slot
+    uint32_t next_size = LoadBE32(slot->data.data());
+    memcpy(next_hash_, slot->data.data() + 4, sizeof(next_hash_));
+    size_t next_offset = offset + size;
+    if (read_ahead_ && next_size >= kChainHeaderSize &&
+        next_size <= stream_size_ - next_offset) {
+      // The reader does not touch the slot again until counter_ is done
+      ahead_ = &slots_[next_slot_];
+      memcpy(ahead_->expected, next_hash_, sizeof(next_hash_));
+      xe::threading::JobOptions options;
+      options.name = "xex_decrypt_block";
+      options.priority = xe::threading::JobPriority::kCritical;
+      options.counter = &counter_;
+      xe::threading::JobSystem::Shared().Submit(
+          [this, slot = ahead_, next_offset, next_size]() {
+            Decrypt(slot, next_offset, next_size);
+          },
+          options);
+    }
+    return slot->data.data();
+  }
+
+ private:
+  struct Slot {
+    std::vector<uint8_t> data;
+    size_t offset = 0;
+    size_t size = 0;
+    uint8_t expected[Sha1::kDigestSize] = {};
+    bool hash_ok = true;
+  };
+
+  /// Fills a slot the reader does not own; touches nothing else
+  void Decrypt(Slot* slot, size_t offset, size_t size) {
+    if (slot->data.size() < size) slot->data.resize(size);
+    aes_.DecryptCbcRange(stream_, stream_size_, offset, size,
+                         slot->data.data(), kZeroIv);
+    slot->hash_ok =
+        !verify_ || ChainBlockMatches(slot->data.data(), size, slot->expected);
+    slot->offset = offset;
+    slot->size = size;
+  }
+
+  const Aes128& aes_;
+  const uint8_t* stream_;
+  size_t stream_size_;
+  bool verify_;
+  uint8_t next_hash_[Sha1::kDigestSize] = {};
+  int64_t block_index_ = 0;
+  int64_t bad_block_ = -1;
+  Slot slots_[2];
+  uint32_t next_slot_ = 0;
+  bool read_ahead_ = false;
+  Slot* ahead_ = nullptr;  // being decrypted by a job against counter_
+  xe::threading::JobCounter counter_;
+};
+
+}  // namespace
+
+Xex2Loader::Xex2Loader() = default;
+Xex2Loader::~Xex2Loader() = default;
+
 bool Xex2Loader::Load(const std::string& path) {
-  std::ifstream file(path, std::ios::binary | std::ios::ate);
-  if (!file.is_open()) {
+  file_ = MappedFile::Open(path);
+  if (!file_) {
     XELOGE("XEX2: Failed to open: {}", path);
     return false;
   }
-  
-  size_t size = static_cast<size_t>(file.tellg());
-  file.seekg(0);
-  
-  raw_data_.resize(size);
-  file.read(reinterpret_cast<char*>(raw_data_.data()), size);
-  file.close();
+  // Headers, then one front-to-back pass over the image data
+  file_->Advise(0, file_->size(), MappedFile::AccessHint::kSequential);
   
   module_.path = path;
   auto pos = path.find_last_of("/\\");
   module_.name = (pos != std::string::npos) ? path.substr(pos + 1) : path;
   
-  XELOGI("XEX2: Loading {} ({} bytes)", module_.name, size);
+  source_identity_ = VerifiedCache::FileIdentity(path);
+  
+  XELOGI("XEX2: Loading {} ({} bytes)", module_.name, file_->size());
+  return LoadFromMemory(file_->data(), static_cast<size_t>(file_->size()));
+}
+
+bool Xex2Loader::LoadFromBuffer(std::vector<uint8_t> buffer) {
+  raw_data_ = std::move(buffer);
   return LoadFromMemory(raw_data_.data(), raw_data_.size());
 }
 
@@ -50,10 +295,15 @@ bool Xex2Loader::LoadFromMemory(const uint8_t* data, size_t size) {
   if (!ParseOptionalHeaders(data, size)) return false;
   if (!ParseSecurityInfo(data, size)) return false;
   if (!ParseImportLibraries(data, size)) return false;
-  if (!DecompressImage(data, size)) return false;
-  if (!ParsePEHeaders()) return false;
+  if (module_.header.pe_data_offset >= size) {
+    XELOGE("XEX2: PE data offset 0x{:X} beyond end of file",
+           module_.header.pe_data_offset);
+    return false;
+  }
+  source_ = data;
+  source_size_ = size;
   
-  XELOGI("XEX2: Loaded OK — entry=0x{:08X}, base=0x{:08X}, size=0x{:X}, title=0x{:08X}",
+  XELOGI("XEX2: Parsed headers — entry=0x{:08X}, base=0x{:08X}, size=0x{:X}, title=0x{:08X}",
          module_.entry_point, module_.base_address, module_.image_size, module_.title_id);
   
   return true;
@@ -199,6 +449,11 @@ bool Xex2Loader::ParseSecurityInfo(const uint8_t* data, size_t size) {
     module_.image_size = BE32(*reinterpret_cast<const uint32_t*>(data + sec_off + 4));
     XELOGD("XEX2: Image size = 0x{:X}", module_.image_size);
   }
+
+  // File key (encrypted with the retail or devkit key)
+  if (sec_off + 0x150 + sizeof(module_.file_key) <= size) {
+    memcpy(module_.file_key, data + sec_off + 0x150, sizeof(module_.file_key));
+  }
   
   return true;
 }
@@ -278,128 +533,164 @@ bool Xex2Loader::ParseImportLibraries(const uint8_t* data, size_t size) {
   return true;
 }
 
-bool Xex2Loader::DecompressImage(const uint8_t* data, size_t size) {
-  uint32_t pe_offset = module_.header.pe_data_offset;
+uint32_t Xex2Loader::FormatInfoOffset() const {
+  for (auto& hdr : module_.opt_headers) {
+    if (hdr.key == kHeaderBaseFileFormat) return hdr.value;
+  }
+  return 0;
+}
+
+size_t Xex2Loader::ImageSizeFromSource() const {
+  if (module_.image_size) return module_.image_size;
+  if (!source_) return 0;
+  const uint8_t* data = source_;
+  const size_t size = source_size_;
+  const size_t pe_size = size - module_.header.pe_data_offset;
+  if (module_.format_info.compression_type != XexCompressionType::kRaw) {
+    return pe_size;
+  }
+  uint32_t fmt_offset = FormatInfoOffset();
+  if (!fmt_offset || fmt_offset + sizeof(Xex2FileFormatInfo) > size) {
+    return pe_size;
+  }
+  uint32_t info_size = BE32(*reinterpret_cast<const uint32_t*>(data + fmt_offset));
+  if (info_size < sizeof(Xex2FileFormatInfo) || fmt_offset + info_size > size) {
+    return pe_size;
+  }
+  uint32_t block_count =
+      (info_size - sizeof(Xex2FileFormatInfo)) / sizeof(Xex2RawDataDescriptor);
+  const uint8_t* block_ptr = data + fmt_offset + sizeof(Xex2FileFormatInfo);
+  size_t total_size = 0;
+  for (uint32_t i = 0; i < block_count; ++i, block_ptr += 8) {
+    total_size += BE32(*reinterpret_cast<const uint32_t*>(block_ptr));
+    total_size += BE32(*reinterpret_cast<const uint32_t*>(block_ptr + 4));
+  }
+  return total_size ? total_size : pe_size;
+}
+
+bool Xex2Loader::DecompressImage(uint8_t* dest, size_t dest_size) {
+  if (!source_) {
+    XELOGE("XEX2: Image source already released");
+    return false;
+  }
+  const uint32_t pe_offset = module_.header.pe_data_offset;
   
   auto comp = module_.format_info.compression_type;
   auto enc = module_.format_info.encryption_type;
   
-  if (enc != XexEncryptionType::kNone) {
-    XELOGW("XEX2: Encrypted XEX — attempting unencrypted fallback");
-    // For development: try loading as-is (works for devkit XEX)
+  std::unique_ptr<Aes128> aes;
+  if (enc == XexEncryptionType::kNormal) {
+    uint8_t session_key[Aes128::kKeySize];
+    if (!DeriveSessionKey(session_key)) {
+      XELOGE("XEX2: No known key decrypts this image");
+      return false;
+    }
+    aes = std::make_unique<Aes128>(session_key);
+  } else if (enc != XexEncryptionType::kNone) {
+    XELOGE("XEX2: Unknown encryption type: {}", static_cast<int>(enc));
+    return false;
   }
   
   switch (comp) {
-    case XexCompressionType::kNone:
-      // Uncompressed — just copy
-      if (pe_offset < size) {
-        size_t pe_size = size - pe_offset;
-        if (module_.image_size > 0) {
-          pe_size = std::min(pe_size, static_cast<size_t>(module_.image_size));
-        }
-        module_.pe_image.resize(pe_size);
-        memcpy(module_.pe_image.data(), data + pe_offset, pe_size);
-        XELOGD("XEX2: Uncompressed PE image: {} bytes", pe_size);
-      }
-      break;
+    case XexCompressionType::kNone: {
+      size_t pe_size = std::min(source_size_ - pe_offset, dest_size);
+      CopyImageSpans(source_ + pe_offset, source_size_ - pe_offset,
+                     {{0, dest, pe_size}}, aes.get());
+      XELOGD("XEX2: Uncompressed PE image: {} bytes", pe_size);
+      return true;
+    }
       
     case XexCompressionType::kRaw:
-      return DecompressRaw(data, size, pe_offset);
+      return DecompressRaw(dest, dest_size, aes.get());
       
-    case XexCompressionType::kCompressed: {
-      XELOGI("XEX2: LZX compressed — attempting decompression");
-      // Parse compression info from the format header
-      uint32_t fmt_offset = 0;
-      for (auto& hdr : module_.opt_headers) {
-        if (hdr.key == kHeaderBaseFileFormat) {
-          fmt_offset = hdr.value;
-          break;
-        }
-      }
-
-      uint32_t window_bits = 17;  // Default Xbox 360 LZX window
-      uint32_t first_block_size = 0;
-
-      if (fmt_offset && fmt_offset + sizeof(Xex2FileFormatInfo) + 24 <= size) {
-        // After the format info comes the first Xex2CompressedBlockInfo
-        const uint8_t* block_info = data + fmt_offset + sizeof(Xex2FileFormatInfo);
-        first_block_size = BE32(*reinterpret_cast<const uint32_t*>(block_info));
-        // Window size is encoded in the block info area
-        // Use 128KB (window_bits=17) as standard for Xbox 360
-        XELOGD("XEX2: LZX first_block_size={}, window_bits={}", first_block_size, window_bits);
-      }
-
-      if (pe_offset < size) {
-        size_t compressed_size = size - pe_offset;
-        size_t uncompressed_size = module_.image_size > 0 ? module_.image_size : compressed_size * 2;
-
-        bool lzx_ok = xe::kernel::LzxDecompressXex(
-            data + pe_offset, compressed_size,
-            uncompressed_size, window_bits,
-            first_block_size, module_.pe_image);
-
-        if (!lzx_ok) {
-          XELOGW("XEX2: LZX decompression failed — falling back to raw copy");
-          module_.pe_image.resize(module_.image_size > 0 ? module_.image_size : compressed_size);
-          memcpy(module_.pe_image.data(), data + pe_offset,
-                 std::min(compressed_size, module_.pe_image.size()));
-        } else {
-          XELOGI("XEX2: LZX decompressed {} -> {} bytes", compressed_size, module_.pe_image.size());
-        }
-      }
-      break;
-    }
+    case XexCompressionType::kCompressed:
+      return DecompressLzx(dest, dest_size, aes.get());
       
     default:
       XELOGE("XEX2: Unknown compression type: {}", static_cast<int>(comp));
       return false;
   }
-  
-  return !module_.pe_image.empty();
 }
 
-bool Xex2Loader::DecompressRaw(const uint8_t* data, size_t size, uint32_t pe_offset) {
-  // Raw = series of (data_size, zero_size) blocks
-  // We need the format info to find the block descriptors
-  uint32_t fmt_offset = 0;
-  for (auto& hdr : module_.opt_headers) {
-    if (hdr.key == kHeaderBaseFileFormat) {
-      fmt_offset = hdr.value;
-      break;
+bool Xex2Loader::DeriveSessionKey(uint8_t session_key[16]) const {
+  static constexpr struct {
+    const uint8_t* key;
+    const char* name;
+  } kMasterKeys[] = {{kRetailKey, "retail"}, {kDevkitKey, "devkit"}};
+  for (auto& master : kMasterKeys) {
+    Aes128(master.key).DecryptBlock(module_.file_key, session_key);
+    if (ProbeSessionKey(session_key)) {
+      XELOGD("XEX2: Image encrypted with the {} key ({})", master.name,
+             Aes128::backend_name());
+      return true;
     }
   }
+  return false;
+}
+
+bool Xex2Loader::ProbeSessionKey(const uint8_t session_key[16]) const {
+  const uint8_t* stream = source_ + module_.header.pe_data_offset;
+  const size_t stream_size = source_size_ - module_.header.pe_data_offset;
+  Aes128 aes(session_key);
+  uint8_t head[32];
+  if (module_.format_info.compression_type != XexCompressionType::kCompressed) {
+    // Raw and uncompressed images start with the PE "MZ" header
+    if (stream_size < 16) return false;
+    aes.DecryptCbcRange(stream, stream_size, 0, 16, head, kZeroIv);
+    return head[0] == 'M' && head[1] == 'Z';
+  }
+
+  // LZX: the first block's next-block size and first chunk size must fit
+  // the chain, and the stream must open with a valid LZX block type
+  uint32_t fmt_offset = FormatInfoOffset();
+  if (!fmt_offset || fmt_offset + sizeof(Xex2FileFormatInfo) + 8 > source_size_ ||
+      stream_size < sizeof(head)) {
+    return false;
+  }
+  uint32_t first_block_size =
+      LoadBE32(source_ + fmt_offset + sizeof(Xex2FileFormatInfo) + 4);
+  if (first_block_size < 26 || first_block_size > stream_size) return false;
+  aes.DecryptCbcRange(stream, stream_size, 0, sizeof(head), head, kZeroIv);
+  uint32_t next_size = LoadBE32(head);
+  uint32_t chunk = (uint32_t(head[24]) << 8) | head[25];
+  uint32_t block_type = (head[27] >> 4) & 7;  // after the intel-header bit
+  if (next_size && (next_size < 24 || next_size > stream_size - first_block_size)) {
+    return false;
+  }
+  return chunk && chunk <= first_block_size - 26 && block_type >= 1 &&
+         block_type <= 3;
+}
+
+bool Xex2Loader::DecompressRaw(uint8_t* dest, size_t dest_size,
+                               const Aes128* aes) {
+  // Raw = series of (data_size, zero_size) blocks
+  const uint8_t* data = source_;
+  const size_t size = source_size_;
+  const uint32_t pe_offset = module_.header.pe_data_offset;
+  const uint8_t* stream = data + pe_offset;
+  const size_t stream_size = size - pe_offset;
+  uint32_t fmt_offset = FormatInfoOffset();
   
   if (!fmt_offset || fmt_offset + sizeof(Xex2FileFormatInfo) > size) {
     // Fallback: just copy everything
-    if (pe_offset < size) {
-      module_.pe_image.resize(size - pe_offset);
-      memcpy(module_.pe_image.data(), data + pe_offset, size - pe_offset);
-    }
-    return !module_.pe_image.empty();
+    CopyImageSpans(stream, stream_size, {{0, dest, std::min(stream_size, dest_size)}},
+                   aes);
+    return true;
   }
   
   uint32_t info_size = BE32(*reinterpret_cast<const uint32_t*>(data + fmt_offset));
-  uint32_t block_count = (info_size - sizeof(Xex2FileFormatInfo)) / sizeof(Xex2RawDataDescriptor);
+  uint32_t block_count = info_size > sizeof(Xex2FileFormatInfo)
+      ? (info_size - sizeof(Xex2FileFormatInfo)) / sizeof(Xex2RawDataDescriptor)
+      : 0;
   
+  // Zero runs are filled here; data runs are gathered and copied (or
+  // decrypted: ciphertext is the data runs back to back) in one pass
   const uint8_t* block_ptr = data + fmt_offset + sizeof(Xex2FileFormatInfo);
-  
-  // Calculate total output size
-  size_t total_size = 0;
-  for (uint32_t i = 0; i < block_count; ++i) {
-    if (block_ptr + 8 > data + size) break;
-    uint32_t data_sz = BE32(*reinterpret_cast<const uint32_t*>(block_ptr));
-    uint32_t zero_sz = BE32(*reinterpret_cast<const uint32_t*>(block_ptr + 4));
-    total_size += data_sz + zero_sz;
-    block_ptr += 8;
-  }
-  
-  if (total_size == 0) total_size = module_.image_size;
-  module_.pe_image.resize(total_size, 0);
-  
-  // Decompress blocks
-  block_ptr = data + fmt_offset + sizeof(Xex2FileFormatInfo);
-  const uint8_t* src = data + pe_offset;
-  uint8_t* dst = module_.pe_image.data();
+  size_t src = 0;
+  uint8_t* dst = dest;
+  uint8_t* dst_end = dest + dest_size;
+  std::vector<ImageSpan> spans;
+  spans.reserve(block_count);
   
   for (uint32_t i = 0; i < block_count; ++i) {
     if (block_ptr + 8 > data + size) break;
@@ -407,61 +698,114 @@ bool Xex2Loader::DecompressRaw(const uint8_t* data, size_t size, uint32_t pe_off
     uint32_t zero_sz = BE32(*reinterpret_cast<const uint32_t*>(block_ptr + 4));
     block_ptr += 8;
     
-    // Copy data block
-    size_t copy_sz = std::min(static_cast<size_t>(data_sz),
-                              static_cast<size_t>(data + size - src));
-    copy_sz = std::min(copy_sz, static_cast<size_t>(module_.pe_image.data() +
-                       module_.pe_image.size() - dst));
-    if (copy_sz > 0) {
-      memcpy(dst, src, copy_sz);
-      src += copy_sz;
-      dst += copy_sz;
-    }
+    size_t copy_sz = std::min({static_cast<size_t>(data_sz),
+                               stream_size - src,
+                               static_cast<size_t>(dst_end - dst)});
+    if (copy_sz) spans.push_back({src, dst, copy_sz});
+    src += copy_sz;
+    dst += copy_sz;
     
     // Zero-fill
     size_t zero_fill = std::min(static_cast<size_t>(zero_sz),
-                                static_cast<size_t>(module_.pe_image.data() +
-                                module_.pe_image.size() - dst));
-    if (zero_fill > 0) {
-      memset(dst, 0, zero_fill);
-      dst += zero_fill;
-    }
+                                static_cast<size_t>(dst_end - dst));
+    memset(dst, 0, zero_fill);
+    dst += zero_fill;
   }
+  CopyImageSpans(stream, stream_size, spans, aes);
   
-  XELOGD("XEX2: Raw decompressed: {} bytes ({} blocks)", module_.pe_image.size(), block_count);
+  XELOGD("XEX2: Raw image: {} bytes ({} blocks)", dst - dest, block_count);
+  return true;
+}
+
+bool Xex2Loader::DecompressLzx(uint8_t* dest, size_t dest_size,
+                               const Aes128* aes) {
+  const uint8_t* data = source_;
+  const size_t size = source_size_;
+  const uint32_t pe_offset = module_.header.pe_data_offset;
+  
+  // Format info is followed by the window size and the first block's
+  // Xex2CompressedBlockInfo
+  uint32_t fmt_offset = FormatInfoOffset();
+  if (!fmt_offset || fmt_offset + sizeof(Xex2FileFormatInfo) + 4 +
+                         sizeof(Xex2CompressedBlockInfo) > size) {
+    XELOGE("XEX2: LZX image without compression info");
+    return false;
+  }
+  const uint8_t* info = data + fmt_offset + sizeof(Xex2FileFormatInfo);
+  uint32_t window_size = BE32(*reinterpret_cast<const uint32_t*>(info));
+  uint32_t first_block_size = BE32(*reinterpret_cast<const uint32_t*>(info + 4));
+  XELOGD("XEX2: LZX window=0x{:X}, first_block_size={}", window_size,
+         first_block_size);
+  
+  // The first block's hash anchors the chain: each block carries the hash
+  // of the next
+  const uint8_t* first_hash = info + 8;
+  auto cache_key = VerifiedCache::MakeKey(source_identity_, "xex", first_hash,
+                                          Sha1::kDigestSize);
+  bool verify = cvars.GetValue<bool>("xex_verify_hashes", true);
+  if (verify && VerifiedCache::Get().Contains(cache_key)) {
+    XELOGD("XEX2: Block hashes already verified for this file");
+    verify = false;
+  }
+
+  bool ok;
+  int64_t bad_block = -1;
+  if (aes) {
+    ChainDecryptor decryptor(*aes, data + pe_offset, size - pe_offset,
+                             verify ? first_hash : nullptr);
+    ok = xe::kernel::LzxDecompressXex(
+        [&decryptor](size_t offset, size_t block_size) {
+          return decryptor.Read(offset, block_size);
+        },
+        size - pe_offset, first_block_size, window_size, dest, dest_size);
+    bad_block = decryptor.bad_block();
+  } else {
+    std::unique_ptr<ChainVerifier> verifier;
+    if (verify) {
+      verifier = std::make_unique<ChainVerifier>(
+          data + pe_offset, size - pe_offset, first_block_size, first_hash);
+    }
+    ok = xe::kernel::LzxDecompressXex(data + pe_offset, size - pe_offset,
+                                      first_block_size, window_size, dest,
+                                      dest_size);
+    if (verifier) bad_block = verifier->Finish();
+  }
+  if (bad_block >= 0) {
+    XELOGE("XEX2: LZX block {} fails its SHA-1 check — the image is corrupt",
+           bad_block);
+    return false;
+  }
+  if (ok && verify) VerifiedCache::Get().Insert(cache_key);
+  if (!ok) {
+    XELOGE("XEX2: LZX decompression failed");
+    return false;
+  }
+  XELOGI("XEX2: LZX decompressed {} -> {} bytes", size - pe_offset, dest_size);
   return true;
 }
 
-bool Xex2Loader::ParsePEHeaders() {
-  if (module_.pe_image.size() < 0x200) {
+bool Xex2Loader::ParsePEHeaders(const uint8_t* pe, size_t size) {
+  if (size < 0x200) {
     XELOGW("XEX2: PE image too small");
     return true;  // Non-fatal
   }
   
-  const uint8_t* pe = module_.pe_image.data();
-  
   // Check for MZ header (some XEX files have stripped PE headers)
   if (pe[0] == 'M' && pe[1] == 'Z') {
     uint32_t pe_offset = *reinterpret_cast<const uint32_t*>(pe + 0x3C);
-    if (pe_offset + 4 <= module_.pe_image.size()) {
+    if (pe_offset + 4 <= size) {
       if (pe[pe_offset] == 'P' && pe[pe_offset + 1] == 'E') {
         XELOGD("XEX2: Found PE header at offset 0x{:X}", pe_offset);
         
         // Parse PE optional header
         uint32_t opt_hdr_off = pe_offset + 0x18;
-        if (opt_hdr_off + 0x60 <= module_.pe_image.size()) {
-          // PE32+ header
+        if (opt_hdr_off + 0x60 <= size) {
           uint32_t pe_entry = *reinterpret_cast<const uint32_t*>(pe + opt_hdr_off + 0x10);
-          uint32_t pe_base = *reinterpret_cast<const uint32_t*>(pe + opt_hdr_off + 0x1C);
-          uint32_t pe_image_size = *reinterpret_cast<const uint32_t*>(pe + opt_hdr_off + 0x38);
           
           // These are little-endian in PE (already native on ARM64)
           if (module_.entry_point == 0) {
             module_.entry_point = module_.base_address + pe_entry;
           }
-          if (module_.image_size == 0) {
-            module_.image_size = pe_image_size;
-          }
         }
         
         // Parse section table
@@ -471,7 +815,7 @@ bool Xex2Loader::ParsePEHeaders() {
         
         for (uint16_t i = 0; i < section_count; ++i) {
           uint32_t sec_off = section_table + i * 40;
-          if (sec_off + 40 > module_.pe_image.size()) break;
+          if (sec_off + 40 > size) break;
           
           XexSection sec;
           char name[9] = {};
@@ -495,38 +839,79 @@ bool Xex2Loader::ParsePEHeaders() {
 }
 
 bool Xex2Loader::MapIntoMemory(uint8_t* guest_base) {
-  if (module_.pe_image.empty()) {
-    XELOGE("XEX2: No PE image to map");
+  if (!source_) {
+    XELOGE("XEX2: No image to map");
     return false;
   }
   
   uint32_t base = module_.base_address;
-  size_t total_size = module_.image_size > 0 ? module_.image_size : module_.pe_image.size();
+  module_.image_size = static_cast<uint32_t>(ImageSizeFromSource());
+  size_t image_size = module_.image_size;
   
   // Align up to page size
-  total_size = (total_size + 0xFFF) & ~0xFFFULL;
+  size_t total_size = (image_size + 0xFFF) & ~0xFFFULL;
   
   // Commit memory for the module
-  if (!xe::memory::Commit(guest_base + base, total_size,
+  uint8_t* dest = guest_base + base;
+  if (!xe::memory::Commit(dest, total_size,
                           xe::memory::PageAccess::kExecuteReadWrite)) {
     XELOGE("XEX2: Failed to commit memory at 0x{:08X}, size=0x{:X}", base, total_size);
     return false;
   }
   
-  // Copy PE image
-  size_t copy_size = std::min(module_.pe_image.size(), total_size);
-  memcpy(guest_base + base, module_.pe_image.data(), copy_size);
+  // Decompress / copy straight into the committed range
+  bool ok = DecompressImage(dest, image_size);
+  if (ok) ok = ParsePEHeaders(dest, image_size);
+  ReleaseSource();
+  if (!ok) return false;
   
-  XELOGI("XEX2: Mapped {} at 0x{:08X}-0x{:08X}",
-         module_.name, base, base + static_cast<uint32_t>(total_size));
+  XELOGI("XEX2: Mapped {} at 0x{:08X}-0x{:08X} (entry=0x{:08X})",
+         module_.name, base, base + static_cast<uint32_t>(total_size),
+         module_.entry_point);
   
   return true;
 }
 
+void Xex2Loader::ReleaseSource() {
+  source_ = nullptr;
+  source_size_ = 0;
+  file_.reset();
+  std::vector<uint8_t>().swap(raw_data_);
+}
+
 bool Xex2Loader::ResolveImports(uint8_t* guest_base) {
   return ResolveImports(guest_base, nullptr);
 }
 
+void Xex2Loader::BuildFunctionMap(xe::cpu::GuestFunctionMap* map) const {
+  constexpr uint32_t kScnCntCode = 0x00000020;
+  constexpr uint32_t kScnMemExecute = 0x20000000;
+  uint8_t* guest_base = xe::memory::GetGuestBase();
+  if (!guest_base) return;
+  const uint32_t base = module_.base_address;
+  const uint32_t image_end = base + module_.image_size;
+
+  size_t pdata = 0;
+  size_t calls = 0;
+  bool scanned = false;
+  for (const auto& sec : module_.sections) {
+    uint32_t start = base + sec.virtual_address;
+    uint32_t size =
+        std::min(sec.virtual_size, image_end - std::min(start, image_end));
+    if (sec.name == ".pdata") {
+      pdata += map->AddPdata(guest_base + start, size);
+    } else if (sec.flags & (kScnCntCode | kScnMemExecute)) {
+      calls += map->AddCallTargets(start, start + size);
+      scanned = true;
+    }
+  }
+  if (!scanned) calls += map->AddCallTargets(base, image_end);
+  if (module_.entry_point) map->Add(module_.entry_point);
+  map->Finalize();
+  XELOGI("XEX2: {} functions ({} from .pdata, {} call sites)",
+         map->functions().size(), pdata, calls);
+}
+
 bool Xex2Loader::ResolveImports(uint8_t* guest_base,
                                 xe::cpu::Processor* processor) {
   uint32_t resolved = 0;
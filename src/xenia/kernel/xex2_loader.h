@@ -9,8 +9,8 @@
  *   - Security Info (AES keys, RSA signature, page descriptors)
  *   - Compressed/encrypted PE image
  *
- * For unencrypted/dev-signed XEX files, we can load directly.
- * For retail XEX files, decryption keys are needed.
+ * Encrypted images are AES-128-CBC over the PE data stream, keyed with the
+ * file key from the security info decrypted by the retail or devkit key.
  */
 #pragma once
 
@@ -20,12 +20,18 @@
 #include <unordered_map>
 #include <memory>
 
+namespace xe {
+class Aes128;
+class MappedFile;
+}
+
 namespace xe::kernel {
 class KernelState;
 class XModule;
 }
 
 namespace xe::cpu {
+class GuestFunctionMap;
 class Processor;
 }
 
@@ -225,6 +231,7 @@ struct XexModule {
   uint32_t title_id = 0;
   uint32_t system_flags = 0;
   uint32_t module_flags = 0;
+  uint8_t file_key[16] = {};  // Security info AES key (still encrypted)
   
   Xex2FileFormatInfo format_info = {};
   Xex2ExecutionInfo exec_info = {};
@@ -233,31 +240,54 @@ struct XexModule {
   std::vector<XexImportLibrary> import_libs;
   std::vector<XexSection> sections;
   
-  // Decompressed PE image
-  std::vector<uint8_t> pe_image;
-  
   std::string name;
   std::string path;
 };
 
+/// Loading is two-phase: Load*/LoadFromMemory parse the headers only, and
+/// MapIntoMemory decompresses the image straight into guest memory. The
+/// PE image never exists as a separate host copy.
 class Xex2Loader {
  public:
-  Xex2Loader() = default;
+  Xex2Loader();
+  ~Xex2Loader();
   
-  /// Load a XEX2 file from disk
+  /// Map a XEX2 file from disk and parse its headers
   bool Load(const std::string& path);
   
-  /// Load from memory buffer
+  /// Parse headers from a borrowed buffer; data must stay valid until
+  /// MapIntoMemory returns
   bool LoadFromMemory(const uint8_t* data, size_t size);
+
+  /// Parse headers from a buffer the loader takes ownership of
+  bool LoadFromBuffer(std::vector<uint8_t> buffer);
   
-  /// Map the loaded module into guest memory
+  /// Commit the image range at base_address, decompress into it, parse the
+  /// PE headers from guest memory, then release the file / buffer
   bool MapIntoMemory(uint8_t* guest_base);
+
+  /// Decompress the image into any host buffer (tools, benchmarks).
+  /// MapIntoMemory does this on the guest range; the source stays loaded.
+  bool DecompressImage(uint8_t* dest, size_t dest_size);
+  /// Image size from the security info, or as implied by the file
+  size_t ImageSizeFromSource() const;
   
   /// Resolve imports against kernel exports
   bool ResolveImports(uint8_t* guest_base);
 
   /// Resolve imports and register thunks with the CPU processor
   bool ResolveImports(uint8_t* guest_base, xe::cpu::Processor* processor);
+
+  /// Function boundaries of the mapped image: its .pdata, plus bl targets
+  /// in code sections (the whole image when the PE headers are stripped)
+  void BuildFunctionMap(xe::cpu::GuestFunctionMap* map) const;
+  
+  /// Identifies the file the XEX came from (see VerifiedCache), so hash
+  /// checks it passed are skipped next time. Load() sets it; in-memory
+  /// loads have none unless the caller provides one.
+  void set_source_identity(std::string identity) {
+    source_identity_ = std::move(identity);
+  }
   
   /// Get the parsed module info
   const XexModule& module() const { return module_; }
@@ -267,17 +297,29 @@ class Xex2Loader {
   bool ParseHeader(const uint8_t* data, size_t size);
   bool ParseOptionalHeaders(const uint8_t* data, size_t size);
   bool ParseSecurityInfo(const uint8_t* data, size_t size);
-  bool DecompressImage(const uint8_t* data, size_t size);
-  bool DecompressRaw(const uint8_t* data, size_t size, uint32_t pe_offset);
-  bool ParsePEHeaders();
   bool ParseImportLibraries(const uint8_t* data, size_t size);
+  /// Offset of the base file format header, 0 if absent
+  uint32_t FormatInfoOffset() const;
+  /// Decrypt file_key with each known master key; keep the one whose
+  /// plaintext looks like the start of this image
+  bool DeriveSessionKey(uint8_t session_key[16]) const;
+  bool ProbeSessionKey(const uint8_t session_key[16]) const;
+  bool DecompressRaw(uint8_t* dest, size_t dest_size, const Aes128* aes);
+  bool DecompressLzx(uint8_t* dest, size_t dest_size, const Aes128* aes);
+  bool ParsePEHeaders(const uint8_t* pe, size_t size);
+  /// Drop the mapping / buffer once the image is in guest memory
+  void ReleaseSource();
   
   /// Byte-swap a 32-bit big-endian value
   static uint32_t BE32(uint32_t v) { return __builtin_bswap32(v); }
   static uint16_t BE16(uint16_t v) { return __builtin_bswap16(v); }
   
   XexModule module_;
+  std::unique_ptr<MappedFile> file_;
   std::vector<uint8_t> raw_data_;
+  const uint8_t* source_ = nullptr;
+  size_t source_size_ = 0;
+  std::string source_identity_;
 };
 
 }  // namespace xe::loader
@@ -5,6 +5,7 @@
 #pragma once
 
 #include "xenia/kernel/xobject.h"
+#include "xenia/cpu/guest_function_map.h"
 #include <cstdint>
 #include <string>
 #include <unordered_map>
@@ -41,12 +42,17 @@ class XModule : public XObject {
     return it != imports_.end() ? it->second : 0;
   }
 
+  /// Function boundaries, filled in by the loader once the image is mapped
+  cpu::GuestFunctionMap& function_map() { return function_map_; }
+  const cpu::GuestFunctionMap& function_map() const { return function_map_; }
+
  private:
   std::string path_;
   std::string name_;
   uint32_t base_address_ = 0;
   uint32_t entry_point_ = 0;
   std::unordered_map<uint32_t, uint32_t> imports_;
+  cpu::GuestFunctionMap function_map_;
 };
 
 }  // namespace xe::kernel
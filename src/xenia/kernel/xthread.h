@@ -38,6 +38,10 @@ class XThread : public XObject {
     ++suspend_count_;
     suspended_ = true;
   }
+  void set_suspend_count(uint32_t count) {
+    suspend_count_ = count;
+    suspended_ = count > 0;
+  }
   void Terminate(uint32_t exit_code) { terminated_ = true; exit_code_ = exit_code; }
   bool is_terminated() const { return terminated_; }
   uint32_t exit_code() const { return exit_code_; }
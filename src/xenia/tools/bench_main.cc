@@ -0,0 +1,778 @@
+/**
+ * Vera360 — Xenia Edge
+ * vera360-bench — microbenchmarks for the core hot paths
+ *
+ *   vera360-bench [--filter=TEXT] [--min-time=MS] [--repetitions=N]
+ *                 [--json=FILE|-] [--list]
+ *
+ * Every benchmark runs on synthetic input built from a fixed seed, so two
+ * builds see identical work. Each one is calibrated to run about MS / N
+ * milliseconds per sample (default 500 / 5); the median sample is the
+ * result, the fastest one is shown next to it as a noise check. "ns/op" is
+ * per unit of the benchmark (guest instruction, packet, call, ...), MB/s
+ * counts the bytes one op reads. --json writes the same numbers for
+ * tracking across commits.
+ */
+
+#include "xenia/base/logging.h"
+#include "xenia/base/memory/memory.h"
+#include "xenia/base/timebase.h"
+#include "xenia/cpu/frontend/ppc_assembler.h"
+#include "xenia/cpu/frontend/ppc_decoder.h"
+#include "xenia/cpu/frontend/ppc_interpreter.h"
+#include "xenia/gpu/gpu_command_processor.h"
+#include "xenia/kernel/lzx_decoder.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace xe::kernel::xboxkrnl {
+void RegisterAllExports();
+uint32_t Dispatch(uint32_t ordinal, uint32_t* args);
+}
+
+namespace {
+
+using namespace xe::cpu::frontend::ppc_asm;
+
+// Guest layout: code, then data the kernels walk (and a scratch area past it)
+constexpr uint32_t kCodeAddress = 0x82000000;
+constexpr uint32_t kCodeSize = 0x10000;
+constexpr uint32_t kDataAddress = 0x40000000;
+constexpr uint32_t kDataSize = 0x10000;  // kernels wrap their pointers at this
+constexpr uint32_t kScratchAddress = kDataAddress + kDataSize;
+constexpr uint32_t kGuestDataSize = 0x100000;
+
+uint8_t* Guest(uint32_t address) {
+  return static_cast<uint8_t*>(xe::memory::TranslateVirtual(address));
+}
+
+void StoreBE32(uint32_t address, uint32_t v) {
+  uint8_t* p = Guest(address);
+  p[0] = uint8_t(v >> 24); p[1] = uint8_t(v >> 16);
+  p[2] = uint8_t(v >> 8);  p[3] = uint8_t(v);
+}
+
+struct Benchmark {
+  const char* name;
+  const char* unit;
+  uint64_t bytes_per_op = 0;
+  /// Runs the workload iterations times; the number of ops done, 0 on error
+  std::function<uint64_t(uint64_t iterations)> run;
+};
+
+struct Result {
+  double ns_per_op = 0;      // median sample
+  double ns_per_op_min = 0;  // fastest sample
+  uint64_t ops = 0;          // over all samples
+};
+
+// ── Interpreter ─────────────────────────────────────────────────────────────
+
+/// A loop the interpreter runs forever; prologue runs once from kCodeAddress
+struct GuestKernel {
+  std::vector<uint32_t> prologue;
+  std::vector<uint32_t> body;  // ends by branching back to its first word
+};
+
+/// Dependent integer ALU work: add, logic, rotate, multiply, compare
+GuestKernel IntegerKernel() {
+  GuestKernel k;
+  k.prologue = {li(3, 1), li(4, 2), li(5, 3)};
+  k.body = {
+      add(6, 3, 4),
+      xor_(7, 6, 5),
+      rlwinm(8, 7, 5, 0, 31),
+      mullw(9, 8, 3),
+      subf(10, 4, 9),
+      or_(11, 10, 6),
+      and_(12, 11, 7),
+      addi(3, 3, 1),
+      addi(4, 4, 3),
+      srw(5, 12, 3),
+      cmpw(0, 3, 4),
+  };
+  k.body.push_back(b(-int32_t(k.body.size() * 4)));
+  return k;
+}
+
+/// Walks 64 KB in 64-byte strides: word, half, byte and doubleword loads
+/// and stores through an address register
+GuestKernel LoadStoreKernel() {
+  GuestKernel k;
+  k.prologue = {lis(10, int32_t(kDataAddress >> 16)), li(3, 0)};
+  k.body = {
+      add(9, 10, 3),
+      lwz(4, 0, 9),
+      lwz(5, 4, 9),
+      lhz(6, 8, 9),
+      lbz(7, 10, 9),
+      add(8, 4, 5),
+      stw(8, 12, 9),
+      sth(6, 16, 9),
+      ld(11, 24, 9),
+      std_(11, 32, 9),
+      addi(3, 3, 64),
+      rlwinm(3, 3, 0, 16, 31),  // wrap at 64 KB
+  };
+  k.body.push_back(b(-int32_t(k.body.size() * 4)));
+  return k;
+}
+
+/// Two data-dependent branches per iteration on an LCG's top bits, so host
+/// branch prediction cannot learn the guest's
+GuestKernel BranchyKernel() {
+  GuestKernel k;
+  k.prologue = {li(3, 12345), lis(4, 0x41C6), ori(4, 4, 0x4E6D), li(6, 0),
+                li(7, 0)};
+  k.body = {
+      mullw(3, 3, 4),
+      addi(3, 3, 12345),
+      rlwinm(5, 3, 1, 31, 31),
+      rlwinm(8, 3, 2, 31, 31),
+      cmpwi(0, 5, 0),
+      beq(0, 12),
+      addi(6, 6, 1),
+      b(8),
+      addi(7, 7, 1),
+      cmpwi(1, 8, 0),
+      bne(1, 8),
+      addi(6, 6, 3),
+  };
+  k.body.push_back(b(-int32_t(k.body.size() * 4)));
+  return k;
+}
+
+/// Vector loads, float multiply-add, permute and logic; results go to a
+/// scratch area so the inputs (floats in [1, 2)) never drift into
+/// denormals or infinities
+GuestKernel VmxKernel() {
+  GuestKernel k;
+  k.prologue = {
+      lis(10, int32_t(kDataAddress >> 16)),
+      lis(12, int32_t(kDataSize >> 16)),
+      mr(9, 10),
+      li(8, 0x40),
+      lvx(0, 10, 8),  // scale
+      li(8, 0x50),
+      lvx(6, 10, 8),  // permute control
+  };
+  k.body = {
+      lvx(1, 0, 9),
+      addi(8, 9, 16),
+      lvx(2, 0, 8),
+      vmaddfp(3, 1, 0, 2),
+      vaddfp(4, 3, 1),
+      vperm(5, 4, 3, 6),
+      vxor(7, 5, 2),
+      vand(8, 7, 4),
+      vmaxfp(11, 5, 3),
+      stvx(11, 12, 9),
+      addi(9, 9, 32),
+      rlwinm(9, 9, 0, 16, 31),
+      or_(9, 9, 10),
+  };
+  k.body.push_back(b(-int32_t(k.body.size() * 4)));
+  return k;
+}
+
+/// The interpreter keeps vector registers in memory byte order, so the
+/// floats are stored as the VMX kernel will compute on them
+void FillGuestData(uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<float> value(1.0f, 2.0f);
+  for (uint32_t offset = 0; offset < kDataSize; offset += 4) {
+    float f = value(rng);
+    memcpy(Guest(kDataAddress + offset), &f, 4);
+  }
+  // VMX kernel constants: scale 0.5, a byte permute mixing both inputs
+  uint8_t* permute = Guest(kDataAddress + 0x50);
+  for (uint32_t i = 0; i < 16; ++i) {
+    permute[i] = uint8_t((i * 7) & 0x1F);
+  }
+  for (uint32_t i = 0; i < 4; ++i) {
+    float half = 0.5f;
+    memcpy(Guest(kDataAddress + 0x40 + i * 4), &half, 4);
+  }
+}
+
+Benchmark InterpreterBenchmark(const char* name, GuestKernel kernel) {
+  auto interpreter = std::make_shared<xe::cpu::frontend::PPCInterpreter>();
+  auto thread = std::make_shared<xe::cpu::ThreadState>();
+  interpreter->SetGuestBase(xe::memory::GetGuestBase());
+
+  // Each benchmark gets its own code page so they can coexist
+  static uint32_t next_code = kCodeAddress;
+  uint32_t code = next_code;
+  next_code += 0x1000;
+  uint32_t address = code;
+  for (uint32_t word : kernel.prologue) {
+    StoreBE32(address, word);
+    address += 4;
+  }
+  for (uint32_t word : kernel.body) {
+    StoreBE32(address, word);
+    address += 4;
+  }
+  thread->pc = code;
+  thread->gpr[1] = kScratchAddress + 0x80000;  // stack
+
+  Benchmark bench{name, "insn", 0, nullptr};
+  bench.run = [interpreter, thread](uint64_t iterations) -> uint64_t {
+    uint64_t done = interpreter->Run(thread.get(), iterations);
+    return done == iterations ? done : 0;
+  };
+  return bench;
+}
+
+// ── PPC decoder ─────────────────────────────────────────────────────────────
+
+Benchmark DecodeBenchmark() {
+  // Every kernel's instructions, repeated: a realistic opcode mix
+  auto words = std::make_shared<std::vector<uint32_t>>();
+  for (const GuestKernel& kernel :
+       {IntegerKernel(), LoadStoreKernel(), BranchyKernel(), VmxKernel()}) {
+    words->insert(words->end(), kernel.prologue.begin(), kernel.prologue.end());
+    words->insert(words->end(), kernel.body.begin(), kernel.body.end());
+  }
+  while (words->size() < 4096) {
+    words->insert(words->end(), words->begin(), words->end());
+  }
+  words->resize(4096);
+
+  Benchmark bench{"ppc/decode", "insn", 4, nullptr};
+  bench.run = [words](uint64_t iterations) -> uint64_t {
+    uint32_t sink = 0;
+    for (uint64_t i = 0; i < iterations; ++i) {
+      uint32_t address = kCodeAddress;
+      for (uint32_t word : *words) {
+        auto instr = xe::cpu::frontend::DecodePPC(address, word);
+        sink += instr.opcode + instr.rD;
+        address += 4;
+      }
+    }
+    asm volatile("" : : "r"(sink));
+    return iterations * words->size();
+  };
+  return bench;
+}
+
+// ── LZX ─────────────────────────────────────────────────────────────────────
+
+constexpr uint32_t kLzxWindowBits = 15;
+
+/// LZX bit writer: MSB-first bits packed into little-endian 16-bit words
+class LzxBitWriter {
+ public:
+  void Put(uint32_t value, uint32_t bits) {
+    for (uint32_t i = bits; i-- > 0;) {
+      word_ = uint16_t((word_ << 1) | ((value >> i) & 1));
+      if (++count_ == 16) Flush();
+    }
+  }
+  void Align() {
+    if (count_) Put(0, 16 - count_);
+  }
+  std::vector<uint8_t> Finish() {
+    Align();
+    // Slack for the decoder's wide refills
+    out_.insert(out_.end(), 16, 0);
+    return std::move(out_);
+  }
+
+ private:
+  void Flush() {
+    out_.push_back(uint8_t(word_));
+    out_.push_back(uint8_t(word_ >> 8));
+    word_ = 0;
+    count_ = 0;
+  }
+  std::vector<uint8_t> out_;
+  uint16_t word_ = 0;
+  uint32_t count_ = 0;
+};
+
+/// Code lengths of a complete prefix code where every symbol costs about
+/// the same: the first ones one bit shorter
+std::vector<uint8_t> FlatLengths(uint32_t symbols) {
+  uint32_t bits = 0;
+  while ((1u << bits) < symbols) bits++;
+  uint32_t short_count = (1u << bits) - symbols;
+  std::vector<uint8_t> lengths(symbols, uint8_t(bits));
+  for (uint32_t i = 0; i < short_count; ++i) lengths[i] = uint8_t(bits - 1);
+  return lengths;
+}
+
+std::vector<uint32_t> CanonicalCodes(const std::vector<uint8_t>& lengths) {
+  uint32_t count[17] = {}, next[17] = {};
+  for (uint8_t length : lengths) count[length]++;
+  count[0] = 0;
+  for (uint32_t length = 1, code = 0; length <= 16; ++length) {
+    code = (code + count[length - 1]) << 1;
+    next[length] = code;
+  }
+  std::vector<uint32_t> codes(lengths.size());
+  for (size_t i = 0; i < lengths.size(); ++i) {
+    if (lengths[i]) codes[i] = next[lengths[i]]++;
+  }
+  return codes;
+}
+
+/// Tree lengths as pretree deltas against an all-zero previous tree
+void WriteLzxLengths(LzxBitWriter& out, const std::vector<uint8_t>& lengths) {
+  std::vector<uint8_t> pre_lengths = FlatLengths(20);
+  std::vector<uint32_t> pre_codes = CanonicalCodes(pre_lengths);
+  for (uint8_t length : pre_lengths) out.Put(length, 4);
+  for (uint8_t length : lengths) {
+    uint32_t symbol = (17 - length) % 17;
+    out.Put(pre_codes[symbol], pre_lengths[symbol]);
+  }
+}
+
+/// One verbatim block of random literals and matches (lengths 2-257,
+/// short offsets favoured, a third of them repeats) over output_size bytes
+/// with a 32 KB window. Returns the stream; *expected gets the output.
+std::vector<uint8_t> BuildLzxStream(uint32_t output_size,
+                                    std::vector<uint8_t>* expected) {
+  constexpr uint32_t kPositionSlots = 30;  // for the 32 KB window
+  constexpr uint32_t kFrameSize = 32768;
+  uint32_t extra[kPositionSlots], base[kPositionSlots];
+  for (uint32_t slot = 0, next = 0; slot < kPositionSlots; ++slot) {
+    extra[slot] = slot < 4 ? 0 : (slot - 2) / 2;
+    base[slot] = next;
+    next += 1u << extra[slot];
+  }
+
+  std::vector<uint8_t> main_lengths = FlatLengths(256 + kPositionSlots * 8);
+  std::vector<uint8_t> length_lengths = FlatLengths(249);
+  std::vector<uint32_t> main_codes = CanonicalCodes(main_lengths);
+  std::vector<uint32_t> length_codes = CanonicalCodes(length_lengths);
+
+  LzxBitWriter out;
+  out.Put(0, 1);  // no E8 translation
+  out.Put(1, 3);  // verbatim
+  out.Put(output_size >> 8, 16);
+  out.Put(output_size & 0xFF, 8);
+  WriteLzxLengths(out, {main_lengths.begin(), main_lengths.begin() + 256});
+  WriteLzxLengths(out, {main_lengths.begin() + 256, main_lengths.end()});
+  WriteLzxLengths(out, length_lengths);
+
+  std::mt19937 rng(360);
+  std::vector<uint8_t>& data = *expected;
+  data.assign(output_size, 0);
+  uint32_t repeats[3] = {1, 1, 1};
+  for (uint32_t pos = 0; pos < output_size;) {
+    uint32_t frame_end = std::min(output_size, (pos / kFrameSize + 1) * kFrameSize);
+    while (pos < frame_end) {
+      uint32_t remaining = frame_end - pos;
+      if (pos < 16 || remaining < 2 || rng() % 100 < 40) {
+        uint8_t literal = uint8_t(rng() % 64 + 32);
+        out.Put(main_codes[literal], main_lengths[literal]);
+        data[pos++] = literal;
+        continue;
+      }
+      uint32_t length = rng() % 10 ? 2 + rng() % 14 : 2 + rng() % 256;
+      length = std::min(length, remaining);
+
+      uint32_t slot, offset, verbatim = 0;
+      uint32_t repeat = rng() % 3;
+      if (rng() % 3 == 0 && repeats[repeat] <= pos) {
+        slot = repeat;
+        offset = repeats[repeat];
+        std::swap(repeats[0], repeats[repeat]);
+      } else {
+        uint32_t span = std::min(pos, 2u << (rng() % 14));
+        offset = 1 + rng() % span;
+        uint32_t formatted = offset + 2;
+        slot = kPositionSlots - 1;
+        while (base[slot] > formatted) slot--;
+        verbatim = formatted - base[slot];
+        repeats[2] = repeats[1];
+        repeats[1] = repeats[0];
+        repeats[0] = offset;
+      }
+
+      uint32_t header = std::min(length - 2, 7u);
+      uint32_t symbol = 256 + slot * 8 + header;
+      out.Put(main_codes[symbol], main_lengths[symbol]);
+      if (header == 7) {
+        out.Put(length_codes[length - 9], length_lengths[length - 9]);
+      }
+      if (slot >= 3) out.Put(verbatim, extra[slot]);
+      for (uint32_t i = 0; i < length; ++i, ++pos) {
+        data[pos] = data[pos - offset];
+      }
+    }
+    out.Align();  // frames restart on a word boundary
+  }
+  return out.Finish();
+}
+
+Benchmark LzxBenchmark() {
+  constexpr uint32_t kOutputSize = 256 * 1024;
+  auto expected = std::make_shared<std::vector<uint8_t>>();
+  auto stream = std::make_shared<std::vector<uint8_t>>(
+      BuildLzxStream(kOutputSize, expected.get()));
+  auto output = std::make_shared<std::vector<uint8_t>>(kOutputSize);
+
+  Benchmark bench{"lzx/decompress_256k", "stream", kOutputSize, nullptr};
+  bench.run = [stream, expected, output](uint64_t iterations) -> uint64_t {
+    for (uint64_t i = 0; i < iterations; ++i) {
+      if (!xe::kernel::LzxDecompress(stream->data(), stream->size(),
+                                     output->data(), output->size(),
+                                     kLzxWindowBits)) {
+        return 0;
+      }
+    }
+    return *output == *expected ? iterations : 0;
+  };
+  return bench;
+}
+
+// ── PM4 ─────────────────────────────────────────────────────────────────────
+
+/// A ring of draw-shaped packet sequences: register block, shader
+/// constants, index count, draw, NOP
+Benchmark Pm4Benchmark() {
+  namespace gpu = xe::gpu;
+  auto processor = std::make_shared<gpu::GpuCommandProcessor>();
+  processor->Initialize(nullptr);
+
+  std::vector<uint32_t> ring;
+  uint32_t packets = 0;
+  auto type0 = [&](uint32_t reg, std::initializer_list<uint32_t> values) {
+    ring.push_back((uint32_t(values.size() - 1) << 16) | reg);
+    ring.insert(ring.end(), values);
+    packets++;
+  };
+  auto type3 = [&](uint32_t opcode, const std::vector<uint32_t>& data) {
+    ring.push_back((3u << 30) | (uint32_t(data.size() - 1) << 16) |
+                   (opcode << 8));
+    ring.insert(ring.end(), data.begin(), data.end());
+    packets++;
+  };
+  std::vector<uint32_t> constants(1 + 64);
+  for (uint32_t draw = 0; ring.size() < 16384 - 128; ++draw) {
+    type0(0x2000, {draw, 1, 2, 3, 4, 5, 6, 7});
+    constants[0] = gpu::reg::SQ_VS_CONST + (draw % 8) * 64;
+    for (uint32_t i = 1; i < constants.size(); ++i) constants[i] = draw * i;
+    type3(gpu::PM4Opcode::SET_CONSTANT, constants);
+    type0(gpu::reg::VGT_NUM_INDICES, {3 * (draw % 100 + 1)});
+    type3(gpu::PM4Opcode::DRAW_INDX, {0, 4});
+    type3(gpu::PM4Opcode::NOP, {0});
+  }
+  uint32_t ring_address = kScratchAddress + 0x40000;
+  for (size_t i = 0; i < ring.size(); ++i) {
+    StoreBE32(ring_address + uint32_t(i) * 4, ring[i]);
+  }
+  uint32_t dwords = uint32_t(ring.size());
+
+  Benchmark bench{"gpu/pm4_ring", "packet", dwords * 4 / packets, nullptr};
+  bench.run = [processor, ring_address, dwords,
+               packets](uint64_t iterations) -> uint64_t {
+    for (uint64_t i = 0; i < iterations; ++i) {
+      // One dword more than the packets, so the write pointer is not 0
+      processor->SetRingBuffer(ring_address, dwords + 1);
+      processor->ProcessRingBuffer(0, dwords);
+      processor->ClearDrawCalls();
+    }
+    return iterations * packets;
+  };
+  return bench;
+}
+
+// ── Byte-swapping copies ────────────────────────────────────────────────────
+
+Benchmark SwapBenchmark(const char* name, uint32_t element_size) {
+  constexpr uint32_t kBytes = 64 * 1024;
+  auto src = std::make_shared<std::vector<uint8_t>>(kBytes + 4);
+  auto dst = std::make_shared<std::vector<uint8_t>>(kBytes + 4);
+  std::mt19937 rng(7);
+  for (uint8_t& byte : *src) byte = uint8_t(rng());
+
+  Benchmark bench{name, "64KiB", kBytes, nullptr};
+  bench.run = [src, dst, element_size](uint64_t iterations) -> uint64_t {
+    for (uint64_t i = 0; i < iterations; ++i) {
+      if (element_size == 4) {
+        xe::memory::CopyAndSwap32(dst->data(), src->data(), kBytes / 4);
+      } else {
+        xe::memory::CopyAndSwap16(dst->data(), src->data(), kBytes / 2);
+      }
+      asm volatile("" : : "r"(dst->data()) : "memory");
+    }
+    return iterations;
+  };
+  return bench;
+}
+
+// ── Kernel exports ──────────────────────────────────────────────────────────
+
+Benchmark ExportBenchmark(const char* name, uint32_t ordinal) {
+  static bool registered = false;
+  if (!registered) {
+    xe::kernel::xboxkrnl::RegisterAllExports();
+    registered = true;
+  }
+  Benchmark bench{name, "call", 0, nullptr};
+  bench.run = [ordinal](uint64_t iterations) -> uint64_t {
+    for (uint64_t i = 0; i < iterations; ++i) {
+      uint32_t args[10] = {kScratchAddress};
+      xe::kernel::xboxkrnl::Dispatch(ordinal, args);
+    }
+    return iterations;
+  };
+  return bench;
+}
+
+// ── Clock ───────────────────────────────────────────────────────────────────
+
+Benchmark GuestTicksBenchmark() {
+  Benchmark bench{"clock/guest_ticks", "call", 0, nullptr};
+  bench.run = [](uint64_t iterations) -> uint64_t {
+    uint64_t sum = 0;
+    for (uint64_t i = 0; i < iterations; ++i) {
+      sum += xe::timebase::QueryGuestTicks();
+    }
+    asm volatile("" : : "r"(sum));
+    return iterations;
+  };
+  return bench;
+}
+
+// ── Logging ─────────────────────────────────────────────────────────────────
+
+Benchmark LogFormatBenchmark() {
+  Benchmark bench{"log/format", "call", 0, nullptr};
+  bench.run = [](uint64_t iterations) -> uint64_t {
+    size_t total = 0;
+    std::string module = "default.xex";
+    for (uint64_t i = 0; i < iterations; ++i) {
+      std::string line =
+          xe::fmt("Loaded module: {} (handle=0x{:08X}) in {} ms, {} bytes",
+                  module, uint32_t(0x100 + i), double(i) * 0.25,
+                  uint64_t(i) << 12);
+      total += line.size();
+    }
+    asm volatile("" : : "r"(total));
+    return iterations;
+  };
+  return bench;
+}
+
+// ── Runner ──────────────────────────────────────────────────────────────────
+
+double Seconds(std::chrono::steady_clock::time_point since) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       since)
+      .count();
+}
+
+/// Log output of the code under test (the PM4 path logs every draw) goes to
+/// /dev/null while it is measured: still paid for, but not at the speed of
+/// whatever terminal stderr is attached to
+class QuietStderr {
+ public:
+  QuietStderr() {
+    fflush(stderr);
+    saved_ = dup(STDERR_FILENO);
+    int null = open("/dev/null", O_WRONLY);
+    if (null >= 0) {
+      dup2(null, STDERR_FILENO);
+      close(null);
+    }
+  }
+  ~QuietStderr() {
+    fflush(stderr);
+    if (saved_ >= 0) {
+      dup2(saved_, STDERR_FILENO);
+      close(saved_);
+    }
+  }
+
+ private:
+  int saved_ = -1;
+};
+
+bool Measure(const Benchmark& bench, double min_time, uint32_t repetitions,
+             Result* result) {
+  QuietStderr quiet;
+  // Grow the iteration count until one run takes a measurable 10 ms
+  uint64_t iterations = 1;
+  double elapsed = 0;
+  for (;;) {
+    auto start = std::chrono::steady_clock::now();
+    if (!bench.run(iterations)) return false;
+    elapsed = Seconds(start);
+    if (elapsed >= 0.01 || iterations >= (1ull << 40)) break;
+    iterations *= elapsed < 0.001 ? 10 : 2;
+  }
+  double per_sample = min_time / repetitions;
+  iterations = std::max<uint64_t>(
+      1, uint64_t(double(iterations) * per_sample / elapsed));
+
+  std::vector<double> samples;
+  for (uint32_t i = 0; i < repetitions; ++i) {
+    auto start = std::chrono::steady_clock::now();
+    uint64_t ops = bench.run(iterations);
+    double seconds = Seconds(start);
+    if (!ops) return false;
+    samples.push_back(seconds * 1e9 / double(ops));
+    result->ops += ops;
+  }
+  std::sort(samples.begin(), samples.end());
+  result->ns_per_op = samples[samples.size() / 2];
+  result->ns_per_op_min = samples.front();
+  return true;
+}
+
+double BytesPerSecond(const Benchmark& bench, const Result& result) {
+  return bench.bytes_per_op && result.ns_per_op > 0
+             ? double(bench.bytes_per_op) * 1e9 / result.ns_per_op
+             : 0;
+}
+
+void WriteJson(FILE* out, const std::vector<Benchmark>& benches,
+               const std::vector<Result>& results, uint32_t repetitions) {
+  char date[32];
+  time_t now = time(nullptr);
+  strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+#if defined(__aarch64__)
+  const char* arch = "arm64";
+#elif defined(__x86_64__)
+  const char* arch = "x86_64";
+#else
+  const char* arch = "unknown";
+#endif
+#if defined(NDEBUG)
+  const char* build = "release";
+#else
+  const char* build = "debug";
+#endif
+  fprintf(out, "{\n  \"context\": {\"date\": \"%s\", \"arch\": \"%s\", "
+               "\"build\": \"%s\", \"repetitions\": %u},\n",
+          date, arch, build, repetitions);
+  fprintf(out, "  \"benchmarks\": [");
+  for (size_t i = 0; i < benches.size(); ++i) {
+    fprintf(out,
+            "%s\n    {\"name\": \"%s\", \"unit\": \"%s\", "
+            "\"ns_per_op\": %.4f, \"ns_per_op_min\": %.4f, "
+            "\"bytes_per_second\": %.0f, \"ops\": %llu}",
+            i ? "," : "", benches[i].name, benches[i].unit,
+            results[i].ns_per_op, results[i].ns_per_op_min,
+            BytesPerSecond(benches[i], results[i]),
+            static_cast<unsigned long long>(results[i].ops));
+  }
+  fprintf(out, "\n  ]\n}\n");
+}
+
+void PrintUsage() {
+  fprintf(stderr,
+          "usage: vera360-bench [--filter=TEXT] [--min-time=MS] "
+          "[--repetitions=N] [--json=FILE|-] [--list]\n");
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::string filter;
+  std::string json_path;
+  double min_time = 0.5;
+  uint32_t repetitions = 5;
+  bool list = false;
+
+  for (int i = 1; i < argc; ++i) {
+    const char* arg = argv[i];
+    if (strncmp(arg, "--filter=", 9) == 0) {
+      filter = arg + 9;
+    } else if (strncmp(arg, "--min-time=", 11) == 0) {
+      min_time = std::max(1.0, atof(arg + 11)) / 1000.0;
+    } else if (strncmp(arg, "--repetitions=", 14) == 0) {
+      repetitions = uint32_t(std::max(1, atoi(arg + 14)));
+    } else if (strncmp(arg, "--json=", 7) == 0) {
+      json_path = arg + 7;
+    } else if (strcmp(arg, "--list") == 0) {
+      list = true;
+    } else {
+      PrintUsage();
+      return 1;
+    }
+  }
+
+  if (!xe::memory::Initialize() ||
+      !xe::memory::Commit(Guest(kCodeAddress), kCodeSize,
+                          xe::memory::PageAccess::kReadWrite) ||
+      !xe::memory::Commit(Guest(kDataAddress), kGuestDataSize,
+                          xe::memory::PageAccess::kReadWrite)) {
+    fprintf(stderr, "cannot map guest memory\n");
+    return 1;
+  }
+  FillGuestData(360);
+
+  std::vector<Benchmark> all = {
+      InterpreterBenchmark("interp/integer", IntegerKernel()),
+      InterpreterBenchmark("interp/load_store", LoadStoreKernel()),
+      InterpreterBenchmark("interp/branchy", BranchyKernel()),
+      InterpreterBenchmark("interp/vmx", VmxKernel()),
+      DecodeBenchmark(),
+      LzxBenchmark(),
+      Pm4Benchmark(),
+      SwapBenchmark("swap/vertex32", 4),
+      SwapBenchmark("swap/index16", 2),
+      ExportBenchmark("export/KeQueryPerformanceCounter", 18),
+      ExportBenchmark("export/InterlockedIncrement", 38),
+      GuestTicksBenchmark(),
+      LogFormatBenchmark(),
+  };
+  std::vector<Benchmark> benches;
+  for (Benchmark& bench : all) {
+    if (filter.empty() || strstr(bench.name, filter.c_str())) {
+      benches.push_back(std::move(bench));
+    }
+  }
+  if (list) {
+    for (const Benchmark& bench : benches) printf("%s\n", bench.name);
+    xe::memory::Shutdown();
+    return 0;
+  }
+
+  printf("%-34s %12s %12s %10s  %s\n", "benchmark", "ns/op", "min ns/op",
+         "MB/s", "op");
+  std::vector<Result> results(benches.size());
+  int failures = 0;
+  for (size_t i = 0; i < benches.size(); ++i) {
+    if (!Measure(benches[i], min_time, repetitions, &results[i])) {
+      fprintf(stderr, "%s: workload failed\n", benches[i].name);
+      failures++;
+      continue;
+    }
+    double bytes = BytesPerSecond(benches[i], results[i]);
+    printf("%-34s %12.2f %12.2f %10.1f  %s\n", benches[i].name,
+           results[i].ns_per_op, results[i].ns_per_op_min, bytes / 1e6,
+           benches[i].unit);
+    fflush(stdout);
+  }
+
+  if (!json_path.empty()) {
+    FILE* out = json_path == "-" ? stdout : fopen(json_path.c_str(), "w");
+    if (!out) {
+      fprintf(stderr, "cannot write %s\n", json_path.c_str());
+      failures++;
+    } else {
+      WriteJson(out, benches, results, repetitions);
+      if (out != stdout) fclose(out);
+    }
+  }
+  xe::memory::Shutdown();
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,178 @@
+/**
+ * Vera360 — Xenia Edge
+ * vera360-cli — headless runner for profiling on a desktop host
+ *
+ *   vera360-cli <game> [--frames=N] [--seconds=S] [--storage=DIR]
+ *               [--trace=FILE] [--profile=FILE]
+ *               [--deterministic | --record=FILE | --replay=FILE]
+ *
+ * Boots a XEX / ISO / STFS package with no window (GPU commands are
+ * processed, nothing is presented, audio goes to the null sink) and ticks
+ * the emulator back to back, unthrottled, until N frames (default 600) or
+ * S seconds have run, the title exits, or Ctrl-C. Then prints guest MIPS,
+ * the frame time distribution and where the frame time went, so a run can
+ * be put under perf, valgrind or a sanitizer like any other process.
+ * --trace writes the run's trace zones as Chrome trace JSON (builds
+ * configured with -DVERA360_TRACE=ON). --profile samples guest call
+ * stacks and writes them as folded stacks for flamegraph.pl / speedscope.
+ * --deterministic makes the guest run the same way every time (guest time
+ * from instruction counts, fixed thread order); --record also logs its pad
+ * input and file I/O, and --replay plays such a log back, so builds can be
+ * compared frame for frame. Pair them with --frames: --seconds stops on
+ * host time.
+ */
+
+#include "xenia/app/emulator.h"
+#include "xenia/apu/apu_system.h"
+#include "xenia/base/clock.h"
+#include "xenia/base/cvar.h"
+#include <algorithm>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+volatile std::sig_atomic_t g_interrupted = 0;
+
+void OnInterrupt(int) { g_interrupted = 1; }
+
+void PrintUsage() {
+  fprintf(stderr,
+          "usage: vera360-cli <game> [--frames=N] [--seconds=S] "
+          "[--storage=DIR] [--trace=FILE] [--profile=FILE]\n"
+          "                   [--deterministic | --record=FILE | "
+          "--replay=FILE]\n");
+}
+
+double Ms(uint64_t ns) { return double(ns) / 1e6; }
+
+double Share(uint64_t part, uint64_t whole) {
+  return whole ? 100.0 * double(part) / double(whole) : 0.0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::string game;
+  std::string storage = "vera360-data";
+  uint64_t frame_limit = 600;
+  bool frames_given = false;
+  double seconds = 0;
+
+  for (int i = 1; i < argc; ++i) {
+    const char* arg = argv[i];
+    if (strncmp(arg, "--frames=", 9) == 0) {
+      frame_limit = strtoull(arg + 9, nullptr, 10);
+      frames_given = true;
+    } else if (strncmp(arg, "--seconds=", 10) == 0) {
+      seconds = std::max(0.0, atof(arg + 10));
+    } else if (strncmp(arg, "--storage=", 10) == 0) {
+      storage = arg + 10;
+    } else if (strncmp(arg, "--trace=", 8) == 0) {
+      cvars.SetValue<std::string>("trace_file", arg + 8);
+    } else if (strncmp(arg, "--profile=", 10) == 0) {
+      cvars.SetValue<std::string>("guest_profile_file", arg + 10);
+    } else if (strcmp(arg, "--deterministic") == 0) {
+      cvars.SetValue<bool>("deterministic", true);
+    } else if (strncmp(arg, "--record=", 9) == 0) {
+      cvars.SetValue<std::string>("replay_record", arg + 9);
+    } else if (strncmp(arg, "--replay=", 9) == 0) {
+      cvars.SetValue<std::string>("replay_play", arg + 9);
+    } else if (arg[0] != '-' && game.empty()) {
+      game = arg;
+    } else {
+      PrintUsage();
+      return 1;
+    }
+  }
+  if (game.empty() || (!frame_limit && !seconds)) {
+    PrintUsage();
+    return 1;
+  }
+  // A time limit alone runs for that long
+  if (seconds && !frames_given) frame_limit = 0;
+
+  xe::Emulator emulator;
+  if (!emulator.Initialize(nullptr, storage)) {
+    fprintf(stderr, "emulator initialisation failed\n");
+    return 1;
+  }
+  if (!emulator.LoadGame(game)) {
+    fprintf(stderr, "cannot load %s\n", game.c_str());
+    return 1;
+  }
+  std::signal(SIGINT, OnInterrupt);
+
+  std::vector<xe::Emulator::FrameStats> frames;
+  frames.reserve(frame_limit ? frame_limit : 4096);
+  uint64_t deadline_ns = uint64_t(seconds * 1e9);
+  uint64_t start = xe::Clock::QueryHostTickCount();
+  uint64_t elapsed = 0;
+  while (!g_interrupted && emulator.is_running()) {
+    uint64_t before = emulator.frame_count();
+    emulator.Tick();
+    elapsed = xe::Clock::QueryHostTickCount() - start;
+    if (emulator.frame_count() == before) break;
+    frames.push_back(emulator.last_frame_stats());
+    if (frame_limit && frames.size() >= frame_limit) break;
+    if (deadline_ns && elapsed >= deadline_ns) break;
+  }
+  const char* reason = g_interrupted          ? "interrupted"
+                       : !emulator.is_running() ? "title exited"
+                                                : "limit reached";
+
+  // ── Report ────────────────────────────────────────────────────────────
+  xe::Emulator::FrameStats sum;
+  std::vector<uint64_t> times;
+  times.reserve(frames.size());
+  for (const auto& frame : frames) {
+    sum.instructions += frame.instructions;
+    sum.cpu_ns += frame.cpu_ns;
+    sum.gpu_ns += frame.gpu_ns;
+    sum.present_ns += frame.present_ns;
+    sum.total_ns += frame.total_ns;
+    times.push_back(frame.total_ns);
+  }
+  std::sort(times.begin(), times.end());
+  size_t count = times.size();
+  double wall = double(elapsed) / 1e9;
+
+  printf("%s: %zu frames in %.3f s (%s)\n", game.c_str(), count, wall,
+         reason);
+  if (count) {
+    uint64_t other = sum.total_ns - std::min(sum.total_ns, sum.cpu_ns +
+                                             sum.gpu_ns + sum.present_ns);
+    printf("  %.1f fps, %.2f guest MIPS (%llu instructions)\n",
+           count / wall, double(sum.instructions) / wall / 1e6,
+           static_cast<unsigned long long>(sum.instructions));
+    printf("  frame ms: min %.3f  avg %.3f  p50 %.3f  p99 %.3f  max %.3f\n",
+           Ms(times.front()), Ms(sum.total_ns) / count,
+           Ms(times[count / 2]), Ms(times[(count - 1) * 99 / 100]),
+           Ms(times.back()));
+    printf("  per frame: cpu %.3f ms (%.1f%%)  gpu %.3f ms (%.1f%%)  "
+           "present %.3f ms (%.1f%%)  other %.3f ms (%.1f%%)\n",
+           Ms(sum.cpu_ns) / count, Share(sum.cpu_ns, sum.total_ns),
+           Ms(sum.gpu_ns) / count, Share(sum.gpu_ns, sum.total_ns),
+           Ms(sum.present_ns) / count, Share(sum.present_ns, sum.total_ns),
+           Ms(other) / count, Share(other, sum.total_ns));
+  }
+  if (auto* apu = emulator.apu_system()) {
+    xe::apu::XmaDecodeStats xma = apu->xma_decoder().stats();
+    printf("  xma: %llu packets, %llu samples, decode %.3f ms (%.2f%% of "
+           "playback)\n",
+           static_cast<unsigned long long>(xma.packets),
+           static_cast<unsigned long long>(xma.samples), Ms(xma.decode_ns),
+           Share(xma.decode_ns, xma.budget_ns));
+    if (apu->sink()) {
+      printf("  audio: %llu frames of underrun\n",
+             static_cast<unsigned long long>(apu->sink()->underrun_frames()));
+    }
+  }
+
+  emulator.Shutdown();
+  return 0;
+}
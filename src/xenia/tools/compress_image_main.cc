@@ -0,0 +1,85 @@
+/**
+ * Vera360 — Xenia Edge
+ * vera360-compress — convert an Xbox 360 ISO into a compressed disc image
+ *
+ *   vera360-compress [--block-size=KiB] [--threads=N] [--no-dedupe]
+ *                    input.iso output.vci
+ */
+
+#include "xenia/vfs/compressed_image.h"
+#include "xenia/vfs/disc_image_device.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace {
+
+void PrintUsage() {
+  fprintf(stderr,
+          "usage: vera360-compress [--block-size=KiB] [--threads=N] "
+          "[--no-dedupe] input.iso output.vci\n");
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  xe::vfs::CompressImageOptions options;
+  std::string input, output;
+
+  for (int i = 1; i < argc; ++i) {
+    const char* arg = argv[i];
+    if (strncmp(arg, "--block-size=", 13) == 0) {
+      options.block_size = static_cast<uint32_t>(atoi(arg + 13)) * 1024;
+    } else if (strncmp(arg, "--threads=", 10) == 0) {
+      options.thread_count = static_cast<uint32_t>(atoi(arg + 10));
+    } else if (strcmp(arg, "--no-dedupe") == 0) {
+      options.dedupe = false;
+    } else if (input.empty()) {
+      input = arg;
+    } else if (output.empty()) {
+      output = arg;
+    } else {
+      PrintUsage();
+      return 1;
+    }
+  }
+  if (input.empty() || output.empty()) {
+    PrintUsage();
+    return 1;
+  }
+
+  if (!xe::vfs::DiscImageDevice::IsDiscImage(input)) {
+    fprintf(stderr, "%s: no XDVDFS volume found\n", input.c_str());
+    return 1;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  int last_percent = -1;
+  bool ok = xe::vfs::CompressDiscImage(
+      input, output, options, [&](uint64_t done, uint64_t total) {
+        int percent = total ? static_cast<int>(done * 100 / total) : 100;
+        if (percent != last_percent) {
+          last_percent = percent;
+          fprintf(stderr, "\r%3d%%", percent);
+        }
+      });
+  fprintf(stderr, "\n");
+  if (!ok) {
+    fprintf(stderr, "conversion failed\n");
+    return 1;
+  }
+
+  // Re-open through the normal mount path as a sanity check
+  if (!xe::vfs::DiscImageDevice::IsDiscImage(output)) {
+    fprintf(stderr, "%s: output does not mount\n", output.c_str());
+    return 1;
+  }
+
+  double seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  fprintf(stderr, "done in %.1f s\n", seconds);
+  return 0;
+}
@@ -0,0 +1,648 @@
+/**
+ * Vera360 — Xenia Edge
+ * vera360-difftest — lockstep differential testing of the CPU backends
+ *
+ *   vera360-difftest [--candidate=jit|interp] [--cases=N] [--length=N]
+ *                    [--seed=S] [--case=N] [--code=FILE[@ADDR]]...
+ *                    [--corpus] [--states=N] [--max-reports=N]
+ *
+ * Every case is one straight-line block staged in guest memory and closed
+ * with a blr. The reference runs it through PPCInterpreter::Step, one
+ * instruction at a time; the candidate runs the same block from the same
+ * ThreadState and memory; then every register, and every guest page either
+ * run touched, must match.
+ *
+ * Blocks come from a random instruction generator (integer, compare,
+ * load/store, float, VMX, SPR moves; --cases of them, --length long) and
+ * from recorded code: raw big-endian dumps given with --code (a title's
+ * text section, vera360-guestbench --dump output) and the guest corpus
+ * with --corpus. Recorded code is cut into basic blocks at branches, sc,
+ * traps and mtlr, and each block runs from --states random initial states.
+ *
+ * Guest memory starts uncommitted: an access hook fills each page on first
+ * touch with a pattern derived from its address, so both runs see the same
+ * memory wherever the block's registers point, and the touched set is
+ * known exactly.
+ *
+ * The "jit" candidate is the ARM64 backend and needs an arm64 host; on x86
+ * build for arm64 and run the tool under qemu-aarch64. "interp" runs
+ * PPCInterpreter::Run and checks the harness itself. A reported case
+ * reproduces alone with the same --seed and --case.
+ */
+
+#include "xenia/base/logging.h"
+#include "xenia/base/memory/memory.h"
+#include "xenia/cpu/backend/arm64/arm64_backend.h"
+#include "xenia/cpu/frontend/ppc_assembler.h"
+#include "xenia/cpu/frontend/ppc_interpreter.h"
+#include "xenia/cpu/processor.h"
+#include "xenia/tools/guest_corpus.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <sys/mman.h>
+
+namespace xe::cpu::frontend {
+std::string DisassemblePPC(uint32_t address, uint32_t code);
+}
+
+namespace {
+
+using namespace xe::cpu::frontend::ppc_asm;
+using xe::cpu::ThreadState;
+using xe::cpu::frontend::PPCInterpreter;
+
+constexpr uint32_t kStagingAddress = 0x82000000;
+constexpr uint32_t kStagingSize = 0x1000;
+/// Blocks return here; never executed
+constexpr uint32_t kExitAddress = kStagingAddress + kStagingSize - 4;
+constexpr uint32_t kMaxBlockLength = 64;
+/// Random blocks address memory through r30/r31 (+ index r28) in here
+constexpr uint32_t kWindowAddress = 0x40000000;
+constexpr uint32_t kWindowSize = 0x100000;
+
+uint8_t* Guest(uint32_t address) {
+  return static_cast<uint8_t*>(xe::memory::TranslateVirtual(address));
+}
+
+// ── Touched pages ───────────────────────────────────────────────────────────
+
+constexpr size_t kMaxTouched = 1024;
+
+/// Filled from the SIGSEGV handler: fixed storage only
+struct TouchedPages {
+  uint32_t unit = xe::memory::kGuestPageSize;
+  uint32_t pages[kMaxTouched];
+  size_t count = 0;
+  bool overflow = false;
+};
+TouchedPages g_touched;
+
+/// What every page holds before a block touches it: a function of its
+/// address alone
+void FillPattern(uint8_t* p, uint32_t address, uint32_t size) {
+  uint32_t x = address | 1;
+  for (uint32_t i = 0; i < size; i += 4) {
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    memcpy(p + i, &x, 4);
+  }
+}
+
+bool OnGuestAccess(void* context, uint32_t guest_address, uint32_t size,
+                   bool from_fault, bool is_write) {
+  (void)size;
+  (void)is_write;
+  if (!from_fault) return true;
+  auto* touched = static_cast<TouchedPages*>(context);
+  uint32_t page = guest_address & ~(touched->unit - 1);
+  void* fresh = mmap(nullptr, touched->unit, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (fresh == MAP_FAILED) return false;
+  FillPattern(static_cast<uint8_t*>(fresh), page, touched->unit);
+  if (!xe::memory::MoveIntoGuest(fresh, page, touched->unit,
+                                 xe::memory::PageAccess::kReadWrite)) {
+    munmap(fresh, touched->unit);
+    return false;
+  }
+  if (touched->count < kMaxTouched) {
+    touched->pages[touched->count++] = page;
+  } else {
+    touched->overflow = true;
+  }
+  return true;
+}
+
+/// Guest pages a run left behind, in touch order
+struct MemoryImage {
+  std::vector<uint32_t> pages;
+  std::vector<uint8_t> bytes;
+};
+
+/// Copies out the pages the last run touched and drops them, so the next
+/// run starts from the pattern again
+MemoryImage TakeTouched() {
+  MemoryImage image;
+  uint32_t unit = g_touched.unit;
+  for (size_t i = 0; i < g_touched.count; ++i) {
+    uint32_t page = g_touched.pages[i];
+    image.pages.push_back(page);
+    image.bytes.insert(image.bytes.end(), Guest(page), Guest(page) + unit);
+    xe::memory::Decommit(Guest(page), unit);
+  }
+  g_touched.count = 0;
+  return image;
+}
+
+// ── Cases ───────────────────────────────────────────────────────────────────
+
+struct Case {
+  std::vector<uint32_t> block;  // without the closing blr
+  ThreadState state;
+  std::string origin;
+};
+
+uint64_t RandomValue(std::mt19937_64& rng) {
+  switch (rng() % 4) {
+    case 0: return rng() % 256;
+    case 1: return kWindowAddress + rng() % kWindowSize;
+    case 2: return uint64_t(int64_t(int32_t(rng())));
+    default: return rng();
+  }
+}
+
+void RandomState(std::mt19937_64& rng, ThreadState* ts) {
+  *ts = ThreadState{};
+  for (uint64_t& gpr : ts->gpr) gpr = RandomValue(rng);
+  ts->gpr[28] = (rng() % 256) * 16;
+  ts->gpr[30] = kWindowAddress + 0x8000 + (rng() % (kWindowSize / 2) & ~15u);
+  ts->gpr[31] = kWindowAddress + 0x8000 + (rng() % (kWindowSize / 2) & ~15u);
+  ts->cr = uint32_t(rng());
+  ts->xer = rng() & 0xE000007F;
+  ts->ctr = uint32_t(rng());
+  ts->lr = kExitAddress;
+  std::uniform_real_distribution<double> mantissa(-1.0, 1.0);
+  for (double& fpr : ts->fpr) {
+    fpr = rng() % 8 ? std::ldexp(mantissa(rng), int(rng() % 41) - 20) : 0.0;
+  }
+  for (auto& vr : ts->vmx) {
+    if (rng() % 2) {
+      for (uint8_t& byte : vr) byte = uint8_t(rng());
+    } else {
+      for (int i = 0; i < 4; ++i) {
+        float f = float(mantissa(rng) * 4.0);
+        memcpy(&vr[i * 4], &f, 4);
+      }
+    }
+  }
+  ts->pc = kStagingAddress;
+}
+
+/// One instruction of the random stream. r28 (index), r30 and r31 (bases)
+/// are never written, so memory operands stay in the window.
+uint32_t RandomInstruction(std::mt19937_64& rng) {
+  auto gpr = [&] { return uint32_t(rng() % 28); };
+  auto fpr = [&] { return uint32_t(rng() % 32); };
+  auto vr = [&] { return uint32_t(rng() % 32); };
+  auto base = [&] { return uint32_t(30 + rng() % 2); };
+  auto simm = [&] { return int32_t(int16_t(rng())); };
+  auto disp = [&](int32_t size) {
+    return (int32_t(rng() % 0x1000) - 0x800) & ~(size - 1);
+  };
+  auto rc = [&] { return uint32_t(rng() % 4 == 0); };
+  switch (rng() % 18) {
+    case 0: return addi(gpr(), gpr(), simm());
+    case 1: return addis(gpr(), gpr(), simm());
+    case 2: return mulli(gpr(), gpr(), simm());
+    case 3:
+      switch (rng() % 3) {
+        case 0: return ori(gpr(), gpr(), uint32_t(rng()) & 0xFFFF);
+        case 1: return oris(gpr(), gpr(), uint32_t(rng()) & 0xFFFF);
+        default: return andi_(gpr(), gpr(), uint32_t(rng()) & 0xFFFF);
+      }
+    case 4:
+      switch (rng() % 4) {
+        case 0: return add(gpr(), gpr(), gpr()) | rc();
+        case 1: return subf(gpr(), gpr(), gpr()) | rc();
+        case 2: return mullw(gpr(), gpr(), gpr()) | rc();
+        default: return neg(gpr(), gpr()) | rc();
+      }
+    case 5:
+      switch (rng() % 3) {
+        case 0: return and_(gpr(), gpr(), gpr()) | rc();
+        case 1: return or_(gpr(), gpr(), gpr()) | rc();
+        default: return xor_(gpr(), gpr(), gpr()) | rc();
+      }
+    case 6:
+      return (rng() % 2 ? slw(gpr(), gpr(), gpr()) : srw(gpr(), gpr(), gpr())) |
+             rc();
+    case 7: {
+      uint32_t sh = rng() % 32, mb = rng() % 32, me = rng() % 32;
+      return rlwinm(gpr(), gpr(), sh, mb, me) | rc();
+    }
+    case 8: {
+      uint32_t crf = rng() % 8;
+      switch (rng() % 4) {
+        case 0: return cmpw(crf, gpr(), gpr());
+        case 1: return cmplw(crf, gpr(), gpr());
+        case 2: return cmpwi(crf, gpr(), simm());
+        default: return cmplwi(crf, gpr(), uint32_t(rng()) & 0xFFFF);
+      }
+    }
+    case 9:
+      switch (rng() % 4) {
+        case 0: return lwz(gpr(), disp(4), base());
+        case 1: return lbz(gpr(), disp(1), base());
+        case 2: return lhz(gpr(), disp(2), base());
+        default: return ld(gpr(), disp(8), base());
+      }
+    case 10:
+      switch (rng() % 4) {
+        case 0: return stw(gpr(), disp(4), base());
+        case 1: return stb(gpr(), disp(1), base());
+        case 2: return sth(gpr(), disp(2), base());
+        default: return std_(gpr(), disp(8), base());
+      }
+    case 11:
+      return rng() % 2 ? lwzx(gpr(), base(), 28) : stwx(gpr(), base(), 28);
+    case 12:
+      return rng() % 2 ? lfs(fpr(), disp(4), base())
+                       : stfs(fpr(), disp(4), base());
+    case 13:
+      switch (rng() % 7) {
+        case 0: return fadd(fpr(), fpr(), fpr());
+        case 1: return fsub(fpr(), fpr(), fpr());
+        case 2: return fmul(fpr(), fpr(), fpr());
+        case 3: return fmadd(fpr(), fpr(), fpr(), fpr());
+        case 4: return fadds(fpr(), fpr(), fpr());
+        case 5: return fmuls(fpr(), fpr(), fpr());
+        default: return fmr(fpr(), fpr());
+      }
+    case 14:
+      switch (rng() % 4) {
+        case 0: return vaddfp(vr(), vr(), vr());
+        case 1: return vsubfp(vr(), vr(), vr());
+        case 2: return vmaxfp(vr(), vr(), vr());
+        default: return vmaddfp(vr(), vr(), vr(), vr());
+      }
+    case 15:
+      switch (rng() % 6) {
+        case 0: return vand(vr(), vr(), vr());
+        case 1: return vor(vr(), vr(), vr());
+        case 2: return vxor(vr(), vr(), vr());
+        case 3: return vperm(vr(), vr(), vr(), vr());
+        case 4: return vsel(vr(), vr(), vr(), vr());
+        default: return vspltw(vr(), vr(), uint32_t(rng() % 4));
+      }
+    case 16:
+      return rng() % 2 ? lvx(vr(), base(), 28) : stvx(vr(), base(), 28);
+    default:
+      switch (rng() % 4) {
+        case 0: return mfcr(gpr());
+        case 1: return mfctr(gpr());
+        case 2: return mflr(gpr());
+        default: return mtctr(gpr());
+      }
+  }
+}
+
+/// Whether a recorded instruction ends a block (and is left out of it):
+/// branches, sc, traps, returns from interrupt and mtlr
+bool EndsBlock(uint32_t word) {
+  uint32_t op = word >> 26;
+  uint32_t xo = (word >> 1) & 0x3FF;
+  uint32_t spr = ((word >> 16) & 0x1F) | (((word >> 11) & 0x1F) << 5);
+  switch (op) {
+    case 2: case 3:             // tdi, twi
+    case 16: case 17: case 18:  // bc, sc, b
+      return true;
+    case 19:  // bclr, bcctr, rfid
+      return xo == 16 || xo == 528 || xo == 18;
+    case 31:  // tw, td, mtspr LR
+      return xo == 4 || xo == 68 || (xo == 467 && spr == 8);
+    default:
+      return word == 0;
+  }
+}
+
+std::vector<std::vector<uint32_t>> SplitBlocks(
+    const std::vector<uint32_t>& words) {
+  std::vector<std::vector<uint32_t>> blocks;
+  std::vector<uint32_t> current;
+  for (uint32_t word : words) {
+    if (EndsBlock(word) || current.size() == kMaxBlockLength) {
+      if (!current.empty()) blocks.push_back(std::move(current));
+      current.clear();
+      if (EndsBlock(word)) continue;
+    }
+    current.push_back(word);
+  }
+  if (!current.empty()) blocks.push_back(std::move(current));
+  return blocks;
+}
+
+bool ReadCode(const std::string& spec, std::vector<uint32_t>* words,
+              uint32_t* address) {
+  std::string path = spec;
+  *address = kStagingAddress;
+  size_t at = spec.rfind('@');
+  if (at != std::string::npos) {
+    path = spec.substr(0, at);
+    *address = uint32_t(strtoul(spec.c_str() + at + 1, nullptr, 0));
+  }
+  FILE* f = fopen(path.c_str(), "rb");
+  if (!f) return false;
+  uint8_t word[4];
+  while (fread(word, 1, 4, f) == 4) {
+    words->push_back((uint32_t(word[0]) << 24) | (uint32_t(word[1]) << 16) |
+                     (uint32_t(word[2]) << 8) | word[3]);
+  }
+  fclose(f);
+  return true;
+}
+
+struct RecordedBlock {
+  std::vector<uint32_t> words;
+  std::string origin;
+};
+
+// ── Candidates ──────────────────────────────────────────────────────────────
+
+/// Runs the staged block from the state; false if it did not come back
+using RunFn = std::function<bool(ThreadState*)>;
+
+bool RunReference(PPCInterpreter& interpreter, ThreadState* ts) {
+  for (uint32_t i = 0; i <= kMaxBlockLength && ts->pc != kExitAddress; ++i) {
+    interpreter.Step(ts);
+  }
+  return ts->pc == kExitAddress;
+}
+
+// ── Comparison ──────────────────────────────────────────────────────────────
+
+void CompareStates(const ThreadState& ref, const ThreadState& cand,
+                   std::vector<std::string>* diffs) {
+  auto report = [&](const std::string& name, uint64_t a, uint64_t b) {
+    if (a != b) {
+      diffs->push_back(xe::fmt("{}: reference 0x{:X}, candidate 0x{:X}", name,
+                               a, b));
+    }
+  };
+  for (int i = 0; i < 32; ++i) {
+    report(xe::fmt("r{}", i), ref.gpr[i], cand.gpr[i]);
+  }
+  report("cr", ref.cr, cand.cr);
+  report("xer", ref.xer, cand.xer);
+  report("ctr", ref.ctr, cand.ctr);
+  report("lr", ref.lr, cand.lr);
+  for (int i = 0; i < 32; ++i) {
+    uint64_t a, b;
+    memcpy(&a, &ref.fpr[i], 8);
+    memcpy(&b, &cand.fpr[i], 8);
+    report(xe::fmt("f{}", i), a, b);
+  }
+  for (int i = 0; i < 128; ++i) {
+    for (int half = 0; half < 2; ++half) {
+      uint64_t a, b;
+      memcpy(&a, &ref.vmx[i][half * 8], 8);
+      memcpy(&b, &cand.vmx[i][half * 8], 8);
+      report(xe::fmt("v{}[{}]", i, half ? "8..15" : "0..7"), a, b);
+    }
+  }
+  report("reserve", ref.reserve_valid ? ref.reserve_address : 0,
+         cand.reserve_valid ? cand.reserve_address : 0);
+}
+
+void CompareMemory(const MemoryImage& ref, const MemoryImage& cand,
+                   uint32_t unit, std::vector<std::string>* diffs) {
+  std::vector<uint32_t> pages = ref.pages;
+  pages.insert(pages.end(), cand.pages.begin(), cand.pages.end());
+  std::sort(pages.begin(), pages.end());
+  pages.erase(std::unique(pages.begin(), pages.end()), pages.end());
+
+  std::vector<uint8_t> pattern(unit);
+  auto contents = [&](const MemoryImage& image, uint32_t page) {
+    for (size_t i = 0; i < image.pages.size(); ++i) {
+      if (image.pages[i] == page) return image.bytes.data() + i * unit;
+    }
+    FillPattern(pattern.data(), page, unit);
+    return static_cast<const uint8_t*>(pattern.data());
+  };
+  for (uint32_t page : pages) {
+    std::vector<uint8_t> a(contents(ref, page), contents(ref, page) + unit);
+    const uint8_t* b = contents(cand, page);
+    for (uint32_t i = 0; i < unit; ++i) {
+      if (a[i] != b[i]) {
+        diffs->push_back(xe::fmt("memory 0x{:08X}: reference 0x{:02X}, "
+                                 "candidate 0x{:02X}",
+                                 page + i, uint32_t(a[i]), uint32_t(b[i])));
+        break;
+      }
+    }
+  }
+}
+
+enum class Outcome { kMatch, kDiverged, kSkipped };
+
+Outcome RunCase(const Case& c, PPCInterpreter& reference, const RunFn& candidate,
+                std::vector<std::string>* diffs) {
+  uint32_t address = kStagingAddress;
+  for (uint32_t word : c.block) {
+    uint8_t* p = Guest(address);
+    p[0] = uint8_t(word >> 24); p[1] = uint8_t(word >> 16);
+    p[2] = uint8_t(word >> 8);  p[3] = uint8_t(word);
+    address += 4;
+  }
+  uint32_t ret = blr();
+  uint8_t* p = Guest(address);
+  p[0] = uint8_t(ret >> 24); p[1] = uint8_t(ret >> 16);
+  p[2] = uint8_t(ret >> 8);  p[3] = uint8_t(ret);
+
+  g_touched.overflow = false;
+  ThreadState ref_state = c.state;
+  bool ref_returned = RunReference(reference, &ref_state);
+  MemoryImage ref_memory = TakeTouched();
+  // A block the reference cannot finish (an unsupported or trapping
+  // instruction) says nothing about the candidate
+  if (!ref_returned || g_touched.overflow) return Outcome::kSkipped;
+
+  ThreadState cand_state = c.state;
+  bool cand_returned = candidate(&cand_state);
+  MemoryImage cand_memory = TakeTouched();
+  if (!cand_returned) {
+    diffs->push_back(xe::fmt("candidate stopped at 0x{:08X}",
+                             cand_state.pc));
+  }
+  CompareStates(ref_state, cand_state, diffs);
+  CompareMemory(ref_memory, cand_memory, g_touched.unit, diffs);
+  return diffs->empty() ? Outcome::kMatch : Outcome::kDiverged;
+}
+
+void PrintUsage() {
+  fprintf(stderr,
+          "usage: vera360-difftest [--candidate=jit|interp] [--cases=N] "
+          "[--length=N] [--seed=S] [--case=N] [--code=FILE[@ADDR]]... "
+          "[--corpus] [--states=N] [--max-reports=N]\n");
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+#if defined(__aarch64__)
+  std::string candidate_name = "jit";
+#else
+  std::string candidate_name = "interp";
+#endif
+  uint64_t random_cases = 10000;
+  uint32_t length = 16;
+  uint64_t seed = 1;
+  int64_t only_case = -1;
+  uint32_t states = 8;
+  uint32_t max_reports = 10;
+  bool corpus = false;
+  std::vector<std::string> code_specs;
+
+  for (int i = 1; i < argc; ++i) {
+    const char* arg = argv[i];
+    if (strncmp(arg, "--candidate=", 12) == 0) {
+      candidate_name = arg + 12;
+    } else if (strncmp(arg, "--cases=", 8) == 0) {
+      random_cases = strtoull(arg + 8, nullptr, 10);
+    } else if (strncmp(arg, "--length=", 9) == 0) {
+      length = std::clamp<uint32_t>(uint32_t(atoi(arg + 9)), 1,
+                                    kMaxBlockLength);
+    } else if (strncmp(arg, "--seed=", 7) == 0) {
+      seed = strtoull(arg + 7, nullptr, 0);
+    } else if (strncmp(arg, "--case=", 7) == 0) {
+      only_case = int64_t(strtoull(arg + 7, nullptr, 10));
+    } else if (strncmp(arg, "--code=", 7) == 0) {
+      code_specs.push_back(arg + 7);
+    } else if (strcmp(arg, "--corpus") == 0) {
+      corpus = true;
+    } else if (strncmp(arg, "--states=", 9) == 0) {
+      states = uint32_t(std::max(1, atoi(arg + 9)));
+    } else if (strncmp(arg, "--max-reports=", 14) == 0) {
+      max_reports = uint32_t(std::max(0, atoi(arg + 14)));
+    } else {
+      PrintUsage();
+      return 1;
+    }
+  }
+
+  // ── Recorded blocks ───────────────────────────────────────────────────
+  std::vector<RecordedBlock> recorded;
+  for (const std::string& spec : code_specs) {
+    std::vector<uint32_t> words;
+    uint32_t address = 0;
+    if (!ReadCode(spec, &words, &address)) {
+      fprintf(stderr, "cannot read %s\n", spec.c_str());
+      return 1;
+    }
+    for (auto& block : SplitBlocks(words)) {
+      recorded.push_back({std::move(block), spec});
+    }
+  }
+  if (corpus) {
+    for (const xe::tools::GuestProgram& program : xe::tools::BuildCorpus()) {
+      for (auto& block : SplitBlocks(program.code)) {
+        recorded.push_back({std::move(block), "corpus/" + program.name});
+      }
+    }
+  }
+  uint64_t total_cases = random_cases + recorded.size() * uint64_t(states);
+
+  if (!xe::memory::Initialize() ||
+      !xe::memory::Commit(Guest(kStagingAddress), kStagingSize,
+                          xe::memory::PageAccess::kReadWrite)) {
+    fprintf(stderr, "cannot map guest memory\n");
+    return 1;
+  }
+  g_touched.unit = std::max<uint32_t>(xe::memory::kGuestPageSize,
+                                      uint32_t(xe::memory::GetHostPageSize()));
+  xe::memory::SetAccessHook(OnGuestAccess, &g_touched);
+
+  PPCInterpreter reference;
+  reference.SetGuestBase(xe::memory::GetGuestBase());
+
+  // ── Candidate ─────────────────────────────────────────────────────────
+  RunFn candidate;
+  PPCInterpreter interpreter;
+  interpreter.SetGuestBase(xe::memory::GetGuestBase());
+#if defined(__aarch64__)
+  xe::cpu::backend::arm64::ARM64Backend backend;
+#endif
+  if (candidate_name == "interp") {
+    candidate = [&interpreter](ThreadState* ts) {
+      interpreter.Run(ts, kMaxBlockLength + 1);
+      return ts->pc == kExitAddress;
+    };
+#if defined(__aarch64__)
+  } else if (candidate_name == "jit") {
+    backend.Initialize();
+    candidate = [&backend](ThreadState* ts) {
+      backend.InvalidateCode(kStagingAddress, kStagingSize);
+      backend.Execute(kStagingAddress, ts);
+      // Compiled code returns to its caller; the dispatcher owns pc
+      ts->pc = kExitAddress;
+      return true;
+    };
+#endif
+  } else {
+    fprintf(stderr, candidate_name == "jit"
+                        ? "the ARM64 JIT needs an arm64 host (or "
+                          "qemu-aarch64)\n"
+                        : "unknown candidate\n");
+    xe::memory::SetAccessHook(nullptr, nullptr);
+    xe::memory::Shutdown();
+    return 1;
+  }
+
+  // ── Run ───────────────────────────────────────────────────────────────
+  uint64_t matched = 0, diverged = 0, skipped = 0, instructions = 0;
+  uint64_t first = only_case >= 0 ? uint64_t(only_case) : 0;
+  uint64_t end = only_case >= 0 ? std::min(first + 1, total_cases)
+                                : total_cases;
+  for (uint64_t index = first; index < end; ++index) {
+    std::mt19937_64 rng(seed * 0x9E3779B97F4A7C15ull + index);
+    Case c;
+    if (index < random_cases) {
+      for (uint32_t i = 0; i < length; ++i) {
+        c.block.push_back(RandomInstruction(rng));
+      }
+      c.origin = "random";
+    } else {
+      const RecordedBlock& block =
+          recorded[(index - random_cases) / states];
+      c.block = block.words;
+      c.origin = block.origin;
+    }
+    RandomState(rng, &c.state);
+
+    std::vector<std::string> diffs;
+    switch (RunCase(c, reference, candidate, &diffs)) {
+      case Outcome::kMatch:
+        matched++;
+        instructions += c.block.size();
+        continue;
+      case Outcome::kSkipped:
+        skipped++;
+        continue;
+      case Outcome::kDiverged:
+        diverged++;
+        instructions += c.block.size();
+        break;
+    }
+    if (diverged > max_reports && only_case < 0) continue;
+    printf("case %llu (%s, seed %llu): %zu difference%s\n",
+           static_cast<unsigned long long>(index), c.origin.c_str(),
+           static_cast<unsigned long long>(seed), diffs.size(),
+           diffs.size() == 1 ? "" : "s");
+    for (size_t i = 0; i < c.block.size(); ++i) {
+      uint32_t address = kStagingAddress + uint32_t(i) * 4;
+      printf("  %s\n",
+             xe::cpu::frontend::DisassemblePPC(address, c.block[i]).c_str());
+    }
+    for (const std::string& diff : diffs) printf("  %s\n", diff.c_str());
+  }
+
+  printf("%s vs interpreter: %llu cases, %llu match, %llu diverge, "
+         "%llu skipped (reference did not finish), %llu instructions\n",
+         candidate_name.c_str(),
+         static_cast<unsigned long long>(end - std::min(first, end)),
+         static_cast<unsigned long long>(matched),
+         static_cast<unsigned long long>(diverged),
+         static_cast<unsigned long long>(skipped),
+         static_cast<unsigned long long>(instructions));
+  xe::memory::SetAccessHook(nullptr, nullptr);
+  xe::memory::Shutdown();
+  return diverged ? 1 : 0;
+}
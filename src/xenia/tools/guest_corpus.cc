@@ -0,0 +1,475 @@
+/**
+ * Vera360 — Xenia Edge
+ * Guest benchmark corpus — programs, reference results and the runner
+ */
+
+#include "xenia/tools/guest_corpus.h"
+#include "xenia/base/logging.h"
+#include "xenia/base/memory/memory.h"
+#include "xenia/cpu/frontend/ppc_assembler.h"
+#include "xenia/cpu/processor.h"
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <random>
+
+namespace xe::kernel::xboxkrnl {
+void RegisterAllExports();
+uint32_t Dispatch(uint32_t ordinal, uint32_t* args);
+}
+
+namespace xe::tools {
+
+namespace {
+
+using namespace xe::cpu::frontend::ppc_asm;
+
+uint8_t* Guest(uint32_t address) {
+  return static_cast<uint8_t*>(xe::memory::TranslateVirtual(address));
+}
+
+void StoreBE32(uint32_t address, uint32_t v) {
+  uint8_t* p = Guest(address);
+  p[0] = uint8_t(v >> 24); p[1] = uint8_t(v >> 16);
+  p[2] = uint8_t(v >> 8);  p[3] = uint8_t(v);
+}
+
+void AppendBE32(std::vector<uint8_t>& bytes, uint32_t v) {
+  bytes.push_back(uint8_t(v >> 24)); bytes.push_back(uint8_t(v >> 16));
+  bytes.push_back(uint8_t(v >> 8));  bytes.push_back(uint8_t(v));
+}
+
+uint32_t FloatBits(float f) {
+  uint32_t bits;
+  memcpy(&bits, &f, 4);
+  return bits;
+}
+
+/// lis + ori: any 32-bit address into reg
+void LoadAddress(std::vector<uint32_t>& code, uint32_t reg, uint32_t address) {
+  code.push_back(lis(reg, int32_t(address >> 16)));
+  code.push_back(ori(reg, reg, address & 0xFFFF));
+}
+
+/// Branch displacement from the next word emitted to the word at index
+int32_t To(const std::vector<uint32_t>& code, size_t index) {
+  return int32_t(index * 4) - int32_t(code.size() * 4);
+}
+
+// ── memcpy ──────────────────────────────────────────────────────────────────
+
+GuestProgram MemcpyProgram() {
+  constexpr uint32_t kBytes = 256 * 1024;
+  constexpr uint32_t kSource = kCorpusDataAddress;
+  constexpr uint32_t kDest = kCorpusDataAddress + 0x100000;
+
+  GuestProgram p;
+  p.name = "memcpy";
+  p.description = "256 KiB copy, four word loads and stores per iteration";
+  auto& c = p.code;
+  LoadAddress(c, 4, kSource);
+  LoadAddress(c, 5, kDest);
+  c.push_back(li(6, kBytes / 16));
+  c.push_back(mtctr(6));
+  size_t loop = c.size();
+  c.insert(c.end(), {lwz(7, 0, 4), lwz(8, 4, 4), lwz(9, 8, 4), lwz(10, 12, 4),
+                     stw(7, 0, 5), stw(8, 4, 5), stw(9, 8, 5), stw(10, 12, 5),
+                     addi(4, 4, 16), addi(5, 5, 16)});
+  c.push_back(bdnz(To(c, loop)));
+  c.push_back(blr());
+
+  std::vector<uint8_t> source(kBytes);
+  std::mt19937 rng(93001);
+  for (uint8_t& byte : source) byte = uint8_t(rng());
+  p.data_size = kDest + kBytes - kCorpusDataAddress;
+  p.setup = [source]() {
+    memcpy(Guest(kSource), source.data(), kBytes);
+    memset(Guest(kDest), 0, kBytes);
+  };
+  p.registers = {{0, 4, kSource + kBytes}, {0, 5, kDest + kBytes}};
+  p.memory = {{kDest, source}};
+  return p;
+}
+
+// ── VMX matrix multiply ─────────────────────────────────────────────────────
+
+/// C = A × B on 16×16 float matrices, four columns of C per vector: each
+/// A element is splatted and multiply-added with a row of B. The inputs
+/// are small integers, so every rounding mode gives the same exact result.
+GuestProgram VmxMatmulProgram() {
+  constexpr uint32_t kN = 16;
+  constexpr uint32_t kRepeats = 64;
+  constexpr uint32_t kA = kCorpusDataAddress;
+  constexpr uint32_t kB = kA + kN * kN * 4;
+  constexpr uint32_t kC = kB + kN * kN * 4;
+
+  GuestProgram p;
+  p.name = "vmx_matmul";
+  p.description = "16x16 float matrix multiply with vspltw and vmaddfp, x64";
+  auto& c = p.code;
+  c.push_back(li(12, kRepeats));
+  c.push_back(mtctr(12));
+  size_t repeat = c.size();
+  LoadAddress(c, 3, kA);
+  LoadAddress(c, 5, kC);
+  c.push_back(li(6, kN));
+  size_t row = c.size();
+  LoadAddress(c, 4, kB);
+  c.push_back(li(7, kN / 4));
+  size_t column = c.size();
+  c.push_back(vxor(0, 0, 0));
+  for (uint32_t kb = 0; kb < kN / 4; ++kb) {
+    c.push_back(addi(9, 3, int32_t(kb * 16)));
+    c.push_back(lvx(1, 0, 9));
+    for (uint32_t q = 0; q < 4; ++q) {
+      c.push_back(vspltw(2, 1, q));
+      c.push_back(addi(8, 4, int32_t((kb * 4 + q) * kN * 4)));
+      c.push_back(lvx(3, 0, 8));
+      c.push_back(vmaddfp(0, 2, 3, 0));
+    }
+  }
+  c.insert(c.end(), {stvx(0, 0, 5), addi(5, 5, 16), addi(4, 4, 16),
+                     addi(7, 7, -1), cmpwi(0, 7, 0)});
+  c.push_back(bne(0, To(c, column)));
+  c.insert(c.end(), {addi(3, 3, int32_t(kN * 4)), addi(6, 6, -1),
+                     cmpwi(0, 6, 0)});
+  c.push_back(bne(0, To(c, row)));
+  c.push_back(bdnz(To(c, repeat)));
+  c.push_back(blr());
+
+  std::vector<float> a(kN * kN), b(kN * kN);
+  std::mt19937 rng(93002);
+  std::uniform_int_distribution<int> value(-4, 4);
+  for (float& f : a) f = float(value(rng));
+  for (float& f : b) f = float(value(rng));
+  std::vector<uint8_t> expected;
+  for (uint32_t i = 0; i < kN; ++i) {
+    for (uint32_t j = 0; j < kN; ++j) {
+      float sum = 0;
+      for (uint32_t k = 0; k < kN; ++k) sum += a[i * kN + k] * b[k * kN + j];
+      AppendBE32(expected, FloatBits(sum));
+    }
+  }
+  p.data_size = kC + kN * kN * 4 - kCorpusDataAddress;
+  p.setup = [a, b]() {
+    for (uint32_t i = 0; i < kN * kN; ++i) {
+      StoreBE32(kA + i * 4, FloatBits(a[i]));
+      StoreBE32(kB + i * 4, FloatBits(b[i]));
+    }
+    memset(Guest(kC), 0, kN * kN * 4);
+  };
+  p.memory = {{kC, expected}};
+  return p;
+}
+
+// ── Linked-list chase ───────────────────────────────────────────────────────
+
+/// 16384 nodes of {next, value} linked in a random order over 256 KiB,
+/// walked four times: every load depends on the one before
+GuestProgram ListChaseProgram() {
+  constexpr uint32_t kNodes = 16384;
+  constexpr uint32_t kPasses = 4;
+  constexpr uint32_t kHead = kCorpusDataAddress + kNodes * 16;
+
+  GuestProgram p;
+  p.name = "list_chase";
+  p.description = "pointer chase through 16384 shuffled nodes, 4 passes";
+  auto& c = p.code;
+  LoadAddress(c, 8, kHead);
+  c.insert(c.end(), {li(4, 0), li(6, 0), li(9, kPasses), mtctr(9)});
+  size_t pass = c.size();
+  c.push_back(lwz(3, 0, 8));
+  size_t node = c.size();
+  c.insert(c.end(), {lwz(5, 4, 3), add(4, 4, 5), lwz(3, 0, 3), addi(6, 6, 1),
+                     cmpwi(0, 3, 0)});
+  c.push_back(bne(0, To(c, node)));
+  c.push_back(bdnz(To(c, pass)));
+  c.push_back(blr());
+
+  std::vector<uint32_t> order(kNodes), values(kNodes);
+  std::iota(order.begin(), order.end(), 0u);
+  std::mt19937 rng(93003);
+  std::shuffle(order.begin(), order.end(), rng);
+  uint32_t sum = 0;
+  for (uint32_t& v : values) {
+    v = uint32_t(rng());
+    sum += v;
+  }
+  p.data_size = kHead + 4 - kCorpusDataAddress;
+  p.setup = [order, values]() {
+    for (uint32_t i = 0; i < kNodes; ++i) {
+      uint32_t node = kCorpusDataAddress + order[i] * 16;
+      uint32_t next =
+          i + 1 < kNodes ? kCorpusDataAddress + order[i + 1] * 16 : 0;
+      StoreBE32(node, next);
+      StoreBE32(node + 4, values[order[i]]);
+    }
+    StoreBE32(kHead, kCorpusDataAddress + order[0] * 16);
+  };
+  p.registers = {{0, 3, 0}, {0, 4, sum * kPasses}, {0, 6, kNodes * kPasses}};
+  return p;
+}
+
+// ── Bytecode interpreter ────────────────────────────────────────────────────
+
+/// A guest-side bytecode VM: two-byte ops dispatched through a jump table
+/// with mtctr/bctr, the indirect-branch pattern of script interpreters
+GuestProgram BytecodeProgram() {
+  constexpr uint32_t kIterations = 10000;
+  constexpr uint32_t kBytecode = kCorpusDataAddress;
+  constexpr uint32_t kTable = kCorpusDataAddress + 0x100;
+  enum : uint8_t { kAdd, kMul, kXorShift, kLoop, kHalt };
+  static const uint8_t bytecode[] = {
+      kAdd, 0x35, kMul, 0x1D, kXorShift, 11, kAdd, 0x7B,
+      kXorShift, 5, kMul, 0x65, kLoop, 0, kHalt, 0,
+  };
+
+  GuestProgram p;
+  p.name = "bytecode_vm";
+  p.description = "jump-table bytecode interpreter, 7 ops x 10000 iterations";
+  auto& c = p.code;
+  c.push_back(li(3, 1));
+  LoadAddress(c, 4, kBytecode);
+  LoadAddress(c, 5, kTable);
+  c.insert(c.end(), {mr(11, 4), li(10, kIterations)});
+  size_t next = c.size();
+  c.insert(c.end(), {lbz(6, 0, 4), lbz(7, 1, 4), addi(4, 4, 2),
+                     rlwinm(6, 6, 2, 0, 29), lwzx(8, 5, 6), mtctr(8), bctr()});
+  uint32_t handlers[5];
+  handlers[kAdd] = uint32_t(c.size());
+  c.push_back(add(3, 3, 7));
+  c.push_back(b(To(c, next)));
+  handlers[kMul] = uint32_t(c.size());
+  c.push_back(mullw(3, 3, 7));
+  c.push_back(b(To(c, next)));
+  handlers[kXorShift] = uint32_t(c.size());
+  c.insert(c.end(), {srw(9, 3, 7), xor_(3, 3, 9)});
+  c.push_back(b(To(c, next)));
+  handlers[kLoop] = uint32_t(c.size());
+  c.insert(c.end(), {addi(10, 10, -1), cmpwi(0, 10, 0)});
+  c.push_back(beq(0, To(c, next)));
+  c.push_back(add(4, 11, 7));
+  c.push_back(b(To(c, next)));
+  handlers[kHalt] = uint32_t(c.size());
+  c.push_back(blr());
+
+  // The same program on the host
+  uint32_t acc = 1, count = kIterations, pc = 0;
+  for (bool running = true; running;) {
+    uint8_t op = bytecode[pc], imm = bytecode[pc + 1];
+    pc += 2;
+    switch (op) {
+      case kAdd: acc += imm; break;
+      case kMul: acc *= imm; break;
+      case kXorShift: acc ^= acc >> imm; break;
+      case kLoop: if (--count) pc = imm; break;
+      default: running = false; break;
+    }
+  }
+
+  p.data_size = kTable + sizeof(handlers) - kCorpusDataAddress;
+  p.setup = [handlers]() {
+    memcpy(Guest(kBytecode), bytecode, sizeof(bytecode));
+    for (uint32_t i = 0; i < 5; ++i) {
+      StoreBE32(kTable + i * 4, kCorpusCodeAddress + handlers[i] * 4);
+    }
+  };
+  p.registers = {{0, 3, acc}, {0, 10, 0}};
+  return p;
+}
+
+// ── lwarx / stwcx. contention ───────────────────────────────────────────────
+
+/// Four threads increment one counter with a reservation loop, time-sliced
+/// at an odd quantum so slices end between the lwarx and the stwcx.; any
+/// lost update shows in the total
+GuestProgram ContentionProgram() {
+  constexpr uint32_t kThreads = 4;
+  constexpr uint32_t kIncrements = 4000;
+  constexpr uint32_t kCounter = kCorpusDataAddress;
+
+  GuestProgram p;
+  p.name = "atomic_contention";
+  p.description = "4 threads x 4000 lwarx/stwcx. increments of one word";
+  p.threads = kThreads;
+  p.quantum = 29;
+  auto& c = p.code;
+  LoadAddress(c, 4, kCounter);
+  c.insert(c.end(), {li(5, kIncrements), mtctr(5), li(7, 0)});
+  size_t retry = c.size();
+  c.insert(c.end(), {lwarx(6, 0, 4), addi(6, 6, 1), stwcx_(6, 0, 4)});
+  c.push_back(bne(0, To(c, retry)));
+  c.push_back(addi(7, 7, 1));
+  c.push_back(bdnz(To(c, retry)));
+  // Per-thread success count at counter + 16 + index * 4
+  c.insert(c.end(), {rlwinm(8, 3, 2, 0, 29), add(8, 8, 4), stw(7, 16, 8),
+                     blr()});
+
+  p.data_size = 16 + kThreads * 4;
+  p.setup = []() { memset(Guest(kCounter), 0, 16 + kThreads * 4); };
+  std::vector<uint8_t> total, slots;
+  AppendBE32(total, kThreads * kIncrements);
+  for (uint32_t i = 0; i < kThreads; ++i) {
+    AppendBE32(slots, kIncrements);
+    p.registers.push_back({i, 7, kIncrements});
+  }
+  p.memory = {{kCounter, total}, {kCounter + 16, slots}};
+  return p;
+}
+
+// ── HLE calls ───────────────────────────────────────────────────────────────
+
+/// A tight loop of kernel calls (InterlockedIncrement through a thunk):
+/// the cost of leaving the guest and coming back
+GuestProgram HleCallProgram() {
+  constexpr uint32_t kCalls = 20000;
+  constexpr uint32_t kCounter = kCorpusDataAddress;
+  constexpr uint32_t kInterlockedIncrement = 38;
+
+  GuestProgram p;
+  p.name = "hle_calls";
+  p.description = "20000 InterlockedIncrement calls through an import thunk";
+  p.thunks = {{kCorpusThunkAddress, kInterlockedIncrement}};
+  auto& c = p.code;
+  c.push_back(mflr(29));
+  LoadAddress(c, 31, kCounter);
+  c.insert(c.end(), {li(30, 0), li(5, kCalls), mtctr(5)});
+  size_t loop = c.size();
+  c.push_back(mr(3, 31));
+  c.push_back(bl(int32_t(kCorpusThunkAddress -
+                         (kCorpusCodeAddress + c.size() * 4))));
+  c.push_back(add(30, 30, 3));
+  c.push_back(bdnz(To(c, loop)));
+  c.insert(c.end(), {mtlr(29), blr()});
+
+  p.data_size = 4;
+  p.setup = []() { StoreBE32(kCounter, 0); };
+  std::vector<uint8_t> counter;
+  AppendBE32(counter, kCalls);
+  p.registers = {{0, 30, kCalls * (kCalls + 1) / 2}};
+  p.memory = {{kCounter, counter}};
+  return p;
+}
+
+}  // namespace
+
+// ── Corpus ──────────────────────────────────────────────────────────────────
+
+std::vector<GuestProgram> BuildCorpus() {
+  std::vector<GuestProgram> corpus;
+  corpus.push_back(MemcpyProgram());
+  corpus.push_back(VmxMatmulProgram());
+  corpus.push_back(ListChaseProgram());
+  corpus.push_back(BytecodeProgram());
+  corpus.push_back(ContentionProgram());
+  corpus.push_back(HleCallProgram());
+  return corpus;
+}
+
+bool MapCorpusMemory() {
+  return xe::memory::Commit(Guest(kCorpusCodeAddress), kCorpusCodeSize,
+                            xe::memory::PageAccess::kReadWrite) &&
+         xe::memory::Commit(Guest(kCorpusDataAddress), kCorpusDataSize,
+                            xe::memory::PageAccess::kReadWrite);
+}
+
+void InstallCorpusDispatch(cpu::Processor& processor) {
+  static bool registered = false;
+  if (!registered) {
+    xe::kernel::xboxkrnl::RegisterAllExports();
+    registered = true;
+  }
+  processor.SetKernelDispatch([](cpu::ThreadState* ts, uint32_t ordinal) {
+    uint32_t args[10] = {};
+    for (int i = 0; i < 8; ++i) {
+      args[i] = static_cast<uint32_t>(ts->gpr[3 + i]);
+    }
+    ts->gpr[3] = xe::kernel::xboxkrnl::Dispatch(ordinal, args);
+  });
+}
+
+void LoadProgram(cpu::Processor& processor, const GuestProgram& program) {
+  uint32_t address = kCorpusCodeAddress;
+  for (uint32_t word : program.code) {
+    StoreBE32(address, word);
+    address += 4;
+  }
+  for (const auto& [thunk, ordinal] : program.thunks) {
+    StoreBE32(thunk, blr());
+    processor.RegisterThunk(thunk, ordinal);
+  }
+  if (program.setup) program.setup();
+}
+
+std::vector<cpu::ThreadState*> PrepareThreads(cpu::Processor& processor,
+                                              const GuestProgram& program) {
+  std::vector<cpu::ThreadState*> threads;
+  for (uint32_t i = 0; i < program.threads; ++i) {
+    cpu::ThreadState* ts = processor.CreateThreadState(i);
+    *ts = cpu::ThreadState{};
+    ts->thread_id = i;
+    ts->gpr[1] = kCorpusStackTop - i * 0x10000 - 0x100;
+    ts->gpr[3] = i;
+    ts->lr = kCorpusExitAddress;
+    ts->pc = kCorpusCodeAddress;
+    threads.push_back(ts);
+  }
+  return threads;
+}
+
+uint64_t RunInterpreted(cpu::Processor& processor, const GuestProgram& program,
+                        const std::vector<cpu::ThreadState*>& threads) {
+  std::vector<uint64_t> executed(threads.size(), 0);
+  uint64_t total = 0;
+  for (bool pending = true; pending;) {
+    pending = false;
+    for (size_t i = 0; i < threads.size(); ++i) {
+      cpu::ThreadState* ts = threads[i];
+      if (ts->pc == kCorpusExitAddress) continue;
+      uint64_t budget = program.max_instructions - executed[i];
+      if (!budget) return 0;
+      uint64_t slice = program.quantum ? std::min<uint64_t>(program.quantum,
+                                                            budget)
+                                       : budget;
+      uint64_t count = processor.ExecuteBounded(ts, ts->pc, slice);
+      if (!count) return 0;
+      executed[i] += count;
+      total += count;
+      pending |= ts->pc != kCorpusExitAddress;
+    }
+  }
+  return total;
+}
+
+bool CheckProgram(const GuestProgram& program,
+                  const std::vector<cpu::ThreadState*>& threads,
+                  std::string* error) {
+  for (size_t i = 0; i < threads.size(); ++i) {
+    if (threads[i]->pc != kCorpusExitAddress) {
+      *error = xe::fmt("thread {} stopped at 0x{:08X}", i, threads[i]->pc);
+      return false;
+    }
+  }
+  for (const auto& reg : program.registers) {
+    uint32_t value = static_cast<uint32_t>(threads[reg.thread]->gpr[reg.gpr]);
+    if (value != reg.value) {
+      *error = xe::fmt("thread {} r{} = 0x{:08X}, expected 0x{:08X}",
+                       reg.thread, reg.gpr, value, reg.value);
+      return false;
+    }
+  }
+  for (const auto& mem : program.memory) {
+    const uint8_t* actual = Guest(mem.address);
+    for (size_t i = 0; i < mem.bytes.size(); ++i) {
+      if (actual[i] != mem.bytes[i]) {
+        *error = xe::fmt("byte at 0x{:08X} = 0x{:02X}, expected 0x{:02X}",
+                         mem.address + uint32_t(i), uint32_t(actual[i]),
+                         uint32_t(mem.bytes[i]));
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+}  // namespace xe::tools
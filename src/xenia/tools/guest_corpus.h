@@ -0,0 +1,99 @@
+/**
+ * Vera360 — Xenia Edge
+ * Guest benchmark corpus — small PPC programs with known results
+ *
+ * Each program is hand-assembled (ppc_assembler.h) into a raw code blob
+ * loaded at kCorpusCodeAddress, plus the input data its setup writes at
+ * kCorpusDataAddress. Every thread enters at the first word with r3 = its
+ * index and LR = kCorpusExitAddress, and is done when it returns there.
+ * The expected registers and memory are computed on the host from the
+ * same inputs, so any execution mode can be checked against them.
+ */
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace xe::cpu {
+class Processor;
+struct ThreadState;
+}  // namespace xe::cpu
+
+namespace xe::tools {
+
+// ── Guest layout ────────────────────────────────────────────────────────────
+
+constexpr uint32_t kCorpusCodeAddress = 0x82000000;
+constexpr uint32_t kCorpusCodeSize = 0x10000;
+/// HLE thunks live at the end of the code area, past any program
+constexpr uint32_t kCorpusThunkAddress = kCorpusCodeAddress + 0xFF00;
+/// Never executed: threads stop when they return here
+constexpr uint32_t kCorpusExitAddress = kCorpusCodeAddress + 0xFFFC;
+constexpr uint32_t kCorpusDataAddress = 0x40000000;
+constexpr uint32_t kCorpusDataSize = 0x400000;
+/// Stacks grow down from here, 64 KB per thread
+constexpr uint32_t kCorpusStackTop = kCorpusDataAddress + kCorpusDataSize;
+
+struct GuestProgram {
+  std::string name;
+  std::string description;
+  std::vector<uint32_t> code;
+  /// Writes the program's input into guest memory (its first data_size
+  /// bytes of the data area)
+  std::function<void()> setup;
+  uint32_t data_size = 0;
+
+  /// Threads share the code; with more than one they are time-sliced
+  /// round-robin, quantum instructions at a time
+  uint32_t threads = 1;
+  uint32_t quantum = 0;
+  /// Runaway guard, per thread
+  uint64_t max_instructions = 50000000;
+  /// HLE thunks the code calls: address, xboxkrnl ordinal
+  std::vector<std::pair<uint32_t, uint32_t>> thunks;
+
+  /// Expected state on exit; registers compare their low word
+  struct Register {
+    uint32_t thread;
+    uint32_t gpr;
+    uint32_t value;
+  };
+  struct Memory {
+    uint32_t address;
+    std::vector<uint8_t> bytes;
+  };
+  std::vector<Register> registers;
+  std::vector<Memory> memory;
+};
+
+/// The whole corpus, built from fixed seeds
+std::vector<GuestProgram> BuildCorpus();
+
+/// Commits the code and data areas (after xe::memory::Initialize)
+bool MapCorpusMemory();
+
+/// HLE calls from the corpus go straight to the xboxkrnl exports, with the
+/// result in r3
+void InstallCorpusDispatch(cpu::Processor& processor);
+
+/// Writes the code, registers its thunks and runs its setup
+void LoadProgram(cpu::Processor& processor, const GuestProgram& program);
+
+/// Fresh thread states for a run, positioned at the entry point
+std::vector<cpu::ThreadState*> PrepareThreads(cpu::Processor& processor,
+                                              const GuestProgram& program);
+
+/// Runs every thread to its exit on the interpreter. Returns the guest
+/// instructions executed, 0 if a thread stopped elsewhere or overran.
+uint64_t RunInterpreted(cpu::Processor& processor, const GuestProgram& program,
+                        const std::vector<cpu::ThreadState*>& threads);
+
+/// Compares against the expected state; the first difference goes to error
+bool CheckProgram(const GuestProgram& program,
+                  const std::vector<cpu::ThreadState*>& threads,
+                  std::string* error);
+
+}  // namespace xe::tools
@@ -0,0 +1,308 @@
+/**
+ * Vera360 — Xenia Edge
+ * vera360-guestbench — end-to-end guest CPU benchmarks on the PPC corpus
+ *
+ *   vera360-guestbench [--filter=TEXT] [--mode=interp|jit|all]
+ *                      [--min-time=MS] [--dump=DIR] [--list]
+ *
+ * Runs every corpus program (guest_corpus.h) in each execution mode until
+ * MS milliseconds (default 500) of samples are in, checks every run
+ * against the expected registers and memory, and reports guest MIPS: the
+ * median sample and the best one. The JIT only exists on arm64 hosts; its
+ * instruction count is the interpreter's for the same program.
+ *
+ * --dump writes each program as raw blobs for other tools: <name>.bin (code,
+ * big-endian, at 0x82000000), <name>.data.bin (input at 0x40000000) and
+ * <name>.txt (entry, threads, thunks and the expected state).
+ */
+
+#include "xenia/base/memory/memory.h"
+#include "xenia/cpu/processor.h"
+#include "xenia/tools/guest_corpus.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+using xe::tools::GuestProgram;
+
+struct Mode {
+  const char* name;
+  xe::cpu::ExecMode exec;
+};
+
+constexpr Mode kModes[] = {
+    {"interp", xe::cpu::ExecMode::kInterpreter},
+#if defined(__aarch64__)
+    {"jit", xe::cpu::ExecMode::kJIT},
+#endif
+};
+
+/// Unhandled-opcode warnings and the like go to /dev/null while a program
+/// runs: a mode that logs per instruction is slow, not unreadable
+class QuietStderr {
+ public:
+  QuietStderr() {
+    fflush(stderr);
+    saved_ = dup(STDERR_FILENO);
+    int null = open("/dev/null", O_WRONLY);
+    if (null >= 0) {
+      dup2(null, STDERR_FILENO);
+      close(null);
+    }
+  }
+  ~QuietStderr() {
+    fflush(stderr);
+    if (saved_ >= 0) {
+      dup2(saved_, STDERR_FILENO);
+      close(saved_);
+    }
+  }
+
+ private:
+  int saved_ = -1;
+};
+
+struct Result {
+  bool correct = true;
+  std::string error;  // first mismatch
+  uint64_t instructions = 0;  // per run
+  double mips = 0;            // median sample
+  double mips_best = 0;
+};
+
+/// One run: fresh input, fresh threads, every thread to its exit
+double RunOnce(xe::cpu::Processor& processor, xe::cpu::ExecMode mode,
+               const GuestProgram& program, uint64_t* instructions,
+               std::vector<xe::cpu::ThreadState*>* threads) {
+  xe::tools::LoadProgram(processor, program);
+  *threads = xe::tools::PrepareThreads(processor, program);
+  auto start = std::chrono::steady_clock::now();
+  if (mode == xe::cpu::ExecMode::kInterpreter) {
+    *instructions = xe::tools::RunInterpreted(processor, program, *threads);
+  } else {
+    // Compiled code runs each thread to its return in one go
+    for (xe::cpu::ThreadState* ts : *threads) {
+      processor.Execute(ts, xe::tools::kCorpusCodeAddress);
+    }
+  }
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+Result Measure(xe::cpu::Processor& processor, xe::cpu::ExecMode mode,
+               const GuestProgram& program, uint64_t reference_instructions,
+               double min_time) {
+  Result result;
+  result.instructions = reference_instructions;
+  std::vector<double> samples;
+  double total = 0;
+  QuietStderr quiet;
+  while ((total < min_time || samples.size() < 3) && samples.size() < 1000) {
+    uint64_t instructions = reference_instructions;
+    std::vector<xe::cpu::ThreadState*> threads;
+    double seconds = RunOnce(processor, mode, program, &instructions, &threads);
+    total += seconds;
+    if (result.correct &&
+        !xe::tools::CheckProgram(program, threads, &result.error)) {
+      result.correct = false;
+    }
+    if (!instructions) {
+      result.correct = false;
+      if (result.error.empty()) result.error = "ran past its instruction limit";
+      break;
+    }
+    samples.push_back(double(instructions) / seconds / 1e6);
+  }
+  if (!samples.empty()) {
+    std::sort(samples.begin(), samples.end());
+    result.mips = samples[samples.size() / 2];
+    result.mips_best = samples.back();
+  }
+  return result;
+}
+
+// ── Dump ────────────────────────────────────────────────────────────────────
+
+bool WriteFile(const std::string& path, const void* data, size_t size) {
+  FILE* f = fopen(path.c_str(), "wb");
+  if (!f) return false;
+  bool ok = fwrite(data, 1, size, f) == size;
+  return fclose(f) == 0 && ok;
+}
+
+uint32_t Fnv1a(const std::vector<uint8_t>& bytes) {
+  uint32_t hash = 0x811C9DC5;
+  for (uint8_t byte : bytes) hash = (hash ^ byte) * 0x01000193;
+  return hash;
+}
+
+bool DumpProgram(xe::cpu::Processor& processor, const GuestProgram& program,
+                 const std::string& dir) {
+  std::string base = dir + "/" + program.name;
+  std::vector<uint8_t> code;
+  for (uint32_t word : program.code) {
+    code.insert(code.end(), {uint8_t(word >> 24), uint8_t(word >> 16),
+                             uint8_t(word >> 8), uint8_t(word)});
+  }
+  xe::tools::LoadProgram(processor, program);
+  const void* data = xe::memory::TranslateVirtual(xe::tools::kCorpusDataAddress);
+  if (!WriteFile(base + ".bin", code.data(), code.size()) ||
+      !WriteFile(base + ".data.bin", data, program.data_size)) {
+    return false;
+  }
+
+  FILE* f = fopen((base + ".txt").c_str(), "w");
+  if (!f) return false;
+  fprintf(f, "# %s\n", program.description.c_str());
+  fprintf(f, "code 0x%08X %zu\n", xe::tools::kCorpusCodeAddress, code.size());
+  fprintf(f, "data 0x%08X %u\n", xe::tools::kCorpusDataAddress,
+          program.data_size);
+  fprintf(f, "entry 0x%08X lr 0x%08X\n", xe::tools::kCorpusCodeAddress,
+          xe::tools::kCorpusExitAddress);
+  fprintf(f, "threads %u quantum %u\n", program.threads, program.quantum);
+  for (const auto& [address, ordinal] : program.thunks) {
+    fprintf(f, "thunk 0x%08X xboxkrnl %u\n", address, ordinal);
+  }
+  for (const auto& reg : program.registers) {
+    fprintf(f, "expect thread %u r%u 0x%08X\n", reg.thread, reg.gpr,
+            reg.value);
+  }
+  for (const auto& mem : program.memory) {
+    fprintf(f, "expect memory 0x%08X %zu fnv1a 0x%08X\n", mem.address,
+            mem.bytes.size(), Fnv1a(mem.bytes));
+  }
+  return fclose(f) == 0;
+}
+
+void PrintUsage() {
+  fprintf(stderr,
+          "usage: vera360-guestbench [--filter=TEXT] [--mode=interp|jit|all] "
+          "[--min-time=MS] [--dump=DIR] [--list]\n");
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::string filter;
+  std::string mode_name = "all";
+  std::string dump_dir;
+  double min_time = 0.5;
+  bool list = false;
+
+  for (int i = 1; i < argc; ++i) {
+    const char* arg = argv[i];
+    if (strncmp(arg, "--filter=", 9) == 0) {
+      filter = arg + 9;
+    } else if (strncmp(arg, "--mode=", 7) == 0) {
+      mode_name = arg + 7;
+    } else if (strncmp(arg, "--min-time=", 11) == 0) {
+      min_time = std::max(1.0, atof(arg + 11)) / 1000.0;
+    } else if (strncmp(arg, "--dump=", 7) == 0) {
+      dump_dir = arg + 7;
+    } else if (strcmp(arg, "--list") == 0) {
+      list = true;
+    } else {
+      PrintUsage();
+      return 1;
+    }
+  }
+
+  std::vector<Mode> modes;
+  for (const Mode& mode : kModes) {
+    if (mode_name == "all" || mode_name == mode.name) modes.push_back(mode);
+  }
+  if (modes.empty()) {
+    if (mode_name == "jit") {
+      fprintf(stderr, "the ARM64 JIT needs an arm64 host\n");
+    } else {
+      PrintUsage();
+    }
+    return 1;
+  }
+
+  std::vector<GuestProgram> programs;
+  for (GuestProgram& program : xe::tools::BuildCorpus()) {
+    if (filter.empty() || program.name.find(filter) != std::string::npos) {
+      programs.push_back(std::move(program));
+    }
+  }
+  if (list) {
+    for (const GuestProgram& program : programs) {
+      printf("%-20s %s\n", program.name.c_str(), program.description.c_str());
+    }
+    return 0;
+  }
+
+  if (!xe::memory::Initialize() || !xe::tools::MapCorpusMemory()) {
+    fprintf(stderr, "cannot map guest memory\n");
+    return 1;
+  }
+  // The interpreter always runs: it gives every mode its instruction count
+  auto interpreter = std::make_unique<xe::cpu::Processor>();
+  interpreter->Initialize(xe::memory::GetGuestBase(),
+                          xe::cpu::ExecMode::kInterpreter);
+  xe::tools::InstallCorpusDispatch(*interpreter);
+
+  if (!dump_dir.empty()) {
+    for (const GuestProgram& program : programs) {
+      if (!DumpProgram(*interpreter, program, dump_dir)) {
+        fprintf(stderr, "cannot write %s/%s.*\n", dump_dir.c_str(),
+                program.name.c_str());
+        xe::memory::Shutdown();
+        return 1;
+      }
+    }
+    printf("wrote %zu programs to %s\n", programs.size(), dump_dir.c_str());
+    xe::memory::Shutdown();
+    return 0;
+  }
+
+  printf("%-20s %-7s %-6s %12s %10s %10s\n", "program", "mode", "check",
+         "insn/run", "MIPS", "best MIPS");
+  int failures = 0;
+  for (const GuestProgram& program : programs) {
+    uint64_t reference = 0;
+    {
+      QuietStderr quiet;
+      std::vector<xe::cpu::ThreadState*> threads;
+      RunOnce(*interpreter, xe::cpu::ExecMode::kInterpreter, program,
+              &reference, &threads);
+    }
+    for (const Mode& mode : modes) {
+      std::unique_ptr<xe::cpu::Processor> owned;
+      xe::cpu::Processor* processor = interpreter.get();
+      if (mode.exec != xe::cpu::ExecMode::kInterpreter) {
+        owned = std::make_unique<xe::cpu::Processor>();
+        owned->Initialize(xe::memory::GetGuestBase(), mode.exec);
+        xe::tools::InstallCorpusDispatch(*owned);
+        processor = owned.get();
+      }
+      Result result = Measure(*processor, mode.exec, program, reference,
+                              min_time);
+      printf("%-20s %-7s %-6s %12llu %10.2f %10.2f\n", program.name.c_str(),
+             mode.name, result.correct ? "ok" : "FAIL",
+             static_cast<unsigned long long>(result.instructions),
+             result.mips, result.mips_best);
+      if (!result.correct) {
+        fprintf(stderr, "  %s/%s: %s\n", program.name.c_str(), mode.name,
+                result.error.c_str());
+        failures++;
+      }
+      fflush(stdout);
+    }
+  }
+  interpreter.reset();
+  xe::memory::Shutdown();
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,707 @@
+/**
+ * Vera360 — Xenia Edge
+ * vera360-xmabench — parallel XMA decode scaling
+ *
+ *   vera360-xmabench [--streams=1,8,64] [--threads=N] [--seconds=S]
+ *
+ * Plays S seconds of a synthetic 48 kHz stereo XMA stream on each of 1, 8
+ * and 64 contexts at once, first on the audio thread alone and then on a
+ * pool of N decode threads (default: one per core, up to 4). The bench acts
+ * as guest and mixer: each period it drains every output ring, re-arms the
+ * input buffers and collects the host copies. "period" is how long the
+ * audio thread was busy per period, which is what the mixer would wait on;
+ * "x realtime" is audio produced per second of wall time. The stream is
+ * generated to the frame grammar, so a frame the decoder rejects ("corrupt")
+ * fails the run.
+ */
+
+#include "xenia/apu/wma_tables.h"
+#include "xenia/apu/xma_decoder.h"
+#include "xenia/base/memory/memory.h"
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+using xe::apu::XmaContext;
+using xe::apu::XmaDecoder;
+
+constexpr uint32_t kPacketsPerBuffer = 16;
+constexpr uint32_t kRingBlocks = 31;
+constexpr uint32_t kSampleRate = 48000;
+// Input buffers are shared by every stream; each context gets its own ring
+constexpr uint32_t kScratchAddress = 0x40000000;
+constexpr uint32_t kInputBufferSize = kPacketsPerBuffer * XmaContext::kPacketSize;
+constexpr uint32_t kRingSize = kRingBlocks * XmaContext::kOutputBlockSize;
+constexpr uint32_t kRingBase = kScratchAddress + 2 * kInputBufferSize;
+constexpr uint32_t kScratchSize =
+    2 * kInputBufferSize + XmaDecoder::kContextCount * kRingSize;
+
+void PrintUsage() {
+  fprintf(stderr,
+          "usage: vera360-xmabench [--streams=1,8,64] [--threads=N] "
+          "[--seconds=S]\n");
+}
+
+uint8_t* Guest(uint32_t address) {
+  return static_cast<uint8_t*>(xe::memory::TranslateVirtual(address));
+}
+
+uint32_t LoadBE32(uint32_t address) {
+  const uint8_t* p = Guest(address);
+  return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) |
+         (uint32_t(p[2]) << 8) | p[3];
+}
+
+void StoreBE32(uint32_t address, uint32_t v) {
+  uint8_t* p = Guest(address);
+  p[0] = uint8_t(v >> 24); p[1] = uint8_t(v >> 16);
+  p[2] = uint8_t(v >> 8);  p[3] = uint8_t(v);
+}
+
+// ── Synthetic stream ─────────────────────────────────────────────────────────
+
+uint32_t Log2(uint32_t v) { return 31 - __builtin_clz(v); }
+
+/// MSB-first bit writer
+class BitWriter {
+ public:
+  void Write(uint32_t value, uint32_t count) {
+    for (uint32_t i = count; i-- > 0;) WriteBit((value >> i) & 1);
+  }
+  void WriteBit(bool bit) {
+    if (!(size_ & 7)) data_.push_back(0);
+    if (bit) data_.back() |= uint8_t(0x80 >> (size_ & 7));
+    size_++;
+  }
+  void Append(const BitWriter& other) {
+    for (uint64_t i = 0; i < other.size_; ++i) WriteBit(other.Bit(i));
+  }
+  bool Bit(uint64_t position) const {
+    return (data_[position >> 3] >> (7 - (position & 7))) & 1;
+  }
+  uint64_t size() const { return size_; }
+
+ private:
+  std::vector<uint8_t> data_;
+  uint64_t size_ = 0;
+};
+
+/// A codebook's codes, rebuilt from the lengths as the decoder does
+class CodeTable {
+ public:
+  explicit CodeTable(const xe::apu::wma::Codebook& book) : book_(book) {
+    uint64_t code = 0;
+    for (uint32_t i = 0; i < book.count; ++i) {
+      codes_.push_back(uint32_t(code));
+      code += uint64_t(1) << (32 - book.lengths[i]);
+    }
+  }
+
+  /// Write a random code, each as likely as in a stream of random bits;
+  /// returns its symbol
+  int32_t Emit(BitWriter& out, std::mt19937& rng) const {
+    uint32_t window = uint32_t(rng());
+    auto it = std::upper_bound(codes_.begin(), codes_.end(), window);
+    uint32_t entry = uint32_t(it - codes_.begin()) - 1;
+    Put(out, entry);
+    return symbol(entry);
+  }
+  /// Write the code of symbol
+  void EmitSymbol(BitWriter& out, int32_t value) const {
+    for (uint32_t i = 0; i < book_.count; ++i) {
+      if (symbol(i) == value) return Put(out, i);
+    }
+  }
+
+ private:
+  int32_t symbol(uint32_t entry) const {
+    return int32_t(book_.symbols[entry]) + book_.symbol_offset;
+  }
+  void Put(BitWriter& out, uint32_t entry) const {
+    uint32_t length = book_.lengths[entry];
+    out.Write(codes_[entry] >> (32 - length), length);
+  }
+
+  const xe::apu::wma::Codebook& book_;
+  std::vector<uint32_t> codes_;
+};
+
+/// Random frames that follow the bitstream's grammar, so the decoder does
+/// its full work on them: mixed subframe tilings, stereo transforms, DPCM
+/// and run/level coded scale factors, vector and run/level coded
+/// coefficients. Codes are drawn as they would be from random bits, with
+/// quantizers kept in a range that rarely clips.
+class FrameGenerator {
+ public:
+  static constexpr uint32_t kFrameLength = 512;
+  static constexpr uint32_t kMinSubframeLength = 128;
+
+  FrameGenerator(uint32_t channels, uint32_t sample_rate, uint32_t seed)
+      : channel_count_(channels), rng_(seed) {
+    // Band layout per block size, as the decoder derives it
+    for (uint32_t i = 0; i < 3; ++i) {
+      uint32_t length = kFrameLength >> i;
+      uint32_t offsets[30] = {};
+      uint32_t band = 1;
+      for (uint32_t x = 0; x < 28 && offsets[band - 1] < length; ++x) {
+        uint32_t offset =
+            ((length * 2 * xe::apu::wma::kCriticalFrequencies[x]) /
+                 sample_rate +
+             2) &
+            ~3u;
+        if (offset > offsets[band - 1]) offsets[band++] = offset;
+        if (offset >= length) break;
+      }
+      band_count_[i] = band - 1;
+    }
+  }
+
+  /// One frame, led by its length field
+  void Generate(BitWriter& out) {
+    BitWriter body;
+    do {
+      body = BitWriter();
+      GenerateBody(body);
+    } while (body.size() + 15 >= 0x7FFF);
+    out.Write(uint32_t(body.size() + 15), 15);
+    out.Append(body);
+  }
+
+ private:
+  struct Channel {
+    std::vector<uint32_t> lengths;
+    uint32_t current = 0;
+    uint32_t decoded = 0;
+    bool reuse_scale_factors = false;
+  };
+
+  bool Chance(uint32_t in) { return rng_() % in == 0; }
+
+  void GenerateBody(BitWriter& out) {
+    GenerateTiling(out);
+    if (channel_count_ > 1 && !Chance(2)) {
+      out.WriteBit(1);  // post-processing matrix...
+      bool matrix = Chance(2);
+      out.WriteBit(matrix);  // ...transmitted
+      if (matrix) out.Write(uint32_t(rng_()), 4 * channel_count_ * channel_count_);
+    } else if (channel_count_ > 1) {
+      out.WriteBit(0);
+    }
+    out.Write(uint32_t(rng_()), 8);  // dynamic range compression
+    out.WriteBit(0);                 // no encoder delay or padding
+
+    for (uint32_t c = 0; c < channel_count_; ++c) {
+      channels_[c].current = 0;
+      channels_[c].decoded = 0;
+      channels_[c].reuse_scale_factors = false;
+    }
+    while (GenerateSubframe(out)) {
+    }
+    out.WriteBit(Chance(2));
+    out.WriteBit(1);  // more frames follow
+  }
+
+  void GenerateTiling(BitWriter& out) {
+    bool fixed = Chance(2);
+    out.WriteBit(fixed);
+    uint32_t samples[2] = {};
+    uint32_t min_length = 0;
+    uint32_t subframe_channels = channel_count_;
+    for (uint32_t c = 0; c < channel_count_; ++c) channels_[c].lengths.clear();
+    do {
+      bool contains[2] = {};
+      bool any = false;
+      for (uint32_t c = 0; c < channel_count_; ++c) {
+        if (samples[c] != min_length) continue;
+        if (fixed || subframe_channels == 1 ||
+            min_length == kFrameLength - kMinSubframeLength) {
+          contains[c] = true;
+        } else {
+          bool last = true;
+          for (uint32_t o = c + 1; o < channel_count_; ++o) {
+            last &= samples[o] != min_length;
+          }
+          contains[c] = (last && !any) || Chance(2);
+          out.WriteBit(contains[c]);
+        }
+        any |= contains[c];
+      }
+
+      uint32_t shift = 2;
+      if (min_length != kFrameLength - kMinSubframeLength) {
+        uint32_t min_shift = min_length ? 1 : 0;
+        shift = min_shift + uint32_t(rng_() % (3 - min_shift));
+        out.WriteBit(shift != 0);
+        if (shift) out.WriteBit(shift == 2);
+      }
+      uint32_t length = kFrameLength >> shift;
+
+      min_length += length;
+      for (uint32_t c = 0; c < channel_count_; ++c) {
+        if (contains[c]) {
+          samples[c] += length;
+          channels_[c].lengths.push_back(length);
+        } else if (samples[c] <= min_length) {
+          if (samples[c] < min_length) {
+            subframe_channels = 0;
+            min_length = samples[c];
+          }
+          ++subframe_channels;
+        }
+      }
+    } while (min_length < kFrameLength);
+  }
+
+  /// false once the frame is complete
+  bool GenerateSubframe(BitWriter& out) {
+    uint32_t offset = kFrameLength;
+    uint32_t length = kFrameLength;
+    for (uint32_t c = 0; c < channel_count_; ++c) {
+      if (offset > channels_[c].decoded) {
+        offset = channels_[c].decoded;
+        length = channels_[c].lengths[channels_[c].current];
+      }
+    }
+    if (offset == kFrameLength) return false;
+    uint32_t subframe[2];
+    uint32_t count = 0;
+    for (uint32_t c = 0; c < channel_count_; ++c) {
+      Channel& channel = channels_[c];
+      if (channel.decoded == offset && channel.current < channel.lengths.size() &&
+          channel.lengths[channel.current] == length) {
+        subframe[count++] = c;
+      }
+    }
+    uint32_t table = Log2(kFrameLength / length);
+    uint32_t band_count = band_count_[table];
+
+    // Fill bits, then the reserved bit
+    bool fill = Chance(8);
+    out.WriteBit(fill);
+    if (fill) {
+      uint32_t bits = uint32_t(rng_() % 4);
+      out.Write(bits, 2);
+      if (!bits) {
+        bits = uint32_t(rng_() % 8);
+        out.Write(3, 4);
+        out.Write(bits, 3);
+        bits++;
+      }
+      out.Write(uint32_t(rng_()), bits);
+    }
+    out.WriteBit(0);
+
+    if (channel_count_ > 1) {
+      out.WriteBit(0);  // no multichannel transform
+      if (count == 2) {
+        bool transform = !Chance(3);
+        out.WriteBit(!transform);
+        if (!transform) {
+          out.WriteBit(0);
+        } else {
+          bool all_bands = Chance(2);
+          out.WriteBit(all_bands);
+          for (uint32_t b = 0; !all_bands && b < band_count; ++b) {
+            out.WriteBit(!Chance(4));
+          }
+        }
+      }
+    }
+
+    bool transmit[2];
+    bool any = false;
+    for (uint32_t i = 0; i < count; ++i) {
+      transmit[i] = !Chance(8);
+      out.WriteBit(transmit[i]);
+      any |= transmit[i];
+    }
+
+    uint32_t vector_coefficients[2] = {length, length};
+    bool vector_counts = false;
+    if (any) {
+      vector_counts = Chance(4);
+      out.WriteBit(vector_counts);
+      for (uint32_t i = 0; vector_counts && i < count; ++i) {
+        uint32_t vectors = uint32_t(rng_() % (length / 4 + 1));
+        out.Write(vectors, Log2((length + 3) / 4) + 1);
+        vector_coefficients[i] = vectors << 2;
+      }
+
+      // Quantizer: mostly within the 6-bit step, sometimes escaped below
+      if (Chance(8)) {
+        out.Write(0x20, 6);
+        for (uint32_t extra = uint32_t(rng_() % 40);; extra -= 31) {
+          out.Write(std::min(extra, 31u), 5);
+          if (extra < 31) break;
+        }
+      } else {
+        out.Write(uint32_t(-18 - int32_t(rng_() % 14)) & 0x3F, 6);
+      }
+      if (count == 2) {
+        uint32_t modifier_bits = uint32_t(rng_() % 4);
+        out.Write(modifier_bits, 3);
+        for (uint32_t i = 0; i < count; ++i) {
+          bool modified = Chance(2);
+          out.WriteBit(modified);
+          if (modified) out.Write(uint32_t(rng_()), modifier_bits);
+        }
+      }
+
+      for (uint32_t i = 0; i < count; ++i) {
+        GenerateScaleFactors(out, channels_[subframe[i]], band_count);
+      }
+    }
+
+    for (uint32_t i = 0; i < count; ++i) {
+      if (transmit[i]) {
+        GenerateCoefficients(out, length, vector_coefficients[i],
+                             vector_counts);
+      }
+    }
+
+    for (uint32_t i = 0; i < count; ++i) {
+      Channel& channel = channels_[subframe[i]];
+      channel.decoded += length;
+      channel.current++;
+    }
+    return true;
+  }
+
+  void GenerateScaleFactors(BitWriter& out, Channel& channel,
+                            uint32_t band_count) {
+    if (channel.current) {
+      bool update = Chance(2);
+      out.WriteBit(update);
+      if (!update) return;
+    }
+    if (!channel.reuse_scale_factors) {
+      out.Write(uint32_t(rng_() % 4), 2);  // step - 1
+      for (uint32_t b = 0; b < band_count; ++b) scale_.Emit(out, rng_);
+    } else {
+      for (uint32_t b = 0; b < band_count; ++b) {
+        BitWriter code;
+        int32_t index = scale_run_level_.Emit(code, rng_);
+        uint32_t run = index > 1 ? xe::apu::wma::kScaleRunLevelRun[index]
+                                 : uint32_t(rng_() % (band_count - b));
+        if (index == 1 || b + run >= band_count) {
+          scale_run_level_.EmitSymbol(out, 1);
+          break;
+        }
+        out.Append(code);
+        if (index == 0) {
+          // Escape: level, run and sign in 14 bits
+          out.Write((uint32_t(rng_() % 8) << 6) | (run << 1) |
+                        uint32_t(rng_() & 1),
+                    14);
+        } else {
+          out.WriteBit(Chance(2));
+        }
+        b += run;
+      }
+    }
+    channel.reuse_scale_factors = true;
+  }
+
+  void GenerateCoefficients(BitWriter& out, uint32_t length,
+                            uint32_t vector_coefficients, bool vector_counts) {
+    uint32_t table = uint32_t(rng_() & 1);
+    out.WriteBit(table);
+
+    uint32_t current = 0;
+    uint32_t zeros = 0;
+    bool run_level = false;
+    while ((vector_counts || !run_level) && current + 3 < vector_coefficients) {
+      uint32_t values[4];
+      int32_t index = vec4_.Emit(out, rng_);
+      if (index < 0) {
+        for (uint32_t i = 0; i < 4; i += 2) {
+          index = vec2_.Emit(out, rng_);
+          if (index < 0) {
+            for (uint32_t j = i; j < i + 2; ++j) {
+              values[j] = uint32_t(vec1_.Emit(out, rng_));
+              if (values[j] == uint32_t(xe::apu::wma::kVec1Escape)) {
+                out.WriteBit(0);  // 8-bit long value
+                out.Write(uint32_t(rng_()), 8);
+              }
+            }
+          } else {
+            values[i] = uint32_t(index) >> 4;
+            values[i + 1] = uint32_t(index) & 0xF;
+          }
+        }
+      } else {
+        values[0] = uint32_t(index) >> 12;
+        values[1] = (uint32_t(index) >> 8) & 0xF;
+        values[2] = (uint32_t(index) >> 4) & 0xF;
+        values[3] = uint32_t(index) & 0xF;
+      }
+      for (uint32_t i = 0; i < 4; ++i, ++current) {
+        if (values[i]) {
+          out.WriteBit(Chance(2));
+          zeros = 0;
+        } else {
+          run_level |= ++zeros > (length >> 8);
+        }
+      }
+    }
+
+    const CodeTable& book = coefficients_[table];
+    const uint16_t* runs =
+        table ? xe::apu::wma::kCoef1Run : xe::apu::wma::kCoef0Run;
+    uint32_t escape_bits = Log2(length - 1) + 1;
+    for (uint32_t offset = current; offset < length; ++offset) {
+      BitWriter code;
+      int32_t index = book.Emit(code, rng_);
+      if (index == 1 || (index > 1 && offset + runs[index] >= length)) {
+        book.EmitSymbol(out, 1);
+        break;
+      }
+      out.Append(code);
+      if (index == 0) {
+        out.WriteBit(0);  // 8-bit level
+        out.Write(uint32_t(rng_()), 8);
+        uint32_t left = length - 1 - offset;
+        uint32_t mode = uint32_t(rng_() % 3);
+        if (mode == 2 && left >= 4) {
+          uint32_t run = uint32_t(rng_() % (std::min(left - 4, length - 1) + 1));
+          out.Write(6, 3);
+          out.Write(run, escape_bits);
+          offset += run + 4;
+        } else if (mode == 1 && left >= 1) {
+          uint32_t run = uint32_t(rng_() % std::min(left, 4u));
+          out.Write(2, 2);
+          out.Write(run, 2);
+          offset += run + 1;
+        } else {
+          out.WriteBit(0);
+        }
+      } else {
+        offset += runs[index];
+      }
+      out.WriteBit(Chance(2));  // sign
+    }
+  }
+
+  uint32_t channel_count_;
+  std::mt19937 rng_;
+  uint32_t band_count_[3] = {};
+  Channel channels_[2];
+
+  CodeTable scale_{xe::apu::wma::kScaleCodebook};
+  CodeTable scale_run_level_{xe::apu::wma::kScaleRunLevelCodebook};
+  CodeTable coefficients_[2] = {CodeTable(xe::apu::wma::kCoefCodebooks[0]),
+                                CodeTable(xe::apu::wma::kCoefCodebooks[1])};
+  CodeTable vec4_{xe::apu::wma::kVec4Codebook};
+  CodeTable vec2_{xe::apu::wma::kVec2Codebook};
+  CodeTable vec1_{xe::apu::wma::kVec1Codebook};
+};
+
+/// Packets of generated stereo frames, frames running across packet
+/// boundaries, the last one padded
+std::vector<uint8_t> BuildStream(uint32_t packets) {
+  constexpr uint32_t kPayloadBits =
+      XmaContext::kPacketSize * 8 - XmaContext::kPacketHeaderBits;
+  FrameGenerator generator(2, kSampleRate, 360);
+
+  uint64_t total_bits = uint64_t(packets) * kPayloadBits;
+  BitWriter payload;
+  std::vector<uint64_t> starts;
+  for (;;) {
+    BitWriter frame;
+    generator.Generate(frame);
+    if (payload.size() + frame.size() > total_bits) break;
+    starts.push_back(payload.size());
+    payload.Append(frame);
+  }
+  while (payload.size() < total_bits) payload.WriteBit(1);  // padding
+
+  std::vector<uint8_t> stream(size_t(packets) * XmaContext::kPacketSize, 0);
+  for (uint32_t packet = 0; packet < packets; ++packet) {
+    uint64_t begin = uint64_t(packet) * kPayloadBits;
+    uint32_t frame_count = 0, first = 0x7FFF;
+    for (uint64_t start : starts) {
+      if (start < begin || start >= begin + kPayloadBits) continue;
+      if (!frame_count++) first = uint32_t(start - begin);
+    }
+    uint8_t* out = &stream[size_t(packet) * XmaContext::kPacketSize];
+    uint32_t header = (frame_count << 26) | (first << 11);
+    out[0] = uint8_t(header >> 24); out[1] = uint8_t(header >> 16);
+    out[2] = uint8_t(header >> 8);  out[3] = uint8_t(header);
+    for (uint32_t i = 0; i < kPayloadBits; ++i) {
+      if (payload.Bit(begin + i)) {
+        uint32_t dst = XmaContext::kPacketHeaderBits + i;
+        out[dst >> 3] |= uint8_t(0x80 >> (dst & 7));
+      }
+    }
+  }
+  return stream;
+}
+
+void KickAll(XmaDecoder& decoder, uint32_t streams) {
+  for (uint32_t bank = 0; bank * 32 < streams; ++bank) {
+    uint32_t count = std::min(32u, streams - bank * 32);
+    uint32_t bits = count == 32 ? ~0u : (1u << count) - 1;
+    decoder.HandleMmioWrite(XmaDecoder::kRegisterBase + (0x650 + bank) * 4,
+                            bits);
+  }
+}
+
+struct RunResult {
+  double wall_seconds = 0;
+  double audio_seconds = 0;  // per stream
+  double period_avg_us = 0;
+  double period_max_us = 0;
+  uint64_t host_dropped = 0;  // XmaOutput samples the "mixer" never took
+  uint64_t corrupt_frames = 0;  // rejected by the decoder: a bench bug
+};
+
+bool Run(uint32_t streams, uint32_t threads, double seconds,
+         RunResult* result) {
+  XmaDecoder decoder;
+  xe::apu::XmaDecoderOptions options;
+  options.thread_count = threads;
+  options.audio_thread = false;
+  if (!decoder.Initialize(options)) return false;
+
+  std::vector<uint32_t> contexts;
+  for (uint32_t i = 0; i < streams; ++i) {
+    uint32_t context = decoder.AllocateContext();
+    if (!context) return false;
+    contexts.push_back(context);
+    StoreBE32(context + 0, kPacketsPerBuffer | (1u << 20) | (1u << 21) |
+                               (kRingBlocks << 22));
+    StoreBE32(context + 4, kPacketsPerBuffer | (3u << 27) | (1u << 29) |
+                               (1u << 31));
+    StoreBE32(context + 20, kScratchAddress);
+    StoreBE32(context + 24, kScratchAddress + kInputBufferSize);
+    StoreBE32(context + 28, kRingBase + i * kRingSize);
+  }
+  KickAll(decoder, streams);
+
+  uint64_t target = uint64_t(seconds * kSampleRate) * streams;
+  uint64_t periods = 0;
+  double period_total = 0;
+  auto start = std::chrono::steady_clock::now();
+  while (decoder.stats().samples < target) {
+    auto period_start = std::chrono::steady_clock::now();
+    decoder.DecodePeriod();
+    double period = std::chrono::duration<double, std::micro>(
+                        std::chrono::steady_clock::now() - period_start)
+                        .count();
+    period_total += period;
+    result->period_max_us = std::max(result->period_max_us, period);
+    periods++;
+
+    // Stragglers finish before the guest side touches the contexts
+    while (!decoder.idle()) sched_yield();
+    for (uint32_t i = 0; i < streams; ++i) {
+      uint32_t context = contexts[i];
+      uint32_t d0 = LoadBE32(context + 0);
+      // Drain the ring, hand back consumed input buffers
+      StoreBE32(context + 36, (d0 >> 27) & 0x1F);
+      StoreBE32(context + 0, d0 | (1u << 20) | (1u << 21));
+      StoreBE32(context + 4, LoadBE32(context + 4) | (1u << 31));
+
+      xe::apu::XmaOutput* output = decoder.context_output(context);
+      if (output->Acquire()) output->Release();
+    }
+    KickAll(decoder, streams);
+  }
+  result->wall_seconds = std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+  result->audio_seconds =
+      double(decoder.stats().samples) / streams / kSampleRate;
+  result->period_avg_us = periods ? period_total / periods : 0;
+  result->corrupt_frames = decoder.stats().corrupt_frames;
+  for (uint32_t context : contexts) {
+    result->host_dropped += decoder.context_output(context)->dropped_samples();
+  }
+
+  for (uint32_t context : contexts) decoder.ReleaseContext(context);
+  decoder.Shutdown();
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::vector<uint32_t> stream_counts = {1, 8, 64};
+  uint32_t threads = 0;
+  double seconds = 10.0;
+
+  for (int i = 1; i < argc; ++i) {
+    const char* arg = argv[i];
+    if (strncmp(arg, "--streams=", 10) == 0) {
+      stream_counts.clear();
+      for (const char* p = arg + 10; *p;) {
+        char* end;
+        uint32_t count = uint32_t(strtoul(p, &end, 10));
+        if (!count || count > XmaDecoder::kContextCount ||
+            (*end && *end != ',')) {
+          PrintUsage();
+          return 1;
+        }
+        stream_counts.push_back(count);
+        p = *end ? end + 1 : end;
+      }
+    } else if (strncmp(arg, "--threads=", 10) == 0) {
+      threads = uint32_t(std::max(1, atoi(arg + 10)));
+    } else if (strncmp(arg, "--seconds=", 10) == 0) {
+      seconds = std::max(0.1, atof(arg + 10));
+    } else {
+      PrintUsage();
+      return 1;
+    }
+  }
+  if (!threads) {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    threads = uint32_t(std::clamp(cores, 1l, 4l));
+  }
+
+  if (!xe::memory::Initialize() ||
+      !xe::memory::Commit(Guest(kScratchAddress), kScratchSize,
+                          xe::memory::PageAccess::kReadWrite)) {
+    fprintf(stderr, "cannot map guest memory\n");
+    return 1;
+  }
+  std::vector<uint8_t> stream = BuildStream(2 * kPacketsPerBuffer);
+  memcpy(Guest(kScratchAddress), stream.data(), stream.size());
+
+  printf("%7s %7s %10s %11s %11s %11s %8s %8s %8s\n", "streams", "threads",
+         "wall ms", "x realtime", "period us", "worst us", "speedup",
+         "dropped", "corrupt");
+  int failures = 0;
+  for (uint32_t streams : stream_counts) {
+    double serial_wall = 0;
+    std::vector<uint32_t> thread_counts = {1};
+    if (threads > 1) thread_counts.push_back(threads);
+    for (uint32_t count : thread_counts) {
+      RunResult result;
+      if (!Run(streams, count, seconds, &result)) {
+        fprintf(stderr, "%u streams: cannot set up the contexts\n", streams);
+        failures++;
+        break;
+      }
+      if (count == 1) serial_wall = result.wall_seconds;
+      printf("%7u %7u %10.1f %11.1f %11.1f %11.1f %7.2fx %8llu %8llu\n",
+             streams, count, result.wall_seconds * 1000.0,
+             result.audio_seconds * streams / result.wall_seconds,
+             result.period_avg_us, result.period_max_us,
+             serial_wall / result.wall_seconds,
+             static_cast<unsigned long long>(result.host_dropped),
+             static_cast<unsigned long long>(result.corrupt_frames));
+      if (result.corrupt_frames) failures++;
+    }
+  }
+  xe::memory::Shutdown();
+  return failures ? 1 : 0;
+}
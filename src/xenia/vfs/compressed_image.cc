@@ -0,0 +1,550 @@
+/**
+ * Vera360 — Xenia Edge
+ * Compressed Disc Image — block cache reader and ISO converter
+ */
+
+#include "xenia/vfs/compressed_image.h"
+#include "xenia/base/logging.h"
+#include "xenia/base/lz4.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace xe::vfs {
+
+namespace {
+
+/// Decompressed blocks kept resident (shared by all open files)
+constexpr uint64_t kCacheBytes = 8 * 1024 * 1024;
+constexpr size_t kMinCacheSlots = 16;
+constexpr uint32_t kMaxDecodeJobs = 4;
+/// Converter: blocks handed to each encoder job per batch
+constexpr uint32_t kBlocksPerThreadBatch = 16;
+
+bool IsPowerOfTwo(uint32_t v) { return v && !(v & (v - 1)); }
+
+uint32_t OnlineCoreCount() {
+  long cores = sysconf(_SC_NPROCESSORS_ONLN);
+  return cores > 0 ? static_cast<uint32_t>(cores) : 1;
+}
+
+bool IsZeroBlock(const uint8_t* data, size_t length) {
+  size_t i = 0;
+  for (; i + 8 <= length; i += 8) {
+    uint64_t v;
+    memcpy(&v, data + i, 8);
+    if (v) return false;
+  }
+  for (; i < length; ++i) {
+    if (data[i]) return false;
+  }
+  return true;
+}
+
+/// Word-at-a-time content hash for dedupe (collisions are re-checked)
+uint64_t HashBlock(const uint8_t* data, size_t length) {
+  uint64_t h = 0xCBF29CE484222325ull ^ length;
+  size_t i = 0;
+  for (; i + 8 <= length; i += 8) {
+    uint64_t v;
+    memcpy(&v, data + i, 8);
+    h = (h ^ v) * 0x100000001B3ull;
+    h ^= h >> 29;
+  }
+  for (; i < length; ++i) h = (h ^ data[i]) * 0x100000001B3ull;
+  return h;
+}
+
+bool PWriteAll(int fd, const void* data, size_t length, uint64_t offset) {
+  auto* p = static_cast<const uint8_t*>(data);
+  while (length) {
+    ssize_t n = pwrite(fd, p, length, static_cast<off_t>(offset));
+    if (n <= 0) return false;
+    p += n;
+    length -= static_cast<size_t>(n);
+    offset += static_cast<uint64_t>(n);
+  }
+  return true;
+}
+
+}  // namespace
+
+// ── Reader ───────────────────────────────────────────────────────────────────
+
+bool CompressedImageSource::IsCompressedImage(const uint8_t* data,
+                                              uint64_t size) {
+  if (size < sizeof(uint32_t)) return false;
+  uint32_t magic;
+  memcpy(&magic, data, 4);
+  return magic == kCompressedImageMagic;
+}
+
+std::unique_ptr<CompressedImageSource> CompressedImageSource::Open(
+    std::unique_ptr<MappedFile> file) {
+  if (file->size() < sizeof(CompressedImageHeader) ||
+      !IsCompressedImage(file->data(), file->size())) {
+    return nullptr;
+  }
+
+  CompressedImageHeader header;
+  memcpy(&header, file->data(), sizeof(header));
+  if (header.version != kCompressedImageVersion ||
+      header.codec != uint32_t(CompressedImageCodec::kLz4) ||
+      !IsPowerOfTwo(header.block_size) ||
+      header.block_size < kCompressedImageMinBlockSize ||
+      header.block_size > kCompressedImageMaxBlockSize) {
+    XELOGW("Compressed image: unsupported header in {}", file->path());
+    return nullptr;
+  }
+  if (header.index_offset > file->size() ||
+      header.block_count > (file->size() - header.index_offset) /
+                               sizeof(CompressedBlockEntry)) {
+    XELOGW("Compressed image: truncated index in {}", file->path());
+    return nullptr;
+  }
+  // image_size is untrusted: divide rather than round up, which could wrap
+  uint64_t expected_blocks = header.image_size / header.block_size +
+                             (header.image_size % header.block_size != 0);
+  if (header.block_count != expected_blocks) {
+    XELOGW("Compressed image: image size does not match the index in {}",
+           file->path());
+    return nullptr;
+  }
+
+  std::vector<CompressedBlockEntry> index(header.block_count);
+  memcpy(index.data(), file->data() + header.index_offset,
+         index.size() * sizeof(CompressedBlockEntry));
+
+  // Validate every payload up front so block reads never bounds-check
+  size_t max_payload = xe::lz4::CompressBound(header.block_size);
+  for (uint64_t i = 0; i < index.size(); ++i) {
+    const auto& e = index[i];
+    size_t length = static_cast<size_t>(std::min<uint64_t>(
+        header.block_size, header.image_size - i * header.block_size));
+    bool valid = false;
+    switch (e.flags) {
+      case kCompressedBlockZero:
+        valid = true;
+        break;
+      case kCompressedBlockStored:
+        valid = e.size == length;
+        break;
+      case kCompressedBlockCodec:
+        valid = e.size <= max_payload;
+        break;
+    }
+    if (!valid || e.offset > header.index_offset ||
+        e.size > header.index_offset - e.offset) {
+      XELOGW("Compressed image: bad index entry {} in {}", i, file->path());
+      return nullptr;
+    }
+  }
+
+  auto source = std::unique_ptr<CompressedImageSource>(
+      new CompressedImageSource(std::move(file), header, std::move(index)));
+  XELOGI("Compressed image: {} blocks of {} KiB, {} cache slots, {} decode "
+         "jobs", source->header_.block_count, source->header_.block_size / 1024,
+         source->slots_.size(), source->max_jobs_);
+  return source;
+}
+
+CompressedImageSource::CompressedImageSource(
+    std::unique_ptr<MappedFile> file, const CompressedImageHeader& header,
+    std::vector<CompressedBlockEntry> index)
+    : file_(std::move(file)), header_(header), index_(std::move(index)) {
+  size_t slot_count = std::max<size_t>(
+      kMinCacheSlots, static_cast<size_t>(kCacheBytes / header_.block_size));
+  slots_.resize(slot_count);
+  for (auto& slot : slots_) slot.data.resize(header_.block_size);
+  slot_map_.reserve(slot_count);
+  // Leave one core for the guest thread that is waiting on the read
+  uint32_t cores = OnlineCoreCount();
+  max_jobs_ = std::min(kMaxDecodeJobs, cores > 1 ? cores - 1 : 0);
+}
+
+CompressedImageSource::~CompressedImageSource() {
+  mutex_.Lock();
+  shutting_down_ = true;
+  mutex_.Unlock();
+  xe::threading::JobSystem::Shared().Wait(jobs_);
+}
+
+void CompressedImageSource::DecodeQueued() {
+  mutex_.Lock();
+  while (!queue_.empty() && !shutting_down_) {
+    uint64_t block = queue_.front();
+    queue_.pop_front();
+    if (slot_map_.count(block)) continue;  // A reader got there first
+    CacheSlot* slot = AcquireSlot(block);
+    if (!slot) continue;
+    mutex_.Unlock();
+    bool decoded = DecodeBlock(block, slot->data.data());
+    mutex_.Lock();
+    ReleaseSlot(slot, decoded);
+  }
+  running_jobs_--;
+  mutex_.Unlock();
+}
+
+size_t CompressedImageSource::BlockLength(uint64_t block) const {
+  return static_cast<size_t>(std::min<uint64_t>(
+      header_.block_size, header_.image_size - block * header_.block_size));
+}
+
+bool CompressedImageSource::DecodeBlock(uint64_t block, uint8_t* dest) const {
+  const auto& e = index_[block];
+  size_t length = BlockLength(block);
+  switch (e.flags) {
+    case kCompressedBlockZero:
+      memset(dest, 0, length);
+      return true;
+    case kCompressedBlockStored:
+      memcpy(dest, file_->data() + e.offset, length);
+      return true;
+    default:
+      if (!xe::lz4::Decompress(file_->data() + e.offset, e.size, dest,
+                               length)) {
+        XELOGE("Compressed image: block {} is corrupt", block);
+        return false;
+      }
+      return true;
+  }
+}
+
+CompressedImageSource::CacheSlot* CompressedImageSource::AcquireSlot(
+    uint64_t block) {
+  // Free slot first, else the least recently used decoded one. Slots that
+  // are still being decoded are pinned.
+  CacheSlot* victim = nullptr;
+  for (auto& slot : slots_) {
+    if (slot.block == kNoBlock) {
+      victim = &slot;
+      break;
+    }
+    if (slot.ready && (!victim || slot.last_use < victim->last_use)) {
+      victim = &slot;
+    }
+  }
+  if (!victim) return nullptr;
+  if (victim->block != kNoBlock) slot_map_.erase(victim->block);
+  victim->block = block;
+  victim->ready = false;
+  victim->last_use = ++use_clock_;
+  slot_map_[block] = victim;
+  return victim;
+}
+
+void CompressedImageSource::ReleaseSlot(CacheSlot* slot, bool decoded) {
+  if (decoded) {
+    slot->ready = true;
+  } else {
+    slot_map_.erase(slot->block);
+    slot->block = kNoBlock;
+  }
+  slot_ready_.NotifyAll();
+}
+
+void CompressedImageSource::QueueBlocks(uint64_t first, uint64_t count) {
+  if (!max_jobs_) return;
+  size_t max_queued = slots_.size() / 2;
+  uint64_t end = std::min(first + count, header_.block_count);
+  bool queued = false;
+  for (uint64_t block = first; block < end; ++block) {
+    if (queue_.size() >= max_queued) break;
+    if (index_[block].flags != kCompressedBlockCodec) continue;
+    if (slot_map_.count(block)) continue;
+    if (std::find(queue_.begin(), queue_.end(), block) != queue_.end()) {
+      continue;
+    }
+    queue_.push_back(block);
+    queued = true;
+  }
+  if (!queued) return;
+  // Running jobs keep draining the queue; add more up to the cap
+  uint32_t wanted = static_cast<uint32_t>(
+      std::min<size_t>(max_jobs_, queue_.size()));
+  xe::threading::JobOptions options;
+  options.name = "vci_decode";
+  options.counter = &jobs_;
+  for (; running_jobs_ < wanted; ++running_jobs_) {
+    xe::threading::JobSystem::Shared().Submit([this]() { DecodeQueued(); },
+                                              options);
+  }
+}
+
+bool CompressedImageSource::ReadBlock(uint64_t block, size_t offset,
+                                      uint8_t* dest, size_t length) {
+  // Zero and stored blocks are served straight from the index / mapping
+  const auto& e = index_[block];
+  if (e.flags == kCompressedBlockZero) {
+    memset(dest, 0, length);
+    return true;
+  }
+  if (e.flags == kCompressedBlockStored) {
+    memcpy(dest, file_->data() + e.offset + offset, length);
+    return true;
+  }
+
+  mutex_.Lock();
+  while (true) {
+    auto it = slot_map_.find(block);
+    if (it != slot_map_.end()) {
+      CacheSlot* slot = it->second;
+      if (!slot->ready) {
+        slot_ready_.Wait(mutex_);
+        continue;  // Re-lookup: the decode may have failed
+      }
+      memcpy(dest, slot->data.data() + offset, length);
+      slot->last_use = ++use_clock_;
+      mutex_.Unlock();
+      return true;
+    }
+
+    CacheSlot* slot = AcquireSlot(block);
+    if (!slot) {
+      // Every slot is mid-decode; decode privately rather than wait
+      mutex_.Unlock();
+      std::vector<uint8_t> scratch(header_.block_size);
+      if (!DecodeBlock(block, scratch.data())) return false;
+      memcpy(dest, scratch.data() + offset, length);
+      return true;
+    }
+    mutex_.Unlock();
+    bool decoded = DecodeBlock(block, slot->data.data());
+    mutex_.Lock();
+    ReleaseSlot(slot, decoded);
+    if (decoded) memcpy(dest, slot->data.data() + offset, length);
+    mutex_.Unlock();
+    return decoded;
+  }
+}
+
+bool CompressedImageSource::Read(uint64_t offset, void* buffer,
+                                 size_t length) {
+  if (offset > header_.image_size || length > header_.image_size - offset) {
+    return false;
+  }
+  if (!length) return true;
+
+  uint64_t block_size = header_.block_size;
+  uint64_t first = offset / block_size;
+  uint64_t last = (offset + length - 1) / block_size;
+  if (last > first) {
+    // Large requests: workers decode the tail while we decode the head
+    mutex_.Lock();
+    QueueBlocks(first + 1, last - first);
+    mutex_.Unlock();
+  }
+
+  auto* dest = static_cast<uint8_t*>(buffer);
+  for (uint64_t block = first; block <= last; ++block) {
+    uint64_t block_start = block * block_size;
+    size_t in_block = static_cast<size_t>(offset - block_start);
+    size_t chunk = std::min<size_t>(length, BlockLength(block) - in_block);
+    if (!ReadBlock(block, in_block, dest, chunk)) return false;
+    dest += chunk;
+    offset += chunk;
+    length -= chunk;
+  }
+  return true;
+}
+
+void CompressedImageSource::Prefetch(uint64_t offset, uint64_t length) {
+  if (offset >= header_.image_size || !length) return;
+  length = std::min(length, header_.image_size - offset);
+  uint64_t first = offset / header_.block_size;
+  uint64_t last = (offset + length - 1) / header_.block_size;
+
+  // A deduplicated block points back at an earlier payload, anywhere in
+  // the file: advise each run of back-to-back payloads on its own rather
+  // than one span that could cover most of the image
+  uint64_t run_start = 0, run_end = 0;
+  for (uint64_t block = first; block <= last; ++block) {
+    const auto& e = index_[block];
+    if (e.flags == kCompressedBlockZero || !e.size) continue;
+    if (run_end > run_start && e.offset == run_end) {
+      run_end += e.size;
+      continue;
+    }
+    if (run_end > run_start) {
+      file_->Advise(run_start, run_end - run_start,
+                    MappedFile::AccessHint::kWillNeed);
+    }
+    run_start = e.offset;
+    run_end = e.offset + e.size;
+  }
+  if (run_end > run_start) {
+    file_->Advise(run_start, run_end - run_start,
+                  MappedFile::AccessHint::kWillNeed);
+  }
+
+  mutex_.Lock();
+  QueueBlocks(first, last - first + 1);
+  mutex_.Unlock();
+}
+
+// ── Writer ───────────────────────────────────────────────────────────────────
+
+namespace {
+
+struct EncodedBlock {
+  std::vector<uint8_t> payload;
+  uint32_t flags = kCompressedBlockZero;
+  uint64_t hash = 0;
+};
+
+void EncodeBlock(const uint8_t* src, size_t length, bool dedupe,
+                 EncodedBlock* out) {
+  if (IsZeroBlock(src, length)) {
+    out->flags = kCompressedBlockZero;
+    out->payload.clear();
+    return;
+  }
+  if (dedupe) out->hash = HashBlock(src, length);
+  out->payload.resize(xe::lz4::CompressBound(length));
+  size_t size = xe::lz4::Compress(src, length, out->payload.data(),
+                                  out->payload.size());
+  if (size == 0 || size >= length) {
+    out->flags = kCompressedBlockStored;
+    out->payload.assign(src, src + length);
+  } else {
+    out->flags = kCompressedBlockCodec;
+    out->payload.resize(size);
+  }
+}
+
+}  // namespace
+
+bool CompressDiscImage(const std::string& input_path,
+                       const std::string& output_path,
+                       const CompressImageOptions& options,
+                       const CompressImageProgress& progress) {
+  uint32_t block_size = options.block_size;
+  if (!IsPowerOfTwo(block_size) || block_size < kCompressedImageMinBlockSize ||
+      block_size > kCompressedImageMaxBlockSize) {
+    XELOGE("Compress: invalid block size {}", block_size);
+    return false;
+  }
+
+  auto input = MappedFile::Open(input_path);
+  if (!input) {
+    XELOGE("Compress: cannot open {}", input_path);
+    return false;
+  }
+  if (CompressedImageSource::IsCompressedImage(input->data(), input->size())) {
+    XELOGE("Compress: {} is already compressed", input_path);
+    return false;
+  }
+  input->Advise(0, input->size(), MappedFile::AccessHint::kSequential);
+
+  int fd = open(output_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                0644);
+  if (fd < 0) {
+    XELOGE("Compress: cannot create {}", output_path);
+    return false;
+  }
+
+  CompressedImageHeader header = {};
+  header.magic = kCompressedImageMagic;
+  header.version = kCompressedImageVersion;
+  header.block_size = block_size;
+  header.codec = uint32_t(CompressedImageCodec::kLz4);
+  header.image_size = input->size();
+  header.block_count = (input->size() + block_size - 1) / block_size;
+
+  uint32_t thread_count =
+      options.thread_count ? options.thread_count : OnlineCoreCount();
+  uint32_t batch_size = thread_count * kBlocksPerThreadBatch;
+  std::vector<EncodedBlock> batch(batch_size);
+  std::vector<CompressedBlockEntry> index(header.block_count);
+  std::unordered_map<uint64_t, uint64_t> first_with_hash;
+  uint64_t file_offset = sizeof(CompressedImageHeader);
+  uint64_t zero_blocks = 0, duplicate_blocks = 0;
+  bool ok = true;
+
+  auto block_length = [&](uint64_t block) {
+    return static_cast<size_t>(std::min<uint64_t>(
+        block_size, header.image_size - block * block_size));
+  };
+  auto block_data = [&](uint64_t block) {
+    return input->data() + block * block_size;
+  };
+
+  for (uint64_t base = 0; ok && base < header.block_count;
+       base += batch_size) {
+    uint32_t count = static_cast<uint32_t>(
+        std::min<uint64_t>(batch_size, header.block_count - base));
+
+    // Encode the batch in parallel: job t takes blocks t, t+n, t+2n…
+    auto encode = [&](uint32_t t) {
+      for (uint32_t i = t; i < count; i += thread_count) {
+        EncodeBlock(block_data(base + i), block_length(base + i),
+                    options.dedupe, &batch[i]);
+      }
+    };
+    xe::threading::JobOptions encode_options;
+    encode_options.name = "vci_encode";
+    xe::threading::JobSystem::Shared().ParallelFor(thread_count, encode,
+                                                   encode_options);
+
+    // Emit in image order so payloads stay sorted by offset
+    for (uint32_t i = 0; ok && i < count; ++i) {
+      uint64_t block = base + i;
+      const EncodedBlock& encoded = batch[i];
+      if (encoded.flags == kCompressedBlockZero) {
+        index[block] = {0, 0, kCompressedBlockZero};
+        ++zero_blocks;
+        continue;
+      }
+      if (options.dedupe) {
+        auto [it, inserted] = first_with_hash.try_emplace(encoded.hash, block);
+        if (!inserted) {
+          uint64_t prior = it->second;
+          if (block_length(prior) == block_length(block) &&
+              memcmp(block_data(prior), block_data(block),
+                     block_length(block)) == 0) {
+            index[block] = index[prior];
+            ++duplicate_blocks;
+            continue;
+          }
+        }
+      }
+      ok = PWriteAll(fd, encoded.payload.data(), encoded.payload.size(),
+                     file_offset);
+      index[block] = {file_offset, uint32_t(encoded.payload.size()),
+                      encoded.flags};
+      file_offset += encoded.payload.size();
+    }
+
+    if (progress) {
+      progress(std::min<uint64_t>((base + count) * block_size,
+                                  header.image_size),
+               header.image_size);
+    }
+  }
+
+  // Index is 8-byte aligned; header goes last so a partial file never
+  // carries a valid magic
+  header.index_offset = (file_offset + 7) & ~uint64_t(7);
+  ok = ok &&
+       PWriteAll(fd, index.data(), index.size() * sizeof(CompressedBlockEntry),
+                 header.index_offset) &&
+       PWriteAll(fd, &header, sizeof(header), 0) && fsync(fd) == 0;
+  close(fd);
+  if (!ok) {
+    XELOGE("Compress: write to {} failed", output_path);
+    unlink(output_path.c_str());
+    return false;
+  }
+
+  uint64_t output_size =
+      header.index_offset + index.size() * sizeof(CompressedBlockEntry);
+  XELOGI("Compress: {} -> {} ({} MiB -> {} MiB, {} zero / {} duplicate blocks)",
+         input_path, output_path, header.image_size >> 20, output_size >> 20,
+         zero_blocks, duplicate_blocks);
+  return true;
+}
+
+}  // namespace xe::vfs
@@ -0,0 +1,154 @@
+/**
+ * Vera360 — Xenia Edge
+ * Compressed Disc Image — block-compressed container for Xbox 360 ISOs
+ *
+ * File layout (little-endian):
+ *   CompressedImageHeader (64 bytes)
+ *   block payloads, in image order (duplicates stored once)
+ *   index: block_count × CompressedBlockEntry (16 bytes)
+ *
+ * Every block expands to block_size bytes (the last one may be shorter), so
+ * any image offset maps to one index lookup. Zero-filled blocks — the bulk
+ * of the padding on redump XGD2/XGD3 images — take no payload at all.
+ *
+ * Reads go through a shared LRU cache of decompressed blocks. Multi-block
+ * requests and Prefetch queue blocks to jobs on the shared job system so
+ * LZ4 decoding overlaps with flash reads and with the guest; readahead for
+ * sequential access is Prefetch from each open file, which tracks its own
+ * position (DiscImageDevice), so interleaved streams do not defeat it.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "xenia/base/job_system.h"
+#include "xenia/base/mapped_file.h"
+#include "xenia/base/threading.h"
+#include "xenia/vfs/disc_image_source.h"
+
+namespace xe::vfs {
+
+/// "VCI1" — Vera360 Compressed Image
+constexpr uint32_t kCompressedImageMagic = 0x31494356;
+constexpr uint32_t kCompressedImageVersion = 1;
+constexpr uint32_t kCompressedImageDefaultBlockSize = 64 * 1024;
+constexpr uint32_t kCompressedImageMinBlockSize = 4 * 1024;
+constexpr uint32_t kCompressedImageMaxBlockSize = 1024 * 1024;
+
+enum class CompressedImageCodec : uint32_t {
+  kLz4 = 1,
+};
+
+struct CompressedImageHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t block_size;       // Power of two
+  uint32_t codec;            // CompressedImageCodec
+  uint64_t image_size;       // Uncompressed size
+  uint64_t block_count;
+  uint64_t index_offset;     // File offset of the block index
+  uint8_t  reserved[24];
+};
+static_assert(sizeof(CompressedImageHeader) == 64);
+
+enum CompressedBlockFlags : uint32_t {
+  kCompressedBlockCodec  = 0,  // Payload is codec-compressed
+  kCompressedBlockStored = 1,  // Payload is the raw block (incompressible)
+  kCompressedBlockZero   = 2,  // No payload, block is all zeros
+};
+
+struct CompressedBlockEntry {
+  uint64_t offset;  // File offset of the payload
+  uint32_t size;    // Payload size
+  uint32_t flags;   // CompressedBlockFlags
+};
+static_assert(sizeof(CompressedBlockEntry) == 16);
+
+// ── Reader ───────────────────────────────────────────────────────────────────
+
+class CompressedImageSource : public DiscImageSource {
+ public:
+  /// Magic check on the first bytes of a file (at least 4)
+  static bool IsCompressedImage(const uint8_t* data, uint64_t size);
+
+  /// Validate the header and index; nullptr if the container is malformed
+  static std::unique_ptr<CompressedImageSource> Open(
+      std::unique_ptr<MappedFile> file);
+
+  ~CompressedImageSource() override;
+
+  uint64_t size() const override { return header_.image_size; }
+  bool Read(uint64_t offset, void* buffer, size_t length) override;
+  void Prefetch(uint64_t offset, uint64_t length) override;
+
+  uint32_t block_size() const { return header_.block_size; }
+  uint64_t block_count() const { return header_.block_count; }
+
+ private:
+  struct CacheSlot {
+    uint64_t block = kNoBlock;
+    uint64_t last_use = 0;
+    bool ready = false;  // false + block set = being decoded
+    std::vector<uint8_t> data;
+  };
+  static constexpr uint64_t kNoBlock = ~0ull;
+
+  CompressedImageSource(std::unique_ptr<MappedFile> file,
+                        const CompressedImageHeader& header,
+                        std::vector<CompressedBlockEntry> index);
+
+  /// Job: decode queued blocks until the queue is empty
+  void DecodeQueued();
+
+  size_t BlockLength(uint64_t block) const;
+  /// Expand one block into dest (block_size bytes); no locking
+  bool DecodeBlock(uint64_t block, uint8_t* dest) const;
+  /// Copy part of a block out of the cache, decoding it if needed
+  bool ReadBlock(uint64_t block, size_t offset, uint8_t* dest, size_t length);
+
+  // Called with mutex_ held
+  CacheSlot* AcquireSlot(uint64_t block);
+  void ReleaseSlot(CacheSlot* slot, bool decoded);
+  void QueueBlocks(uint64_t first, uint64_t count);
+
+  std::unique_ptr<MappedFile> file_;
+  CompressedImageHeader header_;
+  std::vector<CompressedBlockEntry> index_;
+
+  xe::threading::Mutex mutex_;
+  xe::threading::ConditionVariable slot_ready_;
+  std::vector<CacheSlot> slots_;
+  std::unordered_map<uint64_t, CacheSlot*> slot_map_;
+  std::deque<uint64_t> queue_;
+  uint64_t use_clock_ = 0;
+  bool shutting_down_ = false;
+  uint32_t max_jobs_ = 0;      // DecodeQueued jobs allowed in flight
+  uint32_t running_jobs_ = 0;  // queued or running
+  xe::threading::JobCounter jobs_;
+};
+
+// ── Writer ───────────────────────────────────────────────────────────────────
+
+struct CompressImageOptions {
+  uint32_t block_size = kCompressedImageDefaultBlockSize;
+  uint32_t thread_count = 0;  // 0 = one per core
+  bool dedupe = true;         // Store identical blocks once
+};
+
+/// (bytes consumed, total bytes)
+using CompressImageProgress = std::function<void(uint64_t, uint64_t)>;
+
+/// Convert a raw ISO into the compressed container
+bool CompressDiscImage(const std::string& input_path,
+                       const std::string& output_path,
+                       const CompressImageOptions& options,
+                       const CompressImageProgress& progress = nullptr);
+
+}  // namespace xe::vfs
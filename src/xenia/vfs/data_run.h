@@ -0,0 +1,52 @@
+/**
+ * Vera360 — Xenia Edge
+ * Data runs — a file's blocks coalesced into contiguous host byte ranges
+ *
+ * Container formats (STFS, SVOD) scatter file data across blocks with hash
+ * tables in between. Devices resolve a file's block chain once into runs so
+ * a read becomes a binary search plus one memcpy per run it touches.
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace xe::vfs {
+
+struct DataRun {
+  uint64_t file_offset;    // Offset within the guest file
+  uint64_t source_offset;  // Offset within the backing host file
+  uint64_t length;
+  uint32_t source;         // Backing file index (multi-file containers)
+};
+
+/// Append a block, merging it into the previous run when it directly
+/// follows it in the same backing file
+inline void AppendDataRun(std::vector<DataRun>& runs, uint64_t file_offset,
+                          uint32_t source, uint64_t source_offset,
+                          uint64_t length) {
+  if (!runs.empty()) {
+    DataRun& last = runs.back();
+    if (last.source == source &&
+        last.source_offset + last.length == source_offset &&
+        last.file_offset + last.length == file_offset) {
+      last.length += length;
+      return;
+    }
+  }
+  runs.push_back({file_offset, source_offset, length, source});
+}
+
+/// Run containing a file offset, or runs.size() if past the end
+inline size_t FindDataRun(const std::vector<DataRun>& runs, uint64_t offset) {
+  auto it = std::upper_bound(
+      runs.begin(), runs.end(), offset,
+      [](uint64_t value, const DataRun& run) { return value < run.file_offset; });
+  if (it == runs.begin()) return runs.size();
+  size_t index = static_cast<size_t>(it - runs.begin()) - 1;
+  const DataRun& run = runs[index];
+  return offset < run.file_offset + run.length ? index : runs.size();
+}
+
+}  // namespace xe::vfs
@@ -3,59 +3,219 @@
  * Disc Image Device — reads Xbox 360 ISO/XISO disc images (.iso, .xex)
  */
 
+#include "xenia/vfs/disc_image_device.h"
 #include "xenia/base/logging.h"
+#include "xenia/base/memory/memory.h"
+#include <algorithm>
 #include <string>
-#include <fstream>
 #include <cstdint>
 #include <cstring>
+#include <vector>
 
 namespace xe::vfs {
 
-/// Xbox 360 XISO magic at sector 32
-constexpr uint32_t kXisoMagic = 0x58534631;  // "XSF1" — Microsoft XDFS
+namespace {
 
-class DiscImageDevice {
+/// Known game-partition offsets: XISO, XGD3, XGD2, XGD1 (redump layouts)
+constexpr uint64_t kGamePartitionOffsets[] = {
+    0x00000000, 0x02080000, 0x0FD90000, 0x18300000,
+};
+constexpr uint64_t kVolumeDescriptorOffset = 32 * kXdvdfsSectorSize;
+constexpr size_t kMaxDirectoryDepth = 32;
+
+/// Sequential readers get this much read-ahead past the current request
+constexpr uint64_t kReadAheadSize = 4 * 1024 * 1024;
+
+inline uint32_t LE32(const uint8_t* p) {
+  return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) |
+         (uint32_t(p[3]) << 24);
+}
+inline uint64_t LE64(const uint8_t* p) {
+  return uint64_t(LE32(p)) | (uint64_t(LE32(p + 4)) << 32);
+}
+
+/// Locate the XDVDFS volume descriptor; returns false if none matches
+bool FindGamePartition(DiscImageSource& image, uint64_t* game_offset) {
+  char magic[20];
+  for (uint64_t base : kGamePartitionOffsets) {
+    uint64_t off = base + kVolumeDescriptorOffset;
+    if (off + kXdvdfsSectorSize > image.size()) continue;
+    if (image.Read(off, magic, sizeof(magic)) &&
+        memcmp(magic, kXdvdfsMagic, sizeof(magic)) == 0) {
+      *game_offset = base;
+      return true;
+    }
+  }
+  return false;
+}
+
+class DiscImageFile : public VfsFile {
  public:
-  DiscImageDevice(const std::string& path) : path_(path) {}
+  DiscImageFile(VfsEntry* entry, DiscImageDevice* device)
+      : VfsFile(entry), device_(device) {}
 
-  bool Initialize() {
-    file_.open(path_, std::ios::binary);
-    if (!file_.is_open()) {
-      XELOGW("Failed to open disc image: {}", path_);
+  bool Read(void* buffer, size_t length, uint64_t offset,
+            size_t* bytes_read) override {
+    // Streaming readers (movies, audio banks, level loads) get the next
+    // window fetched while the guest consumes this one
+    if (offset == next_sequential_offset_ && offset != 0) {
+      device_->Prefetch(entry(), offset + length, kReadAheadSize);
+    }
+    if (!device_->ReadEntry(entry(), offset, buffer, length, bytes_read)) {
       return false;
     }
-
-    // Check XISO header at sector 32 (0x10000)
-    file_.seekg(0x10000);
-    uint8_t header[0x14];
-    file_.read(reinterpret_cast<char*>(header), sizeof(header));
-
-    uint32_t magic;
-    memcpy(&magic, header, 4);
-    // Xbox uses big-endian
-    // But the actual disc format magic may be little-endian
-    
-    XELOGI("Disc image opened: {}", path_);
-    valid_ = true;
+    next_sequential_offset_ = offset + *bytes_read;
     return true;
   }
 
-  bool ReadSectors(uint64_t offset, uint8_t* buffer, size_t size) {
-    if (!file_.is_open()) return false;
-    file_.seekg(static_cast<std::streamoff>(offset));
-    file_.read(reinterpret_cast<char*>(buffer), static_cast<std::streamsize>(size));
-    return file_.gcount() == static_cast<std::streamsize>(size);
+  bool MapInto(void* dest, size_t length, uint64_t offset) override {
+    return device_->MapEntryInto(entry(), offset, dest, length);
   }
 
-  void Shutdown() {
-    if (file_.is_open()) file_.close();
-    XELOGI("Disc image closed");
+  const uint8_t* mapped_data() const override {
+    return device_->EntryData(entry());
   }
 
  private:
-  std::string path_;
-  std::ifstream file_;
-  bool valid_ = false;
+  DiscImageDevice* device_;
+  uint64_t next_sequential_offset_ = 0;
 };
 
+}  // namespace
+
+DiscImageDevice::DiscImageDevice(std::string_view mount_path,
+                                 std::string_view image_path)
+    : VfsDevice(mount_path), image_path_(image_path) {}
+
+DiscImageDevice::~DiscImageDevice() = default;
+
+bool DiscImageDevice::IsDiscImage(const std::string& path) {
+  auto image = DiscImageSource::Open(path);
+  uint64_t game_offset = 0;
+  return image && FindGamePartition(*image, &game_offset);
+}
+
+bool DiscImageDevice::Initialize() {
+  source_ = DiscImageSource::Open(image_path_);
+  if (!source_) {
+    XELOGW("Failed to open disc image: {}", image_path_);
+    return false;
+  }
+
+  if (!FindGamePartition(*source_, &game_offset_)) {
+    XELOGW("Not a valid XDVDFS image: {}", image_path_);
+    return false;
+  }
+
+  // Volume descriptor: magic[20], root sector (LE32), root size (LE32),
+  // creation FILETIME (LE64)
+  uint8_t descriptor[0x24];
+  if (!source_->Read(game_offset_ + kVolumeDescriptorOffset, descriptor,
+                     sizeof(descriptor))) {
+    return false;
+  }
+  uint32_t root_sector = LE32(descriptor + 0x14);
+  uint32_t root_size = LE32(descriptor + 0x18);
+  uint64_t timestamp = LE64(descriptor + 0x1C);
+
+  VfsEntry* root = ResetTree();
+  root->set_timestamps(timestamp, timestamp);
+  if (!ParseDirectory(root, root_sector, root_size, 0)) {
+    XELOGW("Disc image: failed to parse root directory");
+    return false;
+  }
+
+  XELOGI("Disc image opened: {} (partition @0x{:X}, {} entries)", image_path_,
+         game_offset_, entry_count());
+  return true;
+}
+
+bool DiscImageDevice::ParseDirectory(VfsEntry* parent, uint32_t sector,
+                                     uint32_t length, int depth) {
+  if (length == 0) return true;  // Empty directory
+  if (depth > static_cast<int>(kMaxDirectoryDepth)) return false;
+
+  uint64_t table_offset = game_offset_ + uint64_t(sector) * kXdvdfsSectorSize;
+  if (table_offset + length > source_->size()) return false;
+  std::vector<uint8_t> table_copy;
+  const uint8_t* table;
+  if (source_->data()) {
+    table = source_->data() + table_offset;
+  } else {
+    table_copy.resize(length);
+    if (!source_->Read(table_offset, table_copy.data(), length)) return false;
+    table = table_copy.data();
+  }
+
+  WalkXdvdfsDirectory(table, length, [&](const XdvdfsDirent& dirent) {
+    bool is_dir = (dirent.attributes & kFileAttributeDirectory) != 0;
+    auto* entry = AddEntry(parent, std::make_unique<VfsEntry>(
+                                       this, parent, dirent.name, is_dir));
+    entry->set_timestamps(parent->create_timestamp(),
+                          parent->write_timestamp());
+    if (is_dir) {
+      ParseDirectory(entry, dirent.sector, dirent.size, depth + 1);
+    } else {
+      entry->set_size(dirent.size);
+      entry->set_allocation_size(
+          (uint64_t(dirent.size) + kXdvdfsSectorSize - 1) &
+          ~uint64_t(kXdvdfsSectorSize - 1));
+      entry->set_data_offset(game_offset_ +
+                             uint64_t(dirent.sector) * kXdvdfsSectorSize);
+    }
+  });
+  return true;
+}
+
+const uint8_t* DiscImageDevice::EntryData(const VfsEntry* entry) const {
+  if (!source_->data() ||
+      entry->data_offset() + entry->size() > source_->size()) {
+    return nullptr;
+  }
+  return source_->data() + entry->data_offset();
+}
+
+bool DiscImageDevice::ReadEntry(const VfsEntry* entry, uint64_t offset,
+                                void* buffer, size_t length,
+                                size_t* bytes_read) {
+  *bytes_read = 0;
+  if (offset >= entry->size()) return true;
+  size_t to_read =
+      static_cast<size_t>(std::min<uint64_t>(length, entry->size() - offset));
+  if (const uint8_t* src = EntryData(entry)) {
+    memcpy(buffer, src + offset, to_read);
+  } else if (!source_->Read(entry->data_offset() + offset, buffer, to_read)) {
+    return false;  // Truncated or corrupt image
+  }
+  *bytes_read = to_read;
+  return true;
+}
+
+bool DiscImageDevice::MapEntryInto(const VfsEntry* entry, uint64_t offset,
+                                   void* dest, size_t length) {
+  // Never map past EOF: the tail of the last page belongs to other files
+  if (offset + length > entry->size() || !EntryData(entry) ||
+      source_->fd() < 0) {
+    return false;
+  }
+  return xe::memory::MapFileView(dest, length, source_->fd(),
+                                 entry->data_offset() + offset);
+}
+
+void DiscImageDevice::Prefetch(const VfsEntry* entry, uint64_t offset,
+                               uint64_t length) {
+  if (offset >= entry->size()) return;
+  length = std::min(length, entry->size() - offset);
+  source_->Prefetch(entry->data_offset() + offset, length);
+}
+
+std::unique_ptr<VfsFile> DiscImageDevice::OpenFile(VfsEntry* entry,
+                                                   FileAccess access,
+                                                   bool truncate) {
+  if (entry->is_directory() || access != FileAccess::kRead || truncate) {
+    return nullptr;
+  }
+  return std::make_unique<DiscImageFile>(entry, this);
+}
+
 }  // namespace xe::vfs
@@ -0,0 +1,67 @@
+/**
+ * Vera360 — Xenia Edge
+ * Disc Image Device — Xbox 360 XDVDFS (GDF) disc images (.iso)
+ *
+ * The game partition may start at several offsets depending on how the
+ * image was dumped (XGD2/XGD3 redump, trimmed XISO). Raw images are mapped
+ * once; the directory tree is parsed straight out of the mapping and file
+ * reads are a single memcpy from the mapping into the destination (or a
+ * page remap when the request is page aligned). Block-compressed images
+ * (see compressed_image.h) are read through their block cache instead.
+ */
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "xenia/vfs/disc_image_source.h"
+#include "xenia/vfs/vfs_device.h"
+#include "xenia/vfs/xdvdfs.h"
+
+namespace xe::vfs {
+
+class DiscImageDevice : public VfsDevice {
+ public:
+  DiscImageDevice(std::string_view mount_path, std::string_view image_path);
+  ~DiscImageDevice() override;
+
+  bool Initialize() override;
+
+  std::unique_ptr<VfsFile> OpenFile(VfsEntry* entry, FileAccess access,
+                                    bool truncate) override;
+
+  uint64_t total_bytes() const override {
+    return source_ ? source_->size() : 0;
+  }
+
+  /// Pointer to an entry's bytes inside the mapping (nullptr if the image
+  /// is compressed or truncated)
+  const uint8_t* EntryData(const VfsEntry* entry) const;
+
+  /// Read raw bytes of an entry (offset relative to the file start)
+  bool ReadEntry(const VfsEntry* entry, uint64_t offset, void* buffer,
+                 size_t length, size_t* bytes_read);
+
+  /// Remap whole pages of an entry over dest (copy-on-write, raw only)
+  bool MapEntryInto(const VfsEntry* entry, uint64_t offset, void* dest,
+                    size_t length);
+
+  /// Start fetching (and decompressing) an entry range ahead of use
+  void Prefetch(const VfsEntry* entry, uint64_t offset, uint64_t length);
+
+  /// Probe a host file (raw or compressed) for an XDVDFS volume without
+  /// mounting it
+  static bool IsDiscImage(const std::string& path);
+
+ private:
+  bool ParseDirectory(VfsEntry* parent, uint32_t sector, uint32_t length,
+                      int depth);
+
+  std::string image_path_;
+  std::unique_ptr<DiscImageSource> source_;
+  uint64_t game_offset_ = 0;
+};
+
+}  // namespace xe::vfs
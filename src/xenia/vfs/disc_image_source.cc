@@ -0,0 +1,41 @@
+/**
+ * Vera360 — Xenia Edge
+ * Disc Image Source — raw backend and format detection
+ */
+
+#include "xenia/vfs/disc_image_source.h"
+#include "xenia/vfs/compressed_image.h"
+#include "xenia/base/logging.h"
+#include <cstring>
+#include <utility>
+
+namespace xe::vfs {
+
+std::unique_ptr<DiscImageSource> DiscImageSource::Open(
+    const std::string& path) {
+  auto file = MappedFile::Open(path);
+  if (!file) return nullptr;
+  if (CompressedImageSource::IsCompressedImage(file->data(), file->size())) {
+    return CompressedImageSource::Open(std::move(file));
+  }
+  return std::make_unique<RawImageSource>(std::move(file));
+}
+
+RawImageSource::RawImageSource(std::unique_ptr<MappedFile> file)
+    : file_(std::move(file)) {
+  // File data is read in arbitrary order; only explicit prefetches and
+  // sequential streams should trigger read-ahead
+  file_->Advise(0, file_->size(), MappedFile::AccessHint::kRandom);
+}
+
+bool RawImageSource::Read(uint64_t offset, void* buffer, size_t length) {
+  if (offset > file_->size() || length > file_->size() - offset) return false;
+  memcpy(buffer, file_->data() + offset, length);
+  return true;
+}
+
+void RawImageSource::Prefetch(uint64_t offset, uint64_t length) {
+  file_->Advise(offset, length, MappedFile::AccessHint::kWillNeed);
+}
+
+}  // namespace xe::vfs
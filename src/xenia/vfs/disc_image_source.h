@@ -0,0 +1,61 @@
+/**
+ * Vera360 — Xenia Edge
+ * Disc Image Source — byte-addressable backing store for disc images
+ *
+ * DiscImageDevice parses XDVDFS through this interface so the same device
+ * serves plain ISOs (mapped, zero-copy) and block-compressed images
+ * (decompressed on demand through a block cache).
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "xenia/base/mapped_file.h"
+
+namespace xe::vfs {
+
+class DiscImageSource {
+ public:
+  virtual ~DiscImageSource() = default;
+
+  /// Uncompressed image size in bytes
+  virtual uint64_t size() const = 0;
+
+  /// Copy image bytes [offset, offset + length); false if out of range or
+  /// the backing data is corrupt
+  virtual bool Read(uint64_t offset, void* buffer, size_t length) = 0;
+
+  /// Whole image as one contiguous mapping (raw images only, else nullptr)
+  virtual const uint8_t* data() const { return nullptr; }
+  /// Descriptor whose pages can be remapped 1:1 (raw images only, else -1)
+  virtual int fd() const { return -1; }
+
+  /// Hint that a range will be read soon
+  virtual void Prefetch(uint64_t offset, uint64_t length) {
+    (void)offset; (void)length;
+  }
+
+  /// Open a raw or compressed image, picking the backend from its header
+  static std::unique_ptr<DiscImageSource> Open(const std::string& path);
+};
+
+// ── Raw image ────────────────────────────────────────────────────────────────
+
+class RawImageSource : public DiscImageSource {
+ public:
+  explicit RawImageSource(std::unique_ptr<MappedFile> file);
+
+  uint64_t size() const override { return file_->size(); }
+  bool Read(uint64_t offset, void* buffer, size_t length) override;
+  const uint8_t* data() const override { return file_->data(); }
+  int fd() const override { return file_->fd(); }
+  void Prefetch(uint64_t offset, uint64_t length) override;
+
+ private:
+  std::unique_ptr<MappedFile> file_;
+};
+
+}  // namespace xe::vfs
@@ -3,51 +3,190 @@
  * Host Path Device — maps guest FS paths to Android host paths
  */
 
+#include "xenia/vfs/host_path_device.h"
 #include "xenia/base/logging.h"
 #include <string>
 #include <cstdio>
 #include <sys/stat.h>
+#include <sys/statvfs.h>
 #include <dirent.h>
+#include <fcntl.h>
 #include <unistd.h>
 #include <cerrno>
+#include <cstring>
 
 namespace xe::vfs {
 
-class HostPathDevice {
+namespace {
+
+/// Unix epoch → FILETIME (100ns ticks since 1601-01-01)
+uint64_t ToFileTime(const struct timespec& ts) {
+  constexpr uint64_t kUnixEpochAsFileTime = 116444736000000000ull;
+  return kUnixEpochAsFileTime + uint64_t(ts.tv_sec) * 10000000ull +
+         uint64_t(ts.tv_nsec) / 100;
+}
+
+void FillFromStat(VfsEntry* entry, const struct stat& st) {
+  if (!entry->is_directory()) {
+    entry->set_size(static_cast<uint64_t>(st.st_size));
+    entry->set_allocation_size(static_cast<uint64_t>(st.st_blocks) * 512);
+  }
+  entry->set_timestamps(ToFileTime(st.st_ctim), ToFileTime(st.st_mtim));
+}
+
+class HostPathFile : public VfsFile {
  public:
-  HostPathDevice(const std::string& mount, const std::string& host_root)
-      : mount_path_(mount), host_root_(host_root) {}
+  HostPathFile(VfsEntry* entry, int fd) : VfsFile(entry), fd_(fd) {}
+  ~HostPathFile() override { close(fd_); }
 
-  bool Initialize() {
-    struct stat st;
-    if (stat(host_root_.c_str(), &st) != 0 || !S_ISDIR(st.st_mode)) {
-      XELOGW("Host path does not exist or is not a directory: {}", host_root_);
+  bool Read(void* buffer, size_t length, uint64_t offset,
+            size_t* bytes_read) override {
+    ssize_t n = pread(fd_, buffer, length, static_cast<off_t>(offset));
+    if (n < 0) {
+      *bytes_read = 0;
+      return false;
+    }
+    *bytes_read = static_cast<size_t>(n);
+    return true;
+  }
+
+  bool Write(const void* buffer, size_t length, uint64_t offset,
+             size_t* bytes_written) override {
+    ssize_t n = pwrite(fd_, buffer, length, static_cast<off_t>(offset));
+    if (n < 0) {
+      *bytes_written = 0;
       return false;
     }
-    XELOGI("Host path device: {} -> {}", mount_path_, host_root_);
+    *bytes_written = static_cast<size_t>(n);
+    if (offset + *bytes_written > entry()->size()) {
+      entry()->set_size(offset + *bytes_written);
+    }
     return true;
   }
 
-  std::string ResolvePath(const std::string& relative) const {
-    return host_root_ + "/" + relative;
+  bool SetLength(uint64_t length) override {
+    if (ftruncate(fd_, static_cast<off_t>(length)) != 0) return false;
+    entry()->set_size(length);
+    return true;
   }
 
-  bool FileExists(const std::string& path) const {
-    std::string full = ResolvePath(path);
-    return access(full.c_str(), F_OK) == 0;
+ private:
+  int fd_;
+};
+
+}  // namespace
+
+HostPathDevice::HostPathDevice(std::string_view mount_path,
+                               std::string_view host_root, bool read_only)
+    : VfsDevice(mount_path), host_root_(host_root), read_only_(read_only) {}
+
+HostPathDevice::~HostPathDevice() = default;
+
+bool HostPathDevice::Initialize() {
+  struct stat st;
+  if (stat(host_root_.c_str(), &st) != 0 || !S_ISDIR(st.st_mode)) {
+    XELOGW("Host path does not exist or is not a directory: {}", host_root_);
+    return false;
   }
+  VfsEntry* root = ResetTree();
+  FillFromStat(root, st);
+  root->set_needs_listing(true);
+  ListDirectory(root);
+  XELOGI("Host path device: {} -> {} ({} top-level entries)", mount_path_,
+         host_root_, root->children().size());
+  return true;
+}
 
-  uint64_t FileSize(const std::string& path) const {
+void HostPathDevice::ListChildren(VfsEntry* parent) {
+  std::string host_dir = HostPathFor(parent);
+  DIR* dir = opendir(host_dir.c_str());
+  if (!dir) return;
+  int dir_fd = dirfd(dir);
+  struct dirent* de;
+  while ((de = readdir(dir)) != nullptr) {
+    if (strcmp(de->d_name, ".") == 0 || strcmp(de->d_name, "..") == 0) {
+      continue;
+    }
     struct stat st;
-    if (stat(ResolvePath(path).c_str(), &st) == 0) {
-      return static_cast<uint64_t>(st.st_size);
+    if (fstatat(dir_fd, de->d_name, &st, 0) != 0) continue;
+    bool is_dir = S_ISDIR(st.st_mode);
+    if (!is_dir && !S_ISREG(st.st_mode)) continue;
+
+    auto* entry = AddEntry(parent, std::make_unique<VfsEntry>(
+                                       this, parent, de->d_name, is_dir));
+    FillFromStat(entry, st);
+    entry->set_needs_listing(is_dir);
+  }
+  closedir(dir);
+}
+
+std::string HostPathDevice::HostPathFor(const VfsEntry* entry) const {
+  std::string result = host_root_;
+  if (!entry->path().empty()) {
+    result.push_back('/');
+    size_t start = result.size();
+    result += entry->path();
+    for (size_t i = start; i < result.size(); ++i) {
+      if (result[i] == '\\') result[i] = '/';
     }
-    return 0;
   }
+  return result;
+}
 
- private:
-  std::string mount_path_;
-  std::string host_root_;
-};
+std::unique_ptr<VfsFile> HostPathDevice::OpenFile(VfsEntry* entry,
+                                                  FileAccess access,
+                                                  bool truncate) {
+  if (entry->is_directory()) return nullptr;
+  bool writable = access == FileAccess::kReadWrite && !read_only_;
+  if ((access == FileAccess::kReadWrite || truncate) && !writable) {
+    return nullptr;
+  }
+  int flags = writable ? O_RDWR : O_RDONLY;
+  if (truncate) flags |= O_TRUNC;
+  std::string host_path = HostPathFor(entry);
+  int fd = open(host_path.c_str(), flags | O_CLOEXEC);
+  if (fd < 0) {
+    XELOGW("HostPathDevice: open() failed: {} (errno={})", host_path, errno);
+    return nullptr;
+  }
+  if (truncate) entry->set_size(0);
+  return std::make_unique<HostPathFile>(entry, fd);
+}
+
+VfsEntry* HostPathDevice::CreateChild(VfsEntry* parent, std::string_view name,
+                                      bool is_directory) {
+  // Listing it later would add the new entry a second time
+  ListDirectoryLocked(parent);
+  auto entry = std::make_unique<VfsEntry>(this, parent, name, is_directory);
+  std::string host_path = HostPathFor(entry.get());
+  if (is_directory) {
+    if (mkdir(host_path.c_str(), 0777) != 0 && errno != EEXIST) {
+      XELOGW("HostPathDevice: mkdir() failed: {} (errno={})", host_path, errno);
+      return nullptr;
+    }
+  } else {
+    int fd = open(host_path.c_str(), O_CREAT | O_WRONLY | O_CLOEXEC, 0666);
+    if (fd < 0) {
+      XELOGW("HostPathDevice: create failed: {} (errno={})", host_path, errno);
+      return nullptr;
+    }
+    close(fd);
+  }
+  struct stat st;
+  if (stat(host_path.c_str(), &st) == 0) FillFromStat(entry.get(), st);
+  return AddEntry(parent, std::move(entry));
+}
+
+uint64_t HostPathDevice::total_bytes() const {
+  struct statvfs vfs;
+  if (statvfs(host_root_.c_str(), &vfs) != 0) return 0;
+  return uint64_t(vfs.f_blocks) * vfs.f_frsize;
+}
+
+uint64_t HostPathDevice::free_bytes() const {
+  struct statvfs vfs;
+  if (statvfs(host_root_.c_str(), &vfs) != 0) return 0;
+  return uint64_t(vfs.f_bavail) * vfs.f_frsize;
+}
 
 }  // namespace xe::vfs
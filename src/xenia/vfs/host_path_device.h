@@ -0,0 +1,49 @@
+/**
+ * Vera360 — Xenia Edge
+ * Host Path Device — maps a guest device path onto a host directory
+ *
+ * Directories are listed lazily: each one the first time a lookup or an
+ * enumeration reaches it, so mounting a large tree ($HOME, for a loose
+ * XEX) costs nothing up front and a symlink loop only unrolls as far as
+ * the paths the guest asks for. Afterwards lookups go through the device
+ * index and only file data I/O reaches the host. Entries created by the
+ * guest are added to the index as they are made.
+ */
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include "xenia/vfs/vfs_device.h"
+
+namespace xe::vfs {
+
+class HostPathDevice : public VfsDevice {
+ public:
+  HostPathDevice(std::string_view mount_path, std::string_view host_root,
+                 bool read_only = false);
+  ~HostPathDevice() override;
+
+  bool Initialize() override;
+  bool is_read_only() const override { return read_only_; }
+
+  std::unique_ptr<VfsFile> OpenFile(VfsEntry* entry, FileAccess access,
+                                    bool truncate) override;
+
+  uint64_t total_bytes() const override;
+  uint64_t free_bytes() const override;
+
+  const std::string& host_root() const { return host_root_; }
+  /// Host path for an entry (entry paths keep the on-disk casing)
+  std::string HostPathFor(const VfsEntry* entry) const;
+
+ private:
+  void ListChildren(VfsEntry* dir) override;
+  VfsEntry* CreateChild(VfsEntry* parent, std::string_view name,
+                        bool is_directory) override;
+
+  std::string host_root_;
+  bool read_only_;
+};
+
+}  // namespace xe::vfs
@@ -1,66 +1,566 @@
 /**
  * Vera360 — Xenia Edge
- * STFS Container — reads Xbox 360 STFS/SVOD containers (game packages)
+ * STFS Container — reads Xbox 360 STFS containers (game packages, DLC, TUs)
  */
 
+#include "xenia/vfs/stfs_container.h"
+#include "xenia/base/cvar.h"
+#include "xenia/base/job_system.h"
 #include "xenia/base/logging.h"
+#include "xenia/base/memory/memory.h"
+#include "xenia/base/sha1.h"
+#include <algorithm>
 #include <string>
 #include <vector>
-#include <fstream>
 #include <cstdint>
 #include <cstring>
 
 namespace xe::vfs {
 
-/// STFS header magic values
-constexpr uint32_t kStfsMagicCon  = 0x434F4E20;  // "CON "
-constexpr uint32_t kStfsMagicLive = 0x4C495645;  // "LIVE"
-constexpr uint32_t kStfsMagicPirs = 0x50495253;  // "PIRS"
+DEFINE_bool(stfs_verify_hashes, false,
+            "Check STFS data blocks against their SHA-1 hash tables in the "
+            "background as files are opened");
 
-struct StfsHeader {
-  uint32_t magic;
-  char display_name[0x80];
-  uint32_t content_type;
-  uint32_t title_id;
-};
+namespace {
+
+constexpr uint32_t kFileRecordSize = 0x40;
+constexpr uint32_t kFileRecordsPerBlock = kStfsBlockSize / kFileRecordSize;
+constexpr uint32_t kHashEntrySize = 0x18;
+constexpr uint32_t kBlocksPerLevel1 =
+    kStfsBlocksPerHashTable * kStfsBlocksPerHashTable;  // 0x70E4
+/// Hash entry status bit: the lower-level table lives in the second copy
+constexpr uint8_t kHashEntryActiveIndex = 0x40;
+
+/// Verifier jobs in flight, and blocks each takes from the queue per lock
+constexpr uint32_t kMaxVerifyJobs = 2;
+constexpr uint32_t kVerifyBatchBlocks = 32;
 
-class StfsContainer {
+constexpr uint8_t kFileFlagContiguous = 0x40;
+constexpr uint8_t kFileFlagDirectory  = 0x80;
+
+inline uint32_t BE32(const uint8_t* p) {
+  return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) |
+         (uint32_t(p[2]) << 8) | p[3];
+}
+inline uint32_t BE24(const uint8_t* p) {
+  return (uint32_t(p[0]) << 16) | (uint32_t(p[1]) << 8) | p[2];
+}
+inline uint32_t LE24(const uint8_t* p) {
+  return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16);
+}
+inline uint16_t BE16(const uint8_t* p) { return uint16_t((p[0] << 8) | p[1]); }
+
+class StfsFile : public VfsFile {
  public:
-  StfsContainer(const std::string& path) : path_(path) {}
+  StfsFile(VfsEntry* entry, StfsContainerDevice* device)
+      : VfsFile(entry), device_(device) {}
+
+  bool Read(void* buffer, size_t length, uint64_t offset,
+            size_t* bytes_read) override {
+    return device_->ReadEntry(entry(), offset, buffer, length, bytes_read);
+  }
+
+  bool MapInto(void* dest, size_t length, uint64_t offset) override {
+    return device_->MapEntryInto(entry(), offset, dest, length);
+  }
+
+  const uint8_t* mapped_data() const override {
+    return device_->EntryData(entry());
+  }
+
+ private:
+  StfsContainerDevice* device_;
+};
+
+}  // namespace
+
+StfsContainerDevice::StfsContainerDevice(std::string_view mount_path,
+                                         std::string_view package_path)
+    : VfsDevice(mount_path), package_path_(package_path) {}
+
+StfsContainerDevice::~StfsContainerDevice() {
+  verify_mutex_.Lock();
+  verify_shutdown_ = true;
+  verify_mutex_.Unlock();
+  xe::threading::JobSystem::Shared().Wait(verify_counter_);
+}
+
+bool StfsContainerDevice::IsStfsPackage(const std::string& path) {
+  auto file = MappedFile::Open(path);
+  if (!file || file->size() < 4) return false;
+  uint32_t m = BE32(file->data());
+  return m == kStfsMagicCon || m == kStfsMagicLive || m == kStfsMagicPirs;
+}
+
+bool StfsContainerDevice::Initialize() {
+  package_ = MappedFile::Open(package_path_);
+  if (!package_) {
+    XELOGW("Failed to open STFS container: {}", package_path_);
+    return false;
+  }
+  package_identity_ = VerifiedCache::FileIdentity(package_path_);
+  if (package_->size() < kStfsHeaderReadSize) {
+    XELOGW("STFS container too small: {}", package_path_);
+    return false;
+  }
+  const uint8_t* header = package_->data();
+
+  magic_ = BE32(header);
+  if (magic_ != kStfsMagicCon && magic_ != kStfsMagicLive &&
+      magic_ != kStfsMagicPirs) {
+    XELOGW("Not a valid STFS container (magic=0x{:08X})", magic_);
+    return false;
+  }
 
-  bool Open() {
-    std::ifstream f(path_, std::ios::binary);
-    if (!f.is_open()) {
-      XELOGW("Failed to open STFS container: {}", path_);
-      return false;
+  header_size_ = BE32(header + kStfsHeaderSizeOffset);
+  content_type_ = BE32(header + kStfsContentTypeOffset);
+  title_id_ = BE32(header + kStfsTitleIdOffset);
+
+  uint8_t descriptor_type = header[kStfsDescriptorTypeOffset];
+  if (descriptor_type != 0) {
+    XELOGW("STFS: package uses an SVOD volume; mount it with "
+           "SvodContainerDevice");
+    return false;
+  }
+
+  // Volume descriptor; the file table fields are little-endian
+  const uint8_t* vd = header + kStfsVolumeDescriptorOffset;
+  descriptor_.descriptor_size = vd[0];
+  descriptor_.version = vd[1];
+  descriptor_.block_separation = vd[2];
+  descriptor_.file_table_block_count = uint16_t(vd[3] | (vd[4] << 8));
+  descriptor_.file_table_block_number = LE24(vd + 5);
+  memcpy(descriptor_.top_hash_table_hash, vd + 8, 20);
+  descriptor_.allocated_block_count = BE32(vd + 0x1C);
+  descriptor_.unallocated_block_count = BE32(vd + 0x20);
+
+  first_hash_table_offset_ = (uint64_t(header_size_) + 0xFFF) & ~0xFFFull;
+  table_shift_ = (descriptor_.block_separation & 1) ? 0 : 1;
+
+  // Chains run through metadata-only blocks first (file table) and then
+  // through file data, so parse every table before touching either
+  if (!ParseHashTables()) {
+    XELOGW("STFS: failed to read hash tables");
+    return false;
+  }
+
+  ResetTree();
+  if (!ReadFileTable()) {
+    XELOGW("STFS: failed to read file table");
+    return false;
+  }
+
+  XELOGI("STFS container opened: {} (magic=0x{:08X}, title={:08X}, "
+         "{} blocks, {} entries)",
+         package_path_, magic_, title_id_, block_count_, entry_count());
+  return true;
+}
+
+// ── Block geometry ───────────────────────────────────────────────────────────
+
+uint64_t StfsContainerDevice::BlockToOffset(uint32_t block) const {
+  // Each group of 170 data blocks is preceded by its level-0 table; every
+  // 170 groups also carry a level-1 table, and beyond that a level-2 one.
+  uint64_t backing = (uint64_t((block + kStfsBlocksPerHashTable) /
+                               kStfsBlocksPerHashTable) << table_shift_) + block;
+  if (block >= kStfsBlocksPerHashTable) {
+    backing += uint64_t((block + kBlocksPerLevel1) / kBlocksPerLevel1)
+               << table_shift_;
+    if (block >= kBlocksPerLevel1) backing += uint64_t(1) << table_shift_;
+  }
+  return first_hash_table_offset_ + backing * kStfsBlockSize;
+}
+
+uint32_t StfsContainerDevice::BlockToHashBlock(uint32_t block,
+                                               uint32_t level) const {
+  // Distance between consecutive level-0 / level-1 tables, in blocks
+  uint32_t step0 = table_shift_ ? 0xAC : 0xAB;
+  uint32_t step1 = table_shift_ ? 0x723A : 0x718F;
+
+  if (level == 2) return step1;
+  if (level == 1) {
+    if (block < kBlocksPerLevel1) return step0;
+    return (block / kBlocksPerLevel1) * step1 + (1u << table_shift_);
+  }
+
+  if (block < kStfsBlocksPerHashTable) return 0;
+  uint32_t num = (block / kStfsBlocksPerHashTable) * step0;
+  num += ((block / kBlocksPerLevel1) + 1) << table_shift_;
+  if (block / kBlocksPerLevel1 == 0) return num;
+  return num + (1u << table_shift_);
+}
+
+uint64_t StfsContainerDevice::ActiveHashTableOffset(uint32_t block,
+                                                   uint32_t level) const {
+  auto table_offset = [&](uint32_t level) {
+    return first_hash_table_offset_ +
+           uint64_t(BlockToHashBlock(block, level)) * kStfsBlockSize;
+  };
+  if (!table_shift_) return table_offset(level);  // Single table copy
+
+  // Two copies of every table: the top one is picked by the descriptor,
+  // each lower one by the status byte of its entry in the level above
+  bool second = (descriptor_.block_separation & 2) != 0;
+  auto descend = [&](uint32_t level, uint32_t index) {
+    uint64_t entry = table_offset(level) + (second ? kStfsBlockSize : 0) +
+                     uint64_t(index % kStfsBlocksPerHashTable) * kHashEntrySize;
+    if (entry + kHashEntrySize > package_->size()) return false;
+    return (package_->data()[entry + 0x14] & kHashEntryActiveIndex) != 0;
+  };
+  uint32_t total = descriptor_.allocated_block_count;
+  if (level < 2 && total > kBlocksPerLevel1) {
+    second = descend(2, block / kBlocksPerLevel1);
+  }
+  if (level < 1 && total > kStfsBlocksPerHashTable) {
+    second = descend(1, block / kStfsBlocksPerHashTable);
+  }
+  return table_offset(level) + (second ? kStfsBlockSize : 0);
+}
+
+bool StfsContainerDevice::HashTableMatches(uint64_t table_offset,
+                                           uint64_t hash_offset) const {
+  if (table_offset + kStfsBlockSize > package_->size() ||
+      hash_offset + Sha1::kDigestSize > package_->size()) {
+    return false;
+  }
+  uint8_t digest[Sha1::kDigestSize];
+  Sha1::Digest(package_->data() + table_offset, kStfsBlockSize, digest);
+  return memcmp(digest, package_->data() + hash_offset, Sha1::kDigestSize) ==
+         0;
+}
+
+bool StfsContainerDevice::ParseHashTables() {
+  block_count_ = descriptor_.allocated_block_count;
+  if (block_count_ >= kStfsEndOfChain) return false;
+  block_offsets_.assign(block_count_, 0);
+  next_blocks_.assign(block_count_, kStfsEndOfChain);
+  block_hashes_.assign(size_t(block_count_) * Sha1::kDigestSize, 0);
+  if (!block_count_) return true;
+
+  // Tables are spread through the whole package; on flash, parallel
+  // faults keep more reads in flight than a single sequential walk
+  uint32_t groups = (block_count_ + kStfsBlocksPerHashTable - 1) /
+                    kStfsBlocksPerHashTable;
+  xe::threading::JobOptions options;
+  options.name = "stfs_hash_parse";
+  xe::threading::JobSystem::Shared().ParallelFor(
+      groups, [this](uint32_t group) { ParseHashTableGroup(group); }, options);
+
+  // Level-0 tables were checked per group; the levels above are few
+  if (!cvars.GetValue<bool>("stfs_verify_hashes", false)) return true;
+  uint32_t top = block_count_ > kBlocksPerLevel1         ? 2
+                 : block_count_ > kStfsBlocksPerHashTable ? 1
+                                                          : 0;
+  uint32_t failures = hash_table_failures_.load(std::memory_order_relaxed);
+  if (top == 2) {
+    for (uint32_t first = 0; first < block_count_; first += kBlocksPerLevel1) {
+      uint64_t parent = ActiveHashTableOffset(first, 2) +
+                        uint64_t(first / kBlocksPerLevel1) * kHashEntrySize;
+      if (!HashTableMatches(ActiveHashTableOffset(first, 1), parent)) {
+        failures++;
+      }
+    }
+  }
+  if (!HashTableMatches(ActiveHashTableOffset(0, top),
+                        kStfsVolumeDescriptorOffset + 8)) {
+    failures++;
+  }
+  hash_tables_verified_ = failures == 0;
+  if (failures) {
+    XELOGW("STFS: {} hash tables of {} fail their SHA-1 check", failures,
+           package_path_);
+  }
+  return true;
+}
+
+void StfsContainerDevice::ParseHashTableGroup(uint32_t group) {
+  uint32_t first = group * kStfsBlocksPerHashTable;
+  uint32_t last = std::min(first + kStfsBlocksPerHashTable, block_count_);
+  uint64_t table = ActiveHashTableOffset(first);
+  bool have_table = table + kStfsBlockSize <= package_->size();
+  if (!have_table) {
+    XELOGW("STFS: hash table for blocks {}..{} is past EOF", first, last - 1);
+  }
+  // A level-0 table hashes to its entry in the level-1 table above it
+  if (block_count_ > kStfsBlocksPerHashTable &&
+      cvars.GetValue<bool>("stfs_verify_hashes", false)) {
+    uint64_t parent =
+        ActiveHashTableOffset(first, 1) +
+        uint64_t(group % kStfsBlocksPerHashTable) * kHashEntrySize;
+    if (!have_table || !HashTableMatches(table, parent)) {
+      hash_table_failures_.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  for (uint32_t block = first; block < last; ++block) {
+    uint64_t offset = BlockToOffset(block);
+    // Blocks past EOF stay at offset 0 and are rejected when runs are built
+    if (offset + kStfsBlockSize <= package_->size()) {
+      block_offsets_[block] = offset;
     }
+    if (!have_table) continue;
+    const uint8_t* entry =
+        package_->data() + table + (block - first) * kHashEntrySize;
+    memcpy(&block_hashes_[size_t(block) * Sha1::kDigestSize], entry,
+           Sha1::kDigestSize);
+    next_blocks_[block] = BE24(entry + 0x15);
+  }
+}
 
-    // Read header
-    uint8_t raw_header[0x200];
-    f.read(reinterpret_cast<char*>(raw_header), sizeof(raw_header));
-    if (f.gcount() < 4) return false;
+// ── File table ───────────────────────────────────────────────────────────────
 
-    uint32_t magic;
-    memcpy(&magic, raw_header, 4);
-    magic = __builtin_bswap32(magic);
+bool StfsContainerDevice::ReadFileTable() {
+  struct Record {
+    std::string name;
+    uint8_t flags;
+    uint32_t block_count;
+    uint32_t start_block;
+    uint16_t parent;
+    uint32_t size;
+  };
+  std::vector<Record> records;
 
-    if (magic != kStfsMagicCon && magic != kStfsMagicLive && magic != kStfsMagicPirs) {
-      XELOGW("Not a valid STFS container (magic=0x{:08X})", magic);
-      return false;
+  uint32_t block = descriptor_.file_table_block_number;
+  for (uint32_t i = 0; i < descriptor_.file_table_block_count; ++i) {
+    if (block >= block_count_ || !block_offsets_[block]) break;
+    const uint8_t* data = package_->data() + block_offsets_[block];
+    for (uint32_t r = 0; r < kFileRecordsPerBlock; ++r) {
+      const uint8_t* p = data + r * kFileRecordSize;
+      uint8_t flags = p[0x28];
+      uint8_t name_length = flags & 0x3F;
+      Record rec;
+      rec.flags = flags;
+      rec.name.assign(reinterpret_cast<const char*>(p),
+                      std::min<size_t>(name_length, 0x28));
+      rec.block_count = LE24(p + 0x29);
+      rec.start_block = LE24(p + 0x2F);
+      rec.parent = BE16(p + 0x32);
+      rec.size = BE32(p + 0x34);
+      // Empty records keep their slot so parent indices stay valid
+      records.push_back(std::move(rec));
     }
+    block = next_blocks_[block];
+  }
+  if (records.empty()) return false;
 
-    header_.magic = magic;
-    XELOGI("STFS container opened: {} (magic=0x{:08X})", path_, magic);
-    return true;
+  // Parent indices may point forward, so link the tree in a second pass
+  std::vector<std::vector<uint32_t>> children(records.size());
+  std::vector<uint32_t> roots;
+  for (uint32_t i = 0; i < records.size(); ++i) {
+    if (records[i].name.empty()) continue;
+    uint16_t parent = records[i].parent;
+    if (parent == 0xFFFF) {
+      roots.push_back(i);
+    } else if (parent < records.size() && parent != i) {
+      children[parent].push_back(i);
+    }
   }
 
-  void Close() {
-    XELOGI("STFS container closed: {}", path_);
+  std::vector<bool> attached(records.size(), false);
+  std::vector<std::pair<uint32_t, VfsEntry*>> stack;
+  for (auto it = roots.rbegin(); it != roots.rend(); ++it) {
+    stack.emplace_back(*it, root());
+  }
+  while (!stack.empty()) {
+    auto [index, parent] = stack.back();
+    stack.pop_back();
+    if (attached[index]) continue;  // Malformed: cycle or duplicate link
+    attached[index] = true;
+    const Record& rec = records[index];
+    bool is_dir = (rec.flags & kFileFlagDirectory) != 0;
+    auto* entry = AddEntry(
+        parent, std::make_unique<VfsEntry>(this, parent, rec.name, is_dir));
+    if (is_dir) {
+      for (auto it = children[index].rbegin(); it != children[index].rend();
+           ++it) {
+        stack.emplace_back(*it, entry);
+      }
+    } else {
+      entry->set_size(rec.size);
+      entry->set_allocation_size(uint64_t(rec.block_count) * kStfsBlockSize);
+      entry->set_data_offset(rec.start_block);
+      entry->set_device_flags(rec.flags);
+    }
   }
+  return true;
+}
 
- private:
-  std::string path_;
-  StfsHeader header_ = {};
-};
+// ── File data ────────────────────────────────────────────────────────────────
+
+const std::vector<DataRun>& StfsContainerDevice::EntryRuns(
+    const VfsEntry* entry) {
+  xe::threading::LockGuard lock(runs_mutex_);
+  auto it = runs_.find(entry);
+  if (it != runs_.end()) return it->second;
+
+  // Walk the chain once; consecutive blocks inside a hash group are
+  // adjacent in the package and merge into a single run
+  std::vector<DataRun> runs;
+  bool contiguous = (entry->device_flags() & kFileFlagContiguous) != 0;
+  uint32_t block = static_cast<uint32_t>(entry->data_offset());
+  uint64_t remaining = entry->size();
+  uint64_t file_offset = 0;
+  while (remaining) {
+    if (block >= block_count_ || !block_offsets_[block]) {
+      XELOGW("STFS: {} is truncated at block {}", entry->path(), block);
+      break;
+    }
+    uint64_t length = std::min<uint64_t>(kStfsBlockSize, remaining);
+    AppendDataRun(runs, file_offset, 0, block_offsets_[block], length);
+    file_offset += length;
+    remaining -= length;
+    block = contiguous ? block + 1 : next_blocks_[block];
+  }
+  return runs_.emplace(entry, std::move(runs)).first->second;
+}
+
+bool StfsContainerDevice::ReadEntry(const VfsEntry* entry, uint64_t offset,
+                                    void* buffer, size_t length,
+                                    size_t* bytes_read) {
+  *bytes_read = 0;
+  if (offset >= entry->size()) return true;
+  length = static_cast<size_t>(
+      std::min<uint64_t>(length, entry->size() - offset));
+
+  const auto& runs = EntryRuns(entry);
+  auto* out = static_cast<uint8_t*>(buffer);
+  for (size_t i = FindDataRun(runs, offset);
+       i < runs.size() && *bytes_read < length; ++i) {
+    const DataRun& run = runs[i];
+    uint64_t in_run = offset - run.file_offset;
+    size_t chunk = static_cast<size_t>(
+        std::min<uint64_t>(run.length - in_run, length - *bytes_read));
+    memcpy(out + *bytes_read, package_->data() + run.source_offset + in_run,
+           chunk);
+    *bytes_read += chunk;
+    offset += chunk;
+  }
+  return *bytes_read == length;  // Short only for truncated packages
+}
+
+const uint8_t* StfsContainerDevice::EntryData(const VfsEntry* entry) {
+  const auto& runs = EntryRuns(entry);
+  if (runs.size() != 1 || runs[0].length != entry->size()) return nullptr;
+  return package_->data() + runs[0].source_offset;
+}
+
+bool StfsContainerDevice::MapEntryInto(const VfsEntry* entry, uint64_t offset,
+                                       void* dest, size_t length) {
+  // Only ranges inside one run map 1:1 onto package pages
+  if (offset + length > entry->size()) return false;
+  const auto& runs = EntryRuns(entry);
+  size_t i = FindDataRun(runs, offset);
+  if (i == runs.size()) return false;
+  const DataRun& run = runs[i];
+  uint64_t in_run = offset - run.file_offset;
+  if (in_run + length > run.length) return false;
+  return xe::memory::MapFileView(dest, length, package_->fd(),
+                                 run.source_offset + in_run);
+}
+
+std::unique_ptr<VfsFile> StfsContainerDevice::OpenFile(VfsEntry* entry,
+                                                       FileAccess access,
+                                                       bool truncate) {
+  if (entry->is_directory() || access != FileAccess::kRead || truncate) {
+    return nullptr;
+  }
+  if (cvars.GetValue<bool>("stfs_verify_hashes", false)) VerifyEntry(entry);
+  return std::make_unique<StfsFile>(entry, this);
+}
+
+// ── Verification ─────────────────────────────────────────────────────────────
+
+void StfsContainerDevice::VerifyEntry(const VfsEntry* entry) {
+  auto key = VerifiedCache::MakeKey(package_identity_, "stfs/" + entry->path(),
+                                    descriptor_.top_hash_table_hash,
+                                    sizeof(descriptor_.top_hash_table_hash));
+  if (VerifiedCache::Get().Contains(key)) return;
+  const auto& runs = EntryRuns(entry);
+
+  xe::threading::LockGuard lock(verify_mutex_);
+  if (verify_state_.empty()) verify_state_.assign(block_count_, 0);
+  uint32_t check = static_cast<uint32_t>(verify_checks_.size());
+  uint32_t queued = 0;
+  bool contiguous = (entry->device_flags() & kFileFlagContiguous) != 0;
+  uint32_t block = static_cast<uint32_t>(entry->data_offset());
+  uint64_t blocks = runs.empty() ? 0
+                                 : (runs.back().file_offset +
+                                    runs.back().length + kStfsBlockSize - 1) /
+                                       kStfsBlockSize;
+  bool complete = true;
+  for (uint64_t i = 0; i < blocks; ++i) {
+    if (block >= block_count_ || !block_offsets_[block]) {
+      complete = false;  // Truncated package
+      break;
+    }
+    if (!verify_state_[block]) {
+      verify_state_[block] = 1;
+      verify_queue_.push_back({block, check});
+      queued++;
+    }
+    block = contiguous ? block + 1 : next_blocks_[block];
+  }
+  if (!queued) return;
+  // Only a file whose every block is checked here, against tables that
+  // checked out themselves, can be cached as good
+  verify_checks_.push_back(
+      {complete && hash_tables_verified_ ? std::move(key)
+                                         : VerifiedCache::Key(),
+       queued, false});
+  // Running jobs keep draining the queue; add one per batch up to the cap
+  uint32_t wanted = std::min<uint32_t>(
+      kMaxVerifyJobs, static_cast<uint32_t>((verify_queue_.size() +
+                                             kVerifyBatchBlocks - 1) /
+                                            kVerifyBatchBlocks));
+  xe::threading::JobOptions options;
+  options.name = "stfs_verify";
+  options.priority = xe::threading::JobPriority::kBackground;
+  options.counter = &verify_counter_;
+  for (; verify_jobs_ < wanted; ++verify_jobs_) {
+    xe::threading::JobSystem::Shared().Submit([this]() { VerifyBlocks(); },
+                                              options);
+  }
+}
+
+void StfsContainerDevice::VerifyBlocks() {
+  VerifyItem batch[kVerifyBatchBlocks];
+  bool match[kVerifyBatchBlocks];
+  verify_mutex_.Lock();
+  while (!verify_queue_.empty() && !verify_shutdown_) {
+    uint32_t count = 0;
+    while (count < kVerifyBatchBlocks && !verify_queue_.empty()) {
+      batch[count++] = verify_queue_.front();
+      verify_queue_.pop_front();
+    }
+    verify_mutex_.Unlock();
+
+    for (uint32_t i = 0; i < count; ++i) {
+      uint32_t block = batch[i].block;
+      uint8_t digest[Sha1::kDigestSize];
+      Sha1::Digest(package_->data() + block_offsets_[block], kStfsBlockSize,
+                   digest);
+      match[i] = memcmp(digest,
+                        &block_hashes_[size_t(block) * Sha1::kDigestSize],
+                        Sha1::kDigestSize) == 0;
+    }
+
+    verify_mutex_.Lock();
+    for (uint32_t i = 0; i < count; ++i) {
+      auto& check = verify_checks_[batch[i].check];
+      if (!match[i]) {
+        check.failed = true;
+        if (verify_failures_++ < 16) {
+          XELOGW("STFS: block {} of {} fails its SHA-1 check", batch[i].block,
+                 package_path_);
+        }
+      }
+      if (--check.remaining == 0 && !check.failed) {
+        VerifiedCache::Get().Insert(check.key);
+      }
+    }
+  }
+  verify_jobs_--;
+  verify_mutex_.Unlock();
+}
 
 }  // namespace xe::vfs
@@ -0,0 +1,172 @@
+/**
+ * Vera360 — Xenia Edge
+ * STFS Container Device — Xbox 360 CON/LIVE/PIRS packages
+ *
+ * STFS stores data in 4 KB blocks interleaved with SHA-1 hash tables.
+ * Level-0 tables describe 170 data blocks each (hash + next-block link);
+ * higher levels describe 170 lower tables. The file table is itself a
+ * block chain of 64-byte records, one per file or directory.
+ *
+ * The package is memory mapped and every level-0 table is parsed once (in
+ * parallel for large packages) into flat per-block arrays, so following a
+ * chain never touches the hash tables again. Each file's chain is resolved
+ * into coalesced runs on first use; reads are a binary search plus memcpy.
+ * SHA-1 verification of data blocks, when enabled, runs as background jobs
+ * on the shared pool as files are opened and never delays a read. The hash
+ * tables it trusts are checked while they are parsed, each against its
+ * entry one level up and the top one against the volume descriptor. Files
+ * that passed, in packages whose tables passed, are remembered in the
+ * VerifiedCache and skipped on later runs.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "xenia/base/job_system.h"
+#include "xenia/base/mapped_file.h"
+#include "xenia/base/threading.h"
+#include "xenia/base/verified_cache.h"
+#include "xenia/vfs/data_run.h"
+#include "xenia/vfs/vfs_device.h"
+
+namespace xe::vfs {
+
+/// STFS header magic values
+constexpr uint32_t kStfsMagicCon  = 0x434F4E20;  // "CON "
+constexpr uint32_t kStfsMagicLive = 0x4C495645;  // "LIVE"
+constexpr uint32_t kStfsMagicPirs = 0x50495253;  // "PIRS"
+
+constexpr uint32_t kStfsBlockSize = 0x1000;
+constexpr uint32_t kStfsBlocksPerHashTable = 170;
+constexpr uint32_t kStfsEndOfChain = 0xFFFFFF;
+
+/// Package header fields shared by STFS and SVOD
+constexpr uint32_t kStfsHeaderSizeOffset       = 0x340;
+constexpr uint32_t kStfsContentTypeOffset      = 0x344;
+constexpr uint32_t kStfsTitleIdOffset          = 0x360;
+constexpr uint32_t kStfsVolumeDescriptorOffset = 0x379;
+constexpr uint32_t kStfsDescriptorTypeOffset   = 0x3A9;
+constexpr uint32_t kStfsHeaderReadSize         = 0x3B0;
+
+/// Parsed STFS volume descriptor (at header offset 0x379)
+struct StfsVolumeDescriptor {
+  uint8_t descriptor_size = 0;
+  uint8_t version = 0;
+  uint8_t block_separation = 0;
+  uint16_t file_table_block_count = 0;
+  uint32_t file_table_block_number = 0;
+  uint8_t top_hash_table_hash[20] = {};
+  uint32_t allocated_block_count = 0;
+  uint32_t unallocated_block_count = 0;
+};
+
+class StfsContainerDevice : public VfsDevice {
+ public:
+  StfsContainerDevice(std::string_view mount_path,
+                      std::string_view package_path);
+  ~StfsContainerDevice() override;
+
+  bool Initialize() override;
+
+  std::unique_ptr<VfsFile> OpenFile(VfsEntry* entry, FileAccess access,
+                                    bool truncate) override;
+
+  uint64_t total_bytes() const override {
+    return package_ ? package_->size() : 0;
+  }
+
+  uint32_t magic() const { return magic_; }
+  uint32_t title_id() const { return title_id_; }
+  uint32_t content_type() const { return content_type_; }
+
+  /// Read raw bytes of an entry (offset relative to the file start)
+  bool ReadEntry(const VfsEntry* entry, uint64_t offset, void* buffer,
+                 size_t length, size_t* bytes_read);
+
+  /// Pointer to the whole file when its blocks are one contiguous run
+  const uint8_t* EntryData(const VfsEntry* entry);
+
+  /// Remap whole pages of an entry over dest (copy-on-write)
+  bool MapEntryInto(const VfsEntry* entry, uint64_t offset, void* dest,
+                    size_t length);
+
+  /// Queue background SHA-1 checks of an entry's blocks, unless the file
+  /// already passed on an earlier run
+  void VerifyEntry(const VfsEntry* entry);
+
+  /// Check a host file for a CON/LIVE/PIRS magic
+  static bool IsStfsPackage(const std::string& path);
+
+ private:
+  bool ParseHashTables();
+  void ParseHashTableGroup(uint32_t group);
+  bool ReadFileTable();
+
+  /// Data block number → byte offset in the package
+  uint64_t BlockToOffset(uint32_t block) const;
+  /// Hash table (level 0–2) covering a data block, as a block index
+  uint32_t BlockToHashBlock(uint32_t block, uint32_t level) const;
+  /// Package offset of the active copy of the level 0–2 table for a block
+  uint64_t ActiveHashTableOffset(uint32_t block, uint32_t level = 0) const;
+  /// Whether the SHA-1 of the table at table_offset equals the 20 bytes at
+  /// hash_offset
+  bool HashTableMatches(uint64_t table_offset, uint64_t hash_offset) const;
+
+  const std::vector<DataRun>& EntryRuns(const VfsEntry* entry);
+
+  /// Job: check queued blocks until the queue is empty
+  void VerifyBlocks();
+
+  std::string package_path_;
+  std::unique_ptr<MappedFile> package_;
+
+  uint32_t magic_ = 0;
+  uint32_t header_size_ = 0;
+  uint32_t content_type_ = 0;
+  uint32_t title_id_ = 0;
+  StfsVolumeDescriptor descriptor_;
+  uint64_t first_hash_table_offset_ = 0;
+  /// 0 for read-only packages (one table copy), 1 when tables are doubled
+  uint32_t table_shift_ = 0;
+
+  // Flat per-block tables built once from the level-0 hash tables
+  uint32_t block_count_ = 0;
+  std::vector<uint64_t> block_offsets_;
+  std::vector<uint32_t> next_blocks_;
+  std::vector<uint8_t> block_hashes_;  // 20 bytes per block
+  /// Set by ParseHashTables when every table checked out up to the top hash
+  bool hash_tables_verified_ = false;
+  std::atomic<uint32_t> hash_table_failures_{0};
+
+  xe::threading::Mutex runs_mutex_;
+  std::unordered_map<const VfsEntry*, std::vector<DataRun>> runs_;
+
+  // Background verification
+  struct VerifyCheck {
+    VerifiedCache::Key key;  // Cache entry for the file once it passes
+    uint32_t remaining = 0;
+    bool failed = false;
+  };
+  struct VerifyItem {
+    uint32_t block;
+    uint32_t check;  // Index into verify_checks_
+  };
+  std::string package_identity_;
+  xe::threading::Mutex verify_mutex_;
+  std::deque<VerifyItem> verify_queue_;
+  std::vector<VerifyCheck> verify_checks_;
+  std::vector<uint8_t> verify_state_;  // 0 = unchecked, 1 = queued/done
+  uint32_t verify_failures_ = 0;
+  bool verify_shutdown_ = false;
+  uint32_t verify_jobs_ = 0;  // VerifyBlocks jobs queued or running
+  xe::threading::JobCounter verify_counter_;
+};
+
+}  // namespace xe::vfs
@@ -0,0 +1,315 @@
+/**
+ * Vera360 — Xenia Edge
+ * SVOD Container — GDF file systems inside Xbox 360 SVOD packages
+ */
+
+#include "xenia/vfs/svod_container.h"
+#include "xenia/vfs/stfs_container.h"
+#include "xenia/vfs/xdvdfs.h"
+#include "xenia/base/logging.h"
+#include "xenia/base/memory/memory.h"
+#include <unistd.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace xe::vfs {
+
+namespace {
+
+constexpr uint32_t kSvodBlockSize = 0x800;
+constexpr uint64_t kSvodHashBlockSize = 0x1000;
+constexpr uint32_t kSvodBlocksPerL0Hash = 0x198;
+constexpr uint32_t kSvodHashesPerL1Hash = 0xA1C4;
+constexpr uint32_t kSvodBlocksPerFile = 0x14388;
+constexpr uint64_t kSvodMaxFileSize = 0xA290000;
+constexpr uint32_t kMaxDataFiles = 10000;
+constexpr int kMaxDirectoryDepth = 32;
+
+// SVOD volume descriptor fields (relative to kStfsVolumeDescriptorOffset)
+constexpr uint32_t kSvodFeaturesOffset = 0x18;
+constexpr uint32_t kSvodStartDataBlockOffset = 0x1C;
+constexpr uint8_t kSvodFeatureEnhancedGdf = 0x40;
+
+inline uint32_t BE32(const uint8_t* p) {
+  return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) |
+         (uint32_t(p[2]) << 8) | p[3];
+}
+inline uint32_t LE24(const uint8_t* p) {
+  return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16);
+}
+inline uint32_t LE32(const uint8_t* p) {
+  return LE24(p) | (uint32_t(p[3]) << 24);
+}
+
+bool HasMagicAt(const MappedFile& file, uint64_t offset) {
+  return offset + kXdvdfsSectorSize <= file.size() &&
+         memcmp(file.data() + offset, kXdvdfsMagic, 20) == 0;
+}
+
+class SvodFile : public VfsFile {
+ public:
+  SvodFile(VfsEntry* entry, SvodContainerDevice* device)
+      : VfsFile(entry), device_(device) {}
+
+  bool Read(void* buffer, size_t length, uint64_t offset,
+            size_t* bytes_read) override {
+    return device_->ReadEntry(entry(), offset, buffer, length, bytes_read);
+  }
+
+  bool MapInto(void* dest, size_t length, uint64_t offset) override {
+    return device_->MapEntryInto(entry(), offset, dest, length);
+  }
+
+  const uint8_t* mapped_data() const override {
+    return device_->EntryData(entry());
+  }
+
+ private:
+  SvodContainerDevice* device_;
+};
+
+}  // namespace
+
+SvodContainerDevice::SvodContainerDevice(std::string_view mount_path,
+                                         std::string_view package_path)
+    : VfsDevice(mount_path), package_path_(package_path) {}
+
+SvodContainerDevice::~SvodContainerDevice() = default;
+
+bool SvodContainerDevice::IsSvodPackage(const std::string& path) {
+  auto file = MappedFile::Open(path);
+  if (!file || file->size() < kStfsHeaderReadSize) return false;
+  uint32_t m = BE32(file->data());
+  bool is_package =
+      m == kStfsMagicCon || m == kStfsMagicLive || m == kStfsMagicPirs;
+  return is_package && file->data()[kStfsDescriptorTypeOffset] == 1;
+}
+
+bool SvodContainerDevice::Initialize() {
+  auto package = MappedFile::Open(package_path_);
+  if (!package || package->size() < kStfsHeaderReadSize) {
+    XELOGW("Failed to open SVOD package: {}", package_path_);
+    return false;
+  }
+  const uint8_t* header = package->data();
+  if (header[kStfsDescriptorTypeOffset] != 1) {
+    XELOGW("SVOD: {} has an STFS volume descriptor", package_path_);
+    return false;
+  }
+  title_id_ = BE32(header + kStfsTitleIdOffset);
+  content_type_ = BE32(header + kStfsContentTypeOffset);
+
+  const uint8_t* vd = header + kStfsVolumeDescriptorOffset;
+  uint8_t features = vd[kSvodFeaturesOffset];
+  start_data_block_ = LE24(vd + kSvodStartDataBlockOffset);
+
+  if (!OpenDataFiles()) {
+    // Small packages carry the GDF after their own header
+    data_files_.clear();
+    data_bytes_ = package->size();
+    data_files_.push_back(std::move(package));
+  }
+  const MappedFile& first = *data_files_[0];
+
+  uint64_t magic_offset = 0;
+  if (features & kSvodFeatureEnhancedGdf) {
+    layout_ = Layout::kEnhancedGdf;
+    magic_offset = 0x2000;
+  } else if (HasMagicAt(first, 0x12000)) {
+    layout_ = memcmp(first.data() + 0x2000, "XSF", 3) == 0 ? Layout::kXsf
+                                                            : Layout::kUnknown;
+    magic_offset = 0x12000;
+  } else if (HasMagicAt(first, 0xD000)) {
+    layout_ = Layout::kSingleFile;
+    magic_offset = 0xD000;
+    base_offset_ = 0xB000;
+  }
+  if (!HasMagicAt(first, magic_offset)) {
+    XELOGW("SVOD: no GDF volume found in {}", first.path());
+    return false;
+  }
+
+  const uint8_t* magic_block = first.data() + magic_offset;
+  uint32_t root_block = LE32(magic_block + 0x14);
+  uint32_t root_size = LE32(magic_block + 0x18);
+
+  ResetTree();
+  if (!ParseDirectory(root(), root_block, root_size, 0)) {
+    XELOGW("SVOD: failed to parse root directory");
+    return false;
+  }
+
+  XELOGI("SVOD package opened: {} (title={:08X}, {} data files, {} entries)",
+         package_path_, title_id_, data_files_.size(), entry_count());
+  return true;
+}
+
+bool SvodContainerDevice::OpenDataFiles() {
+  std::string data_dir = package_path_ + ".data";
+  for (uint32_t i = 0; i < kMaxDataFiles; ++i) {
+    char name[16];
+    snprintf(name, sizeof(name), "/Data%04u", i);
+    std::string path = data_dir + name;
+    if (access(path.c_str(), R_OK) != 0) break;
+    auto file = MappedFile::Open(path);
+    if (!file) break;
+    data_bytes_ += file->size();
+    data_files_.push_back(std::move(file));
+  }
+  return !data_files_.empty();
+}
+
+bool SvodContainerDevice::BlockToOffset(uint32_t block, uint32_t* file_index,
+                                        uint64_t* offset) const {
+  // Data files interleave a level-0 hash block every 0x198 data blocks and
+  // a level-1 block every 0xA1C4 level-0 blocks; GDF block numbers are
+  // relative to the descriptor's start block (counted in 0x1000 units)
+  uint64_t true_block = uint64_t(block) - uint64_t(start_data_block_) * 2;
+  if (layout_ == Layout::kEnhancedGdf) true_block += 2;
+  uint64_t file_block = true_block % kSvodBlocksPerFile;
+  uint64_t index = true_block / kSvodBlocksPerFile;
+
+  uint64_t level0_tables = file_block / kSvodBlocksPerL0Hash + 1;
+  uint64_t level1_tables = level0_tables / kSvodHashesPerL1Hash + 1;
+  uint64_t address = file_block * kSvodBlockSize +
+                     (level0_tables + level1_tables) * kSvodHashBlockSize;
+  if (layout_ == Layout::kSingleFile) address += base_offset_;
+
+  // The hash blocks push the tail of a file's range into the next file
+  if (address >= kSvodMaxFileSize) {
+    index += 1;
+    address = address % kSvodMaxFileSize + 0x2000;
+  }
+  if (index >= data_files_.size()) return false;
+  *file_index = static_cast<uint32_t>(index);
+  *offset = address;
+  return true;
+}
+
+bool SvodContainerDevice::ReadBlocks(uint32_t block, void* buffer,
+                                     size_t length) const {
+  auto* out = static_cast<uint8_t*>(buffer);
+  while (length) {
+    uint32_t file_index;
+    uint64_t offset;
+    if (!BlockToOffset(block, &file_index, &offset)) return false;
+    const MappedFile& file = *data_files_[file_index];
+    size_t chunk = std::min<size_t>(length, kSvodBlockSize);
+    if (offset + chunk > file.size()) return false;
+    memcpy(out, file.data() + offset, chunk);
+    out += chunk;
+    length -= chunk;
+    ++block;
+  }
+  return true;
+}
+
+bool SvodContainerDevice::ParseDirectory(VfsEntry* parent, uint32_t block,
+                                         uint32_t length, int depth) {
+  if (length == 0) return true;  // Empty directory
+  if (depth > kMaxDirectoryDepth) return false;
+
+  std::vector<uint8_t> table(length);
+  if (!ReadBlocks(block, table.data(), length)) return false;
+
+  WalkXdvdfsDirectory(table.data(), length, [&](const XdvdfsDirent& dirent) {
+    bool is_dir = (dirent.attributes & kFileAttributeDirectory) != 0;
+    auto* entry = AddEntry(parent, std::make_unique<VfsEntry>(
+                                       this, parent, dirent.name, is_dir));
+    if (is_dir) {
+      ParseDirectory(entry, dirent.sector, dirent.size, depth + 1);
+    } else {
+      entry->set_size(dirent.size);
+      entry->set_allocation_size((uint64_t(dirent.size) + kSvodBlockSize - 1) &
+                                 ~uint64_t(kSvodBlockSize - 1));
+      entry->set_data_offset(dirent.sector);
+    }
+  });
+  return true;
+}
+
+const std::vector<DataRun>& SvodContainerDevice::EntryRuns(
+    const VfsEntry* entry) {
+  xe::threading::LockGuard lock(runs_mutex_);
+  auto it = runs_.find(entry);
+  if (it != runs_.end()) return it->second;
+
+  // Blocks between two hash blocks are adjacent in their data file and
+  // merge into one run (up to 0x198 blocks = 816 KB)
+  std::vector<DataRun> runs;
+  uint32_t block = static_cast<uint32_t>(entry->data_offset());
+  uint64_t remaining = entry->size();
+  uint64_t file_offset = 0;
+  while (remaining) {
+    uint32_t file_index;
+    uint64_t offset;
+    uint64_t length = std::min<uint64_t>(kSvodBlockSize, remaining);
+    if (!BlockToOffset(block, &file_index, &offset) ||
+        offset + length > data_files_[file_index]->size()) {
+      XELOGW("SVOD: {} is truncated at block {}", entry->path(), block);
+      break;
+    }
+    AppendDataRun(runs, file_offset, file_index, offset, length);
+    file_offset += length;
+    remaining -= length;
+    ++block;
+  }
+  return runs_.emplace(entry, std::move(runs)).first->second;
+}
+
+bool SvodContainerDevice::ReadEntry(const VfsEntry* entry, uint64_t offset,
+                                    void* buffer, size_t length,
+                                    size_t* bytes_read) {
+  *bytes_read = 0;
+  if (offset >= entry->size()) return true;
+  length = static_cast<size_t>(
+      std::min<uint64_t>(length, entry->size() - offset));
+
+  const auto& runs = EntryRuns(entry);
+  auto* out = static_cast<uint8_t*>(buffer);
+  for (size_t i = FindDataRun(runs, offset);
+       i < runs.size() && *bytes_read < length; ++i) {
+    const DataRun& run = runs[i];
+    uint64_t in_run = offset - run.file_offset;
+    size_t chunk = static_cast<size_t>(
+        std::min<uint64_t>(run.length - in_run, length - *bytes_read));
+    memcpy(out + *bytes_read,
+           data_files_[run.source]->data() + run.source_offset + in_run,
+           chunk);
+    *bytes_read += chunk;
+    offset += chunk;
+  }
+  return *bytes_read == length;  // Short only for truncated packages
+}
+
+const uint8_t* SvodContainerDevice::EntryData(const VfsEntry* entry) {
+  const auto& runs = EntryRuns(entry);
+  if (runs.size() != 1 || runs[0].length != entry->size()) return nullptr;
+  return data_files_[runs[0].source]->data() + runs[0].source_offset;
+}
+
+bool SvodContainerDevice::MapEntryInto(const VfsEntry* entry, uint64_t offset,
+                                       void* dest, size_t length) {
+  if (offset + length > entry->size()) return false;
+  const auto& runs = EntryRuns(entry);
+  size_t i = FindDataRun(runs, offset);
+  if (i == runs.size()) return false;
+  const DataRun& run = runs[i];
+  uint64_t in_run = offset - run.file_offset;
+  if (in_run + length > run.length) return false;
+  return xe::memory::MapFileView(dest, length, data_files_[run.source]->fd(),
+                                 run.source_offset + in_run);
+}
+
+std::unique_ptr<VfsFile> SvodContainerDevice::OpenFile(VfsEntry* entry,
+                                                       FileAccess access,
+                                                       bool truncate) {
+  if (entry->is_directory() || access != FileAccess::kRead || truncate) {
+    return nullptr;
+  }
+  return std::make_unique<SvodFile>(entry, this);
+}
+
+}  // namespace xe::vfs
@@ -0,0 +1,92 @@
+/**
+ * Vera360 — Xenia Edge
+ * SVOD Container Device — Xbox 360 "Games on Demand" / installed-disc packages
+ *
+ * An SVOD package is a CON/LIVE header whose volume descriptor points at a
+ * GDF (XDVDFS) file system spread over 0x800-byte blocks in a companion
+ * "<package>.data/Data0000…" directory (or, for small packages, the header
+ * file itself). Each data file interleaves level-0/level-1 hash blocks with
+ * data, so GDF block numbers are translated to (data file, byte offset)
+ * before reading. Every data file is memory mapped; each file's blocks are
+ * resolved into coalesced runs once.
+ */
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "xenia/base/mapped_file.h"
+#include "xenia/base/threading.h"
+#include "xenia/vfs/data_run.h"
+#include "xenia/vfs/vfs_device.h"
+
+namespace xe::vfs {
+
+class SvodContainerDevice : public VfsDevice {
+ public:
+  SvodContainerDevice(std::string_view mount_path,
+                      std::string_view package_path);
+  ~SvodContainerDevice() override;
+
+  bool Initialize() override;
+
+  std::unique_ptr<VfsFile> OpenFile(VfsEntry* entry, FileAccess access,
+                                    bool truncate) override;
+
+  uint64_t total_bytes() const override { return data_bytes_; }
+
+  uint32_t title_id() const { return title_id_; }
+  uint32_t content_type() const { return content_type_; }
+
+  /// Read raw bytes of an entry (offset relative to the file start)
+  bool ReadEntry(const VfsEntry* entry, uint64_t offset, void* buffer,
+                 size_t length, size_t* bytes_read);
+
+  /// Pointer to the whole file when its blocks are one contiguous run
+  const uint8_t* EntryData(const VfsEntry* entry);
+
+  /// Remap whole pages of an entry over dest (copy-on-write)
+  bool MapEntryInto(const VfsEntry* entry, uint64_t offset, void* dest,
+                    size_t length);
+
+  /// Check a host file for a CON/LIVE/PIRS header with an SVOD descriptor
+  static bool IsSvodPackage(const std::string& path);
+
+ private:
+  enum class Layout {
+    kUnknown,
+    kEnhancedGdf,  // Magic block right after the hash blocks (0x2000)
+    kXsf,          // XSF header at 0x2000, magic block at 0x12000
+    kSingleFile,   // GDF inside the package file after its 0xB000 header
+  };
+
+  bool OpenDataFiles();
+  /// GDF block → data file index and byte offset within it
+  bool BlockToOffset(uint32_t block, uint32_t* file_index,
+                     uint64_t* offset) const;
+  /// Copy length bytes starting at a GDF block, crossing hash blocks
+  bool ReadBlocks(uint32_t block, void* buffer, size_t length) const;
+  bool ParseDirectory(VfsEntry* parent, uint32_t block, uint32_t length,
+                      int depth);
+
+  const std::vector<DataRun>& EntryRuns(const VfsEntry* entry);
+
+  std::string package_path_;
+  std::vector<std::unique_ptr<MappedFile>> data_files_;
+  uint64_t data_bytes_ = 0;
+
+  uint32_t title_id_ = 0;
+  uint32_t content_type_ = 0;
+  Layout layout_ = Layout::kUnknown;
+  uint32_t start_data_block_ = 0;
+  uint64_t base_offset_ = 0;
+
+  xe::threading::Mutex runs_mutex_;
+  std::unordered_map<const VfsEntry*, std::vector<DataRun>> runs_;
+};
+
+}  // namespace xe::vfs
@@ -0,0 +1,91 @@
+/**
+ * Vera360 — Xenia Edge
+ * VFS Device — shared entry index
+ */
+
+#include "xenia/vfs/vfs_device.h"
+
+namespace xe::vfs {
+
+std::string_view TrimPath(std::string_view path) {
+  while (!path.empty() && (path.front() == '\\' || path.front() == '/')) {
+    path.remove_prefix(1);
+  }
+  while (!path.empty() && (path.back() == '\\' || path.back() == '/')) {
+    path.remove_suffix(1);
+  }
+  return path;
+}
+
+bool IsValidEntryName(std::string_view name) {
+  if (name.empty() || name == "." || name == "..") return false;
+  return name.find_first_of(std::string_view("\\/\0", 3)) ==
+         std::string_view::npos;
+}
+
+VfsDevice::VfsDevice(std::string_view mount_path) : mount_path_(mount_path) {}
+
+VfsDevice::~VfsDevice() = default;
+
+size_t VfsDevice::entry_count() const {
+  std::lock_guard<std::mutex> lock(tree_mutex_);
+  return index_.size();
+}
+
+VfsEntry* VfsDevice::ResolvePath(std::string_view relative_path) {
+  relative_path = TrimPath(relative_path);
+  std::lock_guard<std::mutex> lock(tree_mutex_);
+  auto it = index_.find(relative_path);
+  if (it != index_.end()) return it->second;
+
+  // A miss may be under a directory nobody has listed yet: walk down from
+  // the root, listing each directory on the way
+  VfsEntry* dir = root_.get();
+  size_t start = 0;
+  while (dir && dir->is_directory()) {
+    ListDirectoryLocked(dir);
+    size_t end = relative_path.find_first_of("\\/", start);
+    it = index_.find(relative_path.substr(0, end));
+    if (it == index_.end()) return nullptr;
+    if (end == std::string_view::npos) return it->second;
+    dir = it->second;
+    start = end + 1;
+  }
+  return nullptr;
+}
+
+void VfsDevice::ListDirectory(VfsEntry* dir) {
+  std::lock_guard<std::mutex> lock(tree_mutex_);
+  ListDirectoryLocked(dir);
+}
+
+VfsEntry* VfsDevice::CreateEntry(VfsEntry* parent, std::string_view name,
+                                 bool is_directory) {
+  if (is_read_only() || !parent || !parent->is_directory()) return nullptr;
+  // The name may become a host path component: no "..", no separators
+  if (!IsValidEntryName(name)) return nullptr;
+  std::lock_guard<std::mutex> lock(tree_mutex_);
+  return CreateChild(parent, name, is_directory);
+}
+
+void VfsDevice::ListDirectoryLocked(VfsEntry* dir) {
+  if (!dir || !dir->needs_listing()) return;
+  dir->set_needs_listing(false);
+  ListChildren(dir);
+}
+
+VfsEntry* VfsDevice::ResetTree() {
+  index_.clear();
+  root_ = std::make_unique<VfsEntry>(this, nullptr, "", true);
+  index_.emplace(root_->path(), root_.get());
+  return root_.get();
+}
+
+VfsEntry* VfsDevice::AddEntry(VfsEntry* parent,
+                              std::unique_ptr<VfsEntry> entry) {
+  VfsEntry* added = parent->AddChild(std::move(entry));
+  index_.emplace(added->path(), added);
+  return added;
+}
+
+}  // namespace xe::vfs
@@ -0,0 +1,176 @@
+/**
+ * Vera360 — Xenia Edge
+ * VFS Device — base class for everything mountable in the guest namespace
+ *
+ * A device owns a tree of VfsEntry nodes built once in Initialize() and a
+ * flat index of device-relative paths → entries. Lookups are hashed and
+ * case-insensitive (the Xbox file systems are), so resolving a guest path
+ * never touches the host file system. A device over a host directory of
+ * unknown size instead lists each directory the first time a lookup or an
+ * enumeration reaches it.
+ *
+ * Lookups, listing and creation can come from several guest threads, so
+ * they run under the device's tree mutex. Devices are shared-owned: an open
+ * handle keeps its device (and so its entries) alive across an unmount.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "xenia/vfs/vfs_entry.h"
+
+namespace xe::vfs {
+
+// ── Path hashing ─────────────────────────────────────────────────────────────
+
+/// ASCII case fold with '/' treated as '\\'
+inline char FoldPathChar(char c) {
+  if (c >= 'A' && c <= 'Z') return static_cast<char>(c + ('a' - 'A'));
+  if (c == '/') return '\\';
+  return c;
+}
+
+/// FNV-1a over the folded path; transparent so string_view lookups
+/// don't allocate
+struct PathHash {
+  using is_transparent = void;
+  size_t operator()(std::string_view s) const {
+    uint64_t h = 0xCBF29CE484222325ull;
+    for (char c : s) {
+      h ^= static_cast<uint8_t>(FoldPathChar(c));
+      h *= 0x100000001B3ull;
+    }
+    return static_cast<size_t>(h);
+  }
+};
+
+struct PathEqual {
+  using is_transparent = void;
+  bool operator()(std::string_view a, std::string_view b) const {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+      if (FoldPathChar(a[i]) != FoldPathChar(b[i])) return false;
+    }
+    return true;
+  }
+};
+
+/// Strip leading/trailing separators from a device-relative path
+std::string_view TrimPath(std::string_view path);
+
+/// A name a guest may create: not empty, ".", "..", and free of separators
+/// and NULs, so it cannot step outside its parent directory
+bool IsValidEntryName(std::string_view name);
+
+// ── Open file ────────────────────────────────────────────────────────────────
+
+class VfsFile {
+ public:
+  explicit VfsFile(VfsEntry* entry) : entry_(entry) {}
+  virtual ~VfsFile() = default;
+
+  VfsEntry* entry() const { return entry_; }
+
+  /// Positional read; *bytes_read is 0 at end of file
+  virtual bool Read(void* buffer, size_t length, uint64_t offset,
+                    size_t* bytes_read) = 0;
+  /// Positional write (host-backed devices only)
+  virtual bool Write(const void* buffer, size_t length, uint64_t offset,
+                     size_t* bytes_written) {
+    (void)buffer; (void)length; (void)offset;
+    *bytes_written = 0;
+    return false;
+  }
+  virtual bool SetLength(uint64_t length) {
+    (void)length;
+    return false;
+  }
+
+  /// Place file contents at dest by remapping file pages instead of
+  /// copying. Only possible for memory-mapped images when dest, offset and
+  /// length are host-page aligned; callers fall back to Read() otherwise.
+  virtual bool MapInto(void* dest, size_t length, uint64_t offset) {
+    (void)dest; (void)length; (void)offset;
+    return false;
+  }
+
+  /// Whole-file view when the backing store is memory mapped, else nullptr
+  virtual const uint8_t* mapped_data() const { return nullptr; }
+
+ private:
+  VfsEntry* entry_;
+};
+
+// ── Device ───────────────────────────────────────────────────────────────────
+
+enum class FileAccess {
+  kRead,
+  kReadWrite,
+};
+
+class VfsDevice : public std::enable_shared_from_this<VfsDevice> {
+ public:
+  explicit VfsDevice(std::string_view mount_path);
+  virtual ~VfsDevice();
+
+  /// Parse / scan the backing store and build the entry index
+  virtual bool Initialize() = 0;
+  virtual bool is_read_only() const { return true; }
+
+  const std::string& mount_path() const { return mount_path_; }
+  VfsEntry* root() const { return root_.get(); }
+  size_t entry_count() const;
+
+  /// Case-insensitive lookup of a device-relative path ("" → root); lists
+  /// unlisted directories along the path
+  VfsEntry* ResolvePath(std::string_view relative_path);
+  /// Bring a directory's children into the tree, before enumerating them
+  void ListDirectory(VfsEntry* dir);
+  /// Held while walking a directory's children, which CreateEntry may grow
+  std::mutex& tree_mutex() const { return tree_mutex_; }
+
+  /// Open an entry for I/O. Returns nullptr for directories or on failure.
+  virtual std::unique_ptr<VfsFile> OpenFile(VfsEntry* entry,
+                                            FileAccess access,
+                                            bool truncate) = 0;
+
+  /// Create a new file or directory under parent (writable devices only)
+  VfsEntry* CreateEntry(VfsEntry* parent, std::string_view name,
+                        bool is_directory);
+
+  /// Free-space figures for NtQueryVolumeInformationFile
+  virtual uint64_t total_bytes() const { return 0; }
+  virtual uint64_t free_bytes() const { return 0; }
+
+ protected:
+  /// Replace the tree with a fresh root and clear the index
+  VfsEntry* ResetTree();
+  /// Attach an entry under parent and index its path
+  VfsEntry* AddEntry(VfsEntry* parent, std::unique_ptr<VfsEntry> entry);
+  /// ListDirectory with tree_mutex_ already held
+  void ListDirectoryLocked(VfsEntry* dir);
+  /// Lazy devices: add dir's children, once, for entries marked
+  /// needs_listing. Called with tree_mutex_ held.
+  virtual void ListChildren(VfsEntry* dir) { (void)dir; }
+  /// CreateEntry body, called with tree_mutex_ held and name validated
+  virtual VfsEntry* CreateChild(VfsEntry* parent, std::string_view name,
+                                bool is_directory) {
+    (void)parent; (void)name; (void)is_directory;
+    return nullptr;
+  }
+
+  std::string mount_path_;
+
+ private:
+  mutable std::mutex tree_mutex_;
+  std::unique_ptr<VfsEntry> root_;
+  std::unordered_map<std::string_view, VfsEntry*, PathHash, PathEqual> index_;
+};
+
+}  // namespace xe::vfs
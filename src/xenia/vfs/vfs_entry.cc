@@ -1,9 +1,45 @@
 /**
  * Vera360 — Xenia Edge
- * VFS Entry — implementation stub
+ * VFS Entry implementation
  */
-#include "xenia/base/logging.h"
+
+#include "xenia/vfs/vfs_entry.h"
+
+#include <algorithm>
 
 namespace xe::vfs {
-// VfsEntry implementation is in virtual_file_system.cc
+
+VfsEntry::VfsEntry(VfsDevice* device, VfsEntry* parent, std::string_view name,
+                   bool is_directory)
+    : device_(device), parent_(parent), name_(name),
+      is_directory_(is_directory) {
+  if (parent_ && !parent_->path_.empty()) {
+    path_.reserve(parent_->path_.size() + 1 + name_.size());
+    path_ = parent_->path_;
+    path_.push_back('\\');
+    path_ += name_;
+  } else if (parent_) {
+    path_ = name_;
+  }
+}
+
+VfsEntry::~VfsEntry() = default;
+
+uint32_t VfsEntry::attributes() const {
+  return is_directory_ ? kFileAttributeDirectory : kFileAttributeNormal;
+}
+
+VfsEntry* VfsEntry::AddChild(std::unique_ptr<VfsEntry> child) {
+  children_.push_back(std::move(child));
+  return children_.back().get();
+}
+
+bool VfsEntry::RemoveChild(const VfsEntry* child) {
+  auto it = std::find_if(children_.begin(), children_.end(),
+                         [child](const auto& c) { return c.get() == child; });
+  if (it == children_.end()) return false;
+  children_.erase(it);
+  return true;
+}
+
 }  // namespace xe::vfs
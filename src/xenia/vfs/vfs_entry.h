@@ -0,0 +1,94 @@
+/**
+ * Vera360 — Xenia Edge
+ * VFS Entry — a file or directory node inside a mounted device
+ *
+ * Entries are built once when a device is initialised and owned by the
+ * device's tree. Paths are stored relative to the device root using the
+ * guest '\\' separator and the original (host / image) casing.
+ */
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace xe::vfs {
+
+class VfsDevice;
+
+/// Xbox FILE_ATTRIBUTE_* flags reported to the guest
+enum FileAttributes : uint32_t {
+  kFileAttributeNone      = 0x0000,
+  kFileAttributeReadOnly  = 0x0001,
+  kFileAttributeHidden    = 0x0002,
+  kFileAttributeSystem    = 0x0004,
+  kFileAttributeDirectory = 0x0010,
+  kFileAttributeArchive   = 0x0020,
+  kFileAttributeNormal    = 0x0080,
+};
+
+class VfsEntry {
+ public:
+  VfsEntry(VfsDevice* device, VfsEntry* parent, std::string_view name,
+           bool is_directory);
+  ~VfsEntry();
+
+  VfsDevice* device() const { return device_; }
+  VfsEntry* parent() const { return parent_; }
+  const std::string& name() const { return name_; }
+  /// Device-relative path ("" for the root, "media\\x.bin" otherwise)
+  const std::string& path() const { return path_; }
+
+  bool is_directory() const { return is_directory_; }
+  /// Directory whose children the device has not listed yet (devices that
+  /// index lazily, see VfsDevice::ListDirectory)
+  bool needs_listing() const { return needs_listing_; }
+  void set_needs_listing(bool value) { needs_listing_ = value; }
+  uint32_t attributes() const;
+
+  uint64_t size() const { return size_; }
+  void set_size(uint64_t size) { size_ = size; }
+  uint64_t allocation_size() const { return allocation_size_; }
+  void set_allocation_size(uint64_t size) { allocation_size_ = size; }
+
+  /// Device-specific location of the data (image byte offset, start block…)
+  uint64_t data_offset() const { return data_offset_; }
+  void set_data_offset(uint64_t offset) { data_offset_ = offset; }
+  /// Device-specific flags (e.g. STFS "contiguous" bit)
+  uint32_t device_flags() const { return device_flags_; }
+  void set_device_flags(uint32_t flags) { device_flags_ = flags; }
+
+  /// Times as 100ns FILETIME ticks (0 when the device has none)
+  uint64_t create_timestamp() const { return create_timestamp_; }
+  uint64_t write_timestamp() const { return write_timestamp_; }
+  void set_timestamps(uint64_t create, uint64_t write) {
+    create_timestamp_ = create;
+    write_timestamp_ = write;
+  }
+
+  /// Children in enumeration order (directories only)
+  const std::vector<std::unique_ptr<VfsEntry>>& children() const {
+    return children_;
+  }
+  VfsEntry* AddChild(std::unique_ptr<VfsEntry> child);
+  bool RemoveChild(const VfsEntry* child);
+
+ private:
+  VfsDevice* device_;
+  VfsEntry* parent_;
+  std::string name_;
+  std::string path_;
+  bool is_directory_;
+  bool needs_listing_ = false;
+  uint64_t size_ = 0;
+  uint64_t allocation_size_ = 0;
+  uint64_t data_offset_ = 0;
+  uint32_t device_flags_ = 0;
+  uint64_t create_timestamp_ = 0;
+  uint64_t write_timestamp_ = 0;
+  std::vector<std::unique_ptr<VfsEntry>> children_;
+};
+
+}  // namespace xe::vfs
@@ -3,67 +3,195 @@
  * Virtual File System — main controller
  */
 
+#include "xenia/vfs/virtual_file_system.h"
 #include "xenia/base/logging.h"
+#include <algorithm>
 #include <string>
-#include <unordered_map>
-#include <memory>
 
 namespace xe::vfs {
 
-class VfsDevice;
-
-/// Represents a file entry in the virtual file system
-class VfsEntry {
- public:
-  VfsEntry(const std::string& name, bool is_directory, uint64_t size = 0)
-      : name_(name), is_directory_(is_directory), size_(size) {}
-  
-  const std::string& name() const { return name_; }
-  bool is_directory() const { return is_directory_; }
-  uint64_t size() const { return size_; }
-
- private:
-  std::string name_;
-  bool is_directory_;
-  uint64_t size_;
-};
-
-/// Manages all mounted devices and file path resolution
-class VirtualFileSystem {
- public:
-  VirtualFileSystem() = default;
-  ~VirtualFileSystem() = default;
-
-  bool Initialize() {
-    XELOGI("Virtual file system initialized");
-    return true;
+namespace {
+
+/// Split off the next path component, skipping separators
+std::string_view NextComponent(std::string_view* path) {
+  size_t start = 0;
+  while (start < path->size() && ((*path)[start] == '\\' ||
+                                  (*path)[start] == '/')) {
+    ++start;
+  }
+  size_t end = start;
+  while (end < path->size() && (*path)[end] != '\\' && (*path)[end] != '/') {
+    ++end;
+  }
+  std::string_view component = path->substr(start, end - start);
+  path->remove_prefix(end);
+  return component;
+}
+
+/// Win32 object-manager prefix ("\\??\\d:\\…") carries no meaning here
+std::string_view StripDosDevicePrefix(std::string_view path) {
+  if (path.size() >= 4 && path[0] == '\\' && path[1] == '?' &&
+      path[2] == '?' && path[3] == '\\') {
+    path.remove_prefix(4);
+  }
+  return path;
+}
+
+}  // namespace
+
+VirtualFileSystem::VirtualFileSystem() = default;
+VirtualFileSystem::~VirtualFileSystem() = default;
+
+bool VirtualFileSystem::Initialize() {
+  XELOGI("Virtual file system initialized");
+  return true;
+}
+
+void VirtualFileSystem::Shutdown() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  root_.children.clear();
+  devices_.clear();
+  XELOGI("Virtual file system shut down");
+}
+
+VirtualFileSystem::Node* VirtualFileSystem::FindOrCreateNode(
+    std::string_view path) {
+  Node* node = &root_;
+  for (auto c = NextComponent(&path); !c.empty(); c = NextComponent(&path)) {
+    auto it = node->children.find(c);
+    if (it == node->children.end()) {
+      it = node->children.emplace(std::string(c), std::make_unique<Node>())
+               .first;
+    }
+    node = it->second.get();
   }
+  return node;
+}
 
-  void Shutdown() {
-    mounts_.clear();
-    XELOGI("Virtual file system shut down");
+VirtualFileSystem::Node* VirtualFileSystem::FindNode(
+    std::string_view path) const {
+  const Node* node = &root_;
+  for (auto c = NextComponent(&path); !c.empty(); c = NextComponent(&path)) {
+    auto it = node->children.find(c);
+    if (it == node->children.end()) return nullptr;
+    node = it->second.get();
   }
+  return const_cast<Node*>(node);
+}
 
-  /// Mount a device at a target path (e.g., "\\Device\\Harddisk0\\Partition1" -> host path)
-  bool MountDevice(const std::string& mount_path, const std::string& device_host_path) {
-    mounts_[mount_path] = device_host_path;
-    XELOGI("VFS mount: {} -> {}", mount_path, device_host_path);
-    return true;
+bool VirtualFileSystem::RegisterDevice(std::unique_ptr<VfsDevice> device) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Node* node = FindOrCreateNode(device->mount_path());
+  if (node == &root_) return false;
+  if (node->device) {
+    XELOGW("VFS: replacing device at {}", device->mount_path());
+    VfsDevice* old = node->device;
+    devices_.erase(std::remove_if(devices_.begin(), devices_.end(),
+                                  [old](const auto& d) {
+                                    return d.get() == old;
+                                  }),
+                   devices_.end());
   }
+  node->device = device.get();
+  XELOGI("VFS mount: {}", device->mount_path());
+  devices_.push_back(std::move(device));
+  return true;
+}
 
-  /// Resolve a guest path to a host path
-  std::string ResolvePath(const std::string& guest_path) const {
-    for (auto& [prefix, host_root] : mounts_) {
-      if (guest_path.substr(0, prefix.size()) == prefix) {
-        return host_root + guest_path.substr(prefix.size());
-      }
+bool VirtualFileSystem::UnregisterDevice(std::string_view mount_path) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Node* node = FindNode(mount_path);
+  if (!node || !node->device) return false;
+  VfsDevice* old = node->device;
+  node->device = nullptr;
+  devices_.erase(std::remove_if(devices_.begin(), devices_.end(),
+                                [old](const auto& d) {
+                                  return d.get() == old;
+                                }),
+                 devices_.end());
+  XELOGI("VFS unmount: {}", mount_path);
+  return true;
+}
+
+bool VirtualFileSystem::RegisterSymbolicLink(std::string_view link,
+                                             std::string_view target) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Node* link_node = FindOrCreateNode(link);
+  Node* target_node = FindOrCreateNode(target);
+  if (link_node == &root_ || link_node == target_node) return false;
+  link_node->link = target_node;
+  XELOGI("VFS symlink: {} -> {}", link, target);
+  return true;
+}
+
+bool VirtualFileSystem::UnregisterSymbolicLink(std::string_view link) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Node* node = FindNode(link);
+  if (!node || !node->link) return false;
+  node->link = nullptr;
+  return true;
+}
+
+std::shared_ptr<VfsDevice> VirtualFileSystem::ResolveDevice(
+    std::string_view guest_path, std::string_view* relative) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::string_view rest = StripDosDevicePrefix(guest_path);
+  const Node* node = &root_;
+  VfsDevice* device = nullptr;
+  std::string_view device_rest;
+  int link_hops = 0;
+
+  for (;;) {
+    std::string_view remaining = rest;
+    auto c = NextComponent(&remaining);
+    if (c.empty()) break;
+    auto it = node->children.find(c);
+    if (it == node->children.end()) break;
+    node = it->second.get();
+    rest = remaining;
+    // Symlinks are followed in place: "game:\\x" continues at CdRom0's node
+    while (node->link && link_hops++ < 8) node = node->link;
+    if (node->device) {
+      device = node->device;
+      device_rest = rest;
     }
+  }
+
+  if (!device) return nullptr;
+  if (relative) *relative = TrimPath(device_rest);
+  return device->shared_from_this();
+}
+
+VfsEntry* VirtualFileSystem::ResolvePath(std::string_view guest_path) const {
+  std::string_view relative;
+  auto device = ResolveDevice(guest_path, &relative);
+  if (!device) {
     XELOGW("VFS: unresolved path: {}", guest_path);
-    return "";
+    return nullptr;
+  }
+  return device->ResolvePath(relative);
+}
+
+VfsEntry* VirtualFileSystem::CreatePath(std::string_view guest_path,
+                                        bool is_directory) {
+  std::string_view relative;
+  auto device = ResolveDevice(guest_path, &relative);
+  if (!device || device->is_read_only() || relative.empty()) return nullptr;
+
+  size_t split = relative.find_last_of("\\/");
+  std::string_view parent_path =
+      split == std::string_view::npos ? std::string_view() :
+                                        relative.substr(0, split);
+  std::string_view name =
+      split == std::string_view::npos ? relative : relative.substr(split + 1);
+  if (!IsValidEntryName(name)) {
+    XELOGW("VFS: refusing to create {}", guest_path);
+    return nullptr;
   }
 
- private:
-  std::unordered_map<std::string, std::string> mounts_;
-};
+  VfsEntry* parent = device->ResolvePath(parent_path);
+  if (!parent || !parent->is_directory()) return nullptr;
+  return device->CreateEntry(parent, name, is_directory);
+}
 
 }  // namespace xe::vfs
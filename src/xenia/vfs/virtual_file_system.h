@@ -0,0 +1,66 @@
+/**
+ * Vera360 — Xenia Edge
+ * Virtual File System — mounted devices and guest path resolution
+ *
+ * Mount points and symbolic links ("game:", "d:") live in a prefix trie
+ * keyed by path component, so resolving a guest path walks one hashed,
+ * case-insensitive node per component and hands the remainder to the
+ * deepest mounted device.
+ */
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "xenia/vfs/vfs_device.h"
+
+namespace xe::vfs {
+
+class VirtualFileSystem {
+ public:
+  VirtualFileSystem();
+  ~VirtualFileSystem();
+
+  bool Initialize();
+  void Shutdown();
+
+  /// Mount an initialised device at device->mount_path()
+  bool RegisterDevice(std::unique_ptr<VfsDevice> device);
+  bool UnregisterDevice(std::string_view mount_path);
+
+  /// Alias a path prefix (e.g. "game:" → "\\Device\\CdRom0")
+  bool RegisterSymbolicLink(std::string_view link, std::string_view target);
+  bool UnregisterSymbolicLink(std::string_view link);
+
+  /// Find the device owning a guest path; *relative receives the rest. The
+  /// reference keeps the device alive if it is unmounted meanwhile.
+  std::shared_ptr<VfsDevice> ResolveDevice(std::string_view guest_path,
+                                           std::string_view* relative) const;
+
+  /// Resolve a full guest path to an entry, or nullptr
+  VfsEntry* ResolvePath(std::string_view guest_path) const;
+
+  /// Create a file/directory at a guest path whose parent exists
+  VfsEntry* CreatePath(std::string_view guest_path, bool is_directory);
+
+ private:
+  struct Node {
+    std::unordered_map<std::string, std::unique_ptr<Node>, PathHash, PathEqual>
+        children;
+    VfsDevice* device = nullptr;
+    Node* link = nullptr;
+  };
+
+  Node* FindOrCreateNode(std::string_view path);
+  Node* FindNode(std::string_view path) const;
+
+  mutable std::mutex mutex_;
+  Node root_;
+  std::vector<std::shared_ptr<VfsDevice>> devices_;
+};
+
+}  // namespace xe::vfs
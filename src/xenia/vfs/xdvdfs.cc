@@ -0,0 +1,65 @@
+/**
+ * Vera360 — Xenia Edge
+ * XDVDFS (GDF) directory table traversal
+ */
+
+#include "xenia/vfs/xdvdfs.h"
+#include <vector>
+
+namespace xe::vfs {
+
+namespace {
+
+inline uint16_t LE16(const uint8_t* p) { return uint16_t(p[0] | (p[1] << 8)); }
+inline uint32_t LE32(const uint8_t* p) {
+  return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) |
+         (uint32_t(p[3]) << 24);
+}
+
+}  // namespace
+
+void WalkXdvdfsDirectory(
+    const uint8_t* table, uint32_t length,
+    const std::function<void(const XdvdfsDirent&)>& visit) {
+  // In-order traversal with an explicit stack yields the entries sorted
+  struct Pending {
+    uint32_t offset;
+    bool visited_left;
+  };
+  std::vector<Pending> stack;
+  stack.push_back({0, false});
+  // Nodes sit at multiples of 4; reaching one twice means a cycle
+  std::vector<bool> entered(length / 4 + 1, false);
+
+  while (!stack.empty()) {
+    Pending node = stack.back();
+    stack.pop_back();
+    if (node.offset + 14 > length) continue;
+    const uint8_t* p = table + node.offset;
+    uint16_t left = LE16(p + 0);
+    uint16_t right = LE16(p + 2);
+    if (left == 0xFFFF && right == 0xFFFF) continue;  // Padding
+
+    if (!node.visited_left) {
+      if (entered[node.offset / 4]) break;  // Malformed (cyclic) tree
+      entered[node.offset / 4] = true;
+      stack.push_back({node.offset, true});
+      if (left) stack.push_back({uint32_t(left) * 4, false});
+      continue;
+    }
+
+    uint8_t name_length = p[13];
+    if (name_length && node.offset + 14 + name_length <= length) {
+      XdvdfsDirent dirent;
+      dirent.name = std::string_view(reinterpret_cast<const char*>(p + 14),
+                                     name_length);
+      dirent.sector = LE32(p + 4);
+      dirent.size = LE32(p + 8);
+      dirent.attributes = p[12];
+      visit(dirent);
+    }
+    if (right) stack.push_back({uint32_t(right) * 4, false});
+  }
+}
+
+}  // namespace xe::vfs
@@ -0,0 +1,32 @@
+/**
+ * Vera360 — Xenia Edge
+ * XDVDFS (GDF) directory tables — shared by disc images and SVOD packages
+ */
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string_view>
+
+namespace xe::vfs {
+
+/// "MICROSOFT*XBOX*MEDIA" — XDVDFS volume descriptor magic
+constexpr char kXdvdfsMagic[] = "MICROSOFT*XBOX*MEDIA";
+constexpr uint32_t kXdvdfsSectorSize = 0x800;
+
+struct XdvdfsDirent {
+  std::string_view name;
+  uint32_t sector;
+  uint32_t size;
+  uint8_t attributes;
+};
+
+/// Visit the entries of one directory table in name order. Directory tables
+/// are binary trees: each node is
+///   left(LE16), right(LE16) — subtree offsets in dwords, 0 = none
+///   sector(LE32), size(LE32), attributes(u8), name_length(u8), name
+/// Malformed (cyclic or out-of-range) links are skipped.
+void WalkXdvdfsDirectory(const uint8_t* table, uint32_t length,
+                         const std::function<void(const XdvdfsDirent&)>& visit);
+
+}  // namespace xe::vfs